@@ -0,0 +1,2708 @@
+/*
+    the ssbc assembler as a library:
+    assemble() transforms ssbc assembly source into machine code in memory
+*/
+
+#ifndef ASSEMBLER_H
+#define ASSEMBLER_H
+
+#include <string>
+#include <sstream>
+#include <queue>
+#include <map>
+#include <set>
+#include <vector>
+#include <iostream>
+#include <fstream>
+#include <memory>
+#include <algorithm>
+#include <string_view>
+#include <climits>
+#include "../common.h"
+
+/*
+    - every line of assembly code can have 0 or 1 instruction.
+    - whitespace is ignored
+    - comments are prepended by a semicolon (;) or a double-slash (//)
+*/
+
+// converts number to 8-bit digit string
+// e.g. n = 9 returns "00001001"
+std::string num2macString(char n) {
+    int mask = 0x80;
+    std::string result;
+    while(mask > 0) {
+        int check = n & mask;
+        if((n & mask) == 0) {
+            result.push_back('0');
+        } else {
+            result.push_back('1');
+        }
+        mask >>= 1;
+    }
+    return result;
+}
+
+// returns the high 8 bits of the value
+char getHighByte(int n) {
+    n >>= 8;
+    return n & 0xFF;
+}
+
+char getLowByte(int n) {
+    return n & 0xFF;
+}
+
+// increments i for as long as there is whitespace in the line
+bool skipSpace(const std::string& input, int& i) {
+    bool spaceFound = false;
+    while(i < input.size() && std::isspace(input[i])) {
+        spaceFound = true;
+        ++i;
+    }
+    return spaceFound;
+}
+
+// returns true if the next available character is c
+// incrementing i to the char after if true
+bool tryParseNextChar(const std::string& input, int& i, const char& c) {
+    int resetI = i;
+    skipSpace(input, i);
+    if(i < input.size() && input[i] == c) {
+        ++i;
+        return true;
+    } else {
+        i = resetI;
+        return false;
+    }
+}
+
+// checks if the string is found at position i
+// updates i to the char after a successful parse
+// and returns true
+bool tryParseNextString(const std::string& input, int& i, const std::string& pattern) {
+    int resetI = i;
+    int j = 0;
+    skipSpace(input, i);
+    while(i < input.size() && j < pattern.size()) {
+        if (input[i] != pattern[j]) {
+            i = resetI;
+            return false;
+        } else {
+            ++i;
+            ++j;
+        }
+    }
+    if(j < pattern.size()) {
+        i = resetI;
+        return false;
+    } else {
+        return true;
+    }
+}
+
+// returns true if we this is a token symbol
+bool isTokenSymbol(const char& c) {
+    return std::isalnum(c) || c == '_';
+}
+
+// fills the next available token, a token being any combination of alphanumeric symbols, dashes, and underscores
+// returns false if none available
+// updates i to the char after the token
+bool tryFetchNextToken(const std::string& input, int& i, std::string& out_token) {
+    int resetI = i;
+    out_token = "";
+    skipSpace(input, i);
+    while(i < input.size() && isTokenSymbol(input[i])) {
+        out_token.push_back(input[i]);
+        ++i;
+    }
+
+    if(out_token.size() == 0) {
+        i = resetI;
+        return false;
+    } else {
+        return true;
+    }
+}
+
+// returns true if the next token was found and has a given string pattern
+// updating i to after the token if successfully parsed
+bool tryParseNextToken(const std::string& input, int& i, const std::string& pattern) {
+    int resetI = i;
+    std::string token;
+
+    if(!tryFetchNextToken(input, i, token) || pattern != token) {
+        i = resetI;
+        return false;
+    } else {
+        return true;
+    }
+}
+
+// returns true if the input has a comment at position i
+bool hasComment(const std::string& input, int i) {
+    return tryParseNextString(input, i, "//") || tryParseNextString(input, i, ";");
+}
+
+// returns true if we have a hex symbol
+bool isHex(const char& c) {
+    return ('0' <= c && c <= '9') || ('A' <= c && c <= 'F') || ('a' <= c && c <= 'f');
+}
+
+// returns true if there was a decimal integer in input at position i
+// filling out_val with the resultant input
+// and updates i to the char after a successful parse
+bool tryParseDecimal(const std::string& input, int& i, std::string& out_string, int& out_val) {
+    int resetI = i;
+    out_string = "";
+    int sign = 1;
+
+    if(i < input.size()) {
+        if(input[i] == '-') {
+            out_string.push_back(input[i]);
+            sign = -1;
+            ++i;
+        } else if(input[i] == '+') {
+            out_string.push_back(input[i]);
+            ++i;
+        }
+    }
+
+    if(i >= input.size() || !std::isdigit(input[i])) {
+        i = resetI;
+        return false;
+    }
+
+    int result = 0;
+    while(i < input.size() && std::isdigit(input[i])) {
+        result *= 10;
+        result += input[i] - '0';
+        out_string.push_back(input[i]);
+        ++i;
+    }
+    out_val = sign * result;
+    return true;
+}
+
+// returns true if the input has between 1 to 4 hex digits
+bool tryParseHexDigits(const std::string& input, int& i, std::string& out_hexDigitString) {
+    int resetI = i;
+    out_hexDigitString = "";
+    while(i < input.size() && isHex(input[i])) {
+        out_hexDigitString.push_back(input[i]);
+        ++i;
+    }
+    if(out_hexDigitString.size() == 0){
+        i = resetI;
+        return false;
+    }
+    return true;
+}
+
+int hex2int(const char& c) {
+    if ('0' <= c && c <= '9') {
+        return c - '0';
+    } else if ('A' <= c && c <= 'F') {
+        return c - 'A' + 10;
+    } else if ('a' <= c && c <= 'f') {
+        return c - 'a' + 10;
+    }
+    return -1;
+}
+
+// returns a hex char for 0 <= n <= 15
+char intToHexChar(int n) {
+    if(0 <= n && n <= 9) {
+        return n + '0';
+    } else if (10 <= n && n <= 15) {
+        return n - 10 + 'A';
+    } else {
+        return 'X';
+    }
+}
+
+// accepts a number and returns a 4-byte hex string
+std::string intToFourHex(int n) {
+    if(n > 0xFFFF) {
+        return "xxxx";
+    }
+    std::string result = "0x";
+    for(int i = 0; i < 4; i++) {
+        result.insert(result.begin()+2, intToHexChar(n % 16));
+        n /= 16;                
+    }
+    return result;
+}
+
+// converts hex digits to integer
+int hex2int(const std::string& input) {
+    int result = 0;
+    for(int i = 0; i < input.size(); i++) {
+        result *= 16;
+        result += hex2int(input[i]);        
+    }
+    return result;
+}
+
+// returns true if there was a hex integer in input at position i
+// in the format of "0xFFFF" with between 1 to 4 hex digits
+// filling out_val with the resultant input
+// and updates i to the char after a successful parse
+bool tryParseHex(const std::string& input, int& i, std::string& out_string, int& out_int) {
+    int resetI = i;
+    std::string hexDigitString;
+
+    if(!(tryParseNextString(input, i, "0x") || tryParseNextString(input, i, "0X")) || !tryParseHexDigits(input, i, hexDigitString)) {
+        i = resetI;
+        return false;
+    }
+
+    out_string = "";
+    out_string.append("0x");
+    out_string.append(hexDigitString);
+    out_int = hex2int(hexDigitString);
+    return true;
+}
+
+// returns true if the token is a 2 byte hex value,
+// filling it's integer value in out_val
+bool tryParse2ByteHex(const std::string& input, int& i, std::string& out_string, int& out_int) {
+    int resetI = i;
+    std::string hexDigitString;
+    if(!(tryParseNextString(input, i, "0x") || tryParseNextString(input, i, "0X")) || !tryParseHexDigits(input, i, hexDigitString) || hexDigitString.size() < 3 || hexDigitString.size() > 4) {
+        i = resetI;
+        return false;
+    }
+    out_string = "";
+    out_string.append("0x");
+    out_string.append(hexDigitString);
+    out_int = hex2int(hexDigitString);
+    return true;
+}
+
+// returns true if the token is a 1 byte hex value,
+// filling it's integer value in out_val
+bool tryParse1ByteHex(const std::string& input, int& i, std::string& out_string, int& out_int) {
+    int resetI = i;
+    std::string hexDigitString;
+
+    if(!(tryParseNextString(input, i, "0x") || tryParseNextString(input, i, "0X")) || !tryParseHexDigits(input, i, hexDigitString) || hexDigitString.size() < 1 || hexDigitString.size() > 2) {
+        i = resetI;
+        return false;
+    }
+    out_string = "";
+    out_string.append("0x");
+    out_string.append(hexDigitString);
+    out_int = hex2int(hexDigitString);
+    return true;
+}
+
+// returns true if the input string is a hex or decimal integer
+bool tryParseInt(const std::string& input, int& i, std::string& out_string, int& out_int) {
+    return tryParseHex(input, i, out_string, out_int) || tryParseDecimal(input, i, out_string, out_int);
+}
+
+// returns true if an integer value was parsed in the input at position i
+// updating i to the next char after the successful parse
+// and filling the value in out_val
+bool tryParseNextInt(const std::string& input, int& i, std::string& out_string, int& out_int) {
+    int resetI = i;
+    skipSpace(input, i);
+    if(!tryParseInt(input, i, out_string, out_int)) {
+        i = resetI;
+        return false;
+    } else {
+        return true;
+    }
+}
+
+// returns true if an integer value was parsed in the input at position i
+// updating i to the next char after the successful parse
+// and filling the value in out_val
+bool tryParseNextInt(const std::string& input, int& i, int& out_int) {
+    std::string _;
+    int resetI = i;
+    skipSpace(input, i);
+    if(!tryParseInt(input, i, _, out_int)) {
+        i = resetI;
+        return false;
+    } else {
+        return true;
+    }
+}
+
+// tries to fetch an address label in the format of '#mylabel'
+bool tryParseLabel(const std::string& input, int& i, std::string& out_label) {
+    int resetI = i;
+    if(!tryParseNextChar(input, i, '#') || !tryFetchNextToken(input, i, out_label)) {
+        i = resetI;
+        return false;
+    } else {
+        return true;
+    }
+}
+
+// returns true if there is a single-line comment in the input at position i
+// updating i to the end of the comment
+// filling out_comment with the comment
+bool tryParseSingleComment(const std::string& input, int& i, std::string& out_comment) {
+    int resetI = i;
+    if(!tryParseNextString(input, i, "//") && !tryParseNextString(input, i, ";")) {
+        i = resetI;
+        return false;
+    }
+    skipSpace(input, i);
+    out_comment = "";
+    while(i < input.size()) {
+        out_comment.push_back(input[i]);
+        ++i;
+    }
+    return true;
+}
+
+// returns a string with space padding of size n
+std::string getPadding(int n) {
+    std::string result;
+    while(n > 0) {
+        result.push_back(' ');
+        --n;
+    }
+    return result;
+}
+
+/* specify the high part or low part of a byte */
+enum BytePart {
+    byte_high,
+    byte_low,
+    byte_value      // the whole value, which must fit in a byte
+};
+
+class AddressPart {
+    public:
+    AddressPart() { }
+    AddressPart(std::string _label, BytePart _bytePart) : label(_label), bytePart(_bytePart) {
+        offset = 0;
+        macLine = -1;
+    }
+
+    AddressPart(std::string _label, BytePart _bytePart, int _offset) : label(_label), offset(_offset), bytePart(_bytePart) { }
+    std::string label;
+    int offset = 0;
+    int macLine = -1;
+    BytePart bytePart;
+
+    // set the machine code line
+    // returns true if the resulting macLine is possible 
+    // (i.e. it isn't negative and fits in two bytes (<=0xFFFF))
+    bool set(int _macLine) {
+        macLine = _macLine + offset;
+        return macLine < 0 || macLine > 0xFFFF;
+    }
+
+    // returns the machine code line after offset
+    int get() {
+        return macLine;
+    }
+
+    // returns the machine code byte which corresponds to this address part
+    int getByte() {
+        if(this->bytePart == byte_high) {
+            return getHighByte(this->macLine) & 0xFF;
+        } else {
+            return getLowByte(this->macLine) & 0xFF;
+        }
+    }
+
+    // return a new address part object pointer from a string
+    // returns null if not possible
+    static std::shared_ptr<AddressPart> tryParse(const std::string& input, int& i) {
+        int resetI = i;
+        auto addressPart = std::make_shared<AddressPart>();
+        if(!tryParseNextChar(input, i, '@') || !tryFetchNextToken(input, i, addressPart->label)) {
+            i = resetI;
+            return nullptr;
+        }
+
+        // parse the offset if possible
+        if(tryParseNextChar(input, i, '-')) {
+            if(!tryParseNextInt(input, i, addressPart->offset)) {
+                i = resetI;
+                return nullptr;
+            }
+            addressPart->offset *= -1;
+        } else if(tryParseNextChar(input, i, '+')) {
+            if(!tryParseNextInt(input, i, addressPart->offset)) {
+                i = resetI;
+                return nullptr;
+            }
+        } else {
+            addressPart->offset = 0;
+        }
+
+        if(!tryParseNextChar(input, i, '.')) {
+            i = resetI;
+            return nullptr;
+        }
+
+        if(tryParseNextChar(input, i, 'h') || tryParseNextChar(input, i, 'H')) {
+            addressPart->bytePart = byte_high;
+        } else if(tryParseNextChar(input, i, 'l') || tryParseNextChar(input, i, 'L')) {
+            addressPart->bytePart = byte_low;
+        } else {
+            i = resetI;
+            return nullptr;
+        }
+
+        return addressPart;
+    }
+
+    // returns the address label string
+    std::string toString() {
+        std::string result;
+        // TODO
+        result.push_back('@');
+        result.append(label);
+        if(offset > 0) {
+            result.push_back('+');
+            result.append(std::to_string(offset));
+        } else if(offset < 0) {
+            result.append(std::to_string(offset));
+        }
+        result.push_back('.');
+        if(bytePart == byte_high) {
+            result.push_back('H');
+        } else if(bytePart == byte_low) {
+            result.push_back('L');
+        }
+        return result;
+    }
+};
+
+// a full address, composed of a high byte part and a low byte part
+class Address {
+    public:
+    Address() {}
+    Address(std::string _label, BytePart _bytePart, int _offset) : label(_label), offset(_offset) { }
+
+    std::shared_ptr<AddressPart> highPart;
+    std::shared_ptr<AddressPart> lowPart;
+    std::string label;
+    int offset;
+
+    // sets the machine line number of this address
+    void set(int _macLineNum) {
+        highPart->set(_macLineNum);
+        lowPart->set(_macLineNum);
+    }
+
+    // returns a pointer to an address if successfully parsed,
+    // updating i to the char after a successful parse
+    // else return nullptr
+    static std::shared_ptr<Address> tryParse(const std::string& input, int& i) {
+        int resetI = i;
+        auto address = std::make_shared<Address>();
+        if(!tryParseNextChar(input, i, '@') || !tryFetchNextToken(input, i, address->label)) {
+            i = resetI;
+            return nullptr;
+        }
+
+        // parse the offset if possible
+        if(tryParseNextChar(input, i, '-')) {
+            if(!tryParseNextInt(input, i, address->offset)) {
+                i = resetI;
+                return nullptr;
+            }
+            address->offset *= -1;
+        } else if(tryParseNextChar(input, i, '+')) {
+            if(!tryParseNextInt(input, i, address->offset)) {
+                i = resetI;
+                return nullptr;
+            }
+        } else {
+            address->offset = 0;
+        }
+
+        address->highPart = std::make_shared<AddressPart>(address->label, byte_high, address->offset);
+        address->lowPart = std::make_shared<AddressPart>(address->label, byte_low, address->offset);
+        return address;
+    }
+
+    // returns this address as a string
+    std::string toString() {
+        std::string result;
+        // TODO
+        result.push_back('@');
+        result.append(label);
+        if(offset > 0) {
+            result.push_back('+');
+            result.append(std::to_string(offset));
+        } else if(offset < 0) {
+            result.append(std::to_string(offset));
+        }
+        return result;
+    }
+};
+
+// a map which resolves a given address to its integer machine code line
+class AddressMap {
+    private:
+    std::map<std::string, int> m;
+
+    public:
+    bool has(std::string s) {
+        return m.find(s) != m.end();
+    }
+    void set(std::string s, int n) {
+        m[s] = n;
+    }
+    int get(std::string s) {
+        return m[s];
+    }
+    std::map<std::string, int>& labels() {
+        return m;
+    }
+};
+
+/* operators of an assemble-time expression */
+enum ExprOp {
+    expr_value,     // a number, '@label' or .equ symbol
+    expr_neg,       // -a
+    expr_not,       // ~a
+    expr_mul,       // a * b
+    expr_div,       // a / b
+    expr_mod,       // a % b
+    expr_add,       // a + b
+    expr_sub,       // a - b
+    expr_shl,       // a << b
+    expr_shr,       // a >> b
+    expr_and,       // a & b
+    expr_xor,       // a ^ b
+    expr_or         // a | b
+};
+
+class SymbolMap;
+
+/*
+    an assemble-time constant expression, e.g. '(@end-@start)' or '((COUNT << 2) | 1)'
+    made of numbers, '@label' addresses, .equ symbols, parentheses and the C operators
+    - ~ * / % + - << >> & ^ |, with C precedence
+    evaluated once all labels are known
+*/
+class Expr {
+    public:
+    ExprOp op = expr_value;
+    int value = 0;
+    std::string label = "";
+    std::string symbol = "";
+    std::shared_ptr<Expr> left = nullptr;
+    std::shared_ptr<Expr> right = nullptr;
+
+    // evaluates the expression, filling out_val
+    // returns false and fills out_error if a label or symbol is unknown
+    bool eval(AddressMap& addressMap, SymbolMap& symbols, int& out_val, std::string& out_error, int depth = 0);
+
+    // adds the labels used in this expression to out_labels
+    void getLabels(std::vector<std::string>& out_labels) {
+        if(label != "") {
+            out_labels.push_back(label);
+        }
+        if(left != nullptr) {
+            left->getLabels(out_labels);
+        }
+        if(right != nullptr) {
+            right->getLabels(out_labels);
+        }
+    }
+
+    // returns a new expression from the input at position i, updating i to the char after it
+    // returns null if not possible
+    static std::shared_ptr<Expr> tryParse(const std::string& input, int& i) {
+        return tryParseBinary(input, i, 0);
+    }
+
+    private:
+    static std::shared_ptr<Expr> make(ExprOp op, std::shared_ptr<Expr> left, std::shared_ptr<Expr> right) {
+        auto expr = std::make_shared<Expr>();
+        expr->op = op;
+        expr->left = left;
+        expr->right = right;
+        return expr;
+    }
+
+    // tries to parse the binary operator of the given precedence level (0 binds loosest)
+    static bool tryParseOperator(const std::string& input, int& i, int level, ExprOp& out_op) {
+        switch(level) {
+            case 0: if(tryParseNextChar(input, i, '|')) { out_op = expr_or; return true; } break;
+            case 1: if(tryParseNextChar(input, i, '^')) { out_op = expr_xor; return true; } break;
+            case 2: if(tryParseNextChar(input, i, '&')) { out_op = expr_and; return true; } break;
+            case 3:
+                if(tryParseNextString(input, i, "<<")) { out_op = expr_shl; return true; }
+                if(tryParseNextString(input, i, ">>")) { out_op = expr_shr; return true; }
+                break;
+            case 4:
+                if(tryParseNextChar(input, i, '+')) { out_op = expr_add; return true; }
+                if(tryParseNextChar(input, i, '-')) { out_op = expr_sub; return true; }
+                break;
+            case 5:
+                if(tryParseNextChar(input, i, '*')) { out_op = expr_mul; return true; }
+                if(tryParseNextChar(input, i, '/')) { out_op = expr_div; return true; }
+                if(tryParseNextChar(input, i, '%')) { out_op = expr_mod; return true; }
+                break;
+        }
+        return false;
+    }
+
+    static std::shared_ptr<Expr> tryParseBinary(const std::string& input, int& i, int level) {
+        if(level > 5) {
+            return tryParseUnary(input, i);
+        }
+        int resetI = i;
+        auto left = tryParseBinary(input, i, level + 1);
+        if(left == nullptr) {
+            i = resetI;
+            return nullptr;
+        }
+        ExprOp op;
+        while(tryParseOperator(input, i, level, op)) {
+            auto right = tryParseBinary(input, i, level + 1);
+            if(right == nullptr) {
+                i = resetI;
+                return nullptr;
+            }
+            left = make(op, left, right);
+        }
+        return left;
+    }
+
+    static std::shared_ptr<Expr> tryParseUnary(const std::string& input, int& i) {
+        int resetI = i;
+        std::shared_ptr<Expr> operand;
+        if(tryParseNextChar(input, i, '-')) {
+            if((operand = tryParseUnary(input, i)) != nullptr) {
+                return make(expr_neg, operand, nullptr);
+            }
+        } else if(tryParseNextChar(input, i, '~')) {
+            if((operand = tryParseUnary(input, i)) != nullptr) {
+                return make(expr_not, operand, nullptr);
+            }
+        } else if(tryParseNextChar(input, i, '+')) {
+            if((operand = tryParseUnary(input, i)) != nullptr) {
+                return operand;
+            }
+        } else {
+            return tryParsePrimary(input, i);
+        }
+        i = resetI;
+        return nullptr;
+    }
+
+    static std::shared_ptr<Expr> tryParsePrimary(const std::string& input, int& i) {
+        int resetI = i;
+        auto expr = std::make_shared<Expr>();
+        std::string numString;
+        skipSpace(input, i);
+        if(tryParseNextChar(input, i, '(')) {
+            expr = tryParseBinary(input, i, 0);
+            if(expr != nullptr && tryParseNextChar(input, i, ')')) {
+                return expr;
+            }
+        } else if(tryParseNextChar(input, i, '@')) {
+            if(tryFetchNextToken(input, i, expr->label)) {
+                return expr;
+            }
+        } else if(i < input.size() && std::isdigit(input[i])) {
+            if(tryParseInt(input, i, numString, expr->value)) {
+                return expr;
+            }
+        } else if(tryFetchNextToken(input, i, expr->symbol)) {
+            return expr;
+        }
+        i = resetI;
+        return nullptr;
+    }
+};
+
+// a map of the .equ symbols to their expressions
+class SymbolMap {
+    private:
+    std::map<std::string, std::shared_ptr<Expr>> m;
+
+    public:
+    bool has(std::string s) {
+        return m.find(s) != m.end();
+    }
+    void set(std::string s, std::shared_ptr<Expr> expr) {
+        m[s] = expr;
+    }
+    std::shared_ptr<Expr> get(std::string s) {
+        return m[s];
+    }
+};
+
+bool Expr::eval(AddressMap& addressMap, SymbolMap& symbols, int& out_val, std::string& out_error, int depth) {
+    if(depth > 64) {
+        out_error = "expression too deeply nested, or a symbol refers to itself";
+        return false;
+    }
+
+    if(op == expr_value) {
+        if(label != "") {
+            if(!addressMap.has(label)) {
+                out_error = "unrecognized address label: '" + label + "'";
+                return false;
+            }
+            out_val = addressMap.get(label);
+        } else if(symbol != "") {
+            if(!symbols.has(symbol)) {
+                out_error = "unrecognized symbol: '" + symbol + "'";
+                return false;
+            }
+            return symbols.get(symbol)->eval(addressMap, symbols, out_val, out_error, depth + 1);
+        } else {
+            out_val = value;
+        }
+        return true;
+    }
+
+    int a = 0, b = 0;
+    if(!left->eval(addressMap, symbols, a, out_error, depth + 1)) {
+        return false;
+    }
+    if(right != nullptr && !right->eval(addressMap, symbols, b, out_error, depth + 1)) {
+        return false;
+    }
+    if((op == expr_shl || op == expr_shr) && (b < 0 || b > 31)) {
+        out_error = "shift count out of range 0..31: " + std::to_string(b);
+        return false;
+    }
+    // the arithmetic is done wider, so that a result which doesn't fit an int is found
+    long long wide = 0;
+    switch(op) {
+        case expr_neg: { wide = -(long long)a; break; }
+        case expr_mul: { wide = (long long)a * b; break; }
+        case expr_add: { wide = (long long)a + b; break; }
+        case expr_sub: { wide = (long long)a - b; break; }
+        case expr_shl: { wide = (long long)a * (1ll << b); break; }
+        case expr_div: { wide = b == 0 ? 0 : (long long)a / b; break; }
+        default: { break; }
+    }
+    if(wide < INT_MIN || wide > INT_MAX) {
+        out_error = "expression result out of range: " + std::to_string(wide);
+        return false;
+    }
+    switch(op) {
+        case expr_neg:
+        case expr_mul:
+        case expr_add:
+        case expr_sub:
+        case expr_shl: { out_val = (int)wide; break; }
+        case expr_not: { out_val = ~a; break; }
+        case expr_shr: { out_val = a >> b; break; }
+        case expr_and: { out_val = a & b; break; }
+        case expr_xor: { out_val = a ^ b; break; }
+        case expr_or: { out_val = a | b; break; }
+        case expr_div:
+        case expr_mod: {
+            if(b == 0) {
+                out_error = "division by zero";
+                return false;
+            }
+            out_val = op == expr_div ? (int)wide : (int)((long long)a % b);
+            break;
+        }
+        default: { break; }
+    }
+    return true;
+}
+
+// evaluates an expression which may not use address labels (e.g. a .rept count)
+// returns false and fills out_error if not possible
+bool evalConstant(std::shared_ptr<Expr> expr, SymbolMap& symbols, int& out_val, std::string& out_error) {
+    AddressMap noLabels;
+    std::vector<std::string> labels;
+    expr->getLabels(labels);
+    if(!labels.empty()) {
+        out_error = "expected a constant expression, but it uses address label: '" + labels.front() + "'";
+        return false;
+    }
+    return expr->eval(noLabels, symbols, out_val, out_error);
+}
+
+// returns true if the token is an operation name
+bool isOperationName(const std::string& token) {
+    for(int op = 0; op < op_count; op++) {
+        if(token == opName(op)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/*
+    a byte of machine code taken from an expression:
+    its high byte, low byte, or its whole value if it fits in a byte
+*/
+class ExprPart {
+    public:
+    ExprPart(std::shared_ptr<Expr> _expr, std::string _exprString, BytePart _bytePart) : expr(_expr), exprString(_exprString), bytePart(_bytePart) { }
+    std::shared_ptr<Expr> expr;
+    // the expression as written in the assembly
+    std::string exprString;
+    BytePart bytePart;
+
+    // evaluates the byte, returns false and fills out_error if not possible
+    bool tryGetByte(AddressMap& addressMap, SymbolMap& symbols, int& out_byte, std::string& out_error) {
+        int value;
+        if(!expr->eval(addressMap, symbols, value, out_error)) {
+            return false;
+        }
+        if(bytePart == byte_high) {
+            out_byte = getHighByte(value) & 0xFF;
+        } else if(bytePart == byte_low) {
+            out_byte = getLowByte(value) & 0xFF;
+        } else if(-0x80 <= value && value <= 0xFF) {
+            out_byte = value & 0xFF;
+        } else {
+            out_error = "expression value " + std::to_string(value) + " does not fit in 1 byte: '" + exprString + "'";
+            return false;
+        }
+        return true;
+    }
+
+    // tries to parse an expression starting with '(', '~' or '-(', or a .equ symbol,
+    // optionally followed by '.H' or '.L',
+    // filling out_bytePart with byte_value if there is no suffix
+    // returns the expression, or null if not possible
+    static std::shared_ptr<Expr> tryParse(const std::string& input, int& i, SymbolMap& symbols, std::string& out_exprString, BytePart& out_bytePart) {
+        int resetI = i;
+        std::shared_ptr<Expr> expr;
+        std::string token;
+        skipSpace(input, i);
+        int start = i;
+        // plain numbers are left to the number parsing, so that they keep their sizes
+        int j = i;
+        bool isExprStart = tryParseNextChar(input, j, '(') || tryParseNextChar(input, j, '~')
+            || (tryParseNextChar(input, j, '-') && tryParseNextChar(input, j, '('));
+        if(isExprStart) {
+            expr = Expr::tryParse(input, i);
+        } else if(tryFetchNextToken(input, i, token) && symbols.has(token)) {
+            expr = std::make_shared<Expr>();
+            expr->symbol = token;
+        }
+        if(expr == nullptr) {
+            i = resetI;
+            return nullptr;
+        }
+        out_exprString = input.substr(start, i - start);
+
+        int suffixI = i;
+        out_bytePart = byte_value;
+        if(tryParseNextChar(input, i, '.')) {
+            if(tryParseNextChar(input, i, 'h') || tryParseNextChar(input, i, 'H')) {
+                out_bytePart = byte_high;
+            } else if(tryParseNextChar(input, i, 'l') || tryParseNextChar(input, i, 'L')) {
+                out_bytePart = byte_low;
+            } else {
+                i = suffixI;
+            }
+        }
+        return expr;
+    }
+};
+
+// a line of assembly code, with the line number it came from in the source file
+class SourceLine {
+    public:
+    SourceLine(int _lineNum, std::string _text) : lineNum(_lineNum), text(_text) { }
+    int lineNum;
+    std::string text;
+};
+
+// a macro defined with '.macro name param1, param2' ... '.endm'
+class Macro {
+    public:
+    std::vector<std::string> params;
+    std::vector<SourceLine> body;
+};
+
+// returns the input with any single-line comment removed
+std::string stripComment(const std::string& input) {
+    for(int i = 0; i < input.size(); i++) {
+        if(input[i] == ';' || (input[i] == '/' && i+1 < input.size() && input[i+1] == '/')) {
+            return input.substr(0, i);
+        }
+    }
+    return input;
+}
+
+// returns the input without leading and trailing whitespace
+std::string trim(const std::string& input) {
+    int begin = 0;
+    int end = input.size();
+    while(begin < end && std::isspace(input[begin])) {
+        ++begin;
+    }
+    while(end > begin && std::isspace(input[end-1])) {
+        --end;
+    }
+    return input.substr(begin, end - begin);
+}
+
+// splits the input on commas, trimming each part
+std::vector<std::string> splitArgs(const std::string& input) {
+    std::vector<std::string> result;
+    if(trim(input) == "") {
+        return result;
+    }
+    std::string part;
+    for(const char& c : input) {
+        if(c == ',') {
+            result.push_back(trim(part));
+            part = "";
+        } else {
+            part.push_back(c);
+        }
+    }
+    result.push_back(trim(part));
+    return result;
+}
+
+// returns true if the input has the directive '.name' at position i
+// updating i to the char after it
+bool tryParseDirective(const std::string& input, int& i, const std::string& name) {
+    int resetI = i;
+    if(!tryParseNextChar(input, i, '.') || !tryParseNextToken(input, i, name)) {
+        i = resetI;
+        return false;
+    }
+    return true;
+}
+
+// replaces every occurrence of pattern in input with replacement
+std::string replaceAll(std::string input, const std::string& pattern, const std::string& replacement) {
+    size_t pos = 0;
+    while((pos = input.find(pattern, pos)) != std::string::npos) {
+        input.replace(pos, pattern.size(), replacement);
+        pos += replacement.size();
+    }
+    return input;
+}
+
+// returns the directory part of a path, or "" if it has none
+std::string directoryOf(const std::string& path) {
+    size_t slash = path.find_last_of('/');
+    return slash == std::string::npos ? "" : path.substr(0, slash);
+}
+
+/*
+    expands the assemble-time directives, so that the rest of the assembler only sees plain lines:
+    - '.equ NAME expr' defines a symbol usable in expressions and as an operand
+    - '.macro name p1, p2' ... '.endm' defines a macro, used as 'name a, b', where '\p1' and '\p2'
+      in the body are replaced with the arguments, and '\@' with a number unique to the expansion
+    - '.rept count' ... '.endr' repeats the lines in between count times
+    - '.fill count, value' places count bytes of value (0 if left out)
+    - '.include "file"' places the lines of file, looked for in each include directory and then
+      as named; a file is only placed once, so routines may include what they use
+    directive lines are kept as comments
+*/
+class Preprocessor {
+    public:
+    Preprocessor(SymbolMap& _symbols, std::ostream& _err) : symbols(_symbols), err(_err) { }
+
+    SymbolMap& symbols;
+    // where errors are written
+    std::ostream& err;
+    std::map<std::string, Macro> macros;
+    // the number of macro expansions so far, used for '\@'
+    int expansionCount = 0;
+    // the directories searched by .include
+    std::vector<std::string> includeDirs;
+    // the files included so far
+    std::set<std::string> included;
+
+    // the lines from the start of lines which place code, each at least a byte
+    static int countCodeLines(const std::vector<SourceLine>& lines, size_t start) {
+        int count = 0;
+        for(size_t n = start; n < lines.size(); n++) {
+            count += trim(stripComment(lines[n].text)) != "";
+        }
+        return count;
+    }
+
+    // returns true if a .rept or .fill count is one whose expansion may fit in memory, else
+    // writes an error
+    bool isCountInRange(const SourceLine& line, int count) {
+        if(count < 0 || count > IMAGE_SIZE) {
+            err << "Error on line [" << line.lineNum << "]: count out of range 0.." << IMAGE_SIZE << ": " << count << std::endl;
+            return false;
+        }
+        return true;
+    }
+
+    // expands the input lines into out, returns false after printing an error if not possible
+    bool run(const std::vector<SourceLine>& input, std::vector<SourceLine>& out, int depth = 0) {
+        if(depth > 64) {
+            err << "Error on line [" << (input.empty() ? 0 : input.front().lineNum) << "]: macro or .rept expansion too deep" << std::endl;
+            return false;
+        }
+
+        for(int n = 0; n < input.size(); n++) {
+            const SourceLine& line = input[n];
+            std::string code = stripComment(line.text);
+            std::string name, label;
+            int i = 0;
+
+            if(tryParseDirective(code, i, "equ")) {
+                std::shared_ptr<Expr> expr;
+                if(!tryFetchNextToken(code, i, name) || (expr = Expr::tryParse(code, i)) == nullptr || trim(code.substr(i)) != "") {
+                    err << "Error on line [" << line.lineNum << "]: expected '.equ NAME expression': '" << line.text << "'" << std::endl;
+                    return false;
+                } else if(isOperationName(name) || symbols.has(name)) {
+                    err << "Error on line [" << line.lineNum << "]: symbol already defined: '" << name << "'" << std::endl;
+                    return false;
+                }
+                symbols.set(name, expr);
+                out.push_back(SourceLine(line.lineNum, "; " + trim(line.text)));
+            } else if(tryParseDirective(code, i, "macro")) {
+                Macro macro;
+                if(!tryFetchNextToken(code, i, name)) {
+                    err << "Error on line [" << line.lineNum << "]: expected '.macro name params': '" << line.text << "'" << std::endl;
+                    return false;
+                } else if(isOperationName(name) || macros.find(name) != macros.end()) {
+                    err << "Error on line [" << line.lineNum << "]: macro already defined: '" << name << "'" << std::endl;
+                    return false;
+                }
+                macro.params = splitArgs(code.substr(i));
+                if(!collectBlock(input, n, "macro", "endm", macro.body)) {
+                    return false;
+                }
+                macros[name] = macro;
+                out.push_back(SourceLine(line.lineNum, "; .macro " + name));
+            } else if(tryParseDirective(code, i, "rept")) {
+                std::shared_ptr<Expr> expr = Expr::tryParse(code, i);
+                std::vector<SourceLine> body, expanded;
+                std::string error;
+                int count;
+                if(expr == nullptr || trim(code.substr(i)) != "") {
+                    err << "Error on line [" << line.lineNum << "]: expected '.rept count': '" << line.text << "'" << std::endl;
+                    return false;
+                } else if(!evalConstant(expr, symbols, count, error)) {
+                    err << "Error on line [" << line.lineNum << "]: " << error << std::endl;
+                    return false;
+                } else if(!isCountInRange(line, count) || !collectBlock(input, n, "rept", "endr", body)) {
+                    return false;
+                }
+                out.push_back(SourceLine(line.lineNum, "; " + trim(line.text)));
+                size_t start = out.size();
+                for(int k = 0; k < count; k++) {
+                    if(!run(body, out, depth + 1)) {
+                        return false;
+                    }
+                    // every repetition places as many lines of code as the first
+                    if(k == 0 && (long long)countCodeLines(out, start) * count > IMAGE_SIZE) {
+                        err << "Error on line [" << line.lineNum << "]: .rept expands to more code than fits in memory" << std::endl;
+                        return false;
+                    }
+                }
+            } else if(tryParseDirective(code, i, "fill")) {
+                std::vector<std::string> args = splitArgs(code.substr(i));
+                std::string error;
+                int count, at = 0;
+                std::shared_ptr<Expr> countExpr = args.size() >= 1 ? Expr::tryParse(args[0], at) : nullptr;
+                if(countExpr == nullptr || at != args[0].size() || args.size() > 2) {
+                    err << "Error on line [" << line.lineNum << "]: expected '.fill count, value': '" << line.text << "'" << std::endl;
+                    return false;
+                } else if(!evalConstant(countExpr, symbols, count, error)) {
+                    err << "Error on line [" << line.lineNum << "]: " << error << std::endl;
+                    return false;
+                } else if(!isCountInRange(line, count)) {
+                    return false;
+                }
+                std::string value = args.size() == 2 ? "(" + args[1] + ")" : "0";
+                out.push_back(SourceLine(line.lineNum, "; " + trim(line.text)));
+                for(int k = 0; k < count; k++) {
+                    out.push_back(SourceLine(line.lineNum, value));
+                }
+            } else if(tryParseDirective(code, i, "include")) {
+                std::string fileName = trim(code.substr(i));
+                if(fileName.size() >= 2 && fileName.front() == '"' && fileName.back() == '"') {
+                    fileName = fileName.substr(1, fileName.size() - 2);
+                }
+                std::string path;
+                std::ifstream file;
+                if(fileName.empty() || !tryOpenInclude(fileName, file, path)) {
+                    err << "Error on line [" << line.lineNum << "]: could not include '" << fileName << "'" << std::endl;
+                    return false;
+                }
+                out.push_back(SourceLine(line.lineNum, "; " + trim(line.text)));
+                if(!included.insert(path).second) {
+                    continue;
+                }
+                // the included lines are numbered as the .include line
+                std::vector<SourceLine> lines;
+                std::string text;
+                while(std::getline(file, text)) {
+                    lines.push_back(SourceLine(line.lineNum, text));
+                }
+                if(!run(lines, out, depth + 1)) {
+                    return false;
+                }
+            } else if(tryParseDirective(code, i, "endm") || tryParseDirective(code, i, "endr")) {
+                err << "Error on line [" << line.lineNum << "]: unexpected '" << trim(code) << "'" << std::endl;
+                return false;
+            } else if(isMacroUse(code, label, name, i)) {
+                Macro& macro = macros[name];
+                std::vector<std::string> args = splitArgs(code.substr(i));
+                if(args.size() != macro.params.size()) {
+                    err << "Error on line [" << line.lineNum << "]: macro '" << name << "' expects " << macro.params.size() << " arguments, received " << args.size() << std::endl;
+                    return false;
+                }
+                // longest names first, so that '\ab' is not replaced as '\a'
+                std::vector<std::pair<std::string, std::string>> substitutions;
+                for(int p = 0; p < args.size(); p++) {
+                    substitutions.push_back(std::make_pair("\\" + macro.params[p], args[p]));
+                }
+                std::sort(substitutions.begin(), substitutions.end(), [](const std::pair<std::string, std::string>& a, const std::pair<std::string, std::string>& b) {
+                    return a.first.size() > b.first.size();
+                });
+                ++expansionCount;
+                std::vector<SourceLine> body;
+                for(const auto& bodyLine : macro.body) {
+                    std::string text = bodyLine.text;
+                    for(const auto& substitution : substitutions) {
+                        text = replaceAll(text, substitution.first, substitution.second);
+                    }
+                    text = replaceAll(text, "\\@", std::to_string(expansionCount));
+                    body.push_back(SourceLine(line.lineNum, text));
+                }
+                // the label goes on its own line, so it marks the first byte of the expansion
+                if(label != "") {
+                    out.push_back(SourceLine(line.lineNum, "#" + label));
+                }
+                if(!run(body, out, depth + 1)) {
+                    return false;
+                }
+            } else {
+                out.push_back(line);
+            }
+        }
+        return true;
+    }
+
+    private:
+    // opens the file in the first include directory which has it, or as named, filling its path
+    bool tryOpenInclude(const std::string& fileName, std::ifstream& out_file, std::string& out_path) {
+        std::vector<std::string> paths;
+        if(fileName.front() != '/') {
+            for(const auto& dir : includeDirs) {
+                paths.push_back(dir.empty() ? fileName : dir + "/" + fileName);
+            }
+        }
+        paths.push_back(fileName);
+        for(const auto& path : paths) {
+            out_file.open(path);
+            if(out_file.is_open()) {
+                out_path = path;
+                return true;
+            }
+            out_file.clear();
+        }
+        return false;
+    }
+
+    // returns true if the line is a macro use, optionally labelled,
+    // filling the label and macro name, and updating i to the char after the name
+    bool isMacroUse(const std::string& code, std::string& out_label, std::string& out_name, int& i) {
+        i = 0;
+        out_label = "";
+        tryParseLabel(code, i, out_label);
+        return tryFetchNextToken(code, i, out_name) && macros.find(out_name) != macros.end();
+    }
+
+    // collects the lines after input[n] up to the matching '.end' directive into out_body,
+    // updating n to the index of the end directive
+    bool collectBlock(const std::vector<SourceLine>& input, int& n, const std::string& begin, const std::string& end, std::vector<SourceLine>& out_body) {
+        int startLine = input[n].lineNum;
+        int nesting = 1;
+        for(++n; n < input.size(); n++) {
+            std::string code = stripComment(input[n].text);
+            int i = 0;
+            if(tryParseDirective(code, i, begin)) {
+                ++nesting;
+            } else if(tryParseDirective(code, i, end) && --nesting == 0) {
+                return true;
+            }
+            out_body.push_back(input[n]);
+        }
+        err << "Error on line [" << startLine << "]: '." << begin << "' without '." << end << "'" << std::endl;
+        return false;
+    }
+};
+
+/*
+    a mac line is a line of resultant machine code
+    with a machine code byte (-1 for comments),
+    a line number
+    an assembly code line
+    an optional address label,
+    an optional comment
+    an address-part specifier pointer which,
+        if filled, is used to dereference an address after partial assembly
+*/
+class MacLine {
+    public:
+    MacLine(int _assemLineNum) : assemLineNum(_assemLineNum) { }
+    MacLine(int _assemLineNum, int _byte, std::string _assemString) : assemLineNum(_assemLineNum), byte(_byte & 0xFF), assemString(_assemString) { }
+    MacLine(int _assemLineNum, int _byte, std::string _assemString, std::shared_ptr<AddressPart> _addressRef)
+        : assemLineNum(_assemLineNum), byte(_byte & 0xFF), assemString(_assemString), addressRef(_addressRef) { }
+
+    // the line number which corresponds to the assembly code
+    int assemLineNum;
+    // the machine code line number (this is unique)
+    int macLineNum;
+    // the machine code byte, or -1 if this line only holds a comment
+    int byte = -1;
+    // the opcode if this byte is an operation, else -1 for operands and data
+    int op = -1;
+    std::string assemString = "";
+    std::string addressLabel = "";
+    std::string comment = "";
+    std::shared_ptr<AddressPart> addressRef = nullptr;
+    // if filled, the byte is taken from an expression after partial assembly
+    std::shared_ptr<ExprPart> exprRef = nullptr;
+    // returns the line as written in a .mac listing
+    // hexLineNumber - if true, start lines with machine code with their line number in hex
+    std::string toString(bool hexLineNumber) {
+        std::string result;
+        if(byte >= 0 && hexLineNumber) {
+            result.append(intToFourHex(macLineNum) + " ");
+        }
+        if(byte >= 0) {
+            result.append(num2macString(byte));
+        }
+        if(assemString != "") {
+            result.append(" " + assemString);
+        }
+        if(addressLabel != "") {
+            result.append(" #" + addressLabel);
+        }
+        if(comment != "") {
+            result.append(" ; " + comment);
+        }
+        return result;
+    }
+};
+
+// a queue of machine code lines
+class MacQueue {
+    private:
+    std::queue<std::shared_ptr<MacLine>> codeQueue;
+
+    public:
+    std::shared_ptr<MacLine> push(int assemLineNum) {
+        auto macLine = std::make_shared<MacLine>(assemLineNum);
+        return this->push(macLine);
+    }
+    std::shared_ptr<MacLine> push(int assemLineNum, int byte, std::string assemString) {
+        auto macLine = std::make_shared<MacLine>(assemLineNum, byte, assemString);
+        return this->push(macLine);
+    }
+
+    std::shared_ptr<MacLine> push(int assemLineNum, int byte, std::string assemString, std::shared_ptr<AddressPart> addressPart) {
+        auto macLine = std::make_shared<MacLine>(assemLineNum, byte, assemString, addressPart);
+        return this->push(macLine);
+    }
+    
+    std::shared_ptr<MacLine> push(std::shared_ptr<MacLine> macLine) {
+        codeQueue.push(macLine);
+        return macLine;
+    }
+
+    bool empty() {
+        return codeQueue.empty();
+    }
+
+    void pop() {
+        codeQueue.pop();
+    }
+
+    std::shared_ptr<MacLine> front() {
+        return codeQueue.front();
+    }
+};
+
+// an instruction in the assembled machine code:
+// an operation with its operand bytes, or a single data byte (op = -1)
+class Instruction {
+    public:
+    Instruction(int _op, int _address, int _size) : op(_op), address(_address), size(_size) { }
+    int op;
+    // the machine code line of the first byte
+    int address;
+    int size;
+    // set to false once removed by the optimizer
+    bool alive = true;
+};
+
+// totals of the work removed by the optimizer
+class OptimizeStats {
+    public:
+    int bytesSaved = 0;
+    int cyclesSaved = 0;
+    int rewrites = 0;
+};
+
+// returns the lines with machine code, indexed by machine code line
+std::vector<std::shared_ptr<MacLine>> getByteLines(const std::vector<std::shared_ptr<MacLine>>& macLines) {
+    std::vector<std::shared_ptr<MacLine>> byteLines;
+    for(const auto& macLine : macLines) {
+        if(macLine->byte >= 0) {
+            byteLines.push_back(macLine);
+        }
+    }
+    return byteLines;
+}
+
+// splits the machine code into instructions and data bytes
+std::vector<Instruction> getInstructions(const std::vector<std::shared_ptr<MacLine>>& byteLines) {
+    std::vector<Instruction> instructions;
+    for(int address = 0; address < byteLines.size();) {
+        int op = byteLines[address]->op;
+        if(op >= 0 && address + opSize(op) > byteLines.size()) {
+            op = -1;
+        }
+        int n = op >= 0 ? opSize(op) : 1;
+        instructions.push_back(Instruction(op, address, n));
+        address += n;
+    }
+    return instructions;
+}
+
+// returns true if the 2 operand bytes of the instruction are the high and low part of the same address reference
+bool hasAddressOperand(std::vector<std::shared_ptr<MacLine>>& byteLines, const Instruction& ins) {
+    if(ins.size != 3) {
+        return false;
+    }
+    auto high = byteLines[ins.address+1]->addressRef;
+    auto low = byteLines[ins.address+2]->addressRef;
+    return high != nullptr && low != nullptr && high->bytePart == byte_high && low->bytePart == byte_low
+        && high->label == low->label && high->offset == low->offset;
+}
+
+// returns true if the 2 operand bytes of the instruction are constants
+bool hasConstOperand(std::vector<std::shared_ptr<MacLine>>& byteLines, const Instruction& ins) {
+    for(int a = ins.address+1; a < ins.address + ins.size; a++) {
+        if(byteLines[a]->addressRef != nullptr || byteLines[a]->exprRef != nullptr) {
+            return false;
+        }
+    }
+    return ins.size == 3;
+}
+
+// returns the address the operand of the instruction refers to, or -1 if unknown
+int getOperandAddress(std::vector<std::shared_ptr<MacLine>>& byteLines, AddressMap& addressMap, const Instruction& ins) {
+    if(hasConstOperand(byteLines, ins)) {
+        return (byteLines[ins.address+1]->byte << 8) | byteLines[ins.address+2]->byte;
+    } else if(hasAddressOperand(byteLines, ins)) {
+        auto ref = byteLines[ins.address+1]->addressRef;
+        if(!addressMap.has(ref->label)) {
+            return -1;
+        }
+        return addressMap.get(ref->label) + ref->offset;
+    }
+    return -1;
+}
+
+// returns true if both instructions have the same 2 byte operand
+bool hasSameOperand(std::vector<std::shared_ptr<MacLine>>& byteLines, const Instruction& a, const Instruction& b) {
+    if(hasConstOperand(byteLines, a) && hasConstOperand(byteLines, b)) {
+        return byteLines[a.address+1]->byte == byteLines[b.address+1]->byte
+            && byteLines[a.address+2]->byte == byteLines[b.address+2]->byte;
+    } else if(hasAddressOperand(byteLines, a) && hasAddressOperand(byteLines, b)) {
+        auto refA = byteLines[a.address+1]->addressRef;
+        auto refB = byteLines[b.address+1]->addressRef;
+        return refA->label == refB->label && refA->offset == refB->offset;
+    }
+    return false;
+}
+
+// returns the index of the first instruction which is still alive at or after k
+int nextAlive(std::vector<Instruction>& instructions, int k) {
+    while(k < instructions.size() && !instructions[k].alive) {
+        ++k;
+    }
+    return k;
+}
+
+// returns true if instruction k can be entered other than by falling through from the previous
+// instruction, checking the labels of removed instructions just before it as these now point to k
+bool isEntered(std::vector<Instruction>& instructions, std::vector<bool>& isEntry, int k) {
+    if(isEntry[instructions[k].address]) {
+        return true;
+    }
+    for(int j = k-1; j >= 0 && !instructions[j].alive; j--) {
+        if(isEntry[instructions[j].address]) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// returns true if any byte of the instruction is referenced as data
+bool isPinned(std::vector<bool>& pinned, const Instruction& ins) {
+    for(int a = ins.address; a < ins.address + ins.size; a++) {
+        if(pinned[a]) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// returns true if the operand bytes of the instruction are referenced as data, as the return
+// jump of a routine is, its callers writing where it goes: its operand is then not an address
+bool isOperandData(std::vector<bool>& pinned, const Instruction& ins) {
+    for(int a = ins.address+1; a < ins.address + ins.size; a++) {
+        if(pinned[a]) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// returns the address into the program of size bytes which the instruction's constant operand
+// refers to, or -1 if it has none (or its operand is data, as isOperandData)
+int getAbsoluteAddress(std::vector<std::shared_ptr<MacLine>>& byteLines, AddressMap& addressMap, std::vector<bool>& pinned, const Instruction& ins, int size) {
+    if(!hasConstOperand(byteLines, ins) || isOperandData(pinned, ins)) {
+        return -1;
+    }
+    int target = getOperandAddress(byteLines, addressMap, ins);
+    return target < size ? target : -1;
+}
+
+// returns the new machine code line of an old one after optimization,
+// a removed line moves on to the next line which is kept
+int relocate(std::vector<int>& newAddress, int removed, int address) {
+    if(address < 0) {
+        return address;
+    } else if(address < newAddress.size()) {
+        return newAddress[address];
+    } else {
+        return address - removed;
+    }
+}
+
+/*
+    rewrite rules for the optimizer, one per line, as written by superopt:
+        pushimm 0x00; add => when flags dead    # cycles 10 -> 0, bytes 3 -> 0
+    each side is a list of straight-line instructions separated by ';', and may be empty. pushimm
+    takes a byte or a parameter K1, K2.. standing for any byte; pushext and popext take a variable
+    A, B.. standing for any address below the PSW (variables may name the same address). a rule
+    ending in 'when flags dead' leaves other flags, so it is only applied where the PSW is written
+    before it is next read
+*/
+enum RuleOperand {
+    rule_none,
+    rule_byte,
+    rule_param,
+    rule_variable
+};
+
+class RuleInstruction {
+    public:
+    int op = op_noop;
+    RuleOperand operand = rule_none;
+    // the byte, or the index of the parameter or variable
+    int value = 0;
+};
+
+class RewriteRule {
+    public:
+    std::vector<RuleInstruction> lhs;
+    std::vector<RuleInstruction> rhs;
+    bool isFlagsDead = false;
+
+    int bytes(const std::vector<RuleInstruction>& side) const {
+        int total = 0;
+        for(const auto& ins : side) {
+            total += opSize(ins.op);
+        }
+        return total;
+    }
+    int cycles(const std::vector<RuleInstruction>& side) const {
+        int total = 0;
+        for(const auto& ins : side) {
+            total += opCycles(ins.op);
+        }
+        return total;
+    }
+};
+
+// returns the instruction as written in a rule, e.g. 'pushimm K1'
+std::string ruleInstructionToString(const RuleInstruction& ins) {
+    std::string result = opName(ins.op);
+    if(ins.operand == rule_byte) {
+        result += " 0x" + byte2hex(ins.value);
+    } else if(ins.operand == rule_param) {
+        result += " K" + std::to_string(ins.value + 1);
+    } else if(ins.operand == rule_variable) {
+        result += " ";
+        result.push_back('A' + ins.value);
+    }
+    return result;
+}
+
+// returns the rule as a line of a rules file, without its comment
+std::string ruleToString(const RewriteRule& rule) {
+    std::string result;
+    for(int i = 0; i < rule.lhs.size(); i++) {
+        result += (i > 0 ? "; " : "") + ruleInstructionToString(rule.lhs[i]);
+    }
+    result += " =>";
+    for(int i = 0; i < rule.rhs.size(); i++) {
+        result += (i > 0 ? "; " : " ") + ruleInstructionToString(rule.rhs[i]);
+    }
+    if(rule.isFlagsDead) {
+        result += " when flags dead";
+    }
+    return result;
+}
+
+// parses one side of a rule
+// returns false and fills out_error if it isn't a list of straight-line instructions
+bool tryParseRuleSide(const std::string& input, std::vector<RuleInstruction>& out_side, std::string& out_error) {
+    if(trim(input) == "") {
+        return true;
+    }
+    std::stringstream parts(input);
+    std::string part;
+    while(std::getline(parts, part, ';')) {
+        std::stringstream words(trim(part));
+        std::string name, operand, rest;
+        words >> name >> operand >> rest;
+        RuleInstruction ins;
+        ins.op = -1;
+        for(int op = 0; op < op_count; op++) {
+            if(opName(op) == name) {
+                ins.op = op;
+            }
+        }
+        if(ins.op != op_pushimm && ins.op != op_pushext && ins.op != op_popext && ins.op != op_popinh
+            && ins.op != op_add && ins.op != op_sub && ins.op != op_nor && ins.op != op_noop) {
+            out_error = "'" + name + "' is not a straight-line instruction";
+            return false;
+        }
+        int i = 0;
+        int value;
+        if(rest != "") {
+            out_error = "unexpected '" + rest + "'";
+            return false;
+        } else if(opSize(ins.op) == 1) {
+            if(operand != "") {
+                out_error = name + " takes no operand";
+                return false;
+            }
+        } else if(ins.op == op_pushimm && operand.size() >= 2 && operand[0] == 'K' && tryParseNextInt(operand.substr(1), i, value) && value >= 1) {
+            ins.operand = rule_param;
+            ins.value = value - 1;
+        } else if(ins.op == op_pushimm && tryParseNextInt(operand, i, value) && i == operand.size() && value >= -128 && value <= 0xFF) {
+            ins.operand = rule_byte;
+            ins.value = value & 0xFF;
+        } else if(ins.op != op_pushimm && operand.size() == 1 && operand[0] >= 'A' && operand[0] <= 'Z') {
+            ins.operand = rule_variable;
+            ins.value = operand[0] - 'A';
+        } else {
+            out_error = "bad operand '" + operand + "' for " + name;
+            return false;
+        }
+        out_side.push_back(ins);
+    }
+    return true;
+}
+
+// reads rewrite rules, one per line, with '#' starting a comment
+// returns false and writes the errors to err if any line isn't a rule which saves bytes or cycles
+bool tryReadRules(std::istream& is, std::vector<RewriteRule>& out_rules, std::ostream& err) {
+    const std::string flagsDead = "when flags dead";
+    bool ok = true;
+    std::string line;
+    for(int lineNum = 1; std::getline(is, line); lineNum++) {
+        line = trim(line.substr(0, line.find('#')));
+        if(line == "") {
+            continue;
+        }
+        RewriteRule rule;
+        if(line.size() >= flagsDead.size() && line.compare(line.size() - flagsDead.size(), flagsDead.size(), flagsDead) == 0) {
+            rule.isFlagsDead = true;
+            line = line.substr(0, line.size() - flagsDead.size());
+        }
+        size_t arrow = line.find("=>");
+        std::string error;
+        if(arrow == std::string::npos) {
+            error = "expected 'lhs => rhs'";
+        } else if(tryParseRuleSide(line.substr(0, arrow), rule.lhs, error) && tryParseRuleSide(line.substr(arrow + 2), rule.rhs, error)) {
+            // the replacement may only use what the pattern binds
+            std::set<std::pair<int, int>> bound;
+            for(const auto& ins : rule.lhs) {
+                bound.insert({ ins.operand, ins.value });
+            }
+            for(const auto& ins : rule.rhs) {
+                if((ins.operand == rule_param || ins.operand == rule_variable) && bound.count({ ins.operand, ins.value }) == 0) {
+                    error = "'" + ruleInstructionToString(ins) + "' uses an operand the pattern doesn't bind";
+                }
+            }
+            int lhsBytes = rule.bytes(rule.lhs), rhsBytes = rule.bytes(rule.rhs);
+            int lhsCycles = rule.cycles(rule.lhs), rhsCycles = rule.cycles(rule.rhs);
+            if(rule.lhs.empty()) {
+                error = "empty pattern";
+            } else if(rhsBytes > lhsBytes || rhsCycles > lhsCycles || (rhsBytes == lhsBytes && rhsCycles == lhsCycles)) {
+                error = "the replacement saves neither bytes nor cycles";
+            }
+        }
+        if(error != "") {
+            err << "Error on rules line [" << lineNum << "]: " << error << std::endl;
+            ok = false;
+            continue;
+        }
+        out_rules.push_back(rule);
+    }
+    return ok;
+}
+
+// returns true if the PSW is written before it can be read, after instruction k
+// scanning forward only through instructions which neither branch nor touch the memory map
+bool areFlagsDead(std::vector<std::shared_ptr<MacLine>>& byteLines, AddressMap& addressMap, std::vector<Instruction>& instructions, std::vector<bool>& pinned, int k) {
+    for(k = nextAlive(instructions, k+1); k < instructions.size(); k = nextAlive(instructions, k+1)) {
+        const Instruction& ins = instructions[k];
+        if(isPinned(pinned, ins)) {
+            return false;
+        }
+        if(ins.op == op_add || ins.op == op_sub) {
+            return true;
+        }
+        if(ins.op == op_pushext || ins.op == op_popext) {
+            int address = getOperandAddress(byteLines, addressMap, ins);
+            if(address < 0 || address >= map_PSW) {
+                return false;
+            }
+        } else if(ins.op != op_noop && ins.op != op_pushimm && ins.op != op_popinh && ins.op != op_nor) {
+            return false;
+        }
+    }
+    return false;
+}
+
+// rewrites the instructions from k if they match the rule, in place: the replacement is written
+// over the bytes of the pattern, each of its instructions within one of the pattern's, and
+// the bytes left over are removed
+// returns true if it did
+bool tryApplyRule(const RewriteRule& rule, std::vector<std::shared_ptr<MacLine>>& byteLines, AddressMap& addressMap,
+    std::vector<Instruction>& instructions, std::vector<int>& instructionAt, std::vector<bool>& isEntry, std::vector<bool>& pinned, int k) {
+    // the instructions matched, and what the parameters and variables are bound to
+    std::vector<int> window;
+    std::map<int, int> params;
+    std::map<int, int> variables;
+    for(int i = k; window.size() < rule.lhs.size(); i = nextAlive(instructions, i+1)) {
+        if(i >= instructions.size()) {
+            return false;
+        }
+        const Instruction& ins = instructions[i];
+        const RuleInstruction& pattern = rule.lhs[window.size()];
+        if(ins.op != pattern.op || isPinned(pinned, ins) || (!window.empty() && isEntered(instructions, isEntry, i))) {
+            return false;
+        }
+        if(pattern.operand == rule_byte || pattern.operand == rule_param) {
+            auto operand = byteLines[ins.address+1];
+            if(operand->addressRef != nullptr || operand->exprRef != nullptr) {
+                return false;
+            }
+            if(pattern.operand == rule_byte && operand->byte != pattern.value) {
+                return false;
+            }
+            if(pattern.operand == rule_param && params.count(pattern.value) != 0 && params[pattern.value] != operand->byte) {
+                return false;
+            }
+            params[pattern.value] = operand->byte;
+        } else if(pattern.operand == rule_variable) {
+            int address = getOperandAddress(byteLines, addressMap, ins);
+            if(address < 0 || address >= map_PSW) {
+                return false;
+            }
+            if(variables.count(pattern.value) != 0 && !hasSameOperand(byteLines, instructions[variables[pattern.value]], ins)) {
+                return false;
+            }
+            variables[pattern.value] = i;
+        }
+        window.push_back(i);
+    }
+    if(rule.isFlagsDead && !areFlagsDead(byteLines, addressMap, instructions, pinned, window.back())) {
+        return false;
+    }
+
+    // place the replacement, and take the operand lines it copies before any are written over
+    std::vector<Instruction> placed;
+    std::vector<int> slots;
+    int slot = 0, used = 0;
+    for(const auto& ins : rule.rhs) {
+        while(slot < window.size() && used + opSize(ins.op) > instructions[window[slot]].size) {
+            slot++;
+            used = 0;
+        }
+        if(slot == window.size()) {
+            return false;
+        }
+        placed.push_back(Instruction(ins.op, instructions[window[slot]].address + used, opSize(ins.op)));
+        slots.push_back(slot);
+        used += opSize(ins.op);
+    }
+    std::map<int, std::vector<MacLine>> operandLines;
+    for(const auto& variable : variables) {
+        const Instruction& ins = instructions[variable.second];
+        operandLines[variable.first] = { *byteLines[ins.address+1], *byteLines[ins.address+2] };
+    }
+
+    for(int j = 0; j < placed.size(); j++) {
+        const RuleInstruction& ins = rule.rhs[j];
+        auto opLine = byteLines[placed[j].address];
+        opLine->byte = ins.op;
+        opLine->op = ins.op;
+        opLine->assemString = opName(ins.op);
+        opLine->addressRef = nullptr;
+        opLine->exprRef = nullptr;
+        if(ins.op == op_pushimm) {
+            auto operand = byteLines[placed[j].address+1];
+            operand->byte = ins.operand == rule_param ? params[ins.value] : ins.value;
+            operand->op = -1;
+            operand->assemString = "0x" + byte2hex(operand->byte);
+            operand->addressRef = nullptr;
+            operand->exprRef = nullptr;
+        } else if(ins.op == op_pushext || ins.op == op_popext) {
+            for(int i = 1; i <= 2; i++) {
+                const MacLine& source = operandLines[ins.value][i-1];
+                auto operand = byteLines[placed[j].address+i];
+                operand->byte = source.byte;
+                operand->op = -1;
+                operand->assemString = source.assemString;
+                operand->addressRef = source.addressRef != nullptr ? std::make_shared<AddressPart>(*source.addressRef) : nullptr;
+                operand->exprRef = nullptr;
+            }
+        }
+    }
+
+    // each slot becomes its placed instructions, then the bytes left over, removed
+    std::vector<Instruction> replacement;
+    for(int s = 0; s < window.size(); s++) {
+        const Instruction& old = instructions[window[s]];
+        int end = old.address;
+        for(int j = 0; j < placed.size(); j++) {
+            if(slots[j] == s) {
+                replacement.push_back(placed[j]);
+                end = placed[j].address + placed[j].size;
+            }
+        }
+        if(end < old.address + old.size) {
+            Instruction leftover(-1, end, old.address + old.size - end);
+            leftover.alive = false;
+            replacement.push_back(leftover);
+        }
+    }
+    // the window may have removed instructions between its own, which stay where they are
+    std::vector<Instruction> rewritten(instructions.begin(), instructions.begin() + k);
+    int next = 0;
+    for(int i = k; i <= window.back(); i++) {
+        if(std::find(window.begin(), window.end(), i) == window.end()) {
+            rewritten.push_back(instructions[i]);
+            continue;
+        }
+        while(next < replacement.size() && replacement[next].address < instructions[i].address + instructions[i].size) {
+            rewritten.push_back(replacement[next++]);
+        }
+    }
+    rewritten.insert(rewritten.end(), instructions.begin() + window.back() + 1, instructions.end());
+    instructions = rewritten;
+    std::fill(instructionAt.begin(), instructionAt.end(), -1);
+    for(int i = 0; i < instructions.size(); i++) {
+        instructionAt[instructions[i].address] = i;
+    }
+    return true;
+}
+
+/*
+    peephole optimizer over the assembled mac lines, run before address references are resolved:
+    - removes noops
+    - removes 'pushext X; popext X' round-trips, unless X is memory mapped
+    - removes 'pushimm k; popinh' pairs
+    - retargets jumps which land on a jump of the same kind to the final target
+    - applies the rewrite rules given, e.g. those mined by superopt
+    labels and address references are relocated to the shifted machine code lines.
+    instructions referenced as data (e.g. by self-modifying code) are left as they are, and
+    constant addresses into the program are relocated unless they are data themselves (the
+    operand of a return jump, written by its callers)
+    warnings are written to err
+*/
+void optimize(std::vector<std::shared_ptr<MacLine>>& macLines, AddressMap& addressMap, SymbolMap& symbols, const std::vector<RewriteRule>& rules, OptimizeStats& stats, std::ostream& err) {
+    std::vector<std::shared_ptr<MacLine>> byteLines = getByteLines(macLines);
+    int size = byteLines.size();
+    std::vector<Instruction> instructions = getInstructions(byteLines);
+    // the index of the instruction starting at each machine code line, or -1
+    std::vector<int> instructionAt(size, -1);
+    for(int k = 0; k < instructions.size(); k++) {
+        instructionAt[instructions[k].address] = k;
+    }
+
+    // addresses which are labelled or jumped to
+    std::vector<bool> isEntry(size, false);
+    // addresses which are referenced as data
+    std::vector<bool> pinned(size, false);
+    for(const auto& label : addressMap.labels()) {
+        if(0 <= label.second && label.second < size) {
+            isEntry[label.second] = true;
+        }
+    }
+    for(const auto& ins : instructions) {
+        if((ins.op == op_jnz || ins.op == op_jnn) && hasAddressOperand(byteLines, ins)) {
+            int target = getOperandAddress(byteLines, addressMap, ins);
+            if(0 <= target && target < size) {
+                isEntry[target] = true;
+            }
+            continue;
+        }
+        for(int a = ins.address; a < ins.address + ins.size; a++) {
+            auto ref = byteLines[a]->addressRef;
+            if(ref != nullptr && addressMap.has(ref->label)) {
+                int target = addressMap.get(ref->label) + ref->offset;
+                if(0 <= target && target < size) {
+                    pinned[target] = true;
+                }
+            }
+            // expressions may point anywhere near the labels they use, so pin the labels and
+            // the value, as far as it can be told before optimizing
+            auto exprRef = byteLines[a]->exprRef;
+            if(exprRef != nullptr) {
+                std::vector<std::string> labels;
+                exprRef->expr->getLabels(labels);
+                for(const auto& label : labels) {
+                    if(addressMap.has(label) && addressMap.get(label) < size) {
+                        pinned[addressMap.get(label)] = true;
+                    }
+                }
+                int value;
+                std::string error;
+                if(exprRef->expr->eval(addressMap, symbols, value, error) && 0 <= value && value < size && !labels.empty()) {
+                    pinned[value] = true;
+                }
+            }
+        }
+    }
+
+    // constant operands into the program are addresses as labels are, once the operands which are
+    // data are known, and are relocated with them
+    for(const auto& ins : instructions) {
+        int target = getAbsoluteAddress(byteLines, addressMap, pinned, ins, size);
+        if(target < 0) {
+            continue;
+        } else if(ins.op == op_jnz || ins.op == op_jnn) {
+            isEntry[target] = true;
+        } else {
+            pinned[target] = true;
+        }
+    }
+
+    bool changed = true;
+    while(changed) {
+        changed = false;
+        for(int k = nextAlive(instructions, 0); k < instructions.size(); k = nextAlive(instructions, k+1)) {
+            Instruction& a = instructions[k];
+            if(isPinned(pinned, a)) {
+                continue;
+            }
+
+            if(a.op == op_noop) {
+                a.alive = false;
+                stats.cyclesSaved += opCycles(op_noop);
+                ++stats.rewrites;
+                changed = true;
+                continue;
+            }
+
+            if(a.op == op_jnz || a.op == op_jnn) {
+                int target = getOperandAddress(byteLines, addressMap, a);
+                if(target < 0 || target >= size || instructionAt[target] < 0 || !hasAddressOperand(byteLines, a)) {
+                    continue;
+                }
+                int t = nextAlive(instructions, instructionAt[target]);
+                if(t == k || t >= instructions.size()) {
+                    continue;
+                }
+                Instruction& b = instructions[t];
+                // (not through a jump whose bytes are data: the program may write where it goes)
+                if(b.op != a.op || isPinned(pinned, b) || !hasAddressOperand(byteLines, b) || hasSameOperand(byteLines, a, b)) {
+                    continue;
+                }
+                // retarget to the target of the second jump
+                for(int i = 1; i <= 2; i++) {
+                    auto ref = std::make_shared<AddressPart>(*byteLines[b.address+i]->addressRef);
+                    byteLines[a.address+i]->addressRef = ref;
+                    byteLines[a.address+i]->assemString = ref->toString();
+                }
+                stats.cyclesSaved += opCycles(a.op);
+                ++stats.rewrites;
+                changed = true;
+                continue;
+            }
+
+            const RewriteRule* applied = nullptr;
+            for(const auto& rule : rules) {
+                if(tryApplyRule(rule, byteLines, addressMap, instructions, instructionAt, isEntry, pinned, k)) {
+                    applied = &rule;
+                    break;
+                }
+            }
+            if(applied != nullptr) {
+                stats.cyclesSaved += applied->cycles(applied->lhs) - applied->cycles(applied->rhs);
+                ++stats.rewrites;
+                changed = true;
+                continue;
+            }
+
+            int next = nextAlive(instructions, k+1);
+            if(next >= instructions.size()) {
+                continue;
+            }
+            Instruction& b = instructions[next];
+            if(isPinned(pinned, b) || isEntered(instructions, isEntry, next)) {
+                continue;
+            }
+
+            bool isRoundTrip = a.op == op_pushext && b.op == op_popext && hasSameOperand(byteLines, a, b)
+                && getOperandAddress(byteLines, addressMap, a) >= 0 && getOperandAddress(byteLines, addressMap, a) < map_PSW;
+            bool isPushPop = a.op == op_pushimm && b.op == op_popinh;
+            if(isRoundTrip || isPushPop) {
+                a.alive = false;
+                b.alive = false;
+                stats.cyclesSaved += opCycles(a.op) + opCycles(b.op);
+                ++stats.rewrites;
+                changed = true;
+            }
+        }
+    }
+
+    // find the new machine code line for each old one
+    std::vector<bool> byteAlive(size, true);
+    for(const auto& ins : instructions) {
+        for(int a = ins.address; a < ins.address + ins.size; a++) {
+            byteAlive[a] = ins.alive;
+        }
+    }
+    std::vector<int> newAddress(size + 1);
+    int removed = 0;
+    for(int a = 0; a < size; a++) {
+        newAddress[a] = a - removed;
+        if(!byteAlive[a]) {
+            ++removed;
+        }
+    }
+    newAddress[size] = size - removed;
+    stats.bytesSaved = removed;
+
+    // relocate the address references, which must use the old label addresses
+    for(int a = 0; a < size; a++) {
+        auto ref = byteLines[a]->addressRef;
+        if(!byteAlive[a] || ref == nullptr || !addressMap.has(ref->label)) {
+            continue;
+        }
+        int labelAddress = addressMap.get(ref->label);
+        int target = relocate(newAddress, removed, labelAddress + ref->offset);
+        ref->offset = target - relocate(newAddress, removed, labelAddress);
+    }
+    for(const auto& ins : instructions) {
+        int old = ins.alive ? getAbsoluteAddress(byteLines, addressMap, pinned, ins, size) : -1;
+        int target = relocate(newAddress, removed, old);
+        if(target == old) {
+            continue;
+        }
+        byteLines[ins.address+1]->byte = (target >> 8) & 0xFF;
+        byteLines[ins.address+1]->assemString = intToFourHex(target) + " H";
+        byteLines[ins.address+2]->byte = target & 0xFF;
+        byteLines[ins.address+2]->assemString = getPadding(6) + " L";
+    }
+    for(auto& label : addressMap.labels()) {
+        label.second = relocate(newAddress, removed, label.second);
+    }
+
+    // drop the removed lines, keeping their comments and labels as comment lines
+    std::vector<std::shared_ptr<MacLine>> keptLines;
+    for(const auto& macLine : macLines) {
+        if(macLine->byte >= 0 && !byteAlive[macLine->macLineNum]) {
+            if(macLine->comment == "" && macLine->addressLabel == "") {
+                continue;
+            }
+            macLine->byte = -1;
+            macLine->op = -1;
+            macLine->assemString = "";
+            macLine->addressRef = nullptr;
+            macLine->exprRef = nullptr;
+            macLine->macLineNum = -1;
+        } else if(macLine->byte >= 0) {
+            macLine->macLineNum = newAddress[macLine->macLineNum];
+        }
+        keptLines.push_back(macLine);
+    }
+    macLines = keptLines;
+}
+
+// the machine code placed by one line of assembly source
+class SourceLineCode {
+    public:
+    // the address of the first byte, or -1 if none
+    int address = -1;
+    std::vector<int> bytes;
+    // the clock cycles of the instructions starting on this line
+    int cycles = 0;
+};
+
+// returns the machine code placed by each line of the source, indexed by source line number
+std::vector<SourceLineCode> getSourceLineCode(const std::vector<std::shared_ptr<MacLine>>& macLines, int lineCount) {
+    std::vector<SourceLineCode> code(lineCount + 1);
+    std::vector<std::shared_ptr<MacLine>> byteLines = getByteLines(macLines);
+    for(const auto& macLine : byteLines) {
+        SourceLineCode& lineCode = code[macLine->assemLineNum];
+        if(lineCode.address < 0) {
+            lineCode.address = macLine->macLineNum;
+        }
+        lineCode.bytes.push_back(macLine->byte);
+    }
+    for(const auto& ins : getInstructions(byteLines)) {
+        if(ins.op >= 0) {
+            code[byteLines[ins.address]->assemLineNum].cycles += opCycles(ins.op);
+        }
+    }
+    return code;
+}
+
+// returns the input padded with spaces on the right to at least n chars
+std::string padRight(const std::string& input, int n) {
+    return input + getPadding(n - (int)input.size());
+}
+
+// returns the input padded with spaces on the left to at least n chars
+std::string padLeft(const std::string& input, int n) {
+    return getPadding(n - (int)input.size()) + input;
+}
+
+/*
+    writes the source annotated with the address, machine code bytes and clock cycles of each line,
+    followed by the size and cycles of each '#label' region, which runs up to the next label
+    (counting one pass through each instruction)
+*/
+void writeCycleListing(std::ostream& os, const std::vector<SourceLine>& rawLines, const std::vector<std::shared_ptr<MacLine>>& macLines, AddressMap& addressMap) {
+    std::vector<SourceLineCode> code = getSourceLineCode(macLines, rawLines.size());
+
+    // up to 4 bytes then the count of the rest, as many as an image holds ("xx xx xx xx +65532")
+    const int bytesWidth = 18;
+    os << "addr   " << padRight("bytes", bytesWidth) << " cycles | source" << std::endl;
+    for(const auto& line : rawLines) {
+        const SourceLineCode& lineCode = code[line.lineNum];
+        std::string address, bytes, cycles;
+        if(lineCode.address >= 0) {
+            address = intToFourHex(lineCode.address);
+            for(int b = 0; b < lineCode.bytes.size() && b < 4; b++) {
+                bytes.append(byte2hex(lineCode.bytes[b]) + " ");
+            }
+            if(lineCode.bytes.size() > 4) {
+                bytes.append("+" + std::to_string(lineCode.bytes.size() - 4));
+            }
+        }
+        if(lineCode.cycles > 0) {
+            cycles = std::to_string(lineCode.cycles);
+        }
+        os << padRight(address, 6) << " " << padRight(bytes, bytesWidth) << " " << padLeft(cycles, 6) << " | " << line.text << std::endl;
+    }
+
+    // sort the labels by address, each region ending at the next label
+    std::vector<std::pair<int, std::string>> labels;
+    for(const auto& label : addressMap.labels()) {
+        labels.push_back(std::make_pair(label.second, label.first));
+    }
+    std::sort(labels.begin(), labels.end());
+    std::vector<int> cyclesAt(IMAGE_SIZE + 1, 0);
+    int size = 0;
+    std::vector<std::shared_ptr<MacLine>> byteLines = getByteLines(macLines);
+    for(const auto& ins : getInstructions(byteLines)) {
+        if(ins.op >= 0) {
+            cyclesAt[ins.address] = opCycles(ins.op);
+        }
+        size = ins.address + ins.size;
+    }
+
+    os << std::endl << "label regions (one pass through each instruction)" << std::endl;
+    os << "addr   bytes   cycles | label" << std::endl;
+    for(int k = 0; k < labels.size(); k++) {
+        int begin = labels[k].first;
+        int end = k+1 < labels.size() ? labels[k+1].first : size;
+        int cycles = 0;
+        for(int a = begin; a < end && a < size; a++) {
+            cycles += cyclesAt[a];
+        }
+        os << padRight(intToFourHex(begin), 6) << " " << padLeft(std::to_string(std::max(0, end - begin)), 5) << " "
+            << padLeft(std::to_string(cycles), 8) << " | #" << labels[k].second << std::endl;
+    }
+}
+
+/*
+    writes a machine readable map of the program, one record per line:
+    - 'sym <label> <address>'
+    - 'ins <address> <size> <source line> <cycles>' for each instruction
+    - 'data <address> <size> <source line>' for each run of data bytes from one source line
+    addresses are written in hex (0xFFFF), everything else in decimal
+*/
+void writeSymbolMap(std::ostream& os, const std::string& sourceName, const std::vector<std::shared_ptr<MacLine>>& macLines, AddressMap& addressMap) {
+    os << "# ssbc symbol map for " << sourceName << std::endl;
+    for(const auto& label : addressMap.labels()) {
+        os << "sym " << label.first << " " << intToFourHex(label.second) << std::endl;
+    }
+
+    std::vector<std::shared_ptr<MacLine>> byteLines = getByteLines(macLines);
+    std::vector<Instruction> instructions = getInstructions(byteLines);
+    for(int k = 0; k < instructions.size(); k++) {
+        const Instruction& ins = instructions[k];
+        int sourceLine = byteLines[ins.address]->assemLineNum;
+        if(ins.op >= 0) {
+            os << "ins " << intToFourHex(ins.address) << " " << ins.size << " " << sourceLine << " " << opCycles(ins.op) << std::endl;
+            continue;
+        }
+        int size = 1;
+        while(k+1 < instructions.size() && instructions[k+1].op < 0 && byteLines[instructions[k+1].address]->assemLineNum == sourceLine) {
+            ++size;
+            ++k;
+        }
+        os << "data " << intToFourHex(ins.address) << " " << size << " " << sourceLine << std::endl;
+    }
+}
+
+// options changing how the assembler works
+class AssembleOptions {
+    public:
+    // if true, add noops for comments and empty lines
+    bool addNoops = false;
+    // if true, run the peephole optimizer before resolving addresses
+    bool optimize = false;
+    // the directories searched by .include, before the working directory
+    std::vector<std::string> includeDirs;
+    // rewrite rules applied by the optimizer, as well as its own
+    std::vector<RewriteRule> rules;
+};
+
+// everything produced by assembling a program
+class AssembleResult {
+    public:
+    // true if the program assembled without errors
+    bool ok = false;
+    // the machine code, starting at address 0
+    std::vector<unsigned char> image;
+    // the address of each label
+    AddressMap addressMap;
+    // the .equ symbols
+    SymbolMap symbols;
+    // errors and warnings, one per line
+    std::vector<std::string> diagnostics;
+    // the source lines as read
+    std::vector<SourceLine> sourceLines;
+    // the resultant machine code lines, including comment lines
+    std::vector<std::shared_ptr<MacLine>> macLines;
+    // what the optimizer saved, if it was run
+    OptimizeStats optimizeStats;
+};
+
+// assembles the source into result, writing errors and warnings to err
+// returns false if the source could not be assembled
+bool assembleInto(std::string_view source, const AssembleOptions& options, AssembleResult& result, std::ostream& err) {
+    // assembly code line number
+    int assemLineNum = 0;
+    // machine code line number
+    int macLineNum = 0;
+    std::string input;
+    // if true, we expect a 1 byte value
+    bool exp1Byte = false;
+    // if true, we expect a 2 byte value
+    bool exp2Byte = false;
+    // the operation which expected a value
+    std::string expOp = "";
+    // a queue of machine code lines to be added
+    MacQueue macQueue;
+    // a queue of comments
+    std::queue<std::string> commentQueue;
+    // a label for the next machine code byte
+    std::string addressLabel = "";
+    // a list of machine code line
+    std::vector<std::shared_ptr<MacLine>>& macLines = result.macLines;
+    // a list of machine code lines which need a resolved address
+    std::queue<std::shared_ptr<MacLine>> unresolvedMacLineQueue;
+    // a map which resolves a given address to its integer machine code line
+    AddressMap& addressMap = result.addressMap;
+
+    // the .equ symbols
+    SymbolMap& symbols = result.symbols;
+    // the source lines as read
+    std::vector<SourceLine>& rawLines = result.sourceLines;
+    // the source lines, after expanding macros and other directives
+    std::vector<SourceLine> sourceLines;
+    for(size_t begin = 0; begin < source.size();) {
+        size_t end = source.find('\n', begin);
+        if(end == std::string_view::npos) {
+            end = source.size();
+        }
+        rawLines.push_back(SourceLine(rawLines.size() + 1, std::string(source.substr(begin, end - begin))));
+        begin = end + 1;
+    }
+    Preprocessor preprocessor(symbols, err);
+    preprocessor.includeDirs = options.includeDirs;
+    if(!preprocessor.run(rawLines, sourceLines)) {
+        return false;
+    }
+
+    for(const auto& sourceLine : sourceLines) {
+        assemLineNum = sourceLine.lineNum;
+        input = sourceLine.text;
+
+        int i = 0;
+        std::string stringVal;
+        std::shared_ptr<Address> address;
+        std::shared_ptr<AddressPart> addressPart;
+        std::shared_ptr<Expr> expr;
+        BytePart bytePart;
+
+        /*
+            for each line of input:
+                - if we are in a multi-line comment, try to look for the end of it
+                and parse the rest of the line if found
+                    - and add each line of the multi-line comment to the comment queue
+                while we aren't at the end of input:
+                    - if we see a single-line comment, add the rest of the line to the comment queue
+                      and continue to the next line
+                    - skip whitespace, and continue to the next line if nothing else found
+                    - try to fetch a label, error if label already set
+                    - else try to fetch an address marker, filling the next 2 bytes if found
+                    - else try to fetch an int
+                        - if expected, set 1 or 2 byte value
+                        - else, set 1 byte, or 2 bytes if too large
+                    - else try to fetch a 2 byte hex value, and set it if expected
+                    - else try to fetch a 1 byte hex value, and set it if expected
+                    - else try to fetch an operation, setting 1 or 2 byte expected flags if needed
+                    - else error unexpected values
+            - [ ] todo: save mac line numbers, and fill @label addresses
+            at the end of a line, 
+
+            if the comment queue isn't empty:
+                if flagAddNoops, add noop and add comment to end of line
+                if flagClean, wait until next machine code value
+                else put comment on its own line without machine code
+        */
+
+        // if there is nothing on the line, mark this as an empty line
+        skipSpace(input, i);
+        if(i >= input.size()) {
+            commentQueue.push("");
+            continue;
+        }
+
+        while(i <= input.size()) {
+
+            skipSpace(input, i);
+            if(i >= input.size()) {
+                break;
+            }
+
+            std::string comment = "", stringVal = "";
+            int intVal;
+
+            std::string token;
+            if(tryParseSingleComment(input, i, comment)) {
+                commentQueue.push(comment);
+                continue;
+            } else if(tryParseLabel(input, i, stringVal)) {
+                addressLabel = stringVal;
+                continue;
+            } else if((addressPart = AddressPart::tryParse(input, i)) != nullptr) {
+                std::string label = addressPart->label;
+
+                auto macLine = macQueue.push(assemLineNum, 0, addressPart->toString(), addressPart);
+                unresolvedMacLineQueue.push(macLine);
+                exp1Byte = false;
+                continue;
+            } else if((address = Address::tryParse(input, i)) != nullptr) {
+                std::string label = stringVal;
+                if(exp1Byte) {
+                    err << "Error on line [" << assemLineNum << "]: expected 1 byte value for operation: '" << expOp << "', received full address reference '@" << label << "'" << std::endl;
+                    err << "use '@" << label << ".H' or '@" << label << ".L' instead to use the high-byte or low-byte of an address respectively" << std::endl;
+                    return false;
+                } else {
+                    exp2Byte = false;
+                }
+
+                // high byte
+                {
+                    auto macLine = macQueue.push(assemLineNum, 0, address->toString() + ".H", address->highPart);
+                    unresolvedMacLineQueue.push(macLine);
+                }
+
+                // low byte
+                {
+                    std::string p = getPadding(address->toString().size());
+                    auto macLine = macQueue.push(assemLineNum, 0, p + ".L", address->lowPart);
+                    unresolvedMacLineQueue.push(macLine);
+                }
+                continue;
+            } else if((expr = ExprPart::tryParse(input, i, symbols, stringVal, bytePart)) != nullptr) {
+                /*
+                    an expression is placed as 2 bytes when a 2 byte value is expected, else as 1 byte
+                    '.H' or '.L' always places 1 byte, expecting another after it if 2 bytes were expected
+                */
+                if(exp2Byte && bytePart == byte_value) {
+                    auto high = macQueue.push(assemLineNum, 0, stringVal + " H");
+                    high->exprRef = std::make_shared<ExprPart>(expr, stringVal, byte_high);
+                    unresolvedMacLineQueue.push(high);
+                    auto low = macQueue.push(assemLineNum, 0, getPadding(stringVal.size()) + " L");
+                    low->exprRef = std::make_shared<ExprPart>(expr, stringVal, byte_low);
+                    unresolvedMacLineQueue.push(low);
+                    exp2Byte = false;
+                    exp1Byte = false;
+                } else {
+                    std::string suffix = bytePart == byte_high ? ".H" : bytePart == byte_low ? ".L" : "";
+                    auto macLine = macQueue.push(assemLineNum, 0, stringVal + suffix);
+                    macLine->exprRef = std::make_shared<ExprPart>(expr, stringVal, bytePart);
+                    unresolvedMacLineQueue.push(macLine);
+                    exp1Byte = exp2Byte;
+                    exp2Byte = false;
+                }
+                continue;
+            /*
+                if parsed an integer, try to pad it into a 2 byte value and accept
+                    - if it's too large, error with expOp
+                    exp2Byte = false;
+                if parsed a 2 byte hex value accept
+                    exp2Byte = false;
+                if parsed a 1 byte hex value (e.g. 0xFF), expect a 1 byte value
+                    exp2Byte = false;
+                    exp1Byte = true;
+                else error with expOp
+                empty expOp
+            */
+            } else if(exp2Byte) {
+                /*
+                    when expecting 2 bytes, we shall accept either:
+                    - a decimal value, which will be cast as a 2 byte value
+                    - a 4-digit hex value
+                    - a 2-digit hex value, which will be assumed to be a 1 byte value
+                        - if we only received 1 byte hex value, expect another 1 byte value on the next line
+                        - note: must add padding to be accepted as a 2 byte value:
+                            0x00FF vs 0xFF
+                */
+                if(tryParse2ByteHex(input, i, stringVal, intVal)) {
+                    int& n = intVal;
+                    std::string& numString = stringVal;
+
+                    char h = getHighByte(n);
+                    char l = getLowByte(n);
+                    std::string p = getPadding(numString.size());
+                    macQueue.push(assemLineNum, h, numString + " H");
+                    macQueue.push(assemLineNum, l, p + " L");
+                    exp1Byte = false;
+                    exp2Byte = false;
+                    continue;
+                } else if(tryParse1ByteHex(input, i, stringVal, intVal)) {
+                    int& n = intVal;
+                    std::string& numString = stringVal;
+
+                    macQueue.push(assemLineNum, n, numString);
+                    exp2Byte = false;
+                    exp1Byte = true;
+                    continue;
+                } else if(tryParseDecimal(input, i, stringVal, intVal)) {
+                    int& n = intVal;
+                    std::string& numString = stringVal;
+                    if(-0x80 <= n && n <= 0x7F) {
+                        macQueue.push(assemLineNum, 0, numString + " H");
+                        macQueue.push(assemLineNum, n, getPadding(numString.size()) + " L");
+                    } else if(-0x8000 <=n && n <= 0x7FFF){
+                        char h = getHighByte(n);
+                        char l = getLowByte(n);
+                        std::string p = getPadding(numString.size());
+                        macQueue.push(assemLineNum, h, numString + " H");
+                        macQueue.push(assemLineNum, l, numString + " L");
+                    } else {
+                        err << "Error on line [" << assemLineNum << "]: number too large to convert: " << numString << std::endl;
+                        return false;
+                    }
+                    exp1Byte = false;
+                    exp2Byte = false;
+                    continue;
+                /*
+                    an unsigned hexadecimal value shall be accepted a 1 or 2 bytes, depending on padding
+                    e.g. 0xFF and 0x00FF are assumed to be 1 byte and 2 bytes respectively
+                */
+                } else {
+                    err << "Error on line [" << assemLineNum << "]: expected 2 byte value for operation: '" << expOp << std::endl;
+                    err << "'" << input << "'" << std::endl;
+                    return false;
+                }
+            } else if(exp1Byte) {
+                /*
+                    expect a decimal or hex value, print an error if it is too large or incorrect
+                    no parsing of 2 byte values here since it would be inapprpriate,
+                */
+                if(tryParse1ByteHex(input, i, stringVal, intVal)) {
+                    int& n = intVal;
+                    std::string& numString = stringVal;
+
+                    macQueue.push(assemLineNum, n, numString);
+                    exp1Byte = false;
+                    exp2Byte = false;
+                    continue;
+                } else if(tryParseDecimal(input, i, stringVal, intVal) && (-0x80 <= intVal && intVal <= 0x7F)) {
+                    int& n = intVal;
+                    std::string& numString = stringVal;
+
+                    macQueue.push(assemLineNum, n, numString);
+                    exp1Byte = false;
+                    exp2Byte = false;
+                    continue;
+                } else {
+                    err << "Error on line [" << assemLineNum << "]: expected 1 byte value for operation: '" << expOp << std::endl;
+                    err << "'" << input << "'" << std::endl;
+                    return false;
+                }
+                return false;
+            } else if(tryParse2ByteHex(input, i, stringVal, intVal)) {
+                int& n = intVal;
+                std::string& numString = stringVal;
+
+                char h = getHighByte(n);
+                char l = getLowByte(n);
+                std::string p = getPadding(stringVal.size());
+                    macQueue.push(assemLineNum, h, numString + " H");
+                    macQueue.push(assemLineNum, l, p + " L");
+                continue;
+            } else if(tryParse1ByteHex(input, i, stringVal, intVal)) {
+                int& n = intVal;
+                std::string& numString = stringVal;
+
+                macQueue.push(assemLineNum, n, numString);
+                continue;
+            } else if(tryParseDecimal(input, i, stringVal, intVal)) {
+                int& n = intVal;
+                std::string& numString = stringVal;
+
+                // a 2's complement decimal value shall be placed
+                // as-is in the machine code as 1 or 2 bytes,
+                // depending on magnitude
+                if(-0x80 <= n && n <= 0x7F) {
+                    macQueue.push(assemLineNum, n, numString);
+                } else if(-0x8000 <=n && n <= 0x7FFF){
+                    char h = getHighByte(n);
+                    char l = getLowByte(n);
+                    std::string p = getPadding(numString.size());
+                    macQueue.push(assemLineNum, h, numString + " H");
+                    macQueue.push(assemLineNum, l, p + " L");
+                } else {
+                    err << "Error on line [" << assemLineNum << "]: number too large to convert: " << numString << std::endl;
+                    return false;
+                }
+                continue;
+            /*
+                an unsigned hexadecimal value shall be accepted a 1 or 2 bytes, depending on padding
+                e.g. 0xFF and 0x00FF are assumed to be 1 byte and 2 bytes respectively
+            */
+            } else if(!tryFetchNextToken(input, i, token)) {
+                err << "Error, could not parse line [" + std::to_string(assemLineNum) + "]: '" << input << "'" << std::endl;
+                return false;
+            } else if(token == "noop") {
+                expOp = "noop";
+                macQueue.push(assemLineNum, op_noop, "noop")->op = op_noop;
+                continue;
+            } else if(token == "add") {
+                expOp = "add";
+                macQueue.push(assemLineNum, op_add, "add")->op = op_add;
+                continue;
+            } else if(token == "sub") {
+                expOp = "sub";
+                macQueue.push(assemLineNum, op_sub, "sub")->op = op_sub;
+                continue;
+            } else if(token == "nor") {
+                expOp = "nor";
+                macQueue.push(assemLineNum, op_nor, "nor")->op = op_nor;
+                continue;
+            } else if(token == "popinh") {
+                expOp = "popinh";
+                macQueue.push(assemLineNum, op_popinh, "popinh")->op = op_popinh;
+                continue;
+            } else if(token == "halt") {
+                expOp = "halt";
+                macQueue.push(assemLineNum, op_halt, "halt")->op = op_halt;
+                continue;
+            } else if(token == "pushimm") {
+                expOp = "pushimm";
+                exp2Byte = false;
+                exp1Byte = true;
+                macQueue.push(assemLineNum, op_pushimm, "pushimm")->op = op_pushimm;
+                continue;
+            } else if(token == "pushext") {
+                expOp = "pushext";
+                exp2Byte = true;
+                exp1Byte = false;
+                macQueue.push(assemLineNum, op_pushext, "pushext")->op = op_pushext;
+                continue;
+            } else if(token == "popext") {
+                expOp = "popext";
+                exp2Byte = true;
+                exp1Byte = false;
+                macQueue.push(assemLineNum, op_popext, "popext")->op = op_popext;
+                continue;
+            } else if(token == "jnz") {
+                expOp = "jnz";
+                exp2Byte = true;
+                exp1Byte = false;
+                macQueue.push(assemLineNum, op_jnz, "jnz")->op = op_jnz;
+                continue;
+            } else if(token == "jnn") {
+                expOp = "jnn";
+                exp2Byte = true;
+                exp1Byte = false;
+                macQueue.push(assemLineNum, op_jnn, "jnn")->op = op_jnn;
+                continue;
+            } else {
+                err << "Error on line [" << assemLineNum << "]: unrecognized token: '" << token << "'" << std::endl;
+                return false;
+            }
+        }
+
+        // if there is a comment without machine line codes
+        // just add empty machine lines with the comment
+        if(macQueue.empty()) {
+            while(!commentQueue.empty()) {
+                std::string comment = commentQueue.front();
+                commentQueue.pop();
+                if(options.addNoops) {
+                    auto macLine = macQueue.push(assemLineNum);
+                    macLine->comment = comment;
+                    macLine->byte = op_noop;
+                    macLine->op = op_noop;
+                } else {
+                    auto macLine = std::make_shared<MacLine>(assemLineNum);
+                    macLine->comment = comment;
+                    macLine->macLineNum = -1;
+                    macLines.push_back(macLine);
+                }
+            }
+        }
+
+        while(!macQueue.empty()) {
+            auto macLine = macQueue.front();
+            macQueue.pop();
+            macLine->macLineNum = macLineNum;
+
+            if(addressLabel != "") {
+                macLine->addressLabel = addressLabel;
+                if(addressMap.has(addressLabel)) {
+                    err << "Error on line [" << assemLineNum << "]: address label used already: '" << addressLabel << "'" << std::endl;
+                    err << "'" << input << "'" << std::endl;
+                    return false;
+                } else {
+                    addressMap.set(addressLabel, macLineNum);
+                }
+                addressLabel = "";
+            }
+
+            if(!commentQueue.empty()) {
+                std::string comment = commentQueue.front();
+                commentQueue.pop();
+                macLine->comment = comment;
+            }
+
+            macLines.push_back(macLine);
+            macLineNum++;
+        }
+        continue;
+    }
+
+    if(options.optimize) {
+        optimize(macLines, addressMap, symbols, options.rules, result.optimizeStats, err);
+        macLineNum -= result.optimizeStats.bytesSaved;
+
+        // removed lines no longer need resolving, and retargeted jumps have new references
+        unresolvedMacLineQueue = std::queue<std::shared_ptr<MacLine>>();
+        for(const auto& macLine : macLines) {
+            if(macLine->byte >= 0 && (macLine->addressRef != nullptr || macLine->exprRef != nullptr)) {
+                unresolvedMacLineQueue.push(macLine);
+            }
+        }
+    }
+
+    // resolve address references
+    while(!unresolvedMacLineQueue.empty()) {
+        auto macLine = unresolvedMacLineQueue.front();
+        unresolvedMacLineQueue.pop();
+        if(macLine->exprRef != nullptr) {
+            std::string error;
+            if(!macLine->exprRef->tryGetByte(addressMap, symbols, macLine->byte, error)) {
+                err << "Error on line [" << macLine->assemLineNum << "]: " << error << std::endl;
+                return false;
+            }
+            continue;
+        } else if(macLine->addressRef == nullptr) {
+            // should never happen
+            err << "Error on line [" << macLine->assemLineNum << "]: mac line in address ref queue without address" << std::endl;
+            return false;
+        }
+
+        std::string refLabel = macLine->addressRef->label;
+        if(!addressMap.has(refLabel)) {
+            err << "Error on line [" << macLine->assemLineNum << "]: unrecognized address label: '" << refLabel << "'" << std::endl;
+            return false;
+        } else {
+            // update the machine code to use the referenced address
+            // (the high part or low part value)
+            int macLineNum = addressMap.get(refLabel);
+            macLine->addressRef->set(macLineNum);
+            macLine->byte = macLine->addressRef->getByte();
+        }
+    }
+
+    if(macLineNum > IMAGE_SIZE) {
+        err << "Error: program is " << macLineNum << " bytes, which does not fit in memory" << std::endl;
+        return false;
+    }
+
+    // the resolved byte stream, in machine code line order
+    result.image.reserve(macLineNum);
+    for(const auto& macLine : macLines) {
+        if(macLine->byte >= 0) {
+            result.image.push_back(macLine->byte);
+        }
+    }
+    return true;
+}
+
+
+// assembles ssbc assembly source in memory
+AssembleResult assemble(std::string_view source, const AssembleOptions& options = AssembleOptions()) {
+    AssembleResult result;
+    std::ostringstream err;
+    result.ok = assembleInto(source, options, result, err);
+    std::istringstream diagnostics(err.str());
+    std::string line;
+    while(std::getline(diagnostics, line)) {
+        result.diagnostics.push_back(line);
+    }
+    return result;
+}
+
+// writes the annotated .mac listing of the machine code lines
+// hexLineNumber - if true, start lines with machine code with their line number in hex
+void writeMacListing(std::ostream& os, const std::vector<std::shared_ptr<MacLine>>& macLines, bool hexLineNumber) {
+    for(const auto& macLine : macLines) {
+        os << macLine->toString(hexLineNumber) << std::endl;
+    }
+}
+
+#endif // ASSEMBLER_H
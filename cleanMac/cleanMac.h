@@ -0,0 +1,136 @@
+#ifndef CLEANMAC_H
+#define CLEANMAC_H
+
+#include <cstdio>
+#include <cstring>
+#include <vector>
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+/*
+    removes anything except for binary text on a line
+
+    for each line, leading whitespace is skipped, and if the line then starts with a binary digit,
+    the run of binary digits is written out on its own line
+
+    input is read in large blocks: line ends are found with memchr, binary runs are
+    measured 16 or 32 bytes at a time with SSE2 or AVX2, and output is written in bulk
+*/
+
+// the size of the blocks read and written
+const size_t BLOCK_SIZE = 1 << 20;
+
+// returns the number of '0' and '1' chars at the start of p, looking at no more than n chars
+size_t binaryRunLength(const char* p, size_t n) {
+    size_t i = 0;
+#if defined(__AVX2__)
+    const __m256i zeros32 = _mm256_set1_epi8('0');
+    const __m256i ones32 = _mm256_set1_epi8('1');
+    while(i + 32 <= n) {
+        __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + i));
+        __m256i isBinary = _mm256_or_si256(_mm256_cmpeq_epi8(chunk, zeros32), _mm256_cmpeq_epi8(chunk, ones32));
+        unsigned int mask = ~static_cast<unsigned int>(_mm256_movemask_epi8(isBinary));
+        if(mask != 0) {
+            return i + __builtin_ctz(mask);
+        }
+        i += 32;
+    }
+#endif
+#if defined(__SSE2__)
+    const __m128i zeros = _mm_set1_epi8('0');
+    const __m128i ones = _mm_set1_epi8('1');
+    while(i + 16 <= n) {
+        __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i));
+        __m128i isBinary = _mm_or_si128(_mm_cmpeq_epi8(chunk, zeros), _mm_cmpeq_epi8(chunk, ones));
+        unsigned int mask = ~static_cast<unsigned int>(_mm_movemask_epi8(isBinary)) & 0xFFFF;
+        if(mask != 0) {
+            return i + __builtin_ctz(mask);
+        }
+        i += 16;
+    }
+#endif
+    while(i < n && (p[i] == '0' || p[i] == '1')) {
+        ++i;
+    }
+    return i;
+}
+
+// writes the binary run of one line (not including its '\n') to out
+// atEnd - true if the line is the last of the input, with no '\n'
+void cleanLine(const char* line, size_t length, bool atEnd, std::vector<char>& out) {
+    size_t i = 0;
+    while(i < length && (line[i] == ' ' || line[i] == '\t' || line[i] == '\r')) {
+        ++i;
+    }
+    size_t run = binaryRunLength(line + i, length - i);
+    if(run == 0) {
+        return;
+    }
+    out.insert(out.end(), line + i, line + i + run);
+    // the binary run is ended by a newline, unless it runs up to the end of the input
+    if(!atEnd || i + run < length) {
+        out.push_back('\n');
+    }
+}
+
+// cleans text which is already in memory, appending the result to out
+void cleanMac(const char* data, size_t size, std::vector<char>& out) {
+    size_t begin = 0;
+    while(begin < size) {
+        const char* line = data + begin;
+        const char* newline = static_cast<const char*>(std::memchr(line, '\n', size - begin));
+        if(newline == nullptr) {
+            cleanLine(line, size - begin, true, out);
+            break;
+        }
+        cleanLine(line, newline - line, false, out);
+        begin += newline - line + 1;
+    }
+}
+
+// cleans everything read from in, writing it to out
+void cleanMac(FILE* inFile, FILE* outFile) {
+    std::vector<char> in(BLOCK_SIZE);
+    std::vector<char> out;
+    out.reserve(BLOCK_SIZE + BLOCK_SIZE / 2);
+    // the number of bytes in the input buffer, and where the unprocessed part begins
+    size_t filled = 0;
+    size_t begin = 0;
+    bool atEnd = false;
+
+    while(!atEnd) {
+        // keep the partial line at the end of the buffer, growing it for long lines
+        if(begin > 0) {
+            std::memmove(in.data(), in.data() + begin, filled - begin);
+            filled -= begin;
+            begin = 0;
+        }
+        if(filled == in.size()) {
+            in.resize(in.size() * 2);
+        }
+        size_t n = std::fread(in.data() + filled, 1, in.size() - filled, inFile);
+        filled += n;
+        atEnd = n == 0;
+
+        while(begin < filled) {
+            const char* line = in.data() + begin;
+            const char* newline = static_cast<const char*>(std::memchr(line, '\n', filled - begin));
+            if(newline == nullptr) {
+                if(atEnd) {
+                    cleanLine(line, filled - begin, true, out);
+                    begin = filled;
+                }
+                break;
+            }
+            cleanLine(line, newline - line, false, out);
+            begin += newline - line + 1;
+        }
+
+        if(out.size() >= BLOCK_SIZE || atEnd) {
+            std::fwrite(out.data(), 1, out.size(), outFile);
+            out.clear();
+        }
+    }
+}
+
+#endif // CLEANMAC_H
@@ -0,0 +1,42 @@
+/*
+    accepts .mac file, and writes the value of each machine code line as a decimal integer,
+    one per line (as two's complement with --signed)
+*/
+
+#include <iostream>
+#include <string>
+#include "codec.h"
+
+int main(int argc, char** argv) {
+    std::string inFileName, outFileName;
+    if(!tryParseIOFileNames(argc, argv, inFileName, outFileName)) {
+        std::cerr << "Usage: " << argv[0] << " -i infile -o outfile [--signed]" << std::endl;
+        return 1;
+    }
+    bool isSigned = tryParseArg(argc, argv, "--signed");
+
+    FILE* inFile = openFile(inFileName, "rb");
+    FILE* outFile = inFile != nullptr ? openFile(outFileName, "wb") : nullptr;
+    if(outFile == nullptr) {
+        return 1;
+    }
+
+    // the text of each value, so that no conversion happens per line
+    std::vector<std::string> text(256);
+    for(int b = 0; b < 256; b++) {
+        text[b] = std::to_string(isSigned ? (int)(signed char)b : b) + "\n";
+    }
+
+    BlockReader reader(inFile);
+    {
+        BlockWriter writer(outFile);
+        decodeMac(reader, [&](const std::vector<unsigned char>& block) {
+            for(const unsigned char& b : block) {
+                writer.write(text[b].data(), text[b].size());
+            }
+        });
+    }
+    std::fclose(inFile);
+    std::fclose(outFile);
+    return 0;
+}
@@ -0,0 +1,65 @@
+/*
+    accepts raw bytes (bin), hex text (hex) or intel hex (ihex),
+    and writes them as .mac lines of 8 binary digits
+*/
+
+#include <iostream>
+#include <fstream>
+#include <string>
+#include "codec.h"
+
+int main(int argc, char** argv) {
+    std::string inFileName, outFileName;
+    if(!tryParseIOFileNames(argc, argv, inFileName, outFileName)) {
+        std::cerr << "Usage: " << argv[0] << " -i infile -o outfile [-f bin|hex|ihex]" << std::endl;
+        return 1;
+    }
+    std::string format = "bin";
+    tryParseArg(argc, argv, "-f", format);
+    if(format != "bin" && format != "hex" && format != "ihex") {
+        std::cerr << "Error: unrecognized input format: '" << format << "'" << std::endl;
+        return 1;
+    }
+
+    std::vector<unsigned char> bytes;
+    if(format == "ihex") {
+        std::ifstream inFile;
+        inFile.open(inFileName);
+        if(!inFile.is_open()) {
+            std::cerr << "Error: could not open " << inFileName << std::endl;
+            return 1;
+        }
+        if(!tryReadIntelHex(inFile, bytes)) {
+            std::cerr << "Error: malformed intel hex in " << inFileName << std::endl;
+            return 1;
+        }
+    }
+
+    FILE* inFile = openFile(inFileName, "rb");
+    FILE* outFile = inFile != nullptr ? openFile(outFileName, "wb") : nullptr;
+    if(outFile == nullptr) {
+        return 1;
+    }
+
+    BlockReader reader(inFile);
+    int result = 0;
+    {
+        BlockWriter writer(outFile);
+        if(format == "bin") {
+            const unsigned char* data;
+            size_t length;
+            while(reader.nextBlock(data, length)) {
+                encodeMac(data, length, writer);
+            }
+        } else {
+            if(format == "hex" && !decodeHex(reader, bytes)) {
+                std::cerr << "Error: malformed hex text in " << inFileName << std::endl;
+                result = 1;
+            }
+            encodeMac(bytes.data(), bytes.size(), writer);
+        }
+    }
+    std::fclose(inFile);
+    std::fclose(outFile);
+    return result;
+}
@@ -0,0 +1,291 @@
+/*
+    conversions between ascii-binary .mac text, raw bytes, hex text and intel hex
+    - 8 '0'/'1' chars are packed into a byte (and back) with SSE2 compares and movemask
+    - bytes are converted to hex through a table
+    - input and output go through large blocks rather than a char or line at a time
+*/
+
+#ifndef CODEC_H
+#define CODEC_H
+
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+#include "../common.h"
+
+// the size of the blocks read and written
+const size_t CODEC_BLOCK_SIZE = 1 << 20;
+
+// reads a file in large blocks, handing out one line at a time
+class BlockReader {
+    public:
+    BlockReader(FILE* _file) : file(_file), buffer(CODEC_BLOCK_SIZE) { }
+
+    // fills the next line (without its '\n'), which stays valid until the next call
+    // returns false at the end of the input
+    bool nextLine(const char*& out_line, size_t& out_length) {
+        while(true) {
+            const char* newline = static_cast<const char*>(std::memchr(buffer.data() + begin, '\n', filled - begin));
+            if(newline != nullptr) {
+                out_line = buffer.data() + begin;
+                out_length = newline - out_line;
+                begin += out_length + 1;
+                return true;
+            }
+            if(atEnd) {
+                if(begin == filled) {
+                    return false;
+                }
+                out_line = buffer.data() + begin;
+                out_length = filled - begin;
+                begin = filled;
+                return true;
+            }
+            fill();
+        }
+    }
+
+    // fills the next block of raw bytes, returns false at the end of the input
+    bool nextBlock(const unsigned char*& out_data, size_t& out_length) {
+        if(begin == filled) {
+            if(atEnd) {
+                return false;
+            }
+            fill();
+            if(begin == filled) {
+                return false;
+            }
+        }
+        out_data = reinterpret_cast<const unsigned char*>(buffer.data() + begin);
+        out_length = filled - begin;
+        begin = filled;
+        return true;
+    }
+
+    private:
+    FILE* file;
+    std::vector<char> buffer;
+    size_t begin = 0;
+    size_t filled = 0;
+    bool atEnd = false;
+
+    // keeps the unread part at the start of the buffer, growing it for long lines, and reads more
+    void fill() {
+        if(begin > 0) {
+            std::memmove(buffer.data(), buffer.data() + begin, filled - begin);
+            filled -= begin;
+            begin = 0;
+        }
+        if(filled == buffer.size()) {
+            buffer.resize(buffer.size() * 2);
+        }
+        size_t n = std::fread(buffer.data() + filled, 1, buffer.size() - filled, file);
+        filled += n;
+        atEnd = n == 0;
+    }
+};
+
+// collects output into large blocks before writing it
+class BlockWriter {
+    public:
+    BlockWriter(FILE* _file) : file(_file) {
+        buffer.reserve(CODEC_BLOCK_SIZE + 64);
+    }
+    ~BlockWriter() {
+        flush();
+    }
+
+    // returns space for n more chars, which must be filled
+    char* reserve(size_t n) {
+        if(buffer.size() + n > CODEC_BLOCK_SIZE) {
+            flush();
+        }
+        size_t size = buffer.size();
+        buffer.resize(size + n);
+        return buffer.data() + size;
+    }
+    void write(const char* data, size_t n) {
+        std::memcpy(reserve(n), data, n);
+    }
+    void put(char c) {
+        *reserve(1) = c;
+    }
+    void flush() {
+        std::fwrite(buffer.data(), 1, buffer.size(), file);
+        buffer.clear();
+    }
+
+    private:
+    FILE* file;
+    std::vector<char> buffer;
+};
+
+// returns the byte with its bits in reverse order
+inline unsigned char reverseBits(unsigned char b) {
+    return ((b * 0x0202020202ULL) & 0x010884422010ULL) % 1023;
+}
+
+// packs the 8 chars at p into a byte, the first being the high bit
+// returns false if they are not all '0' or '1'
+inline bool tryPackBinary8(const char* p, unsigned char& out_byte) {
+#if defined(__SSE2__)
+    __m128i chars = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(p));
+    __m128i ones = _mm_cmpeq_epi8(chars, _mm_set1_epi8('1'));
+    __m128i zeros = _mm_cmpeq_epi8(chars, _mm_set1_epi8('0'));
+    if((_mm_movemask_epi8(_mm_or_si128(ones, zeros)) & 0xFF) != 0xFF) {
+        return false;
+    }
+    // movemask puts the first char in the low bit
+    out_byte = reverseBits(_mm_movemask_epi8(ones) & 0xFF);
+    return true;
+#else
+    int value = 0;
+    for(int i = 0; i < 8; i++) {
+        if(p[i] != '0' && p[i] != '1') {
+            return false;
+        }
+        value = (value << 1) | (p[i] - '0');
+    }
+    out_byte = value;
+    return true;
+#endif
+}
+
+// writes the byte as 8 '0'/'1' chars, high bit first
+inline void unpackBinary8(unsigned char b, char* out) {
+#if defined(__SSE2__)
+    const __m128i bits = _mm_setr_epi8(-128, 64, 32, 16, 8, 4, 2, 1, 0, 0, 0, 0, 0, 0, 0, 0);
+    __m128i isSet = _mm_cmpeq_epi8(_mm_and_si128(_mm_set1_epi8(b), bits), bits);
+    // '0' - (-1) is '1'
+    _mm_storel_epi64(reinterpret_cast<__m128i*>(out), _mm_sub_epi8(_mm_set1_epi8('0'), isSet));
+#else
+    for(int i = 0; i < 8; i++) {
+        out[i] = (b >> (7 - i)) & 1 ? '1' : '0';
+    }
+#endif
+}
+
+// hex digits for each byte value
+class HexDigits {
+    public:
+    char digits[256][2];
+    HexDigits() {
+        for(int b = 0; b < 256; b++) {
+            digits[b][0] = part2Hex(b >> 4);
+            digits[b][1] = part2Hex(b);
+        }
+    }
+};
+
+// writes the byte as 2 hex digits
+inline void byteToHex(unsigned char b, char* out) {
+    static const HexDigits hex;
+    out[0] = hex.digits[b][0];
+    out[1] = hex.digits[b][1];
+}
+
+// returns the value of a hex digit, or -1
+inline int hexDigitValue(char c) {
+    if('0' <= c && c <= '9') {
+        return c - '0';
+    } else if('A' <= c && c <= 'F') {
+        return c - 'A' + 10;
+    } else if('a' <= c && c <= 'f') {
+        return c - 'a' + 10;
+    }
+    return -1;
+}
+
+// reads the byte of the .mac line, which starts with 8 binary digits
+// returns false for other lines, which are comments
+inline bool tryDecodeMacLine(const char* line, size_t length, unsigned char& out_byte) {
+    return length >= 8 && tryPackBinary8(line, out_byte);
+}
+
+// reads the bytes of every machine code line of a .mac file, passing each block of them to emit
+// returns the number of bytes
+template<typename Emit>
+size_t decodeMac(BlockReader& reader, Emit emit) {
+    std::vector<unsigned char> block;
+    block.reserve(CODEC_BLOCK_SIZE);
+    size_t count = 0;
+    const char* line;
+    size_t length;
+    unsigned char byte;
+    while(reader.nextLine(line, length)) {
+        if(tryDecodeMacLine(line, length, byte)) {
+            block.push_back(byte);
+            if(block.size() == CODEC_BLOCK_SIZE) {
+                emit(block);
+                count += block.size();
+                block.clear();
+            }
+        }
+    }
+    if(!block.empty()) {
+        emit(block);
+        count += block.size();
+    }
+    return count;
+}
+
+// writes the bytes as .mac lines of 8 binary digits
+void encodeMac(const unsigned char* data, size_t n, BlockWriter& writer) {
+    for(size_t i = 0; i < n; i++) {
+        char* out = writer.reserve(9);
+        unpackBinary8(data[i], out);
+        out[8] = '\n';
+    }
+}
+
+// writes the bytes as hex text, 16 bytes per line
+void encodeHex(const unsigned char* data, size_t n, BlockWriter& writer) {
+    for(size_t i = 0; i < n; i += 16) {
+        size_t count = std::min<size_t>(16, n - i);
+        char* out = writer.reserve(count * 3);
+        for(size_t j = 0; j < count; j++) {
+            byteToHex(data[i + j], out + j * 3);
+            out[j * 3 + 2] = j + 1 < count ? ' ' : '\n';
+        }
+    }
+}
+
+// reads hex text (pairs of hex digits, optionally separated by whitespace) into bytes
+// returns false if there is anything else in the text
+bool decodeHex(BlockReader& reader, std::vector<unsigned char>& out) {
+    const char* line;
+    size_t length;
+    while(reader.nextLine(line, length)) {
+        for(size_t i = 0; i < length;) {
+            if(std::isspace(line[i])) {
+                ++i;
+                continue;
+            }
+            int high = hexDigitValue(line[i]);
+            int low = i + 1 < length ? hexDigitValue(line[i + 1]) : -1;
+            if(high < 0 || low < 0) {
+                return false;
+            }
+            out.push_back((high << 4) | low);
+            i += 2;
+        }
+    }
+    return true;
+}
+
+// opens a file for the codec tools, returning null after writing an error if not possible
+FILE* openFile(const std::string& fileName, const char* mode) {
+    FILE* file = std::fopen(fileName.c_str(), mode);
+    if(file == nullptr) {
+        std::cerr << "Error: could not open " << fileName << std::endl;
+    }
+    return file;
+}
+
+#endif // CODEC_H
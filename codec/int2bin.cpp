@@ -0,0 +1,72 @@
+/*
+    accepts integers separated by whitespace (decimal, or hex like 0xFF), and writes each
+    as a .mac line of 8 binary digits
+    values must fit in a byte, from -128 to 255
+*/
+
+#include <iostream>
+#include <string>
+#include "codec.h"
+
+int main(int argc, char** argv) {
+    std::string inFileName, outFileName;
+    if(!tryParseIOFileNames(argc, argv, inFileName, outFileName)) {
+        std::cerr << "Usage: " << argv[0] << " -i infile -o outfile" << std::endl;
+        return 1;
+    }
+
+    FILE* inFile = openFile(inFileName, "rb");
+    FILE* outFile = inFile != nullptr ? openFile(outFileName, "wb") : nullptr;
+    if(outFile == nullptr) {
+        return 1;
+    }
+
+    BlockReader reader(inFile);
+    int result = 0;
+    {
+        BlockWriter writer(outFile);
+        const char* line;
+        size_t length;
+        int lineNum = 0;
+        while(result == 0 && reader.nextLine(line, length)) {
+            ++lineNum;
+            size_t i = 0;
+            while(i < length) {
+                if(std::isspace(line[i])) {
+                    ++i;
+                    continue;
+                }
+                int sign = 1, base = 10, value = 0, digits = 0;
+                if(line[i] == '-' || line[i] == '+') {
+                    sign = line[i] == '-' ? -1 : 1;
+                    ++i;
+                }
+                if(i + 1 < length && line[i] == '0' && (line[i+1] == 'x' || line[i+1] == 'X')) {
+                    base = 16;
+                    i += 2;
+                }
+                while(i < length && !std::isspace(line[i])) {
+                    int digit = hexDigitValue(line[i]);
+                    if(digit < 0 || digit >= base || value > 0xFFFF) {
+                        break;
+                    }
+                    value = value * base + digit;
+                    ++digits;
+                    ++i;
+                }
+                value *= sign;
+                if(digits == 0 || (i < length && !std::isspace(line[i])) || value < -0x80 || value > 0xFF) {
+                    std::cerr << "Error on line [" << lineNum << "]: expected an integer from -128 to 255" << std::endl;
+                    result = 1;
+                    break;
+                }
+                char* out = writer.reserve(9);
+                unpackBinary8(value & 0xFF, out);
+                out[8] = '\n';
+            }
+        }
+    }
+    std::fclose(inFile);
+    std::fclose(outFile);
+    return result;
+}
@@ -0,0 +1,66 @@
+/*
+    accepts .mac file, and writes its machine code as raw bytes (bin), hex text (hex),
+    intel hex (ihex) or a full 64K memory image (img)
+    lines which don't start with 8 binary digits are comments and are skipped
+*/
+
+#include <iostream>
+#include <sstream>
+#include <string>
+#include "codec.h"
+
+int main(int argc, char** argv) {
+    std::string inFileName, outFileName;
+    if(!tryParseIOFileNames(argc, argv, inFileName, outFileName)) {
+        std::cerr << "Usage: " << argv[0] << " -i infile -o outfile [-f bin|hex|ihex|img]" << std::endl;
+        return 1;
+    }
+    std::string format = "bin";
+    tryParseArg(argc, argv, "-f", format);
+    if(format != "bin" && format != "hex" && format != "ihex" && format != "img") {
+        std::cerr << "Error: unrecognized output format: '" << format << "'" << std::endl;
+        return 1;
+    }
+
+    FILE* inFile = openFile(inFileName, "rb");
+    FILE* outFile = inFile != nullptr ? openFile(outFileName, "wb") : nullptr;
+    if(outFile == nullptr) {
+        return 1;
+    }
+
+    BlockReader reader(inFile);
+    int result = 0;
+    {
+        BlockWriter writer(outFile);
+        if(format == "bin") {
+            decodeMac(reader, [&](const std::vector<unsigned char>& block) {
+                writer.write(reinterpret_cast<const char*>(block.data()), block.size());
+            });
+        } else if(format == "hex") {
+            decodeMac(reader, [&](const std::vector<unsigned char>& block) {
+                encodeHex(block.data(), block.size(), writer);
+            });
+        } else {
+            // intel hex and memory images only address 64K
+            std::vector<unsigned char> bytes;
+            decodeMac(reader, [&](const std::vector<unsigned char>& block) {
+                bytes.insert(bytes.end(), block.begin(), block.end());
+            });
+            if(bytes.size() > IMAGE_SIZE) {
+                std::cerr << "Error: " << bytes.size() << " bytes do not fit in memory" << std::endl;
+                result = 1;
+            } else {
+                std::ostringstream os;
+                if(format == "ihex") {
+                    writeIntelHex(os, bytes);
+                } else {
+                    tryWriteImage(os, bytes);
+                }
+                writer.write(os.str().data(), os.str().size());
+            }
+        }
+    }
+    std::fclose(inFile);
+    std::fclose(outFile);
+    return result;
+}
@@ -3,6 +3,83 @@
 
 #include <string>
 #include <fstream>
+#include <vector>
+#include <algorithm>
+
+// opcodes
+enum {
+    op_noop = 0,      // no operation     - 00000000
+    op_halt = 1,      // halt             - 00000001
+    op_pushimm = 2,   // push immediate   - 00000010
+    op_pushext = 3,   // push external    - 00000011
+    op_popinh = 4,    // pop inherent     - 00000100
+    op_popext = 5,    // pop external     - 00000101
+    op_jnz = 6,       // jump not zero    - 00000110
+    op_jnn = 7,       // jump not negative- 00000111
+    op_add = 8,       // add              - 00001000
+    op_sub = 9,       // subtract         - 00001001
+    op_nor = 10,      // nor              - 00001010
+    op_count = 11
+};
+
+// memory map
+enum {
+    map_PSW = 0xFFFB,
+    map_portA = 0xFFFC,
+    map_portB = 0xFFFD,
+    map_portC = 0xFFFE,
+    map_portD = 0xFFFF
+};
+
+// returns the mnemonic of an opcode
+std::string opName(int op) {
+    switch(op) {
+        case op_noop: { return "noop"; }
+        case op_halt: { return "halt"; }
+        case op_pushimm: { return "pushimm"; }
+        case op_pushext: { return "pushext"; }
+        case op_popinh: { return "popinh"; }
+        case op_popext: { return "popext"; }
+        case op_jnz: { return "jnz"; }
+        case op_jnn: { return "jnn"; }
+        case op_add: { return "add"; }
+        case op_sub: { return "sub"; }
+        case op_nor: { return "nor"; }
+    }
+    return "";
+}
+
+// returns the size in bytes of an instruction, including its operand
+int opSize(int op) {
+    switch(op) {
+        case op_pushimm: { return 2; }
+        case op_pushext:
+        case op_popext:
+        case op_jnz:
+        case op_jnn: { return 3; }
+    }
+    return 1;
+}
+
+// returns the clock cycles taken by an instruction, counted as the sequential (';') steps of
+// docs/abstractRTN.md: 3 for instruction interpretation (IR <- MEM[PC]; set_fault; PC <- PC+1)
+// plus the steps of the instruction's execution
+int opCycles(int op) {
+    switch(op) {
+        case op_noop:
+        case op_halt:
+        case op_popinh:
+        case op_jnz:
+        case op_jnn: { return 4; }
+        case op_pushimm:
+        case op_pushext:
+        case op_popext:
+        case op_add:
+        case op_sub:
+        case op_nor: { return 5; }
+    }
+    return 3;
+}
 
 // try to parse the first 8 chars as binary values
 // out_binaryString - the bits as a string value
@@ -29,6 +106,7 @@ bool get4BitParts(const std::string& input, std::string& out_highPart, std::stri
     }
     out_highPart = input.substr(0, 4);
     out_lowPart = input.substr(4, 4);
+    return true;
 }
 
 // returns hex char from 4-bit string
@@ -96,6 +174,98 @@ std::string twoBytes2hex(int input) {
     return result;
 }
 
+// returns the bottom byte of input as a 2 symbol hex string
+std::string byte2hex(int input) {
+    std::string result;
+    result.push_back(part2Hex(input >> 4));
+    result.push_back(part2Hex(input));
+    return result;
+}
+
+// size of the full ssbc address space
+const int IMAGE_SIZE = 0x10000;
+
+// writes the bytes as-is
+void writeBinary(std::ostream& os, const std::vector<unsigned char>& bytes) {
+    os.write(reinterpret_cast<const char*>(bytes.data()), bytes.size());
+}
+
+// writes the bytes as a full memory image, padded with zeroes up to IMAGE_SIZE
+// returns false, writing nothing, if there are more bytes than that
+bool tryWriteImage(std::ostream& os, const std::vector<unsigned char>& bytes) {
+    if(bytes.size() > IMAGE_SIZE) {
+        return false;
+    }
+    writeBinary(os, bytes);
+    std::vector<unsigned char> padding(IMAGE_SIZE - bytes.size(), 0);
+    writeBinary(os, padding);
+    return true;
+}
+
+// writes the bytes as intel hex records of up to 16 bytes each, starting at address 0
+void writeIntelHex(std::ostream& os, const std::vector<unsigned char>& bytes) {
+    for(int addr = 0; addr < bytes.size(); addr += 16) {
+        int count = std::min<int>(16, bytes.size() - addr);
+        int checksum = count + ((addr >> 8) & 0xFF) + (addr & 0xFF);
+        std::string record = ":" + byte2hex(count) + twoBytes2hex(addr) + "00";
+        for(int i = 0; i < count; i++) {
+            record.append(byte2hex(bytes[addr + i]));
+            checksum += bytes[addr + i];
+        }
+        record.append(byte2hex(-checksum));
+        os << record << '\n';
+    }
+    os << ":00000001FF" << '\n';
+}
+
+// reads intel hex records from the input into bytes, growing it as needed
+// returns false if a record is malformed or has a bad checksum
+bool tryReadIntelHex(std::istream& is, std::vector<unsigned char>& bytes) {
+    std::string line;
+    while(std::getline(is, line)) {
+        while(!line.empty() && std::isspace(line.back())) {
+            line.pop_back();
+        }
+        if(line.empty()) {
+            continue;
+        }
+        if(line[0] != ':' || line.size() < 11 || line.size() % 2 == 0) {
+            return false;
+        }
+        std::vector<int> record;
+        for(int i = 1; i < line.size(); i += 2) {
+            int high = std::isxdigit(line[i]) ? std::stoi(line.substr(i, 1), nullptr, 16) : -1;
+            int low = std::isxdigit(line[i+1]) ? std::stoi(line.substr(i+1, 1), nullptr, 16) : -1;
+            if(high < 0 || low < 0) {
+                return false;
+            }
+            record.push_back((high << 4) | low);
+        }
+        int checksum = 0;
+        for(const int& b : record) {
+            checksum += b;
+        }
+        int count = record[0];
+        if((checksum & 0xFF) != 0 || record.size() != count + 5) {
+            return false;
+        }
+        int type = record[3];
+        if(type == 1) {
+            break;
+        } else if(type != 0) {
+            continue;
+        }
+        int addr = (record[1] << 8) | record[2];
+        if(bytes.size() < addr + count) {
+            bytes.resize(addr + count, 0);
+        }
+        for(int i = 0; i < count; i++) {
+            bytes[addr + i] = record[4 + i];
+        }
+    }
+    return true;
+}
+
 // returns true if there was an argument set, filling it's value to out_val
 bool tryParseArg(const int& argc, char** argv, const std::string& flagString, std::string& out_val) {
     for(int i = 0; i < argc; i++) {
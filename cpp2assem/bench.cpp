@@ -0,0 +1,195 @@
+/*
+    compiles each benchmark program with --naive, by default and with --optimize, runs each on the
+    machine, and compares the cycles taken and bytes of code
+
+    with --functions, also lists each function's instructions and the cycles spent in it,
+    by default and with --optimize
+
+    each program states its expected result for portA in a comment, e.g. '// expect: 55'
+*/
+
+#include <string>
+#include <sstream>
+#include <iostream>
+#include <fstream>
+#include <iomanip>
+#include "compiler.h"
+#include "../assem2mac/assembler.h"
+#include "../ssbc-interpreter/machine.h"
+
+// the most instructions a benchmark may run before it is taken to be stuck
+const long long MAX_INSTRUCTIONS = 100000000;
+
+// the code of one function, from its label to the next function's
+class FunctionProfile {
+    public:
+    int instructions = 0;
+    long long cycles = 0;
+};
+
+class BenchRun {
+    public:
+    bool ok = false;
+    int result = 0;
+    long long cycles = 0;
+    int bytes = 0;
+    // by function name
+    std::map<std::string, FunctionProfile> functions;
+};
+
+// compiles, assembles and runs the program, writing errors to err
+bool tryRun(const std::string& source, const CompileOptions& compileOptions, BenchRun& out_run, std::ostream& err) {
+    CompileResult compiled;
+    if(!compileInto(source, compileOptions, compiled, err)) {
+        return false;
+    }
+    AssembleResult assembled = assemble(compiled.assembly);
+    if(!assembled.ok) {
+        for(const auto& diagnostic : assembled.diagnostics) {
+            err << diagnostic << std::endl;
+        }
+        return false;
+    }
+
+    // each function's code runs from its label to the next function, or the end of the image
+    std::map<int, std::string> starts;
+    for(const auto& label : assembled.addressMap.labels()) {
+        if(label.first.compare(0, 2, "f_") == 0) {
+            starts[label.second] = label.first.substr(2);
+        }
+    }
+    int size = assembled.image.size();
+    std::vector<FunctionProfile*> owner(size, nullptr);
+    for(auto start = starts.begin(); start != starts.end(); ++start) {
+        auto next = std::next(start);
+        int end = next != starts.end() ? next->first : size;
+        FunctionProfile& profile = out_run.functions[start->second];
+        for(int address = start->first; address < end; address += opSize(assembled.image[address] & 0xF)) {
+            ++profile.instructions;
+        }
+        std::fill(owner.begin() + start->first, owner.begin() + end, &profile);
+    }
+
+    Machine machine;
+    machine.load(assembled.image);
+    while(machine.instructions < MAX_INSTRUCTIONS) {
+        int pc = machine.PC;
+        long long before = machine.cycles;
+        bool isRunning = machine.step();
+        if(pc < size && owner[pc] != nullptr) {
+            owner[pc]->cycles += machine.cycles - before;
+        }
+        if(!isRunning) {
+            break;
+        }
+    }
+    if(!machine.HALT) {
+        err << "Error: the program did not halt" << std::endl;
+        return false;
+    }
+    out_run.ok = true;
+    out_run.result = machine.portA();
+    out_run.cycles = machine.cycles;
+    out_run.bytes = size;
+    return true;
+}
+
+// the change from before to after, as a percentage
+std::string percent(long long before, long long after) {
+    std::ostringstream out;
+    out << std::fixed << std::setprecision(0) << (before > 0 ? 100.0 * (before - after) / before : 0.0) << "%";
+    return out.str();
+}
+
+int main(int argc, char** argv) {
+    bool showFunctions = tryParseArg(argc, argv, "--functions");
+    std::vector<std::string> fileNames;
+    for(int i = 1; i < argc; i++) {
+        if(std::string(argv[i]) != "--functions") {
+            fileNames.push_back(argv[i]);
+        }
+    }
+    if(fileNames.empty()) {
+        std::cerr << "Usage: " << argv[0] << " [--functions] program.cpp..." << std::endl;
+        return 1;
+    }
+
+    std::cout << std::left << std::setw(16) << "program" << std::right
+        << std::setw(8) << "result" << std::setw(14) << "naive cycles" << std::setw(10) << "cycles"
+        << std::setw(11) << "optimized" << std::setw(8) << "saved"
+        << std::setw(13) << "naive bytes" << std::setw(8) << "bytes" << std::setw(11) << "optimized" << std::endl;
+
+    std::ostringstream functionTable;
+    functionTable << std::left << std::setw(16) << "program" << std::setw(16) << "function" << std::right
+        << std::setw(14) << "instructions" << std::setw(11) << "optimized"
+        << std::setw(10) << "cycles" << std::setw(11) << "optimized" << std::endl;
+
+    bool allPassed = true;
+    long long naiveTotal = 0, total = 0, optimizedTotal = 0;
+    for(const auto& fileName : fileNames) {
+        std::ifstream file(fileName);
+        if(!file.is_open()) {
+            std::cerr << "Error: could not open " << fileName << std::endl;
+            return 1;
+        }
+        std::stringstream source;
+        source << file.rdbuf();
+
+        int expected = -1;
+        size_t at = source.str().find("// expect:");
+        if(at != std::string::npos) {
+            expected = std::stoi(source.str().substr(at + 10)) & 0xFF;
+        }
+
+        CompileOptions naiveOptions, defaultOptions, optimizeOptions;
+        naiveOptions.naive = true;
+        optimizeOptions.optimize = true;
+        BenchRun naive, plain, optimized;
+        std::string name = fileName.substr(fileName.find_last_of('/') + 1);
+        if(!tryRun(source.str(), naiveOptions, naive, std::cerr) || !tryRun(source.str(), defaultOptions, plain, std::cerr)
+            || !tryRun(source.str(), optimizeOptions, optimized, std::cerr)) {
+            std::cerr << "Error: " << name << " failed" << std::endl;
+            allPassed = false;
+            continue;
+        }
+        bool passed = naive.result == plain.result && plain.result == optimized.result
+            && (expected < 0 || plain.result == expected);
+        allPassed &= passed;
+        naiveTotal += naive.cycles;
+        total += plain.cycles;
+        optimizedTotal += optimized.cycles;
+
+        std::cout << std::left << std::setw(16) << name << std::right
+            << std::setw(8) << plain.result << std::setw(14) << naive.cycles << std::setw(10) << plain.cycles
+            << std::setw(11) << optimized.cycles << std::setw(8) << percent(naive.cycles, optimized.cycles)
+            << std::setw(13) << naive.bytes << std::setw(8) << plain.bytes << std::setw(11) << optimized.bytes;
+        if(!passed) {
+            std::cout << "  FAILED: expected " << expected << ", naive gave " << naive.result
+                << ", optimized gave " << optimized.result;
+        }
+        std::cout << std::endl;
+
+        // the functions inlined into every caller, or no longer called, are not placed
+        for(const auto& function : plain.functions) {
+            functionTable << std::left << std::setw(16) << name << std::setw(16) << function.first << std::right
+                << std::setw(14) << function.second.instructions;
+            auto after = optimized.functions.find(function.first);
+            if(after == optimized.functions.end()) {
+                functionTable << std::setw(11) << "removed" << std::setw(10) << function.second.cycles << std::endl;
+                continue;
+            }
+            functionTable << std::setw(11) << after->second.instructions << std::setw(10) << function.second.cycles
+                << std::setw(11) << after->second.cycles << std::endl;
+        }
+    }
+
+    if(naiveTotal > 0) {
+        std::cout << "total: " << naiveTotal << " naive cycles, " << total << " cycles ("
+            << std::fixed << std::setprecision(1) << 100.0 * (naiveTotal - total) / naiveTotal << "% fewer), "
+            << optimizedTotal << " optimized cycles (" << 100.0 * (naiveTotal - optimizedTotal) / naiveTotal << "% fewer)" << std::endl;
+    }
+    if(showFunctions) {
+        std::cout << std::endl << functionTable.str();
+    }
+    return allPassed ? 0 : 1;
+}
@@ -0,0 +1,26 @@
+// sorts an array, then checks it is in order
+// expect: 42
+
+int data[12] = { 12, -5, 33, 0, 7, -20, 42, 19, 3, -1, 8, 25 };
+
+void sort(int n) {
+    for(int i = 0; i < n - 1; i++) {
+        for(int j = 0; j < n - 1 - i; j++) {
+            if(data[j] > data[j + 1]) {
+                int t = data[j];
+                data[j] = data[j + 1];
+                data[j + 1] = t;
+            }
+        }
+    }
+}
+
+int main() {
+    sort(12);
+    for(int i = 1; i < 12; i++) {
+        if(data[i - 1] > data[i]) {
+            return -1;
+        }
+    }
+    return data[11];
+}
@@ -0,0 +1,27 @@
+// the negated dot product of two vectors with each term clamped, through small function calls
+// expect: 31
+
+const int SIZE = 8;
+int a[SIZE] = { 3, -1, 4, 1, -5, 9, 2, -6 };
+int b[SIZE] = { 2, 7, -1, 8, 2, -8, 1, 8 };
+int weight = 3;
+
+int clamp(int x, int low, int high) {
+    if(x < low) {
+        return low;
+    }
+    if(x > high) {
+        return high;
+    }
+    return x;
+}
+
+int main() {
+    int total = 0;
+    int margin = 1;
+    for(int i = 0; i < SIZE; i++) {
+        int limit = weight * 4 + margin;
+        total -= clamp(a[i] * b[i], -limit, limit);
+    }
+    return total;
+}
@@ -0,0 +1,16 @@
+// the number of collatz steps to reach 1 from 7, plus where it stopped
+// expect: 17
+
+int main() {
+    int n = 7;
+    int steps = 0;
+    do {
+        if(n & 1) {
+            n = n * 3 + 1;
+        } else {
+            n = n >> 1;
+        }
+        steps++;
+    } while(n != 1 && n > 0 && n < 100);
+    return steps + n;
+}
@@ -0,0 +1,40 @@
+// counts the relations which hold between pairs of values, many of them far enough apart that their
+// 8-bit difference overflows, and between each value and constants
+// expect: 86
+
+int values[6] = { -128, -100, -1, 0, 100, 127 };
+
+int main() {
+    int count = 0;
+    for(int i = 0; i < 6; i++) {
+        int a = values[i];
+        for(int j = 0; j < 6; j++) {
+            int b = values[j];
+            if(a < b) {
+                count++;
+            }
+            if(a <= b) {
+                count++;
+            }
+            if(a > b) {
+                count++;
+            }
+            if(a >= b) {
+                count++;
+            }
+        }
+        if(a < 100) {
+            count++;
+        }
+        if(a >= -100) {
+            count++;
+        }
+        if(-1 < a) {
+            count++;
+        }
+        if(a > 0) {
+            count++;
+        }
+    }
+    return count;
+}
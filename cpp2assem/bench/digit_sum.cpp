@@ -0,0 +1,15 @@
+// the sum of the decimal digits of several numbers, using division and remainder
+// expect: 47
+
+int digitSum(int n) {
+    int sum = 0;
+    while(n > 0) {
+        sum += n % 10;
+        n = n / 10;
+    }
+    return sum;
+}
+
+int main() {
+    return digitSum(127) + digitSum(99) + digitSum(45) + digitSum(118);
+}
@@ -0,0 +1,17 @@
+// the 11th fibonacci number, iteratively
+// expect: 89
+
+int fib(int n) {
+    int a = 0;
+    int b = 1;
+    for(int i = 0; i < n; i++) {
+        int t = a + b;
+        a = b;
+        b = t;
+    }
+    return a;
+}
+
+int main() {
+    return fib(11);
+}
@@ -0,0 +1,17 @@
+// greatest common divisors by subtraction
+// expect: 2
+
+int gcd(int a, int b) {
+    while(a != b) {
+        if(a > b) {
+            a -= b;
+        } else {
+            b -= a;
+        }
+    }
+    return a;
+}
+
+int main() {
+    return gcd(105, 84) + gcd(120, 36) - gcd(17, 5) - gcd(96, 64) + gcd(81, 27) - 27 + 2;
+}
@@ -0,0 +1,26 @@
+// the largest difference between neighbouring elements, through small function calls
+// expect: 38
+
+int values[10] = { 4, -9, 15, 2, 40, 21, 3, -10, 28, 11 };
+
+int abs(int x) {
+    if(x < 0) {
+        return -x;
+    }
+    return x;
+}
+
+int max(int a, int b) {
+    if(a > b) {
+        return a;
+    }
+    return b;
+}
+
+int main() {
+    int best = 0;
+    for(int i = 1; i < 10; i++) {
+        best = max(best, abs(values[i] - values[i - 1]));
+    }
+    return best;
+}
@@ -0,0 +1,13 @@
+// a sum of products, using the multiply helper
+// expect: 79
+
+int a[6] = { 3, 7, -2, 5, 11, -4 };
+int b[6] = { 4, 2, 9, -3, 6, -5 };
+
+int main() {
+    int total = 0;
+    for(int i = 0; i < 6; i++) {
+        total += a[i] * b[i];
+    }
+    return total;
+}
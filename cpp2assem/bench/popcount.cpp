@@ -0,0 +1,20 @@
+// the number of set bits in several bytes, clearing the lowest bit each time
+// expect: 27
+
+int popcount(int v) {
+    int count = 0;
+    while(v != 0) {
+        v &= v - 1;
+        count++;
+    }
+    return count;
+}
+
+int main() {
+    int total = 0;
+    int values[6] = { 0x7F, 0x55, -1, 0x0F, 0x12, 0x03 };
+    for(int i = 0; i < 6; i++) {
+        total += popcount(values[i]);
+    }
+    return total;
+}
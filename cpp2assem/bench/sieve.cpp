@@ -0,0 +1,18 @@
+// the number of primes below 100, by the sieve of eratosthenes
+// expect: 25
+
+const int LIMIT = 100;
+bool composite[LIMIT];
+
+int main() {
+    int count = 0;
+    for(int i = 2; i < LIMIT; i++) {
+        if(!composite[i]) {
+            count++;
+            for(int j = i + i; j < LIMIT && j > 0; j += i) {
+                composite[j] = true;
+            }
+        }
+    }
+    return count;
+}
@@ -0,0 +1,20 @@
+// the largest distance of a signal from its three-point average, reading each element more than once
+// expect: 36
+
+int signal[12] = { 4, 9, 2, 30, 7, 5, 6, -20, 8, 3, 12, 1 };
+
+int main() {
+    int scale = 2;
+    int peak = 0;
+    for(int i = 1; i < 11; i++) {
+        int average = (signal[i - 1] + signal[i] + signal[i + 1]) / 3;
+        int delta = signal[i] - average;
+        if(delta < 0) {
+            delta = -delta;
+        }
+        if(delta * scale > peak) {
+            peak = delta * scale;
+        }
+    }
+    return peak;
+}
@@ -0,0 +1,13 @@
+// the sum of an array, wrapping at 8 bits
+// expect: 11
+
+const int SIZE = 16;
+int values[SIZE] = { 3, 1, 4, 1, 5, 9, 2, 6, 5, 3, 5, 8, 9, 7, 9, 3 };
+
+int main() {
+    int sum = 0;
+    for(int i = 0; i < SIZE; i++) {
+        sum += values[i];
+    }
+    return sum - 69;
+}
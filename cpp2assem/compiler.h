@@ -0,0 +1,3837 @@
+/*
+    the cpp2assem compiler as a library:
+    compile() transforms a small subset of C++ into ssbc assembly
+
+    - 'int' (also 'char' and 'bool') is a signed 8-bit value, and arithmetic wraps
+    - global variables, functions, parameters, local variables and arrays of up to 256 elements
+    - every variable is statically allocated, so functions may not be recursive
+    - 'int main()' is jumped to at reset, and its result is written to portA before a halt
+    - asm("...") places ssbc assembly inline
+*/
+
+#ifndef COMPILER_H
+#define COMPILER_H
+
+#include <string>
+#include <sstream>
+#include <map>
+#include <set>
+#include <vector>
+#include <iostream>
+#include <memory>
+#include <algorithm>
+#include <functional>
+#include <string_view>
+#include "../common.h"
+#include "../runtime/runtime.h"
+
+/*
+    tokens
+*/
+
+enum TokenType {
+    token_identifier,
+    token_number,
+    token_string,
+    token_symbol,
+    token_end
+};
+
+class Token {
+    public:
+    TokenType type = token_end;
+    std::string text;
+    int value = 0;
+    int line = 0;
+};
+
+// the symbols of the language, longest first so that the longest match is taken
+const std::vector<std::string> SYMBOLS = {
+    "<<=", ">>=",
+    "<<", ">>", "<=", ">=", "==", "!=", "&&", "||", "++", "--",
+    "+=", "-=", "*=", "/=", "%=", "&=", "|=", "^=",
+    "+", "-", "*", "/", "%", "&", "|", "^", "~", "!", "<", ">", "=",
+    "(", ")", "{", "}", "[", "]", ";", ","
+};
+
+// returns the value of an escaped char, e.g. 'n' for '\n'
+char unescapeChar(char c) {
+    switch(c) {
+        case 'n': { return '\n'; }
+        case 't': { return '\t'; }
+        case 'r': { return '\r'; }
+        case '0': { return '\0'; }
+        default: { return c; }
+    }
+}
+
+// splits the source into tokens, skipping whitespace, comments and preprocessor lines
+// returns false after writing an error if not possible
+bool tryTokenize(std::string_view source, std::vector<Token>& out_tokens, std::ostream& err) {
+    int line = 1;
+    size_t i = 0;
+    bool atLineStart = true;
+    while(i < source.size()) {
+        char c = source[i];
+        if(c == '\n') {
+            ++line;
+            ++i;
+            atLineStart = true;
+            continue;
+        }
+        if(std::isspace(c)) {
+            ++i;
+            continue;
+        }
+        if(c == '#' && atLineStart) {
+            // preprocessor lines (e.g. #include) are ignored
+            while(i < source.size() && source[i] != '\n') {
+                ++i;
+            }
+            continue;
+        }
+        atLineStart = false;
+        if(source.compare(i, 2, "//") == 0) {
+            while(i < source.size() && source[i] != '\n') {
+                ++i;
+            }
+            continue;
+        }
+        if(source.compare(i, 2, "/*") == 0) {
+            size_t end = source.find("*/", i + 2);
+            if(end == std::string_view::npos) {
+                err << "Error on line [" << line << "]: unterminated comment" << std::endl;
+                return false;
+            }
+            line += std::count(source.begin() + i, source.begin() + end, '\n');
+            i = end + 2;
+            continue;
+        }
+
+        Token token;
+        token.line = line;
+        if(std::isalpha(c) || c == '_') {
+            token.type = token_identifier;
+            while(i < source.size() && (std::isalnum(source[i]) || source[i] == '_')) {
+                token.text.push_back(source[i++]);
+            }
+        } else if(std::isdigit(c)) {
+            token.type = token_number;
+            int base = 10;
+            if(source.compare(i, 2, "0x") == 0 || source.compare(i, 2, "0X") == 0) {
+                base = 16;
+                i += 2;
+            } else if(source.compare(i, 2, "0b") == 0 || source.compare(i, 2, "0B") == 0) {
+                base = 2;
+                i += 2;
+            }
+            while(i < source.size() && std::isalnum(source[i])) {
+                char d = source[i];
+                int digit = std::isdigit(d) ? d - '0' : std::isxdigit(d) ? std::tolower(d) - 'a' + 10 : base;
+                if(digit >= base) {
+                    err << "Error on line [" << line << "]: malformed number" << std::endl;
+                    return false;
+                }
+                token.value = (token.value * base + digit) & 0xFFFF;
+                token.text.push_back(source[i++]);
+            }
+        } else if(c == '\'') {
+            token.type = token_number;
+            ++i;
+            if(i < source.size() && source[i] == '\\') {
+                ++i;
+                token.value = i < source.size() ? unescapeChar(source[i]) : 0;
+            } else {
+                token.value = i < source.size() ? source[i] : 0;
+            }
+            ++i;
+            if(i >= source.size() || source[i] != '\'') {
+                err << "Error on line [" << line << "]: malformed char literal" << std::endl;
+                return false;
+            }
+            ++i;
+        } else if(c == '"') {
+            token.type = token_string;
+            ++i;
+            while(i < source.size() && source[i] != '"' && source[i] != '\n') {
+                if(source[i] == '\\' && i + 1 < source.size()) {
+                    ++i;
+                    token.text.push_back(unescapeChar(source[i++]));
+                } else {
+                    token.text.push_back(source[i++]);
+                }
+            }
+            if(i >= source.size() || source[i] != '"') {
+                err << "Error on line [" << line << "]: unterminated string" << std::endl;
+                return false;
+            }
+            ++i;
+        } else {
+            token.type = token_symbol;
+            for(const auto& symbol : SYMBOLS) {
+                if(source.compare(i, symbol.size(), symbol) == 0) {
+                    token.text = symbol;
+                    break;
+                }
+            }
+            if(token.text.empty()) {
+                err << "Error on line [" << line << "]: unexpected character '" << c << "'" << std::endl;
+                return false;
+            }
+            i += token.text.size();
+        }
+        out_tokens.push_back(token);
+    }
+
+    Token end;
+    end.type = token_end;
+    end.text = "end of file";
+    end.line = line;
+    out_tokens.push_back(end);
+    return true;
+}
+
+/*
+    the syntax tree
+*/
+
+// a statically allocated variable, or a named constant
+class Variable {
+    public:
+    std::string name;
+    // the assembly label of its first byte
+    std::string label;
+    // the number of elements, or 0 if it is not an array
+    int length = 0;
+    // the initial value of each byte
+    std::vector<int> init = { 0 };
+    // a 'const' with a known value takes no memory
+    bool isConstant = false;
+    int value = 0;
+    // true once code refers to it, so that it is placed in memory
+    bool isUsed = false;
+    // true if it is declared outside of any function
+    bool isGlobal = false;
+
+    // the number of bytes taken in memory
+    int size() {
+        return length > 0 ? length : 1;
+    }
+};
+
+enum NodeKind {
+    node_number,
+    node_variable,
+    node_index,
+    node_call,
+    node_unary,
+    node_binary,
+    node_assign,
+    node_increment
+};
+
+class AstNode {
+    public:
+    NodeKind kind = node_number;
+    // the operator, e.g. "+", "+=", "++", or the name of the function called
+    std::string op;
+    int value = 0;
+    int line = 0;
+    std::shared_ptr<Variable> variable;
+    // the operands: unary and increment use left, index uses right as the index
+    std::shared_ptr<AstNode> left;
+    std::shared_ptr<AstNode> right;
+    std::vector<std::shared_ptr<AstNode>> args;
+    // for increments, true for '++x' and false for 'x++'
+    bool isPrefix = false;
+};
+
+enum StatementKind {
+    statement_expression,
+    statement_if,
+    statement_while,
+    statement_do,
+    statement_for,
+    statement_return,
+    statement_break,
+    statement_continue,
+    statement_block,
+    statement_asm,
+    statement_empty
+};
+
+class Statement {
+    public:
+    StatementKind kind = statement_empty;
+    int line = 0;
+    // the expression, condition or returned value
+    std::shared_ptr<AstNode> expr;
+    std::shared_ptr<Statement> init;
+    std::shared_ptr<AstNode> step;
+    std::shared_ptr<Statement> body;
+    std::shared_ptr<Statement> elseBody;
+    std::vector<std::shared_ptr<Statement>> statements;
+    // the inline assembly
+    std::string text;
+};
+
+class Function {
+    public:
+    std::string name;
+    bool returnsValue = true;
+    bool isDefined = false;
+    // a runtime library routine, placed as its generated assembly rather than compiled
+    bool isRuntime = false;
+    int line = 0;
+    std::vector<std::shared_ptr<Variable>> params;
+    // parameters, locals and compiler temporaries
+    std::vector<std::shared_ptr<Variable>> variables;
+    std::shared_ptr<Statement> body;
+    // the functions called by this one
+    std::set<std::string> calls;
+    // the deepest the stack gets within the function, not counting calls
+    int maxDepth = 0;
+};
+
+class CompileUnit {
+    public:
+    std::vector<std::shared_ptr<Variable>> globals;
+    std::vector<std::shared_ptr<Function>> functions;
+    std::map<std::string, std::shared_ptr<Function>> functionMap;
+};
+
+// returns true if the node is a number or named constant, filling its value
+bool isConstantNode(const std::shared_ptr<AstNode>& node, int& out_value) {
+    if(node->kind == node_number) {
+        out_value = node->value;
+        return true;
+    } else if(node->kind == node_variable && node->variable->isConstant) {
+        out_value = node->variable->value;
+        return true;
+    }
+    return false;
+}
+
+// evaluates an expression made only of numbers and constants, as a full int
+// used for array sizes and initializers
+bool tryEvalConstant(const std::shared_ptr<AstNode>& node, int& out_value) {
+    if(isConstantNode(node, out_value)) {
+        return true;
+    }
+    int a, b;
+    if(node->kind == node_unary && tryEvalConstant(node->left, a)) {
+        if(node->op == "-") { out_value = -a; return true; }
+        if(node->op == "+") { out_value = a; return true; }
+        if(node->op == "~") { out_value = ~a; return true; }
+        if(node->op == "!") { out_value = !a; return true; }
+    }
+    if(node->kind == node_binary && tryEvalConstant(node->left, a) && tryEvalConstant(node->right, b)) {
+        const std::string& op = node->op;
+        if(op == "+") { out_value = a + b; return true; }
+        if(op == "-") { out_value = a - b; return true; }
+        if(op == "*") { out_value = a * b; return true; }
+        if(op == "/" && b != 0) { out_value = a / b; return true; }
+        if(op == "%" && b != 0) { out_value = a % b; return true; }
+        if(op == "<<") { out_value = a << (b & 0xF); return true; }
+        if(op == ">>") { out_value = a >> (b & 0xF); return true; }
+        if(op == "&") { out_value = a & b; return true; }
+        if(op == "|") { out_value = a | b; return true; }
+        if(op == "^") { out_value = a ^ b; return true; }
+    }
+    return false;
+}
+
+// returns true if evaluating the node could change a variable or call a function
+bool hasSideEffects(const std::shared_ptr<AstNode>& node) {
+    if(node == nullptr) {
+        return false;
+    }
+    if(node->kind == node_call || node->kind == node_assign || node->kind == node_increment) {
+        return true;
+    }
+    return hasSideEffects(node->left) || hasSideEffects(node->right);
+}
+
+// returns the power of 2 the value is, or -1
+int powerOf2(int value) {
+    for(int i = 0; i < 8; i++) {
+        if(value == (1 << i)) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+// returns the helper function called for the binary operator, or "" if it is generated inline
+std::string helperFor(const std::string& op, const std::shared_ptr<AstNode>& left, const std::shared_ptr<AstNode>& right) {
+    int value;
+    if(op == "*") {
+        bool isShift = (isConstantNode(right, value) && powerOf2(value & 0xFF) >= 0)
+            || (isConstantNode(left, value) && powerOf2(value & 0xFF) >= 0);
+        return isShift ? "" : "__mul";
+    } else if(op == "/") {
+        return "__div";
+    } else if(op == "%") {
+        return "__mod";
+    } else if(op == "<<") {
+        return isConstantNode(right, value) ? "" : "__shl";
+    } else if(op == ">>") {
+        return "__shr";
+    }
+    return "";
+}
+
+/*
+    the parser
+*/
+
+// the binding strength of each binary operator, higher binds tighter
+int binaryPrecedence(const Token& token) {
+    if(token.type != token_symbol) {
+        return -1;
+    }
+    const std::string& op = token.text;
+    if(op == "||") { return 1; }
+    if(op == "&&") { return 2; }
+    if(op == "|") { return 3; }
+    if(op == "^") { return 4; }
+    if(op == "&") { return 5; }
+    if(op == "==" || op == "!=") { return 6; }
+    if(op == "<" || op == "<=" || op == ">" || op == ">=") { return 7; }
+    if(op == "<<" || op == ">>") { return 8; }
+    if(op == "+" || op == "-") { return 9; }
+    if(op == "*" || op == "/" || op == "%") { return 10; }
+    return -1;
+}
+
+// returns true if the operator assigns, e.g. '=' or '+='
+bool isAssignOp(const Token& token) {
+    static const std::set<std::string> ops = { "=", "+=", "-=", "*=", "/=", "%=", "&=", "|=", "^=", "<<=", ">>=" };
+    return token.type == token_symbol && ops.count(token.text) > 0;
+}
+
+class Parser {
+    public:
+    Parser(const std::vector<Token>& _tokens, CompileUnit& _unit, std::ostream& _err)
+        : tokens(_tokens), unit(_unit), err(_err) { }
+
+    // parses every declaration into the unit
+    // returns false after writing an error if not possible
+    bool parse() {
+        scopes.push_back(std::map<std::string, std::shared_ptr<Variable>>());
+        while(ok && peek().type != token_end) {
+            parseTopLevel();
+        }
+        return ok;
+    }
+
+    private:
+    const std::vector<Token>& tokens;
+    CompileUnit& unit;
+    std::ostream& err;
+    size_t pos = 0;
+    bool ok = true;
+    // the variables visible at each level of nesting, globals first
+    std::vector<std::map<std::string, std::shared_ptr<Variable>>> scopes;
+    // the function being parsed
+    std::shared_ptr<Function> function;
+
+    const Token& peek(int ahead = 0) {
+        return tokens[std::min(pos + ahead, tokens.size() - 1)];
+    }
+
+    const Token& next() {
+        const Token& token = peek();
+        if(pos < tokens.size() - 1) {
+            ++pos;
+        }
+        return token;
+    }
+
+    // returns true if the next token is the symbol or keyword, without consuming it
+    bool isNext(const std::string& text) {
+        return (peek().type == token_symbol || peek().type == token_identifier) && peek().text == text;
+    }
+
+    // consumes the next token if it is the symbol or keyword
+    bool tryAccept(const std::string& text) {
+        if(isNext(text)) {
+            next();
+            return true;
+        }
+        return false;
+    }
+
+    // writes an error for the line of the next token, only the first error being written
+    void error(const std::string& message) {
+        if(ok) {
+            err << "Error on line [" << peek().line << "]: " << message << std::endl;
+        }
+        ok = false;
+    }
+
+    // consumes the symbol or keyword, writing an error if it is not next
+    bool expect(const std::string& text) {
+        if(tryAccept(text)) {
+            return true;
+        }
+        error("expected '" + text + "', found '" + peek().text + "'");
+        return false;
+    }
+
+    // returns true if the next token starts a declaration
+    bool isTypeNext() {
+        return isNext("int") || isNext("char") || isNext("bool") || isNext("void") || isNext("const") || isNext("signed");
+    }
+
+    // parses a type, returning false for 'void'
+    bool parseType(bool& out_isConst) {
+        out_isConst = tryAccept("const");
+        tryAccept("signed");
+        if(tryAccept("void")) {
+            return false;
+        }
+        if(!tryAccept("int") && !tryAccept("char") && !tryAccept("bool")) {
+            error("expected a type, found '" + peek().text + "'");
+        }
+        return true;
+    }
+
+    // parses an identifier, writing an error if there isn't one
+    std::string parseName() {
+        if(peek().type != token_identifier) {
+            error("expected a name, found '" + peek().text + "'");
+            return "";
+        }
+        return next().text;
+    }
+
+    // returns the variable visible by the name, or null
+    std::shared_ptr<Variable> findVariable(const std::string& name) {
+        for(auto scope = scopes.rbegin(); scope != scopes.rend(); ++scope) {
+            auto found = scope->find(name);
+            if(found != scope->end()) {
+                return found->second;
+            }
+        }
+        return nullptr;
+    }
+
+    // creates a variable in the innermost scope
+    std::shared_ptr<Variable> declareVariable(const std::string& name) {
+        if(scopes.back().count(name) > 0) {
+            error("'" + name + "' is already declared");
+            return nullptr;
+        }
+        auto variable = std::make_shared<Variable>();
+        variable->name = name;
+        if(function == nullptr) {
+            variable->label = "g_" + name;
+            variable->isGlobal = true;
+            unit.globals.push_back(variable);
+        } else {
+            // locals of the same name in different blocks get their own labels
+            std::string label = "v_" + function->name + "_" + name;
+            int count = 0;
+            for(const auto& other : function->variables) {
+                count += other->name == name;
+            }
+            variable->label = count == 0 ? label : label + "_" + std::to_string(count);
+            function->variables.push_back(variable);
+        }
+        scopes.back()[name] = variable;
+        return variable;
+    }
+
+    // parses a function or global variables
+    void parseTopLevel() {
+        int line = peek().line;
+        bool isConst;
+        bool returnsValue = parseType(isConst);
+        std::string name = parseName();
+        if(!ok) {
+            return;
+        }
+        if(tryAccept("(")) {
+            parseFunction(name, returnsValue, line);
+        } else if(!returnsValue) {
+            error("variables may not be 'void'");
+        } else {
+            parseDeclarators(name, isConst);
+        }
+    }
+
+    // parses the declarations following 'int name', up to the ';'
+    // globals are initialized in memory, locals by the statements returned
+    std::shared_ptr<Statement> parseDeclarators(std::string name, bool isConst) {
+        auto block = std::make_shared<Statement>();
+        block->kind = statement_block;
+        block->line = peek().line;
+        while(ok) {
+            auto variable = declareVariable(name);
+            if(!ok) {
+                break;
+            }
+            if(tryAccept("[")) {
+                int length = 0;
+                auto size = parseExpression();
+                if(ok && (!tryEvalConstant(size, length) || length < 1 || length > 0x100)) {
+                    error("the size of array '" + name + "' must be a constant from 1 to 256");
+                }
+                expect("]");
+                variable->length = length;
+            }
+            variable->init.assign(variable->size(), 0);
+
+            if(tryAccept("=")) {
+                std::vector<std::shared_ptr<AstNode>> values;
+                if(variable->length > 0) {
+                    expect("{");
+                    while(ok && !isNext("}")) {
+                        values.push_back(parseAssignment());
+                        if(!tryAccept(",")) {
+                            break;
+                        }
+                    }
+                    expect("}");
+                    if(ok && (int)values.size() > variable->length) {
+                        error("too many initializers for '" + name + "'");
+                    }
+                } else {
+                    values.push_back(parseAssignment());
+                }
+                if(!ok) {
+                    break;
+                }
+
+                int value;
+                bool allConstant = true;
+                for(size_t i = 0; i < values.size(); i++) {
+                    if(tryEvalConstant(values[i], value)) {
+                        variable->init[i] = value & 0xFF;
+                    } else {
+                        allConstant = false;
+                    }
+                }
+                if(isConst && variable->length == 0 && allConstant) {
+                    variable->isConstant = true;
+                    variable->value = (signed char)variable->init[0];
+                } else if(function == nullptr && !allConstant) {
+                    error("global '" + name + "' must be initialized with constants");
+                } else if(function != nullptr) {
+                    // a local is initialized each time its declaration is reached
+                    for(size_t i = 0; i < values.size(); i++) {
+                        auto target = std::make_shared<AstNode>();
+                        target->line = values[i]->line;
+                        target->variable = variable;
+                        if(variable->length > 0) {
+                            target->kind = node_index;
+                            target->right = std::make_shared<AstNode>();
+                            target->right->value = i;
+                        } else {
+                            target->kind = node_variable;
+                        }
+                        auto assign = std::make_shared<AstNode>();
+                        assign->kind = node_assign;
+                        assign->op = "=";
+                        assign->line = values[i]->line;
+                        assign->left = target;
+                        assign->right = values[i];
+                        auto statement = std::make_shared<Statement>();
+                        statement->kind = statement_expression;
+                        statement->line = assign->line;
+                        statement->expr = assign;
+                        block->statements.push_back(statement);
+                    }
+                }
+            } else if(isConst) {
+                error("const '" + name + "' must be initialized");
+            }
+
+            if(!tryAccept(",")) {
+                break;
+            }
+            name = parseName();
+        }
+        expect(";");
+        return block;
+    }
+
+    // parses a function, after its name and '('
+    void parseFunction(const std::string& name, bool returnsValue, int line) {
+        std::shared_ptr<Function> previous = unit.functionMap.count(name) > 0 ? unit.functionMap[name] : nullptr;
+        if(findVariable(name) != nullptr) {
+            error("'" + name + "' is already declared as a variable");
+            return;
+        }
+        function = std::make_shared<Function>();
+        function->name = name;
+        function->returnsValue = returnsValue;
+        function->line = line;
+        scopes.push_back(std::map<std::string, std::shared_ptr<Variable>>());
+
+        if(!(isNext("void") && peek(1).text == ")" && tryAccept("void"))) {
+            while(ok && !isNext(")")) {
+                bool isConst;
+                if(!parseType(isConst)) {
+                    error("parameters may not be 'void'");
+                }
+                std::string paramName = parseName();
+                if(!ok) {
+                    break;
+                }
+                function->params.push_back(declareVariable(paramName));
+                if(!tryAccept(",")) {
+                    break;
+                }
+            }
+        }
+        expect(")");
+
+        if(previous != nullptr && (previous->params.size() != function->params.size() || previous->returnsValue != returnsValue)) {
+            error("'" + name + "' does not match its earlier declaration");
+        } else if(tryAccept(";")) {
+            // a declaration, defined later
+            if(previous == nullptr) {
+                unit.functionMap[name] = function;
+                unit.functions.push_back(function);
+            }
+        } else if(previous != nullptr && previous->isDefined) {
+            error("'" + name + "' is already defined");
+        } else {
+            function->isDefined = true;
+            function->body = parseBlock();
+            if(previous == nullptr) {
+                unit.functions.push_back(function);
+            } else {
+                *previous = *function;
+                function = previous;
+            }
+            unit.functionMap[name] = function;
+        }
+        scopes.pop_back();
+        function = nullptr;
+    }
+
+    // parses statements between '{' and '}', in their own scope
+    std::shared_ptr<Statement> parseBlock() {
+        auto block = std::make_shared<Statement>();
+        block->kind = statement_block;
+        block->line = peek().line;
+        expect("{");
+        scopes.push_back(std::map<std::string, std::shared_ptr<Variable>>());
+        while(ok && !isNext("}") && peek().type != token_end) {
+            block->statements.push_back(parseStatement());
+        }
+        scopes.pop_back();
+        expect("}");
+        return block;
+    }
+
+    // parses the condition of an if, while or do, between '(' and ')'
+    std::shared_ptr<AstNode> parseCondition() {
+        expect("(");
+        auto condition = parseExpression();
+        expect(")");
+        return condition;
+    }
+
+    std::shared_ptr<Statement> parseStatement() {
+        auto statement = std::make_shared<Statement>();
+        statement->line = peek().line;
+        if(isNext("{")) {
+            return parseBlock();
+        } else if(isTypeNext()) {
+            bool isConst;
+            if(!parseType(isConst)) {
+                error("variables may not be 'void'");
+                return statement;
+            }
+            std::string name = parseName();
+            if(!ok) {
+                return statement;
+            }
+            return parseDeclarators(name, isConst);
+        } else if(tryAccept("if")) {
+            statement->kind = statement_if;
+            statement->expr = parseCondition();
+            statement->body = parseStatement();
+            if(tryAccept("else")) {
+                statement->elseBody = parseStatement();
+            }
+        } else if(tryAccept("while")) {
+            statement->kind = statement_while;
+            statement->expr = parseCondition();
+            statement->body = parseStatement();
+        } else if(tryAccept("do")) {
+            statement->kind = statement_do;
+            statement->body = parseStatement();
+            expect("while");
+            statement->expr = parseCondition();
+            expect(";");
+        } else if(tryAccept("for")) {
+            statement->kind = statement_for;
+            // variables declared in the for are scoped to it
+            scopes.push_back(std::map<std::string, std::shared_ptr<Variable>>());
+            expect("(");
+            if(!tryAccept(";")) {
+                if(isTypeNext()) {
+                    statement->init = parseStatement();
+                } else {
+                    statement->init = std::make_shared<Statement>();
+                    statement->init->kind = statement_expression;
+                    statement->init->line = peek().line;
+                    statement->init->expr = parseExpression();
+                    expect(";");
+                }
+            }
+            if(!isNext(";")) {
+                statement->expr = parseExpression();
+            }
+            expect(";");
+            if(!isNext(")")) {
+                statement->step = parseExpression();
+            }
+            expect(")");
+            statement->body = parseStatement();
+            scopes.pop_back();
+        } else if(tryAccept("return")) {
+            statement->kind = statement_return;
+            if(!isNext(";")) {
+                statement->expr = parseExpression();
+            }
+            if(ok && (statement->expr != nullptr) != function->returnsValue) {
+                error(function->returnsValue ? "'" + function->name + "' must return a value" : "'" + function->name + "' is void and can't return a value");
+            }
+            expect(";");
+        } else if(tryAccept("break")) {
+            statement->kind = statement_break;
+            expect(";");
+        } else if(tryAccept("continue")) {
+            statement->kind = statement_continue;
+            expect(";");
+        } else if(tryAccept("asm") || tryAccept("__asm__")) {
+            statement->kind = statement_asm;
+            expect("(");
+            while(ok && peek().type == token_string) {
+                statement->text.append(next().text);
+            }
+            expect(")");
+            expect(";");
+        } else if(tryAccept(";")) {
+            statement->kind = statement_empty;
+        } else {
+            statement->kind = statement_expression;
+            statement->expr = parseExpression();
+            expect(";");
+        }
+        return statement;
+    }
+
+    std::shared_ptr<AstNode> parseExpression() {
+        return parseAssignment();
+    }
+
+    // returns true if the node may be assigned to
+    bool isAssignable(const std::shared_ptr<AstNode>& node) {
+        return (node->kind == node_variable && node->variable->length == 0 && !node->variable->isConstant) || node->kind == node_index;
+    }
+
+    std::shared_ptr<AstNode> parseAssignment() {
+        auto left = parseBinary(1);
+        if(!ok || !isAssignOp(peek())) {
+            return left;
+        }
+        auto node = std::make_shared<AstNode>();
+        node->kind = node_assign;
+        node->line = peek().line;
+        node->op = next().text;
+        if(!isAssignable(left)) {
+            error("the left side of '" + node->op + "' can't be assigned to");
+            return node;
+        }
+        node->left = left;
+        node->right = parseAssignment();
+        if(ok) {
+            addHelperCall(node->op.substr(0, node->op.size() - 1), node->left, node->right);
+        }
+        return node;
+    }
+
+    // parses binary operators binding at least as tightly as minPrecedence, left to right
+    std::shared_ptr<AstNode> parseBinary(int minPrecedence) {
+        auto left = parseUnary();
+        while(ok && binaryPrecedence(peek()) >= minPrecedence) {
+            int precedence = binaryPrecedence(peek());
+            auto node = std::make_shared<AstNode>();
+            node->kind = node_binary;
+            node->line = peek().line;
+            node->op = next().text;
+            node->left = left;
+            node->right = parseBinary(precedence + 1);
+            if(!ok) {
+                break;
+            }
+            // expressions of constants are folded, e.g. for 'SIZE - 1'
+            int value;
+            if(tryEvalConstant(node, value)) {
+                left = std::make_shared<AstNode>();
+                left->line = node->line;
+                left->value = value;
+                continue;
+            }
+            addHelperCall(node->op, node->left, node->right);
+            left = node;
+        }
+        return left;
+    }
+
+    // records the helper function needed by an operator as called, so that it is compiled
+    void addHelperCall(const std::string& op, const std::shared_ptr<AstNode>& left, const std::shared_ptr<AstNode>& right) {
+        std::string helper = helperFor(op, left, right);
+        if(!helper.empty() && function != nullptr) {
+            function->calls.insert(helper);
+        }
+    }
+
+    std::shared_ptr<AstNode> parseUnary() {
+        auto node = std::make_shared<AstNode>();
+        node->line = peek().line;
+        if(isNext("-") || isNext("+") || isNext("~") || isNext("!")) {
+            node->kind = node_unary;
+            node->op = next().text;
+            node->left = parseUnary();
+            // a negative literal is a literal
+            if(ok && node->op == "-" && node->left->kind == node_number) {
+                node->left->value = -node->left->value;
+                return node->left;
+            }
+            return node;
+        } else if(isNext("++") || isNext("--")) {
+            node->kind = node_increment;
+            node->op = next().text;
+            node->isPrefix = true;
+            node->left = parseUnary();
+            if(ok && !isAssignable(node->left)) {
+                error("'" + node->op + "' needs a variable");
+            }
+            return node;
+        }
+        return parsePostfix();
+    }
+
+    std::shared_ptr<AstNode> parsePostfix() {
+        auto node = parsePrimary();
+        while(ok) {
+            if(isNext("[")) {
+                if(node->kind != node_variable || node->variable->length == 0) {
+                    error("only arrays may be indexed");
+                    break;
+                }
+                next();
+                node->kind = node_index;
+                node->right = parseExpression();
+                expect("]");
+                int index;
+                if(ok && isConstantNode(node->right, index) && (index < 0 || index >= node->variable->length)) {
+                    error("index " + std::to_string(index) + " is out of range for '" + node->variable->name + "'");
+                }
+            } else if(isNext("++") || isNext("--")) {
+                auto increment = std::make_shared<AstNode>();
+                increment->kind = node_increment;
+                increment->line = peek().line;
+                increment->op = next().text;
+                if(!isAssignable(node)) {
+                    error("'" + increment->op + "' needs a variable");
+                }
+                increment->left = node;
+                node = increment;
+            } else {
+                break;
+            }
+        }
+        if(ok && node->kind == node_variable && node->variable->length > 0) {
+            error("array '" + node->variable->name + "' must be indexed");
+        }
+        return node;
+    }
+
+    std::shared_ptr<AstNode> parsePrimary() {
+        auto node = std::make_shared<AstNode>();
+        node->line = peek().line;
+        if(peek().type == token_number) {
+            node->kind = node_number;
+            node->value = next().value;
+        } else if(isNext("true") || isNext("false")) {
+            node->kind = node_number;
+            node->value = next().text == "true";
+        } else if(tryAccept("(")) {
+            node = parseExpression();
+            expect(")");
+        } else if(peek().type == token_identifier && peek(1).text == "(") {
+            node->kind = node_call;
+            node->op = next().text;
+            next();
+            while(ok && !isNext(")")) {
+                node->args.push_back(parseAssignment());
+                if(!tryAccept(",")) {
+                    break;
+                }
+            }
+            expect(")");
+            if(function != nullptr) {
+                function->calls.insert(node->op);
+            }
+        } else if(peek().type == token_identifier) {
+            node->kind = node_variable;
+            node->variable = findVariable(peek().text);
+            if(node->variable == nullptr) {
+                error("'" + peek().text + "' is not declared");
+            }
+            next();
+        } else {
+            error("expected an expression, found '" + peek().text + "'");
+        }
+        return node;
+    }
+};
+
+/*
+    the helper functions for operators which ssbc has no instructions for
+    they are routines of the runtime library (runtime/runtime.h), declared here so that they are
+    called like any other function, and placed as generated assembly only if used
+*/
+const char* HELPER_SOURCE = R"(
+int __mul(int a, int b);
+int __div(int a, int b);
+int __mod(int a, int b);
+int __shl(int a, int b);
+int __shr(int a, int b);
+)";
+
+// the runtime routine of each helper function
+const std::map<std::string, std::string> HELPER_ROUTINES = {
+    { "__mul", "mul8" },
+    { "__div", "div8" },
+    { "__mod", "mod8" },
+    { "__shl", "shl8" },
+    { "__shr", "shr8" }
+};
+
+/*
+    the middle-end, run with --optimize between parsing and code generation
+    the passes rewrite the syntax tree, since the code generator works from expression trees:
+    - small functions, and functions called once, are inlined with their own copies of their variables
+    - constants and copies of variables are propagated forwards, and operators on constants are folded
+    - unreachable statements, and stores to locals which are not read again, are removed
+    - expressions which don't change within a loop are computed once before it
+    - expressions computed again before their variables change are kept in a temporary
+
+    variables can't be pointed to, so the parameters and locals of a function are only changed by
+    its own statements, and a call only changes globals
+*/
+
+class MiddleEndStats {
+    public:
+    // calls replaced by the body of the function called
+    int inlined = 0;
+    // reads of variables replaced by a constant or another variable
+    int propagated = 0;
+    // operators evaluated at compile time
+    int folded = 0;
+    // statements and stores removed as unreachable or unused
+    int removed = 0;
+    // expressions moved out of loops
+    int hoisted = 0;
+    // expressions reused from a temporary rather than computed again
+    int reused = 0;
+};
+
+// what a statement or expression may change
+class Effects {
+    public:
+    // the scalar variables assigned
+    std::set<const Variable*> variables;
+    // the arrays stored to
+    std::set<const Variable*> arrays;
+    // true if a function is called, which may change any global
+    bool hasCall = false;
+    // true if there is inline assembly, which may change anything
+    bool hasAsm = false;
+
+    // returns true if the variable or array may be changed
+    bool mayChange(const Variable* variable) const {
+        return hasAsm || variables.count(variable) > 0 || arrays.count(variable) > 0 || (hasCall && variable->isGlobal);
+    }
+};
+
+void collectEffects(const std::shared_ptr<AstNode>& node, Effects& effects) {
+    if(node == nullptr) {
+        return;
+    }
+    if(node->kind == node_assign || node->kind == node_increment) {
+        if(node->left->kind == node_variable) {
+            effects.variables.insert(node->left->variable.get());
+        } else {
+            effects.arrays.insert(node->left->variable.get());
+        }
+    } else if(node->kind == node_call) {
+        effects.hasCall = true;
+    }
+    collectEffects(node->left, effects);
+    collectEffects(node->right, effects);
+    for(const auto& arg : node->args) {
+        collectEffects(arg, effects);
+    }
+}
+
+void collectEffects(const std::shared_ptr<Statement>& statement, Effects& effects) {
+    if(statement == nullptr) {
+        return;
+    }
+    if(statement->kind == statement_asm) {
+        effects.hasAsm = true;
+    }
+    collectEffects(statement->expr, effects);
+    collectEffects(statement->step, effects);
+    collectEffects(statement->init, effects);
+    collectEffects(statement->body, effects);
+    collectEffects(statement->elseBody, effects);
+    for(const auto& inner : statement->statements) {
+        collectEffects(inner, effects);
+    }
+}
+
+// collects the variables and arrays read by the expression
+void collectReads(const std::shared_ptr<AstNode>& node, std::set<const Variable*>& reads) {
+    if(node == nullptr) {
+        return;
+    }
+    if(node->kind == node_assign && node->op == "=" && node->left->kind == node_variable) {
+        // the target is only written
+        collectReads(node->right, reads);
+        return;
+    }
+    if(node->kind == node_variable || node->kind == node_index) {
+        reads.insert(node->variable.get());
+    }
+    collectReads(node->left, reads);
+    collectReads(node->right, reads);
+    for(const auto& arg : node->args) {
+        collectReads(arg, reads);
+    }
+}
+
+void collectReads(const std::shared_ptr<Statement>& statement, std::set<const Variable*>& reads) {
+    if(statement == nullptr) {
+        return;
+    }
+    collectReads(statement->expr, reads);
+    collectReads(statement->step, reads);
+    collectReads(statement->init, reads);
+    collectReads(statement->body, reads);
+    collectReads(statement->elseBody, reads);
+    for(const auto& inner : statement->statements) {
+        collectReads(inner, reads);
+    }
+}
+
+// collects the names of the functions called, including the helpers for operators
+void collectCalls(const std::shared_ptr<AstNode>& node, std::set<std::string>& calls) {
+    if(node == nullptr) {
+        return;
+    }
+    std::string helper;
+    if(node->kind == node_call) {
+        calls.insert(node->op);
+    } else if(node->kind == node_binary) {
+        helper = helperFor(node->op, node->left, node->right);
+    } else if(node->kind == node_assign && node->op != "=") {
+        helper = helperFor(node->op.substr(0, node->op.size() - 1), node->left, node->right);
+    }
+    if(!helper.empty()) {
+        calls.insert(helper);
+    }
+    collectCalls(node->left, calls);
+    collectCalls(node->right, calls);
+    for(const auto& arg : node->args) {
+        collectCalls(arg, calls);
+    }
+}
+
+void collectCalls(const std::shared_ptr<Statement>& statement, std::set<std::string>& calls) {
+    if(statement == nullptr) {
+        return;
+    }
+    collectCalls(statement->expr, calls);
+    collectCalls(statement->step, calls);
+    collectCalls(statement->init, calls);
+    collectCalls(statement->body, calls);
+    collectCalls(statement->elseBody, calls);
+    for(const auto& inner : statement->statements) {
+        collectCalls(inner, calls);
+    }
+}
+
+// collects the names of the functions called within loops, as collectCalls
+void collectLoopCalls(const std::shared_ptr<Statement>& statement, bool isInLoop, std::set<std::string>& calls) {
+    if(statement == nullptr) {
+        return;
+    }
+    bool isLoop = statement->kind == statement_while || statement->kind == statement_do || statement->kind == statement_for;
+    if(isInLoop || isLoop) {
+        collectCalls(statement->expr, calls);
+        collectCalls(statement->step, calls);
+    }
+    collectLoopCalls(statement->init, isInLoop, calls);
+    collectLoopCalls(statement->body, isInLoop || isLoop, calls);
+    collectLoopCalls(statement->elseBody, isInLoop, calls);
+    for(const auto& inner : statement->statements) {
+        collectLoopCalls(inner, isInLoop, calls);
+    }
+}
+
+// the number of nodes and statements, as a measure of the code generated
+int treeSize(const std::shared_ptr<AstNode>& node) {
+    if(node == nullptr) {
+        return 0;
+    }
+    int size = 1 + treeSize(node->left) + treeSize(node->right);
+    for(const auto& arg : node->args) {
+        size += treeSize(arg);
+    }
+    return size;
+}
+
+int treeSize(const std::shared_ptr<Statement>& statement) {
+    if(statement == nullptr) {
+        return 0;
+    }
+    // blocks only group statements
+    int size = statement->kind == statement_block ? 0 : 1;
+    size += treeSize(statement->expr) + treeSize(statement->step) + treeSize(statement->init)
+        + treeSize(statement->body) + treeSize(statement->elseBody);
+    for(const auto& inner : statement->statements) {
+        size += treeSize(inner);
+    }
+    return size;
+}
+
+using VariableMap = std::map<const Variable*, std::shared_ptr<Variable>>;
+
+// copies the expression, replacing the variables in the map
+std::shared_ptr<AstNode> cloneNode(const std::shared_ptr<AstNode>& node, const VariableMap& variables) {
+    if(node == nullptr) {
+        return nullptr;
+    }
+    auto copy = std::make_shared<AstNode>(*node);
+    if(node->variable != nullptr) {
+        auto found = variables.find(node->variable.get());
+        if(found != variables.end()) {
+            copy->variable = found->second;
+        }
+    }
+    copy->left = cloneNode(node->left, variables);
+    copy->right = cloneNode(node->right, variables);
+    for(auto& arg : copy->args) {
+        arg = cloneNode(arg, variables);
+    }
+    return copy;
+}
+
+std::shared_ptr<Statement> cloneStatement(const std::shared_ptr<Statement>& statement, const VariableMap& variables) {
+    if(statement == nullptr) {
+        return nullptr;
+    }
+    auto copy = std::make_shared<Statement>(*statement);
+    copy->expr = cloneNode(statement->expr, variables);
+    copy->step = cloneNode(statement->step, variables);
+    copy->init = cloneStatement(statement->init, variables);
+    copy->body = cloneStatement(statement->body, variables);
+    copy->elseBody = cloneStatement(statement->elseBody, variables);
+    for(auto& inner : copy->statements) {
+        inner = cloneStatement(inner, variables);
+    }
+    return copy;
+}
+
+std::shared_ptr<AstNode> makeNumber(int value, int line) {
+    auto node = std::make_shared<AstNode>();
+    node->kind = node_number;
+    node->value = value;
+    node->line = line;
+    return node;
+}
+
+std::shared_ptr<AstNode> makeVariableNode(const std::shared_ptr<Variable>& variable, int line) {
+    auto node = std::make_shared<AstNode>();
+    node->kind = node_variable;
+    node->variable = variable;
+    node->line = line;
+    return node;
+}
+
+std::shared_ptr<AstNode> makeAssign(const std::shared_ptr<AstNode>& target, const std::shared_ptr<AstNode>& value) {
+    auto node = std::make_shared<AstNode>();
+    node->kind = node_assign;
+    node->op = "=";
+    node->line = value->line;
+    node->left = target;
+    node->right = value;
+    return node;
+}
+
+std::shared_ptr<Statement> makeStatement(StatementKind kind, int line) {
+    auto statement = std::make_shared<Statement>();
+    statement->kind = kind;
+    statement->line = line;
+    return statement;
+}
+
+std::shared_ptr<Statement> makeExpressionStatement(const std::shared_ptr<AstNode>& expr) {
+    auto statement = makeStatement(statement_expression, expr->line);
+    statement->expr = expr;
+    return statement;
+}
+
+// evaluates the operator on constants as the generated code does, on signed 8-bit values
+// returns false if the result isn't known, e.g. when dividing by 0
+bool tryFoldBinary(const std::string& op, int a, int b, int& out_value) {
+    a = (signed char)a;
+    b = (signed char)b;
+    int result;
+    if(op == "+") {
+        result = a + b;
+    } else if(op == "-") {
+        result = a - b;
+    } else if(op == "*") {
+        result = a * b;
+    } else if(op == "/" && b != 0) {
+        result = a / b;
+    } else if(op == "%" && b != 0) {
+        result = a % b;
+    } else if(op == "&") {
+        result = a & b;
+    } else if(op == "|") {
+        result = a | b;
+    } else if(op == "^") {
+        result = a ^ b;
+    } else if(op == "<<") {
+        // shift counts are unsigned, as the runtime library takes them
+        result = (b & 0xFF) >= 8 ? 0 : a << b;
+    } else if(op == ">>") {
+        result = (b & 0xFF) >= 8 ? (a < 0 ? -1 : 0) : a >> b;
+    } else if(op == "==") {
+        result = a == b;
+    } else if(op == "!=") {
+        result = a != b;
+    } else if(op == "<") {
+        result = a < b;
+    } else if(op == ">=") {
+        result = a >= b;
+    } else if(op == ">") {
+        result = a > b;
+    } else if(op == "<=") {
+        result = a <= b;
+    } else if(op == "&&") {
+        result = a != 0 && b != 0;
+    } else if(op == "||") {
+        result = a != 0 || b != 0;
+    } else {
+        return false;
+    }
+    out_value = (signed char)result;
+    return true;
+}
+
+bool tryFoldUnary(const std::string& op, int a, int& out_value) {
+    a = (signed char)a;
+    int result;
+    if(op == "-") {
+        result = -a;
+    } else if(op == "~") {
+        result = ~a;
+    } else if(op == "!") {
+        result = a == 0;
+    } else if(op == "+") {
+        result = a;
+    } else {
+        return false;
+    }
+    out_value = (signed char)result;
+    return true;
+}
+
+// a rough count of the cycles taken to push the value of the expression
+int estimateCycles(const std::shared_ptr<AstNode>& node) {
+    int value;
+    switch(node->kind) {
+        case node_number:
+        case node_variable: {
+            return 5;
+        }
+        case node_index: {
+            return isConstantNode(node->right, value) ? 5 : estimateCycles(node->right) + 20;
+        }
+        case node_unary: {
+            return estimateCycles(node->left) + (node->op == "+" ? 0 : node->op == "!" ? 30 : 10);
+        }
+        case node_binary: {
+            int operands = estimateCycles(node->left) + estimateCycles(node->right);
+            const std::string& op = node->op;
+            if(op == "+" || op == "-") {
+                return operands + 5;
+            } else if(op == "&" || op == "|") {
+                return operands + 25;
+            } else if(op == "^") {
+                return operands + 60;
+            } else if(!helperFor(op, node->left, node->right).empty()) {
+                return operands + 400;
+            }
+            return operands + 30;
+        }
+        default: {
+            return 1000;
+        }
+    }
+}
+
+// returns true if the expression computes a value worth keeping in a temporary:
+// arithmetic without side effects, or an element at an index only known at run time
+// conditions are left alone, as the code generator branches on them without a value
+bool isReusable(const std::shared_ptr<AstNode>& node) {
+    if(hasSideEffects(node)) {
+        return false;
+    }
+    int value;
+    if(node->kind == node_index) {
+        return !isConstantNode(node->right, value);
+    } else if(node->kind == node_unary) {
+        return node->op == "-" || node->op == "~";
+    } else if(node->kind == node_binary) {
+        static const std::set<std::string> conditions = { "&&", "||", "==", "!=", "<", "<=", ">", ">=" };
+        return conditions.count(node->op) == 0;
+    }
+    return false;
+}
+
+// a string which is equal for expressions computing the same value from the same variables
+std::string nodeKey(const std::shared_ptr<AstNode>& node) {
+    int value;
+    if(isConstantNode(node, value)) {
+        return std::to_string(value & 0xFF);
+    }
+    switch(node->kind) {
+        case node_variable: {
+            return node->variable->label;
+        }
+        case node_index: {
+            return node->variable->label + "[" + nodeKey(node->right) + "]";
+        }
+        case node_unary: {
+            return node->op + "(" + nodeKey(node->left) + ")";
+        }
+        case node_binary: {
+            return "(" + nodeKey(node->left) + node->op + nodeKey(node->right) + ")";
+        }
+        default: {
+            return "";
+        }
+    }
+}
+
+// returns true if every path through the statement ends in a return
+bool alwaysReturns(const std::shared_ptr<Statement>& statement) {
+    if(statement == nullptr) {
+        return false;
+    } else if(statement->kind == statement_return) {
+        return true;
+    } else if(statement->kind == statement_block) {
+        for(const auto& inner : statement->statements) {
+            if(alwaysReturns(inner)) {
+                return true;
+            }
+        }
+    } else if(statement->kind == statement_if) {
+        return alwaysReturns(statement->body) && alwaysReturns(statement->elseBody);
+    }
+    return false;
+}
+
+bool containsReturn(const std::shared_ptr<Statement>& statement) {
+    if(statement == nullptr) {
+        return false;
+    }
+    if(statement->kind == statement_return) {
+        return true;
+    }
+    for(const auto& inner : statement->statements) {
+        if(containsReturn(inner)) {
+            return true;
+        }
+    }
+    return containsReturn(statement->init) || containsReturn(statement->body) || containsReturn(statement->elseBody);
+}
+
+// returns true if the statement does nothing
+bool isEmptyStatement(const std::shared_ptr<Statement>& statement) {
+    return statement == nullptr || statement->kind == statement_empty
+        || (statement->kind == statement_block && statement->statements.empty());
+}
+
+// what is known of a variable at a point: its constant value, or another variable it is a copy of
+class Fact {
+    public:
+    bool isConstant = false;
+    int value = 0;
+    std::shared_ptr<Variable> copyOf;
+
+    bool operator==(const Fact& other) const {
+        return isConstant == other.isConstant && value == other.value && copyOf == other.copyOf;
+    }
+};
+
+class Facts {
+    public:
+    std::map<const Variable*, Fact> known;
+    // false after a return, break or continue, until paths join
+    bool isReachable = true;
+};
+
+// an expression computed earlier, which may be reused while its variables are unchanged
+class Available {
+    public:
+    std::string key;
+    // where it is first computed, which is made to also store it in temp once it is reused
+    std::shared_ptr<AstNode> first;
+    std::shared_ptr<Variable> temp;
+    std::set<const Variable*> reads;
+};
+
+using AvailableList = std::vector<std::shared_ptr<Available>>;
+
+// the largest function inlined wherever it is called, as counted by treeSize
+const int INLINE_SIZE = 16;
+
+class MiddleEnd {
+    public:
+    MiddleEnd(CompileUnit& _unit, MiddleEndStats& _stats) : unit(_unit), stats(_stats) { }
+
+    void run() {
+        inlineCalls();
+        for(const auto& each : unit.functions) {
+            if(!each->isDefined || each->isRuntime) {
+                continue;
+            }
+            function = each;
+            for(int i = 0; i < 2; i++) {
+                cleanUp();
+            }
+            hoistInvariants(function->body);
+            AvailableList available;
+            reuse(function->body, available);
+            // the temporaries are often copied, or left unread
+            cleanUp();
+        }
+        for(const auto& each : unit.functions) {
+            each->calls.clear();
+            collectCalls(each->body, each->calls);
+        }
+    }
+
+    private:
+    CompileUnit& unit;
+    MiddleEndStats& stats;
+    // the function being optimized
+    std::shared_ptr<Function> function;
+    int inlineCount = 0;
+    int tempCount = 0;
+
+    // propagates, removes unreachable statements, then removes dead stores
+    void cleanUp() {
+        Facts facts;
+        propagate(function->body, facts);
+        function->body = simplify(function->body);
+        locals.clear();
+        for(const auto& variable : function->variables) {
+            if(variable->length == 0 && !variable->isConstant) {
+                locals.insert(variable.get());
+            }
+        }
+        liveness(function->body, LiveSet(), true);
+    }
+
+    // a variable for an expression, in the function being optimized
+    std::shared_ptr<Variable> newTemp() {
+        auto temp = std::make_shared<Variable>();
+        temp->label = "o" + std::to_string(++tempCount);
+        temp->name = temp->label;
+        function->variables.push_back(temp);
+        return temp;
+    }
+
+    /*
+        inlining
+    */
+
+    // the number of calls to each function
+    std::map<std::string, int> callCounts;
+
+    void countCalls(const std::shared_ptr<AstNode>& node) {
+        if(node == nullptr) {
+            return;
+        }
+        if(node->kind == node_call) {
+            ++callCounts[node->op];
+        }
+        countCalls(node->left);
+        countCalls(node->right);
+        for(const auto& arg : node->args) {
+            countCalls(arg);
+        }
+    }
+
+    void countCalls(const std::shared_ptr<Statement>& statement) {
+        if(statement == nullptr) {
+            return;
+        }
+        countCalls(statement->expr);
+        countCalls(statement->step);
+        countCalls(statement->init);
+        countCalls(statement->body);
+        countCalls(statement->elseBody);
+        for(const auto& inner : statement->statements) {
+            countCalls(inner);
+        }
+    }
+
+    // replaces calls with the body of the function called until none are left to inline
+    void inlineCalls() {
+        bool changed = true;
+        for(int round = 0; round < 4 && changed; round++) {
+            changed = false;
+            callCounts.clear();
+            for(const auto& each : unit.functions) {
+                countCalls(each->body);
+            }
+            for(const auto& each : unit.functions) {
+                if(each->isDefined && !each->isRuntime) {
+                    function = each;
+                    changed |= inlineWithin(function->body);
+                }
+            }
+        }
+    }
+
+    // returns true if calls to the function may be replaced by its body: it must not call
+    // functions itself, so that inlining ends, and be small or only called once
+    // local arrays keep their contents between calls, so a function with one is left alone
+    bool isInlinable(const std::shared_ptr<Function>& callee) {
+        if(!callee->isDefined || callee->name == "main" || callee->name.compare(0, 2, "__") == 0 || callee == function) {
+            return false;
+        }
+        for(const auto& variable : callee->variables) {
+            if(variable->length > 0) {
+                return false;
+            }
+        }
+        Effects effects;
+        collectEffects(callee->body, effects);
+        if(effects.hasCall || effects.hasAsm) {
+            return false;
+        }
+        return treeSize(callee->body) <= INLINE_SIZE || callCounts[callee->name] == 1;
+    }
+
+    // returns the first call in the expression which is always evaluated and may be inlined, or null
+    std::shared_ptr<AstNode>* findInlineCall(std::shared_ptr<AstNode>& node) {
+        if(node == nullptr) {
+            return nullptr;
+        }
+        if(node->kind == node_call) {
+            // the arguments are evaluated before the call
+            for(auto& arg : node->args) {
+                auto found = findInlineCall(arg);
+                if(found != nullptr) {
+                    return found;
+                }
+            }
+            auto callee = unit.functionMap.find(node->op);
+            if(callee != unit.functionMap.end() && isInlinable(callee->second) && callee->second->params.size() == node->args.size()) {
+                return &node;
+            }
+            return nullptr;
+        }
+        auto found = findInlineCall(node->left);
+        if(found != nullptr) {
+            return found;
+        }
+        bool isShortCircuit = node->kind == node_binary && (node->op == "&&" || node->op == "||");
+        return isShortCircuit ? nullptr : findInlineCall(node->right);
+    }
+
+    // replaces each return in the statements with a statement made from its value, so that they may be
+    // placed inline, moving the statements following an if into its branch which doesn't return
+    // returns false if a return is not at the end of a path, e.g. within a loop
+    bool tryLowerReturns(std::vector<std::shared_ptr<Statement>>& statements, const std::function<std::shared_ptr<Statement>(const std::shared_ptr<AstNode>&)>& makeResult) {
+        for(size_t i = 0; i < statements.size(); i++) {
+            auto statement = statements[i];
+            if(!containsReturn(statement)) {
+                continue;
+            }
+            if(statement->kind == statement_return) {
+                statements[i] = makeResult(statement->expr);
+                statements.resize(i + 1);
+                return true;
+            }
+            if(statement->kind == statement_block) {
+                // scopes are already resolved, so a block's statements may be moved into the list
+                std::vector<std::shared_ptr<Statement>> inner = statement->statements;
+                statements.erase(statements.begin() + i);
+                statements.insert(statements.begin() + i, inner.begin(), inner.end());
+                --i;
+                continue;
+            }
+            bool thenReturns = alwaysReturns(statement->body);
+            bool elseReturns = alwaysReturns(statement->elseBody);
+            if(statement->kind != statement_if || (!thenReturns && !elseReturns)) {
+                return false;
+            }
+            std::vector<std::shared_ptr<Statement>> rest(statements.begin() + i + 1, statements.end());
+            statements.resize(i + 1);
+            auto thenBlock = makeStatement(statement_block, statement->line);
+            auto elseBlock = makeStatement(statement_block, statement->line);
+            thenBlock->statements.push_back(statement->body);
+            if(statement->elseBody != nullptr) {
+                elseBlock->statements.push_back(statement->elseBody);
+            }
+            if(!thenReturns) {
+                thenBlock->statements.insert(thenBlock->statements.end(), rest.begin(), rest.end());
+            } else if(!elseReturns) {
+                elseBlock->statements.insert(elseBlock->statements.end(), rest.begin(), rest.end());
+            }
+            statement->body = thenBlock;
+            statement->elseBody = elseBlock;
+            return tryLowerReturns(thenBlock->statements, makeResult) && tryLowerReturns(elseBlock->statements, makeResult);
+        }
+        return true;
+    }
+
+    // replaces the first call in the statement which may be inlined with the body of the function,
+    // placed before the statement, which uses its result from a variable
+    // returns false if there is no such call
+    bool tryInlineStatement(std::shared_ptr<Statement>& statement) {
+        bool isEvaluatedOnce = statement->kind == statement_expression || statement->kind == statement_return || statement->kind == statement_if;
+        if(!isEvaluatedOnce || statement->expr == nullptr) {
+            return false;
+        }
+        auto& expr = statement->expr;
+        auto slot = findInlineCall(expr);
+        if(slot == nullptr) {
+            return false;
+        }
+        auto call = *slot;
+        auto callee = unit.functionMap[call->op];
+        bool isWhole = slot == &expr;
+        bool keepsReturns = isWhole && statement->kind == statement_return;
+        bool isDiscarded = isWhole && statement->kind == statement_expression;
+        if(!isDiscarded && !callee->returnsValue) {
+            // the code generator reports the error
+            return false;
+        }
+
+        // where the result goes: returned from the caller, discarded, stored in the variable
+        // assigned, or a new variable standing in for the call
+        std::shared_ptr<AstNode> target;
+        bool isAssigned = statement->kind == statement_expression && expr->kind == node_assign && expr->op == "="
+            && expr->left->kind == node_variable && slot == &expr->right;
+
+        // the rest of the statement now runs after the call: as its operands may be evaluated in
+        // any order, it only mustn't share globals with the call, when either changes them
+        Effects calleeEffects;
+        collectEffects(callee->body, calleeEffects);
+        std::set<const Variable*> calleeReads;
+        collectReads(callee->body, calleeReads);
+        *slot = makeNumber(0, call->line);
+        Effects restEffects;
+        collectEffects(expr, restEffects);
+        std::set<const Variable*> restReads;
+        collectReads(expr, restReads);
+        *slot = call;
+        for(const auto& variable : calleeReads) {
+            if(variable->isGlobal && (restEffects.hasCall || restEffects.mayChange(variable))) {
+                return false;
+            }
+        }
+        for(const auto* changed : { &calleeEffects.variables, &calleeEffects.arrays }) {
+            for(const auto& variable : *changed) {
+                if(variable->isGlobal && (restEffects.hasCall || restReads.count(variable) > 0 || restEffects.mayChange(variable))) {
+                    return false;
+                }
+            }
+        }
+
+        if(isAssigned) {
+            target = expr->left;
+        } else if(!keepsReturns && !isDiscarded) {
+            auto result = std::make_shared<Variable>();
+            result->name = "result";
+            target = makeVariableNode(result, call->line);
+        }
+        auto makeResult = [&](const std::shared_ptr<AstNode>& value) {
+            if(value == nullptr) {
+                return makeStatement(statement_empty, call->line);
+            } else if(target == nullptr) {
+                return makeExpressionStatement(value);
+            }
+            return makeExpressionStatement(makeAssign(cloneNode(target, VariableMap()), value));
+        };
+
+        // the callee's variables are copied, so that each call inlined has its own, e.g. v_f_x to i1_f_x
+        int instance = ++inlineCount;
+        VariableMap variables;
+        for(const auto& variable : callee->variables) {
+            if(!variable->isConstant) {
+                auto copy = std::make_shared<Variable>(*variable);
+                copy->label = "i" + std::to_string(instance) + "_" + variable->label.substr(2);
+                copy->isUsed = false;
+                variables[variable.get()] = copy;
+            }
+        }
+        auto body = cloneStatement(callee->body, variables);
+        if(callee->returnsValue && !alwaysReturns(body)) {
+            // as in the generated code, falling off the end returns 0
+            auto returnZero = makeStatement(statement_return, callee->line);
+            returnZero->expr = makeNumber(0, callee->line);
+            body->statements.push_back(returnZero);
+        }
+        if(!keepsReturns && !tryLowerReturns(body->statements, makeResult)) {
+            return false;
+        }
+
+        auto block = makeStatement(statement_block, statement->line);
+        for(size_t i = 0; i < call->args.size(); i++) {
+            auto param = makeVariableNode(variables[callee->params[i].get()], call->line);
+            block->statements.push_back(makeExpressionStatement(makeAssign(param, call->args[i])));
+        }
+        block->statements.push_back(body);
+        if(target != nullptr && !isAssigned) {
+            // the statement follows, reading the result
+            target->variable->label = "i" + std::to_string(instance) + "_result";
+            variables[target->variable.get()] = target->variable;
+            *slot = target;
+            block->statements.push_back(statement);
+        }
+        for(const auto& variable : variables) {
+            function->variables.push_back(variable.second);
+        }
+        statement = block;
+        ++stats.inlined;
+        return true;
+    }
+
+    // inlines calls within the statement and those nested in it
+    // returns true if any were inlined
+    bool inlineWithin(std::shared_ptr<Statement>& statement) {
+        if(statement == nullptr) {
+            return false;
+        }
+        bool changed = false;
+        while(tryInlineStatement(statement)) {
+            changed = true;
+        }
+        changed |= inlineWithin(statement->init);
+        changed |= inlineWithin(statement->body);
+        changed |= inlineWithin(statement->elseBody);
+        for(auto& inner : statement->statements) {
+            changed |= inlineWithin(inner);
+        }
+        return changed;
+    }
+
+    /*
+        constant and copy propagation
+    */
+
+    // forgets the variable, and any variable known to be a copy of it
+    void forget(Facts& facts, const Variable* variable) {
+        facts.known.erase(variable);
+        for(auto fact = facts.known.begin(); fact != facts.known.end();) {
+            if(fact->second.copyOf.get() == variable) {
+                fact = facts.known.erase(fact);
+            } else {
+                ++fact;
+            }
+        }
+    }
+
+    void forget(Facts& facts, const Effects& effects) {
+        if(effects.hasAsm) {
+            facts.known.clear();
+            return;
+        }
+        for(const auto& variable : effects.variables) {
+            forget(facts, variable);
+        }
+        if(effects.hasCall) {
+            for(auto fact = facts.known.begin(); fact != facts.known.end();) {
+                if(fact->first->isGlobal || (fact->second.copyOf != nullptr && fact->second.copyOf->isGlobal)) {
+                    fact = facts.known.erase(fact);
+                } else {
+                    ++fact;
+                }
+            }
+        }
+    }
+
+    // what is known where two paths join
+    Facts meet(const Facts& a, const Facts& b) {
+        if(!a.isReachable) {
+            return b;
+        } else if(!b.isReachable) {
+            return a;
+        }
+        Facts result;
+        for(const auto& fact : a.known) {
+            auto other = b.known.find(fact.first);
+            if(other != b.known.end() && other->second == fact.second) {
+                result.known.insert(fact);
+            }
+        }
+        return result;
+    }
+
+    // evaluates the node if its operands are constant, or drops an operand which changes nothing
+    std::shared_ptr<AstNode> fold(const std::shared_ptr<AstNode>& node) {
+        int a, b, value;
+        if(node->kind == node_unary && isConstantNode(node->left, a) && tryFoldUnary(node->op, a, value)) {
+            ++stats.folded;
+            return makeNumber(value, node->line);
+        }
+        if(node->kind != node_binary) {
+            return node;
+        }
+        const std::string& op = node->op;
+        bool isLeftConstant = isConstantNode(node->left, a);
+        bool isRightConstant = isConstantNode(node->right, b);
+        if(isLeftConstant && isRightConstant && tryFoldBinary(op, a, b, value)) {
+            ++stats.folded;
+            return makeNumber(value, node->line);
+        }
+        if(isRightConstant && (b & 0xFF) == 0 && (op == "+" || op == "-" || op == "|" || op == "^" || op == "<<" || op == ">>")) {
+            ++stats.folded;
+            return node->left;
+        }
+        if(isLeftConstant && (a & 0xFF) == 0 && (op == "+" || op == "|" || op == "^")) {
+            ++stats.folded;
+            return node->right;
+        }
+        if((isRightConstant && (b & 0xFF) == 1 && (op == "*" || op == "/")) || (isLeftConstant && (a & 0xFF) == 1 && op == "*")) {
+            ++stats.folded;
+            return isRightConstant ? node->left : node->right;
+        }
+        return node;
+    }
+
+    // replaces reads of variables with what is known of them, unless the expression itself
+    // changes them, then folds the expression
+    std::shared_ptr<AstNode> substitute(const std::shared_ptr<AstNode>& node, const Facts& facts, const Effects& effects) {
+        if(node == nullptr) {
+            return nullptr;
+        }
+        if(node->kind == node_variable) {
+            auto fact = facts.known.find(node->variable.get());
+            if(node->variable->isConstant || fact == facts.known.end() || effects.mayChange(node->variable.get())) {
+                return node;
+            }
+            if(fact->second.isConstant) {
+                ++stats.propagated;
+                return makeNumber(fact->second.value, node->line);
+            } else if(!effects.mayChange(fact->second.copyOf.get())) {
+                ++stats.propagated;
+                return makeVariableNode(fact->second.copyOf, node->line);
+            }
+            return node;
+        }
+        if(node->kind == node_assign || node->kind == node_increment) {
+            // the target is written, though the index of an element is read
+            if(node->left->kind == node_index) {
+                node->left->right = substitute(node->left->right, facts, effects);
+            }
+            node->right = substitute(node->right, facts, effects);
+            return node;
+        }
+        node->left = substitute(node->left, facts, effects);
+        node->right = substitute(node->right, facts, effects);
+        for(auto& arg : node->args) {
+            arg = substitute(arg, facts, effects);
+        }
+        return fold(node);
+    }
+
+    // rewrites the expression from the facts, then updates them with what it changes
+    void propagate(std::shared_ptr<AstNode>& expr, Facts& facts) {
+        if(expr == nullptr) {
+            return;
+        }
+        Effects effects;
+        collectEffects(expr, effects);
+        expr = substitute(expr, facts, effects);
+        forget(facts, effects);
+        if(expr->kind == node_assign && expr->op == "=" && expr->left->kind == node_variable) {
+            const auto& target = expr->left->variable;
+            const auto& value = expr->right;
+            Fact fact;
+            if(isConstantNode(value, fact.value)) {
+                fact.isConstant = true;
+                fact.value = (signed char)fact.value;
+                facts.known[target.get()] = fact;
+            } else if(value->kind == node_variable && value->variable != target) {
+                fact.copyOf = value->variable;
+                facts.known[target.get()] = fact;
+            }
+        }
+    }
+
+    void propagate(const std::shared_ptr<Statement>& statement, Facts& facts) {
+        switch(statement->kind) {
+            case statement_expression: {
+                propagate(statement->expr, facts);
+                break;
+            }
+            case statement_block: {
+                for(const auto& inner : statement->statements) {
+                    propagate(inner, facts);
+                }
+                break;
+            }
+            case statement_if: {
+                propagate(statement->expr, facts);
+                int value;
+                if(isConstantNode(statement->expr, value)) {
+                    // the other branch is removed by simplify()
+                    if(value != 0) {
+                        propagate(statement->body, facts);
+                    } else if(statement->elseBody != nullptr) {
+                        propagate(statement->elseBody, facts);
+                    }
+                    break;
+                }
+                Facts thenFacts = facts;
+                propagate(statement->body, thenFacts);
+                if(statement->elseBody != nullptr) {
+                    propagate(statement->elseBody, facts);
+                }
+                facts = meet(thenFacts, facts);
+                break;
+            }
+            case statement_while:
+            case statement_for:
+            case statement_do: {
+                if(statement->init != nullptr) {
+                    propagate(statement->init, facts);
+                }
+                // only what the loop doesn't change is known throughout it
+                Effects effects;
+                collectEffects(statement->expr, effects);
+                collectEffects(statement->step, effects);
+                collectEffects(statement->body, effects);
+                forget(facts, effects);
+                Facts conditionFacts = facts;
+                propagate(statement->expr, conditionFacts);
+                Facts bodyFacts = facts;
+                propagate(statement->body, bodyFacts);
+                Facts stepFacts = facts;
+                propagate(statement->step, stepFacts);
+                break;
+            }
+            case statement_return:
+            case statement_break:
+            case statement_continue: {
+                propagate(statement->expr, facts);
+                facts.known.clear();
+                facts.isReachable = false;
+                break;
+            }
+            case statement_asm: {
+                facts.known.clear();
+                break;
+            }
+            case statement_empty: {
+                break;
+            }
+        }
+    }
+
+    /*
+        removing unreachable statements
+    */
+
+    // returns the statement with branches on constants resolved and statements which do nothing removed
+    std::shared_ptr<Statement> simplify(const std::shared_ptr<Statement>& statement) {
+        int value;
+        switch(statement->kind) {
+            case statement_block: {
+                std::vector<std::shared_ptr<Statement>> statements;
+                for(size_t i = 0; i < statement->statements.size(); i++) {
+                    if(!statements.empty() && (statements.back()->kind == statement_return
+                        || statements.back()->kind == statement_break || statements.back()->kind == statement_continue)) {
+                        // the rest can't be reached
+                        stats.removed += statement->statements.size() - i;
+                        break;
+                    }
+                    auto inner = simplify(statement->statements[i]);
+                    if(inner->kind == statement_block) {
+                        // scopes are already resolved, so nested blocks are flattened
+                        statements.insert(statements.end(), inner->statements.begin(), inner->statements.end());
+                    } else if(!isEmptyStatement(inner)) {
+                        statements.push_back(inner);
+                    }
+                }
+                statement->statements = statements;
+                return statement;
+            }
+            case statement_expression: {
+                const auto& expr = statement->expr;
+                bool isSelfAssign = expr->kind == node_assign && expr->op == "=" && expr->left->kind == node_variable
+                    && expr->right->kind == node_variable && expr->left->variable == expr->right->variable;
+                if(!hasSideEffects(expr) || isSelfAssign) {
+                    ++stats.removed;
+                    return makeStatement(statement_empty, statement->line);
+                }
+                return statement;
+            }
+            case statement_if: {
+                statement->body = simplify(statement->body);
+                if(statement->elseBody != nullptr) {
+                    statement->elseBody = simplify(statement->elseBody);
+                }
+                if(isConstantNode(statement->expr, value)) {
+                    ++stats.removed;
+                    auto taken = value != 0 ? statement->body : statement->elseBody;
+                    return taken != nullptr ? taken : makeStatement(statement_empty, statement->line);
+                }
+                if(isEmptyStatement(statement->elseBody)) {
+                    statement->elseBody = nullptr;
+                }
+                if(isEmptyStatement(statement->body)) {
+                    if(statement->elseBody == nullptr) {
+                        auto effect = makeExpressionStatement(statement->expr);
+                        return simplify(effect);
+                    }
+                    // if(c) {} else x; is if(!c) x;
+                    auto negated = std::make_shared<AstNode>();
+                    negated->kind = node_unary;
+                    negated->op = "!";
+                    negated->line = statement->expr->line;
+                    negated->left = statement->expr;
+                    statement->expr = negated;
+                    statement->body = statement->elseBody;
+                    statement->elseBody = nullptr;
+                }
+                return statement;
+            }
+            case statement_while:
+            case statement_for: {
+                if(statement->init != nullptr) {
+                    statement->init = simplify(statement->init);
+                }
+                statement->body = simplify(statement->body);
+                if(statement->expr != nullptr && isConstantNode(statement->expr, value) && value == 0) {
+                    ++stats.removed;
+                    return statement->init != nullptr ? statement->init : makeStatement(statement_empty, statement->line);
+                }
+                return statement;
+            }
+            case statement_do: {
+                statement->body = simplify(statement->body);
+                return statement;
+            }
+            default: {
+                return statement;
+            }
+        }
+    }
+
+    /*
+        dead store elimination
+    */
+
+    using LiveSet = std::set<const Variable*>;
+    // the function's own scalars, whose stores may be removed
+    LiveSet locals;
+    // what is live where a break and a continue go, for each loop entered
+    std::vector<std::pair<LiveSet, LiveSet>> loopLive;
+
+    // adds the locals read by the expression
+    void addUses(const std::shared_ptr<AstNode>& node, LiveSet& live) {
+        std::set<const Variable*> reads;
+        collectReads(node, reads);
+        for(const auto& variable : reads) {
+            if(locals.count(variable) > 0) {
+                live.insert(variable);
+            }
+        }
+    }
+
+    // returns the locals which may be read after the start of the statement, given those which may be
+    // read after its end, removing stores to locals which won't be read if remove
+    LiveSet liveness(const std::shared_ptr<Statement>& statement, const LiveSet& liveOut, bool remove) {
+        LiveSet live = liveOut;
+        switch(statement->kind) {
+            case statement_expression: {
+                auto& expr = statement->expr;
+                bool isStore = (expr->kind == node_assign || expr->kind == node_increment) && expr->left->kind == node_variable;
+                if(remove && isStore && locals.count(expr->left->variable.get()) > 0 && liveOut.count(expr->left->variable.get()) == 0) {
+                    ++stats.removed;
+                    if(expr->kind == node_assign && hasSideEffects(expr->right)) {
+                        auto value = expr->right;
+                        expr = value;
+                    } else {
+                        statement->kind = statement_empty;
+                        statement->expr = nullptr;
+                        return live;
+                    }
+                }
+                if(expr->kind == node_assign && expr->op == "=" && expr->left->kind == node_variable) {
+                    live.erase(expr->left->variable.get());
+                }
+                addUses(expr, live);
+                return live;
+            }
+            case statement_block: {
+                for(auto inner = statement->statements.rbegin(); inner != statement->statements.rend(); ++inner) {
+                    live = liveness(*inner, live, remove);
+                }
+                return live;
+            }
+            case statement_if: {
+                live = liveness(statement->body, liveOut, remove);
+                if(statement->elseBody != nullptr) {
+                    LiveSet elseLive = liveness(statement->elseBody, liveOut, remove);
+                    live.insert(elseLive.begin(), elseLive.end());
+                } else {
+                    live.insert(liveOut.begin(), liveOut.end());
+                }
+                addUses(statement->expr, live);
+                return live;
+            }
+            case statement_while:
+            case statement_for: {
+                // the condition goes to the body or out, and the body goes through the step to the condition
+                LiveSet head = liveOut;
+                addUses(statement->expr, head);
+                LiveSet stepIn;
+                while(true) {
+                    stepIn = head;
+                    addUses(statement->step, stepIn);
+                    loopLive.push_back(std::make_pair(liveOut, stepIn));
+                    LiveSet bodyIn = liveness(statement->body, stepIn, false);
+                    loopLive.pop_back();
+                    LiveSet next = head;
+                    next.insert(bodyIn.begin(), bodyIn.end());
+                    if(next == head) {
+                        break;
+                    }
+                    head = next;
+                }
+                if(remove) {
+                    loopLive.push_back(std::make_pair(liveOut, stepIn));
+                    liveness(statement->body, stepIn, true);
+                    loopLive.pop_back();
+                }
+                return statement->init != nullptr ? liveness(statement->init, head, remove) : head;
+            }
+            case statement_do: {
+                // the body goes to the condition, which goes to the body or out
+                LiveSet conditionIn = liveOut;
+                addUses(statement->expr, conditionIn);
+                LiveSet bodyIn;
+                while(true) {
+                    loopLive.push_back(std::make_pair(liveOut, conditionIn));
+                    bodyIn = liveness(statement->body, conditionIn, false);
+                    loopLive.pop_back();
+                    LiveSet next = conditionIn;
+                    next.insert(bodyIn.begin(), bodyIn.end());
+                    if(next == conditionIn) {
+                        break;
+                    }
+                    conditionIn = next;
+                }
+                if(remove) {
+                    loopLive.push_back(std::make_pair(liveOut, conditionIn));
+                    bodyIn = liveness(statement->body, conditionIn, true);
+                    loopLive.pop_back();
+                }
+                return bodyIn;
+            }
+            case statement_return: {
+                live.clear();
+                addUses(statement->expr, live);
+                return live;
+            }
+            case statement_break: {
+                return loopLive.empty() ? live : loopLive.back().first;
+            }
+            case statement_continue: {
+                return loopLive.empty() ? live : loopLive.back().second;
+            }
+            case statement_asm: {
+                return locals;
+            }
+            default: {
+                return live;
+            }
+        }
+    }
+
+    /*
+        loop-invariant code motion
+    */
+
+    // returns true if the expression gives the same value throughout a loop with the effects
+    bool isInvariant(const std::shared_ptr<AstNode>& node, const Effects& effects) {
+        std::set<const Variable*> reads;
+        collectReads(node, reads);
+        for(const auto& variable : reads) {
+            if(effects.mayChange(variable)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // replaces the largest invariant expressions within the node with temporaries, assigned by hoisted
+    void replaceInvariants(std::shared_ptr<AstNode>& node, const Effects& effects, std::vector<std::shared_ptr<Statement>>& hoisted, std::map<std::string, std::shared_ptr<Variable>>& temps) {
+        if(node == nullptr) {
+            return;
+        }
+        if(isReusable(node) && isInvariant(node, effects)) {
+            auto& temp = temps[nodeKey(node)];
+            if(temp == nullptr) {
+                temp = newTemp();
+                hoisted.push_back(makeExpressionStatement(makeAssign(makeVariableNode(temp, node->line), node)));
+            }
+            ++stats.hoisted;
+            node = makeVariableNode(temp, node->line);
+            return;
+        }
+        if(node->kind == node_assign || node->kind == node_increment) {
+            if(node->left->kind == node_index) {
+                replaceInvariants(node->left->right, effects, hoisted, temps);
+            }
+            replaceInvariants(node->right, effects, hoisted, temps);
+            return;
+        }
+        replaceInvariants(node->left, effects, hoisted, temps);
+        replaceInvariants(node->right, effects, hoisted, temps);
+        for(auto& arg : node->args) {
+            replaceInvariants(arg, effects, hoisted, temps);
+        }
+    }
+
+    void replaceInvariants(const std::shared_ptr<Statement>& statement, const Effects& effects, std::vector<std::shared_ptr<Statement>>& hoisted, std::map<std::string, std::shared_ptr<Variable>>& temps) {
+        if(statement == nullptr) {
+            return;
+        }
+        replaceInvariants(statement->expr, effects, hoisted, temps);
+        replaceInvariants(statement->step, effects, hoisted, temps);
+        replaceInvariants(statement->init, effects, hoisted, temps);
+        replaceInvariants(statement->body, effects, hoisted, temps);
+        replaceInvariants(statement->elseBody, effects, hoisted, temps);
+        for(const auto& inner : statement->statements) {
+            replaceInvariants(inner, effects, hoisted, temps);
+        }
+    }
+
+    // moves what doesn't change within each loop to before it, innermost loops first
+    // expressions have no side effects and can't fault, so they may be computed even if the loop isn't run
+    void hoistInvariants(std::shared_ptr<Statement>& statement) {
+        if(statement == nullptr) {
+            return;
+        }
+        hoistInvariants(statement->init);
+        hoistInvariants(statement->body);
+        hoistInvariants(statement->elseBody);
+        for(auto& inner : statement->statements) {
+            hoistInvariants(inner);
+        }
+        if(statement->kind != statement_while && statement->kind != statement_for && statement->kind != statement_do) {
+            return;
+        }
+        Effects effects;
+        collectEffects(statement->expr, effects);
+        collectEffects(statement->step, effects);
+        collectEffects(statement->body, effects);
+        if(effects.hasAsm) {
+            return;
+        }
+        std::vector<std::shared_ptr<Statement>> hoisted;
+        std::map<std::string, std::shared_ptr<Variable>> temps;
+        replaceInvariants(statement->expr, effects, hoisted, temps);
+        replaceInvariants(statement->step, effects, hoisted, temps);
+        replaceInvariants(statement->body, effects, hoisted, temps);
+        if(hoisted.empty()) {
+            return;
+        }
+        // the hoisted statements go after a for's initializer, which they may read
+        auto block = makeStatement(statement_block, statement->line);
+        if(statement->init != nullptr) {
+            block->statements.push_back(statement->init);
+            statement->init = nullptr;
+        }
+        block->statements.insert(block->statements.end(), hoisted.begin(), hoisted.end());
+        block->statements.push_back(statement);
+        statement = block;
+    }
+
+    /*
+        common subexpression elimination
+    */
+
+    // forgets the expressions whose variables may be changed
+    void forget(AvailableList& available, const Effects& effects) {
+        available.erase(std::remove_if(available.begin(), available.end(), [&](const std::shared_ptr<Available>& entry) {
+            for(const auto& variable : entry->reads) {
+                if(effects.mayChange(variable)) {
+                    return true;
+                }
+            }
+            return false;
+        }), available.end());
+    }
+
+    // replaces expressions within the node which are available with their temporaries,
+    // adding those it computes unconditionally to computed
+    void reuseIn(std::shared_ptr<AstNode>& node, const AvailableList& available, AvailableList& computed, bool isConditional) {
+        if(node == nullptr) {
+            return;
+        }
+        // keeping a value takes a popext and pushext, and reading it back a pushext
+        if(isReusable(node) && estimateCycles(node) > 15) {
+            std::string key = nodeKey(node);
+            for(const auto& entry : available) {
+                if(entry->key != key) {
+                    continue;
+                }
+                if(entry->temp == nullptr) {
+                    // where it is first computed, it is now also stored
+                    entry->temp = newTemp();
+                    auto original = std::make_shared<AstNode>(*entry->first);
+                    *entry->first = *makeAssign(makeVariableNode(entry->temp, original->line), original);
+                }
+                ++stats.reused;
+                node = makeVariableNode(entry->temp, node->line);
+                return;
+            }
+            if(!isConditional) {
+                auto entry = std::make_shared<Available>();
+                entry->key = key;
+                entry->first = node;
+                collectReads(node, entry->reads);
+                computed.push_back(entry);
+            }
+        }
+        if(node->kind == node_assign || node->kind == node_increment) {
+            if(node->left->kind == node_index) {
+                reuseIn(node->left->right, available, computed, isConditional);
+            }
+            reuseIn(node->right, available, computed, isConditional);
+            return;
+        }
+        bool isShortCircuit = node->kind == node_binary && (node->op == "&&" || node->op == "||");
+        reuseIn(node->left, available, computed, isConditional);
+        reuseIn(node->right, available, computed, isConditional || isShortCircuit);
+        for(auto& arg : node->args) {
+            reuseIn(arg, available, computed, isConditional);
+        }
+    }
+
+    // reuses available expressions in an expression evaluated once, then makes those it computes available
+    // expressions with side effects beyond a store at the top are left alone, as their order matters
+    void reuseExpression(std::shared_ptr<AstNode>& expr, AvailableList& available) {
+        if(expr == nullptr) {
+            return;
+        }
+        Effects effects;
+        collectEffects(expr, effects);
+        bool isStore = expr->kind == node_assign || expr->kind == node_increment;
+        bool isSimple = !hasSideEffects(expr) || (isStore && !hasSideEffects(expr->right)
+            && (expr->left->kind != node_index || !hasSideEffects(expr->left->right)));
+        if(!isSimple) {
+            forget(available, effects);
+            return;
+        }
+        AvailableList computed;
+        reuseIn(expr, available, computed, false);
+        forget(available, effects);
+        forget(computed, effects);
+        available.insert(available.end(), computed.begin(), computed.end());
+    }
+
+    void reuse(const std::shared_ptr<Statement>& statement, AvailableList& available) {
+        switch(statement->kind) {
+            case statement_expression: {
+                reuseExpression(statement->expr, available);
+                break;
+            }
+            case statement_block: {
+                for(const auto& inner : statement->statements) {
+                    reuse(inner, available);
+                }
+                break;
+            }
+            case statement_if: {
+                reuseExpression(statement->expr, available);
+                AvailableList thenAvailable = available;
+                reuse(statement->body, thenAvailable);
+                if(statement->elseBody != nullptr) {
+                    reuse(statement->elseBody, available);
+                }
+                // only what is available after both branches is available after the if
+                available.erase(std::remove_if(available.begin(), available.end(), [&](const std::shared_ptr<Available>& entry) {
+                    return std::find(thenAvailable.begin(), thenAvailable.end(), entry) == thenAvailable.end();
+                }), available.end());
+                break;
+            }
+            case statement_while:
+            case statement_for:
+            case statement_do: {
+                if(statement->init != nullptr) {
+                    reuse(statement->init, available);
+                }
+                Effects effects;
+                collectEffects(statement->expr, effects);
+                collectEffects(statement->step, effects);
+                collectEffects(statement->body, effects);
+                forget(available, effects);
+                // the condition of a while or for is computed before each pass through the body
+                AvailableList bodyAvailable = available;
+                if(statement->kind != statement_do) {
+                    reuseExpression(statement->expr, bodyAvailable);
+                }
+                reuse(statement->body, bodyAvailable);
+                AvailableList stepAvailable = available;
+                reuseExpression(statement->step, stepAvailable);
+                if(statement->kind == statement_do) {
+                    AvailableList conditionAvailable = available;
+                    reuseExpression(statement->expr, conditionAvailable);
+                }
+                break;
+            }
+            case statement_return: {
+                reuseExpression(statement->expr, available);
+                break;
+            }
+            case statement_asm: {
+                available.clear();
+                break;
+            }
+            default: {
+                break;
+            }
+        }
+    }
+};
+
+/*
+    code generation
+*/
+
+class CompileOptions {
+    public:
+    // if true, generate code with a plain left-to-right tree walk, as a baseline:
+    // operands are reordered through temporaries, conditions are computed as 0 or 1
+    // and then tested, and loops test at the top and jump back
+    bool naive = false;
+    // if true, run the middle-end on the syntax tree before generating code
+    bool optimize = false;
+    // the runtime routines' variant: 'looped', 'unrolled', or 'auto', which unrolls the routines
+    // called from a loop or from a function other than main, and keeps the rest small
+    std::string runtime = "auto";
+};
+
+// the flag tested after computing a difference d
+enum FlagTest {
+    test_nonzero,   // d != 0
+    test_zero,      // d == 0
+    test_positive,  // d >= 0
+    test_negative   // d < 0
+};
+
+// returns the opposite test
+FlagTest invertTest(FlagTest test) {
+    switch(test) {
+        case test_nonzero: { return test_zero; }
+        case test_zero: { return test_nonzero; }
+        case test_positive: { return test_negative; }
+        default: { return test_positive; }
+    }
+}
+
+// the size of the jump to main at address 0
+const int ENTRY_SIZE = 6;
+
+class CodeGenerator {
+    public:
+    CodeGenerator(CompileUnit& _unit, const CompileOptions& _options, std::ostream& _err)
+        : unit(_unit), options(_options), err(_err) { }
+
+    // generates the assembly for main and every function it uses
+    // returns false after writing an error if not possible
+    bool generate(std::string& out) {
+        if(unit.functionMap.count("main") == 0 || !unit.functionMap["main"]->isDefined) {
+            err << "Error: there is no 'main' function" << std::endl;
+            return false;
+        }
+        auto main = unit.functionMap["main"];
+        if(!main->returnsValue || !main->params.empty()) {
+            err << "Error on line [" << main->line << "]: 'main' must be declared 'int main()'" << std::endl;
+            return false;
+        }
+
+        // functions are placed in the order of the source, from main and what it calls,
+        // and then the runtime routines they use
+        std::vector<std::shared_ptr<Function>> reached;
+        std::set<std::string> visiting, visited;
+        if(!tryVisit(main, visiting, visited)) {
+            return false;
+        }
+        for(bool isRuntime : { false, true }) {
+            for(const auto& function : unit.functions) {
+                if(visited.count(function->name) > 0 && function->isRuntime == isRuntime) {
+                    reached.push_back(function);
+                }
+            }
+        }
+        for(const auto& function : reached) {
+            if(function == main) {
+                collectLoopCalls(function->body, false, hotCalls);
+            } else if(!function->isRuntime) {
+                collectCalls(function->body, hotCalls);
+            }
+        }
+        for(const auto& function : reached) {
+            generateFunction(function);
+            if(!ok) {
+                return false;
+            }
+        }
+        resolveAliases();
+
+        std::ostringstream os;
+        os << "; compiled by cpp2assem" << (options.naive ? " --naive" : "") << std::endl;
+        os << "    jnz @f_main" << std::endl;
+        os << "    jnn @f_main" << std::endl;
+        writeData(os, reached);
+        for(const auto& line : lines) {
+            os << line << std::endl;
+        }
+        out = os.str();
+        return true;
+    }
+
+    private:
+    CompileUnit& unit;
+    const CompileOptions& options;
+    std::ostream& err;
+    bool ok = true;
+    // the generated code, a line each
+    std::vector<std::string> lines;
+    // labels waiting for the next instruction, and labels which name the same address as another
+    std::vector<std::string> pendingLabels;
+    std::map<std::string, std::string> aliases;
+    int labelCount = 0;
+    int callCount = 0;
+    // the function being generated, its stack depth and the temporaries in use
+    std::shared_ptr<Function> function;
+    int depth = 0;
+    int tempsInUse = 0;
+    std::vector<std::shared_ptr<Variable>> temps;
+    // the break and continue labels of the enclosing loops
+    std::vector<std::pair<std::string, std::string>> loops;
+    // the functions called within a loop, or from functions other than main
+    std::set<std::string> hotCalls;
+
+    void error(int line, const std::string& message) {
+        if(ok) {
+            err << "Error on line [" << line << "]: " << message << std::endl;
+        }
+        ok = false;
+    }
+
+    // walks the call graph from the function, rejecting recursion and undefined functions
+    bool tryVisit(const std::shared_ptr<Function>& function, std::set<std::string>& visiting, std::set<std::string>& visited) {
+        if(visited.count(function->name) > 0) {
+            return true;
+        }
+        visiting.insert(function->name);
+        for(const auto& name : function->calls) {
+            if(unit.functionMap.count(name) == 0 || !unit.functionMap[name]->isDefined) {
+                err << "Error on line [" << function->line << "]: '" << function->name << "' calls '" << name << "', which is not defined" << std::endl;
+                return false;
+            }
+            if(visiting.count(name) > 0) {
+                err << "Error on line [" << function->line << "]: '" << function->name << "' calls '" << name
+                    << "' recursively, which is not supported since variables are statically allocated" << std::endl;
+                return false;
+            }
+            if(!tryVisit(unit.functionMap[name], visiting, visited)) {
+                return false;
+            }
+        }
+        visiting.erase(function->name);
+        visited.insert(function->name);
+        return true;
+    }
+
+    /*
+        emitting code
+    */
+
+    std::string newLabel() {
+        return "L" + std::to_string(++labelCount);
+    }
+
+    // places a label on the next instruction
+    void label(const std::string& name) {
+        pendingLabels.push_back(name);
+    }
+
+    void emit(const std::string& instruction) {
+        if(!pendingLabels.empty()) {
+            // only one label may be placed on an address, so the rest are made aliases of it
+            for(size_t i = 1; i < pendingLabels.size(); i++) {
+                aliases[pendingLabels[i]] = pendingLabels[0];
+            }
+            lines.push_back("#" + pendingLabels[0]);
+            pendingLabels.clear();
+        }
+        lines.push_back("    " + instruction);
+    }
+
+    void comment(const std::string& text) {
+        lines.push_back("; " + text);
+    }
+
+    // replaces references to aliased labels with the label placed
+    void resolveAliases() {
+        if(aliases.empty()) {
+            return;
+        }
+        for(auto& line : lines) {
+            size_t at = line.find('@');
+            if(at == std::string::npos) {
+                continue;
+            }
+            size_t end = at + 1;
+            while(end < line.size() && (std::isalnum(line[end]) || line[end] == '_')) {
+                ++end;
+            }
+            auto alias = aliases.find(line.substr(at + 1, end - at - 1));
+            if(alias != aliases.end()) {
+                line.replace(at + 1, end - at - 1, alias->second);
+            }
+        }
+    }
+
+    void adjustDepth(int change) {
+        depth += change;
+        function->maxDepth = std::max(function->maxDepth, depth);
+    }
+
+    void pushImm(int value) {
+        emit("pushimm 0x" + byte2hex(value));
+        adjustDepth(1);
+    }
+
+    // pushes the byte at the label, with an offset
+    void pushExt(const std::shared_ptr<Variable>& variable, int offset = 0) {
+        variable->isUsed = true;
+        emit("pushext @" + variable->label + (offset > 0 ? "+" + std::to_string(offset) : ""));
+        adjustDepth(1);
+    }
+
+    void popExt(const std::shared_ptr<Variable>& variable, int offset = 0) {
+        variable->isUsed = true;
+        emit("popext @" + variable->label + (offset > 0 ? "+" + std::to_string(offset) : ""));
+        adjustDepth(-1);
+    }
+
+    void popInh() {
+        emit("popinh");
+        adjustDepth(-1);
+    }
+
+    // add, sub or nor
+    void binaryOp(const std::string& op) {
+        emit(op);
+        adjustDepth(-1);
+    }
+
+    // jumps whatever the flags are: Z and N are only set together by add and sub,
+    // and when Z is set the result was 0 so N is clear
+    void jump(const std::string& target) {
+        emit("jnz @" + target);
+        emit("jnn @" + target);
+    }
+
+    // jumps to target if the last difference passes the test, else falls through
+    void branchOnFlags(FlagTest test, const std::string& target) {
+        if(test == test_nonzero) {
+            emit("jnz @" + target);
+        } else if(test == test_positive) {
+            emit("jnn @" + target);
+        } else if(test == test_zero) {
+            // not taking jnz means Z is set, and then N is clear
+            std::string skip = newLabel();
+            emit("jnz @" + skip);
+            emit("jnn @" + target);
+            label(skip);
+        } else {
+            // not taking jnn means N is set, and then Z is clear
+            std::string skip = newLabel();
+            emit("jnn @" + skip);
+            emit("jnz @" + target);
+            label(skip);
+        }
+    }
+
+    // returns a temporary for the function, one for each level of nesting
+    std::shared_ptr<Variable> acquireTemp() {
+        int index = tempsInUse++;
+        while((int)temps.size() <= index) {
+            auto temp = std::make_shared<Variable>();
+            temp->name = "";
+            temp->label = "t_" + function->name + "_" + std::to_string(temps.size());
+            temps.push_back(temp);
+            function->variables.push_back(temp);
+        }
+        return temps[index];
+    }
+
+    void releaseTemp() {
+        --tempsInUse;
+    }
+
+    /*
+        expressions
+    */
+
+    // returns true if the node is pushed by a single instruction
+    bool isLeaf(const std::shared_ptr<AstNode>& node) {
+        int value;
+        return node->kind == node_number || node->kind == node_variable
+            || (node->kind == node_index && isConstantNode(node->right, value));
+    }
+
+    // the stack depth needed to evaluate the node (its Sethi-Ullman number)
+    int need(const std::shared_ptr<AstNode>& node) {
+        switch(node->kind) {
+            case node_number:
+            case node_variable: {
+                return 1;
+            }
+            case node_index: {
+                return isLeaf(node) ? 1 : std::max(need(node->right), 2);
+            }
+            case node_call: {
+                int result = 1;
+                for(size_t i = 0; i < node->args.size(); i++) {
+                    result = std::max(result, need(node->args[i]) + (int)i);
+                }
+                return result;
+            }
+            case node_unary: {
+                return std::max(need(node->left), 2);
+            }
+            case node_binary: {
+                int l = need(node->left), r = need(node->right);
+                if(isCommutative(node->op)) {
+                    return l == r ? l + 1 : std::max(l, r);
+                }
+                return std::max(l, r + 1);
+            }
+            case node_assign: {
+                return need(node->right) + 1;
+            }
+            default: {
+                return 2;
+            }
+        }
+    }
+
+    static bool isCommutative(const std::string& op) {
+        return op == "+" || op == "&" || op == "|" || op == "^" || op == "==" || op == "!=" || op == "*";
+    }
+
+    static bool isCondition(const std::shared_ptr<AstNode>& node) {
+        if(node->kind == node_unary) {
+            return node->op == "!";
+        }
+        if(node->kind != node_binary) {
+            return false;
+        }
+        const std::string& op = node->op;
+        return op == "&&" || op == "||" || op == "==" || op == "!=" || op == "<" || op == "<=" || op == ">" || op == ">=";
+    }
+
+    // pushes a leaf node
+    void pushLeaf(const std::shared_ptr<AstNode>& node) {
+        int value;
+        if(isConstantNode(node, value)) {
+            pushImm(value);
+        } else if(node->kind == node_variable) {
+            pushExt(node->variable);
+        } else {
+            isConstantNode(node->right, value);
+            pushExt(node->variable, value);
+        }
+    }
+
+    // pushes two operands so that top ends up on top of bottom
+    // the operand needing the deeper stack goes first if the operation is commutative
+    void genOperands(const std::shared_ptr<AstNode>& bottom, const std::shared_ptr<AstNode>& top, bool commutative) {
+        if(commutative && need(top) > need(bottom)) {
+            genExpr(top);
+            genExpr(bottom);
+        } else {
+            genExpr(bottom);
+            genExpr(top);
+        }
+    }
+
+    // pushes the left and right operands of a binary node, so that the one named
+    // by leftOnTop is on top, as add, sub and nor take their first operand from the top
+    void genBinaryOperands(const std::shared_ptr<AstNode>& node, bool leftOnTop) {
+        if(!options.naive) {
+            if(leftOnTop) {
+                genOperands(node->right, node->left, isCommutative(node->op));
+            } else {
+                genOperands(node->left, node->right, isCommutative(node->op));
+            }
+            return;
+        }
+        genExpr(node->left);
+        genExpr(node->right);
+        if(leftOnTop) {
+            auto right = acquireTemp();
+            auto left = acquireTemp();
+            popExt(right);
+            popExt(left);
+            pushExt(right);
+            pushExt(left);
+            releaseTemp();
+            releaseTemp();
+        }
+    }
+
+    // pushes the value of the node twice
+    // a leaf is simply pushed twice, anything else is kept in a temporary
+    void genTwice(const std::shared_ptr<AstNode>& node) {
+        if(isLeaf(node) && !options.naive) {
+            pushLeaf(node);
+            pushLeaf(node);
+        } else {
+            genExpr(node);
+            auto temp = acquireTemp();
+            popExt(temp);
+            pushExt(temp);
+            pushExt(temp);
+            releaseTemp();
+        }
+    }
+
+    // pushes ~node, as nor(x, x)
+    void genComplement(const std::shared_ptr<AstNode>& node) {
+        int value;
+        if(isConstantNode(node, value) && !options.naive) {
+            pushImm(~value);
+            return;
+        }
+        genTwice(node);
+        binaryOp("nor");
+    }
+
+    // stores the top of the stack into a temporary for the node if it is not a leaf,
+    // returning a leaf node for it
+    std::shared_ptr<AstNode> makeLeaf(const std::shared_ptr<AstNode>& node) {
+        if(isLeaf(node) && !options.naive) {
+            return node;
+        }
+        genExpr(node);
+        auto temp = acquireTemp();
+        popExt(temp);
+        auto leaf = std::make_shared<AstNode>();
+        leaf->kind = node_variable;
+        leaf->line = node->line;
+        leaf->variable = temp;
+        return leaf;
+    }
+
+    // pushes a bitwise and, or or xor from nor:
+    // a & b = nor(~a, ~b), a | b = ~nor(a, b), a ^ b = nor(nor(a, b), a & b)
+    void genBitwise(const std::shared_ptr<AstNode>& node) {
+        if(node->op == "&") {
+            genComplement(node->left);
+            genComplement(node->right);
+            binaryOp("nor");
+        } else if(node->op == "|") {
+            genBinaryOperands(node, false);
+            binaryOp("nor");
+            auto temp = acquireTemp();
+            popExt(temp);
+            pushExt(temp);
+            pushExt(temp);
+            binaryOp("nor");
+            releaseTemp();
+        } else {
+            int temps = tempsInUse;
+            auto a = makeLeaf(node->left);
+            auto b = makeLeaf(node->right);
+            pushLeaf(a);
+            pushLeaf(b);
+            binaryOp("nor");
+            genComplement(a);
+            genComplement(b);
+            binaryOp("nor");
+            binaryOp("nor");
+            tempsInUse = temps;
+        }
+    }
+
+    // pushes node << count
+    void genShiftLeft(const std::shared_ptr<AstNode>& node, int count) {
+        if(count >= 8) {
+            genEffect(node);
+            pushImm(0);
+            return;
+        }
+        if(count <= 0) {
+            genExpr(node);
+            return;
+        }
+        genTwice(node);
+        binaryOp("add");
+        auto temp = acquireTemp();
+        for(int i = 1; i < count; i++) {
+            popExt(temp);
+            pushExt(temp);
+            pushExt(temp);
+            binaryOp("add");
+        }
+        releaseTemp();
+    }
+
+    // calls a helper function for an operator
+    void genHelperCall(const std::string& name, const std::shared_ptr<AstNode>& node) {
+        auto call = std::make_shared<AstNode>();
+        call->kind = node_call;
+        call->op = name;
+        call->line = node->line;
+        call->args.push_back(node->left);
+        call->args.push_back(node->right);
+        genCall(call, true);
+    }
+
+    // pushes the value of the node
+    // returns true if Z and N were set from the value, by add or sub
+    bool genExpr(const std::shared_ptr<AstNode>& node) {
+        int value;
+        switch(node->kind) {
+            case node_number:
+            case node_variable: {
+                pushLeaf(node);
+                return false;
+            }
+            case node_index: {
+                if(isLeaf(node)) {
+                    pushLeaf(node);
+                } else {
+                    genIndexedAccess(node, "pushext");
+                }
+                return false;
+            }
+            case node_call: {
+                genCall(node, true);
+                return false;
+            }
+            case node_unary: {
+                if(node->op == "-") {
+                    // 0 - x
+                    genExpr(node->left);
+                    pushImm(0);
+                    binaryOp("sub");
+                    return true;
+                } else if(node->op == "~") {
+                    genComplement(node->left);
+                    return false;
+                } else if(node->op == "+") {
+                    return genExpr(node->left);
+                }
+                genConditionValue(node);
+                return false;
+            }
+            case node_binary: {
+                const std::string& op = node->op;
+                if(op == "+") {
+                    genBinaryOperands(node, false);
+                    binaryOp("add");
+                    return true;
+                } else if(op == "-") {
+                    if(!options.naive && isConstantNode(node->right, value)) {
+                        // x - k as x + -k, so that x goes first
+                        genExpr(node->left);
+                        pushImm(-value);
+                        binaryOp("add");
+                    } else {
+                        // sub takes the top minus the one below it
+                        genBinaryOperands(node, true);
+                        binaryOp("sub");
+                    }
+                    return true;
+                } else if(op == "&" || op == "|" || op == "^") {
+                    genBitwise(node);
+                    return false;
+                } else if(op == "<<" || op == ">>" || op == "*" || op == "/" || op == "%") {
+                    std::string helper = helperFor(op, node->left, node->right);
+                    if(!helper.empty()) {
+                        genHelperCall(helper, node);
+                    } else if(op == "<<") {
+                        isConstantNode(node->right, value);
+                        genShiftLeft(node->left, value & 0xFF);
+                    } else if(isConstantNode(node->right, value)) {
+                        genShiftLeft(node->left, powerOf2(value & 0xFF));
+                    } else {
+                        isConstantNode(node->left, value);
+                        genShiftLeft(node->right, powerOf2(value & 0xFF));
+                    }
+                    return false;
+                }
+                genConditionValue(node);
+                return false;
+            }
+            case node_assign: {
+                genAssign(node, true);
+                return false;
+            }
+            case node_increment: {
+                genIncrement(node, true);
+                return false;
+            }
+        }
+        return false;
+    }
+
+    // evaluates the node for its side effects only
+    void genEffect(const std::shared_ptr<AstNode>& node) {
+        if(node->kind == node_assign) {
+            genAssign(node, false);
+        } else if(node->kind == node_increment) {
+            genIncrement(node, false);
+        } else if(node->kind == node_call) {
+            genCall(node, false);
+        } else if(hasSideEffects(node)) {
+            genExpr(node);
+            popInh();
+        }
+    }
+
+    // pushes the value of an array element, or pops into it, for an index known only at run time
+    // the low byte of the address is computed and written into the operand of the instruction
+    // which accesses it, which works since arrays are placed so as not to cross a 256-byte page
+    void genIndexedAccess(const std::shared_ptr<AstNode>& node, const std::string& instruction) {
+        auto& array = node->variable;
+        array->isUsed = true;
+        int index;
+        if(isConstantNode(node->right, index)) {
+            if(instruction == "pushext") {
+                pushExt(array, index);
+            } else {
+                popExt(array, index);
+            }
+            return;
+        }
+        std::string access = newLabel();
+        genExpr(node->right);
+        emit("pushimm @" + array->label + ".L");
+        adjustDepth(1);
+        binaryOp("add");
+        emit("popext @" + access + "+2");
+        adjustDepth(-1);
+        label(access);
+        emit(instruction + " @" + array->label);
+        adjustDepth(instruction == "pushext" ? 1 : -1);
+    }
+
+    // pops the top of the stack into the variable or array element
+    void genStore(const std::shared_ptr<AstNode>& target) {
+        if(target->kind == node_variable) {
+            popExt(target->variable);
+        } else {
+            genIndexedAccess(target, "popext");
+        }
+    }
+
+    // returns the target with any index which has side effects evaluated into a temporary,
+    // so that it may be read and written
+    std::shared_ptr<AstNode> stableTarget(const std::shared_ptr<AstNode>& target) {
+        if(target->kind != node_index || !hasSideEffects(target->right)) {
+            return target;
+        }
+        genExpr(target->right);
+        auto temp = acquireTemp();
+        popExt(temp);
+        auto index = std::make_shared<AstNode>();
+        index->kind = node_variable;
+        index->line = target->line;
+        index->variable = temp;
+        auto stable = std::make_shared<AstNode>(*target);
+        stable->right = index;
+        return stable;
+    }
+
+    // generates an assignment, leaving its value on the stack if needValue
+    void genAssign(const std::shared_ptr<AstNode>& node, bool needValue) {
+        int temps = tempsInUse;
+        auto target = stableTarget(node->left);
+        std::shared_ptr<AstNode> value = node->right;
+        if(node->op != "=") {
+            value = std::make_shared<AstNode>();
+            value->kind = node_binary;
+            value->line = node->line;
+            value->op = node->op.substr(0, node->op.size() - 1);
+            value->left = target;
+            value->right = node->right;
+        }
+        genExpr(value);
+        genStore(target);
+        if(needValue) {
+            genExpr(target);
+        }
+        tempsInUse = temps;
+    }
+
+    // generates ++ or --, leaving the value on the stack if needValue
+    void genIncrement(const std::shared_ptr<AstNode>& node, bool needValue) {
+        int temps = tempsInUse;
+        auto target = stableTarget(node->left);
+        if(needValue && !node->isPrefix) {
+            genExpr(target);
+        }
+        auto one = std::make_shared<AstNode>();
+        one->kind = node_number;
+        one->value = 1;
+        auto assign = std::make_shared<AstNode>();
+        assign->kind = node_assign;
+        assign->line = node->line;
+        assign->op = node->op == "++" ? "+=" : "-=";
+        assign->left = target;
+        assign->right = one;
+        genAssign(assign, needValue && node->isPrefix);
+        tempsInUse = temps;
+    }
+
+    // calls a function: the arguments are pushed, then popped into the parameters, the return
+    // address is written into the operand of the jnz at the end of the function, and the function
+    // is jumped to, leaving its result on the stack
+    void genCall(const std::shared_ptr<AstNode>& node, bool needValue) {
+        if(unit.functionMap.count(node->op) == 0) {
+            error(node->line, "'" + node->op + "' is not declared");
+            return;
+        }
+        auto callee = unit.functionMap[node->op];
+        if(callee->name == "main") {
+            error(node->line, "'main' may not be called");
+            return;
+        }
+        if(callee->params.size() != node->args.size()) {
+            error(node->line, "'" + callee->name + "' takes " + std::to_string(callee->params.size()) + " arguments");
+            return;
+        }
+        if(needValue && !callee->returnsValue) {
+            error(node->line, "'" + callee->name + "' is void and has no value");
+            return;
+        }
+
+        for(const auto& arg : node->args) {
+            genExpr(arg);
+        }
+        for(int i = (int)callee->params.size() - 1; i >= 0; i--) {
+            popExt(callee->params[i]);
+        }
+        std::string returnLabel = "c" + std::to_string(++callCount);
+        emit("pushimm @" + returnLabel + ".H");
+        emit("popext @r_" + callee->name + "+1");
+        emit("pushimm @" + returnLabel + ".L");
+        emit("popext @r_" + callee->name + "+2");
+        function->maxDepth = std::max(function->maxDepth, depth + 1);
+        jump("f_" + callee->name);
+        label(returnLabel);
+        if(callee->returnsValue) {
+            adjustDepth(1);
+            if(!needValue) {
+                popInh();
+            }
+        }
+    }
+
+    /*
+        conditions
+    */
+
+    // pushes x - y with the flags set from it
+    void genDifference(const std::shared_ptr<AstNode>& x, const std::shared_ptr<AstNode>& y) {
+        int value;
+        if(!options.naive && isConstantNode(y, value)) {
+            bool flagsSet = genExpr(x);
+            if(value != 0 || !flagsSet) {
+                pushImm(-value);
+                binaryOp("add");
+            }
+        } else if(!options.naive && isConstantNode(x, value) && value == 0) {
+            genExpr(y);
+            pushImm(0);
+            binaryOp("sub");
+        } else {
+            auto node = std::make_shared<AstNode>();
+            node->kind = node_binary;
+            node->op = "-";
+            node->left = x;
+            node->right = y;
+            genBinaryOperands(node, true);
+            binaryOp("sub");
+        }
+    }
+
+    // jumps to target if the truth of the node is jumpIf, else falls through
+    void genBranch(const std::shared_ptr<AstNode>& node, const std::string& target, bool jumpIf) {
+        int value;
+        if(isConstantNode(node, value)) {
+            if((value != 0) == jumpIf) {
+                jump(target);
+            }
+            return;
+        }
+        if(options.naive) {
+            // compute the condition as a value, then test it
+            genExpr(node);
+            pushImm(0);
+            binaryOp("add");
+            popInh();
+            branchOnFlags(jumpIf ? test_nonzero : test_zero, target);
+            return;
+        }
+
+        const std::string& op = node->op;
+        if(node->kind == node_unary && op == "!") {
+            genBranch(node->left, target, !jumpIf);
+        } else if(node->kind == node_binary && (op == "&&" || op == "||")) {
+            // jumping when an && is true or an || is false takes both sides
+            if(jumpIf == (op == "&&")) {
+                std::string skip = newLabel();
+                genBranch(node->left, skip, !jumpIf);
+                genBranch(node->right, target, jumpIf);
+                label(skip);
+            } else {
+                genBranch(node->left, target, jumpIf);
+                genBranch(node->right, target, jumpIf);
+            }
+        } else if(isCondition(node)) {
+            if(!tryGenRelationBranch(node, target, jumpIf)) {
+                FlagTest test = genComparison(node);
+                popInh();
+                branchOnFlags(jumpIf ? test : invertTest(test), target);
+            }
+        } else {
+            if(!genExpr(node)) {
+                pushImm(0);
+                binaryOp("add");
+            }
+            popInh();
+            branchOnFlags(jumpIf ? test_nonzero : test_zero, target);
+        }
+    }
+
+    // pushes leaf + 0 with the flags set from it
+    void genSign(const std::shared_ptr<AstNode>& leaf) {
+        pushLeaf(leaf);
+        pushImm(0);
+        binaryOp("add");
+    }
+
+    // pushes a value for a comparison with the flags set from it, returning the test of them
+    // which makes the comparison true: x - y for == and !=
+    // the relations are taken as a < b or a >= b, x > y being y < x and x <= y being y >= x;
+    // a - b may overflow 8 bits when a and b have different signs, so then the sign of a alone
+    // decides, pushed as a + 0, and the difference only when their signs are the same
+    FlagTest genComparison(const std::shared_ptr<AstNode>& node) {
+        const std::string& op = node->op;
+        if(op == "==" || op == "!=") {
+            genDifference(node->left, node->right);
+            return op == "==" ? test_zero : test_nonzero;
+        }
+        bool isSwapped = op == ">" || op == "<=";
+        FlagTest test = op == "<" || op == ">" ? test_negative : test_positive;
+        std::shared_ptr<AstNode> a = isSwapped ? node->right : node->left;
+        std::shared_ptr<AstNode> b = isSwapped ? node->left : node->right;
+        int value;
+        if(!options.naive && isConstantNode(a, value) && (signed char)value < 127) {
+            // c < b is b >= c + 1 and c >= b is b < c + 1, moving the constant to the right
+            auto next = std::make_shared<AstNode>();
+            next->kind = node_number;
+            next->line = a->line;
+            next->value = (signed char)value + 1;
+            a = b;
+            b = next;
+            test = invertTest(test);
+        }
+
+        if(!options.naive && isConstantNode(b, value)) {
+            value = (signed char)value;
+            bool flagsSet = genExpr(a);
+            if(value == 0) {
+                if(!flagsSet) {
+                    pushImm(0);
+                    binaryOp("add");
+                }
+                return test;
+            }
+            // a - c overflows only when a and c have different signs, and then has the sign
+            // opposite to a's, which alone decides: a is restored by adding c back where it may have
+            pushImm(-value);
+            binaryOp("add");
+            std::string end = newLabel();
+            if(value > 0) {
+                // a - c < 0 is exact
+                std::string isPositive = newLabel();
+                emit("jnn @" + isPositive);
+                // not taking jnn means N is set, and then Z is clear
+                emit("jnz @" + end);
+                label(isPositive);
+            } else {
+                // a - c >= 0 is exact
+                emit("jnn @" + end);
+            }
+            pushImm(value);
+            binaryOp("add");
+            label(end);
+            return test;
+        }
+
+        int temps = tempsInUse;
+        auto leafA = makeLeaf(a);
+        auto leafB = makeLeaf(b);
+        std::string isAPositive = newLabel(), differ = newLabel(), same = newLabel(), end = newLabel();
+        genSign(leafA);
+        popInh();
+        emit("jnn @" + isAPositive);
+        genSign(leafB);
+        popInh();
+        emit("jnn @" + differ);
+        // not taking jnn means N is set, and then Z is clear
+        emit("jnz @" + same);
+        label(isAPositive);
+        genSign(leafB);
+        popInh();
+        emit("jnn @" + same);
+        label(differ);
+        genSign(leafA);
+        jump(end);
+        adjustDepth(-1);
+        label(same);
+        pushLeaf(leafB);
+        pushLeaf(leafA);
+        binaryOp("sub");
+        label(end);
+        tempsInUse = temps;
+        return test;
+    }
+
+    // jumps to target if a relation between two values which aren't constants is jumpIf, else
+    // falls through; returns false for any other condition
+    // the sign of a - b is branched on first: when a and b have the same sign it is exact, so one
+    // sign says whether it overflowed where values are mostly positive, and both only otherwise
+    bool tryGenRelationBranch(const std::shared_ptr<AstNode>& node, const std::string& target, bool jumpIf) {
+        const std::string& op = node->op;
+        int value;
+        if((op != "<" && op != "<=" && op != ">" && op != ">=")
+            || isConstantNode(node->left, value) || isConstantNode(node->right, value)) {
+            return false;
+        }
+        bool isSwapped = op == ">" || op == "<=";
+        bool isLessJumped = (op == "<" || op == ">") == jumpIf;
+        int temps = tempsInUse;
+        auto a = makeLeaf(isSwapped ? node->right : node->left);
+        auto b = makeLeaf(isSwapped ? node->left : node->right);
+        std::string end = newLabel(), isDifferencePositive = newLabel();
+        const std::string& isLess = isLessJumped ? target : end;
+        const std::string& isNotLess = isLessJumped ? end : target;
+        pushLeaf(b);
+        pushLeaf(a);
+        binaryOp("sub");
+        popInh();
+        emit("jnn @" + isDifferencePositive);
+        // a - b < 0: a is less, unless a is positive and b negative
+        genSign(b);
+        popInh();
+        emit("jnn @" + isLess);
+        genSign(a);
+        popInh();
+        emit("jnn @" + isNotLess);
+        // not taking jnn means N is set, and then Z is clear
+        emit("jnz @" + isLess);
+        label(isDifferencePositive);
+        // a - b >= 0: a isn't less, unless a is negative and b positive
+        genSign(a);
+        popInh();
+        emit("jnn @" + isNotLess);
+        genSign(b);
+        popInh();
+        emit("jnn @" + isLess);
+        emit("jnz @" + isNotLess);
+        label(end);
+        tempsInUse = temps;
+        return true;
+    }
+
+    // pushes 1 if the condition is true, else 0
+    void genConditionValue(const std::shared_ptr<AstNode>& node) {
+        std::string isTrue = newLabel();
+        std::string end = newLabel();
+        if(options.naive && node->kind == node_binary && node->op != "&&" && node->op != "||") {
+            FlagTest test = genComparison(node);
+            popInh();
+            branchOnFlags(test, isTrue);
+        } else if(options.naive && node->kind == node_unary) {
+            genExpr(node->left);
+            pushImm(0);
+            binaryOp("add");
+            popInh();
+            branchOnFlags(test_zero, isTrue);
+        } else if(options.naive) {
+            // && and || test each side as a value
+            std::string isFalse = newLabel();
+            if(node->op == "&&") {
+                genBranch(node->left, isFalse, false);
+                genBranch(node->right, isFalse, false);
+                jump(isTrue);
+            } else {
+                genBranch(node->left, isTrue, true);
+                genBranch(node->right, isTrue, true);
+            }
+            label(isFalse);
+        } else {
+            genBranch(node, isTrue, true);
+        }
+        pushImm(0);
+        jump(end);
+        adjustDepth(-1);
+        label(isTrue);
+        pushImm(1);
+        label(end);
+    }
+
+    /*
+        statements
+    */
+
+    void genStatement(const std::shared_ptr<Statement>& statement, bool isLast = false) {
+        switch(statement->kind) {
+            case statement_expression: {
+                genEffect(statement->expr);
+                break;
+            }
+            case statement_block: {
+                for(size_t i = 0; i < statement->statements.size(); i++) {
+                    genStatement(statement->statements[i], isLast && i == statement->statements.size() - 1);
+                }
+                break;
+            }
+            case statement_if: {
+                std::string elseLabel = newLabel();
+                genBranch(statement->expr, elseLabel, false);
+                genStatement(statement->body);
+                if(statement->elseBody != nullptr) {
+                    std::string end = newLabel();
+                    jump(end);
+                    label(elseLabel);
+                    genStatement(statement->elseBody);
+                    label(end);
+                } else {
+                    label(elseLabel);
+                }
+                break;
+            }
+            case statement_while:
+            case statement_for: {
+                if(statement->init != nullptr) {
+                    genStatement(statement->init);
+                }
+                genLoop(statement);
+                break;
+            }
+            case statement_do: {
+                std::string body = newLabel(), next = newLabel(), end = newLabel();
+                loops.push_back(std::make_pair(end, next));
+                label(body);
+                genStatement(statement->body);
+                label(next);
+                genBranch(statement->expr, body, true);
+                label(end);
+                loops.pop_back();
+                break;
+            }
+            case statement_return: {
+                if(statement->expr != nullptr) {
+                    genExpr(statement->expr);
+                }
+                if(!isLast) {
+                    jump("x_" + function->name);
+                }
+                break;
+            }
+            case statement_break:
+            case statement_continue: {
+                if(loops.empty()) {
+                    error(statement->line, "'break' and 'continue' must be within a loop");
+                    return;
+                }
+                jump(statement->kind == statement_break ? loops.back().first : loops.back().second);
+                break;
+            }
+            case statement_asm: {
+                std::istringstream text(statement->text);
+                std::string line;
+                while(std::getline(text, line)) {
+                    line.erase(0, line.find_first_not_of(" \t"));
+                    if(!line.empty()) {
+                        emit(line);
+                    }
+                }
+                break;
+            }
+            case statement_empty: {
+                break;
+            }
+        }
+        // each statement leaves the stack as it found it
+        depth = 0;
+    }
+
+    // generates a while or for loop
+    // the condition is placed after the body, so that each iteration takes one branch
+    void genLoop(const std::shared_ptr<Statement>& statement) {
+        std::string top = newLabel(), next = newLabel(), end = newLabel();
+        loops.push_back(std::make_pair(end, next));
+        if(options.naive) {
+            label(top);
+            if(statement->expr != nullptr) {
+                genBranch(statement->expr, end, false);
+            }
+            genStatement(statement->body);
+            label(next);
+            if(statement->step != nullptr) {
+                genEffect(statement->step);
+            }
+            jump(top);
+        } else {
+            std::string test = newLabel();
+            int value;
+            bool isForever = statement->expr == nullptr || (isConstantNode(statement->expr, value) && value != 0);
+            if(!isForever) {
+                jump(test);
+            }
+            label(top);
+            genStatement(statement->body);
+            label(next);
+            if(statement->step != nullptr) {
+                genEffect(statement->step);
+            }
+            label(test);
+            if(isForever) {
+                jump(top);
+            } else {
+                genBranch(statement->expr, top, true);
+            }
+        }
+        label(end);
+        loops.pop_back();
+    }
+
+    // returns true if the statement always ends with a return
+    static bool endsWithReturn(const std::shared_ptr<Statement>& statement) {
+        if(statement->kind == statement_return) {
+            return true;
+        }
+        return statement->kind == statement_block && !statement->statements.empty() && endsWithReturn(statement->statements.back());
+    }
+
+    // generates a function: its body, then the exit, where the result is on the stack
+    void generateFunction(const std::shared_ptr<Function>& _function) {
+        function = _function;
+        function->maxDepth = 0;
+        if(function->isRuntime) {
+            generateRuntime();
+            return;
+        }
+        depth = 0;
+        tempsInUse = 0;
+        temps.clear();
+        for(const auto& param : function->params) {
+            param->isUsed = true;
+        }
+
+        std::string signature = std::string(function->returnsValue ? "int " : "void ") + function->name + "(";
+        for(size_t i = 0; i < function->params.size(); i++) {
+            signature.append((i > 0 ? ", int " : "int ") + function->params[i]->name);
+        }
+        comment(signature + ")");
+        label("f_" + function->name);
+        genStatement(function->body, true);
+        if(!ok) {
+            return;
+        }
+        if(function->returnsValue && !endsWithReturn(function->body)) {
+            pushImm(0);
+        }
+
+        label("x_" + function->name);
+        if(function->name == "main") {
+            emit("popext 0x" + twoBytes2hex(map_portA));
+            emit("halt");
+        } else {
+            // the flags are made nonzero so that the jnz back to the caller is taken
+            emit("pushimm 0x01");
+            emit("pushimm 0x01");
+            emit("add");
+            emit("popinh");
+            label("r_" + function->name);
+            emit("jnz 0x0000");
+        }
+        depth = 0;
+    }
+
+    // places a runtime routine's generated assembly, labelled as the helper function
+    void generateRuntime() {
+        const Routine* routine = findRoutine(HELPER_ROUTINES.at(function->name));
+        bool isUnrolled = options.runtime == "unrolled" || (options.runtime == "auto" && hotCalls.count(function->name) > 0);
+        std::istringstream text(generateRoutine(*routine, isUnrolled, function->name, function->maxDepth));
+        std::string line;
+        while(std::getline(text, line)) {
+            lines.push_back(line);
+        }
+    }
+
+    /*
+        data
+    */
+
+    // places every variable used after the jump to main, where their addresses are known,
+    // so that arrays may be kept from crossing a 256-byte page
+    void writeData(std::ostream& os, const std::vector<std::shared_ptr<Function>>& reached) {
+        std::vector<std::shared_ptr<Variable>> variables;
+        for(const auto& variable : unit.globals) {
+            if(variable->isUsed && !variable->isConstant) {
+                variables.push_back(variable);
+            }
+        }
+        // a runtime routine places its own variables
+        for(const auto& function : reached) {
+            if(function->isRuntime) {
+                continue;
+            }
+            for(const auto& variable : function->variables) {
+                if(variable->isUsed && !variable->isConstant) {
+                    variables.push_back(variable);
+                }
+            }
+        }
+        if(variables.empty()) {
+            return;
+        }
+
+        os << "; data" << std::endl;
+        int address = ENTRY_SIZE;
+        for(const auto& variable : variables) {
+            int size = variable->size();
+            if(variable->length > 0 && (address & 0xFF) + size > 0x100) {
+                int padding = 0x100 - (address & 0xFF);
+                os << ".fill " << padding << std::endl;
+                address += padding;
+            }
+            os << "#" << variable->label;
+            for(int i = 0; i < size; i++) {
+                os << ((i > 0 && i % 16 == 0) ? "\n" : " ") << "0x" << byte2hex(variable->init[i]);
+            }
+            os << std::endl;
+            address += size;
+        }
+    }
+};
+
+/*
+    the compiler's interface
+*/
+
+class CompileResult {
+    public:
+    // true if the program compiled without errors
+    bool ok = false;
+    // the ssbc assembly
+    std::string assembly;
+    // errors, one per line
+    std::vector<std::string> diagnostics;
+    // the syntax tree, with the stack depth of each function filled
+    CompileUnit unit;
+    // what the middle-end changed, with --optimize
+    MiddleEndStats stats;
+};
+
+// compiles the source into result, writing errors to err
+// returns false if the source could not be compiled
+bool compileInto(std::string_view source, const CompileOptions& options, CompileResult& result, std::ostream& err) {
+    std::vector<Token> tokens;
+    std::ostringstream helperErr;
+    if(!tryTokenize(HELPER_SOURCE, tokens, helperErr)) {
+        err << "Error in helper functions: " << helperErr.str();
+        return false;
+    }
+    tokens.pop_back();
+    // the program's line numbers start after the helpers, so they are counted again from 1
+    std::vector<Token> programTokens;
+    if(!tryTokenize(source, programTokens, err)) {
+        return false;
+    }
+    tokens.insert(tokens.end(), programTokens.begin(), programTokens.end());
+
+    Parser parser(tokens, result.unit, err);
+    if(!parser.parse()) {
+        return false;
+    }
+    for(const auto& helper : HELPER_ROUTINES) {
+        auto function = result.unit.functionMap[helper.first];
+        function->isDefined = true;
+        function->isRuntime = true;
+    }
+    if(options.optimize) {
+        MiddleEnd(result.unit, result.stats).run();
+    }
+    CodeGenerator generator(result.unit, options, err);
+    return generator.generate(result.assembly);
+}
+
+// compiles the source, returning the assembly along with any errors
+CompileResult compile(std::string_view source, const CompileOptions& options = CompileOptions()) {
+    CompileResult result;
+    std::ostringstream err;
+    result.ok = compileInto(source, options, result, err);
+    std::istringstream diagnostics(err.str());
+    std::string line;
+    while(std::getline(diagnostics, line)) {
+        result.diagnostics.push_back(line);
+    }
+    return result;
+}
+
+#endif // COMPILER_H
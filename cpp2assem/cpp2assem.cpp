@@ -0,0 +1,59 @@
+/*
+    accepts a C++ source file and transforms it into ssbc assembly
+*/
+
+#include <string>
+#include <sstream>
+#include <iostream>
+#include <fstream>
+#include "compiler.h"
+
+int main(int argc, char** argv) {
+    std::string inFileName;
+    std::string outFileName;
+    if(!tryParseIOFileNames(argc, argv, inFileName, outFileName)) {
+        std::cerr << "Usage: " << argv[0] << " -i infile -o outfile [--naive] [--optimize] [--runtime auto|looped|unrolled]" << std::endl;
+        return 1;
+    }
+
+    CompileOptions options;
+    options.naive = tryParseArg(argc, argv, "--naive");
+    options.optimize = tryParseArg(argc, argv, "--optimize");
+    tryParseArg(argc, argv, "--runtime", options.runtime);
+    if(options.runtime != "auto" && options.runtime != "looped" && options.runtime != "unrolled") {
+        std::cerr << "Error: unrecognized runtime variant: '" << options.runtime << "'" << std::endl;
+        return 1;
+    }
+
+    std::ifstream inFile;
+    inFile.open(inFileName);
+    if(!inFile.is_open()) {
+        std::cerr << "Error: could not open " << inFileName << std::endl;
+        return 1;
+    }
+
+    std::stringstream source;
+    source << inFile.rdbuf();
+    CompileResult result = compile(source.str(), options);
+    for(const auto& diagnostic : result.diagnostics) {
+        std::cerr << diagnostic << std::endl;
+    }
+    if(!result.ok) {
+        return 1;
+    }
+    if(options.optimize) {
+        const MiddleEndStats& stats = result.stats;
+        std::cerr << "middle-end: inlined " << stats.inlined << " calls, propagated " << stats.propagated
+            << " values, folded " << stats.folded << " operators, removed " << stats.removed << " statements, hoisted "
+            << stats.hoisted << " and reused " << stats.reused << " expressions" << std::endl;
+    }
+
+    std::ofstream outFile;
+    outFile.open(outFileName);
+    if(!outFile.is_open()) {
+        std::cerr << "Error: could not open " << outFileName << std::endl;
+        return 1;
+    }
+    outFile << result.assembly;
+    return 0;
+}
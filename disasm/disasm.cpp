@@ -0,0 +1,117 @@
+/*
+    accepts machine code (.mac), intel hex (.hex, .ihex) or a raw binary or memory image,
+    and writes ssbc assembly which re-assembles to the same bytes
+    usage: disasm.exe -i infile -o outfile.s [--entry addr]
+           disasm.exe -d outdir [--entry addr] snapshot...
+    the second form disassembles every snapshot into outdir/<name>.s, reusing all buffers
+*/
+
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include "../common.h"
+#include "../codec/codec.h"
+#include "disassembler.h"
+
+// returns true if the string ends with the suffix
+bool endsWith(const std::string& input, const std::string& suffix) {
+    return input.size() >= suffix.size() && input.compare(input.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+// loads the bytes of a program file, replacing the contents of out_image
+// returns false after writing an error if not possible
+bool tryLoadImage(const std::string& fileName, std::vector<unsigned char>& out_image) {
+    out_image.clear();
+    if(endsWith(fileName, ".hex") || endsWith(fileName, ".ihex")) {
+        std::ifstream file;
+        file.open(fileName);
+        if(!file.is_open()) {
+            std::cerr << "Error: could not open " << fileName << std::endl;
+            return false;
+        }
+        if(!tryReadIntelHex(file, out_image)) {
+            std::cerr << "Error: malformed intel hex in " << fileName << std::endl;
+            return false;
+        }
+    } else {
+        FILE* file = openFile(fileName, "rb");
+        if(file == nullptr) {
+            return false;
+        }
+        BlockReader reader(file);
+        if(endsWith(fileName, ".mac")) {
+            decodeMac(reader, [&](const std::vector<unsigned char>& block) {
+                out_image.insert(out_image.end(), block.begin(), block.end());
+            });
+        } else {
+            const unsigned char* data;
+            size_t length;
+            while(reader.nextBlock(data, length)) {
+                out_image.insert(out_image.end(), data, data + length);
+            }
+        }
+        std::fclose(file);
+    }
+
+    if(out_image.size() > IMAGE_SIZE) {
+        std::cerr << "Error: " << fileName << " is " << out_image.size() << " bytes, which does not fit in memory" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+// disassembles one file into another
+// returns false after writing an error if not possible
+bool tryDisassembleFile(Disassembler& disassembler, const std::string& inFileName, const std::string& outFileName,
+        int entry, std::vector<unsigned char>& image, std::string& text) {
+    if(!tryLoadImage(inFileName, image)) {
+        return false;
+    }
+    text.clear();
+    disassembler.disassemble(image.data(), image.size(), text, entry);
+
+    FILE* outFile = openFile(outFileName, "wb");
+    if(outFile == nullptr) {
+        return false;
+    }
+    std::fwrite(text.data(), 1, text.size(), outFile);
+    std::fclose(outFile);
+    return true;
+}
+
+int main(int argc, char** argv) {
+    std::string inFileName, outFileName, outDirName, value;
+    bool isBatch = tryParseArg(argc, argv, "-d", outDirName);
+    if(!isBatch && !tryParseIOFileNames(argc, argv, inFileName, outFileName)) {
+        std::cerr << "Usage: " << argv[0] << " -i infile -o outfile.s [--entry addr]" << std::endl;
+        std::cerr << "       " << argv[0] << " -d outdir [--entry addr] snapshot..." << std::endl;
+        return 1;
+    }
+    int entry = 0;
+    if(tryParseArg(argc, argv, "--entry", value)) {
+        entry = std::stoi(value, nullptr, 0);
+    }
+
+    Disassembler disassembler;
+    std::vector<unsigned char> image;
+    std::string text;
+    if(!isBatch) {
+        return tryDisassembleFile(disassembler, inFileName, outFileName, entry, image, text) ? 0 : 1;
+    }
+
+    int failures = 0;
+    for(int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if(arg == "-d" || arg == "--entry") {
+            ++i;
+            continue;
+        }
+        std::string name = arg.substr(arg.find_last_of('/') + 1);
+        name = name.substr(0, name.find_last_of('.'));
+        if(!tryDisassembleFile(disassembler, arg, outDirName + "/" + name + ".s", entry, image, text)) {
+            ++failures;
+        }
+    }
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,220 @@
+#ifndef DISASSEMBLER_H
+#define DISASSEMBLER_H
+
+/*
+    recovers ssbc assembly from machine code by recursive traversal
+
+    code is found by following execution from the entry point: each instruction falls through
+    to the next until a halt or an invalid opcode, and the targets of jnz and jnn are added to a
+    worklist. everything which is never reached is written as data. jump targets and the
+    addresses used by pushext and popext are given '#L_xxxx' labels, so that the output
+    re-assembles to the same bytes
+
+    every address is decoded at most once, and all state is kept in a flag per address and a
+    worklist which are reused between images, so a full 64K image takes linear time without
+    allocating per instruction
+*/
+
+#include <string>
+#include <vector>
+#include "../common.h"
+
+// what is known about an address of the image
+enum DisasmFlag {
+    // an instruction starts at this address
+    flag_code = 1,
+    // an operand byte of an instruction
+    flag_operand = 2,
+    // a jump target or an address operand, given a label
+    flag_label = 4
+};
+
+// the number of unlabelled data bytes written on one line
+const int DATA_BYTES_PER_LINE = 8;
+
+class Disassembler {
+    public:
+    // the flags of each address
+    std::vector<unsigned char> flags;
+    // the instructions found, and the bytes they cover
+    int instructions = 0;
+    int codeBytes = 0;
+
+    // disassembles the image, appending the assembly to out
+    void disassemble(const unsigned char* image, size_t size, std::string& out, int entry = 0) {
+        this->image = image;
+        this->size = size;
+        flags.assign(size, 0);
+        instructions = 0;
+        codeBytes = 0;
+        traverse(entry);
+        emit(out);
+    }
+
+    private:
+    const unsigned char* image = nullptr;
+    size_t size = 0;
+    std::vector<int> worklist;
+
+    // returns the 2 byte operand of the instruction at the address
+    int operand(size_t address) {
+        return (image[address + 1] << 8) | image[address + 2];
+    }
+
+    // marks the address as the start of an instruction, adding it to the worklist if it is new
+    void addCode(int address) {
+        if(address < (int)size && (flags[address] & flag_code) == 0) {
+            flags[address] |= flag_code;
+            worklist.push_back(address);
+        }
+    }
+
+    // follows execution from the entry point, marking code, operands and labels
+    void traverse(int entry) {
+        worklist.clear();
+        worklist.reserve(size);
+        addCode(entry);
+        while(!worklist.empty()) {
+            size_t pc = worklist.back();
+            worklist.pop_back();
+            while(true) {
+                int op = image[pc] & 0xF;
+                if(op >= op_count || pc + opSize(op) > size) {
+                    // the machine faults here, or the instruction runs off the image
+                    break;
+                }
+                ++instructions;
+                for(int i = 1; i < opSize(op); i++) {
+                    flags[pc + i] |= flag_operand;
+                }
+                if(op == op_jnz || op == op_jnn || op == op_pushext || op == op_popext) {
+                    int address = operand(pc);
+                    if(address < (int)size) {
+                        flags[address] |= flag_label;
+                    }
+                    if(op == op_jnz || op == op_jnn) {
+                        addCode(address);
+                    }
+                }
+                pc += opSize(op);
+                if(op == op_halt || pc >= size || (flags[pc] & flag_code) != 0) {
+                    break;
+                }
+                flags[pc] |= flag_code;
+            }
+        }
+    }
+
+    // appends the value as hex digits
+    void appendHex(std::string& out, int value, int digits) {
+        for(int i = digits - 1; i >= 0; i--) {
+            out.push_back(part2Hex(value >> (4 * i)));
+        }
+    }
+
+    // appends the label of an address
+    void appendLabel(std::string& out, int address) {
+        out.append("L_");
+        appendHex(out, address, 4);
+    }
+
+    // appends a byte as '0xHH'
+    void appendByte(std::string& out, int value) {
+        out.append("0x");
+        appendHex(out, value, 2);
+    }
+
+    // appends the operand of an instruction which may use an address
+    // addresses in the image are written as labels, others as 4 hex digits
+    void appendAddress(std::string& out, int address) {
+        if(address < (int)size) {
+            out.push_back('@');
+            appendLabel(out, address);
+        } else {
+            out.append("0x");
+            appendHex(out, address, 4);
+        }
+    }
+
+    // returns true if the instruction at the address can be written on one line:
+    // its opcode is one the assembler writes, and none of its operand bytes are labelled
+    // or the start of another instruction
+    bool isWholeInstruction(size_t address) {
+        int op = image[address];
+        if((flags[address] & flag_code) == 0 || op >= op_count || address + opSize(op) > size) {
+            return false;
+        }
+        for(int i = 1; i < opSize(op); i++) {
+            if((flags[address + i] & (flag_code | flag_label)) != 0) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // writes the assembly for the whole image
+    void emit(std::string& out) {
+        for(const unsigned char& flag : flags) {
+            codeBytes += (flag & (flag_code | flag_operand)) != 0;
+        }
+        out.reserve(out.size() + size * 8);
+        out.append("; disassembled: ");
+        out.append(std::to_string(instructions));
+        out.append(" instructions in ");
+        out.append(std::to_string(codeBytes));
+        out.append(" of ");
+        out.append(std::to_string(size));
+        out.append(" bytes\n");
+
+        size_t address = 0;
+        while(address < size) {
+            if(flags[address] & flag_label) {
+                out.push_back('#');
+                appendLabel(out, address);
+                out.push_back(' ');
+            }
+
+            int op = image[address];
+            if(isWholeInstruction(address)) {
+                out.append(opName(op));
+                if(op == op_pushimm) {
+                    out.push_back(' ');
+                    appendByte(out, image[address + 1]);
+                } else if(opSize(op) == 3) {
+                    out.push_back(' ');
+                    appendAddress(out, operand(address));
+                }
+                out.push_back('\n');
+                address += opSize(op);
+            } else if(flags[address] & (flag_code | flag_operand)) {
+                // code which the assembler can't write as an instruction is written a byte at a time
+                appendByte(out, image[address]);
+                if(flags[address] & flag_code) {
+                    if(op < op_count) {
+                        out.append(" ; ");
+                        out.append(opName(op));
+                    } else if((op & 0xF) < op_count) {
+                        out.append(" ; executes as ");
+                        out.append(opName(op & 0xF));
+                    } else {
+                        out.append(" ; faults");
+                    }
+                }
+                out.push_back('\n');
+                ++address;
+            } else {
+                // a run of data, up to the next label or code
+                appendByte(out, image[address]);
+                ++address;
+                for(int n = 1; n < DATA_BYTES_PER_LINE && address < size && flags[address] == 0; n++) {
+                    out.push_back(' ');
+                    appendByte(out, image[address]);
+                    ++address;
+                }
+                out.push_back('\n');
+            }
+        }
+    }
+};
+
+#endif // DISASSEMBLER_H
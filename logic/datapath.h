@@ -0,0 +1,169 @@
+/*
+    ssbc's datapath as a netlist of gates, following docs/abstractRTN.md
+
+    the control decoder of decoder.h is minimized (minimizer.h) into a sum of products per control
+    signal and built as and/or gates over IR, Z, N, the step counter T, and the reset, fault and halt
+    lines; the signals drive
+    - the alu: s1 + s2, or s1 - s2 as s1 + ~s2 + 1 through the same ripple carry adder, or s1 NOR s2
+    - the flags: Z <- NOT (R2<7> OR .. OR R2<0>), N <- R2<7>, written to the PSW at 0xFFFB
+    - the register transfers: PC, SP, IR, R2, fault and halt as flip-flops, each loading from a mux
+      of its sources, and a memory write port whose address and data are muxed the same way
+    memory is read through ports for MEM[PC], MEM[PC+1], s1, s2, MEM[ext] and the PSW
+    T counts the steps of an instruction (T0 IR <- MEM[PC], T1 set_fault, T2 PC <- PC+1, then T3 and
+    T4), returning to 0 after its last step, and at once if the machine has halted or faulted, so a
+    bad opcode's third step is the RTN's '(NOT Fault) -> ...' which isn't taken
+*/
+
+#ifndef DATAPATH_H
+#define DATAPATH_H
+
+#include <vector>
+#include "netlist.h"
+#include "minimizer.h"
+#include "decoder.h"
+#include "../ssbc-interpreter/machine.h"
+
+class Datapath {
+    public:
+    Netlist net;
+    // registers
+    Bus PC, SP, IR, R2, T;
+    int FAULT = WIRE_0, HALT = WIRE_0;
+    // the reset signal, an input
+    int reset = WIRE_0;
+    // on if the machine is halted or faulted at the start of an instruction, so the cycle does nothing
+    int idle = WIRE_0;
+    // the decoder's control signals
+    std::vector<int> control;
+    // the products of the decoder, and the total of its literals
+    int products = 0;
+    int literals = 0;
+};
+
+// the sum of products of a cover, over the decoder's input wires (input 0 most significant)
+int coverGates(Netlist& net, const std::vector<Cube>& cover, const std::vector<int>& inputs, std::map<Cube, int>& products) {
+    int n = inputs.size();
+    int sum = WIRE_0;
+    for(const auto& cube : cover) {
+        if(products.count(cube) == 0) {
+            int product = WIRE_1;
+            for(int i = 0; i < n; i++) {
+                uint32_t bit = 1u << (n - 1 - i);
+                if(cube.care & bit) {
+                    product = net.andOf(product, cube.value & bit ? inputs[i] : net.notOf(inputs[i]));
+                }
+            }
+            products[cube] = product;
+        }
+        sum = net.orOf(sum, products[cube]);
+    }
+    return sum;
+}
+
+// builds the datapath, with the decoder minimized from its truth table
+Datapath buildDatapath() {
+    Datapath d;
+    Netlist& net = d.net;
+    d.PC = net.registerBus("PC", 16);
+    d.SP = net.registerBus("SP", 16);
+    d.IR = net.registerBus("IR", 8);
+    d.R2 = net.registerBus("R2", 8);
+    d.T = net.registerBus("T", 3);
+    d.FAULT = net.registerBus("fault", 1)[0];
+    d.HALT = net.registerBus("halt", 1)[0];
+    d.reset = net.input();
+    net.names["Reset"] = { d.reset };
+
+    // operands
+    Bus memPC = net.read(d.PC, 8);
+    Bus memPC1 = net.read(net.add(d.PC, net.constant(1, 16)), 8);
+    Bus ext = memPC1;
+    ext.insert(ext.end(), memPC.begin(), memPC.end());
+    Bus SP1 = net.add(d.SP, net.constant(1, 16));
+    Bus SP2 = net.add(d.SP, net.constant(2, 16));
+    Bus s1 = net.read(SP1, 8);
+    Bus s2 = net.read(SP2, 8);
+    Bus memExt = net.read(ext, 8);
+    Bus psw = net.read(net.constant(map_PSW, 16), 8);
+    int Z = psw[7], N = psw[6];
+
+    // the decoder
+    TruthTable table = decoderTable();
+    std::vector<int> inputs;
+    for(int i = 7; i >= 0; i--) {
+        inputs.push_back(d.IR[i]);
+    }
+    inputs.insert(inputs.end(), { Z, N, d.T[2], d.T[1], d.T[0], d.reset, d.FAULT, d.HALT });
+    std::map<Cube, int> products;
+    MinimizeOptions options;
+    for(int o = 0; o < table.outputs(); o++) {
+        MinimizeStats stats;
+        std::vector<Cube> cover = minimize(table.on[o], table.dc[o], options, stats);
+        d.control.push_back(coverGates(net, cover, inputs, products));
+    }
+    d.products = products.size();
+    for(const auto& product : products) {
+        d.literals += product.first.literals();
+    }
+    const std::vector<int>& c = d.control;
+
+    // the alu, subtracting by adding the complement
+    Bus b;
+    for(int wire : s2) {
+        b.push_back(net.xorOf(wire, c[ctl_aluSub]));
+    }
+    Bus sum = net.add(s1, b, c[ctl_aluSub]);
+    Bus nor;
+    for(int i = 0; i < 8; i++) {
+        nor.push_back(net.norOf(s1[i], s2[i]));
+    }
+    Bus alu = net.muxBus(c[ctl_aluNor], nor, sum);
+    net.names["alu"] = alu;
+
+    // the flags from R2, PSW<7..0> := Z#N#6@0
+    Bus pswNext = net.constant(0, 8);
+    pswNext[7] = net.notOf(net.orReduce(d.R2));
+    pswNext[6] = d.R2[7];
+
+    // the memory write port
+    Bus address = net.selectBus({
+        { c[ctl_addrSp], d.SP }, { c[ctl_addrSp2], SP2 }, { c[ctl_addrExt], ext }, { c[ctl_flagsLoad], net.constant(map_PSW, 16) }
+    }, 16);
+    Bus data = net.selectBus({
+        { c[ctl_dataIi], memPC }, { c[ctl_dataExt], memExt }, { c[ctl_dataS1], s1 }, { c[ctl_dataAlu], alu }, { c[ctl_flagsLoad], pswNext }
+    }, 8);
+    net.write(address, data, net.orOf(c[ctl_memWrite], c[ctl_flagsLoad]));
+
+    // the registers' next values, reset taking priority
+    int notReset = net.notOf(d.reset);
+    Bus pcStep = net.constant(0, 16);
+    pcStep[0] = c[ctl_pcInc];
+    pcStep[1] = c[ctl_pcAdd2];
+    Bus pcNext = net.muxBus(c[ctl_pcLoad], ext, net.add(d.PC, pcStep));
+    Bus spStep(16, c[ctl_spDec]);
+    spStep[0] = net.orOf(c[ctl_spInc], c[ctl_spDec]);
+    Bus spNext = net.add(d.SP, spStep);
+    for(int i = 0; i < 16; i++) {
+        pcNext[i] = net.andOf(notReset, pcNext[i]);
+        spNext[i] = (SP_RESET >> i) & 1 ? net.orOf(d.reset, spNext[i]) : net.andOf(notReset, spNext[i]);
+    }
+    net.setNext(d.PC, pcNext);
+    net.setNext(d.SP, spNext);
+    net.setNext(d.IR, net.muxBus(c[ctl_irLoad], memPC, d.IR));
+    net.setNext(d.R2, net.muxBus(net.orOf(c[ctl_aluAdd], c[ctl_aluSub]), sum, d.R2));
+    net.setNext({ d.FAULT }, { net.andOf(notReset, net.orOf(d.FAULT, c[ctl_faultSet])) });
+    net.setNext({ d.HALT }, { net.andOf(notReset, net.orOf(d.HALT, c[ctl_haltSet])) });
+    int stopped = net.orOf(d.FAULT, d.HALT);
+    int tClear = net.orOf(net.orOf(d.reset, c[ctl_stepEnd]), stopped);
+    Bus tNext = net.add(d.T, net.constant(1, 3));
+    for(int i = 0; i < 3; i++) {
+        tNext[i] = net.andOf(net.notOf(tClear), tNext[i]);
+    }
+    net.setNext(d.T, tNext);
+    d.idle = net.andOf(net.andOf(stopped, net.equals(d.T, 0)), notReset);
+    net.names["idle"] = { d.idle };
+    net.levelize();
+    return d;
+}
+
+#endif // DATAPATH_H
@@ -0,0 +1,139 @@
+/*
+    the truth table of ssbc's control decoder, from docs/abstractRTN.md
+
+    each instruction takes a step per sequential (';') part of its RTN, counted by T:
+    - T0: IR <- MEM[PC]
+    - T1: set_fault (the opcode, IR<3..0>, is past 0xA)
+    - T2: PC <- PC+1
+    - T3 and T4: the execution steps, 1 or 2 of them as in opCycles()
+    the decoder gives the control signals of a step from IR, the flags, T, and the reset, fault and
+    halt lines; steps an instruction never reaches (T past its last step, or past T1 for a bad
+    opcode) are don't-cares, which is most of what lets the decoder minimize well
+*/
+
+#ifndef DECODER_H
+#define DECODER_H
+
+#include <string>
+#include <vector>
+#include "minimizer.h"
+
+// the decoder's inputs, in the order of their bits in a minterm, most significant first
+const std::vector<std::string> DECODER_INPUTS = {
+    "IR7", "IR6", "IR5", "IR4", "IR3", "IR2", "IR1", "IR0", "Z", "N", "T2", "T1", "T0", "Reset", "Fault", "Halt"
+};
+
+// the control signals
+enum {
+    ctl_reset,      // PC <- 0, SP <- 0xFFFA, halt <- 0, fault <- 0, T <- 0
+    ctl_irLoad,     // IR <- MEM[PC]
+    ctl_faultSet,   // fault <- 1
+    ctl_pcInc,      // PC <- PC+1
+    ctl_pcAdd2,     // PC <- PC+2
+    ctl_pcLoad,     // PC <- ext
+    ctl_spInc,      // SP <- SP+1
+    ctl_spDec,      // SP <- SP-1
+    ctl_memWrite,   // MEM[address] <- data
+    ctl_addrSp,     // address is SP
+    ctl_addrSp2,    // address is SP+2
+    ctl_addrExt,    // address is ext
+    ctl_dataIi,     // data is ii
+    ctl_dataExt,    // data is MEM[ext]
+    ctl_dataS1,     // data is s1
+    ctl_dataAlu,    // data is the alu's result, R2
+    ctl_aluAdd,     // R2 <- s1+s2
+    ctl_aluSub,     // R2 <- s1-s2
+    ctl_aluNor,     // R2 <- s1 NOR s2
+    ctl_flagsLoad,  // Z and N from R2
+    ctl_haltSet,    // halt <- 1
+    ctl_stepEnd,    // T <- 0 (else T <- T+1)
+    ctl_count
+};
+
+const std::vector<std::string> DECODER_OUTPUTS = {
+    "reset", "irLoad", "faultSet", "pcInc", "pcAdd2", "pcLoad", "spInc", "spDec", "memWrite", "addrSp", "addrSp2",
+    "addrExt", "dataIi", "dataExt", "dataS1", "dataAlu", "aluAdd", "aluSub", "aluNor", "flagsLoad", "haltSet", "stepEnd"
+};
+
+// fills the control signals of a step, returns false if the step can't happen (all are don't-cares)
+bool decodeControl(int ir, bool z, bool n, int step, bool reset, bool fault, bool halt, std::vector<bool>& out_signals) {
+    out_signals.assign(ctl_count, false);
+    if(reset) {
+        out_signals[ctl_reset] = true;
+        return true;
+    }
+    if(fault || halt) {
+        return true;
+    }
+    int opcode = ir & 0xF;
+    bool isValid = opcode < op_count;
+    if(step == 0) {
+        out_signals[ctl_irLoad] = true;
+        return true;
+    }
+    if(step == 1) {
+        out_signals[ctl_faultSet] = !isValid;
+        return true;
+    }
+    // a bad opcode faults at T1, so never gets further
+    if(!isValid || step > 2 + (opCycles(opcode) - 3)) {
+        return false;
+    }
+    if(step == 2) {
+        out_signals[ctl_pcInc] = true;
+        return true;
+    }
+    bool isLast = step == 2 + (opCycles(opcode) - 3);
+    out_signals[ctl_stepEnd] = isLast;
+    bool isAlu = opcode == op_add || opcode == op_sub || opcode == op_nor;
+    if(step == 3) {
+        switch(opcode) {
+            case op_halt: { out_signals[ctl_haltSet] = true; break; }
+            case op_pushimm: { out_signals[ctl_memWrite] = out_signals[ctl_addrSp] = out_signals[ctl_dataIi] = true; break; }
+            case op_pushext: { out_signals[ctl_memWrite] = out_signals[ctl_addrSp] = out_signals[ctl_dataExt] = true; break; }
+            case op_popinh: { out_signals[ctl_spInc] = true; break; }
+            case op_popext: { out_signals[ctl_memWrite] = out_signals[ctl_addrExt] = out_signals[ctl_dataS1] = true; break; }
+            // a jump which isn't taken skips over its address
+            case op_jnz: { out_signals[z ? ctl_pcAdd2 : ctl_pcLoad] = true; break; }
+            case op_jnn: { out_signals[n ? ctl_pcAdd2 : ctl_pcLoad] = true; break; }
+        }
+        if(isAlu) {
+            out_signals[ctl_memWrite] = out_signals[ctl_addrSp2] = out_signals[ctl_dataAlu] = true;
+            out_signals[opcode == op_add ? ctl_aluAdd : opcode == op_sub ? ctl_aluSub : ctl_aluNor] = true;
+        }
+        return true;
+    }
+    switch(opcode) {
+        case op_pushimm: { out_signals[ctl_spDec] = out_signals[ctl_pcInc] = true; break; }
+        case op_pushext: { out_signals[ctl_spDec] = out_signals[ctl_pcAdd2] = true; break; }
+        case op_popext: { out_signals[ctl_spInc] = out_signals[ctl_pcAdd2] = true; break; }
+    }
+    if(isAlu) {
+        out_signals[ctl_spInc] = true;
+        out_signals[ctl_flagsLoad] = opcode != op_nor;
+    }
+    return true;
+}
+
+// the decoder's truth table, over every combination of its 16 inputs
+TruthTable decoderTable() {
+    TruthTable table(DECODER_INPUTS, DECODER_OUTPUTS);
+    std::vector<bool> signals;
+    for(uint32_t m = 0; m < (1u << DECODER_INPUTS.size()); m++) {
+        int ir = m >> 8;
+        bool z = (m >> 7) & 1, n = (m >> 6) & 1;
+        int step = (m >> 3) & 7;
+        bool reset = (m >> 2) & 1, fault = (m >> 1) & 1, halt = m & 1;
+        bool isPossible = decodeControl(ir, z, n, step, reset, fault, halt, signals);
+        for(int o = 0; o < ctl_count; o++) {
+            if(!isPossible) {
+                table.dc[o].set(m);
+            } else if(signals[o]) {
+                table.on[o].set(m);
+            }
+        }
+    }
+    return table;
+}
+
+#endif // DECODER_H
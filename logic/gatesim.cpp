@@ -0,0 +1,212 @@
+/*
+    simulates ssbc's datapath at gate level, 64 machines at a time, checking every clock cycle
+    against the interpreter
+
+    each of the 64 lanes runs its own program: random memory images (mostly valid opcodes), or the
+    programs given, with random values on ports A and C; after each cycle every lane's PC, SP, IR,
+    R2, fault and halt, whether it is between instructions, and the byte it wrote are compared with
+    an interpreter stepped a cycle at a time (Machine::microStep), then its whole memory once the
+    lanes have all stopped
+*/
+
+#include <string>
+#include <iostream>
+#include <fstream>
+#include <iomanip>
+#include <random>
+#include <chrono>
+#include "datapath.h"
+#include "../assem2mac/assembler.h"
+#include "../ssbc-interpreter/machine.h"
+
+// fills each lane's image, from the programs if there are any
+void fillImages(const std::vector<std::vector<unsigned char>>& programs, std::mt19937_64& random, std::vector<std::vector<unsigned char>>& out_images) {
+    for(int lane = 0; lane < LANES; lane++) {
+        std::vector<unsigned char>& image = out_images[lane];
+        if(!programs.empty()) {
+            image = programs[lane % programs.size()];
+            image.resize(IMAGE_SIZE, 0);
+            image[map_portA] = random();
+            image[map_portC] = random();
+            continue;
+        }
+        // valid opcodes with random operands, so that programs run for a while before faulting
+        std::fill(image.begin(), image.end(), 0);
+        int size = 64 + random() % 1024;
+        for(int i = 0; i < size; i++) {
+            image[i] = random() % 8 == 0 ? random() : random() % op_count;
+        }
+        image[map_PSW] = random() & 0xC0;
+    }
+}
+
+// the registers of every lane, gathered once a cycle
+class LaneState {
+    public:
+    int PC[LANES], SP[LANES], IR[LANES], R2[LANES], T[LANES];
+
+    void gather(const NetlistSim& sim, const Datapath& d) {
+        sim.gather(d.PC, PC);
+        sim.gather(d.SP, SP);
+        sim.gather(d.IR, IR);
+        sim.gather(d.R2, R2);
+        sim.gather(d.T, T);
+    }
+};
+
+// returns the first difference between the lane and its interpreter, or "" if they match
+std::string compareLane(const NetlistSim& sim, const Datapath& d, const LaneState& state, int lane, const Machine& machine) {
+    static const std::vector<std::string> names = { "PC", "SP", "IR", "R2", "fault", "halt", "the start of an instruction" };
+    int gates[] = {
+        state.PC[lane], state.SP[lane], state.IR[lane], state.R2[lane],
+        (int)(sim.wires[d.FAULT] >> lane) & 1, (int)(sim.wires[d.HALT] >> lane) & 1, state.T[lane] == 0
+    };
+    int interpreter[] = { machine.PC, machine.SP, machine.IR, machine.R2, machine.FAULT, machine.HALT, machine.phase == 0 };
+    for(size_t i = 0; i < names.size(); i++) {
+        if(gates[i] != interpreter[i]) {
+            return names[i] + " is " + std::to_string(gates[i]) + " at gate level but " + std::to_string(interpreter[i]) + " in the interpreter";
+        }
+    }
+    return "";
+}
+
+int main(int argc, char** argv) {
+    std::string value;
+    int batches = 20;
+    long long maxCycles = 20000;
+    if(tryParseArg(argc, argv, "--batches", value)) {
+        batches = std::atoi(value.c_str());
+    }
+    if(tryParseArg(argc, argv, "--cycles", value)) {
+        maxCycles = std::atoll(value.c_str());
+    }
+    std::string seed = "1";
+    tryParseArg(argc, argv, "--seed", seed);
+    std::mt19937_64 random(std::atoll(seed.c_str()));
+
+    // the other arguments are programs in ssbc assembly
+    std::vector<std::vector<unsigned char>> programs;
+    for(int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if(arg == "--batches" || arg == "--cycles" || arg == "--seed" || arg == "--netlist") {
+            i++;
+            continue;
+        }
+        std::ifstream inFile(arg);
+        if(!inFile.is_open()) {
+            std::cerr << "Error: could not open " << arg << std::endl;
+            std::cerr << "Usage: " << argv[0] << " [--batches n] [--cycles n] [--seed n] [--netlist outfile] [program.s ...]" << std::endl;
+            return 1;
+        }
+        std::stringstream source;
+        source << inFile.rdbuf();
+        // .include is found relative to the program
+        AssembleOptions options;
+        size_t slash = arg.find_last_of('/');
+        options.includeDirs.push_back(slash != std::string::npos ? arg.substr(0, slash) : ".");
+        AssembleResult result = assemble(source.str(), options);
+        if(!result.ok) {
+            for(const auto& diagnostic : result.diagnostics) {
+                std::cerr << diagnostic << std::endl;
+            }
+            return 1;
+        }
+        programs.push_back(result.image);
+    }
+
+    auto buildStart = std::chrono::steady_clock::now();
+    Datapath d = buildDatapath();
+    double buildMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - buildStart).count();
+    std::string netlistFileName;
+    if(tryParseArg(argc, argv, "--netlist", netlistFileName)) {
+        std::ofstream netlistFile(netlistFileName);
+        if(!netlistFile.is_open()) {
+            std::cerr << "Error: could not open " << netlistFileName << std::endl;
+            return 1;
+        }
+        d.net.writeListing(netlistFile);
+    }
+    std::string counts;
+    for(const auto& count : d.net.gateCounts()) {
+        counts += (counts.empty() ? "" : ", ") + std::to_string(count.second) + " " + count.first;
+    }
+    std::cerr << "netlist: " << d.net.gates.size() << " gates (" << counts << "), " << d.net.depth() << " levels, " << d.net.flops.size() << " flip-flops, " << d.net.readPorts.size()
+        << " read ports; decoder of " << d.products << " products, " << d.literals << " literals; built in "
+        << std::fixed << std::setprecision(1) << buildMs << " ms" << std::endl;
+
+    NetlistSim sim(d.net);
+    LaneState state;
+    std::vector<Machine> machines(LANES);
+    std::vector<std::vector<unsigned char>> images(LANES, std::vector<unsigned char>(IMAGE_SIZE));
+    long long laneCycles = 0, instructions = 0;
+    int halted = 0, faulted = 0, stopped = 0;
+    auto start = std::chrono::steady_clock::now();
+    for(int batch = 0; batch < batches; batch++) {
+        fillImages(programs, random, images);
+        // fresh machines, as reset leaves R2 alone
+        machines.assign(LANES, Machine());
+        for(int lane = 0; lane < LANES; lane++) {
+            for(int address = 0; address < IMAGE_SIZE; address++) {
+                sim.at(lane, address) = images[lane][address];
+            }
+            machines[lane].load(images[lane]);
+        }
+        // a reset cycle, which the interpreter's load has done
+        std::fill(sim.wires.begin() + 2, sim.wires.end(), 0);
+        sim.wires[d.reset] = ~0ull;
+        sim.evaluate();
+        sim.clock();
+        sim.wires[d.reset] = 0;
+
+        for(long long cycle = 0; cycle < maxCycles; cycle++) {
+            sim.evaluate();
+            uint64_t idle = sim.wires[d.idle];
+            if(idle == ~0ull) {
+                break;
+            }
+            // the address each lane writes this cycle, to check the interpreter wrote the same byte
+            const WritePort& port = d.net.writePorts[0];
+            uint64_t writes = sim.wires[port.enable] & ~idle;
+            int addresses[LANES];
+            sim.gather(port.address, addresses);
+            sim.clock();
+            state.gather(sim, d);
+            for(int lane = 0; lane < LANES; lane++) {
+                Machine& machine = machines[lane];
+                bool isRunning = machine.microStep();
+                std::string difference;
+                if(isRunning != !((idle >> lane) & 1)) {
+                    difference = isRunning ? "the gates are idle but the interpreter isn't" : "the interpreter is idle but the gates aren't";
+                } else if(isRunning) {
+                    difference = compareLane(sim, d, state, lane, machine);
+                    laneCycles++;
+                }
+                if(difference.empty() && ((writes >> lane) & 1) && sim.at(lane, addresses[lane]) != machine.MEM[addresses[lane]]) {
+                    difference = "MEM[" + intToFourHex(addresses[lane]) + "] differs";
+                }
+                if(!difference.empty()) {
+                    std::cerr << "Error: batch " << batch << " lane " << lane << " cycle " << cycle + 1
+                        << " (instruction " << machine.instructions << ", opcode " << (machine.IR & 0xF) << "): " << difference << std::endl;
+                    return 1;
+                }
+            }
+        }
+        for(int lane = 0; lane < LANES; lane++) {
+            for(int address = 0; address < IMAGE_SIZE; address++) {
+                if(sim.at(lane, address) != machines[lane].MEM[address]) {
+                    std::cerr << "Error: batch " << batch << " lane " << lane << ": MEM[" << intToFourHex(address) << "] differs from the interpreter's" << std::endl;
+                    return 1;
+                }
+            }
+            instructions += machines[lane].instructions;
+            halted += machines[lane].HALT;
+            faulted += machines[lane].FAULT;
+            stopped += !machines[lane].HALT && !machines[lane].FAULT;
+        }
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cerr << batches * LANES << " machines (" << halted << " halted, " << faulted << " faulted, " << stopped << " stopped after "
+        << maxCycles << " cycles): " << instructions << " instructions, " << laneCycles << " cycles, every one matching the interpreter, in "
+        << std::setprecision(2) << seconds << " s (" << std::setprecision(1) << laneCycles / seconds / 1e6 << "M machine cycles/s)" << std::endl;
+    return 0;
+}
@@ -0,0 +1,122 @@
+/*
+    minimizes a truth table into a sum of products per output
+
+    the table is read from a pla file (-i), or is ssbc's control decoder (--decoder) or a random
+    function of some inputs (--random); the cover is written as pla or as c equations (-f eqn),
+    checked against the table, and its size and the time taken are reported on stderr
+*/
+
+#include <string>
+#include <iostream>
+#include <fstream>
+#include <iomanip>
+#include <random>
+#include <chrono>
+#include "minimizer.h"
+#include "decoder.h"
+
+int main(int argc, char** argv) {
+    std::string inFileName, outFileName, randomInputs;
+    bool hasIn = tryParseArg(argc, argv, "-i", inFileName);
+    bool isDecoder = tryParseArg(argc, argv, "--decoder");
+    bool isRandom = tryParseArg(argc, argv, "--random", randomInputs);
+    if(!tryParseArg(argc, argv, "-o", outFileName) || hasIn + isDecoder + isRandom != 1) {
+        std::cerr << "Usage: " << argv[0] << " (-i infile.pla | --decoder | --random inputs [--seed n]) -o outfile"
+            << " [-f pla|eqn] [--method auto|qm|espresso] [--table tablefile]" << std::endl;
+        return 1;
+    }
+    std::string format = "pla";
+    tryParseArg(argc, argv, "-f", format);
+    if(format != "pla" && format != "eqn") {
+        std::cerr << "Error: unrecognized output format: '" << format << "'" << std::endl;
+        return 1;
+    }
+    MinimizeOptions options;
+    tryParseArg(argc, argv, "--method", options.method);
+    if(options.method != "auto" && options.method != "qm" && options.method != "espresso") {
+        std::cerr << "Error: unrecognized method: '" << options.method << "'" << std::endl;
+        return 1;
+    }
+
+    TruthTable table;
+    if(hasIn) {
+        std::ifstream inFile(inFileName);
+        if(!inFile.is_open()) {
+            std::cerr << "Error: could not open " << inFileName << std::endl;
+            return 1;
+        }
+        if(!tryReadPla(inFile, table, std::cerr)) {
+            return 1;
+        }
+    } else if(isDecoder) {
+        table = decoderTable();
+    } else {
+        // like the javascript simplifier's test, each minterm is on or off at random
+        int inputs = std::atoi(randomInputs.c_str());
+        if(inputs < 1 || inputs > MAX_INPUTS) {
+            std::cerr << "Error: a table needs 1 to " << MAX_INPUTS << " inputs" << std::endl;
+            return 1;
+        }
+        std::string seed = "1";
+        tryParseArg(argc, argv, "--seed", seed);
+        std::mt19937_64 random(std::atoll(seed.c_str()));
+        std::vector<std::string> inputNames;
+        for(int i = 0; i < inputs; i++) {
+            inputNames.push_back("in" + std::to_string(i));
+        }
+        table = TruthTable(inputNames, { "out0" });
+        for(auto& word : table.on[0].words) {
+            word = random() & table.on[0].wordMask();
+        }
+    }
+
+    std::string tableFileName;
+    if(tryParseArg(argc, argv, "--table", tableFileName)) {
+        std::ofstream tableFile(tableFileName);
+        if(!tableFile.is_open()) {
+            std::cerr << "Error: could not open " << tableFileName << std::endl;
+            return 1;
+        }
+        writeTablePla(tableFile, table);
+    }
+
+    std::cerr << std::left << std::setw(12) << "output" << std::right << std::setw(9) << "on" << std::setw(9) << "dc"
+        << std::setw(9) << "method" << std::setw(8) << "cubes" << std::setw(10) << "literals" << std::setw(10) << "ms" << std::endl;
+    std::vector<std::vector<Cube>> covers;
+    size_t totalCubes = 0, totalLiterals = 0;
+    auto start = std::chrono::steady_clock::now();
+    for(int o = 0; o < table.outputs(); o++) {
+        auto outputStart = std::chrono::steady_clock::now();
+        MinimizeStats stats;
+        covers.push_back(minimize(table.on[o], table.dc[o], options, stats));
+        double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - outputStart).count();
+        if(!isCover(covers.back(), table.on[o], table.dc[o])) {
+            std::cerr << "Error: the cover of " << table.outputNames[o] << " doesn't match its table" << std::endl;
+            return 1;
+        }
+        size_t literals = 0;
+        for(const auto& cube : covers.back()) {
+            literals += cube.literals();
+        }
+        totalCubes += covers.back().size();
+        totalLiterals += literals;
+        std::cerr << std::left << std::setw(12) << table.outputNames[o] << std::right << std::setw(9) << table.on[o].count()
+            << std::setw(9) << table.dc[o].count() << std::setw(9) << stats.method << std::setw(8) << covers.back().size()
+            << std::setw(10) << literals << std::setw(10) << std::fixed << std::setprecision(1) << ms << std::endl;
+    }
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    std::cerr << "total: " << table.inputs << " inputs, " << table.outputs() << " outputs, " << totalCubes << " cubes, "
+        << totalLiterals << " literals in " << std::fixed << std::setprecision(1) << ms << " ms, every cover checked" << std::endl;
+
+    std::ofstream outFile(outFileName);
+    if(!outFile.is_open()) {
+        std::cerr << "Error: could not open " << outFileName << std::endl;
+        return 1;
+    }
+    if(format == "pla") {
+        writeCoverPla(outFile, table, covers);
+    } else {
+        writeCoverEquations(outFile, table, covers);
+    }
+    return 0;
+}
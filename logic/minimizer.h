@@ -0,0 +1,662 @@
+/*
+    two-level (sum of products) minimization of truth tables, for designing ssbc's decode and alu logic
+    - a cube (product term) is a pair of bitmasks: the inputs it cares about, and their values
+    - the on-set, don't-care set and off-set of a function are bitsets over its minterms, and a
+      cube is checked against one 64 minterms at a time: a word pattern selects the cube's
+      minterms among the lowest 6 inputs, and only the words its higher inputs allow are visited
+    - 'qm' finds every prime implicant Quine-McCluskey style (each implicant looks up its
+      neighbour across one input in a hash set rather than comparing every pair) then takes the
+      essential primes and a greedy cover of what is left
+    - 'espresso' grows each uncovered minterm into a prime, removes redundant cubes, and
+      repeats reduce / expand / irredundant while the cover gets smaller
+    - 'auto' uses qm while it stays small and falls back to espresso
+*/
+
+#ifndef MINIMIZER_H
+#define MINIMIZER_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <iostream>
+#include <sstream>
+#include <unordered_set>
+#include <algorithm>
+#include "../common.h"
+
+// the most inputs a truth table may have (the minterm bitsets take 2^inputs bits)
+const int MAX_INPUTS = 24;
+
+// a product of literals: the inputs in care must equal the bits of value
+// input i of a table with n inputs is bit n-1-i of a minterm, so a row read as binary is its minterm
+class Cube {
+    public:
+    uint32_t care = 0;
+    uint32_t value = 0;
+
+    Cube() { }
+    Cube(uint32_t _care, uint32_t _value) : care(_care), value(_value & _care) { }
+
+    // the cube of a single minterm
+    static Cube minterm(int inputs, uint32_t m) {
+        return Cube((1u << inputs) - 1, m);
+    }
+
+    int literals() const {
+        return __builtin_popcount(care);
+    }
+
+    bool contains(uint32_t m) const {
+        return (m & care) == value;
+    }
+
+    bool contains(const Cube& other) const {
+        return (other.care & care) == care && (other.value & care) == value;
+    }
+
+    bool operator==(const Cube& other) const {
+        return care == other.care && value == other.value;
+    }
+
+    bool operator<(const Cube& other) const {
+        return care != other.care ? care < other.care : value < other.value;
+    }
+
+    // the cube as a row of '0', '1' and '-', input 0 first
+    std::string text(int inputs) const {
+        std::string row(inputs, '-');
+        for(int i = 0; i < inputs; i++) {
+            uint32_t bit = 1u << (inputs - 1 - i);
+            if(care & bit) {
+                row[i] = value & bit ? '1' : '0';
+            }
+        }
+        return row;
+    }
+};
+
+class CubeHash {
+    public:
+    size_t operator()(const Cube& cube) const {
+        return std::hash<uint64_t>()(((uint64_t)cube.care << 32) | cube.value);
+    }
+};
+
+// the bits of a word of minterms whose low 6 bits have input bit i set
+const uint64_t LOW_INPUT_PATTERNS[6] = {
+    0xAAAAAAAAAAAAAAAAull, 0xCCCCCCCCCCCCCCCCull, 0xF0F0F0F0F0F0F0F0ull,
+    0xFF00FF00FF00FF00ull, 0xFFFF0000FFFF0000ull, 0xFFFFFFFF00000000ull
+};
+
+// a set of minterms of a function of some number of inputs, 64 to a word
+class MintermSet {
+    public:
+    int inputs = 0;
+    std::vector<uint64_t> words;
+
+    MintermSet() { }
+    MintermSet(int _inputs) : inputs(_inputs), words(_inputs >= 6 ? (size_t)1 << (_inputs - 6) : 1, 0) { }
+
+    // the bits of a word which are minterms, less than 64 if there are fewer than 6 inputs
+    uint64_t wordMask() const {
+        return inputs >= 6 ? ~0ull : (1ull << (1 << inputs)) - 1;
+    }
+
+    void set(uint32_t m) {
+        words[m >> 6] |= 1ull << (m & 63);
+    }
+
+    bool test(uint32_t m) const {
+        return (words[m >> 6] >> (m & 63)) & 1;
+    }
+
+    // calls f(index, mask) for each word holding minterms of cube, with mask the bits of those minterms
+    template<typename F>
+    void forEachWord(const Cube& cube, F f) const {
+        uint64_t pattern = wordMask();
+        for(int i = 0; i < 6 && i < inputs; i++) {
+            if(cube.care & (1u << i)) {
+                pattern &= cube.value & (1u << i) ? LOW_INPUT_PATTERNS[i] : ~LOW_INPUT_PATTERNS[i];
+            }
+        }
+        uint32_t highMask = inputs > 6 ? (uint32_t)(words.size() - 1) : 0;
+        uint32_t highCare = (cube.care >> 6) & highMask;
+        uint32_t highValue = (cube.value >> 6) & highCare;
+        uint32_t free = highMask & ~highCare;
+        // visit every subset of the free high inputs
+        uint32_t sub = 0;
+        do {
+            f(highValue | sub, pattern);
+            sub = (sub - free) & free;
+        } while(sub != 0);
+    }
+
+    // calls f(minterm) for each minterm in both the set and cube
+    template<typename F>
+    void forEachMinterm(const Cube& cube, F f) const {
+        forEachWord(cube, [&](uint32_t index, uint64_t mask) {
+            uint64_t bits = words[index] & mask;
+            while(bits != 0) {
+                f((index << 6) | __builtin_ctzll(bits));
+                bits &= bits - 1;
+            }
+        });
+    }
+
+    bool intersects(const Cube& cube) const {
+        bool found = false;
+        forEachWord(cube, [&](uint32_t index, uint64_t mask) {
+            found |= (words[index] & mask) != 0;
+        });
+        return found;
+    }
+
+    size_t count(const Cube& cube) const {
+        size_t total = 0;
+        forEachWord(cube, [&](uint32_t index, uint64_t mask) {
+            total += __builtin_popcountll(words[index] & mask);
+        });
+        return total;
+    }
+
+    size_t count() const {
+        size_t total = 0;
+        for(uint64_t word : words) {
+            total += __builtin_popcountll(word);
+        }
+        return total;
+    }
+
+    bool empty() const {
+        for(uint64_t word : words) {
+            if(word != 0) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    void add(const Cube& cube) {
+        forEachWord(cube, [&](uint32_t index, uint64_t mask) {
+            words[index] |= mask;
+        });
+    }
+
+    void remove(const Cube& cube) {
+        forEachWord(cube, [&](uint32_t index, uint64_t mask) {
+            words[index] &= ~mask;
+        });
+    }
+
+    // fills the lowest minterm in the set, returns false if it is empty
+    bool tryFirst(uint32_t& out_m) const {
+        for(size_t i = 0; i < words.size(); i++) {
+            if(words[i] != 0) {
+                out_m = (i << 6) | __builtin_ctzll(words[i]);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    MintermSet operator|(const MintermSet& other) const {
+        MintermSet result = *this;
+        for(size_t i = 0; i < words.size(); i++) {
+            result.words[i] |= other.words[i];
+        }
+        return result;
+    }
+
+    // the minterms not in the set
+    MintermSet complement() const {
+        MintermSet result = *this;
+        for(auto& word : result.words) {
+            word = ~word & wordMask();
+        }
+        return result;
+    }
+};
+
+// the number of cubes and literals of a cover, the cubes counting first
+long long coverCost(const std::vector<Cube>& cover) {
+    long long literals = 0;
+    for(const auto& cube : cover) {
+        literals += cube.literals();
+    }
+    return (long long)cover.size() * (MAX_INPUTS + 1) + literals;
+}
+
+// returns true if cover holds every minterm of on, and nothing outside on and dc
+bool isCover(const std::vector<Cube>& cover, const MintermSet& on, const MintermSet& dc) {
+    MintermSet covered(on.inputs);
+    for(const auto& cube : cover) {
+        covered.add(cube);
+    }
+    for(size_t i = 0; i < on.words.size(); i++) {
+        if((on.words[i] & ~covered.words[i]) != 0 || (covered.words[i] & ~(on.words[i] | dc.words[i])) != 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// fills every prime implicant of on with dc, by merging implicants differing in one input
+// returns false if an intermediate set of implicants grew past limit
+bool tryPrimeImplicants(const MintermSet& on, const MintermSet& dc, size_t limit, std::vector<Cube>& out_primes) {
+    out_primes.clear();
+    MintermSet onOrDc = on | dc;
+    std::unordered_set<Cube, CubeHash> layer;
+    onOrDc.forEachMinterm(Cube(), [&](uint32_t m) {
+        layer.insert(Cube::minterm(on.inputs, m));
+    });
+    if(layer.size() > limit) {
+        return false;
+    }
+    while(!layer.empty()) {
+        std::unordered_set<Cube, CubeHash> next;
+        for(const auto& cube : layer) {
+            bool isPrime = true;
+            for(uint32_t cared = cube.care; cared != 0; cared &= cared - 1) {
+                uint32_t bit = cared & -cared;
+                if(layer.count(Cube(cube.care, cube.value ^ bit)) != 0) {
+                    isPrime = false;
+                    next.insert(Cube(cube.care & ~bit, cube.value & ~bit));
+                }
+            }
+            // a cube only of don't-cares is no use in a cover
+            if(isPrime && on.intersects(cube)) {
+                out_primes.push_back(cube);
+            }
+        }
+        if(next.size() > limit) {
+            return false;
+        }
+        layer.swap(next);
+    }
+    std::sort(out_primes.begin(), out_primes.end());
+    return true;
+}
+
+// chooses cubes from primes covering on: every essential prime (the only one holding some minterm),
+// then repeatedly the one holding the most minterms not yet covered, the fewest literals breaking ties
+std::vector<Cube> selectCover(const std::vector<Cube>& primes, const MintermSet& on) {
+    // minterms held by one prime, and by two or more
+    MintermSet once(on.inputs), twice(on.inputs);
+    for(const auto& prime : primes) {
+        on.forEachWord(prime, [&](uint32_t index, uint64_t mask) {
+            twice.words[index] |= once.words[index] & mask;
+            once.words[index] |= mask;
+        });
+    }
+    MintermSet unique = on;
+    for(size_t i = 0; i < unique.words.size(); i++) {
+        unique.words[i] &= once.words[i] & ~twice.words[i];
+    }
+
+    std::vector<Cube> cover;
+    std::vector<bool> isUsed(primes.size(), false);
+    MintermSet uncovered = on;
+    for(size_t i = 0; i < primes.size(); i++) {
+        if(unique.intersects(primes[i])) {
+            cover.push_back(primes[i]);
+            isUsed[i] = true;
+            uncovered.remove(primes[i]);
+        }
+    }
+    while(!uncovered.empty()) {
+        size_t best = 0, bestCount = 0;
+        for(size_t i = 0; i < primes.size(); i++) {
+            if(isUsed[i]) {
+                continue;
+            }
+            size_t count = uncovered.count(primes[i]);
+            if(count > bestCount || (count == bestCount && count > 0 && primes[i].literals() < primes[best].literals())) {
+                best = i;
+                bestCount = count;
+            }
+        }
+        cover.push_back(primes[best]);
+        isUsed[best] = true;
+        uncovered.remove(primes[best]);
+    }
+    return cover;
+}
+
+// grows cube into a prime implicant which doesn't touch off, one input at a time, each time freeing
+// the input whose new half holds the most minterms of target
+Cube expand(Cube cube, const MintermSet& off, const MintermSet& target) {
+    // an input which can't be freed stays blocked as the cube grows
+    uint32_t blocked = 0;
+    while(true) {
+        uint32_t bestBit = 0;
+        long long bestCount = -1;
+        for(uint32_t cared = cube.care & ~blocked; cared != 0; cared &= cared - 1) {
+            uint32_t bit = cared & -cared;
+            Cube half(cube.care, cube.value ^ bit);
+            if(off.intersects(half)) {
+                blocked |= bit;
+                continue;
+            }
+            long long count = target.count(half);
+            if(count > bestCount) {
+                bestBit = bit;
+                bestCount = count;
+            }
+        }
+        if(bestBit == 0) {
+            return cube;
+        }
+        cube = Cube(cube.care & ~bestBit, cube.value);
+    }
+}
+
+// removes cubes whose minterms of on are all held by other cubes, trying the smallest cubes first
+void irredundant(std::vector<Cube>& cover, const MintermSet& on, std::vector<uint16_t>& counts) {
+    std::fill(counts.begin(), counts.end(), 0);
+    for(const auto& cube : cover) {
+        on.forEachMinterm(cube, [&](uint32_t m) { counts[m]++; });
+    }
+    std::stable_sort(cover.begin(), cover.end(), [](const Cube& a, const Cube& b) {
+        return a.literals() > b.literals();
+    });
+    std::vector<Cube> kept;
+    for(const auto& cube : cover) {
+        bool isNeeded = false;
+        on.forEachMinterm(cube, [&](uint32_t m) { isNeeded |= counts[m] == 1; });
+        if(isNeeded) {
+            kept.push_back(cube);
+        } else {
+            on.forEachMinterm(cube, [&](uint32_t m) { counts[m]--; });
+        }
+    }
+    cover.swap(kept);
+}
+
+// shrinks each cube to the smallest cube holding the minterms of on which only it holds
+void reduce(std::vector<Cube>& cover, const MintermSet& on, std::vector<uint16_t>& counts) {
+    uint32_t full = Cube::minterm(on.inputs, 0).care;
+    for(auto& cube : cover) {
+        uint32_t all = full, any = 0;
+        on.forEachMinterm(cube, [&](uint32_t m) {
+            if(counts[m] == 1) {
+                all &= m;
+                any |= m;
+            }
+        });
+        if(any == 0 && all == full) {
+            continue;
+        }
+        Cube reduced(full & ~(all ^ any), all);
+        on.forEachMinterm(cube, [&](uint32_t m) {
+            if(!reduced.contains(m)) {
+                counts[m]--;
+            }
+        });
+        cube = reduced;
+    }
+}
+
+// a cover of on with dc found by espresso's expand, irredundant and reduce loop
+std::vector<Cube> minimizeEspresso(const MintermSet& on, const MintermSet& dc, int& out_passes) {
+    MintermSet off = (on | dc).complement();
+    std::vector<Cube> cover;
+    MintermSet uncovered = on;
+    uint32_t m;
+    while(uncovered.tryFirst(m)) {
+        Cube cube = expand(Cube::minterm(on.inputs, m), off, uncovered);
+        cover.push_back(cube);
+        uncovered.remove(cube);
+    }
+    std::vector<uint16_t> counts((size_t)1 << on.inputs);
+    irredundant(cover, on, counts);
+
+    std::vector<Cube> best = cover;
+    out_passes = 1;
+    for(int pass = 0; pass < 8; pass++) {
+        reduce(cover, on, counts);
+        for(auto& cube : cover) {
+            cube = expand(cube, off, on);
+        }
+        irredundant(cover, on, counts);
+        out_passes++;
+        if(coverCost(cover) >= coverCost(best)) {
+            break;
+        }
+        best = cover;
+    }
+    std::sort(best.begin(), best.end());
+    return best;
+}
+
+class MinimizeOptions {
+    public:
+    // 'auto', 'qm' or 'espresso'
+    std::string method = "auto";
+    // the most implicants qm may hold at once in auto, before falling back to espresso
+    size_t qmLimit = 1 << 12;
+};
+
+class MinimizeStats {
+    public:
+    std::string method;
+    size_t primes = 0;
+    int passes = 0;
+};
+
+// a sum of products holding every minterm of on, and nothing outside on and dc
+std::vector<Cube> minimize(const MintermSet& on, const MintermSet& dc, const MinimizeOptions& options, MinimizeStats& out_stats) {
+    out_stats = MinimizeStats();
+    if(on.empty()) {
+        out_stats.method = "none";
+        return {};
+    }
+    if(options.method != "espresso") {
+        std::vector<Cube> primes;
+        size_t limit = options.method == "qm" ? (size_t)-1 : options.qmLimit;
+        if(tryPrimeImplicants(on, dc, limit, primes)) {
+            out_stats.method = "qm";
+            out_stats.primes = primes.size();
+            std::vector<Cube> cover = selectCover(primes, on);
+            std::sort(cover.begin(), cover.end());
+            return cover;
+        }
+    }
+    out_stats.method = "espresso";
+    return minimizeEspresso(on, dc, out_stats.passes);
+}
+
+// a multiple output function given as on-set and don't-care set per output
+class TruthTable {
+    public:
+    int inputs = 0;
+    std::vector<std::string> inputNames, outputNames;
+    std::vector<MintermSet> on, dc;
+
+    TruthTable() { }
+    TruthTable(const std::vector<std::string>& _inputNames, const std::vector<std::string>& _outputNames) :
+        inputs(_inputNames.size()), inputNames(_inputNames), outputNames(_outputNames),
+        on(_outputNames.size(), MintermSet(inputs)), dc(_outputNames.size(), MintermSet(inputs)) { }
+
+    int outputs() const {
+        return outputNames.size();
+    }
+};
+
+// reads a berkeley pla truth table
+// - '.i n' and '.o m' give the numbers of inputs and outputs, '.ilb' and '.ob' their names
+// - each row is the inputs ('0', '1' or '-' for either) then the outputs: '1' puts the row's
+//   minterms in the on-set, '-' or '~' in the don't-care set, and '0' leaves them off
+// - minterms in no row are off, and a minterm both on and don't-care is on
+// returns false after writing the errors if not possible
+bool tryReadPla(std::istream& is, TruthTable& out_table, std::ostream& err) {
+    int inputs = -1, outputs = -1;
+    std::vector<std::string> inputNames, outputNames;
+    std::vector<std::pair<std::string, std::string>> rows;
+    std::string line;
+    int lineNumber = 0;
+    while(std::getline(is, line)) {
+        lineNumber++;
+        size_t comment = line.find('#');
+        if(comment != std::string::npos) {
+            line = line.substr(0, comment);
+        }
+        std::istringstream words(line);
+        std::string first;
+        if(!(words >> first)) {
+            continue;
+        }
+        if(first == ".i") {
+            words >> inputs;
+        } else if(first == ".o") {
+            words >> outputs;
+        } else if(first == ".ilb" || first == ".ob") {
+            std::string name;
+            while(words >> name) {
+                (first == ".ilb" ? inputNames : outputNames).push_back(name);
+            }
+        } else if(first == ".e" || first == ".end") {
+            break;
+        } else if(first[0] == '.') {
+            // .p, .type and the like aren't needed
+        } else {
+            std::string second;
+            words >> second;
+            rows.push_back(std::make_pair(first, second));
+            if(first.find_first_not_of("01-") != std::string::npos || second.find_first_not_of("01-~") != std::string::npos
+                || (inputs >= 0 && (int)first.size() != inputs) || (outputs >= 0 && (int)second.size() != outputs)) {
+                err << "Error: line " << lineNumber << ": malformed row '" << line << "'" << std::endl;
+                return false;
+            }
+        }
+    }
+    if(inputs < 0 && !rows.empty()) {
+        inputs = rows[0].first.size();
+    }
+    if(outputs < 0 && !rows.empty()) {
+        outputs = rows[0].second.size();
+    }
+    if(inputs < 1 || inputs > MAX_INPUTS || outputs < 1) {
+        err << "Error: a table needs 1 to " << MAX_INPUTS << " inputs and an output" << std::endl;
+        return false;
+    }
+    for(int i = inputNames.size(); i < inputs; i++) {
+        inputNames.push_back("in" + std::to_string(i));
+    }
+    for(int i = outputNames.size(); i < outputs; i++) {
+        outputNames.push_back("out" + std::to_string(i));
+    }
+    inputNames.resize(inputs);
+    outputNames.resize(outputs);
+    out_table = TruthTable(inputNames, outputNames);
+    for(const auto& row : rows) {
+        if((int)row.first.size() != inputs || (int)row.second.size() != outputs) {
+            err << "Error: row '" << row.first << " " << row.second << "' doesn't match .i " << inputs << " .o " << outputs << std::endl;
+            return false;
+        }
+        Cube cube;
+        for(int i = 0; i < inputs; i++) {
+            uint32_t bit = 1u << (inputs - 1 - i);
+            if(row.first[i] != '-') {
+                cube.care |= bit;
+                cube.value |= row.first[i] == '1' ? bit : 0;
+            }
+        }
+        for(int o = 0; o < outputs; o++) {
+            if(row.second[o] == '1') {
+                out_table.on[o].add(cube);
+            } else if(row.second[o] == '-' || row.second[o] == '~') {
+                out_table.dc[o].add(cube);
+            }
+        }
+    }
+    for(int o = 0; o < outputs; o++) {
+        for(size_t i = 0; i < out_table.dc[o].words.size(); i++) {
+            out_table.dc[o].words[i] &= ~out_table.on[o].words[i];
+        }
+    }
+    return true;
+}
+
+// writes the truth table as pla, a row per minterm which is on or don't-care for some output
+void writeTablePla(std::ostream& os, const TruthTable& table) {
+    os << ".i " << table.inputs << "\n.o " << table.outputs() << "\n.ilb";
+    for(const auto& name : table.inputNames) {
+        os << " " << name;
+    }
+    os << "\n.ob";
+    for(const auto& name : table.outputNames) {
+        os << " " << name;
+    }
+    os << "\n";
+    MintermSet any(table.inputs);
+    for(int o = 0; o < table.outputs(); o++) {
+        any = any | table.on[o] | table.dc[o];
+    }
+    any.forEachMinterm(Cube(), [&](uint32_t m) {
+        std::string outputs;
+        for(int o = 0; o < table.outputs(); o++) {
+            outputs += table.on[o].test(m) ? '1' : table.dc[o].test(m) ? '-' : '0';
+        }
+        os << Cube::minterm(table.inputs, m).text(table.inputs) << " " << outputs << "\n";
+    });
+    os << ".e\n";
+}
+
+// writes a cover per output as pla, with a row per distinct cube giving the outputs it is in
+void writeCoverPla(std::ostream& os, const TruthTable& table, const std::vector<std::vector<Cube>>& covers) {
+    std::vector<Cube> cubes;
+    for(const auto& cover : covers) {
+        cubes.insert(cubes.end(), cover.begin(), cover.end());
+    }
+    std::sort(cubes.begin(), cubes.end());
+    cubes.erase(std::unique(cubes.begin(), cubes.end()), cubes.end());
+    os << ".i " << table.inputs << "\n.o " << table.outputs() << "\n.ilb";
+    for(const auto& name : table.inputNames) {
+        os << " " << name;
+    }
+    os << "\n.ob";
+    for(const auto& name : table.outputNames) {
+        os << " " << name;
+    }
+    os << "\n.p " << cubes.size() << "\n";
+    for(const auto& cube : cubes) {
+        std::string outputs;
+        for(const auto& cover : covers) {
+            outputs += std::find(cover.begin(), cover.end(), cube) != cover.end() ? '1' : '0';
+        }
+        os << cube.text(table.inputs) << " " << outputs << "\n";
+    }
+    os << ".e\n";
+}
+
+// the cover as a c expression of the inputs, e.g. 'a & ~b | c', '0' if empty or '1' if always on
+std::string coverExpression(const std::vector<Cube>& cover, const std::vector<std::string>& inputNames) {
+    if(cover.empty()) {
+        return "0";
+    }
+    int inputs = inputNames.size();
+    std::string expression;
+    for(const auto& cube : cover) {
+        if(cube.care == 0) {
+            return "1";
+        }
+        std::string term;
+        for(int i = 0; i < inputs; i++) {
+            uint32_t bit = 1u << (inputs - 1 - i);
+            if(cube.care & bit) {
+                term += (term.empty() ? "" : " & ") + std::string(cube.value & bit ? "" : "~") + inputNames[i];
+            }
+        }
+        expression += (expression.empty() ? "" : " | ") + term;
+    }
+    return expression;
+}
+
+// writes a line 'name = expression;' per output
+void writeCoverEquations(std::ostream& os, const TruthTable& table, const std::vector<std::vector<Cube>>& covers) {
+    for(int o = 0; o < table.outputs(); o++) {
+        os << table.outputNames[o] << " = " << coverExpression(covers[o], table.inputNames) << ";\n";
+    }
+}
+
+#endif // MINIMIZER_H
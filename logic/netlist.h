@@ -0,0 +1,483 @@
+/*
+    a gate-level netlist, simulated 64 vectors at a time
+
+    each wire is a uint64_t with a bit per lane, so one pass over the gates evaluates 64 independent
+    copies of the circuit; the gates are kept levelized (ordered by their depth from the inputs), so a
+    single pass in order settles all of the combinational logic
+    - inputs: wires set from outside, the flip-flops' outputs and primary inputs like reset
+    - gates: and, or, xor, nor and not, which are folded when an input is constant and shared when
+      the same gate is asked for twice
+    - read ports: an address bus in, a data bus out, looked up in each lane's own memory
+    - write ports: an address, data and enable, written to each lane's memory at the clock
+    - flip-flops: a d wire copied to its q input at the clock
+    buses are vectors of wires, least significant bit first
+*/
+
+#ifndef NETLIST_H
+#define NETLIST_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <map>
+#include <tuple>
+#include <iostream>
+#include <algorithm>
+#include "../common.h"
+
+enum GateKind {
+    gate_and,
+    gate_or,
+    gate_xor,
+    gate_nor,
+    gate_not,
+    gate_read   // the data of a read port, b being the port
+};
+
+const std::vector<std::string> GATE_NAMES = { "and", "or", "xor", "nor", "not", "read" };
+
+typedef std::vector<int> Bus;
+
+// the constant wires
+const int WIRE_0 = 0;
+const int WIRE_1 = 1;
+
+class Gate {
+    public:
+    GateKind kind = gate_and;
+    int a = 0, b = 0;
+    int out = 0;
+    int level = 0;
+};
+
+class ReadPort {
+    public:
+    Bus address;
+    Bus data;
+};
+
+class WritePort {
+    public:
+    Bus address;
+    Bus data;
+    int enable = WIRE_0;
+};
+
+class Netlist {
+    public:
+    int wires = 2;
+    std::vector<Gate> gates;
+    std::vector<ReadPort> readPorts;
+    std::vector<WritePort> writePorts;
+    // pairs of d and q wires
+    std::vector<std::pair<int, int>> flops;
+    // the level of each wire, 0 for inputs and constants
+    std::vector<int> levels = { 0, 0 };
+    // buses named for probing and the netlist listing
+    std::map<std::string, Bus> names;
+    // the ranges of gates of one kind and level, once levelized
+    std::vector<std::pair<size_t, size_t>> runs;
+
+    int input() {
+        levels.push_back(0);
+        return wires++;
+    }
+
+    Bus inputBus(int width) {
+        Bus bus;
+        for(int i = 0; i < width; i++) {
+            bus.push_back(input());
+        }
+        return bus;
+    }
+
+    Bus constant(int value, int width) {
+        Bus bus;
+        for(int i = 0; i < width; i++) {
+            bus.push_back((value >> i) & 1 ? WIRE_1 : WIRE_0);
+        }
+        return bus;
+    }
+
+    int notOf(int a) {
+        if(a == WIRE_0 || a == WIRE_1) {
+            return a == WIRE_0 ? WIRE_1 : WIRE_0;
+        }
+        return gate(gate_not, a, a);
+    }
+
+    int andOf(int a, int b) {
+        if(a == WIRE_0 || b == WIRE_0) {
+            return WIRE_0;
+        }
+        if(a == WIRE_1 || a == b) {
+            return b;
+        }
+        return b == WIRE_1 ? a : gate(gate_and, std::min(a, b), std::max(a, b));
+    }
+
+    int orOf(int a, int b) {
+        if(a == WIRE_1 || b == WIRE_1) {
+            return WIRE_1;
+        }
+        if(a == WIRE_0 || a == b) {
+            return b;
+        }
+        return b == WIRE_0 ? a : gate(gate_or, std::min(a, b), std::max(a, b));
+    }
+
+    int xorOf(int a, int b) {
+        if(a == WIRE_0 || b == WIRE_0) {
+            return a == WIRE_0 ? b : a;
+        }
+        if(a == WIRE_1 || b == WIRE_1) {
+            return notOf(a == WIRE_1 ? b : a);
+        }
+        return a == b ? WIRE_0 : gate(gate_xor, std::min(a, b), std::max(a, b));
+    }
+
+    int norOf(int a, int b) {
+        if(a == WIRE_0 || b == WIRE_0 || a == WIRE_1 || b == WIRE_1) {
+            return notOf(orOf(a, b));
+        }
+        return gate(gate_nor, std::min(a, b), std::max(a, b));
+    }
+
+    // select ? a : b
+    int mux(int select, int a, int b) {
+        if(a == b) {
+            return a;
+        }
+        return orOf(andOf(select, a), andOf(notOf(select), b));
+    }
+
+    Bus muxBus(int select, const Bus& a, const Bus& b) {
+        Bus bus;
+        for(size_t i = 0; i < a.size(); i++) {
+            bus.push_back(mux(select, a[i], b[i]));
+        }
+        return bus;
+    }
+
+    // the OR of each bus ANDed with its select, for selects of which at most one is on
+    Bus selectBus(const std::vector<std::pair<int, Bus>>& choices, int width) {
+        Bus bus = constant(0, width);
+        for(const auto& choice : choices) {
+            for(int i = 0; i < width; i++) {
+                bus[i] = orOf(bus[i], andOf(choice.first, choice.second[i]));
+            }
+        }
+        return bus;
+    }
+
+    // a ripple carry adder, wrapping at the width of a
+    Bus add(const Bus& a, const Bus& b, int carryIn = WIRE_0) {
+        Bus sum;
+        int carry = carryIn;
+        for(size_t i = 0; i < a.size(); i++) {
+            int half = xorOf(a[i], b[i]);
+            sum.push_back(xorOf(half, carry));
+            carry = orOf(andOf(a[i], b[i]), andOf(half, carry));
+        }
+        return sum;
+    }
+
+    // the OR of every wire of the bus, as a balanced tree
+    int orReduce(Bus bus) {
+        while(bus.size() > 1) {
+            Bus next;
+            for(size_t i = 0; i + 1 < bus.size(); i += 2) {
+                next.push_back(orOf(bus[i], bus[i + 1]));
+            }
+            if(bus.size() % 2) {
+                next.push_back(bus.back());
+            }
+            bus.swap(next);
+        }
+        return bus.empty() ? WIRE_0 : bus[0];
+    }
+
+    // returns 1 if the bus equals the value
+    int equals(const Bus& bus, int value) {
+        Bus bits;
+        for(size_t i = 0; i < bus.size(); i++) {
+            bits.push_back((value >> i) & 1 ? notOf(bus[i]) : bus[i]);
+        }
+        return notOf(orReduce(bits));
+    }
+
+    Bus read(const Bus& address, int width) {
+        ReadPort port;
+        port.address = address;
+        int level = 0;
+        for(int wire : address) {
+            level = std::max(level, levels[wire]);
+        }
+        for(int i = 0; i < width; i++) {
+            Gate g;
+            g.kind = gate_read;
+            g.a = i;
+            g.b = readPorts.size();
+            g.out = wires++;
+            g.level = level + 1;
+            levels.push_back(g.level);
+            gates.push_back(g);
+            port.data.push_back(g.out);
+        }
+        readPorts.push_back(port);
+        return readPorts.back().data;
+    }
+
+    void write(const Bus& address, const Bus& data, int enable) {
+        WritePort port;
+        port.address = address;
+        port.data = data;
+        port.enable = enable;
+        writePorts.push_back(port);
+    }
+
+    // a register of flip-flops, returning their outputs; its next value is set with setNext
+    Bus registerBus(const std::string& name, int width) {
+        Bus q = inputBus(width);
+        names[name] = q;
+        return q;
+    }
+
+    void setNext(const Bus& q, const Bus& d) {
+        for(size_t i = 0; i < q.size(); i++) {
+            flops.push_back(std::make_pair(d[i], q[i]));
+        }
+    }
+
+    // orders the gates by level, so that each is evaluated after its inputs, and within a level by
+    // kind, so that the simulator runs through each kind's gates in one loop
+    void levelize() {
+        std::stable_sort(gates.begin(), gates.end(), [](const Gate& x, const Gate& y) {
+            return x.level != y.level ? x.level < y.level : x.kind < y.kind;
+        });
+        runs.clear();
+        for(size_t i = 0; i < gates.size(); i++) {
+            if(runs.empty() || gates[runs.back().first].kind != gates[i].kind || gates[runs.back().first].level != gates[i].level) {
+                runs.push_back(std::make_pair(i, i));
+            }
+            runs.back().second = i + 1;
+        }
+    }
+
+    int depth() const {
+        int result = 0;
+        for(const auto& g : gates) {
+            result = std::max(result, g.level);
+        }
+        return result;
+    }
+
+    // the number of gates of each kind
+    std::map<std::string, int> gateCounts() const {
+        std::map<std::string, int> counts;
+        for(const auto& g : gates) {
+            counts[GATE_NAMES[g.kind]]++;
+        }
+        return counts;
+    }
+
+    // writes a line per gate, 'level out = kind a b', then the ports, flip-flops and named buses
+    void writeListing(std::ostream& os) const {
+        for(const auto& g : gates) {
+            if(g.kind == gate_read) {
+                os << g.level << " w" << g.out << " = read port" << g.b << " bit" << g.a << "\n";
+            } else {
+                os << g.level << " w" << g.out << " = " << GATE_NAMES[g.kind] << " w" << g.a << (g.kind != gate_not ? " w" + std::to_string(g.b) : "") << "\n";
+            }
+        }
+        auto busText = [](const Bus& bus) {
+            std::string text;
+            for(auto wire = bus.rbegin(); wire != bus.rend(); ++wire) {
+                text += " w" + std::to_string(*wire);
+            }
+            return text;
+        };
+        for(size_t p = 0; p < readPorts.size(); p++) {
+            os << "read port" << p << " address" << busText(readPorts[p].address) << "\n";
+        }
+        for(const auto& port : writePorts) {
+            os << "write enable w" << port.enable << " address" << busText(port.address) << " data" << busText(port.data) << "\n";
+        }
+        for(const auto& flop : flops) {
+            os << "flop w" << flop.second << " <- w" << flop.first << "\n";
+        }
+        for(const auto& name : names) {
+            os << "bus " << name.first << busText(name.second) << "\n";
+        }
+    }
+
+    private:
+    // gates by their kind and inputs, so that the same gate is made once
+    std::map<std::tuple<int, int, int>, int> made;
+
+    int gate(GateKind kind, int a, int b) {
+        auto key = std::make_tuple((int)kind, a, b);
+        auto found = made.find(key);
+        if(found != made.end()) {
+            return found->second;
+        }
+        Gate g;
+        g.kind = kind;
+        g.a = a;
+        g.b = b;
+        g.out = wires++;
+        g.level = std::max(levels[a], levels[b]) + 1;
+        levels.push_back(g.level);
+        gates.push_back(g);
+        made[key] = g.out;
+        return g.out;
+    }
+};
+
+const int LANES = 64;
+
+// transposes a matrix of 8x8 bits, byte i bit j becoming byte j bit i
+inline uint64_t transpose8(uint64_t x) {
+    uint64_t t = (x ^ (x >> 7)) & 0x00AA00AA00AA00AAull;
+    x ^= t ^ (t << 7);
+    t = (x ^ (x >> 14)) & 0x0000CCCC0000CCCCull;
+    x ^= t ^ (t << 14);
+    t = (x ^ (x >> 28)) & 0x00000000F0F0F0F0ull;
+    return x ^ t ^ (t << 28);
+}
+
+// swaps the bytes of a and b picked out by the mask shifted by k bytes, a step of transposeBytes
+inline void swapBytes(uint64_t& a, uint64_t& b, int k, uint64_t mask) {
+    uint64_t t = ((a >> (8 * k)) ^ b) & mask;
+    b ^= t;
+    a ^= t << (8 * k);
+}
+
+// transposes a matrix of 8x8 bytes, byte j of word i becoming byte i of word j
+inline void transposeBytes(uint64_t* w) {
+    const uint64_t m1 = 0x00FF00FF00FF00FFull, m2 = 0x0000FFFF0000FFFFull, m4 = 0x00000000FFFFFFFFull;
+    swapBytes(w[0], w[1], 1, m1); swapBytes(w[2], w[3], 1, m1); swapBytes(w[4], w[5], 1, m1); swapBytes(w[6], w[7], 1, m1);
+    swapBytes(w[0], w[2], 2, m2); swapBytes(w[1], w[3], 2, m2); swapBytes(w[4], w[6], 2, m2); swapBytes(w[5], w[7], 2, m2);
+    swapBytes(w[0], w[4], 4, m4); swapBytes(w[1], w[5], 4, m4); swapBytes(w[2], w[6], 4, m4); swapBytes(w[3], w[7], 4, m4);
+}
+
+// the wires of a netlist and a memory per lane
+// memory is interleaved, a byte of each lane per address, so lanes reading the same address (as
+// when they run one program on different inputs) read the same cache line
+class NetlistSim {
+    public:
+    const Netlist& net;
+    std::vector<uint64_t> wires;
+    std::vector<unsigned char> memory;
+
+    NetlistSim(const Netlist& _net) : net(_net), wires(_net.wires, 0), memory((size_t)LANES * IMAGE_SIZE, 0) {
+        wires[WIRE_1] = ~0ull;
+    }
+
+    unsigned char& at(int lane, int address) {
+        return memory[(size_t)address * LANES + lane];
+    }
+
+    // the value of a bus in a lane
+    int get(const Bus& bus, int lane) const {
+        int value = 0;
+        for(size_t i = 0; i < bus.size(); i++) {
+            value |= ((wires[bus[i]] >> lane) & 1) << i;
+        }
+        return value;
+    }
+
+    // the value of a bus in every lane: 8 wires at a time, the 8x8 bytes of their words transposed
+    // into a word per 8 lanes, and each of those transposed into a byte per lane
+    void gather(const Bus& bus, int* out_values) const {
+        for(size_t low = 0; low < bus.size(); low += 8) {
+            uint64_t words[8] = { };
+            for(size_t i = 0; i < 8 && low + i < bus.size(); i++) {
+                words[i] = wires[bus[low + i]];
+            }
+            transposeBytes(words);
+            for(int group = 0; group < LANES / 8; group++) {
+                uint64_t columns = transpose8(words[group]);
+                for(int j = 0; j < 8; j++) {
+                    int bits = (int)((columns >> (j * 8)) & 0xFF) << low;
+                    out_values[group * 8 + j] = low == 0 ? bits : out_values[group * 8 + j] | bits;
+                }
+            }
+        }
+    }
+
+    // settles the combinational logic from the inputs, a run of gates of one kind at a time
+    void evaluate() {
+        uint64_t* w = wires.data();
+        const Gate* gates = net.gates.data();
+        for(const auto& run : net.runs) {
+            const Gate* begin = gates + run.first;
+            const Gate* end = gates + run.second;
+            switch(begin->kind) {
+                case gate_and: { for(const Gate* g = begin; g != end; ++g) { w[g->out] = w[g->a] & w[g->b]; } break; }
+                case gate_or: { for(const Gate* g = begin; g != end; ++g) { w[g->out] = w[g->a] | w[g->b]; } break; }
+                case gate_xor: { for(const Gate* g = begin; g != end; ++g) { w[g->out] = w[g->a] ^ w[g->b]; } break; }
+                case gate_nor: { for(const Gate* g = begin; g != end; ++g) { w[g->out] = ~(w[g->a] | w[g->b]); } break; }
+                case gate_not: { for(const Gate* g = begin; g != end; ++g) { w[g->out] = ~w[g->a]; } break; }
+                case gate_read: {
+                    // a port is read at its first data bit, the rest of its bits coming from portBits
+                    int lastPort = -1;
+                    for(const Gate* g = begin; g != end; ++g) {
+                        if(g->b != lastPort) {
+                            readPort(net.readPorts[g->b]);
+                            lastPort = g->b;
+                        }
+                        w[g->out] = portBits[g->a];
+                    }
+                    break;
+                }
+            }
+        }
+    }
+
+    // writes memory and loads each flip-flop from its d wire
+    void clock() {
+        for(const auto& port : net.writePorts) {
+            uint64_t enabled = wires[port.enable];
+            if(enabled == 0) {
+                continue;
+            }
+            gather(port.address, addresses);
+            gather(port.data, values);
+            while(enabled) {
+                int lane = __builtin_ctzll(enabled);
+                at(lane, addresses[lane]) = values[lane];
+                enabled &= enabled - 1;
+            }
+        }
+        next.resize(net.flops.size());
+        for(size_t i = 0; i < net.flops.size(); i++) {
+            next[i] = wires[net.flops[i].first];
+        }
+        for(size_t i = 0; i < net.flops.size(); i++) {
+            wires[net.flops[i].second] = next[i];
+        }
+    }
+
+    private:
+    int addresses[LANES];
+    int values[LANES];
+    uint64_t portBits[8];
+    std::vector<uint64_t> next;
+
+    // looks up each lane's byte at its address, transposing the bytes into a word per data bit
+    void readPort(const ReadPort& port) {
+        gather(port.address, addresses);
+        for(int group = 0; group < LANES / 8; group++) {
+            uint64_t rows = 0;
+            for(int j = 0; j < 8; j++) {
+                int lane = group * 8 + j;
+                rows |= (uint64_t)memory[(size_t)addresses[lane] * LANES + lane] << (j * 8);
+            }
+            portBits[group] = transpose8(rows);
+        }
+        transposeBytes(portBits);
+    }
+};
+
+#endif // NETLIST_H
@@ -3,20 +3,86 @@
     adds hex line number and hex bytecode to beginning
     of each line with binary byte code
     (all other lines are assumed to be comments and will be preserved)
+
+    with '-j threads' the input is mapped into memory and converted in parallel chunks
+    (see mac2lineMac.h), straight into the mapped output file
 */ 
 
 #include <iostream>
 #include <fstream>
 #include <string>
+#include <vector>
+#include <thread>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 #include "../common.h"
+#include "mac2lineMac.h"
+
+// converts the input file with the given number of threads
+// returns false after writing an error if not possible
+bool convertParallel(const std::string& inFileName, const std::string& outFileName, int threadCount) {
+    int inFd = open(inFileName.c_str(), O_RDONLY);
+    if(inFd < 0) {
+        std::cerr << "Error: could not open " << inFileName << std::endl;
+        return false;
+    }
+    struct stat inStat;
+    fstat(inFd, &inStat);
+    size_t inSize = inStat.st_size;
+    const char* in = nullptr;
+    if(inSize > 0) {
+        in = static_cast<const char*>(mmap(nullptr, inSize, PROT_READ, MAP_PRIVATE, inFd, 0));
+        if(in == MAP_FAILED) {
+            std::cerr << "Error: could not map " << inFileName << std::endl;
+            close(inFd);
+            return false;
+        }
+    }
+
+    std::vector<Chunk> chunks = splitChunks(in, inSize, threadCount);
+    size_t outSize = countChunks(in, chunks);
+
+    int outFd = open(outFileName.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if(outFd < 0 || ftruncate(outFd, outSize) != 0) {
+        std::cerr << "Error: could not open " << outFileName << std::endl;
+        return false;
+    }
+    if(outSize > 0) {
+        char* out = static_cast<char*>(mmap(nullptr, outSize, PROT_READ | PROT_WRITE, MAP_SHARED, outFd, 0));
+        if(out == MAP_FAILED) {
+            std::cerr << "Error: could not map " << outFileName << std::endl;
+            return false;
+        }
+        formatChunks(in, out, chunks);
+        munmap(out, outSize);
+    }
+    close(outFd);
+    if(in != nullptr) {
+        munmap(const_cast<char*>(in), inSize);
+    }
+    close(inFd);
+    return true;
+}
 
 int main(int argc, char** argv) {
     std::string line, binaryString, inFileName, outFileName;
     if(!tryParseIOFileNames(argc, argv, inFileName, outFileName)) {
-        std::cerr << "Usage: " << argv[0] << " -i infile -o outfile" << std::endl;
+        std::cerr << "Usage: " << argv[0] << " -i infile -o outfile [-j threads]" << std::endl;
         return 1;
     }
 
+    std::string threadString;
+    if(tryParseArg(argc, argv, "-j", threadString)) {
+        int threadCount = std::stoi(threadString);
+        if(threadCount <= 0) {
+            threadCount = std::max(1u, std::thread::hardware_concurrency());
+        }
+        return convertParallel(inFileName, outFileName, threadCount) ? 0 : 1;
+    }
+
     std::ifstream inFile;
     inFile.open(inFileName);
     if(!inFile.is_open()) {
@@ -0,0 +1,168 @@
+#ifndef MAC2LINEMAC_H
+#define MAC2LINEMAC_H
+
+/*
+    adds hex line number and hex bytecode to beginning
+    of each line with binary byte code
+    (all other lines are assumed to be comments and will be preserved)
+
+    the input is split into chunks: the binary lines of each chunk are counted in parallel,
+    a prefix sum gives each chunk its first line number and output offset, and the chunks
+    are then formatted in parallel straight into the output
+*/
+
+#include <string>
+#include <vector>
+#include <thread>
+#include <functional>
+#include <cstring>
+#include "../common.h"
+
+// the chars added before each binary line: 'XXXX HH '
+const size_t PREFIX_SIZE = 8;
+
+// hex digits for each byte value
+class HexTable {
+    public:
+    char digits[256][2];
+    HexTable() {
+        for(int b = 0; b < 256; b++) {
+            digits[b][0] = part2Hex(b >> 4);
+            digits[b][1] = part2Hex(b);
+        }
+    }
+};
+
+// returns true if the line starts with 8 binary digits, filling the byte value
+inline bool tryParseBinaryByte(const char* line, size_t length, int& out_byte) {
+    if(length < 8) {
+        return false;
+    }
+    int value = 0;
+    for(int i = 0; i < 8; i++) {
+        if(line[i] != '0' && line[i] != '1') {
+            return false;
+        }
+        value = (value << 1) | (line[i] - '0');
+    }
+    out_byte = value;
+    return true;
+}
+
+// a part of the input, split at a line boundary
+class Chunk {
+    public:
+    size_t begin = 0;
+    size_t end = 0;
+    // the number of binary lines in the chunk
+    size_t binaryLines = 0;
+    // the number of output bytes of the chunk
+    size_t outSize = 0;
+    // the line number of the first binary line, and the offset of the chunk in the output
+    size_t firstLineNum = 0;
+    size_t outOffset = 0;
+};
+
+// counts the binary lines and output size of a chunk
+void countChunk(const char* in, Chunk& chunk) {
+    size_t pos = chunk.begin;
+    int byte;
+    while(pos < chunk.end) {
+        const char* newline = static_cast<const char*>(std::memchr(in + pos, '\n', chunk.end - pos));
+        size_t lineEnd = newline != nullptr ? newline - in : chunk.end;
+        if(tryParseBinaryByte(in + pos, lineEnd - pos, byte)) {
+            ++chunk.binaryLines;
+            chunk.outSize += PREFIX_SIZE;
+        }
+        // every line is written with a '\n', even the last one
+        chunk.outSize += lineEnd - pos + 1;
+        pos = lineEnd + 1;
+    }
+}
+
+// formats a chunk into its place in the output
+void formatChunk(const char* in, char* out, const Chunk& chunk, const HexTable& hex) {
+    size_t pos = chunk.begin;
+    char* o = out + chunk.outOffset;
+    size_t lineNum = chunk.firstLineNum;
+    int byte;
+    while(pos < chunk.end) {
+        const char* newline = static_cast<const char*>(std::memchr(in + pos, '\n', chunk.end - pos));
+        size_t lineEnd = newline != nullptr ? newline - in : chunk.end;
+        if(tryParseBinaryByte(in + pos, lineEnd - pos, byte)) {
+            // the line number is written as 4 hex digits, like twoBytes2hex
+            std::memcpy(o, hex.digits[(lineNum >> 8) & 0xFF], 2);
+            std::memcpy(o + 2, hex.digits[lineNum & 0xFF], 2);
+            o[4] = ' ';
+            std::memcpy(o + 5, hex.digits[byte], 2);
+            o[7] = ' ';
+            o += PREFIX_SIZE;
+            ++lineNum;
+        }
+        std::memcpy(o, in + pos, lineEnd - pos);
+        o += lineEnd - pos;
+        *o++ = '\n';
+        pos = lineEnd + 1;
+    }
+}
+
+// splits the input into a chunk for each thread, at line boundaries
+std::vector<Chunk> splitChunks(const char* in, size_t inSize, int threadCount) {
+    std::vector<Chunk> chunks(threadCount);
+    size_t pos = 0;
+    for(int t = 0; t < threadCount; t++) {
+        chunks[t].begin = pos;
+        size_t end = t == threadCount - 1 ? inSize : std::max(pos, inSize * (t + 1) / threadCount);
+        if(end < inSize) {
+            const char* newline = static_cast<const char*>(std::memchr(in + end, '\n', inSize - end));
+            end = newline != nullptr ? newline - in + 1 : inSize;
+        }
+        chunks[t].end = end;
+        pos = end;
+    }
+    return chunks;
+}
+
+// counts every chunk in parallel, and gives each its first line number and output offset
+// returns the size of the output
+size_t countChunks(const char* in, std::vector<Chunk>& chunks) {
+    std::vector<std::thread> threads;
+    for(auto& chunk : chunks) {
+        threads.push_back(std::thread(countChunk, in, std::ref(chunk)));
+    }
+    for(auto& thread : threads) {
+        thread.join();
+    }
+
+    size_t lineNum = 0, outSize = 0;
+    for(auto& chunk : chunks) {
+        chunk.firstLineNum = lineNum;
+        chunk.outOffset = outSize;
+        lineNum += chunk.binaryLines;
+        outSize += chunk.outSize;
+    }
+    return outSize;
+}
+
+// formats every chunk in parallel into out, which must hold the size returned by countChunks
+void formatChunks(const char* in, char* out, const std::vector<Chunk>& chunks) {
+    HexTable hex;
+    std::vector<std::thread> threads;
+    for(const auto& chunk : chunks) {
+        threads.push_back(std::thread(formatChunk, in, out, std::cref(chunk), std::cref(hex)));
+    }
+    for(auto& thread : threads) {
+        thread.join();
+    }
+}
+
+// converts text which is already in memory, replacing the contents of out
+void lineMac(const char* in, size_t inSize, std::vector<char>& out, int threadCount = 1) {
+    std::vector<Chunk> chunks = splitChunks(in, inSize, threadCount);
+    out.resize(countChunks(in, chunks));
+    if(!out.empty()) {
+        formatChunks(in, out.data(), chunks);
+    }
+}
+
+#endif // MAC2LINEMAC_H
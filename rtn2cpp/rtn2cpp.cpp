@@ -0,0 +1,45 @@
+/*
+    generates the interpreter's step functions from the abstract RTN
+
+    usage: rtn2cpp.exe -i ../docs/abstractRTN.md -o ../ssbc-interpreter/rtnStep.h
+*/
+
+#include <string>
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include "rtn2cpp.h"
+
+int main(int argc, char** argv) {
+    std::string inFileName, outFileName;
+    if(!tryParseIOFileNames(argc, argv, inFileName, outFileName)) {
+        std::cerr << "Usage: " << argv[0] << " -i abstractRTN.md -o rtnStep.h" << std::endl;
+        return 1;
+    }
+    std::ifstream inFile(inFileName);
+    if(!inFile.is_open()) {
+        std::cerr << "Error: could not open " << inFileName << std::endl;
+        return 1;
+    }
+    std::stringstream document;
+    document << inFile.rdbuf();
+
+    Rtn rtn;
+    if(!tryReadRtn(document.str(), rtn, std::cerr)) {
+        return 1;
+    }
+    // generated in full before the output is opened, so a bad RTN leaves the last header alone
+    std::ostringstream header;
+    RtnGenerator generator(rtn, std::cerr);
+    std::string sourceName = inFileName.substr(inFileName.find_last_of('/') + 1);
+    if(!generator.generate(header, "docs/" + sourceName)) {
+        return 1;
+    }
+    std::ofstream outFile(outFileName);
+    if(!outFile.is_open()) {
+        std::cerr << "Error: could not open " << outFileName << std::endl;
+        return 1;
+    }
+    outFile << header.str();
+    return 0;
+}
@@ -0,0 +1,1757 @@
+/*
+    rtn2cpp as a library: reads the abstract RTN of docs/abstractRTN.md and generates the
+    interpreter's step functions from it
+
+    the document gives
+    - the registers, in the Processor State table (a width from '<15..0>' or '1-bit', a 'Signal'
+      being an input rather than state), and the memory, 'MEM[0..2^16-1]<7..0>'
+    - definitions, 'name<hi..lo> := ...', which are substituted as text: expressions (opcode, ii,
+      s1, PSW) and procedures (Set_fault, Ins_exe and Ins_interpretation, the machine)
+    - registers mapped to memory: 'PSW mapped to 0xFFFB' with 'PSW := Z#N#6@0' keeps Z and N in
+      bits 7 and 6 of that byte
+    the notation, loosest first: ':' separates parallel actions, ';' sequential steps, and
+    'condition -> ...' guards the rest of its sequence; 'a <- b' is a register transfer
+    - each sequential step is a clock cycle, a guard whose condition is false still taking its step
+    - the actions of a parallel step read their operands before any of them write, each location
+      once however many of them use it, and registers kept in one byte of memory are written at once
+    - a call of ins_exe counts an instruction, and a call of ins_interpretation (looping back to
+      the next instruction) takes no step
+
+    the generated header has, for a machine with a member per register named in capitals, and
+    memory accessed through m.fetch(a) (a read at PC's address), m.read(a) and m.write(a, v):
+    - rtnReset(m): the Reset branch of Ins_interpretation
+    - rtnStep(m): one instruction with its steps collapsed into straight-line code per opcode, the
+      cycles of each path added at once; returns false if the machine is halted or faulted
+    - rtnMicroStep(m): one clock cycle, m.phase being the step to run, 0 at the start of an
+      instruction; returns false without a cycle if the machine is halted or faulted
+*/
+
+#ifndef RTN2CPP_H
+#define RTN2CPP_H
+
+#include <string>
+#include <sstream>
+#include <map>
+#include <vector>
+#include <memory>
+#include <iostream>
+#include <algorithm>
+#include <tuple>
+#include "../common.h"
+
+/*
+    tokens
+*/
+
+enum RtnTokenType {
+    rtnToken_identifier,
+    rtnToken_number,
+    rtnToken_symbol,
+    rtnToken_end
+};
+
+class RtnToken {
+    public:
+    RtnTokenType type = rtnToken_end;
+    std::string text;
+    int value = 0;
+    int line = 0;
+};
+
+// the symbols of the notation, longest first so that the longest match is taken
+const std::vector<std::string> RTN_SYMBOLS = {
+    "<-", "->", ":=", "<=", ">=", "..",
+    "<", ">", "=", "+", "-", "#", "@", "(", ")", "[", "]", ":", ";"
+};
+
+// returns the identifier in lower case, as names in the RTN aren't case sensitive
+std::string lowerCase(std::string text) {
+    std::transform(text.begin(), text.end(), text.begin(), [](char c) { return std::tolower(c); });
+    return text;
+}
+
+// splits RTN text into tokens, the '\' markdown escapes of '\(' and '\)' being skipped
+// returns false after writing an error if not possible
+bool tryTokenizeRtn(const std::string& text, int line, std::vector<RtnToken>& out_tokens, std::ostream& err) {
+    out_tokens.clear();
+    size_t i = 0;
+    while(i < text.size()) {
+        char c = text[i];
+        if(c == '\n') {
+            ++line;
+            ++i;
+            continue;
+        }
+        if(std::isspace(c) || c == '\\') {
+            ++i;
+            continue;
+        }
+        RtnToken token;
+        token.line = line;
+        if(std::isalpha(c) || c == '_') {
+            token.type = rtnToken_identifier;
+            while(i < text.size() && (std::isalnum(text[i]) || text[i] == '_')) {
+                token.text.push_back(text[i++]);
+            }
+        } else if(std::isdigit(c)) {
+            token.type = rtnToken_number;
+            int base = text.compare(i, 2, "0x") == 0 || text.compare(i, 2, "0X") == 0 ? 16 : 10;
+            if(base == 16) {
+                token.text = text.substr(i, 2);
+                i += 2;
+            }
+            while(i < text.size() && std::isxdigit(text[i]) && (base == 16 || std::isdigit(text[i]))) {
+                token.value = token.value * base + (std::isdigit(text[i]) ? text[i] - '0' : std::tolower(text[i]) - 'a' + 10);
+                token.text.push_back(text[i++]);
+            }
+        } else {
+            token.type = rtnToken_symbol;
+            for(const auto& symbol : RTN_SYMBOLS) {
+                if(text.compare(i, symbol.size(), symbol) == 0) {
+                    token.text = symbol;
+                    break;
+                }
+            }
+            if(token.text.empty()) {
+                err << "Error on line [" << line << "]: unexpected '" << c << "'" << std::endl;
+                return false;
+            }
+            i += token.text.size();
+        }
+        out_tokens.push_back(token);
+    }
+    RtnToken end;
+    end.line = line;
+    out_tokens.push_back(end);
+    return true;
+}
+
+/*
+    the syntax tree
+*/
+
+enum RtnExprKind {
+    rtnExpr_number,
+    rtnExpr_name,       // a register, signal or expression definition
+    rtnExpr_memory,     // MEM[address]
+    rtnExpr_bits,       // name<high..low>
+    rtnExpr_concat,     // a#b, the first operand highest
+    rtnExpr_repeat,     // count@bit
+    rtnExpr_unary,      // NOT a, -a
+    rtnExpr_binary,     // a+b, a-b, a OR b, a AND b, a NOR b
+    rtnExpr_compare,    // a = b, or a chain like 0 <= a <= 10
+    rtnExpr_reduce      // name<high> OR .. OR name<low>
+};
+
+class RtnExpr {
+    public:
+    RtnExprKind kind = rtnExpr_number;
+    // the operator, in upper case, or each operator of a compare chain
+    std::string op;
+    std::vector<std::string> ops;
+    int value = 0;
+    std::string name;
+    int high = 0, low = 0;
+    std::vector<std::shared_ptr<RtnExpr>> args;
+};
+
+typedef std::shared_ptr<RtnExpr> RtnExprPtr;
+
+enum RtnNodeKind {
+    rtnNode_sequence,   // a; b
+    rtnNode_parallel,   // a: b
+    rtnNode_guard,      // condition -> body
+    rtnNode_transfer,   // target <- value
+    rtnNode_call        // a procedure's name
+};
+
+class RtnNode {
+    public:
+    RtnNodeKind kind = rtnNode_sequence;
+    std::vector<std::shared_ptr<RtnNode>> items;
+    RtnExprPtr condition, target, value;
+    std::shared_ptr<RtnNode> body;
+    // the procedure called, or the label of a guard like 'Pushimm (:= opcode=2)'
+    std::string name;
+};
+
+typedef std::shared_ptr<RtnNode> RtnNodePtr;
+
+RtnExprPtr rtnNumber(int value) {
+    RtnExprPtr expr = std::make_shared<RtnExpr>();
+    expr->value = value;
+    return expr;
+}
+
+class RtnRegister {
+    public:
+    std::string name;
+    int width = 0;
+    // an input like Reset, which isn't part of the machine's state
+    bool isSignal = false;
+    // the address and bit of a register kept in memory, or -1
+    int address = -1;
+    int bit = 0;
+
+    // the machine's member holding the register
+    std::string member() const {
+        std::string result = name;
+        std::transform(result.begin(), result.end(), result.begin(), [](char c) { return std::toupper(c); });
+        return result;
+    }
+};
+
+class RtnDefinition {
+    public:
+    std::string name;
+    // the declared width, or 0
+    int width = 0;
+    std::string text;
+    int line = 0;
+};
+
+// a byte of memory holding registers, and the constant value of its other bits
+class RtnMappedByte {
+    public:
+    int registerMask = 0;
+    int constantBits = 0;
+};
+
+class Rtn {
+    public:
+    // by the name in lower case
+    std::map<std::string, RtnRegister> registers;
+    std::map<std::string, RtnDefinition> definitions;
+    std::map<int, RtnMappedByte> mappedBytes;
+    int addressBits = 0;
+    int dataBits = 0;
+
+    const RtnRegister* findRegister(const std::string& name) const {
+        auto found = registers.find(lowerCase(name));
+        return found != registers.end() ? &found->second : nullptr;
+    }
+
+    const RtnDefinition* findDefinition(const std::string& name) const {
+        auto found = definitions.find(lowerCase(name));
+        return found != definitions.end() ? &found->second : nullptr;
+    }
+};
+
+/*
+    parsing
+*/
+
+class RtnParser {
+    public:
+    RtnParser(const std::vector<RtnToken>& _tokens, std::ostream& _err) : tokens(_tokens), err(_err) { }
+
+    // parses the tokens as parallel actions, returning null after writing an error if not possible
+    RtnNodePtr parseStatement() {
+        RtnNodePtr node = parseParallel();
+        if(ok && peek().type != rtnToken_end) {
+            error("unexpected '" + peek().text + "'");
+        }
+        return ok ? node : nullptr;
+    }
+
+    // parses the tokens as an expression, a trailing ':' or ';' being allowed
+    RtnExprPtr parseExpression() {
+        RtnExprPtr expr = parseOr();
+        while(tryAccept(":") || tryAccept(";")) { }
+        if(ok && peek().type != rtnToken_end) {
+            error("unexpected '" + peek().text + "'");
+        }
+        return ok ? expr : nullptr;
+    }
+
+    private:
+    const std::vector<RtnToken>& tokens;
+    std::ostream& err;
+    size_t pos = 0;
+    bool ok = true;
+
+    const RtnToken& peek(int ahead = 0) {
+        return tokens[std::min(pos + ahead, tokens.size() - 1)];
+    }
+
+    const RtnToken& next() {
+        const RtnToken& token = peek();
+        if(pos < tokens.size() - 1) {
+            ++pos;
+        }
+        return token;
+    }
+
+    // returns true if the token ahead is the symbol or (in any case) keyword
+    bool isNext(const std::string& text, int ahead = 0) {
+        const RtnToken& token = peek(ahead);
+        return (token.type == rtnToken_symbol && token.text == text) || (token.type == rtnToken_identifier && lowerCase(token.text) == lowerCase(text));
+    }
+
+    bool tryAccept(const std::string& text) {
+        if(isNext(text)) {
+            next();
+            return true;
+        }
+        return false;
+    }
+
+    void error(const std::string& message) {
+        if(ok) {
+            err << "Error on line [" << peek().line << "]: " << message << std::endl;
+        }
+        ok = false;
+    }
+
+    bool expect(const std::string& text) {
+        if(tryAccept(text)) {
+            return true;
+        }
+        error("expected '" + text + "', found '" + peek().text + "'");
+        return false;
+    }
+
+    // returns true if the separator (or the end) is next, ending a step
+    bool isStepEnd() {
+        return isNext(":") || isNext(";") || isNext(")") || peek().type == rtnToken_end;
+    }
+
+    // the label of a named condition at a token, e.g. 'Noop' of 'Noop (:= opcode=0) -> ...'
+    std::string labelAt(size_t at) {
+        return at + 2 < tokens.size() && tokens[at].type == rtnToken_identifier && tokens[at + 1].text == "(" && tokens[at + 2].text == ":="
+            ? tokens[at].text : "";
+    }
+
+    // a: b: c, with a trailing ':' allowed
+    RtnNodePtr parseParallel() {
+        RtnNodePtr node = std::make_shared<RtnNode>();
+        node->kind = rtnNode_parallel;
+        while(ok && !isNext(")") && peek().type != rtnToken_end) {
+            node->items.push_back(parseSequence());
+            if(!tryAccept(":")) {
+                break;
+            }
+        }
+        return node->items.size() == 1 ? node->items[0] : node;
+    }
+
+    // a; b; c, with a trailing ';' allowed; a guard takes the rest of its sequence
+    RtnNodePtr parseSequence() {
+        RtnNodePtr node = std::make_shared<RtnNode>();
+        node->kind = rtnNode_sequence;
+        while(ok && !isNext(":") && !isNext(")") && peek().type != rtnToken_end) {
+            if(isGuardOrTransferNext()) {
+                size_t start = pos;
+                RtnExprPtr left = parseOr();
+                if(tryAccept("->")) {
+                    RtnNodePtr guard = std::make_shared<RtnNode>();
+                    guard->kind = rtnNode_guard;
+                    guard->condition = left;
+                    guard->name = labelAt(start);
+                    guard->body = parseSequence();
+                    node->items.push_back(guard);
+                    break;
+                }
+                expect("<-");
+                RtnNodePtr transfer = std::make_shared<RtnNode>();
+                transfer->kind = rtnNode_transfer;
+                transfer->target = left;
+                transfer->value = parseOr();
+                if(left->kind != rtnExpr_name && left->kind != rtnExpr_memory) {
+                    error("can only transfer to a register or memory");
+                }
+                node->items.push_back(transfer);
+            } else if(tryAccept("(")) {
+                node->items.push_back(parseParallel());
+                expect(")");
+            } else if(peek().type == rtnToken_identifier) {
+                RtnNodePtr call = std::make_shared<RtnNode>();
+                call->kind = rtnNode_call;
+                call->name = next().text;
+                node->items.push_back(call);
+            } else {
+                error("unexpected '" + peek().text + "'");
+            }
+            if(ok && !isStepEnd()) {
+                error("unexpected '" + peek().text + "'");
+            }
+            if(!tryAccept(";")) {
+                break;
+            }
+        }
+        return node->items.size() == 1 ? node->items[0] : node;
+    }
+
+    // returns true if a '->' or '<-' comes before the end of the step, so it starts with an expression
+    bool isGuardOrTransferNext() {
+        int depth = 0;
+        for(int ahead = 0; peek(ahead).type != rtnToken_end; ahead++) {
+            if(isNext("(", ahead) || isNext("[", ahead)) {
+                depth++;
+            } else if(isNext(")", ahead) || isNext("]", ahead)) {
+                if(--depth < 0) {
+                    return false;
+                }
+            } else if(depth == 0 && (isNext("->", ahead) || isNext("<-", ahead))) {
+                return true;
+            } else if(depth == 0 && (isNext(":", ahead) || isNext(";", ahead))) {
+                return false;
+            }
+        }
+        return false;
+    }
+
+    RtnExprPtr binary(const std::string& op, RtnExprPtr left, RtnExprPtr right) {
+        RtnExprPtr expr = std::make_shared<RtnExpr>();
+        expr->kind = rtnExpr_binary;
+        expr->op = op;
+        expr->args = { left, right };
+        return expr;
+    }
+
+    // returns true if the operand is a single bit of a register, filling its name and bit
+    static bool isSingleBit(const RtnExprPtr& expr, std::string& out_name, int& out_high, int& out_low) {
+        if(expr->kind == rtnExpr_bits || expr->kind == rtnExpr_reduce) {
+            out_name = lowerCase(expr->name);
+            out_high = expr->high;
+            out_low = expr->low;
+            return expr->kind == rtnExpr_reduce || expr->high == expr->low;
+        }
+        return false;
+    }
+
+    // a OR b NOR c, where 'x<7> OR x<6> .. OR x<0>' is the OR of bits 7 to 0 of x
+    RtnExprPtr parseOr() {
+        std::vector<RtnExprPtr> operands = { parseAnd() };
+        std::vector<std::string> ops;
+        while(ok) {
+            if(tryAccept("..")) {
+                expect("OR");
+                RtnExprPtr last = parseAnd();
+                std::string name, lastName;
+                int high, low, lastHigh, lastLow;
+                if(!isSingleBit(operands.back(), name, high, low) || !isSingleBit(last, lastName, lastHigh, lastLow) || name != lastName) {
+                    error("'..' needs bits of one register on either side");
+                    return nullptr;
+                }
+                RtnExprPtr reduce = std::make_shared<RtnExpr>();
+                reduce->kind = rtnExpr_reduce;
+                reduce->name = operands.back()->name;
+                reduce->high = high;
+                reduce->low = lastLow;
+                operands.back() = reduce;
+            } else if(isNext("OR") || isNext("NOR")) {
+                ops.push_back(next().text);
+                operands.push_back(parseAnd());
+            } else {
+                break;
+            }
+        }
+        if(!ok) {
+            return nullptr;
+        }
+        // merges runs of bits of one register, e.g. x<7> OR (x<6> .. OR x<0>)
+        RtnExprPtr result = operands[0];
+        for(size_t i = 0; i < ops.size(); i++) {
+            std::string name, nextName;
+            int high, low, nextHigh, nextLow;
+            if(lowerCase(ops[i]) == "or" && isSingleBit(result, name, high, low) && isSingleBit(operands[i + 1], nextName, nextHigh, nextLow)
+                && name == nextName && nextHigh == low - 1) {
+                RtnExprPtr reduce = std::make_shared<RtnExpr>();
+                reduce->kind = rtnExpr_reduce;
+                reduce->name = result->name;
+                reduce->high = high;
+                reduce->low = nextLow;
+                result = reduce;
+            } else {
+                std::string op = ops[i];
+                std::transform(op.begin(), op.end(), op.begin(), [](char c) { return std::toupper(c); });
+                result = binary(op, result, operands[i + 1]);
+            }
+        }
+        return result;
+    }
+
+    RtnExprPtr parseAnd() {
+        RtnExprPtr left = parseNot();
+        while(ok && tryAccept("AND")) {
+            left = binary("AND", left, parseNot());
+        }
+        return left;
+    }
+
+    RtnExprPtr parseNot() {
+        if(tryAccept("NOT")) {
+            RtnExprPtr expr = std::make_shared<RtnExpr>();
+            expr->kind = rtnExpr_unary;
+            expr->op = "NOT";
+            expr->args = { parseNot() };
+            return expr;
+        }
+        return parseCompare();
+    }
+
+    // a = b, or a chain like 0 <= a <= 10
+    RtnExprPtr parseCompare() {
+        RtnExprPtr first = parseConcat();
+        if(!(isNext("=") || isNext("<") || isNext(">") || isNext("<=") || isNext(">="))) {
+            return first;
+        }
+        RtnExprPtr expr = std::make_shared<RtnExpr>();
+        expr->kind = rtnExpr_compare;
+        expr->args.push_back(first);
+        while(ok && (isNext("=") || isNext("<") || isNext(">") || isNext("<=") || isNext(">="))) {
+            expr->ops.push_back(next().text);
+            expr->args.push_back(parseConcat());
+        }
+        return expr;
+    }
+
+    RtnExprPtr parseConcat() {
+        RtnExprPtr first = parseAdd();
+        if(!isNext("#")) {
+            return first;
+        }
+        RtnExprPtr expr = std::make_shared<RtnExpr>();
+        expr->kind = rtnExpr_concat;
+        expr->args.push_back(first);
+        while(ok && tryAccept("#")) {
+            expr->args.push_back(parseAdd());
+        }
+        return expr;
+    }
+
+    RtnExprPtr parseAdd() {
+        RtnExprPtr left = parseUnary();
+        while(ok && (isNext("+") || isNext("-"))) {
+            std::string op = next().text;
+            left = binary(op, left, parseUnary());
+        }
+        return left;
+    }
+
+    RtnExprPtr parseUnary() {
+        if(tryAccept("-")) {
+            RtnExprPtr expr = std::make_shared<RtnExpr>();
+            expr->kind = rtnExpr_unary;
+            expr->op = "-";
+            expr->args = { parseUnary() };
+            return expr;
+        }
+        return parsePrimary();
+    }
+
+    // returns true if '<n>' or '<n..m>' is next
+    bool isBitsNext() {
+        return isNext("<") && peek(1).type == rtnToken_number
+            && (isNext(">", 2) || (isNext("..", 2) && peek(3).type == rtnToken_number && isNext(">", 4)));
+    }
+
+    RtnExprPtr parsePrimary() {
+        RtnExprPtr expr = std::make_shared<RtnExpr>();
+        if(peek().type == rtnToken_number) {
+            expr->value = next().value;
+            if(tryAccept("@")) {
+                if(peek().type != rtnToken_number) {
+                    error("expected a bit after '@'");
+                    return expr;
+                }
+                expr->kind = rtnExpr_repeat;
+                expr->high = expr->value;
+                expr->value = next().value;
+            }
+            return expr;
+        }
+        if(tryAccept("(")) {
+            expr = parseOr();
+            expect(")");
+            return expr;
+        }
+        if(peek().type != rtnToken_identifier) {
+            error("expected an operand, found '" + peek().text + "'");
+            return expr;
+        }
+        std::string name = next().text;
+        if(lowerCase(name) == "mem" && tryAccept("[")) {
+            expr->kind = rtnExpr_memory;
+            expr->args = { parseOr() };
+            expect("]");
+            return expr;
+        }
+        // a named condition, e.g. 'Noop (:= opcode=0)'
+        if(isNext("(") && isNext(":=", 1)) {
+            next();
+            next();
+            expr = parseOr();
+            expect(")");
+            return expr;
+        }
+        expr->kind = rtnExpr_name;
+        expr->name = name;
+        if(isBitsNext()) {
+            next();
+            expr->kind = rtnExpr_bits;
+            expr->high = expr->low = next().value;
+            if(tryAccept("..")) {
+                expr->low = next().value;
+            }
+            next();
+        }
+        return expr;
+    }
+
+};
+
+// reads the registers, memory, definitions and memory mapped registers of the RTN document
+// returns false after writing an error if not possible
+bool tryReadRtn(const std::string& document, Rtn& out_rtn, std::ostream& err) {
+    std::vector<std::string> lines;
+    std::istringstream stream(document);
+    std::string line;
+    while(std::getline(stream, line)) {
+        lines.push_back(line);
+    }
+    auto trim = [](const std::string& text) {
+        size_t begin = text.find_first_not_of(" \t\r");
+        size_t end = text.find_last_not_of(" \t\r");
+        return begin == std::string::npos ? std::string() : text.substr(begin, end - begin + 1);
+    };
+    // parses '<hi..lo>' at the start of text, filling the width
+    auto tryParseRange = [](const std::string& text, int& out_width) {
+        int high, low;
+        if(std::sscanf(text.c_str(), "<%d..%d>", &high, &low) == 2) {
+            out_width = high - low + 1;
+            return true;
+        }
+        return false;
+    };
+    std::vector<std::pair<std::string, int>> mappings;
+    for(size_t i = 0; i < lines.size(); i++) {
+        std::string text = trim(lines[i]);
+        // a row of the Processor State table, e.g. '| PC<15..0>: | Program Counter |'
+        if(text.size() > 1 && text[0] == '|') {
+            size_t bar = text.find('|', 1);
+            std::string cell = trim(text.substr(1, bar - 1));
+            std::string description = bar != std::string::npos ? text.substr(bar) : "";
+            size_t colon = cell.find(':');
+            size_t nameEnd = 0;
+            while(nameEnd < cell.size() && (std::isalnum(cell[nameEnd]) || cell[nameEnd] == '_')) {
+                nameEnd++;
+            }
+            if(colon == std::string::npos || nameEnd == 0) {
+                continue;
+            }
+            RtnRegister reg;
+            reg.name = cell.substr(0, nameEnd);
+            if(!tryParseRange(cell.substr(nameEnd), reg.width)) {
+                reg.width = (cell + description).find("1-bit") != std::string::npos ? 1 : 0;
+            }
+            reg.isSignal = description.find("Signal") != std::string::npos;
+            if(reg.width == 0 && !reg.isSignal) {
+                err << "Error on line [" << i + 1 << "]: no width for " << reg.name << std::endl;
+                return false;
+            }
+            reg.width = std::max(reg.width, 1);
+            // 'Ri<7..0>: Register i (0 <= i <= 3)' is R0 to R3
+            int count;
+            size_t range = description.find("(0 <= i <= ");
+            if(reg.name.back() == 'i' && range != std::string::npos && std::sscanf(description.c_str() + range, "(0 <= i <= %d)", &count) == 1) {
+                std::string prefix = reg.name.substr(0, reg.name.size() - 1);
+                for(int k = 0; k <= count; k++) {
+                    reg.name = prefix + std::to_string(k);
+                    out_rtn.registers[lowerCase(reg.name)] = reg;
+                }
+            } else {
+                out_rtn.registers[lowerCase(reg.name)] = reg;
+            }
+            continue;
+        }
+        if(text.compare(0, 2, "- ") == 0) {
+            text = trim(text.substr(2));
+        }
+        // the memory, 'MEM[0..2^16-1]<7..0>'
+        if(text.compare(0, 9, "MEM[0..2^") == 0) {
+            if(std::sscanf(text.c_str(), "MEM[0..2^%d-1]", &out_rtn.addressBits) != 1
+                || !tryParseRange(text.substr(text.find(']') + 1), out_rtn.dataBits)) {
+                err << "Error on line [" << i + 1 << "]: malformed memory" << std::endl;
+                return false;
+            }
+            continue;
+        }
+        // 'PSW mapped to 0xFFFB'
+        size_t mapped = text.find(" mapped to ");
+        if(mapped != std::string::npos && text.find(' ') == mapped) {
+            mappings.push_back(std::make_pair(text.substr(0, mapped), (int)std::strtol(text.c_str() + mapped + 11, nullptr, 16)));
+            continue;
+        }
+        // a definition, 'name<hi..lo> := ...', running over lines until its parentheses balance
+        size_t define = text.find(":=");
+        size_t nameEnd = 0;
+        while(nameEnd < text.size() && (std::isalnum(text[nameEnd]) || text[nameEnd] == '_')) {
+            nameEnd++;
+        }
+        if(define == std::string::npos || nameEnd == 0 || std::isdigit(text[0])) {
+            continue;
+        }
+        RtnDefinition definition;
+        definition.name = text.substr(0, nameEnd);
+        definition.line = i + 1;
+        std::string between = trim(text.substr(nameEnd, define - nameEnd));
+        if(between != "" && !tryParseRange(between, definition.width)) {
+            continue;
+        }
+        definition.text = text.substr(define + 2);
+        int depth = 0;
+        for(size_t j = i; j < lines.size(); j++) {
+            if(j > i) {
+                definition.text += "\n" + lines[j];
+            }
+            const std::string& part = j > i ? lines[j] : definition.text;
+            depth += std::count(part.begin(), part.end(), '(') - std::count(part.begin(), part.end(), ')');
+            if(depth <= 0) {
+                i = j;
+                break;
+            }
+        }
+        out_rtn.definitions[lowerCase(definition.name)] = definition;
+    }
+
+    if(out_rtn.addressBits == 0 || out_rtn.registers.empty() || out_rtn.findDefinition("ins_interpretation") == nullptr) {
+        err << "Error: the RTN needs its registers, its memory and Ins_interpretation" << std::endl;
+        return false;
+    }
+    // registers within a memory mapped definition, e.g. Z and N within PSW := Z#N#6@0
+    for(const auto& mapping : mappings) {
+        const RtnDefinition* definition = out_rtn.findDefinition(mapping.first);
+        if(definition == nullptr) {
+            continue;
+        }
+        std::vector<RtnToken> tokens;
+        if(!tryTokenizeRtn(definition->text, definition->line, tokens, err)) {
+            return false;
+        }
+        RtnParser parser(tokens, err);
+        RtnExprPtr expr = parser.parseExpression();
+        if(expr == nullptr) {
+            return false;
+        }
+        std::vector<RtnExprPtr> parts = expr->kind == rtnExpr_concat ? expr->args : std::vector<RtnExprPtr>{ expr };
+        RtnMappedByte& mappedByte = out_rtn.mappedBytes[mapping.second];
+        int bit = out_rtn.dataBits;
+        for(const auto& part : parts) {
+            if(part->kind == rtnExpr_name && out_rtn.findRegister(part->name) != nullptr) {
+                RtnRegister& reg = out_rtn.registers[lowerCase(part->name)];
+                bit -= reg.width;
+                reg.address = mapping.second;
+                reg.bit = bit;
+                mappedByte.registerMask |= ((1 << reg.width) - 1) << bit;
+            } else if(part->kind == rtnExpr_repeat) {
+                bit -= part->high;
+                mappedByte.constantBits |= part->value ? ((1 << part->high) - 1) << bit : 0;
+            } else {
+                err << "Error on line [" << definition->line << "]: " << mapping.first << " must be registers and constant bits" << std::endl;
+                return false;
+            }
+        }
+        if(bit != 0) {
+            err << "Error on line [" << definition->line << "]: " << mapping.first << " is not " << out_rtn.dataBits << " bits" << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+/*
+    code generation
+*/
+
+// returns a number as C++, in hex past 9
+std::string cppNumber(int value) {
+    if(value < 10) {
+        return std::to_string(value);
+    }
+    std::ostringstream text;
+    text << "0x" << std::uppercase << std::hex << value;
+    return text.str();
+}
+
+// an expression as C++, its value always within its width
+class CppValue {
+    public:
+    std::string code;
+    int width = 0;
+    bool isConstant = false;
+    int value = 0;
+};
+
+class RtnGenerator {
+    public:
+    RtnGenerator(const Rtn& _rtn, std::ostream& _err) : rtn(_rtn), err(_err) { }
+
+    // writes the generated header, returns false after writing an error if not possible
+    bool generate(std::ostream& os, const std::string& sourceName) {
+        RtnNodePtr machine = procedure("ins_interpretation");
+        if(machine == nullptr) {
+            return false;
+        }
+        RtnNodePtr resetBranch = fold(machine, { { "reset", 1 } });
+        RtnNodePtr runBranch = fold(machine, { { "reset", 0 } });
+        for(const auto& reg : rtn.registers) {
+            if(reg.second.isSignal && reg.first != "reset") {
+                err << "Error: only the Reset signal is known, not " << reg.second.name << std::endl;
+                return false;
+            }
+        }
+
+        os << "/*\n"
+           << "    generated by rtn2cpp from " << sourceName << ", do not edit\n"
+           << "    - rtnReset(m): the Reset branch of Ins_interpretation\n"
+           << "    - rtnStep(m): one instruction, its steps collapsed into straight-line code per opcode;\n"
+           << "      returns false if the machine is halted or faulted\n"
+           << "    - rtnMicroStep(m): one clock cycle, m.phase being the step to run, 0 at the start of an\n"
+           << "      instruction; returns false without a cycle if the machine is halted or faulted\n"
+           << "    memory is accessed through m.fetch(a) for the program at PC, m.read(a) and m.write(a, v)\n"
+           << "*/\n\n"
+           << "#ifndef RTNSTEP_H\n#define RTNSTEP_H\n\n";
+
+        body.str("");
+        temporaries = 0;
+        int pending = 0;
+        emitCollapsed(resetBranch, 1, pending);
+        if(!ok) {
+            return false;
+        }
+        os << "template<typename M>\nvoid rtnReset(M& m) {\n" << body.str() << "}\n\n";
+
+        body.str("");
+        temporaries = 0;
+        pending = 0;
+        emitChoice(alternatives(runBranch), 1, pending, "return false;");
+        if(!ok) {
+            return false;
+        }
+        os << "template<typename M>\nbool rtnStep(M& m) {\n" << body.str() << "    return !m." << memberOf("halt") << " && !m." << memberOf("fault") << ";\n}\n\n";
+
+        states.clear();
+        stateIds.clear();
+        temporaries = 0;
+        states.push_back(MicroState());
+        std::ostringstream start;
+        emitMicroChoice(alternatives(runBranch), 0, 3, "return false;", start);
+        states[0].comment = "the start of an instruction";
+        states[0].code = start.str();
+        if(!ok) {
+            return false;
+        }
+        os << "template<typename M>\nbool rtnMicroStep(M& m) {\n    switch(m.phase) {\n";
+        for(size_t s = 0; s < states.size(); s++) {
+            os << "        // " << states[s].comment << "\n        case " << s << ": {\n" << states[s].code << "            break;\n        }\n";
+        }
+        os << "    }\n    ++m.cycles;\n    return true;\n}\n\n#endif // RTNSTEP_H\n";
+        return true;
+    }
+
+    private:
+    const Rtn& rtn;
+    std::ostream& err;
+    bool ok = true;
+    std::map<std::string, RtnNodePtr> procedures;
+    std::map<std::string, RtnExprPtr> expressions;
+    std::ostringstream body;
+    int temporaries = 0;
+
+    // the memory reads of the step being written, by what is read: how many times each is made, and
+    // the temporary holding those made more than once, written to readOut at the first, so that the
+    // step reads each location once
+    std::map<std::string, int> readCounts;
+    std::map<std::string, std::string> readNames;
+    bool isCountingReads = false;
+    std::ostream* readOut = nullptr;
+    std::string readPad;
+
+    class MicroState {
+        public:
+        std::string comment;
+        std::string code;
+    };
+    std::vector<MicroState> states;
+    std::map<std::tuple<const RtnNode*, size_t, int>, int> stateIds;
+
+    void error(const std::string& message) {
+        if(ok) {
+            err << "Error: " << message << std::endl;
+        }
+        ok = false;
+    }
+
+    std::string memberOf(const std::string& name) {
+        const RtnRegister* reg = rtn.findRegister(name);
+        return reg != nullptr ? reg->member() : name;
+    }
+
+    // the parsed body of a procedure definition, or null after writing an error
+    RtnNodePtr procedure(const std::string& name) {
+        std::string key = lowerCase(name);
+        if(procedures.count(key) == 0) {
+            const RtnDefinition* definition = rtn.findDefinition(key);
+            if(definition == nullptr) {
+                error("nothing is defined as " + name);
+                return nullptr;
+            }
+            std::vector<RtnToken> tokens;
+            if(!tryTokenizeRtn(definition->text, definition->line, tokens, err)) {
+                ok = false;
+                return nullptr;
+            }
+            RtnParser parser(tokens, err);
+            RtnNodePtr node = parser.parseStatement();
+            if(node == nullptr) {
+                ok = false;
+                return nullptr;
+            }
+            procedures[key] = node;
+        }
+        return procedures[key];
+    }
+
+    // the parsed body of an expression definition, or null
+    RtnExprPtr expression(const std::string& name) {
+        std::string key = lowerCase(name);
+        if(expressions.count(key) == 0) {
+            const RtnDefinition* definition = rtn.findDefinition(key);
+            if(definition == nullptr) {
+                return nullptr;
+            }
+            std::vector<RtnToken> tokens;
+            if(!tryTokenizeRtn(definition->text, definition->line, tokens, err)) {
+                ok = false;
+                return nullptr;
+            }
+            RtnParser parser(tokens, err);
+            expressions[key] = parser.parseExpression();
+            if(expressions[key] == nullptr) {
+                ok = false;
+            }
+        }
+        return expressions[key];
+    }
+
+    /*
+        constant folding of the signals
+    */
+
+    RtnExprPtr foldExpr(const RtnExprPtr& expr, const std::map<std::string, int>& signals) {
+        if(expr->kind == rtnExpr_name && signals.count(lowerCase(expr->name)) != 0) {
+            return rtnNumber(signals.at(lowerCase(expr->name)));
+        }
+        if(expr->args.empty()) {
+            return expr;
+        }
+        RtnExprPtr result = std::make_shared<RtnExpr>(*expr);
+        bool isConstant = true;
+        for(auto& arg : result->args) {
+            arg = foldExpr(arg, signals);
+            isConstant &= arg->kind == rtnExpr_number;
+        }
+        if(!isConstant) {
+            // 'x AND 0' and 'x OR 1' don't depend on x
+            if(result->kind == rtnExpr_binary && (result->op == "AND" || result->op == "OR")) {
+                int absorbing = result->op == "AND" ? 0 : 1;
+                for(const auto& arg : result->args) {
+                    if(arg->kind == rtnExpr_number && arg->value == absorbing) {
+                        return rtnNumber(absorbing);
+                    }
+                }
+                for(size_t i = 0; i < 2; i++) {
+                    if(result->args[i]->kind == rtnExpr_number) {
+                        return result->args[1 - i];
+                    }
+                }
+            }
+            return result;
+        }
+        if(result->kind == rtnExpr_unary && result->op == "NOT") {
+            return rtnNumber(result->args[0]->value == 0 ? 1 : 0);
+        }
+        if(result->kind == rtnExpr_binary && result->op == "AND") {
+            return rtnNumber(result->args[0]->value & result->args[1]->value);
+        }
+        if(result->kind == rtnExpr_binary && result->op == "OR") {
+            return rtnNumber(result->args[0]->value | result->args[1]->value);
+        }
+        return result;
+    }
+
+    // the tree with the signals' values substituted and guards which can't be taken dropped
+    RtnNodePtr fold(const RtnNodePtr& node, const std::map<std::string, int>& signals) {
+        RtnNodePtr result = std::make_shared<RtnNode>(*node);
+        if(node->kind == rtnNode_guard) {
+            result->condition = foldExpr(node->condition, signals);
+            result->body = fold(node->body, signals);
+            if(result->condition->kind == rtnExpr_number) {
+                return result->condition->value != 0 ? result->body : nullptr;
+            }
+            return result;
+        }
+        if(node->kind == rtnNode_transfer) {
+            result->value = foldExpr(node->value, signals);
+            return result;
+        }
+        result->items.clear();
+        for(const auto& item : node->items) {
+            RtnNodePtr folded = fold(item, signals);
+            if(folded != nullptr) {
+                result->items.push_back(folded);
+            }
+        }
+        return result;
+    }
+
+    /*
+        expressions
+    */
+
+    static int maskOf(int width) {
+        return width >= 31 ? 0x7FFFFFFF : (1 << width) - 1;
+    }
+
+    CppValue constant(int value, int width) {
+        CppValue result;
+        result.width = width;
+        result.isConstant = true;
+        result.value = value & maskOf(width);
+        result.code = cppNumber(result.value);
+        return result;
+    }
+
+    // the value masked to a width, if it may not fit
+    CppValue masked(const std::string& code, int width) {
+        CppValue result;
+        result.code = "(" + (code.find(' ') == std::string::npos ? code : "(" + code + ")") + " & " + cppNumber(maskOf(width)) + ")";
+        result.width = width;
+        return result;
+    }
+
+    // a read of memory as C++, counted while the step's reads are counted, and bound to a
+    // temporary at its first use if the step makes it more than once
+    std::string memoryRead(const std::string& key, const std::string& code) {
+        if(isCountingReads) {
+            readCounts[key]++;
+            return code;
+        }
+        auto count = readCounts.find(key);
+        if(readOut == nullptr || count == readCounts.end() || count->second < 2) {
+            return code;
+        }
+        if(readNames.count(key) == 0) {
+            std::string name = "r" + std::to_string(temporaries++);
+            *readOut << readPad << "int " << name << " = " << code << ";\n";
+            readNames[key] = name;
+        }
+        return readNames[key];
+    }
+
+    CppValue readRegister(const RtnRegister& reg) {
+        CppValue result;
+        result.width = reg.width;
+        if(reg.isSignal) {
+            error("the " + reg.name + " signal can only be used in Ins_interpretation's guards");
+        } else if(reg.address >= 0) {
+            std::string byte = memoryRead("MEM[" + cppNumber(reg.address) + "]", "m.read(" + cppNumber(reg.address) + ")");
+            result.code = "((" + byte + " >> " + std::to_string(reg.bit) + ") & " + cppNumber(maskOf(reg.width)) + ")";
+        } else {
+            result.code = "m." + reg.member();
+        }
+        return result;
+    }
+
+    // whether a memory address is the program counter's, so that reading it fetches the program;
+    // the address of another read (like MEM[ext]) doesn't count, only the address itself
+    bool isFetch(const RtnExprPtr& expr) {
+        if(expr->kind == rtnExpr_memory) {
+            return false;
+        }
+        if(expr->kind == rtnExpr_name || expr->kind == rtnExpr_bits) {
+            const RtnRegister* reg = rtn.findRegister(expr->name);
+            if(reg != nullptr) {
+                return reg->name == "PC";
+            }
+            RtnExprPtr definition = expression(expr->name);
+            return definition != nullptr && isFetch(definition);
+        }
+        for(const auto& arg : expr->args) {
+            if(isFetch(arg)) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // the address of memory as C++, within the address width
+    std::string address(const RtnExprPtr& expr) {
+        CppValue value = cpp(expr);
+        return value.width > rtn.addressBits ? masked(value.code, rtn.addressBits).code : value.code;
+    }
+
+    CppValue cpp(const RtnExprPtr& expr) {
+        switch(expr->kind) {
+            case rtnExpr_number: {
+                int width = 1;
+                while(width < 31 && (expr->value >> width) != 0) {
+                    width++;
+                }
+                return constant(expr->value, width);
+            }
+            case rtnExpr_name: {
+                const RtnRegister* reg = rtn.findRegister(expr->name);
+                if(reg != nullptr) {
+                    return readRegister(*reg);
+                }
+                RtnExprPtr definition = expression(expr->name);
+                if(definition == nullptr) {
+                    error("nothing is defined as " + expr->name);
+                    return CppValue();
+                }
+                CppValue value = cpp(definition);
+                const RtnDefinition* declared = rtn.findDefinition(expr->name);
+                if(declared->width > 0 && declared->width < value.width) {
+                    return masked(value.code, declared->width);
+                }
+                return value;
+            }
+            case rtnExpr_memory: {
+                CppValue result;
+                result.code = memoryRead(describe(expr), (isFetch(expr->args[0]) ? "m.fetch(" : "m.read(") + address(expr->args[0]) + ")");
+                result.width = rtn.dataBits;
+                return result;
+            }
+            case rtnExpr_bits: {
+                RtnExprPtr whole = std::make_shared<RtnExpr>(*expr);
+                whole->kind = rtnExpr_name;
+                CppValue value = cpp(whole);
+                int width = expr->high - expr->low + 1;
+                if(expr->low == 0 && width >= value.width) {
+                    return value;
+                }
+                std::string shifted = expr->low == 0 ? value.code : value.code + " >> " + std::to_string(expr->low);
+                return masked(shifted, width);
+            }
+            case rtnExpr_reduce: {
+                RtnExprPtr whole = std::make_shared<RtnExpr>(*expr);
+                whole->kind = rtnExpr_name;
+                CppValue value = cpp(whole);
+                CppValue result;
+                result.width = 1;
+                if(expr->low == 0 && expr->high + 1 >= value.width) {
+                    result.code = "(" + value.code + " != 0)";
+                } else {
+                    result.code = "(((" + value.code + " >> " + std::to_string(expr->low) + ") & "
+                        + cppNumber(maskOf(expr->high - expr->low + 1)) + ") != 0)";
+                }
+                return result;
+            }
+            case rtnExpr_repeat: {
+                return constant(expr->value ? maskOf(expr->high) : 0, expr->high);
+            }
+            case rtnExpr_concat: {
+                std::string code;
+                int width = 0;
+                for(auto arg = expr->args.rbegin(); arg != expr->args.rend(); ++arg) {
+                    CppValue part = cpp(*arg);
+                    if(!(part.isConstant && part.value == 0)) {
+                        std::string shifted = width == 0 ? part.code : "(" + part.code + " << " + std::to_string(width) + ")";
+                        code = code.empty() ? shifted : shifted + " | " + code;
+                    }
+                    width += part.width;
+                }
+                CppValue result;
+                result.code = code.empty() ? "0" : "(" + code + ")";
+                result.width = width;
+                return result;
+            }
+            case rtnExpr_unary: {
+                CppValue value = cpp(expr->args[0]);
+                if(expr->op == "NOT" && value.width == 1) {
+                    CppValue result;
+                    result.code = "!" + value.code;
+                    result.width = 1;
+                    return result;
+                }
+                return masked((expr->op == "NOT" ? "~" : "-") + value.code, value.width);
+            }
+            case rtnExpr_binary: {
+                CppValue left = cpp(expr->args[0]), right = cpp(expr->args[1]);
+                int width = std::max(left.width, right.width);
+                if(expr->op == "+" || expr->op == "-") {
+                    // a sum within a wider value (e.g. an address) is masked by its user
+                    return masked(left.code + " " + expr->op + " " + right.code, width);
+                }
+                std::string op = expr->op == "AND" ? "&" : "|";
+                if(width == 1 && expr->op != "NOR") {
+                    CppValue result;
+                    result.code = "(" + left.code + (op == "&" ? " && " : " || ") + right.code + ")";
+                    result.width = 1;
+                    return result;
+                }
+                std::string code = "(" + left.code + " " + op + " " + right.code + ")";
+                if(expr->op == "NOR") {
+                    return masked("~" + code, width);
+                }
+                CppValue result;
+                result.code = code;
+                result.width = width;
+                return result;
+            }
+            case rtnExpr_compare: {
+                std::string code;
+                for(size_t i = 0; i < expr->ops.size(); i++) {
+                    CppValue left = cpp(expr->args[i]), right = cpp(expr->args[i + 1]);
+                    // 0 <= x is always true of the unsigned values here
+                    if(expr->ops[i] == "<=" && left.isConstant && left.value == 0) {
+                        continue;
+                    }
+                    std::string op = expr->ops[i] == "=" ? "==" : expr->ops[i];
+                    code += (code.empty() ? "" : " && ") + left.code + " " + op + " " + right.code;
+                }
+                CppValue result;
+                result.code = "(" + (code.empty() ? "1" : code) + ")";
+                result.width = 1;
+                return result;
+            }
+        }
+        return CppValue();
+    }
+
+    /*
+        statements
+    */
+
+    // the number of steps the longest path through the node takes
+    int stepsOf(const RtnNodePtr& node) {
+        switch(node->kind) {
+            case rtnNode_transfer: {
+                return 1;
+            }
+            case rtnNode_guard: {
+                return std::max(1, stepsOf(node->body));
+            }
+            case rtnNode_call: {
+                if(lowerCase(node->name) == "ins_interpretation") {
+                    return 0;
+                }
+                RtnNodePtr called = procedure(node->name);
+                return called != nullptr ? stepsOf(called) : 0;
+            }
+            case rtnNode_sequence: {
+                int steps = 0;
+                for(const auto& item : node->items) {
+                    steps += stepsOf(item);
+                }
+                return steps;
+            }
+            case rtnNode_parallel: {
+                int steps = 0;
+                for(const auto& item : node->items) {
+                    steps = std::max(steps, stepsOf(item));
+                }
+                return steps;
+            }
+        }
+        return 0;
+    }
+
+    // a transfer within a parallel step, and the guards it is under
+    class Action {
+        public:
+        std::vector<RtnExprPtr> conditions;
+        RtnNodePtr transfer;
+        // the procedure which is called, if not a transfer
+        std::string call;
+    };
+
+    // collects the actions of a single step
+    void collectActions(const RtnNodePtr& node, std::vector<RtnExprPtr> conditions, std::vector<Action>& out_actions) {
+        switch(node->kind) {
+            case rtnNode_transfer: {
+                Action action;
+                action.conditions = conditions;
+                action.transfer = node;
+                out_actions.push_back(action);
+                break;
+            }
+            case rtnNode_guard: {
+                conditions.push_back(node->condition);
+                collectActions(node->body, conditions, out_actions);
+                break;
+            }
+            case rtnNode_call: {
+                if(lowerCase(node->name) == "ins_exe") {
+                    Action action;
+                    action.conditions = conditions;
+                    action.call = node->name;
+                    out_actions.push_back(action);
+                } else if(lowerCase(node->name) != "ins_interpretation") {
+                    RtnNodePtr called = procedure(node->name);
+                    if(called != nullptr) {
+                        collectActions(called, conditions, out_actions);
+                    }
+                }
+                break;
+            }
+            case rtnNode_sequence:
+            case rtnNode_parallel: {
+                for(const auto& item : node->items) {
+                    collectActions(item, conditions, out_actions);
+                }
+                break;
+            }
+        }
+    }
+
+    // the code writing a value to a register or memory, the value already within its width
+    std::string write(const RtnExprPtr& target, const std::string& addressCode, const CppValue& value) {
+        if(target->kind == rtnExpr_memory) {
+            std::string code = value.width > rtn.dataBits ? masked(value.code, rtn.dataBits).code : value.code;
+            return "m.write(" + addressCode + ", " + code + ");";
+        }
+        const RtnRegister* reg = rtn.findRegister(target->name);
+        if(reg == nullptr || reg->isSignal) {
+            error("can't transfer to " + target->name);
+            return "";
+        }
+        if(reg->address >= 0) {
+            return writeMapped(reg->address, { { reg, value } });
+        }
+        std::string code = value.width > reg->width ? masked(value.code, reg->width).code : value.code;
+        return "m." + reg->member() + " = " + code + ";";
+    }
+
+    // the code writing registers kept in one byte of memory at once, the value of each already
+    // within its width
+    std::string writeMapped(int address, const std::vector<std::pair<const RtnRegister*, CppValue>>& values) {
+        // the other registers in the byte keep their bits, and the rest are constant
+        const RtnMappedByte& mappedByte = rtn.mappedBytes.at(address);
+        int keep = mappedByte.registerMask;
+        std::string result;
+        for(const auto& value : values) {
+            const RtnRegister* reg = value.first;
+            std::string code = value.second.width > reg->width ? masked(value.second.code, reg->width).code : value.second.code;
+            keep &= ~(maskOf(reg->width) << reg->bit);
+            result += (result.empty() ? "" : " | ") + ("(" + code + " << " + std::to_string(reg->bit) + ")");
+        }
+        if(keep != 0) {
+            // read straight from MEM, as the access is the write
+            result = "(m.MEM[" + cppNumber(address) + "] & " + cppNumber(keep) + ") | " + result;
+        }
+        if(mappedByte.constantBits != 0) {
+            result += " | " + cppNumber(mappedByte.constantBits);
+        }
+        return "m.write(" + cppNumber(address) + ", " + result + ");";
+    }
+
+    // the byte of memory a transfer writes a register kept in, or -1
+    int mappedAddressOf(const RtnNodePtr& transfer) {
+        if(transfer == nullptr || transfer->target->kind == rtnExpr_memory) {
+            return -1;
+        }
+        const RtnRegister* reg = rtn.findRegister(transfer->target->name);
+        return reg != nullptr && !reg->isSignal ? reg->address : -1;
+    }
+
+    // counts the memory reads of a step's guards, addresses and values, for memoryRead
+    void countReads(const std::vector<Action>& actions) {
+        readCounts.clear();
+        readNames.clear();
+        isCountingReads = true;
+        for(const auto& action : actions) {
+            for(const auto& expr : action.conditions) {
+                cpp(expr);
+            }
+            if(action.transfer) {
+                if(action.transfer->target->kind == rtnExpr_memory) {
+                    address(action.transfer->target->args[0]);
+                }
+                cpp(action.transfer->value);
+            }
+        }
+        isCountingReads = false;
+    }
+
+    // writes the code of a single step: each guard and operand is read before anything is written,
+    // each location and value once, and registers kept in the same byte of memory are written at once
+    void emitActions(std::vector<Action> actions, int indent, std::ostream& os) {
+        std::string pad(indent * 4, ' ');
+        // a transfer of a register to itself, like noop's PC <- PC, only takes its step
+        actions.erase(std::remove_if(actions.begin(), actions.end(), [](const Action& action) {
+            return action.transfer && action.transfer->target->kind == rtnExpr_name && action.transfer->value->kind == rtnExpr_name
+                && lowerCase(action.transfer->target->name) == lowerCase(action.transfer->value->name);
+        }), actions.end());
+        countReads(actions);
+        readOut = &os;
+        readPad = pad;
+        if(actions.size() == 1 && actions[0].conditions.empty()) {
+            const Action& action = actions[0];
+            if(action.transfer) {
+                std::string addressCode = action.transfer->target->kind == rtnExpr_memory ? address(action.transfer->target->args[0]) : "";
+                std::string code = write(action.transfer->target, addressCode, cpp(action.transfer->value));
+                os << pad << code << "\n";
+            }
+            readOut = nullptr;
+            return;
+        }
+        std::vector<std::string> conditionCodes, addressCodes;
+        std::vector<CppValue> values;
+        // the temporary holding each value computed, so that one used twice is computed once
+        std::map<std::string, std::string> valueNames;
+        for(const auto& action : actions) {
+            std::string condition;
+            for(const auto& expr : action.conditions) {
+                condition += (condition.empty() ? "" : " && ") + cpp(expr).code;
+            }
+            if(!condition.empty()) {
+                std::string name = "c" + std::to_string(temporaries++);
+                os << pad << "bool " << name << " = " << condition << ";\n";
+                condition = name;
+            }
+            conditionCodes.push_back(condition);
+            std::string addressCode;
+            CppValue value;
+            if(action.transfer) {
+                if(action.transfer->target->kind == rtnExpr_memory) {
+                    addressCode = "a" + std::to_string(temporaries++);
+                    os << pad << "int " << addressCode << " = " << address(action.transfer->target->args[0]) << ";\n";
+                }
+                value = cpp(action.transfer->value);
+                if(!value.isConstant && valueNames.count(value.code) != 0) {
+                    value.code = valueNames[value.code];
+                } else if(!value.isConstant) {
+                    std::string name = "v" + std::to_string(temporaries++);
+                    os << pad << "int " << name << " = " << value.code << ";\n";
+                    valueNames[value.code] = name;
+                    value.code = name;
+                }
+            }
+            addressCodes.push_back(addressCode);
+            values.push_back(value);
+        }
+        readOut = nullptr;
+        std::vector<bool> isWritten(actions.size());
+        for(size_t i = 0; i < actions.size(); i++) {
+            if(!actions[i].transfer || isWritten[i]) {
+                continue;
+            }
+            std::string code = write(actions[i].transfer->target, addressCodes[i], values[i]);
+            int mapped = mappedAddressOf(actions[i].transfer);
+            if(mapped >= 0) {
+                // with the other registers of its byte written under the same guards
+                std::vector<std::pair<const RtnRegister*, CppValue>> parts;
+                for(size_t j = i; j < actions.size(); j++) {
+                    if(mappedAddressOf(actions[j].transfer) == mapped && conditionCodes[j] == conditionCodes[i]) {
+                        parts.push_back({ rtn.findRegister(actions[j].transfer->target->name), values[j] });
+                        isWritten[j] = true;
+                    }
+                }
+                code = writeMapped(mapped, parts);
+            }
+            if(conditionCodes[i].empty()) {
+                os << pad << code << "\n";
+            } else {
+                os << pad << "if(" << conditionCodes[i] << ") {\n" << pad << "    " << code << "\n" << pad << "}\n";
+            }
+        }
+    }
+
+    // the guarded alternatives of a step which takes more than one path, e.g. each opcode
+    std::vector<RtnNodePtr> alternatives(const RtnNodePtr& node) {
+        if(node->kind == rtnNode_guard) {
+            return { node };
+        }
+        std::vector<RtnNodePtr> result;
+        for(const auto& item : node->items) {
+            if(item->kind != rtnNode_guard) {
+                error("the parallel steps of more than one step must all be guarded");
+                return {};
+            }
+            result.push_back(item);
+        }
+        return result;
+    }
+
+    // returns true if the node is a parallel step of alternatives taking more than one step
+    bool isChoice(const RtnNodePtr& node) {
+        return (node->kind == rtnNode_parallel || node->kind == rtnNode_guard) && stepsOf(node) > 1;
+    }
+
+    // if each alternative is 'name = constant', fills the name's code, for a switch
+    bool trySwitchOn(const std::vector<RtnNodePtr>& choices, std::string& out_subject) {
+        std::string name;
+        for(const auto& choice : choices) {
+            const RtnExprPtr& condition = choice->condition;
+            if(condition->kind != rtnExpr_compare || condition->ops.size() != 1 || condition->ops[0] != "="
+                || condition->args[1]->kind != rtnExpr_number || condition->args[0]->kind != rtnExpr_name
+                || (name != "" && lowerCase(condition->args[0]->name) != name)) {
+                return false;
+            }
+            name = lowerCase(condition->args[0]->name);
+        }
+        if(name == "") {
+            return false;
+        }
+        out_subject = cpp(choices[0]->condition->args[0]).code;
+        return true;
+    }
+
+    // the code of a condition without its outer parentheses, for an if
+    static std::string unwrap(const std::string& code) {
+        if(code.size() < 2 || code.front() != '(' || code.back() != ')') {
+            return code;
+        }
+        int depth = 0;
+        for(size_t i = 0; i + 1 < code.size(); i++) {
+            depth += code[i] == '(' ? 1 : code[i] == ')' ? -1 : 0;
+            if(depth == 0) {
+                return code;
+            }
+        }
+        return code.substr(1, code.size() - 2);
+    }
+
+    // writes the cycles added since the last branch
+    void flush(int indent, int& pending) {
+        if(pending > 0) {
+            body << std::string(indent * 4, ' ') << "m.cycles += " << pending << ";\n";
+        }
+        pending = 0;
+    }
+
+    // writes the alternatives as a switch or if chain, with otherwise run if none is taken
+    void emitChoice(const std::vector<RtnNodePtr>& choices, int indent, int& pending, const std::string& otherwise) {
+        std::string pad(indent * 4, ' ');
+        std::string subject;
+        if(trySwitchOn(choices, subject)) {
+            body << pad << "switch(" << unwrap(subject) << ") {\n";
+            for(const auto& choice : choices) {
+                body << pad << "    // " << choice->name << "\n";
+                body << pad << "    case " << choice->condition->args[1]->value << ": {\n";
+                int branchPending = pending;
+                emitCollapsed(choice->body, indent + 2, branchPending);
+                flush(indent + 2, branchPending);
+                body << pad << "        break;\n" << pad << "    }\n";
+            }
+            body << pad << "    default: {\n";
+        } else {
+            for(size_t i = 0; i < choices.size(); i++) {
+                body << pad << (i == 0 ? "if(" : "} else if(") << unwrap(cpp(choices[i]->condition).code) << ") {\n";
+                int branchPending = pending;
+                emitCollapsed(choices[i]->body, indent + 1, branchPending);
+                flush(indent + 1, branchPending);
+            }
+            body << pad << "} else {\n";
+        }
+        // a guard which isn't taken still takes its step
+        int inner = subject != "" ? indent + 2 : indent + 1;
+        int otherPending = pending + 1;
+        if(otherwise != "") {
+            body << std::string(inner * 4, ' ') << otherwise << "\n";
+        } else {
+            flush(inner, otherPending);
+        }
+        if(subject != "") {
+            body << pad << "        break;\n";
+        }
+        body << pad << (subject != "" ? "    }\n" + pad + "}\n" : "}\n");
+        pending = 0;
+    }
+
+    // writes the steps of the node one after another, adding the cycles of each path
+    void emitCollapsed(const RtnNodePtr& node, int indent, int& pending) {
+        if(!ok) {
+            return;
+        }
+        std::string pad(indent * 4, ' ');
+        if(node->kind == rtnNode_sequence) {
+            for(const auto& item : node->items) {
+                emitCollapsed(item, indent, pending);
+            }
+        } else if(node->kind == rtnNode_call && lowerCase(node->name) == "ins_exe") {
+            body << pad << "++m.instructions;\n";
+            RtnNodePtr called = procedure(node->name);
+            if(called != nullptr) {
+                emitCollapsed(called, indent, pending);
+            }
+        } else if(node->kind == rtnNode_call) {
+            if(lowerCase(node->name) != "ins_interpretation") {
+                RtnNodePtr called = procedure(node->name);
+                if(called != nullptr) {
+                    emitCollapsed(called, indent, pending);
+                }
+            }
+        } else if(node->kind == rtnNode_guard && stepsOf(node->body) > 1) {
+            emitChoice({ node }, indent, pending, "");
+        } else if(isChoice(node)) {
+            emitChoice(alternatives(node), indent, pending, "");
+        } else {
+            std::vector<Action> actions;
+            collectActions(node, {}, actions);
+            emitActions(actions, indent, body);
+            pending++;
+        }
+    }
+
+    /*
+        micro steps
+    */
+
+    // returns the state running the items of a sequence from start, then going to next
+    int stateOf(const RtnNodePtr& sequence, size_t start, int next) {
+        const std::vector<RtnNodePtr>& items = sequence->items;
+        while(start < items.size() && stepsOf(items[start]) == 0) {
+            start++;
+        }
+        if(start >= items.size()) {
+            return next;
+        }
+        auto key = std::make_tuple(sequence.get(), start, next);
+        if(stateIds.count(key) != 0) {
+            return stateIds[key];
+        }
+        int id = states.size();
+        stateIds[key] = id;
+        states.push_back(MicroState());
+        int after = stateOf(sequence, start + 1, next);
+        std::ostringstream code;
+        emitMicro(items[start], after, 3, code);
+        states[id].comment = describe(items[start]);
+        states[id].code = code.str();
+        return id;
+    }
+
+    // writes the first step of the node, which then goes on to the state next
+    void emitMicro(const RtnNodePtr& node, int next, int indent, std::ostream& os) {
+        if(!ok) {
+            return;
+        }
+        std::string pad(indent * 4, ' ');
+        if(node->kind == rtnNode_sequence) {
+            size_t first = 0;
+            while(first < node->items.size() && stepsOf(node->items[first]) == 0) {
+                first++;
+            }
+            if(first >= node->items.size()) {
+                os << pad << "m.phase = " << next << ";\n";
+                return;
+            }
+            emitMicro(node->items[first], stateOf(node, first + 1, next), indent, os);
+        } else if(node->kind == rtnNode_call && lowerCase(node->name) == "ins_exe") {
+            os << pad << "++m.instructions;\n";
+            RtnNodePtr called = procedure(node->name);
+            if(called != nullptr) {
+                emitMicro(called, next, indent, os);
+            }
+        } else if(node->kind == rtnNode_call) {
+            RtnNodePtr called = procedure(node->name);
+            if(called != nullptr) {
+                emitMicro(called, next, indent, os);
+            }
+        } else if((node->kind == rtnNode_guard && stepsOf(node->body) > 1) || isChoice(node)) {
+            emitMicroChoice(alternatives(node), next, indent, "", os);
+        } else {
+            std::vector<Action> actions;
+            collectActions(node, {}, actions);
+            emitActions(actions, indent, os);
+            os << pad << "m.phase = " << next << ";\n";
+        }
+    }
+
+    void emitMicroChoice(const std::vector<RtnNodePtr>& choices, int next, int indent, const std::string& otherwise, std::ostream& os) {
+        std::string pad(indent * 4, ' ');
+        std::string subject;
+        bool isSwitch = trySwitchOn(choices, subject);
+        if(isSwitch) {
+            os << pad << "switch(" << unwrap(subject) << ") {\n";
+        }
+        for(size_t i = 0; i < choices.size(); i++) {
+            if(isSwitch) {
+                os << pad << "    // " << choices[i]->name << "\n" << pad << "    case " << choices[i]->condition->args[1]->value << ": {\n";
+                emitMicro(choices[i]->body, next, indent + 2, os);
+                os << pad << "        break;\n" << pad << "    }\n";
+            } else {
+                os << pad << (i == 0 ? "if(" : "} else if(") << unwrap(cpp(choices[i]->condition).code) << ") {\n";
+                emitMicro(choices[i]->body, next, indent + 1, os);
+            }
+        }
+        std::string inner = pad + (isSwitch ? "        " : "    ");
+        os << pad << (isSwitch ? "    default: {\n" : "} else {\n");
+        os << inner << (otherwise != "" ? otherwise : "m.phase = " + std::to_string(next) + ";") << "\n";
+        if(isSwitch) {
+            os << inner << "break;\n" << pad << "    }\n";
+        }
+        os << pad << "}\n";
+    }
+
+    /*
+        comments
+    */
+
+    std::string describe(const RtnExprPtr& expr) {
+        switch(expr->kind) {
+            case rtnExpr_number: { return cppNumber(expr->value); }
+            case rtnExpr_name: { return expr->name; }
+            case rtnExpr_memory: { return "MEM[" + describe(expr->args[0]) + "]"; }
+            case rtnExpr_bits: {
+                return expr->name + "<" + std::to_string(expr->high) + (expr->high != expr->low ? ".." + std::to_string(expr->low) : "") + ">";
+            }
+            case rtnExpr_reduce: {
+                return expr->name + "<" + std::to_string(expr->high) + "> OR .. OR " + expr->name + "<" + std::to_string(expr->low) + ">";
+            }
+            case rtnExpr_repeat: { return std::to_string(expr->high) + "@" + std::to_string(expr->value); }
+            case rtnExpr_concat: {
+                std::string text;
+                for(const auto& arg : expr->args) {
+                    text += (text.empty() ? "" : "#") + describe(arg);
+                }
+                return text;
+            }
+            case rtnExpr_unary: {
+                std::string operand = describe(expr->args[0]);
+                if(expr->args[0]->kind != rtnExpr_name && expr->args[0]->kind != rtnExpr_number && expr->args[0]->kind != rtnExpr_bits) {
+                    operand = "(" + operand + ")";
+                }
+                return (expr->op == "NOT" ? "NOT " : "-") + operand;
+            }
+            case rtnExpr_binary: {
+                bool isWord = expr->op != "+" && expr->op != "-";
+                return describe(expr->args[0]) + (isWord ? " " + expr->op + " " : expr->op) + describe(expr->args[1]);
+            }
+            case rtnExpr_compare: {
+                std::string text = describe(expr->args[0]);
+                for(size_t i = 0; i < expr->ops.size(); i++) {
+                    text += " " + expr->ops[i] + " " + describe(expr->args[i + 1]);
+                }
+                return text;
+            }
+        }
+        return "";
+    }
+
+    std::string describe(const RtnNodePtr& node) {
+        switch(node->kind) {
+            case rtnNode_transfer: { return describe(node->target) + " <- " + describe(node->value); }
+            case rtnNode_call: { return node->name; }
+            case rtnNode_guard: {
+                return (node->name != "" ? node->name : "(" + describe(node->condition) + ")") + " -> " + describe(node->body);
+            }
+            case rtnNode_sequence:
+            case rtnNode_parallel: {
+                std::string text;
+                for(const auto& item : node->items) {
+                    text += (text.empty() ? "" : node->kind == rtnNode_sequence ? "; " : ": ") + describe(item);
+                }
+                return "(" + text + ")";
+            }
+        }
+        return "";
+    }
+};
+
+#endif // RTN2CPP_H
@@ -0,0 +1,253 @@
+/*
+    generates the runtime library's routines, verifies them on the machine and measures them
+
+    -o dir writes each variant of each routine to dir, e.g. dir/mul8_unrolled.s
+    --verify runs each variant against the C++ it implements: every pair of 8-bit arguments,
+      and for 16-bit routines every value of each argument against a set of edge values of the
+      other, plus random pairs
+    --table prints the cycles per call of each variant, from its entry to its return, measured
+      over every 8-bit pair (shift counts within the width) or random 16-bit pairs
+*/
+
+#include <string>
+#include <sstream>
+#include <iostream>
+#include <fstream>
+#include <iomanip>
+#include <random>
+#include "runtime.h"
+#include "../assem2mac/assembler.h"
+#include "../ssbc-interpreter/machine.h"
+
+// the most instructions a call may run before it is taken to be stuck
+const long long MAX_INSTRUCTIONS = 100000;
+
+// a routine variant assembled alone, with a halt to return to
+class Harness {
+    public:
+    const Routine& routine;
+    bool isUnrolled;
+    std::string text;
+    int maxDepth = 0;
+    std::vector<unsigned char> image;
+    // the routine's size, without the halt
+    int bytes = 0;
+    int entry = 0, returnJump = 0, halt = 0, a = 0, b = 0, extra = 0;
+    Machine machine;
+
+    Harness(const Routine& _routine, bool _isUnrolled) : routine(_routine), isUnrolled(_isUnrolled) { }
+
+    // assembles the variant, returning false after writing the errors if not possible
+    bool tryLoad(std::ostream& err) {
+        text = generateRoutine(routine, isUnrolled, "", maxDepth);
+        AssembleResult assembled = assemble(text + "#t_halt\n    halt\n");
+        if(!assembled.ok) {
+            err << "Error: " << routineFileName(routine, isUnrolled) << " did not assemble" << std::endl;
+            for(const auto& diagnostic : assembled.diagnostics) {
+                err << diagnostic << std::endl;
+            }
+            return false;
+        }
+        image = assembled.image;
+        bytes = image.size() - 1;
+        AddressMap& labels = assembled.addressMap;
+        entry = labels.get("f_" + routine.name);
+        returnJump = labels.get("r_" + routine.name);
+        halt = labels.get("t_halt");
+        a = labels.get("v_" + routine.name + "_a");
+        b = labels.get("v_" + routine.name + "_b");
+        extra = routine.extra.empty() ? 0 : labels.get("v_" + routine.name + "_" + routine.extra);
+        return true;
+    }
+
+    // calls the routine with x and y, filling the results and the N flag on return
+    // returns the cycles from the entry to the return, or -1 if the routine did not return
+    // with its stack balanced
+    long long call(int x, int y, int& out_result, int& out_extra, bool& out_isNegative) {
+        std::copy(image.begin(), image.end(), machine.MEM);
+        machine.reset();
+        machine.PC = entry;
+        put(a, x, routine.width);
+        // shift counts are a byte
+        put(b, y, isShift(routine) ? 8 : routine.width);
+        machine.MEM[returnJump + 1] = halt >> 8;
+        machine.MEM[returnJump + 2] = halt & 0xFF;
+        machine.run(MAX_INSTRUCTIONS);
+        if(!machine.HALT || machine.PC != halt + 1) {
+            return -1;
+        }
+        int depth = routine.isPushed ? 1 : 0;
+        if(machine.SP != SP_RESET - depth) {
+            return -1;
+        }
+        out_result = routine.isPushed ? machine.MEM[SP_RESET] : get(a);
+        out_extra = routine.extra.empty() ? 0 : get(extra);
+        out_isNegative = machine.N();
+        return machine.cycles - opCycles(op_halt);
+    }
+
+    private:
+    void put(int address, int value, int width) {
+        if(width == 16) {
+            machine.MEM[address] = value >> 8;
+            machine.MEM[address + 1] = value & 0xFF;
+        } else {
+            machine.MEM[address] = value;
+        }
+    }
+
+    int get(int address) {
+        return routine.width == 16 ? (machine.MEM[address] << 8) | machine.MEM[address + 1] : machine.MEM[address];
+    }
+};
+
+// the values each 16-bit argument is crossed with
+std::vector<int> edgeValues(const Routine& routine) {
+    if(isShift(routine)) {
+        std::vector<int> counts;
+        for(int k = 0; k <= 17; k++) {
+            counts.push_back(k);
+        }
+        counts.insert(counts.end(), { 0x7F, 0x80, 0xFF });
+        return counts;
+    }
+    return { 0x0000, 0x0001, 0x0002, 0x0003, 0x0007, 0x000A, 0x007F, 0x0080, 0x00FF, 0x0100, 0x0101, 0x1234,
+        0x7FFE, 0x7FFF, 0x8000, 0x8001, 0xABCD, 0xFF00, 0xFFFE, 0xFFFF };
+}
+
+// the pairs of arguments a variant is verified with
+std::vector<std::pair<int, int>> verifyInputs(const Routine& routine) {
+    std::vector<std::pair<int, int>> inputs;
+    if(routine.width == 8) {
+        for(int x = 0; x < 256; x++) {
+            for(int y = 0; y < 256; y++) {
+                inputs.push_back(std::make_pair(x, y));
+            }
+        }
+        return inputs;
+    }
+    int countLimit = isShift(routine) ? 0x100 : 0x10000;
+    for(int edge : edgeValues(routine)) {
+        for(int x = 0; x < 0x10000; x++) {
+            inputs.push_back(std::make_pair(x, edge));
+        }
+    }
+    if(!isShift(routine)) {
+        for(int edge : edgeValues(routine)) {
+            for(int y = 0; y < 0x10000; y++) {
+                inputs.push_back(std::make_pair(edge, y));
+            }
+        }
+    }
+    std::mt19937 random(routine.width);
+    for(int n = 0; n < 200000; n++) {
+        inputs.push_back(std::make_pair(random() & 0xFFFF, random() % countLimit));
+    }
+    return inputs;
+}
+
+// the pairs of arguments a variant is measured with
+std::vector<std::pair<int, int>> measureInputs(const Routine& routine) {
+    std::vector<std::pair<int, int>> inputs;
+    if(routine.width == 8) {
+        for(int x = 0; x < 256; x++) {
+            for(int y = 0; y < (isShift(routine) ? 8 : 256); y++) {
+                inputs.push_back(std::make_pair(x, y));
+            }
+        }
+        return inputs;
+    }
+    std::mt19937 random(1);
+    for(int n = 0; n < 20000; n++) {
+        inputs.push_back(std::make_pair(random() & 0xFFFF, isShift(routine) ? random() % 16 : random() & 0xFFFF));
+    }
+    return inputs;
+}
+
+// runs every input through the variant, returning false after writing the first mismatch
+bool verify(Harness& harness, std::ostream& err) {
+    const Routine& routine = harness.routine;
+    std::string name = routineFileName(routine, harness.isUnrolled);
+    for(const auto& input : verifyInputs(routine)) {
+        int result, extra;
+        bool isNegative;
+        long long cycles = harness.call(input.first, input.second, result, extra, isNegative);
+        int expected = routine.result(input.first, input.second);
+        int expectedExtra = routine.extraResult ? routine.extraResult(input.first, input.second) : 0;
+        bool isCompare = routine.name.find("cmp") != std::string::npos;
+        std::string problem;
+        if(cycles < 0) {
+            problem = "did not return with its stack balanced";
+        } else if(result != expected) {
+            problem = "gave " + std::to_string(result) + ", expected " + std::to_string(expected);
+        } else if(extra != expectedExtra) {
+            problem = "left " + routine.extra + " " + std::to_string(extra) + ", expected " + std::to_string(expectedExtra);
+        } else if(isCompare && isNegative != (expected == 0xFF)) {
+            problem = "returned with N " + std::string(isNegative ? "set" : "clear");
+        }
+        if(problem != "") {
+            err << "Error: " << name << " with a = " << input.first << ", b = " << input.second << " " << problem << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+int main(int argc, char** argv) {
+    std::string outDir;
+    bool hasOutDir = tryParseArg(argc, argv, "-o", outDir);
+    bool isVerifying = tryParseArg(argc, argv, "--verify");
+    bool isMeasuring = tryParseArg(argc, argv, "--table");
+    if(!hasOutDir && !isVerifying && !isMeasuring) {
+        std::cerr << "Usage: " << argv[0] << " [-o dir] [--verify] [--table]" << std::endl;
+        return 1;
+    }
+
+    if(isMeasuring) {
+        std::cout << std::left << std::setw(10) << "routine" << std::setw(10) << "variant" << std::setw(24) << "operation" << std::right
+            << std::setw(7) << "bytes" << std::setw(7) << "stack" << std::setw(8) << "min" << std::setw(8) << "avg" << std::setw(8) << "max" << std::endl;
+    }
+    bool allPassed = true;
+    for(const auto& routine : routines()) {
+        for(bool isUnrolled : { false, true }) {
+            if(routine.isStraight && isUnrolled) {
+                continue;
+            }
+            Harness harness(routine, isUnrolled);
+            if(!harness.tryLoad(std::cerr)) {
+                return 1;
+            }
+            std::string fileName = routineFileName(routine, isUnrolled);
+            if(hasOutDir) {
+                std::ofstream file(outDir + "/" + fileName);
+                if(!file.is_open()) {
+                    std::cerr << "Error: could not open " << outDir << "/" << fileName << std::endl;
+                    return 1;
+                }
+                file << harness.text;
+            }
+            if(isVerifying) {
+                bool passed = verify(harness, std::cerr);
+                std::cerr << fileName << ": " << (passed ? "ok" : "FAILED") << std::endl;
+                allPassed &= passed;
+            }
+            if(isMeasuring) {
+                long long least = -1, most = 0, total = 0;
+                std::vector<std::pair<int, int>> inputs = measureInputs(routine);
+                for(const auto& input : inputs) {
+                    int result, extra;
+                    bool isNegative;
+                    long long cycles = harness.call(input.first, input.second, result, extra, isNegative);
+                    least = least < 0 ? cycles : std::min(least, cycles);
+                    most = std::max(most, cycles);
+                    total += cycles;
+                }
+                std::string variant = routine.isStraight ? "-" : isUnrolled ? "unrolled" : "looped";
+                std::cout << std::left << std::setw(10) << routine.name << std::setw(10) << variant << std::setw(24) << routine.summary << std::right
+                    << std::setw(7) << harness.bytes << std::setw(7) << harness.maxDepth << std::setw(8) << least
+                    << std::setw(8) << std::fixed << std::setprecision(0) << (double)total / inputs.size() << std::setw(8) << most << std::endl;
+            }
+        }
+    }
+    return allPassed ? 0 : 1;
+}
@@ -0,0 +1,84 @@
+; cmp16: a <=> b, 16-bit
+#f_cmp16
+    pushext @v_cmp16_b
+    pushext @v_cmp16_a
+    sub
+    jnz @l_cmp16_1
+    popinh
+    pushext @v_cmp16_b+1
+    pushext @v_cmp16_a+1
+    sub
+    jnz @l_cmp16_2
+#l_cmp16_ret
+    pushimm 0x00
+    popext 0xFFFB
+#r_cmp16
+    jnz 0x0000
+#l_cmp16_1
+    popinh
+    pushimm 0x00
+    pushext @v_cmp16_a
+    add
+    popinh
+    jnn @l_cmp16_5
+    pushimm 0x00
+    pushext @v_cmp16_b
+    add
+    popinh
+    jnn @l_cmp16_3
+    jnz @l_cmp16_6
+#l_cmp16_5
+    pushimm 0x00
+    pushext @v_cmp16_b
+    add
+    popinh
+    jnn @l_cmp16_6
+    jnz @l_cmp16_4
+#l_cmp16_6
+    pushext @v_cmp16_b
+    pushext @v_cmp16_a
+    sub
+    popinh
+    jnn @l_cmp16_4
+    jnz @l_cmp16_3
+#l_cmp16_2
+    popinh
+    pushimm 0x00
+    pushext @v_cmp16_a+1
+    add
+    popinh
+    jnn @l_cmp16_7
+    pushimm 0x00
+    pushext @v_cmp16_b+1
+    add
+    popinh
+    jnn @l_cmp16_4
+    jnz @l_cmp16_8
+#l_cmp16_7
+    pushimm 0x00
+    pushext @v_cmp16_b+1
+    add
+    popinh
+    jnn @l_cmp16_8
+    jnz @l_cmp16_3
+#l_cmp16_8
+    pushext @v_cmp16_b+1
+    pushext @v_cmp16_a+1
+    sub
+    popinh
+    jnn @l_cmp16_4
+    jnz @l_cmp16_3
+#l_cmp16_3
+    pushimm 0xFF
+    pushimm 0x40
+    popext 0xFFFB
+    jnz @r_cmp16
+#l_cmp16_4
+    pushimm 0x01
+    pushimm 0x00
+    popext 0xFFFB
+    jnz @r_cmp16
+#v_cmp16_a 0x00
+    0x00
+#v_cmp16_b 0x00
+    0x00
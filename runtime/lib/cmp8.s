@@ -0,0 +1,50 @@
+; cmp8: a <=> b, 8-bit
+#f_cmp8
+    pushext @v_cmp8_b
+    pushext @v_cmp8_a
+    sub
+    jnz @l_cmp8_1
+#l_cmp8_ret
+    pushimm 0x00
+    popext 0xFFFB
+#r_cmp8
+    jnz 0x0000
+#l_cmp8_1
+    popinh
+    pushimm 0x00
+    pushext @v_cmp8_a
+    add
+    popinh
+    jnn @l_cmp8_4
+    pushimm 0x00
+    pushext @v_cmp8_b
+    add
+    popinh
+    jnn @l_cmp8_2
+    jnz @l_cmp8_5
+#l_cmp8_4
+    pushimm 0x00
+    pushext @v_cmp8_b
+    add
+    popinh
+    jnn @l_cmp8_5
+    jnz @l_cmp8_3
+#l_cmp8_5
+    pushext @v_cmp8_b
+    pushext @v_cmp8_a
+    sub
+    popinh
+    jnn @l_cmp8_3
+    jnz @l_cmp8_2
+#l_cmp8_2
+    pushimm 0xFF
+    pushimm 0x40
+    popext 0xFFFB
+    jnz @r_cmp8
+#l_cmp8_3
+    pushimm 0x01
+    pushimm 0x00
+    popext 0xFFFB
+    jnz @r_cmp8
+#v_cmp8_a 0x00
+#v_cmp8_b 0x00
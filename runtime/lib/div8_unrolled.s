@@ -0,0 +1,309 @@
+; div8: a / b, 8-bit, unrolled
+#f_div8
+    pushimm 0x00
+    popext @v_div8_s
+    pushimm 0x00
+    pushext @v_div8_a
+    add
+    popinh
+    jnn @l_div8_1
+    pushext @v_div8_a
+    pushimm 0x00
+    sub
+    popext @v_div8_a
+    pushimm 0x01
+    popext @v_div8_s
+#l_div8_1
+    pushimm 0x00
+    pushext @v_div8_b
+    add
+    popinh
+    jnn @l_div8_2
+    pushext @v_div8_b
+    pushimm 0x00
+    sub
+    popext @v_div8_b
+    pushext @v_div8_s
+    pushimm 0x01
+    sub
+    popext @v_div8_s
+#l_div8_2
+    pushimm 0x00
+    pushext @v_div8_b
+    add
+    popinh
+    jnz @l_div8_5
+    pushext @v_div8_a
+    popext @v_div8_m
+    pushimm 0xFF
+    popext @v_div8_a
+    jnz @l_div8_32
+    jnn @l_div8_32
+#l_div8_5
+    jnn @l_div8_6
+    pushext @v_div8_a
+    popext @v_div8_m
+    pushimm 0x00
+    pushext @v_div8_a
+    add
+    popinh
+    jnn @l_div8_7
+    pushext @v_div8_b
+    pushext @v_div8_a
+    sub
+    jnn @l_div8_8
+    popinh
+#l_div8_7
+    pushimm 0x00
+    popext @v_div8_a
+    jnz @l_div8_32
+    jnn @l_div8_32
+#l_div8_6
+    pushimm 0x00
+    popext @v_div8_m
+    pushimm 0x00
+    pushext @v_div8_a
+    add
+    popinh
+    pushext @v_div8_b
+    pushext @v_div8_m
+    pushext @v_div8_m
+    jnn @l_div8_9
+    pushimm 0x01
+    add
+#l_div8_9
+    add
+    sub
+    jnn @l_div8_10
+    pushext @v_div8_b
+    add
+    popext @v_div8_m
+    pushext @v_div8_a
+    pushext @v_div8_a
+    add
+    popext @v_div8_a
+#l_div8_11
+    pushext @v_div8_b
+    pushext @v_div8_m
+    pushext @v_div8_m
+    jnn @l_div8_12
+    pushimm 0x01
+    add
+#l_div8_12
+    add
+    sub
+    jnn @l_div8_13
+    pushext @v_div8_b
+    add
+    popext @v_div8_m
+    pushext @v_div8_a
+    pushext @v_div8_a
+    add
+    popext @v_div8_a
+#l_div8_14
+    pushext @v_div8_b
+    pushext @v_div8_m
+    pushext @v_div8_m
+    jnn @l_div8_15
+    pushimm 0x01
+    add
+#l_div8_15
+    add
+    sub
+    jnn @l_div8_16
+    pushext @v_div8_b
+    add
+    popext @v_div8_m
+    pushext @v_div8_a
+    pushext @v_div8_a
+    add
+    popext @v_div8_a
+#l_div8_17
+    pushext @v_div8_b
+    pushext @v_div8_m
+    pushext @v_div8_m
+    jnn @l_div8_18
+    pushimm 0x01
+    add
+#l_div8_18
+    add
+    sub
+    jnn @l_div8_19
+    pushext @v_div8_b
+    add
+    popext @v_div8_m
+    pushext @v_div8_a
+    pushext @v_div8_a
+    add
+    popext @v_div8_a
+#l_div8_20
+    pushext @v_div8_b
+    pushext @v_div8_m
+    pushext @v_div8_m
+    jnn @l_div8_21
+    pushimm 0x01
+    add
+#l_div8_21
+    add
+    sub
+    jnn @l_div8_22
+    pushext @v_div8_b
+    add
+    popext @v_div8_m
+    pushext @v_div8_a
+    pushext @v_div8_a
+    add
+    popext @v_div8_a
+#l_div8_23
+    pushext @v_div8_b
+    pushext @v_div8_m
+    pushext @v_div8_m
+    jnn @l_div8_24
+    pushimm 0x01
+    add
+#l_div8_24
+    add
+    sub
+    jnn @l_div8_25
+    pushext @v_div8_b
+    add
+    popext @v_div8_m
+    pushext @v_div8_a
+    pushext @v_div8_a
+    add
+    popext @v_div8_a
+#l_div8_26
+    pushext @v_div8_b
+    pushext @v_div8_m
+    pushext @v_div8_m
+    jnn @l_div8_27
+    pushimm 0x01
+    add
+#l_div8_27
+    add
+    sub
+    jnn @l_div8_28
+    pushext @v_div8_b
+    add
+    popext @v_div8_m
+    pushext @v_div8_a
+    pushext @v_div8_a
+    add
+    popext @v_div8_a
+#l_div8_29
+    pushext @v_div8_b
+    pushext @v_div8_m
+    pushext @v_div8_m
+    jnn @l_div8_30
+    pushimm 0x01
+    add
+#l_div8_30
+    add
+    sub
+    jnn @l_div8_31
+    pushext @v_div8_b
+    add
+    popext @v_div8_m
+    pushext @v_div8_a
+    pushext @v_div8_a
+    add
+    popext @v_div8_a
+#l_div8_32
+    pushext @v_div8_a
+    pushimm 0x00
+    pushext @v_div8_s
+    add
+    popinh
+    jnz @l_div8_4
+#l_div8_ret
+    pushimm 0x00
+    popext 0xFFFB
+#r_div8
+    jnz 0x0000
+#l_div8_8
+    popext @v_div8_m
+    pushimm 0x01
+    popext @v_div8_a
+    jnz @l_div8_32
+    jnn @l_div8_32
+#l_div8_10
+    popext @v_div8_m
+    pushext @v_div8_a
+    pushext @v_div8_a
+    add
+    pushimm 0x01
+    add
+    popext @v_div8_a
+    jnz @l_div8_11
+#l_div8_13
+    popext @v_div8_m
+    pushext @v_div8_a
+    pushext @v_div8_a
+    add
+    pushimm 0x01
+    add
+    popext @v_div8_a
+    jnz @l_div8_14
+#l_div8_16
+    popext @v_div8_m
+    pushext @v_div8_a
+    pushext @v_div8_a
+    add
+    pushimm 0x01
+    add
+    popext @v_div8_a
+    jnz @l_div8_17
+#l_div8_19
+    popext @v_div8_m
+    pushext @v_div8_a
+    pushext @v_div8_a
+    add
+    pushimm 0x01
+    add
+    popext @v_div8_a
+    jnz @l_div8_20
+#l_div8_22
+    popext @v_div8_m
+    pushext @v_div8_a
+    pushext @v_div8_a
+    add
+    pushimm 0x01
+    add
+    popext @v_div8_a
+    jnz @l_div8_23
+#l_div8_25
+    popext @v_div8_m
+    pushext @v_div8_a
+    pushext @v_div8_a
+    add
+    pushimm 0x01
+    add
+    popext @v_div8_a
+    jnz @l_div8_26
+#l_div8_28
+    popext @v_div8_m
+    pushext @v_div8_a
+    pushext @v_div8_a
+    add
+    pushimm 0x01
+    add
+    popext @v_div8_a
+    jnz @l_div8_29
+#l_div8_31
+    popext @v_div8_m
+    pushext @v_div8_a
+    pushext @v_div8_a
+    add
+    pushimm 0x01
+    add
+    popext @v_div8_a
+    jnz @l_div8_32
+#l_div8_4
+    pushimm 0x00
+    sub
+    jnz @r_div8
+    jnn @l_div8_ret
+#v_div8_a 0x00
+#v_div8_b 0x00
+#v_div8_m 0x00
+#v_div8_s 0x00
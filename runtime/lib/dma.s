@@ -0,0 +1,65 @@
+; dma: macros programming the interpreter's DMA device (ssbc run --dma, see ssbc-interpreter/dma.h)
+; place with '.include "../runtime/lib/dma.s"' before they are used; it places no code
+; each writes the device's registers with pushimm/pushext and popext, leaving the stack and flags
+; as they were, and the transfer is done by the time the next instruction runs
+.equ DMA_SRC 0xFF00
+.equ DMA_DST 0xFF02
+.equ DMA_LEN 0xFF04
+.equ DMA_VALUE 0xFF06
+.equ DMA_CTRL 0xFF07
+.equ DMA_COPY 1
+.equ DMA_FILL 2
+
+; dma_copy src, dst, len: copies len bytes from src to dst, each a number or an expression
+; such as '@buf'; the blocks may overlap
+.macro dma_copy src, dst, len
+    pushimm (\src).H
+    popext DMA_SRC
+    pushimm (\src).L
+    popext (DMA_SRC+1)
+    pushimm (\dst).H
+    popext DMA_DST
+    pushimm (\dst).L
+    popext (DMA_DST+1)
+    pushimm (\len).H
+    popext DMA_LEN
+    pushimm (\len).L
+    popext (DMA_LEN+1)
+    pushimm DMA_COPY
+    popext DMA_CTRL
+.endm
+
+; dma_fill dst, value, len: sets len bytes from dst to value
+.macro dma_fill dst, value, len
+    pushimm (\dst).H
+    popext DMA_DST
+    pushimm (\dst).L
+    popext (DMA_DST+1)
+    pushimm (\len).H
+    popext DMA_LEN
+    pushimm (\len).L
+    popext (DMA_LEN+1)
+    pushimm \value
+    popext DMA_VALUE
+    pushimm DMA_FILL
+    popext DMA_CTRL
+.endm
+
+; dma_copy_vars src, dst, len: as dma_copy, with the addresses and length read from 2-byte
+; variables (high byte first), e.g. 'dma_copy_vars @v_from, @v_to, @v_count'
+.macro dma_copy_vars src, dst, len
+    pushext \src
+    popext DMA_SRC
+    pushext \src+1
+    popext (DMA_SRC+1)
+    pushext \dst
+    popext DMA_DST
+    pushext \dst+1
+    popext (DMA_DST+1)
+    pushext \len
+    popext DMA_LEN
+    pushext \len+1
+    popext (DMA_LEN+1)
+    pushimm DMA_COPY
+    popext DMA_CTRL
+.endm
@@ -0,0 +1,65 @@
+; events: names and macros for the interpreter's timer and interrupts (ssbc run --events, see
+; ssbc-interpreter/events.h)
+; place with '.include "../runtime/lib/events.s"' before they are used; it places no code
+; each macro writes the registers with pushimm and popext, leaving the stack and flags as they were
+.equ IRQ_STATUS 0xFF10
+.equ IRQ_ENABLE 0xFF11
+.equ IRQ_VECTOR 0xFF12
+.equ IRQ_RETURN 0xFF14
+.equ IRQ_PSW 0xFF16
+.equ IRQ_CTRL 0xFF17
+.equ TIMER_PERIOD 0xFF18
+.equ TIMER_SCALE 0xFF1A
+.equ TIMER_CTRL 0xFF1B
+; the sources, as bits of IRQ_STATUS and IRQ_ENABLE
+.equ IRQ_TIMER 1
+.equ IRQ_PORTA 2
+.equ IRQ_PORTC 4
+; the commands of IRQ_CTRL and TIMER_CTRL
+.equ IRQ_WAIT 1
+.equ IRQ_RET 2
+.equ TIMER_STOP 0
+.equ TIMER_PERIODIC 1
+.equ TIMER_ONESHOT 2
+
+; irq_handler handler, sources: interrupts at handler (e.g. '@tick') when any of the sources
+; (e.g. 'IRQ_TIMER') is pending
+.macro irq_handler handler, sources
+    pushimm (\handler).H
+    popext IRQ_VECTOR
+    pushimm (\handler).L
+    popext (IRQ_VECTOR+1)
+    pushimm \sources
+    popext IRQ_ENABLE
+.endm
+
+; timer_start period, scale, mode: starts the timer going off every period << scale cycles
+; (TIMER_PERIODIC) or once (TIMER_ONESHOT)
+.macro timer_start period, scale, mode
+    pushimm (\period).H
+    popext TIMER_PERIOD
+    pushimm (\period).L
+    popext (TIMER_PERIOD+1)
+    pushimm \scale
+    popext TIMER_SCALE
+    pushimm \mode
+    popext TIMER_CTRL
+.endm
+
+; irq_wait: sleeps until an enabled source is pending, the interrupt (if any) being taken first
+.macro irq_wait
+    pushimm IRQ_WAIT
+    popext IRQ_CTRL
+.endm
+
+; irq_clear sources: clears the sources' pending bits, as a handler does before returning
+.macro irq_clear sources
+    pushimm \sources
+    popext IRQ_STATUS
+.endm
+
+; irq_return: returns from the handler to where the program was interrupted, with its flags
+.macro irq_return
+    pushimm IRQ_RET
+    popext IRQ_CTRL
+.endm
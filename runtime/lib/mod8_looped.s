@@ -0,0 +1,126 @@
+; mod8: a % b, 8-bit, looped
+#f_mod8
+    pushimm 0x00
+    popext @v_mod8_s
+    pushimm 0x00
+    pushext @v_mod8_a
+    add
+    popinh
+    jnn @l_mod8_1
+    pushext @v_mod8_a
+    pushimm 0x00
+    sub
+    popext @v_mod8_a
+    pushimm 0x01
+    popext @v_mod8_s
+#l_mod8_1
+    pushimm 0x00
+    pushext @v_mod8_b
+    add
+    popinh
+    jnn @l_mod8_2
+    pushext @v_mod8_b
+    pushimm 0x00
+    sub
+    popext @v_mod8_b
+#l_mod8_2
+    pushimm 0x00
+    pushext @v_mod8_b
+    add
+    popinh
+    jnz @l_mod8_5
+    pushext @v_mod8_a
+    popext @v_mod8_m
+    pushimm 0xFF
+    popext @v_mod8_a
+    jnz @l_mod8_3
+    jnn @l_mod8_3
+#l_mod8_5
+    jnn @l_mod8_6
+    pushext @v_mod8_a
+    popext @v_mod8_m
+    pushimm 0x00
+    pushext @v_mod8_a
+    add
+    popinh
+    jnn @l_mod8_7
+    pushext @v_mod8_b
+    pushext @v_mod8_a
+    sub
+    jnn @l_mod8_8
+    popinh
+#l_mod8_7
+    pushimm 0x00
+    popext @v_mod8_a
+    jnz @l_mod8_3
+    jnn @l_mod8_3
+#l_mod8_6
+    pushimm 0x00
+    popext @v_mod8_m
+    pushimm 0x07
+    popext @v_mod8_i
+#l_mod8_9
+    pushimm 0x00
+    pushext @v_mod8_a
+    add
+    popinh
+    pushext @v_mod8_b
+    pushext @v_mod8_m
+    pushext @v_mod8_m
+    jnn @l_mod8_10
+    pushimm 0x01
+    add
+#l_mod8_10
+    add
+    sub
+    jnn @l_mod8_11
+    pushext @v_mod8_b
+    add
+    popext @v_mod8_m
+    pushext @v_mod8_a
+    pushext @v_mod8_a
+    add
+    popext @v_mod8_a
+#l_mod8_12
+    pushext @v_mod8_i
+    pushimm 0xFF
+    add
+    popext @v_mod8_i
+    jnn @l_mod8_9
+#l_mod8_3
+    pushext @v_mod8_m
+    pushimm 0x00
+    pushext @v_mod8_s
+    add
+    popinh
+    jnz @l_mod8_4
+#l_mod8_ret
+    pushimm 0x00
+    popext 0xFFFB
+#r_mod8
+    jnz 0x0000
+#l_mod8_8
+    popext @v_mod8_m
+    pushimm 0x01
+    popext @v_mod8_a
+    jnz @l_mod8_3
+    jnn @l_mod8_3
+#l_mod8_11
+    popext @v_mod8_m
+    pushext @v_mod8_a
+    pushext @v_mod8_a
+    add
+    pushimm 0x01
+    add
+    popext @v_mod8_a
+    jnz @l_mod8_12
+#l_mod8_4
+    pushimm 0x00
+    sub
+    jnz @r_mod8
+    jnn @l_mod8_ret
+#v_mod8_a 0x00
+#v_mod8_b 0x00
+#v_mod8_m 0x00
+#v_mod8_s 0x00
+#v_mod8_i 0x00
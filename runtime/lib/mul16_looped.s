@@ -0,0 +1,135 @@
+; mul16: a * b, 16-bit, looped
+#f_mul16
+    pushimm 0x00
+    pushext @v_mul16_b+1
+    add
+    popinh
+    jnn @l_mul16_1
+    pushext @v_mul16_a
+    popext @v_mul16_r
+    pushext @v_mul16_a+1
+    popext @v_mul16_r+1
+    jnz @l_mul16_2
+#l_mul16_1
+    pushimm 0x00
+    popext @v_mul16_r
+    pushimm 0x00
+    popext @v_mul16_r+1
+#l_mul16_2
+    pushimm 0x06
+    popext @v_mul16_i
+#l_mul16_3
+    pushimm 0x00
+    pushext @v_mul16_r+1
+    add
+    popinh
+    pushext @v_mul16_r
+    pushext @v_mul16_r
+    jnn @l_mul16_5
+    pushimm 0x01
+    add
+#l_mul16_5
+    add
+    popext @v_mul16_r
+    pushext @v_mul16_r+1
+    pushext @v_mul16_r+1
+    add
+    popext @v_mul16_r+1
+    pushext @v_mul16_b+1
+    pushext @v_mul16_b+1
+    add
+    popext @v_mul16_b+1
+    jnn @l_mul16_10
+    pushext @v_mul16_a+1
+    pushext @v_mul16_r+1
+    add
+    popext @v_mul16_r+1
+    jnn @l_mul16_6
+    pushimm 0x00
+    pushext @v_mul16_a+1
+    add
+    popinh
+    jnn @l_mul16_9
+#l_mul16_7
+    pushext @v_mul16_a+1
+    pushext @v_mul16_r+1
+    sub
+    popinh
+    jnn @l_mul16_9
+#l_mul16_8
+    pushext @v_mul16_a
+    pushext @v_mul16_r
+    add
+    pushimm 0x01
+    add
+    popext @v_mul16_r
+    jnz @l_mul16_10
+    jnn @l_mul16_10
+#l_mul16_6
+    pushimm 0x00
+    pushext @v_mul16_a+1
+    add
+    popinh
+    jnn @l_mul16_7
+    jnz @l_mul16_8
+#l_mul16_9
+    pushext @v_mul16_a
+    pushext @v_mul16_r
+    add
+    popext @v_mul16_r
+#l_mul16_10
+    pushext @v_mul16_i
+    pushimm 0xFF
+    add
+    popext @v_mul16_i
+    jnn @l_mul16_3
+    pushimm 0x00
+    pushext @v_mul16_b
+    add
+    popinh
+    pushimm 0x00
+    jnn @l_mul16_11
+    pushext @v_mul16_a+1
+    add
+#l_mul16_11
+    popext @v_mul16_t
+    pushimm 0x06
+    popext @v_mul16_i
+#l_mul16_12
+    pushext @v_mul16_t
+    pushext @v_mul16_t
+    pushext @v_mul16_b
+    pushext @v_mul16_b
+    add
+    popext @v_mul16_b
+    jnn @l_mul16_13
+    pushext @v_mul16_a+1
+    add
+#l_mul16_13
+    add
+    popext @v_mul16_t
+    pushext @v_mul16_i
+    pushimm 0xFF
+    add
+    popext @v_mul16_i
+    jnn @l_mul16_12
+    pushext @v_mul16_t
+    pushext @v_mul16_r
+    add
+    popext @v_mul16_a
+    pushext @v_mul16_r+1
+    popext @v_mul16_a+1
+    jnz @r_mul16
+#l_mul16_ret
+    pushimm 0x00
+    popext 0xFFFB
+#r_mul16
+    jnz 0x0000
+#v_mul16_a 0x00
+    0x00
+#v_mul16_b 0x00
+    0x00
+#v_mul16_r 0x00
+    0x00
+#v_mul16_t 0x00
+#v_mul16_i 0x00
@@ -0,0 +1,542 @@
+; mul16: a * b, 16-bit, unrolled
+#f_mul16
+    pushimm 0x00
+    pushext @v_mul16_b+1
+    add
+    popinh
+    jnn @l_mul16_1
+    pushext @v_mul16_a
+    popext @v_mul16_r
+    pushext @v_mul16_a+1
+    popext @v_mul16_r+1
+    jnz @l_mul16_2
+#l_mul16_1
+    pushimm 0x00
+    popext @v_mul16_r
+    pushimm 0x00
+    popext @v_mul16_r+1
+#l_mul16_2
+    pushimm 0x00
+    pushext @v_mul16_r+1
+    add
+    popinh
+    pushext @v_mul16_r
+    pushext @v_mul16_r
+    jnn @l_mul16_5
+    pushimm 0x01
+    add
+#l_mul16_5
+    add
+    popext @v_mul16_r
+    pushext @v_mul16_r+1
+    pushext @v_mul16_r+1
+    add
+    popext @v_mul16_r+1
+    pushext @v_mul16_b+1
+    pushext @v_mul16_b+1
+    add
+    popext @v_mul16_b+1
+    jnn @l_mul16_10
+    pushext @v_mul16_a+1
+    pushext @v_mul16_r+1
+    add
+    popext @v_mul16_r+1
+    jnn @l_mul16_6
+    pushimm 0x00
+    pushext @v_mul16_a+1
+    add
+    popinh
+    jnn @l_mul16_9
+#l_mul16_7
+    pushext @v_mul16_a+1
+    pushext @v_mul16_r+1
+    sub
+    popinh
+    jnn @l_mul16_9
+#l_mul16_8
+    pushext @v_mul16_a
+    pushext @v_mul16_r
+    add
+    pushimm 0x01
+    add
+    popext @v_mul16_r
+    jnz @l_mul16_10
+    jnn @l_mul16_10
+#l_mul16_6
+    pushimm 0x00
+    pushext @v_mul16_a+1
+    add
+    popinh
+    jnn @l_mul16_7
+    jnz @l_mul16_8
+#l_mul16_9
+    pushext @v_mul16_a
+    pushext @v_mul16_r
+    add
+    popext @v_mul16_r
+#l_mul16_10
+    pushimm 0x00
+    pushext @v_mul16_r+1
+    add
+    popinh
+    pushext @v_mul16_r
+    pushext @v_mul16_r
+    jnn @l_mul16_12
+    pushimm 0x01
+    add
+#l_mul16_12
+    add
+    popext @v_mul16_r
+    pushext @v_mul16_r+1
+    pushext @v_mul16_r+1
+    add
+    popext @v_mul16_r+1
+    pushext @v_mul16_b+1
+    pushext @v_mul16_b+1
+    add
+    popext @v_mul16_b+1
+    jnn @l_mul16_17
+    pushext @v_mul16_a+1
+    pushext @v_mul16_r+1
+    add
+    popext @v_mul16_r+1
+    jnn @l_mul16_13
+    pushimm 0x00
+    pushext @v_mul16_a+1
+    add
+    popinh
+    jnn @l_mul16_16
+#l_mul16_14
+    pushext @v_mul16_a+1
+    pushext @v_mul16_r+1
+    sub
+    popinh
+    jnn @l_mul16_16
+#l_mul16_15
+    pushext @v_mul16_a
+    pushext @v_mul16_r
+    add
+    pushimm 0x01
+    add
+    popext @v_mul16_r
+    jnz @l_mul16_17
+    jnn @l_mul16_17
+#l_mul16_13
+    pushimm 0x00
+    pushext @v_mul16_a+1
+    add
+    popinh
+    jnn @l_mul16_14
+    jnz @l_mul16_15
+#l_mul16_16
+    pushext @v_mul16_a
+    pushext @v_mul16_r
+    add
+    popext @v_mul16_r
+#l_mul16_17
+    pushimm 0x00
+    pushext @v_mul16_r+1
+    add
+    popinh
+    pushext @v_mul16_r
+    pushext @v_mul16_r
+    jnn @l_mul16_19
+    pushimm 0x01
+    add
+#l_mul16_19
+    add
+    popext @v_mul16_r
+    pushext @v_mul16_r+1
+    pushext @v_mul16_r+1
+    add
+    popext @v_mul16_r+1
+    pushext @v_mul16_b+1
+    pushext @v_mul16_b+1
+    add
+    popext @v_mul16_b+1
+    jnn @l_mul16_24
+    pushext @v_mul16_a+1
+    pushext @v_mul16_r+1
+    add
+    popext @v_mul16_r+1
+    jnn @l_mul16_20
+    pushimm 0x00
+    pushext @v_mul16_a+1
+    add
+    popinh
+    jnn @l_mul16_23
+#l_mul16_21
+    pushext @v_mul16_a+1
+    pushext @v_mul16_r+1
+    sub
+    popinh
+    jnn @l_mul16_23
+#l_mul16_22
+    pushext @v_mul16_a
+    pushext @v_mul16_r
+    add
+    pushimm 0x01
+    add
+    popext @v_mul16_r
+    jnz @l_mul16_24
+    jnn @l_mul16_24
+#l_mul16_20
+    pushimm 0x00
+    pushext @v_mul16_a+1
+    add
+    popinh
+    jnn @l_mul16_21
+    jnz @l_mul16_22
+#l_mul16_23
+    pushext @v_mul16_a
+    pushext @v_mul16_r
+    add
+    popext @v_mul16_r
+#l_mul16_24
+    pushimm 0x00
+    pushext @v_mul16_r+1
+    add
+    popinh
+    pushext @v_mul16_r
+    pushext @v_mul16_r
+    jnn @l_mul16_26
+    pushimm 0x01
+    add
+#l_mul16_26
+    add
+    popext @v_mul16_r
+    pushext @v_mul16_r+1
+    pushext @v_mul16_r+1
+    add
+    popext @v_mul16_r+1
+    pushext @v_mul16_b+1
+    pushext @v_mul16_b+1
+    add
+    popext @v_mul16_b+1
+    jnn @l_mul16_31
+    pushext @v_mul16_a+1
+    pushext @v_mul16_r+1
+    add
+    popext @v_mul16_r+1
+    jnn @l_mul16_27
+    pushimm 0x00
+    pushext @v_mul16_a+1
+    add
+    popinh
+    jnn @l_mul16_30
+#l_mul16_28
+    pushext @v_mul16_a+1
+    pushext @v_mul16_r+1
+    sub
+    popinh
+    jnn @l_mul16_30
+#l_mul16_29
+    pushext @v_mul16_a
+    pushext @v_mul16_r
+    add
+    pushimm 0x01
+    add
+    popext @v_mul16_r
+    jnz @l_mul16_31
+    jnn @l_mul16_31
+#l_mul16_27
+    pushimm 0x00
+    pushext @v_mul16_a+1
+    add
+    popinh
+    jnn @l_mul16_28
+    jnz @l_mul16_29
+#l_mul16_30
+    pushext @v_mul16_a
+    pushext @v_mul16_r
+    add
+    popext @v_mul16_r
+#l_mul16_31
+    pushimm 0x00
+    pushext @v_mul16_r+1
+    add
+    popinh
+    pushext @v_mul16_r
+    pushext @v_mul16_r
+    jnn @l_mul16_33
+    pushimm 0x01
+    add
+#l_mul16_33
+    add
+    popext @v_mul16_r
+    pushext @v_mul16_r+1
+    pushext @v_mul16_r+1
+    add
+    popext @v_mul16_r+1
+    pushext @v_mul16_b+1
+    pushext @v_mul16_b+1
+    add
+    popext @v_mul16_b+1
+    jnn @l_mul16_38
+    pushext @v_mul16_a+1
+    pushext @v_mul16_r+1
+    add
+    popext @v_mul16_r+1
+    jnn @l_mul16_34
+    pushimm 0x00
+    pushext @v_mul16_a+1
+    add
+    popinh
+    jnn @l_mul16_37
+#l_mul16_35
+    pushext @v_mul16_a+1
+    pushext @v_mul16_r+1
+    sub
+    popinh
+    jnn @l_mul16_37
+#l_mul16_36
+    pushext @v_mul16_a
+    pushext @v_mul16_r
+    add
+    pushimm 0x01
+    add
+    popext @v_mul16_r
+    jnz @l_mul16_38
+    jnn @l_mul16_38
+#l_mul16_34
+    pushimm 0x00
+    pushext @v_mul16_a+1
+    add
+    popinh
+    jnn @l_mul16_35
+    jnz @l_mul16_36
+#l_mul16_37
+    pushext @v_mul16_a
+    pushext @v_mul16_r
+    add
+    popext @v_mul16_r
+#l_mul16_38
+    pushimm 0x00
+    pushext @v_mul16_r+1
+    add
+    popinh
+    pushext @v_mul16_r
+    pushext @v_mul16_r
+    jnn @l_mul16_40
+    pushimm 0x01
+    add
+#l_mul16_40
+    add
+    popext @v_mul16_r
+    pushext @v_mul16_r+1
+    pushext @v_mul16_r+1
+    add
+    popext @v_mul16_r+1
+    pushext @v_mul16_b+1
+    pushext @v_mul16_b+1
+    add
+    popext @v_mul16_b+1
+    jnn @l_mul16_45
+    pushext @v_mul16_a+1
+    pushext @v_mul16_r+1
+    add
+    popext @v_mul16_r+1
+    jnn @l_mul16_41
+    pushimm 0x00
+    pushext @v_mul16_a+1
+    add
+    popinh
+    jnn @l_mul16_44
+#l_mul16_42
+    pushext @v_mul16_a+1
+    pushext @v_mul16_r+1
+    sub
+    popinh
+    jnn @l_mul16_44
+#l_mul16_43
+    pushext @v_mul16_a
+    pushext @v_mul16_r
+    add
+    pushimm 0x01
+    add
+    popext @v_mul16_r
+    jnz @l_mul16_45
+    jnn @l_mul16_45
+#l_mul16_41
+    pushimm 0x00
+    pushext @v_mul16_a+1
+    add
+    popinh
+    jnn @l_mul16_42
+    jnz @l_mul16_43
+#l_mul16_44
+    pushext @v_mul16_a
+    pushext @v_mul16_r
+    add
+    popext @v_mul16_r
+#l_mul16_45
+    pushimm 0x00
+    pushext @v_mul16_r+1
+    add
+    popinh
+    pushext @v_mul16_r
+    pushext @v_mul16_r
+    jnn @l_mul16_47
+    pushimm 0x01
+    add
+#l_mul16_47
+    add
+    popext @v_mul16_r
+    pushext @v_mul16_r+1
+    pushext @v_mul16_r+1
+    add
+    popext @v_mul16_r+1
+    pushext @v_mul16_b+1
+    pushext @v_mul16_b+1
+    add
+    popext @v_mul16_b+1
+    jnn @l_mul16_52
+    pushext @v_mul16_a+1
+    pushext @v_mul16_r+1
+    add
+    popext @v_mul16_r+1
+    jnn @l_mul16_48
+    pushimm 0x00
+    pushext @v_mul16_a+1
+    add
+    popinh
+    jnn @l_mul16_51
+#l_mul16_49
+    pushext @v_mul16_a+1
+    pushext @v_mul16_r+1
+    sub
+    popinh
+    jnn @l_mul16_51
+#l_mul16_50
+    pushext @v_mul16_a
+    pushext @v_mul16_r
+    add
+    pushimm 0x01
+    add
+    popext @v_mul16_r
+    jnz @l_mul16_52
+    jnn @l_mul16_52
+#l_mul16_48
+    pushimm 0x00
+    pushext @v_mul16_a+1
+    add
+    popinh
+    jnn @l_mul16_49
+    jnz @l_mul16_50
+#l_mul16_51
+    pushext @v_mul16_a
+    pushext @v_mul16_r
+    add
+    popext @v_mul16_r
+#l_mul16_52
+    pushimm 0x00
+    pushext @v_mul16_b
+    add
+    popinh
+    pushimm 0x00
+    jnn @l_mul16_53
+    pushext @v_mul16_a+1
+    add
+#l_mul16_53
+    popext @v_mul16_t
+    pushext @v_mul16_t
+    pushext @v_mul16_t
+    pushext @v_mul16_b
+    pushext @v_mul16_b
+    add
+    popext @v_mul16_b
+    jnn @l_mul16_54
+    pushext @v_mul16_a+1
+    add
+#l_mul16_54
+    add
+    popext @v_mul16_t
+    pushext @v_mul16_t
+    pushext @v_mul16_t
+    pushext @v_mul16_b
+    pushext @v_mul16_b
+    add
+    popext @v_mul16_b
+    jnn @l_mul16_55
+    pushext @v_mul16_a+1
+    add
+#l_mul16_55
+    add
+    popext @v_mul16_t
+    pushext @v_mul16_t
+    pushext @v_mul16_t
+    pushext @v_mul16_b
+    pushext @v_mul16_b
+    add
+    popext @v_mul16_b
+    jnn @l_mul16_56
+    pushext @v_mul16_a+1
+    add
+#l_mul16_56
+    add
+    popext @v_mul16_t
+    pushext @v_mul16_t
+    pushext @v_mul16_t
+    pushext @v_mul16_b
+    pushext @v_mul16_b
+    add
+    popext @v_mul16_b
+    jnn @l_mul16_57
+    pushext @v_mul16_a+1
+    add
+#l_mul16_57
+    add
+    popext @v_mul16_t
+    pushext @v_mul16_t
+    pushext @v_mul16_t
+    pushext @v_mul16_b
+    pushext @v_mul16_b
+    add
+    popext @v_mul16_b
+    jnn @l_mul16_58
+    pushext @v_mul16_a+1
+    add
+#l_mul16_58
+    add
+    popext @v_mul16_t
+    pushext @v_mul16_t
+    pushext @v_mul16_t
+    pushext @v_mul16_b
+    pushext @v_mul16_b
+    add
+    popext @v_mul16_b
+    jnn @l_mul16_59
+    pushext @v_mul16_a+1
+    add
+#l_mul16_59
+    add
+    popext @v_mul16_t
+    pushext @v_mul16_t
+    pushext @v_mul16_t
+    pushext @v_mul16_b
+    pushext @v_mul16_b
+    add
+    popext @v_mul16_b
+    jnn @l_mul16_60
+    pushext @v_mul16_a+1
+    add
+#l_mul16_60
+    add
+    pushext @v_mul16_r
+    add
+    popext @v_mul16_a
+    pushext @v_mul16_r+1
+    popext @v_mul16_a+1
+    jnz @r_mul16
+#l_mul16_ret
+    pushimm 0x00
+    popext 0xFFFB
+#r_mul16
+    jnz 0x0000
+#v_mul16_a 0x00
+    0x00
+#v_mul16_b 0x00
+    0x00
+#v_mul16_r 0x00
+    0x00
+#v_mul16_t 0x00
@@ -0,0 +1,39 @@
+; mul8: a * b, 8-bit, looped
+#f_mul8
+    pushimm 0x00
+    pushext @v_mul8_b
+    add
+    popinh
+    pushimm 0x00
+    jnn @l_mul8_1
+    pushext @v_mul8_a
+    add
+#l_mul8_1
+    popext @v_mul8_r
+    pushimm 0x06
+    popext @v_mul8_i
+#l_mul8_2
+    pushext @v_mul8_r
+    pushext @v_mul8_r
+    pushext @v_mul8_b
+    pushext @v_mul8_b
+    add
+    popext @v_mul8_b
+    jnn @l_mul8_3
+    pushext @v_mul8_a
+    add
+#l_mul8_3
+    add
+    popext @v_mul8_r
+    pushext @v_mul8_i
+    pushimm 0xFF
+    add
+    popext @v_mul8_i
+    jnn @l_mul8_2
+    pushext @v_mul8_r
+#r_mul8
+    jnz 0x0000
+#v_mul8_a 0x00
+#v_mul8_b 0x00
+#v_mul8_r 0x00
+#v_mul8_i 0x00
@@ -0,0 +1,104 @@
+; mul8: a * b, 8-bit, unrolled
+#f_mul8
+    pushimm 0x00
+    pushext @v_mul8_b
+    add
+    popinh
+    pushimm 0x00
+    jnn @l_mul8_1
+    pushext @v_mul8_a
+    add
+#l_mul8_1
+    popext @v_mul8_r
+    pushext @v_mul8_r
+    pushext @v_mul8_r
+    pushext @v_mul8_b
+    pushext @v_mul8_b
+    add
+    popext @v_mul8_b
+    jnn @l_mul8_2
+    pushext @v_mul8_a
+    add
+#l_mul8_2
+    add
+    popext @v_mul8_r
+    pushext @v_mul8_r
+    pushext @v_mul8_r
+    pushext @v_mul8_b
+    pushext @v_mul8_b
+    add
+    popext @v_mul8_b
+    jnn @l_mul8_3
+    pushext @v_mul8_a
+    add
+#l_mul8_3
+    add
+    popext @v_mul8_r
+    pushext @v_mul8_r
+    pushext @v_mul8_r
+    pushext @v_mul8_b
+    pushext @v_mul8_b
+    add
+    popext @v_mul8_b
+    jnn @l_mul8_4
+    pushext @v_mul8_a
+    add
+#l_mul8_4
+    add
+    popext @v_mul8_r
+    pushext @v_mul8_r
+    pushext @v_mul8_r
+    pushext @v_mul8_b
+    pushext @v_mul8_b
+    add
+    popext @v_mul8_b
+    jnn @l_mul8_5
+    pushext @v_mul8_a
+    add
+#l_mul8_5
+    add
+    popext @v_mul8_r
+    pushext @v_mul8_r
+    pushext @v_mul8_r
+    pushext @v_mul8_b
+    pushext @v_mul8_b
+    add
+    popext @v_mul8_b
+    jnn @l_mul8_6
+    pushext @v_mul8_a
+    add
+#l_mul8_6
+    add
+    popext @v_mul8_r
+    pushext @v_mul8_r
+    pushext @v_mul8_r
+    pushext @v_mul8_b
+    pushext @v_mul8_b
+    add
+    popext @v_mul8_b
+    jnn @l_mul8_7
+    pushext @v_mul8_a
+    add
+#l_mul8_7
+    add
+    popext @v_mul8_r
+    pushext @v_mul8_r
+    pushext @v_mul8_r
+    pushext @v_mul8_b
+    pushext @v_mul8_b
+    add
+    popext @v_mul8_b
+    jnn @l_mul8_8
+    pushext @v_mul8_a
+    add
+#l_mul8_8
+    add
+    jnz @r_mul8
+#l_mul8_ret
+    pushimm 0x00
+    popext 0xFFFB
+#r_mul8
+    jnz 0x0000
+#v_mul8_a 0x00
+#v_mul8_b 0x00
+#v_mul8_r 0x00
@@ -0,0 +1,61 @@
+; shl16: a << b, 16-bit, looped
+#f_shl16
+    pushext @v_shl16_b
+    pushext @v_shl16_b
+    nor
+    pushimm 0x0F
+    nor
+    pushimm 0x00
+    add
+    popinh
+    jnz @l_shl16_1
+    pushimm 0xF8
+    pushext @v_shl16_b
+    add
+    jnn @l_shl16_3
+    popinh
+#l_shl16_2
+    jnz @l_shl16_5
+    jnn @l_shl16_5
+#l_shl16_4
+    pushimm 0x00
+    pushext @v_shl16_a+1
+    add
+    popinh
+    pushext @v_shl16_a
+    pushext @v_shl16_a
+    jnn @l_shl16_6
+    pushimm 0x01
+    add
+#l_shl16_6
+    add
+    popext @v_shl16_a
+    pushext @v_shl16_a+1
+    pushext @v_shl16_a+1
+    add
+    popext @v_shl16_a+1
+#l_shl16_5
+    pushext @v_shl16_b
+    pushimm 0xFF
+    add
+    popext @v_shl16_b
+    jnn @l_shl16_4
+#r_shl16
+    jnz 0x0000
+#l_shl16_3
+    popext @v_shl16_b
+    pushext @v_shl16_a+1
+    popext @v_shl16_a
+    pushimm 0x00
+    popext @v_shl16_a+1
+    jnz @l_shl16_2
+    jnn @l_shl16_2
+#l_shl16_1
+    pushimm 0x00
+    popext @v_shl16_a
+    pushimm 0x00
+    popext @v_shl16_a+1
+    jnz @r_shl16
+#v_shl16_a 0x00
+    0x00
+#v_shl16_b 0x00
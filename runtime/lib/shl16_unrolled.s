@@ -0,0 +1,225 @@
+; shl16: a << b, 16-bit, unrolled
+#f_shl16
+    pushext @v_shl16_b
+    pushext @v_shl16_b
+    nor
+    pushimm 0x0F
+    nor
+    pushimm 0x00
+    add
+    popinh
+    jnz @l_shl16_1
+    pushimm 0xF8
+    pushext @v_shl16_b
+    add
+    jnn @l_shl16_3
+    popinh
+#l_shl16_2
+    pushimm 0xFC
+    pushext @v_shl16_b
+    add
+    popinh
+    jnn @l_shl16_20
+    pushimm 0xFE
+    pushext @v_shl16_b
+    add
+    popinh
+    jnn @l_shl16_21
+    pushimm 0xFF
+    pushext @v_shl16_b
+    add
+    popinh
+    jnn @l_shl16_6
+    jnz @l_shl16_4
+#l_shl16_21
+    pushimm 0xFD
+    pushext @v_shl16_b
+    add
+    popinh
+    jnn @l_shl16_10
+    jnz @l_shl16_8
+#l_shl16_20
+    pushimm 0xFA
+    pushext @v_shl16_b
+    add
+    popinh
+    jnn @l_shl16_22
+    pushimm 0xFB
+    pushext @v_shl16_b
+    add
+    popinh
+    jnn @l_shl16_14
+    jnz @l_shl16_12
+#l_shl16_22
+    pushimm 0xF9
+    pushext @v_shl16_b
+    add
+    popinh
+    jnn @l_shl16_18
+    jnz @l_shl16_16
+#l_shl16_19
+    pushext @v_shl16_a
+    pushext @v_shl16_a
+    jnn @l_shl16_23
+    pushimm 0x01
+    add
+#l_shl16_23
+    add
+    popext @v_shl16_a
+    pushext @v_shl16_a+1
+    pushext @v_shl16_a+1
+    add
+    popext @v_shl16_a+1
+#l_shl16_17
+    pushext @v_shl16_a
+    pushext @v_shl16_a
+    jnn @l_shl16_24
+    pushimm 0x01
+    add
+#l_shl16_24
+    add
+    popext @v_shl16_a
+    pushext @v_shl16_a+1
+    pushext @v_shl16_a+1
+    add
+    popext @v_shl16_a+1
+#l_shl16_15
+    pushext @v_shl16_a
+    pushext @v_shl16_a
+    jnn @l_shl16_25
+    pushimm 0x01
+    add
+#l_shl16_25
+    add
+    popext @v_shl16_a
+    pushext @v_shl16_a+1
+    pushext @v_shl16_a+1
+    add
+    popext @v_shl16_a+1
+#l_shl16_13
+    pushext @v_shl16_a
+    pushext @v_shl16_a
+    jnn @l_shl16_26
+    pushimm 0x01
+    add
+#l_shl16_26
+    add
+    popext @v_shl16_a
+    pushext @v_shl16_a+1
+    pushext @v_shl16_a+1
+    add
+    popext @v_shl16_a+1
+#l_shl16_11
+    pushext @v_shl16_a
+    pushext @v_shl16_a
+    jnn @l_shl16_27
+    pushimm 0x01
+    add
+#l_shl16_27
+    add
+    popext @v_shl16_a
+    pushext @v_shl16_a+1
+    pushext @v_shl16_a+1
+    add
+    popext @v_shl16_a+1
+#l_shl16_9
+    pushext @v_shl16_a
+    pushext @v_shl16_a
+    jnn @l_shl16_28
+    pushimm 0x01
+    add
+#l_shl16_28
+    add
+    popext @v_shl16_a
+    pushext @v_shl16_a+1
+    pushext @v_shl16_a+1
+    add
+    popext @v_shl16_a+1
+#l_shl16_7
+    pushext @v_shl16_a
+    pushext @v_shl16_a
+    jnn @l_shl16_29
+    pushimm 0x01
+    add
+#l_shl16_29
+    add
+    popext @v_shl16_a
+    pushext @v_shl16_a+1
+    pushext @v_shl16_a+1
+    add
+    popext @v_shl16_a+1
+    jnz @r_shl16
+#l_shl16_ret
+    pushimm 0x00
+    popext 0xFFFB
+#r_shl16
+    jnz 0x0000
+#l_shl16_3
+    popext @v_shl16_b
+    pushext @v_shl16_a+1
+    popext @v_shl16_a
+    pushimm 0x00
+    popext @v_shl16_a+1
+    jnz @l_shl16_2
+    jnn @l_shl16_2
+#l_shl16_1
+    pushimm 0x00
+    popext @v_shl16_a
+    pushimm 0x00
+    popext @v_shl16_a+1
+    jnz @r_shl16
+#l_shl16_4
+    jnz @r_shl16
+    jnn @l_shl16_ret
+#l_shl16_6
+    pushimm 0x00
+    pushext @v_shl16_a+1
+    add
+    popinh
+    jnz @l_shl16_7
+    jnn @l_shl16_7
+#l_shl16_8
+    pushimm 0x00
+    pushext @v_shl16_a+1
+    add
+    popinh
+    jnz @l_shl16_9
+    jnn @l_shl16_9
+#l_shl16_10
+    pushimm 0x00
+    pushext @v_shl16_a+1
+    add
+    popinh
+    jnz @l_shl16_11
+    jnn @l_shl16_11
+#l_shl16_12
+    pushimm 0x00
+    pushext @v_shl16_a+1
+    add
+    popinh
+    jnz @l_shl16_13
+    jnn @l_shl16_13
+#l_shl16_14
+    pushimm 0x00
+    pushext @v_shl16_a+1
+    add
+    popinh
+    jnz @l_shl16_15
+    jnn @l_shl16_15
+#l_shl16_16
+    pushimm 0x00
+    pushext @v_shl16_a+1
+    add
+    popinh
+    jnz @l_shl16_17
+    jnn @l_shl16_17
+#l_shl16_18
+    pushimm 0x00
+    pushext @v_shl16_a+1
+    add
+    popinh
+    jnz @l_shl16_19
+    jnn @l_shl16_19
+#v_shl16_a 0x00
+    0x00
+#v_shl16_b 0x00
@@ -0,0 +1,31 @@
+; shl8: a << b, 8-bit, looped
+#f_shl8
+    pushext @v_shl8_b
+    pushext @v_shl8_b
+    nor
+    pushimm 0x07
+    nor
+    pushimm 0x00
+    add
+    popinh
+    jnz @l_shl8_1
+    jnn @l_shl8_3
+#l_shl8_2
+    pushext @v_shl8_a
+    pushext @v_shl8_a
+    add
+    popext @v_shl8_a
+#l_shl8_3
+    pushext @v_shl8_b
+    pushimm 0xFF
+    add
+    popext @v_shl8_b
+    jnn @l_shl8_2
+    pushext @v_shl8_a
+#r_shl8
+    jnz 0x0000
+#l_shl8_1
+    pushimm 0x00
+    jnz @r_shl8
+#v_shl8_a 0x00
+#v_shl8_b 0x00
@@ -0,0 +1,102 @@
+; shl8: a << b, 8-bit, unrolled
+#f_shl8
+    pushext @v_shl8_b
+    pushext @v_shl8_b
+    nor
+    pushimm 0x07
+    nor
+    pushimm 0x00
+    add
+    popinh
+    jnz @l_shl8_1
+    pushimm 0xFC
+    pushext @v_shl8_b
+    add
+    popinh
+    jnn @l_shl8_10
+    pushimm 0xFE
+    pushext @v_shl8_b
+    add
+    popinh
+    jnn @l_shl8_11
+    pushimm 0xFF
+    pushext @v_shl8_b
+    add
+    popinh
+    jnn @l_shl8_3
+    jnz @l_shl8_2
+#l_shl8_11
+    pushimm 0xFD
+    pushext @v_shl8_b
+    add
+    popinh
+    jnn @l_shl8_5
+    jnz @l_shl8_4
+#l_shl8_10
+    pushimm 0xFA
+    pushext @v_shl8_b
+    add
+    popinh
+    jnn @l_shl8_12
+    pushimm 0xFB
+    pushext @v_shl8_b
+    add
+    popinh
+    jnn @l_shl8_7
+    jnz @l_shl8_6
+#l_shl8_12
+    pushimm 0xF9
+    pushext @v_shl8_b
+    add
+    popinh
+    jnn @l_shl8_9
+    jnz @l_shl8_8
+#l_shl8_9
+    pushext @v_shl8_a
+    pushext @v_shl8_a
+    add
+    popext @v_shl8_a
+#l_shl8_8
+    pushext @v_shl8_a
+    pushext @v_shl8_a
+    add
+    popext @v_shl8_a
+#l_shl8_7
+    pushext @v_shl8_a
+    pushext @v_shl8_a
+    add
+    popext @v_shl8_a
+#l_shl8_6
+    pushext @v_shl8_a
+    pushext @v_shl8_a
+    add
+    popext @v_shl8_a
+#l_shl8_5
+    pushext @v_shl8_a
+    pushext @v_shl8_a
+    add
+    popext @v_shl8_a
+#l_shl8_4
+    pushext @v_shl8_a
+    pushext @v_shl8_a
+    add
+    popext @v_shl8_a
+#l_shl8_3
+    pushext @v_shl8_a
+    pushext @v_shl8_a
+    add
+    jnz @r_shl8
+#l_shl8_ret
+    pushimm 0x00
+    popext 0xFFFB
+#r_shl8
+    jnz 0x0000
+#l_shl8_1
+    pushimm 0x00
+    jnz @r_shl8
+#l_shl8_2
+    pushext @v_shl8_a
+    jnz @r_shl8
+    jnn @l_shl8_ret
+#v_shl8_a 0x00
+#v_shl8_b 0x00
@@ -0,0 +1,94 @@
+; shr16: a >> b, 16-bit, looped
+#f_shr16
+    pushimm 0x00
+    pushext @v_shr16_a
+    add
+    popinh
+    pushimm 0x00
+    jnn @l_shr16_1
+    pushimm 0xFF
+    add
+#l_shr16_1
+    popext @v_shr16_t
+    pushext @v_shr16_b
+    pushext @v_shr16_b
+    nor
+    pushimm 0x0F
+    nor
+    pushimm 0x00
+    add
+    popinh
+    jnz @l_shr16_2
+    pushimm 0xF8
+    pushext @v_shr16_b
+    add
+    jnn @l_shr16_4
+    popinh
+#l_shr16_3
+    pushext @v_shr16_b
+    pushimm 0x08
+    sub
+    popext @v_shr16_i
+    jnz @l_shr16_7
+    jnn @l_shr16_7
+#l_shr16_6
+    pushimm 0x00
+    pushext @v_shr16_a+1
+    add
+    popinh
+    pushext @v_shr16_a
+    pushext @v_shr16_a
+    jnn @l_shr16_8
+    pushimm 0x01
+    add
+#l_shr16_8
+    add
+    pushimm 0x00
+    pushext @v_shr16_a
+    add
+    popinh
+    pushext @v_shr16_t
+    pushext @v_shr16_t
+    jnn @l_shr16_9
+    pushimm 0x01
+    add
+#l_shr16_9
+    add
+    popext @v_shr16_t
+    popext @v_shr16_a
+    pushext @v_shr16_a+1
+    pushext @v_shr16_a+1
+    add
+    popext @v_shr16_a+1
+#l_shr16_7
+    pushext @v_shr16_i
+    pushimm 0xFF
+    add
+    popext @v_shr16_i
+    jnn @l_shr16_6
+#l_shr16_5
+    pushext @v_shr16_a
+    popext @v_shr16_a+1
+    pushext @v_shr16_t
+    popext @v_shr16_a
+#r_shr16
+    jnz 0x0000
+#l_shr16_4
+    popext @v_shr16_b
+    pushext @v_shr16_a
+    popext @v_shr16_a+1
+    pushext @v_shr16_t
+    popext @v_shr16_a
+    jnz @l_shr16_3
+    jnn @l_shr16_3
+#l_shr16_2
+    pushext @v_shr16_t
+    popext @v_shr16_a
+    pushext @v_shr16_t
+    popext @v_shr16_a+1
+    jnz @r_shr16
+#v_shr16_a 0x00
+    0x00
+#v_shr16_b 0x00
+#v_shr16_t 0x00
+#v_shr16_i 0x00
@@ -0,0 +1,321 @@
+; shr16: a >> b, 16-bit, unrolled
+#f_shr16
+    pushimm 0x00
+    pushext @v_shr16_a
+    add
+    popinh
+    pushimm 0x00
+    jnn @l_shr16_1
+    pushimm 0xFF
+    add
+#l_shr16_1
+    popext @v_shr16_t
+    pushext @v_shr16_b
+    pushext @v_shr16_b
+    nor
+    pushimm 0x0F
+    nor
+    pushimm 0x00
+    add
+    popinh
+    jnz @l_shr16_2
+    pushimm 0xF8
+    pushext @v_shr16_b
+    add
+    jnn @l_shr16_4
+    popinh
+#l_shr16_3
+    pushimm 0xFC
+    pushext @v_shr16_b
+    add
+    popinh
+    jnn @l_shr16_22
+    pushimm 0xFE
+    pushext @v_shr16_b
+    add
+    popinh
+    jnn @l_shr16_23
+    pushimm 0xFF
+    pushext @v_shr16_b
+    add
+    popinh
+    jnn @l_shr16_8
+    jnz @l_shr16_6
+#l_shr16_23
+    pushimm 0xFD
+    pushext @v_shr16_b
+    add
+    popinh
+    jnn @l_shr16_12
+    jnz @l_shr16_10
+#l_shr16_22
+    pushimm 0xFA
+    pushext @v_shr16_b
+    add
+    popinh
+    jnn @l_shr16_24
+    pushimm 0xFB
+    pushext @v_shr16_b
+    add
+    popinh
+    jnn @l_shr16_16
+    jnz @l_shr16_14
+#l_shr16_24
+    pushimm 0xF9
+    pushext @v_shr16_b
+    add
+    popinh
+    jnn @l_shr16_20
+    jnz @l_shr16_18
+#l_shr16_9
+    pushext @v_shr16_a
+    pushext @v_shr16_a
+    jnn @l_shr16_25
+    pushimm 0x01
+    add
+#l_shr16_25
+    add
+    pushimm 0x00
+    pushext @v_shr16_a
+    add
+    popinh
+    pushext @v_shr16_t
+    pushext @v_shr16_t
+    jnn @l_shr16_26
+    pushimm 0x01
+    add
+#l_shr16_26
+    add
+    popext @v_shr16_t
+    popext @v_shr16_a
+    pushext @v_shr16_a+1
+    pushext @v_shr16_a+1
+    add
+    popext @v_shr16_a+1
+#l_shr16_11
+    pushext @v_shr16_a
+    pushext @v_shr16_a
+    jnn @l_shr16_27
+    pushimm 0x01
+    add
+#l_shr16_27
+    add
+    pushimm 0x00
+    pushext @v_shr16_a
+    add
+    popinh
+    pushext @v_shr16_t
+    pushext @v_shr16_t
+    jnn @l_shr16_28
+    pushimm 0x01
+    add
+#l_shr16_28
+    add
+    popext @v_shr16_t
+    popext @v_shr16_a
+    pushext @v_shr16_a+1
+    pushext @v_shr16_a+1
+    add
+    popext @v_shr16_a+1
+#l_shr16_13
+    pushext @v_shr16_a
+    pushext @v_shr16_a
+    jnn @l_shr16_29
+    pushimm 0x01
+    add
+#l_shr16_29
+    add
+    pushimm 0x00
+    pushext @v_shr16_a
+    add
+    popinh
+    pushext @v_shr16_t
+    pushext @v_shr16_t
+    jnn @l_shr16_30
+    pushimm 0x01
+    add
+#l_shr16_30
+    add
+    popext @v_shr16_t
+    popext @v_shr16_a
+    pushext @v_shr16_a+1
+    pushext @v_shr16_a+1
+    add
+    popext @v_shr16_a+1
+#l_shr16_15
+    pushext @v_shr16_a
+    pushext @v_shr16_a
+    jnn @l_shr16_31
+    pushimm 0x01
+    add
+#l_shr16_31
+    add
+    pushimm 0x00
+    pushext @v_shr16_a
+    add
+    popinh
+    pushext @v_shr16_t
+    pushext @v_shr16_t
+    jnn @l_shr16_32
+    pushimm 0x01
+    add
+#l_shr16_32
+    add
+    popext @v_shr16_t
+    popext @v_shr16_a
+    pushext @v_shr16_a+1
+    pushext @v_shr16_a+1
+    add
+    popext @v_shr16_a+1
+#l_shr16_17
+    pushext @v_shr16_a
+    pushext @v_shr16_a
+    jnn @l_shr16_33
+    pushimm 0x01
+    add
+#l_shr16_33
+    add
+    pushimm 0x00
+    pushext @v_shr16_a
+    add
+    popinh
+    pushext @v_shr16_t
+    pushext @v_shr16_t
+    jnn @l_shr16_34
+    pushimm 0x01
+    add
+#l_shr16_34
+    add
+    popext @v_shr16_t
+    popext @v_shr16_a
+    pushext @v_shr16_a+1
+    pushext @v_shr16_a+1
+    add
+    popext @v_shr16_a+1
+#l_shr16_19
+    pushext @v_shr16_a
+    pushext @v_shr16_a
+    jnn @l_shr16_35
+    pushimm 0x01
+    add
+#l_shr16_35
+    add
+    pushimm 0x00
+    pushext @v_shr16_a
+    add
+    popinh
+    pushext @v_shr16_t
+    pushext @v_shr16_t
+    jnn @l_shr16_36
+    pushimm 0x01
+    add
+#l_shr16_36
+    add
+    popext @v_shr16_t
+    popext @v_shr16_a
+    pushext @v_shr16_a+1
+    pushext @v_shr16_a+1
+    add
+    popext @v_shr16_a+1
+#l_shr16_21
+    pushext @v_shr16_a
+    pushext @v_shr16_a
+    jnn @l_shr16_37
+    pushimm 0x01
+    add
+#l_shr16_37
+    add
+    pushimm 0x00
+    pushext @v_shr16_a
+    add
+    popinh
+    pushext @v_shr16_t
+    pushext @v_shr16_t
+    jnn @l_shr16_38
+    pushimm 0x01
+    add
+#l_shr16_38
+    add
+    popext @v_shr16_t
+    popext @v_shr16_a
+#l_shr16_5
+    pushext @v_shr16_a
+    popext @v_shr16_a+1
+    pushext @v_shr16_t
+    popext @v_shr16_a
+    jnz @r_shr16
+#l_shr16_ret
+    pushimm 0x00
+    popext 0xFFFB
+#r_shr16
+    jnz 0x0000
+#l_shr16_4
+    popext @v_shr16_b
+    pushext @v_shr16_a
+    popext @v_shr16_a+1
+    pushext @v_shr16_t
+    popext @v_shr16_a
+    jnz @l_shr16_3
+    jnn @l_shr16_3
+#l_shr16_2
+    pushext @v_shr16_t
+    popext @v_shr16_a
+    pushext @v_shr16_t
+    popext @v_shr16_a+1
+    jnz @r_shr16
+#l_shr16_6
+    jnz @r_shr16
+    jnn @l_shr16_ret
+#l_shr16_8
+    pushimm 0x00
+    pushext @v_shr16_a+1
+    add
+    popinh
+    jnz @l_shr16_9
+    jnn @l_shr16_9
+#l_shr16_10
+    pushimm 0x00
+    pushext @v_shr16_a+1
+    add
+    popinh
+    jnz @l_shr16_11
+    jnn @l_shr16_11
+#l_shr16_12
+    pushimm 0x00
+    pushext @v_shr16_a+1
+    add
+    popinh
+    jnz @l_shr16_13
+    jnn @l_shr16_13
+#l_shr16_14
+    pushimm 0x00
+    pushext @v_shr16_a+1
+    add
+    popinh
+    jnz @l_shr16_15
+    jnn @l_shr16_15
+#l_shr16_16
+    pushimm 0x00
+    pushext @v_shr16_a+1
+    add
+    popinh
+    jnz @l_shr16_17
+    jnn @l_shr16_17
+#l_shr16_18
+    pushimm 0x00
+    pushext @v_shr16_a+1
+    add
+    popinh
+    jnz @l_shr16_19
+    jnn @l_shr16_19
+#l_shr16_20
+    pushimm 0x00
+    pushext @v_shr16_a+1
+    add
+    popinh
+    jnz @l_shr16_21
+    jnn @l_shr16_21
+#v_shr16_a 0x00
+    0x00
+#v_shr16_b 0x00
+#v_shr16_t 0x00
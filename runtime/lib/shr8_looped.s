@@ -0,0 +1,55 @@
+; shr8: a >> b, 8-bit, looped
+#f_shr8
+    pushimm 0x00
+    pushext @v_shr8_a
+    add
+    popinh
+    pushimm 0x00
+    jnn @l_shr8_1
+    pushimm 0xFF
+    add
+#l_shr8_1
+    popext @v_shr8_r
+    pushext @v_shr8_b
+    pushext @v_shr8_b
+    nor
+    pushimm 0x07
+    nor
+    pushimm 0x00
+    add
+    popinh
+    jnz @l_shr8_2
+    pushext @v_shr8_b
+    pushimm 0x07
+    sub
+    popext @v_shr8_i
+    jnn @l_shr8_4
+#l_shr8_3
+    pushext @v_shr8_r
+    pushext @v_shr8_r
+    pushext @v_shr8_a
+    pushext @v_shr8_a
+    add
+    popext @v_shr8_a
+    jnn @l_shr8_5
+    pushimm 0x01
+    add
+#l_shr8_5
+    add
+    popext @v_shr8_r
+#l_shr8_4
+    pushext @v_shr8_i
+    pushimm 0xFF
+    add
+    popext @v_shr8_i
+    jnn @l_shr8_3
+    pushext @v_shr8_r
+#r_shr8
+    jnz 0x0000
+#l_shr8_2
+    pushext @v_shr8_r
+    jnz @r_shr8
+#v_shr8_a 0x00
+#v_shr8_b 0x00
+#v_shr8_r 0x00
+#v_shr8_i 0x00
@@ -0,0 +1,160 @@
+; shr8: a >> b, 8-bit, unrolled
+#f_shr8
+    pushimm 0x00
+    pushext @v_shr8_a
+    add
+    popinh
+    pushimm 0x00
+    jnn @l_shr8_1
+    pushimm 0xFF
+    add
+#l_shr8_1
+    popext @v_shr8_r
+    pushext @v_shr8_b
+    pushext @v_shr8_b
+    nor
+    pushimm 0x07
+    nor
+    pushimm 0x00
+    add
+    popinh
+    jnz @l_shr8_2
+    pushimm 0xFC
+    pushext @v_shr8_b
+    add
+    popinh
+    jnn @l_shr8_11
+    pushimm 0xFE
+    pushext @v_shr8_b
+    add
+    popinh
+    jnn @l_shr8_12
+    pushimm 0xFF
+    pushext @v_shr8_b
+    add
+    popinh
+    jnn @l_shr8_4
+    jnz @l_shr8_3
+#l_shr8_12
+    pushimm 0xFD
+    pushext @v_shr8_b
+    add
+    popinh
+    jnn @l_shr8_6
+    jnz @l_shr8_5
+#l_shr8_11
+    pushimm 0xFA
+    pushext @v_shr8_b
+    add
+    popinh
+    jnn @l_shr8_13
+    pushimm 0xFB
+    pushext @v_shr8_b
+    add
+    popinh
+    jnn @l_shr8_8
+    jnz @l_shr8_7
+#l_shr8_13
+    pushimm 0xF9
+    pushext @v_shr8_b
+    add
+    popinh
+    jnn @l_shr8_10
+    jnz @l_shr8_9
+#l_shr8_4
+    pushext @v_shr8_r
+    pushext @v_shr8_r
+    pushext @v_shr8_a
+    pushext @v_shr8_a
+    add
+    popext @v_shr8_a
+    jnn @l_shr8_14
+    pushimm 0x01
+    add
+#l_shr8_14
+    add
+    popext @v_shr8_r
+#l_shr8_5
+    pushext @v_shr8_r
+    pushext @v_shr8_r
+    pushext @v_shr8_a
+    pushext @v_shr8_a
+    add
+    popext @v_shr8_a
+    jnn @l_shr8_15
+    pushimm 0x01
+    add
+#l_shr8_15
+    add
+    popext @v_shr8_r
+#l_shr8_6
+    pushext @v_shr8_r
+    pushext @v_shr8_r
+    pushext @v_shr8_a
+    pushext @v_shr8_a
+    add
+    popext @v_shr8_a
+    jnn @l_shr8_16
+    pushimm 0x01
+    add
+#l_shr8_16
+    add
+    popext @v_shr8_r
+#l_shr8_7
+    pushext @v_shr8_r
+    pushext @v_shr8_r
+    pushext @v_shr8_a
+    pushext @v_shr8_a
+    add
+    popext @v_shr8_a
+    jnn @l_shr8_17
+    pushimm 0x01
+    add
+#l_shr8_17
+    add
+    popext @v_shr8_r
+#l_shr8_8
+    pushext @v_shr8_r
+    pushext @v_shr8_r
+    pushext @v_shr8_a
+    pushext @v_shr8_a
+    add
+    popext @v_shr8_a
+    jnn @l_shr8_18
+    pushimm 0x01
+    add
+#l_shr8_18
+    add
+    popext @v_shr8_r
+#l_shr8_9
+    pushext @v_shr8_r
+    pushext @v_shr8_r
+    pushext @v_shr8_a
+    pushext @v_shr8_a
+    add
+    popext @v_shr8_a
+    jnn @l_shr8_19
+    pushimm 0x01
+    add
+#l_shr8_19
+    add
+    jnz @r_shr8
+#l_shr8_ret
+    pushimm 0x00
+    popext 0xFFFB
+#r_shr8
+    jnz 0x0000
+#l_shr8_2
+    pushext @v_shr8_r
+    jnz @r_shr8
+#l_shr8_3
+    pushext @v_shr8_a
+    jnz @r_shr8
+    jnn @l_shr8_ret
+#l_shr8_10
+    pushext @v_shr8_r
+    jnz @r_shr8
+    jnn @l_shr8_ret
+#v_shr8_a 0x00
+#v_shr8_b 0x00
+#v_shr8_r 0x00
@@ -0,0 +1,84 @@
+; ucmp16: a <=> b unsigned, 16-bit
+#f_ucmp16
+    pushext @v_ucmp16_b
+    pushext @v_ucmp16_a
+    sub
+    jnz @l_ucmp16_1
+    popinh
+    pushext @v_ucmp16_b+1
+    pushext @v_ucmp16_a+1
+    sub
+    jnz @l_ucmp16_2
+#l_ucmp16_ret
+    pushimm 0x00
+    popext 0xFFFB
+#r_ucmp16
+    jnz 0x0000
+#l_ucmp16_1
+    popinh
+    pushimm 0x00
+    pushext @v_ucmp16_a
+    add
+    popinh
+    jnn @l_ucmp16_5
+    pushimm 0x00
+    pushext @v_ucmp16_b
+    add
+    popinh
+    jnn @l_ucmp16_4
+    jnz @l_ucmp16_6
+#l_ucmp16_5
+    pushimm 0x00
+    pushext @v_ucmp16_b
+    add
+    popinh
+    jnn @l_ucmp16_6
+    jnz @l_ucmp16_3
+#l_ucmp16_6
+    pushext @v_ucmp16_b
+    pushext @v_ucmp16_a
+    sub
+    popinh
+    jnn @l_ucmp16_4
+    jnz @l_ucmp16_3
+#l_ucmp16_2
+    popinh
+    pushimm 0x00
+    pushext @v_ucmp16_a+1
+    add
+    popinh
+    jnn @l_ucmp16_7
+    pushimm 0x00
+    pushext @v_ucmp16_b+1
+    add
+    popinh
+    jnn @l_ucmp16_4
+    jnz @l_ucmp16_8
+#l_ucmp16_7
+    pushimm 0x00
+    pushext @v_ucmp16_b+1
+    add
+    popinh
+    jnn @l_ucmp16_8
+    jnz @l_ucmp16_3
+#l_ucmp16_8
+    pushext @v_ucmp16_b+1
+    pushext @v_ucmp16_a+1
+    sub
+    popinh
+    jnn @l_ucmp16_4
+    jnz @l_ucmp16_3
+#l_ucmp16_3
+    pushimm 0xFF
+    pushimm 0x40
+    popext 0xFFFB
+    jnz @r_ucmp16
+#l_ucmp16_4
+    pushimm 0x01
+    pushimm 0x00
+    popext 0xFFFB
+    jnz @r_ucmp16
+#v_ucmp16_a 0x00
+    0x00
+#v_ucmp16_b 0x00
+    0x00
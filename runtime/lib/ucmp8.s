@@ -0,0 +1,50 @@
+; ucmp8: a <=> b unsigned, 8-bit
+#f_ucmp8
+    pushext @v_ucmp8_b
+    pushext @v_ucmp8_a
+    sub
+    jnz @l_ucmp8_1
+#l_ucmp8_ret
+    pushimm 0x00
+    popext 0xFFFB
+#r_ucmp8
+    jnz 0x0000
+#l_ucmp8_1
+    popinh
+    pushimm 0x00
+    pushext @v_ucmp8_a
+    add
+    popinh
+    jnn @l_ucmp8_4
+    pushimm 0x00
+    pushext @v_ucmp8_b
+    add
+    popinh
+    jnn @l_ucmp8_3
+    jnz @l_ucmp8_5
+#l_ucmp8_4
+    pushimm 0x00
+    pushext @v_ucmp8_b
+    add
+    popinh
+    jnn @l_ucmp8_5
+    jnz @l_ucmp8_2
+#l_ucmp8_5
+    pushext @v_ucmp8_b
+    pushext @v_ucmp8_a
+    sub
+    popinh
+    jnn @l_ucmp8_3
+    jnz @l_ucmp8_2
+#l_ucmp8_2
+    pushimm 0xFF
+    pushimm 0x40
+    popext 0xFFFB
+    jnz @r_ucmp8
+#l_ucmp8_3
+    pushimm 0x01
+    pushimm 0x00
+    popext 0xFFFB
+    jnz @r_ucmp8
+#v_ucmp8_a 0x00
+#v_ucmp8_b 0x00
@@ -0,0 +1,231 @@
+; udiv16: a / b, a % b unsigned, 16-bit, looped
+#f_udiv16
+    pushext @v_udiv16_a
+    popext @v_udiv16_m
+    pushext @v_udiv16_a+1
+    popext @v_udiv16_m+1
+    pushext @v_udiv16_b
+    pushext @v_udiv16_b+1
+    nor
+    pushimm 0x00
+    nor
+    pushimm 0x00
+    add
+    popinh
+    jnz @l_udiv16_1
+    pushimm 0xFF
+    popext @v_udiv16_a
+    pushimm 0xFF
+    popext @v_udiv16_a+1
+    jnz @l_udiv16_5
+    jnn @l_udiv16_5
+#l_udiv16_1
+    pushimm 0x00
+    pushext @v_udiv16_b
+    add
+    popinh
+    jnn @l_udiv16_2
+    pushimm 0x00
+    pushext @v_udiv16_a
+    add
+    popinh
+    jnn @l_udiv16_3
+    pushext @v_udiv16_b+1
+    pushext @v_udiv16_a+1
+    sub
+    popext @v_udiv16_t+1
+    pushimm 0x00
+    pushext @v_udiv16_a+1
+    add
+    popinh
+    jnn @l_udiv16_6
+    pushimm 0x00
+    pushext @v_udiv16_b+1
+    add
+    popinh
+    jnn @l_udiv16_9
+#l_udiv16_7
+    pushimm 0x00
+    pushext @v_udiv16_t+1
+    add
+    popinh
+    jnn @l_udiv16_9
+#l_udiv16_8
+    pushext @v_udiv16_b
+    pushext @v_udiv16_a
+    sub
+    pushimm 0xFF
+    add
+    popext @v_udiv16_t
+    jnz @l_udiv16_10
+    jnn @l_udiv16_10
+#l_udiv16_6
+    pushimm 0x00
+    pushext @v_udiv16_b+1
+    add
+    popinh
+    jnn @l_udiv16_7
+    jnz @l_udiv16_8
+#l_udiv16_9
+    pushext @v_udiv16_b
+    pushext @v_udiv16_a
+    sub
+    popext @v_udiv16_t
+#l_udiv16_10
+    jnn @l_udiv16_4
+#l_udiv16_3
+    pushimm 0x00
+    popext @v_udiv16_a
+    pushimm 0x00
+    popext @v_udiv16_a+1
+    jnz @l_udiv16_5
+    jnn @l_udiv16_5
+#l_udiv16_2
+    pushimm 0x00
+    popext @v_udiv16_m
+    pushimm 0x00
+    popext @v_udiv16_m+1
+    pushimm 0x0F
+    popext @v_udiv16_i
+#l_udiv16_11
+    pushimm 0x00
+    pushext @v_udiv16_a
+    add
+    popinh
+    pushext @v_udiv16_m+1
+    pushext @v_udiv16_m+1
+    jnn @l_udiv16_12
+    pushimm 0x01
+    add
+#l_udiv16_12
+    add
+    pushimm 0x00
+    pushext @v_udiv16_m+1
+    add
+    popinh
+    pushext @v_udiv16_m
+    pushext @v_udiv16_m
+    jnn @l_udiv16_13
+    pushimm 0x01
+    add
+#l_udiv16_13
+    add
+    popext @v_udiv16_m
+    popext @v_udiv16_m+1
+    pushext @v_udiv16_b+1
+    pushext @v_udiv16_m+1
+    sub
+    popext @v_udiv16_t+1
+    pushimm 0x00
+    pushext @v_udiv16_m+1
+    add
+    popinh
+    jnn @l_udiv16_16
+    pushimm 0x00
+    pushext @v_udiv16_b+1
+    add
+    popinh
+    jnn @l_udiv16_19
+#l_udiv16_17
+    pushimm 0x00
+    pushext @v_udiv16_t+1
+    add
+    popinh
+    jnn @l_udiv16_19
+#l_udiv16_18
+    pushext @v_udiv16_b
+    pushext @v_udiv16_m
+    sub
+    pushimm 0xFF
+    add
+    popext @v_udiv16_t
+    jnz @l_udiv16_20
+    jnn @l_udiv16_20
+#l_udiv16_16
+    pushimm 0x00
+    pushext @v_udiv16_b+1
+    add
+    popinh
+    jnn @l_udiv16_17
+    jnz @l_udiv16_18
+#l_udiv16_19
+    pushext @v_udiv16_b
+    pushext @v_udiv16_m
+    sub
+    popext @v_udiv16_t
+#l_udiv16_20
+    jnn @l_udiv16_14
+    pushimm 0x00
+    pushext @v_udiv16_a+1
+    add
+    popinh
+    pushext @v_udiv16_a
+    pushext @v_udiv16_a
+    jnn @l_udiv16_21
+    pushimm 0x01
+    add
+#l_udiv16_21
+    pushext @v_udiv16_a+1
+    pushext @v_udiv16_a+1
+    add
+    popext @v_udiv16_a+1
+    add
+    popext @v_udiv16_a
+#l_udiv16_15
+    pushext @v_udiv16_i
+    pushimm 0xFF
+    add
+    popext @v_udiv16_i
+    jnn @l_udiv16_11
+#l_udiv16_5
+    jnz @r_udiv16
+#l_udiv16_ret
+    pushimm 0x00
+    popext 0xFFFB
+#r_udiv16
+    jnz 0x0000
+#l_udiv16_4
+    pushext @v_udiv16_t
+    popext @v_udiv16_m
+    pushext @v_udiv16_t+1
+    popext @v_udiv16_m+1
+    pushimm 0x00
+    popext @v_udiv16_a
+    pushimm 0x01
+    popext @v_udiv16_a+1
+    jnz @l_udiv16_5
+    jnn @l_udiv16_5
+#l_udiv16_14
+    pushext @v_udiv16_t
+    popext @v_udiv16_m
+    pushext @v_udiv16_t+1
+    popext @v_udiv16_m+1
+    pushimm 0x00
+    pushext @v_udiv16_a+1
+    add
+    popinh
+    pushext @v_udiv16_a
+    pushext @v_udiv16_a
+    jnn @l_udiv16_22
+    pushimm 0x01
+    add
+#l_udiv16_22
+    pushext @v_udiv16_a+1
+    pushext @v_udiv16_a+1
+    add
+    pushimm 0x01
+    add
+    popext @v_udiv16_a+1
+    add
+    popext @v_udiv16_a
+    jnz @l_udiv16_15
+    jnn @l_udiv16_15
+#v_udiv16_a 0x00
+    0x00
+#v_udiv16_b 0x00
+    0x00
+#v_udiv16_m 0x00
+    0x00
+#v_udiv16_t 0x00
+    0x00
+#v_udiv16_i 0x00
@@ -0,0 +1,1796 @@
+; udiv16: a / b, a % b unsigned, 16-bit, unrolled
+#f_udiv16
+    pushext @v_udiv16_a
+    popext @v_udiv16_m
+    pushext @v_udiv16_a+1
+    popext @v_udiv16_m+1
+    pushext @v_udiv16_b
+    pushext @v_udiv16_b+1
+    nor
+    pushimm 0x00
+    nor
+    pushimm 0x00
+    add
+    popinh
+    jnz @l_udiv16_1
+    pushimm 0xFF
+    popext @v_udiv16_a
+    pushimm 0xFF
+    popext @v_udiv16_a+1
+    jnz @l_udiv16_164
+    jnn @l_udiv16_164
+#l_udiv16_1
+    pushimm 0x00
+    pushext @v_udiv16_b
+    add
+    popinh
+    jnn @l_udiv16_2
+    pushimm 0x00
+    pushext @v_udiv16_a
+    add
+    popinh
+    jnn @l_udiv16_3
+    pushext @v_udiv16_b+1
+    pushext @v_udiv16_a+1
+    sub
+    popext @v_udiv16_t+1
+    pushimm 0x00
+    pushext @v_udiv16_a+1
+    add
+    popinh
+    jnn @l_udiv16_6
+    pushimm 0x00
+    pushext @v_udiv16_b+1
+    add
+    popinh
+    jnn @l_udiv16_9
+#l_udiv16_7
+    pushimm 0x00
+    pushext @v_udiv16_t+1
+    add
+    popinh
+    jnn @l_udiv16_9
+#l_udiv16_8
+    pushext @v_udiv16_b
+    pushext @v_udiv16_a
+    sub
+    pushimm 0xFF
+    add
+    popext @v_udiv16_t
+    jnz @l_udiv16_10
+    jnn @l_udiv16_10
+#l_udiv16_6
+    pushimm 0x00
+    pushext @v_udiv16_b+1
+    add
+    popinh
+    jnn @l_udiv16_7
+    jnz @l_udiv16_8
+#l_udiv16_9
+    pushext @v_udiv16_b
+    pushext @v_udiv16_a
+    sub
+    popext @v_udiv16_t
+#l_udiv16_10
+    jnn @l_udiv16_4
+#l_udiv16_3
+    pushimm 0x00
+    popext @v_udiv16_a
+    pushimm 0x00
+    popext @v_udiv16_a+1
+    jnz @l_udiv16_164
+    jnn @l_udiv16_164
+#l_udiv16_2
+    pushimm 0x00
+    popext @v_udiv16_m
+    pushimm 0x00
+    popext @v_udiv16_m+1
+    pushimm 0x00
+    pushext @v_udiv16_a
+    add
+    popinh
+    pushext @v_udiv16_m+1
+    pushext @v_udiv16_m+1
+    jnn @l_udiv16_11
+    pushimm 0x01
+    add
+#l_udiv16_11
+    add
+    pushimm 0x00
+    pushext @v_udiv16_m+1
+    add
+    popinh
+    pushext @v_udiv16_m
+    pushext @v_udiv16_m
+    jnn @l_udiv16_12
+    pushimm 0x01
+    add
+#l_udiv16_12
+    add
+    popext @v_udiv16_m
+    popext @v_udiv16_m+1
+    pushext @v_udiv16_b+1
+    pushext @v_udiv16_m+1
+    sub
+    popext @v_udiv16_t+1
+    pushimm 0x00
+    pushext @v_udiv16_m+1
+    add
+    popinh
+    jnn @l_udiv16_15
+    pushimm 0x00
+    pushext @v_udiv16_b+1
+    add
+    popinh
+    jnn @l_udiv16_18
+#l_udiv16_16
+    pushimm 0x00
+    pushext @v_udiv16_t+1
+    add
+    popinh
+    jnn @l_udiv16_18
+#l_udiv16_17
+    pushext @v_udiv16_b
+    pushext @v_udiv16_m
+    sub
+    pushimm 0xFF
+    add
+    popext @v_udiv16_t
+    jnz @l_udiv16_19
+    jnn @l_udiv16_19
+#l_udiv16_15
+    pushimm 0x00
+    pushext @v_udiv16_b+1
+    add
+    popinh
+    jnn @l_udiv16_16
+    jnz @l_udiv16_17
+#l_udiv16_18
+    pushext @v_udiv16_b
+    pushext @v_udiv16_m
+    sub
+    popext @v_udiv16_t
+#l_udiv16_19
+    jnn @l_udiv16_13
+    pushimm 0x00
+    pushext @v_udiv16_a+1
+    add
+    popinh
+    pushext @v_udiv16_a
+    pushext @v_udiv16_a
+    jnn @l_udiv16_20
+    pushimm 0x01
+    add
+#l_udiv16_20
+    pushext @v_udiv16_a+1
+    pushext @v_udiv16_a+1
+    add
+    popext @v_udiv16_a+1
+    add
+    popext @v_udiv16_a
+#l_udiv16_14
+    pushext @v_udiv16_m+1
+    pushext @v_udiv16_m+1
+    jnn @l_udiv16_21
+    pushimm 0x01
+    add
+#l_udiv16_21
+    add
+    pushimm 0x00
+    pushext @v_udiv16_m+1
+    add
+    popinh
+    pushext @v_udiv16_m
+    pushext @v_udiv16_m
+    jnn @l_udiv16_22
+    pushimm 0x01
+    add
+#l_udiv16_22
+    add
+    popext @v_udiv16_m
+    popext @v_udiv16_m+1
+    pushext @v_udiv16_b+1
+    pushext @v_udiv16_m+1
+    sub
+    popext @v_udiv16_t+1
+    pushimm 0x00
+    pushext @v_udiv16_m+1
+    add
+    popinh
+    jnn @l_udiv16_25
+    pushimm 0x00
+    pushext @v_udiv16_b+1
+    add
+    popinh
+    jnn @l_udiv16_28
+#l_udiv16_26
+    pushimm 0x00
+    pushext @v_udiv16_t+1
+    add
+    popinh
+    jnn @l_udiv16_28
+#l_udiv16_27
+    pushext @v_udiv16_b
+    pushext @v_udiv16_m
+    sub
+    pushimm 0xFF
+    add
+    popext @v_udiv16_t
+    jnz @l_udiv16_29
+    jnn @l_udiv16_29
+#l_udiv16_25
+    pushimm 0x00
+    pushext @v_udiv16_b+1
+    add
+    popinh
+    jnn @l_udiv16_26
+    jnz @l_udiv16_27
+#l_udiv16_28
+    pushext @v_udiv16_b
+    pushext @v_udiv16_m
+    sub
+    popext @v_udiv16_t
+#l_udiv16_29
+    jnn @l_udiv16_23
+    pushimm 0x00
+    pushext @v_udiv16_a+1
+    add
+    popinh
+    pushext @v_udiv16_a
+    pushext @v_udiv16_a
+    jnn @l_udiv16_30
+    pushimm 0x01
+    add
+#l_udiv16_30
+    pushext @v_udiv16_a+1
+    pushext @v_udiv16_a+1
+    add
+    popext @v_udiv16_a+1
+    add
+    popext @v_udiv16_a
+#l_udiv16_24
+    pushext @v_udiv16_m+1
+    pushext @v_udiv16_m+1
+    jnn @l_udiv16_31
+    pushimm 0x01
+    add
+#l_udiv16_31
+    add
+    pushimm 0x00
+    pushext @v_udiv16_m+1
+    add
+    popinh
+    pushext @v_udiv16_m
+    pushext @v_udiv16_m
+    jnn @l_udiv16_32
+    pushimm 0x01
+    add
+#l_udiv16_32
+    add
+    popext @v_udiv16_m
+    popext @v_udiv16_m+1
+    pushext @v_udiv16_b+1
+    pushext @v_udiv16_m+1
+    sub
+    popext @v_udiv16_t+1
+    pushimm 0x00
+    pushext @v_udiv16_m+1
+    add
+    popinh
+    jnn @l_udiv16_35
+    pushimm 0x00
+    pushext @v_udiv16_b+1
+    add
+    popinh
+    jnn @l_udiv16_38
+#l_udiv16_36
+    pushimm 0x00
+    pushext @v_udiv16_t+1
+    add
+    popinh
+    jnn @l_udiv16_38
+#l_udiv16_37
+    pushext @v_udiv16_b
+    pushext @v_udiv16_m
+    sub
+    pushimm 0xFF
+    add
+    popext @v_udiv16_t
+    jnz @l_udiv16_39
+    jnn @l_udiv16_39
+#l_udiv16_35
+    pushimm 0x00
+    pushext @v_udiv16_b+1
+    add
+    popinh
+    jnn @l_udiv16_36
+    jnz @l_udiv16_37
+#l_udiv16_38
+    pushext @v_udiv16_b
+    pushext @v_udiv16_m
+    sub
+    popext @v_udiv16_t
+#l_udiv16_39
+    jnn @l_udiv16_33
+    pushimm 0x00
+    pushext @v_udiv16_a+1
+    add
+    popinh
+    pushext @v_udiv16_a
+    pushext @v_udiv16_a
+    jnn @l_udiv16_40
+    pushimm 0x01
+    add
+#l_udiv16_40
+    pushext @v_udiv16_a+1
+    pushext @v_udiv16_a+1
+    add
+    popext @v_udiv16_a+1
+    add
+    popext @v_udiv16_a
+#l_udiv16_34
+    pushext @v_udiv16_m+1
+    pushext @v_udiv16_m+1
+    jnn @l_udiv16_41
+    pushimm 0x01
+    add
+#l_udiv16_41
+    add
+    pushimm 0x00
+    pushext @v_udiv16_m+1
+    add
+    popinh
+    pushext @v_udiv16_m
+    pushext @v_udiv16_m
+    jnn @l_udiv16_42
+    pushimm 0x01
+    add
+#l_udiv16_42
+    add
+    popext @v_udiv16_m
+    popext @v_udiv16_m+1
+    pushext @v_udiv16_b+1
+    pushext @v_udiv16_m+1
+    sub
+    popext @v_udiv16_t+1
+    pushimm 0x00
+    pushext @v_udiv16_m+1
+    add
+    popinh
+    jnn @l_udiv16_45
+    pushimm 0x00
+    pushext @v_udiv16_b+1
+    add
+    popinh
+    jnn @l_udiv16_48
+#l_udiv16_46
+    pushimm 0x00
+    pushext @v_udiv16_t+1
+    add
+    popinh
+    jnn @l_udiv16_48
+#l_udiv16_47
+    pushext @v_udiv16_b
+    pushext @v_udiv16_m
+    sub
+    pushimm 0xFF
+    add
+    popext @v_udiv16_t
+    jnz @l_udiv16_49
+    jnn @l_udiv16_49
+#l_udiv16_45
+    pushimm 0x00
+    pushext @v_udiv16_b+1
+    add
+    popinh
+    jnn @l_udiv16_46
+    jnz @l_udiv16_47
+#l_udiv16_48
+    pushext @v_udiv16_b
+    pushext @v_udiv16_m
+    sub
+    popext @v_udiv16_t
+#l_udiv16_49
+    jnn @l_udiv16_43
+    pushimm 0x00
+    pushext @v_udiv16_a+1
+    add
+    popinh
+    pushext @v_udiv16_a
+    pushext @v_udiv16_a
+    jnn @l_udiv16_50
+    pushimm 0x01
+    add
+#l_udiv16_50
+    pushext @v_udiv16_a+1
+    pushext @v_udiv16_a+1
+    add
+    popext @v_udiv16_a+1
+    add
+    popext @v_udiv16_a
+#l_udiv16_44
+    pushext @v_udiv16_m+1
+    pushext @v_udiv16_m+1
+    jnn @l_udiv16_51
+    pushimm 0x01
+    add
+#l_udiv16_51
+    add
+    pushimm 0x00
+    pushext @v_udiv16_m+1
+    add
+    popinh
+    pushext @v_udiv16_m
+    pushext @v_udiv16_m
+    jnn @l_udiv16_52
+    pushimm 0x01
+    add
+#l_udiv16_52
+    add
+    popext @v_udiv16_m
+    popext @v_udiv16_m+1
+    pushext @v_udiv16_b+1
+    pushext @v_udiv16_m+1
+    sub
+    popext @v_udiv16_t+1
+    pushimm 0x00
+    pushext @v_udiv16_m+1
+    add
+    popinh
+    jnn @l_udiv16_55
+    pushimm 0x00
+    pushext @v_udiv16_b+1
+    add
+    popinh
+    jnn @l_udiv16_58
+#l_udiv16_56
+    pushimm 0x00
+    pushext @v_udiv16_t+1
+    add
+    popinh
+    jnn @l_udiv16_58
+#l_udiv16_57
+    pushext @v_udiv16_b
+    pushext @v_udiv16_m
+    sub
+    pushimm 0xFF
+    add
+    popext @v_udiv16_t
+    jnz @l_udiv16_59
+    jnn @l_udiv16_59
+#l_udiv16_55
+    pushimm 0x00
+    pushext @v_udiv16_b+1
+    add
+    popinh
+    jnn @l_udiv16_56
+    jnz @l_udiv16_57
+#l_udiv16_58
+    pushext @v_udiv16_b
+    pushext @v_udiv16_m
+    sub
+    popext @v_udiv16_t
+#l_udiv16_59
+    jnn @l_udiv16_53
+    pushimm 0x00
+    pushext @v_udiv16_a+1
+    add
+    popinh
+    pushext @v_udiv16_a
+    pushext @v_udiv16_a
+    jnn @l_udiv16_60
+    pushimm 0x01
+    add
+#l_udiv16_60
+    pushext @v_udiv16_a+1
+    pushext @v_udiv16_a+1
+    add
+    popext @v_udiv16_a+1
+    add
+    popext @v_udiv16_a
+#l_udiv16_54
+    pushext @v_udiv16_m+1
+    pushext @v_udiv16_m+1
+    jnn @l_udiv16_61
+    pushimm 0x01
+    add
+#l_udiv16_61
+    add
+    pushimm 0x00
+    pushext @v_udiv16_m+1
+    add
+    popinh
+    pushext @v_udiv16_m
+    pushext @v_udiv16_m
+    jnn @l_udiv16_62
+    pushimm 0x01
+    add
+#l_udiv16_62
+    add
+    popext @v_udiv16_m
+    popext @v_udiv16_m+1
+    pushext @v_udiv16_b+1
+    pushext @v_udiv16_m+1
+    sub
+    popext @v_udiv16_t+1
+    pushimm 0x00
+    pushext @v_udiv16_m+1
+    add
+    popinh
+    jnn @l_udiv16_65
+    pushimm 0x00
+    pushext @v_udiv16_b+1
+    add
+    popinh
+    jnn @l_udiv16_68
+#l_udiv16_66
+    pushimm 0x00
+    pushext @v_udiv16_t+1
+    add
+    popinh
+    jnn @l_udiv16_68
+#l_udiv16_67
+    pushext @v_udiv16_b
+    pushext @v_udiv16_m
+    sub
+    pushimm 0xFF
+    add
+    popext @v_udiv16_t
+    jnz @l_udiv16_69
+    jnn @l_udiv16_69
+#l_udiv16_65
+    pushimm 0x00
+    pushext @v_udiv16_b+1
+    add
+    popinh
+    jnn @l_udiv16_66
+    jnz @l_udiv16_67
+#l_udiv16_68
+    pushext @v_udiv16_b
+    pushext @v_udiv16_m
+    sub
+    popext @v_udiv16_t
+#l_udiv16_69
+    jnn @l_udiv16_63
+    pushimm 0x00
+    pushext @v_udiv16_a+1
+    add
+    popinh
+    pushext @v_udiv16_a
+    pushext @v_udiv16_a
+    jnn @l_udiv16_70
+    pushimm 0x01
+    add
+#l_udiv16_70
+    pushext @v_udiv16_a+1
+    pushext @v_udiv16_a+1
+    add
+    popext @v_udiv16_a+1
+    add
+    popext @v_udiv16_a
+#l_udiv16_64
+    pushext @v_udiv16_m+1
+    pushext @v_udiv16_m+1
+    jnn @l_udiv16_71
+    pushimm 0x01
+    add
+#l_udiv16_71
+    add
+    pushimm 0x00
+    pushext @v_udiv16_m+1
+    add
+    popinh
+    pushext @v_udiv16_m
+    pushext @v_udiv16_m
+    jnn @l_udiv16_72
+    pushimm 0x01
+    add
+#l_udiv16_72
+    add
+    popext @v_udiv16_m
+    popext @v_udiv16_m+1
+    pushext @v_udiv16_b+1
+    pushext @v_udiv16_m+1
+    sub
+    popext @v_udiv16_t+1
+    pushimm 0x00
+    pushext @v_udiv16_m+1
+    add
+    popinh
+    jnn @l_udiv16_75
+    pushimm 0x00
+    pushext @v_udiv16_b+1
+    add
+    popinh
+    jnn @l_udiv16_78
+#l_udiv16_76
+    pushimm 0x00
+    pushext @v_udiv16_t+1
+    add
+    popinh
+    jnn @l_udiv16_78
+#l_udiv16_77
+    pushext @v_udiv16_b
+    pushext @v_udiv16_m
+    sub
+    pushimm 0xFF
+    add
+    popext @v_udiv16_t
+    jnz @l_udiv16_79
+    jnn @l_udiv16_79
+#l_udiv16_75
+    pushimm 0x00
+    pushext @v_udiv16_b+1
+    add
+    popinh
+    jnn @l_udiv16_76
+    jnz @l_udiv16_77
+#l_udiv16_78
+    pushext @v_udiv16_b
+    pushext @v_udiv16_m
+    sub
+    popext @v_udiv16_t
+#l_udiv16_79
+    jnn @l_udiv16_73
+    pushimm 0x00
+    pushext @v_udiv16_a+1
+    add
+    popinh
+    pushext @v_udiv16_a
+    pushext @v_udiv16_a
+    jnn @l_udiv16_80
+    pushimm 0x01
+    add
+#l_udiv16_80
+    pushext @v_udiv16_a+1
+    pushext @v_udiv16_a+1
+    add
+    popext @v_udiv16_a+1
+    add
+    popext @v_udiv16_a
+#l_udiv16_74
+    pushext @v_udiv16_m+1
+    pushext @v_udiv16_m+1
+    jnn @l_udiv16_81
+    pushimm 0x01
+    add
+#l_udiv16_81
+    add
+    pushimm 0x00
+    pushext @v_udiv16_m+1
+    add
+    popinh
+    pushext @v_udiv16_m
+    pushext @v_udiv16_m
+    jnn @l_udiv16_82
+    pushimm 0x01
+    add
+#l_udiv16_82
+    add
+    popext @v_udiv16_m
+    popext @v_udiv16_m+1
+    pushext @v_udiv16_b+1
+    pushext @v_udiv16_m+1
+    sub
+    popext @v_udiv16_t+1
+    pushimm 0x00
+    pushext @v_udiv16_m+1
+    add
+    popinh
+    jnn @l_udiv16_85
+    pushimm 0x00
+    pushext @v_udiv16_b+1
+    add
+    popinh
+    jnn @l_udiv16_88
+#l_udiv16_86
+    pushimm 0x00
+    pushext @v_udiv16_t+1
+    add
+    popinh
+    jnn @l_udiv16_88
+#l_udiv16_87
+    pushext @v_udiv16_b
+    pushext @v_udiv16_m
+    sub
+    pushimm 0xFF
+    add
+    popext @v_udiv16_t
+    jnz @l_udiv16_89
+    jnn @l_udiv16_89
+#l_udiv16_85
+    pushimm 0x00
+    pushext @v_udiv16_b+1
+    add
+    popinh
+    jnn @l_udiv16_86
+    jnz @l_udiv16_87
+#l_udiv16_88
+    pushext @v_udiv16_b
+    pushext @v_udiv16_m
+    sub
+    popext @v_udiv16_t
+#l_udiv16_89
+    jnn @l_udiv16_83
+    pushimm 0x00
+    pushext @v_udiv16_a+1
+    add
+    popinh
+    pushext @v_udiv16_a
+    pushext @v_udiv16_a
+    jnn @l_udiv16_90
+    pushimm 0x01
+    add
+#l_udiv16_90
+    pushext @v_udiv16_a+1
+    pushext @v_udiv16_a+1
+    add
+    popext @v_udiv16_a+1
+    add
+    popext @v_udiv16_a
+#l_udiv16_84
+    pushext @v_udiv16_m+1
+    pushext @v_udiv16_m+1
+    jnn @l_udiv16_91
+    pushimm 0x01
+    add
+#l_udiv16_91
+    add
+    pushimm 0x00
+    pushext @v_udiv16_m+1
+    add
+    popinh
+    pushext @v_udiv16_m
+    pushext @v_udiv16_m
+    jnn @l_udiv16_92
+    pushimm 0x01
+    add
+#l_udiv16_92
+    add
+    popext @v_udiv16_m
+    popext @v_udiv16_m+1
+    pushext @v_udiv16_b+1
+    pushext @v_udiv16_m+1
+    sub
+    popext @v_udiv16_t+1
+    pushimm 0x00
+    pushext @v_udiv16_m+1
+    add
+    popinh
+    jnn @l_udiv16_95
+    pushimm 0x00
+    pushext @v_udiv16_b+1
+    add
+    popinh
+    jnn @l_udiv16_98
+#l_udiv16_96
+    pushimm 0x00
+    pushext @v_udiv16_t+1
+    add
+    popinh
+    jnn @l_udiv16_98
+#l_udiv16_97
+    pushext @v_udiv16_b
+    pushext @v_udiv16_m
+    sub
+    pushimm 0xFF
+    add
+    popext @v_udiv16_t
+    jnz @l_udiv16_99
+    jnn @l_udiv16_99
+#l_udiv16_95
+    pushimm 0x00
+    pushext @v_udiv16_b+1
+    add
+    popinh
+    jnn @l_udiv16_96
+    jnz @l_udiv16_97
+#l_udiv16_98
+    pushext @v_udiv16_b
+    pushext @v_udiv16_m
+    sub
+    popext @v_udiv16_t
+#l_udiv16_99
+    jnn @l_udiv16_93
+    pushimm 0x00
+    pushext @v_udiv16_a+1
+    add
+    popinh
+    pushext @v_udiv16_a
+    pushext @v_udiv16_a
+    jnn @l_udiv16_100
+    pushimm 0x01
+    add
+#l_udiv16_100
+    pushext @v_udiv16_a+1
+    pushext @v_udiv16_a+1
+    add
+    popext @v_udiv16_a+1
+    add
+    popext @v_udiv16_a
+#l_udiv16_94
+    pushext @v_udiv16_m+1
+    pushext @v_udiv16_m+1
+    jnn @l_udiv16_101
+    pushimm 0x01
+    add
+#l_udiv16_101
+    add
+    pushimm 0x00
+    pushext @v_udiv16_m+1
+    add
+    popinh
+    pushext @v_udiv16_m
+    pushext @v_udiv16_m
+    jnn @l_udiv16_102
+    pushimm 0x01
+    add
+#l_udiv16_102
+    add
+    popext @v_udiv16_m
+    popext @v_udiv16_m+1
+    pushext @v_udiv16_b+1
+    pushext @v_udiv16_m+1
+    sub
+    popext @v_udiv16_t+1
+    pushimm 0x00
+    pushext @v_udiv16_m+1
+    add
+    popinh
+    jnn @l_udiv16_105
+    pushimm 0x00
+    pushext @v_udiv16_b+1
+    add
+    popinh
+    jnn @l_udiv16_108
+#l_udiv16_106
+    pushimm 0x00
+    pushext @v_udiv16_t+1
+    add
+    popinh
+    jnn @l_udiv16_108
+#l_udiv16_107
+    pushext @v_udiv16_b
+    pushext @v_udiv16_m
+    sub
+    pushimm 0xFF
+    add
+    popext @v_udiv16_t
+    jnz @l_udiv16_109
+    jnn @l_udiv16_109
+#l_udiv16_105
+    pushimm 0x00
+    pushext @v_udiv16_b+1
+    add
+    popinh
+    jnn @l_udiv16_106
+    jnz @l_udiv16_107
+#l_udiv16_108
+    pushext @v_udiv16_b
+    pushext @v_udiv16_m
+    sub
+    popext @v_udiv16_t
+#l_udiv16_109
+    jnn @l_udiv16_103
+    pushimm 0x00
+    pushext @v_udiv16_a+1
+    add
+    popinh
+    pushext @v_udiv16_a
+    pushext @v_udiv16_a
+    jnn @l_udiv16_110
+    pushimm 0x01
+    add
+#l_udiv16_110
+    pushext @v_udiv16_a+1
+    pushext @v_udiv16_a+1
+    add
+    popext @v_udiv16_a+1
+    add
+    popext @v_udiv16_a
+#l_udiv16_104
+    pushext @v_udiv16_m+1
+    pushext @v_udiv16_m+1
+    jnn @l_udiv16_111
+    pushimm 0x01
+    add
+#l_udiv16_111
+    add
+    pushimm 0x00
+    pushext @v_udiv16_m+1
+    add
+    popinh
+    pushext @v_udiv16_m
+    pushext @v_udiv16_m
+    jnn @l_udiv16_112
+    pushimm 0x01
+    add
+#l_udiv16_112
+    add
+    popext @v_udiv16_m
+    popext @v_udiv16_m+1
+    pushext @v_udiv16_b+1
+    pushext @v_udiv16_m+1
+    sub
+    popext @v_udiv16_t+1
+    pushimm 0x00
+    pushext @v_udiv16_m+1
+    add
+    popinh
+    jnn @l_udiv16_115
+    pushimm 0x00
+    pushext @v_udiv16_b+1
+    add
+    popinh
+    jnn @l_udiv16_118
+#l_udiv16_116
+    pushimm 0x00
+    pushext @v_udiv16_t+1
+    add
+    popinh
+    jnn @l_udiv16_118
+#l_udiv16_117
+    pushext @v_udiv16_b
+    pushext @v_udiv16_m
+    sub
+    pushimm 0xFF
+    add
+    popext @v_udiv16_t
+    jnz @l_udiv16_119
+    jnn @l_udiv16_119
+#l_udiv16_115
+    pushimm 0x00
+    pushext @v_udiv16_b+1
+    add
+    popinh
+    jnn @l_udiv16_116
+    jnz @l_udiv16_117
+#l_udiv16_118
+    pushext @v_udiv16_b
+    pushext @v_udiv16_m
+    sub
+    popext @v_udiv16_t
+#l_udiv16_119
+    jnn @l_udiv16_113
+    pushimm 0x00
+    pushext @v_udiv16_a+1
+    add
+    popinh
+    pushext @v_udiv16_a
+    pushext @v_udiv16_a
+    jnn @l_udiv16_120
+    pushimm 0x01
+    add
+#l_udiv16_120
+    pushext @v_udiv16_a+1
+    pushext @v_udiv16_a+1
+    add
+    popext @v_udiv16_a+1
+    add
+    popext @v_udiv16_a
+#l_udiv16_114
+    pushext @v_udiv16_m+1
+    pushext @v_udiv16_m+1
+    jnn @l_udiv16_121
+    pushimm 0x01
+    add
+#l_udiv16_121
+    add
+    pushimm 0x00
+    pushext @v_udiv16_m+1
+    add
+    popinh
+    pushext @v_udiv16_m
+    pushext @v_udiv16_m
+    jnn @l_udiv16_122
+    pushimm 0x01
+    add
+#l_udiv16_122
+    add
+    popext @v_udiv16_m
+    popext @v_udiv16_m+1
+    pushext @v_udiv16_b+1
+    pushext @v_udiv16_m+1
+    sub
+    popext @v_udiv16_t+1
+    pushimm 0x00
+    pushext @v_udiv16_m+1
+    add
+    popinh
+    jnn @l_udiv16_125
+    pushimm 0x00
+    pushext @v_udiv16_b+1
+    add
+    popinh
+    jnn @l_udiv16_128
+#l_udiv16_126
+    pushimm 0x00
+    pushext @v_udiv16_t+1
+    add
+    popinh
+    jnn @l_udiv16_128
+#l_udiv16_127
+    pushext @v_udiv16_b
+    pushext @v_udiv16_m
+    sub
+    pushimm 0xFF
+    add
+    popext @v_udiv16_t
+    jnz @l_udiv16_129
+    jnn @l_udiv16_129
+#l_udiv16_125
+    pushimm 0x00
+    pushext @v_udiv16_b+1
+    add
+    popinh
+    jnn @l_udiv16_126
+    jnz @l_udiv16_127
+#l_udiv16_128
+    pushext @v_udiv16_b
+    pushext @v_udiv16_m
+    sub
+    popext @v_udiv16_t
+#l_udiv16_129
+    jnn @l_udiv16_123
+    pushimm 0x00
+    pushext @v_udiv16_a+1
+    add
+    popinh
+    pushext @v_udiv16_a
+    pushext @v_udiv16_a
+    jnn @l_udiv16_130
+    pushimm 0x01
+    add
+#l_udiv16_130
+    pushext @v_udiv16_a+1
+    pushext @v_udiv16_a+1
+    add
+    popext @v_udiv16_a+1
+    add
+    popext @v_udiv16_a
+#l_udiv16_124
+    pushext @v_udiv16_m+1
+    pushext @v_udiv16_m+1
+    jnn @l_udiv16_131
+    pushimm 0x01
+    add
+#l_udiv16_131
+    add
+    pushimm 0x00
+    pushext @v_udiv16_m+1
+    add
+    popinh
+    pushext @v_udiv16_m
+    pushext @v_udiv16_m
+    jnn @l_udiv16_132
+    pushimm 0x01
+    add
+#l_udiv16_132
+    add
+    popext @v_udiv16_m
+    popext @v_udiv16_m+1
+    pushext @v_udiv16_b+1
+    pushext @v_udiv16_m+1
+    sub
+    popext @v_udiv16_t+1
+    pushimm 0x00
+    pushext @v_udiv16_m+1
+    add
+    popinh
+    jnn @l_udiv16_135
+    pushimm 0x00
+    pushext @v_udiv16_b+1
+    add
+    popinh
+    jnn @l_udiv16_138
+#l_udiv16_136
+    pushimm 0x00
+    pushext @v_udiv16_t+1
+    add
+    popinh
+    jnn @l_udiv16_138
+#l_udiv16_137
+    pushext @v_udiv16_b
+    pushext @v_udiv16_m
+    sub
+    pushimm 0xFF
+    add
+    popext @v_udiv16_t
+    jnz @l_udiv16_139
+    jnn @l_udiv16_139
+#l_udiv16_135
+    pushimm 0x00
+    pushext @v_udiv16_b+1
+    add
+    popinh
+    jnn @l_udiv16_136
+    jnz @l_udiv16_137
+#l_udiv16_138
+    pushext @v_udiv16_b
+    pushext @v_udiv16_m
+    sub
+    popext @v_udiv16_t
+#l_udiv16_139
+    jnn @l_udiv16_133
+    pushimm 0x00
+    pushext @v_udiv16_a+1
+    add
+    popinh
+    pushext @v_udiv16_a
+    pushext @v_udiv16_a
+    jnn @l_udiv16_140
+    pushimm 0x01
+    add
+#l_udiv16_140
+    pushext @v_udiv16_a+1
+    pushext @v_udiv16_a+1
+    add
+    popext @v_udiv16_a+1
+    add
+    popext @v_udiv16_a
+#l_udiv16_134
+    pushext @v_udiv16_m+1
+    pushext @v_udiv16_m+1
+    jnn @l_udiv16_141
+    pushimm 0x01
+    add
+#l_udiv16_141
+    add
+    pushimm 0x00
+    pushext @v_udiv16_m+1
+    add
+    popinh
+    pushext @v_udiv16_m
+    pushext @v_udiv16_m
+    jnn @l_udiv16_142
+    pushimm 0x01
+    add
+#l_udiv16_142
+    add
+    popext @v_udiv16_m
+    popext @v_udiv16_m+1
+    pushext @v_udiv16_b+1
+    pushext @v_udiv16_m+1
+    sub
+    popext @v_udiv16_t+1
+    pushimm 0x00
+    pushext @v_udiv16_m+1
+    add
+    popinh
+    jnn @l_udiv16_145
+    pushimm 0x00
+    pushext @v_udiv16_b+1
+    add
+    popinh
+    jnn @l_udiv16_148
+#l_udiv16_146
+    pushimm 0x00
+    pushext @v_udiv16_t+1
+    add
+    popinh
+    jnn @l_udiv16_148
+#l_udiv16_147
+    pushext @v_udiv16_b
+    pushext @v_udiv16_m
+    sub
+    pushimm 0xFF
+    add
+    popext @v_udiv16_t
+    jnz @l_udiv16_149
+    jnn @l_udiv16_149
+#l_udiv16_145
+    pushimm 0x00
+    pushext @v_udiv16_b+1
+    add
+    popinh
+    jnn @l_udiv16_146
+    jnz @l_udiv16_147
+#l_udiv16_148
+    pushext @v_udiv16_b
+    pushext @v_udiv16_m
+    sub
+    popext @v_udiv16_t
+#l_udiv16_149
+    jnn @l_udiv16_143
+    pushimm 0x00
+    pushext @v_udiv16_a+1
+    add
+    popinh
+    pushext @v_udiv16_a
+    pushext @v_udiv16_a
+    jnn @l_udiv16_150
+    pushimm 0x01
+    add
+#l_udiv16_150
+    pushext @v_udiv16_a+1
+    pushext @v_udiv16_a+1
+    add
+    popext @v_udiv16_a+1
+    add
+    popext @v_udiv16_a
+#l_udiv16_144
+    pushext @v_udiv16_m+1
+    pushext @v_udiv16_m+1
+    jnn @l_udiv16_151
+    pushimm 0x01
+    add
+#l_udiv16_151
+    add
+    pushimm 0x00
+    pushext @v_udiv16_m+1
+    add
+    popinh
+    pushext @v_udiv16_m
+    pushext @v_udiv16_m
+    jnn @l_udiv16_152
+    pushimm 0x01
+    add
+#l_udiv16_152
+    add
+    popext @v_udiv16_m
+    popext @v_udiv16_m+1
+    pushext @v_udiv16_b+1
+    pushext @v_udiv16_m+1
+    sub
+    popext @v_udiv16_t+1
+    pushimm 0x00
+    pushext @v_udiv16_m+1
+    add
+    popinh
+    jnn @l_udiv16_155
+    pushimm 0x00
+    pushext @v_udiv16_b+1
+    add
+    popinh
+    jnn @l_udiv16_158
+#l_udiv16_156
+    pushimm 0x00
+    pushext @v_udiv16_t+1
+    add
+    popinh
+    jnn @l_udiv16_158
+#l_udiv16_157
+    pushext @v_udiv16_b
+    pushext @v_udiv16_m
+    sub
+    pushimm 0xFF
+    add
+    popext @v_udiv16_t
+    jnz @l_udiv16_159
+    jnn @l_udiv16_159
+#l_udiv16_155
+    pushimm 0x00
+    pushext @v_udiv16_b+1
+    add
+    popinh
+    jnn @l_udiv16_156
+    jnz @l_udiv16_157
+#l_udiv16_158
+    pushext @v_udiv16_b
+    pushext @v_udiv16_m
+    sub
+    popext @v_udiv16_t
+#l_udiv16_159
+    jnn @l_udiv16_153
+    pushimm 0x00
+    pushext @v_udiv16_a+1
+    add
+    popinh
+    pushext @v_udiv16_a
+    pushext @v_udiv16_a
+    jnn @l_udiv16_160
+    pushimm 0x01
+    add
+#l_udiv16_160
+    pushext @v_udiv16_a+1
+    pushext @v_udiv16_a+1
+    add
+    popext @v_udiv16_a+1
+    add
+    popext @v_udiv16_a
+#l_udiv16_154
+    pushext @v_udiv16_m+1
+    pushext @v_udiv16_m+1
+    jnn @l_udiv16_161
+    pushimm 0x01
+    add
+#l_udiv16_161
+    add
+    pushimm 0x00
+    pushext @v_udiv16_m+1
+    add
+    popinh
+    pushext @v_udiv16_m
+    pushext @v_udiv16_m
+    jnn @l_udiv16_162
+    pushimm 0x01
+    add
+#l_udiv16_162
+    add
+    popext @v_udiv16_m
+    popext @v_udiv16_m+1
+    pushext @v_udiv16_b+1
+    pushext @v_udiv16_m+1
+    sub
+    popext @v_udiv16_t+1
+    pushimm 0x00
+    pushext @v_udiv16_m+1
+    add
+    popinh
+    jnn @l_udiv16_165
+    pushimm 0x00
+    pushext @v_udiv16_b+1
+    add
+    popinh
+    jnn @l_udiv16_168
+#l_udiv16_166
+    pushimm 0x00
+    pushext @v_udiv16_t+1
+    add
+    popinh
+    jnn @l_udiv16_168
+#l_udiv16_167
+    pushext @v_udiv16_b
+    pushext @v_udiv16_m
+    sub
+    pushimm 0xFF
+    add
+    popext @v_udiv16_t
+    jnz @l_udiv16_169
+    jnn @l_udiv16_169
+#l_udiv16_165
+    pushimm 0x00
+    pushext @v_udiv16_b+1
+    add
+    popinh
+    jnn @l_udiv16_166
+    jnz @l_udiv16_167
+#l_udiv16_168
+    pushext @v_udiv16_b
+    pushext @v_udiv16_m
+    sub
+    popext @v_udiv16_t
+#l_udiv16_169
+    jnn @l_udiv16_163
+    pushimm 0x00
+    pushext @v_udiv16_a+1
+    add
+    popinh
+    pushext @v_udiv16_a
+    pushext @v_udiv16_a
+    jnn @l_udiv16_170
+    pushimm 0x01
+    add
+#l_udiv16_170
+    pushext @v_udiv16_a+1
+    pushext @v_udiv16_a+1
+    add
+    popext @v_udiv16_a+1
+    add
+    popext @v_udiv16_a
+#l_udiv16_164
+    jnz @r_udiv16
+#l_udiv16_ret
+    pushimm 0x00
+    popext 0xFFFB
+#r_udiv16
+    jnz 0x0000
+#l_udiv16_4
+    pushext @v_udiv16_t
+    popext @v_udiv16_m
+    pushext @v_udiv16_t+1
+    popext @v_udiv16_m+1
+    pushimm 0x00
+    popext @v_udiv16_a
+    pushimm 0x01
+    popext @v_udiv16_a+1
+    jnz @l_udiv16_164
+    jnn @l_udiv16_164
+#l_udiv16_13
+    pushext @v_udiv16_t
+    popext @v_udiv16_m
+    pushext @v_udiv16_t+1
+    popext @v_udiv16_m+1
+    pushimm 0x00
+    pushext @v_udiv16_a+1
+    add
+    popinh
+    pushext @v_udiv16_a
+    pushext @v_udiv16_a
+    jnn @l_udiv16_171
+    pushimm 0x01
+    add
+#l_udiv16_171
+    pushext @v_udiv16_a+1
+    pushext @v_udiv16_a+1
+    add
+    pushimm 0x01
+    add
+    popext @v_udiv16_a+1
+    add
+    popext @v_udiv16_a
+    jnz @l_udiv16_14
+    jnn @l_udiv16_14
+#l_udiv16_23
+    pushext @v_udiv16_t
+    popext @v_udiv16_m
+    pushext @v_udiv16_t+1
+    popext @v_udiv16_m+1
+    pushimm 0x00
+    pushext @v_udiv16_a+1
+    add
+    popinh
+    pushext @v_udiv16_a
+    pushext @v_udiv16_a
+    jnn @l_udiv16_172
+    pushimm 0x01
+    add
+#l_udiv16_172
+    pushext @v_udiv16_a+1
+    pushext @v_udiv16_a+1
+    add
+    pushimm 0x01
+    add
+    popext @v_udiv16_a+1
+    add
+    popext @v_udiv16_a
+    jnz @l_udiv16_24
+    jnn @l_udiv16_24
+#l_udiv16_33
+    pushext @v_udiv16_t
+    popext @v_udiv16_m
+    pushext @v_udiv16_t+1
+    popext @v_udiv16_m+1
+    pushimm 0x00
+    pushext @v_udiv16_a+1
+    add
+    popinh
+    pushext @v_udiv16_a
+    pushext @v_udiv16_a
+    jnn @l_udiv16_173
+    pushimm 0x01
+    add
+#l_udiv16_173
+    pushext @v_udiv16_a+1
+    pushext @v_udiv16_a+1
+    add
+    pushimm 0x01
+    add
+    popext @v_udiv16_a+1
+    add
+    popext @v_udiv16_a
+    jnz @l_udiv16_34
+    jnn @l_udiv16_34
+#l_udiv16_43
+    pushext @v_udiv16_t
+    popext @v_udiv16_m
+    pushext @v_udiv16_t+1
+    popext @v_udiv16_m+1
+    pushimm 0x00
+    pushext @v_udiv16_a+1
+    add
+    popinh
+    pushext @v_udiv16_a
+    pushext @v_udiv16_a
+    jnn @l_udiv16_174
+    pushimm 0x01
+    add
+#l_udiv16_174
+    pushext @v_udiv16_a+1
+    pushext @v_udiv16_a+1
+    add
+    pushimm 0x01
+    add
+    popext @v_udiv16_a+1
+    add
+    popext @v_udiv16_a
+    jnz @l_udiv16_44
+    jnn @l_udiv16_44
+#l_udiv16_53
+    pushext @v_udiv16_t
+    popext @v_udiv16_m
+    pushext @v_udiv16_t+1
+    popext @v_udiv16_m+1
+    pushimm 0x00
+    pushext @v_udiv16_a+1
+    add
+    popinh
+    pushext @v_udiv16_a
+    pushext @v_udiv16_a
+    jnn @l_udiv16_175
+    pushimm 0x01
+    add
+#l_udiv16_175
+    pushext @v_udiv16_a+1
+    pushext @v_udiv16_a+1
+    add
+    pushimm 0x01
+    add
+    popext @v_udiv16_a+1
+    add
+    popext @v_udiv16_a
+    jnz @l_udiv16_54
+    jnn @l_udiv16_54
+#l_udiv16_63
+    pushext @v_udiv16_t
+    popext @v_udiv16_m
+    pushext @v_udiv16_t+1
+    popext @v_udiv16_m+1
+    pushimm 0x00
+    pushext @v_udiv16_a+1
+    add
+    popinh
+    pushext @v_udiv16_a
+    pushext @v_udiv16_a
+    jnn @l_udiv16_176
+    pushimm 0x01
+    add
+#l_udiv16_176
+    pushext @v_udiv16_a+1
+    pushext @v_udiv16_a+1
+    add
+    pushimm 0x01
+    add
+    popext @v_udiv16_a+1
+    add
+    popext @v_udiv16_a
+    jnz @l_udiv16_64
+    jnn @l_udiv16_64
+#l_udiv16_73
+    pushext @v_udiv16_t
+    popext @v_udiv16_m
+    pushext @v_udiv16_t+1
+    popext @v_udiv16_m+1
+    pushimm 0x00
+    pushext @v_udiv16_a+1
+    add
+    popinh
+    pushext @v_udiv16_a
+    pushext @v_udiv16_a
+    jnn @l_udiv16_177
+    pushimm 0x01
+    add
+#l_udiv16_177
+    pushext @v_udiv16_a+1
+    pushext @v_udiv16_a+1
+    add
+    pushimm 0x01
+    add
+    popext @v_udiv16_a+1
+    add
+    popext @v_udiv16_a
+    jnz @l_udiv16_74
+    jnn @l_udiv16_74
+#l_udiv16_83
+    pushext @v_udiv16_t
+    popext @v_udiv16_m
+    pushext @v_udiv16_t+1
+    popext @v_udiv16_m+1
+    pushimm 0x00
+    pushext @v_udiv16_a+1
+    add
+    popinh
+    pushext @v_udiv16_a
+    pushext @v_udiv16_a
+    jnn @l_udiv16_178
+    pushimm 0x01
+    add
+#l_udiv16_178
+    pushext @v_udiv16_a+1
+    pushext @v_udiv16_a+1
+    add
+    pushimm 0x01
+    add
+    popext @v_udiv16_a+1
+    add
+    popext @v_udiv16_a
+    jnz @l_udiv16_84
+    jnn @l_udiv16_84
+#l_udiv16_93
+    pushext @v_udiv16_t
+    popext @v_udiv16_m
+    pushext @v_udiv16_t+1
+    popext @v_udiv16_m+1
+    pushimm 0x00
+    pushext @v_udiv16_a+1
+    add
+    popinh
+    pushext @v_udiv16_a
+    pushext @v_udiv16_a
+    jnn @l_udiv16_179
+    pushimm 0x01
+    add
+#l_udiv16_179
+    pushext @v_udiv16_a+1
+    pushext @v_udiv16_a+1
+    add
+    pushimm 0x01
+    add
+    popext @v_udiv16_a+1
+    add
+    popext @v_udiv16_a
+    jnz @l_udiv16_94
+    jnn @l_udiv16_94
+#l_udiv16_103
+    pushext @v_udiv16_t
+    popext @v_udiv16_m
+    pushext @v_udiv16_t+1
+    popext @v_udiv16_m+1
+    pushimm 0x00
+    pushext @v_udiv16_a+1
+    add
+    popinh
+    pushext @v_udiv16_a
+    pushext @v_udiv16_a
+    jnn @l_udiv16_180
+    pushimm 0x01
+    add
+#l_udiv16_180
+    pushext @v_udiv16_a+1
+    pushext @v_udiv16_a+1
+    add
+    pushimm 0x01
+    add
+    popext @v_udiv16_a+1
+    add
+    popext @v_udiv16_a
+    jnz @l_udiv16_104
+    jnn @l_udiv16_104
+#l_udiv16_113
+    pushext @v_udiv16_t
+    popext @v_udiv16_m
+    pushext @v_udiv16_t+1
+    popext @v_udiv16_m+1
+    pushimm 0x00
+    pushext @v_udiv16_a+1
+    add
+    popinh
+    pushext @v_udiv16_a
+    pushext @v_udiv16_a
+    jnn @l_udiv16_181
+    pushimm 0x01
+    add
+#l_udiv16_181
+    pushext @v_udiv16_a+1
+    pushext @v_udiv16_a+1
+    add
+    pushimm 0x01
+    add
+    popext @v_udiv16_a+1
+    add
+    popext @v_udiv16_a
+    jnz @l_udiv16_114
+    jnn @l_udiv16_114
+#l_udiv16_123
+    pushext @v_udiv16_t
+    popext @v_udiv16_m
+    pushext @v_udiv16_t+1
+    popext @v_udiv16_m+1
+    pushimm 0x00
+    pushext @v_udiv16_a+1
+    add
+    popinh
+    pushext @v_udiv16_a
+    pushext @v_udiv16_a
+    jnn @l_udiv16_182
+    pushimm 0x01
+    add
+#l_udiv16_182
+    pushext @v_udiv16_a+1
+    pushext @v_udiv16_a+1
+    add
+    pushimm 0x01
+    add
+    popext @v_udiv16_a+1
+    add
+    popext @v_udiv16_a
+    jnz @l_udiv16_124
+    jnn @l_udiv16_124
+#l_udiv16_133
+    pushext @v_udiv16_t
+    popext @v_udiv16_m
+    pushext @v_udiv16_t+1
+    popext @v_udiv16_m+1
+    pushimm 0x00
+    pushext @v_udiv16_a+1
+    add
+    popinh
+    pushext @v_udiv16_a
+    pushext @v_udiv16_a
+    jnn @l_udiv16_183
+    pushimm 0x01
+    add
+#l_udiv16_183
+    pushext @v_udiv16_a+1
+    pushext @v_udiv16_a+1
+    add
+    pushimm 0x01
+    add
+    popext @v_udiv16_a+1
+    add
+    popext @v_udiv16_a
+    jnz @l_udiv16_134
+    jnn @l_udiv16_134
+#l_udiv16_143
+    pushext @v_udiv16_t
+    popext @v_udiv16_m
+    pushext @v_udiv16_t+1
+    popext @v_udiv16_m+1
+    pushimm 0x00
+    pushext @v_udiv16_a+1
+    add
+    popinh
+    pushext @v_udiv16_a
+    pushext @v_udiv16_a
+    jnn @l_udiv16_184
+    pushimm 0x01
+    add
+#l_udiv16_184
+    pushext @v_udiv16_a+1
+    pushext @v_udiv16_a+1
+    add
+    pushimm 0x01
+    add
+    popext @v_udiv16_a+1
+    add
+    popext @v_udiv16_a
+    jnz @l_udiv16_144
+    jnn @l_udiv16_144
+#l_udiv16_153
+    pushext @v_udiv16_t
+    popext @v_udiv16_m
+    pushext @v_udiv16_t+1
+    popext @v_udiv16_m+1
+    pushimm 0x00
+    pushext @v_udiv16_a+1
+    add
+    popinh
+    pushext @v_udiv16_a
+    pushext @v_udiv16_a
+    jnn @l_udiv16_185
+    pushimm 0x01
+    add
+#l_udiv16_185
+    pushext @v_udiv16_a+1
+    pushext @v_udiv16_a+1
+    add
+    pushimm 0x01
+    add
+    popext @v_udiv16_a+1
+    add
+    popext @v_udiv16_a
+    jnz @l_udiv16_154
+    jnn @l_udiv16_154
+#l_udiv16_163
+    pushext @v_udiv16_t
+    popext @v_udiv16_m
+    pushext @v_udiv16_t+1
+    popext @v_udiv16_m+1
+    pushimm 0x00
+    pushext @v_udiv16_a+1
+    add
+    popinh
+    pushext @v_udiv16_a
+    pushext @v_udiv16_a
+    jnn @l_udiv16_186
+    pushimm 0x01
+    add
+#l_udiv16_186
+    pushext @v_udiv16_a+1
+    pushext @v_udiv16_a+1
+    add
+    pushimm 0x01
+    add
+    popext @v_udiv16_a+1
+    add
+    popext @v_udiv16_a
+    jnz @l_udiv16_164
+    jnn @l_udiv16_164
+#v_udiv16_a 0x00
+    0x00
+#v_udiv16_b 0x00
+    0x00
+#v_udiv16_m 0x00
+    0x00
+#v_udiv16_t 0x00
+    0x00
@@ -0,0 +1,92 @@
+; udiv8: a / b, a % b unsigned, 8-bit, looped
+#f_udiv8
+    pushimm 0x00
+    pushext @v_udiv8_b
+    add
+    popinh
+    jnz @l_udiv8_2
+    pushext @v_udiv8_a
+    popext @v_udiv8_m
+    pushimm 0xFF
+    popext @v_udiv8_a
+    jnz @l_udiv8_1
+    jnn @l_udiv8_1
+#l_udiv8_2
+    jnn @l_udiv8_3
+    pushext @v_udiv8_a
+    popext @v_udiv8_m
+    pushimm 0x00
+    pushext @v_udiv8_a
+    add
+    popinh
+    jnn @l_udiv8_4
+    pushext @v_udiv8_b
+    pushext @v_udiv8_a
+    sub
+    jnn @l_udiv8_5
+    popinh
+#l_udiv8_4
+    pushimm 0x00
+    popext @v_udiv8_a
+    jnz @l_udiv8_1
+    jnn @l_udiv8_1
+#l_udiv8_3
+    pushimm 0x00
+    popext @v_udiv8_m
+    pushimm 0x07
+    popext @v_udiv8_i
+#l_udiv8_6
+    pushimm 0x00
+    pushext @v_udiv8_a
+    add
+    popinh
+    pushext @v_udiv8_b
+    pushext @v_udiv8_m
+    pushext @v_udiv8_m
+    jnn @l_udiv8_7
+    pushimm 0x01
+    add
+#l_udiv8_7
+    add
+    sub
+    jnn @l_udiv8_8
+    pushext @v_udiv8_b
+    add
+    popext @v_udiv8_m
+    pushext @v_udiv8_a
+    pushext @v_udiv8_a
+    add
+    popext @v_udiv8_a
+#l_udiv8_9
+    pushext @v_udiv8_i
+    pushimm 0xFF
+    add
+    popext @v_udiv8_i
+    jnn @l_udiv8_6
+#l_udiv8_1
+    pushext @v_udiv8_a
+    jnz @r_udiv8
+#l_udiv8_ret
+    pushimm 0x00
+    popext 0xFFFB
+#r_udiv8
+    jnz 0x0000
+#l_udiv8_5
+    popext @v_udiv8_m
+    pushimm 0x01
+    popext @v_udiv8_a
+    jnz @l_udiv8_1
+    jnn @l_udiv8_1
+#l_udiv8_8
+    popext @v_udiv8_m
+    pushext @v_udiv8_a
+    pushext @v_udiv8_a
+    add
+    pushimm 0x01
+    add
+    popext @v_udiv8_a
+    jnz @l_udiv8_9
+#v_udiv8_a 0x00
+#v_udiv8_b 0x00
+#v_udiv8_m 0x00
+#v_udiv8_i 0x00
@@ -0,0 +1,271 @@
+; udiv8: a / b, a % b unsigned, 8-bit, unrolled
+#f_udiv8
+    pushimm 0x00
+    pushext @v_udiv8_b
+    add
+    popinh
+    jnz @l_udiv8_2
+    pushext @v_udiv8_a
+    popext @v_udiv8_m
+    pushimm 0xFF
+    popext @v_udiv8_a
+    jnz @l_udiv8_29
+    jnn @l_udiv8_29
+#l_udiv8_2
+    jnn @l_udiv8_3
+    pushext @v_udiv8_a
+    popext @v_udiv8_m
+    pushimm 0x00
+    pushext @v_udiv8_a
+    add
+    popinh
+    jnn @l_udiv8_4
+    pushext @v_udiv8_b
+    pushext @v_udiv8_a
+    sub
+    jnn @l_udiv8_5
+    popinh
+#l_udiv8_4
+    pushimm 0x00
+    popext @v_udiv8_a
+    jnz @l_udiv8_29
+    jnn @l_udiv8_29
+#l_udiv8_3
+    pushimm 0x00
+    popext @v_udiv8_m
+    pushimm 0x00
+    pushext @v_udiv8_a
+    add
+    popinh
+    pushext @v_udiv8_b
+    pushext @v_udiv8_m
+    pushext @v_udiv8_m
+    jnn @l_udiv8_6
+    pushimm 0x01
+    add
+#l_udiv8_6
+    add
+    sub
+    jnn @l_udiv8_7
+    pushext @v_udiv8_b
+    add
+    popext @v_udiv8_m
+    pushext @v_udiv8_a
+    pushext @v_udiv8_a
+    add
+    popext @v_udiv8_a
+#l_udiv8_8
+    pushext @v_udiv8_b
+    pushext @v_udiv8_m
+    pushext @v_udiv8_m
+    jnn @l_udiv8_9
+    pushimm 0x01
+    add
+#l_udiv8_9
+    add
+    sub
+    jnn @l_udiv8_10
+    pushext @v_udiv8_b
+    add
+    popext @v_udiv8_m
+    pushext @v_udiv8_a
+    pushext @v_udiv8_a
+    add
+    popext @v_udiv8_a
+#l_udiv8_11
+    pushext @v_udiv8_b
+    pushext @v_udiv8_m
+    pushext @v_udiv8_m
+    jnn @l_udiv8_12
+    pushimm 0x01
+    add
+#l_udiv8_12
+    add
+    sub
+    jnn @l_udiv8_13
+    pushext @v_udiv8_b
+    add
+    popext @v_udiv8_m
+    pushext @v_udiv8_a
+    pushext @v_udiv8_a
+    add
+    popext @v_udiv8_a
+#l_udiv8_14
+    pushext @v_udiv8_b
+    pushext @v_udiv8_m
+    pushext @v_udiv8_m
+    jnn @l_udiv8_15
+    pushimm 0x01
+    add
+#l_udiv8_15
+    add
+    sub
+    jnn @l_udiv8_16
+    pushext @v_udiv8_b
+    add
+    popext @v_udiv8_m
+    pushext @v_udiv8_a
+    pushext @v_udiv8_a
+    add
+    popext @v_udiv8_a
+#l_udiv8_17
+    pushext @v_udiv8_b
+    pushext @v_udiv8_m
+    pushext @v_udiv8_m
+    jnn @l_udiv8_18
+    pushimm 0x01
+    add
+#l_udiv8_18
+    add
+    sub
+    jnn @l_udiv8_19
+    pushext @v_udiv8_b
+    add
+    popext @v_udiv8_m
+    pushext @v_udiv8_a
+    pushext @v_udiv8_a
+    add
+    popext @v_udiv8_a
+#l_udiv8_20
+    pushext @v_udiv8_b
+    pushext @v_udiv8_m
+    pushext @v_udiv8_m
+    jnn @l_udiv8_21
+    pushimm 0x01
+    add
+#l_udiv8_21
+    add
+    sub
+    jnn @l_udiv8_22
+    pushext @v_udiv8_b
+    add
+    popext @v_udiv8_m
+    pushext @v_udiv8_a
+    pushext @v_udiv8_a
+    add
+    popext @v_udiv8_a
+#l_udiv8_23
+    pushext @v_udiv8_b
+    pushext @v_udiv8_m
+    pushext @v_udiv8_m
+    jnn @l_udiv8_24
+    pushimm 0x01
+    add
+#l_udiv8_24
+    add
+    sub
+    jnn @l_udiv8_25
+    pushext @v_udiv8_b
+    add
+    popext @v_udiv8_m
+    pushext @v_udiv8_a
+    pushext @v_udiv8_a
+    add
+    popext @v_udiv8_a
+#l_udiv8_26
+    pushext @v_udiv8_b
+    pushext @v_udiv8_m
+    pushext @v_udiv8_m
+    jnn @l_udiv8_27
+    pushimm 0x01
+    add
+#l_udiv8_27
+    add
+    sub
+    jnn @l_udiv8_28
+    pushext @v_udiv8_b
+    add
+    popext @v_udiv8_m
+    pushext @v_udiv8_a
+    pushext @v_udiv8_a
+    add
+    popext @v_udiv8_a
+#l_udiv8_29
+    pushext @v_udiv8_a
+    jnz @r_udiv8
+#l_udiv8_ret
+    pushimm 0x00
+    popext 0xFFFB
+#r_udiv8
+    jnz 0x0000
+#l_udiv8_5
+    popext @v_udiv8_m
+    pushimm 0x01
+    popext @v_udiv8_a
+    jnz @l_udiv8_29
+    jnn @l_udiv8_29
+#l_udiv8_7
+    popext @v_udiv8_m
+    pushext @v_udiv8_a
+    pushext @v_udiv8_a
+    add
+    pushimm 0x01
+    add
+    popext @v_udiv8_a
+    jnz @l_udiv8_8
+#l_udiv8_10
+    popext @v_udiv8_m
+    pushext @v_udiv8_a
+    pushext @v_udiv8_a
+    add
+    pushimm 0x01
+    add
+    popext @v_udiv8_a
+    jnz @l_udiv8_11
+#l_udiv8_13
+    popext @v_udiv8_m
+    pushext @v_udiv8_a
+    pushext @v_udiv8_a
+    add
+    pushimm 0x01
+    add
+    popext @v_udiv8_a
+    jnz @l_udiv8_14
+#l_udiv8_16
+    popext @v_udiv8_m
+    pushext @v_udiv8_a
+    pushext @v_udiv8_a
+    add
+    pushimm 0x01
+    add
+    popext @v_udiv8_a
+    jnz @l_udiv8_17
+#l_udiv8_19
+    popext @v_udiv8_m
+    pushext @v_udiv8_a
+    pushext @v_udiv8_a
+    add
+    pushimm 0x01
+    add
+    popext @v_udiv8_a
+    jnz @l_udiv8_20
+#l_udiv8_22
+    popext @v_udiv8_m
+    pushext @v_udiv8_a
+    pushext @v_udiv8_a
+    add
+    pushimm 0x01
+    add
+    popext @v_udiv8_a
+    jnz @l_udiv8_23
+#l_udiv8_25
+    popext @v_udiv8_m
+    pushext @v_udiv8_a
+    pushext @v_udiv8_a
+    add
+    pushimm 0x01
+    add
+    popext @v_udiv8_a
+    jnz @l_udiv8_26
+#l_udiv8_28
+    popext @v_udiv8_m
+    pushext @v_udiv8_a
+    pushext @v_udiv8_a
+    add
+    pushimm 0x01
+    add
+    popext @v_udiv8_a
+    jnz @l_udiv8_29
+#v_udiv8_a 0x00
+#v_udiv8_b 0x00
+#v_udiv8_m 0x00
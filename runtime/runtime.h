@@ -0,0 +1,1301 @@
+/*
+    the runtime library: routines for the operations ssbc has no instruction for (multiply,
+    divide, shifts and compare) generated as assembly, each in a looped and an unrolled variant
+
+    a routine is called like a compiled function: its arguments are popped into '@v_<name>_a' and
+    '@v_<name>_b', the return address is written to '@r_<name>+1' and '@r_<name>+2', and it is
+    entered with 'jnz @f_<name>' 'jnn @f_<name>'
+    - 8-bit routines push their result; udiv8 also leaves the remainder in '@v_udiv8_m'
+    - 16-bit values are big-endian, '@v_<name>_a' being the high byte and '@v_<name>_a+1' the low;
+      16-bit routines leave their result in a, and udiv16 the remainder in m
+    - cmp routines push -1, 0 or 1 for a < b, a == b and a > b, and return with N set only if a < b,
+      so that the caller can branch on the result with a 'jnn'
+    each routine's variables follow its code, so a routine is placed with '.include' or by
+    pasting its text, and its labels are kept apart by its name
+*/
+
+#ifndef RUNTIME_H
+#define RUNTIME_H
+
+#include <string>
+#include <vector>
+#include <map>
+#include <sstream>
+#include <functional>
+#include "../common.h"
+
+// writes the assembly of one routine, with its labels prefixed by the routine's name
+class RoutineWriter {
+    public:
+    RoutineWriter(const std::string& _name) : name(_name) { }
+
+    std::string name;
+    // the deepest the routine takes the stack
+    int maxDepth = 0;
+
+    // what the flags are known to be when the code falls through to the return
+    enum End {
+        end_zClear,     // Z is clear, so the return jump is taken as is
+        end_zSet,       // Z is set, so the PSW is cleared first
+        end_unknown,    // Z may be set, so it is tested
+        end_none        // the code doesn't fall through
+    };
+
+    std::string returnLabel() { return "r_" + name; }
+    std::string entryLabel() { return "f_" + name; }
+    // clears the PSW and then returns, for when Z may be set
+    std::string fixLabel() { return "l_" + name + "_ret"; }
+
+    // the operand naming byte offset of a variable
+    std::string var(const std::string& variable, int offset = 0) {
+        return "@v_" + name + "_" + variable + (offset > 0 ? "+" + std::to_string(offset) : "");
+    }
+
+    // a variable of size bytes, placed after the code
+    void declare(const std::string& variable, int size = 1) {
+        data.push_back(std::make_pair(variable, size));
+    }
+
+    std::string newLabel() {
+        return "l_" + name + "_" + std::to_string(++labelCount);
+    }
+
+    void label(const std::string& l) {
+        pendingLabels.push_back(l);
+    }
+
+    void pushVar(const std::string& variable, int offset = 0) { emit("pushext " + var(variable, offset), 1); }
+    void pushImm(int value) { emit("pushimm 0x" + byte2hex(value & 0xFF), 1); }
+    void popVar(const std::string& variable, int offset = 0) { emit("popext " + var(variable, offset), -1); }
+    void popPSW() { emit("popext 0x" + twoBytes2hex(map_PSW), -1); }
+    void popInh() { emit("popinh", -1); }
+    void add() { emit("add", -1); }
+    // s1 - s2: the top of the stack minus the one under it
+    void sub() { emit("sub", -1); }
+    void nor() { emit("nor", -1); }
+    void jnz(const std::string& target) { emit("jnz @" + target, 0); }
+    void jnn(const std::string& target) { emit("jnn @" + target, 0); }
+
+    // jumps whatever the flags, leaving them as they are
+    void jump(const std::string& target) {
+        jnz(target);
+        jnn(target);
+    }
+
+    // returns with the result in place and the flags as they come
+    void ret() {
+        jnz(returnLabel());
+        jnn(fixLabel());
+        isFixUsed = true;
+    }
+
+    // sets the flags from a variable
+    void test(const std::string& variable, int offset = 0) {
+        pushImm(0);
+        pushVar(variable, offset);
+        add();
+        popInh();
+    }
+
+    // the depth of the stack where code is only reached by a jump
+    void setDepth(int _depth) {
+        depth = _depth;
+    }
+
+    // code placed after the return, reached only by jumps, written by generate with the stack at depth
+    void later(int _depth, std::function<void()> generate) {
+        deferred.push_back(std::make_pair(_depth, generate));
+    }
+
+    // places the return, after which the deferred code and the data go
+    void finish(End end) {
+        if(end == end_unknown) {
+            jnz(returnLabel());
+        }
+        if(end == end_unknown || end == end_zSet) {
+            label(fixLabel());
+            pushImm(0);
+            popPSW();
+            isFixPlaced = true;
+        }
+        label(returnLabel());
+        emit("jnz 0x0000", 0);
+    }
+
+    // the routine's text, with the labels which share an address made one
+    std::string text() {
+        close();
+        std::ostringstream os;
+        for(auto line : lines) {
+            size_t at = line.find('@');
+            if(at != std::string::npos) {
+                size_t end = line.find_first_of("+. ", at);
+                std::string target = line.substr(at + 1, end == std::string::npos ? std::string::npos : end - at - 1);
+                auto alias = aliases.find(target);
+                if(alias != aliases.end()) {
+                    line.replace(at + 1, target.size(), alias->second);
+                }
+            }
+            os << line << std::endl;
+        }
+        return os.str();
+    }
+
+    private:
+    std::vector<std::string> lines;
+    std::vector<std::string> pendingLabels;
+    std::map<std::string, std::string> aliases;
+    std::vector<std::pair<std::string, int>> data;
+    std::vector<std::pair<int, std::function<void()>>> deferred;
+    int labelCount = 0;
+    int depth = 0;
+    bool isFixUsed = false;
+    bool isFixPlaced = false;
+    bool isClosed = false;
+
+    // places the deferred code, the fix if only deferred code uses it, and the data
+    void close() {
+        if(isClosed) {
+            return;
+        }
+        isClosed = true;
+        // deferred code may defer more
+        for(size_t i = 0; i < deferred.size(); i++) {
+            depth = deferred[i].first;
+            deferred[i].second();
+        }
+        if(isFixUsed && !isFixPlaced) {
+            label(fixLabel());
+            pushImm(0);
+            popPSW();
+            jnz(returnLabel());
+        }
+        for(const auto& variable : data) {
+            lines.push_back("#v_" + name + "_" + variable.first + " 0x00");
+            for(int i = 1; i < variable.second; i++) {
+                lines.push_back("    0x00");
+            }
+        }
+    }
+
+    void emit(const std::string& instruction, int change) {
+        if(!pendingLabels.empty()) {
+            // only one label may be placed on an address: the entry and return keep theirs,
+            // as callers name them
+            std::string placed = pendingLabels[0];
+            for(const auto& pending : pendingLabels) {
+                if(pending == returnLabel() || pending == entryLabel()) {
+                    placed = pending;
+                }
+            }
+            for(const auto& pending : pendingLabels) {
+                if(pending != placed) {
+                    aliases[pending] = placed;
+                }
+            }
+            lines.push_back("#" + placed);
+            pendingLabels.clear();
+        }
+        lines.push_back("    " + instruction);
+        depth += change;
+        maxDepth = std::max(maxDepth, depth);
+    }
+};
+
+/*
+    the routines
+    loop counters count down to -1, so that a loop exits with Z clear and the return needs no fix
+*/
+
+// counts a loop: decrements the counter, jumping to loop while it is not negative
+void countDown(RoutineWriter& w, const std::string& counter, const std::string& loop) {
+    w.pushVar(counter);
+    w.pushImm(0xFF);
+    w.add();
+    w.popVar(counter);
+    w.jnn(loop);
+}
+
+// v = v + v, setting N from the top bit of the result
+void double8(RoutineWriter& w, const std::string& v, int offset = 0) {
+    w.pushVar(v, offset);
+    w.pushVar(v, offset);
+    w.add();
+    w.popVar(v, offset);
+}
+
+// sets Z if v has none of the bits outside mask, as nor(~v, mask) = v & ~mask
+void testOutside(RoutineWriter& w, const std::string& v, int mask) {
+    w.pushVar(v);
+    w.pushVar(v);
+    w.nor();
+    w.pushImm(mask);
+    w.nor();
+    w.pushImm(0);
+    w.add();
+    w.popInh();
+}
+
+// jumps to entries[v] for v in [low, high), where v is known to be in that range
+void dispatch(RoutineWriter& w, const std::string& v, int low, int high, const std::vector<std::string>& entries) {
+    if(high - low == 1) {
+        w.jump(entries[low]);
+        return;
+    }
+    int middle = (low + high) / 2;
+    w.pushImm(-middle);
+    w.pushVar(v);
+    w.add();
+    w.popInh();
+    if(high - low == 2) {
+        // v - middle is negative, so Z is clear
+        w.jnn(entries[middle]);
+        w.jnz(entries[low]);
+        return;
+    }
+    std::string upper = w.newLabel();
+    w.jnn(upper);
+    dispatch(w, v, low, middle, entries);
+    w.label(upper);
+    dispatch(w, v, middle, high, entries);
+}
+
+// r = r + r, plus x if the next bit of y (brought to the top by doubling y) is set
+// r is left on the stack if not stored
+void mulStep(RoutineWriter& w, const std::string& x, int xOffset, const std::string& y, int yOffset, const std::string& r, bool isStored) {
+    std::string skip = w.newLabel();
+    w.pushVar(r);
+    w.pushVar(r);
+    double8(w, y, yOffset);
+    w.jnn(skip);
+    w.pushVar(x, xOffset);
+    w.add();
+    w.label(skip);
+    w.add();
+    if(isStored) {
+        w.popVar(r);
+    }
+}
+
+// r = x * y by Horner's rule from the top bit of y, leaving r on the stack
+// y is shifted out, and i is the loop counter
+void mulBytes(RoutineWriter& w, bool isUnrolled, const std::string& x, int xOffset, const std::string& y, int yOffset, const std::string& r, const std::string& i) {
+    std::string skip = w.newLabel();
+    w.test(y, yOffset);
+    w.pushImm(0);
+    w.jnn(skip);
+    w.pushVar(x, xOffset);
+    w.add();
+    w.label(skip);
+    w.popVar(r);
+    if(isUnrolled) {
+        for(int bit = 6; bit >= 0; bit--) {
+            mulStep(w, x, xOffset, y, yOffset, r, bit > 0);
+        }
+        return;
+    }
+    std::string loop = w.newLabel();
+    w.pushImm(6);
+    w.popVar(i);
+    w.label(loop);
+    mulStep(w, x, xOffset, y, yOffset, r, true);
+    countDown(w, i, loop);
+    w.pushVar(r);
+}
+
+// a * b
+void genMul8(RoutineWriter& w, bool isUnrolled) {
+    w.declare("a");
+    w.declare("b");
+    w.declare("r");
+    if(!isUnrolled) {
+        w.declare("i");
+    }
+    mulBytes(w, isUnrolled, "a", 0, "b", 0, "r", "i");
+    w.finish(isUnrolled ? RoutineWriter::end_unknown : RoutineWriter::end_zClear);
+}
+
+// one step of restoring division, with N the top bit of a:
+// m = m + m + that bit, and if m >= b then m = m - b and the quotient bit is 1
+// a is doubled with the quotient bit coming in at the bottom, leaving N its next top bit
+// b < 128, so m - b is within 8 bits signed
+void udivStep8(RoutineWriter& w) {
+    std::string carry = w.newLabel(), fits = w.newLabel(), next = w.newLabel();
+    w.pushVar("b");
+    w.pushVar("m");
+    w.pushVar("m");
+    w.jnn(carry);
+    w.pushImm(1);
+    w.add();
+    w.label(carry);
+    w.add();
+    w.sub();
+    w.jnn(fits);
+    // m + m + bit = (m + m + bit - b) + b
+    w.pushVar("b");
+    w.add();
+    w.popVar("m");
+    double8(w, "a");
+    w.label(next);
+    w.later(1, [&w, fits, next]() {
+        w.label(fits);
+        w.popVar("m");
+        w.pushVar("a");
+        w.pushVar("a");
+        w.add();
+        w.pushImm(1);
+        w.add();
+        w.popVar("a");
+        // a is odd, so Z is clear
+        w.jnz(next);
+    });
+}
+
+// a / b unsigned, leaving the quotient in a and the remainder in m, then going to done
+// dividing by 0 gives a quotient of 0xFF and a remainder of a
+void udivBytes(RoutineWriter& w, bool isUnrolled, const std::string& done) {
+    std::string nonzero = w.newLabel(), small = w.newLabel(), zero = w.newLabel(), one = w.newLabel();
+    w.test("b");
+    w.jnz(nonzero);
+    w.pushVar("a");
+    w.popVar("m");
+    w.pushImm(0xFF);
+    w.popVar("a");
+    w.jump(done);
+
+    // b >= 128: the quotient is 1 if a >= b, unsigned
+    w.label(nonzero);
+    w.jnn(small);
+    w.pushVar("a");
+    w.popVar("m");
+    w.test("a");
+    w.jnn(zero);
+    w.pushVar("b");
+    w.pushVar("a");
+    w.sub();
+    w.jnn(one);
+    w.popInh();
+    w.label(zero);
+    w.pushImm(0);
+    w.popVar("a");
+    w.jump(done);
+    w.later(1, [&w, one, done]() {
+        w.label(one);
+        w.popVar("m");
+        w.pushImm(1);
+        w.popVar("a");
+        w.jump(done);
+    });
+
+    w.label(small);
+    w.pushImm(0);
+    w.popVar("m");
+    if(isUnrolled) {
+        w.test("a");
+        for(int step = 0; step < 8; step++) {
+            udivStep8(w);
+        }
+    } else {
+        std::string loop = w.newLabel();
+        w.pushImm(7);
+        w.popVar("i");
+        w.label(loop);
+        w.test("a");
+        udivStep8(w);
+        countDown(w, "i", loop);
+    }
+    w.label(done);
+}
+
+// a / b unsigned, with the remainder left in m
+void genUdiv8(RoutineWriter& w, bool isUnrolled) {
+    w.declare("a");
+    w.declare("b");
+    w.declare("m");
+    if(!isUnrolled) {
+        w.declare("i");
+    }
+    udivBytes(w, isUnrolled, w.newLabel());
+    w.pushVar("a");
+    w.finish(RoutineWriter::end_unknown);
+}
+
+// v = -v
+void negate(RoutineWriter& w, const std::string& v) {
+    w.pushVar(v);
+    w.pushImm(0);
+    w.sub();
+    w.popVar(v);
+}
+
+// a / b rounding toward zero, or a % b with the sign of a, on the magnitudes
+// s is 1 if the result is negated
+// dividing by 0 gives 1 for a negative a and -1 otherwise, and a % 0 is a
+void genSignedDivide(RoutineWriter& w, bool isUnrolled, bool isMod) {
+    w.declare("a");
+    w.declare("b");
+    w.declare("m");
+    w.declare("s");
+    if(!isUnrolled) {
+        w.declare("i");
+    }
+    std::string aPositive = w.newLabel(), bPositive = w.newLabel(), done = w.newLabel(), negative = w.newLabel();
+    w.pushImm(0);
+    w.popVar("s");
+    w.test("a");
+    w.jnn(aPositive);
+    negate(w, "a");
+    w.pushImm(1);
+    w.popVar("s");
+    w.label(aPositive);
+    w.test("b");
+    w.jnn(bPositive);
+    negate(w, "b");
+    if(!isMod) {
+        w.pushVar("s");
+        w.pushImm(1);
+        w.sub();
+        w.popVar("s");
+    }
+    w.label(bPositive);
+    udivBytes(w, isUnrolled, done);
+    w.pushVar(isMod ? "m" : "a");
+    w.test("s");
+    w.jnz(negative);
+    w.finish(RoutineWriter::end_zSet);
+    w.later(1, [&w, negative]() {
+        w.label(negative);
+        w.pushImm(0);
+        w.sub();
+        w.ret();
+    });
+}
+
+void genDiv8(RoutineWriter& w, bool isUnrolled) {
+    genSignedDivide(w, isUnrolled, false);
+}
+
+void genMod8(RoutineWriter& w, bool isUnrolled) {
+    genSignedDivide(w, isUnrolled, true);
+}
+
+// a << b, with b unsigned: 8 or more shifts everything out
+void genShl8(RoutineWriter& w, bool isUnrolled) {
+    w.declare("a");
+    w.declare("b");
+    std::string zero = w.newLabel();
+    testOutside(w, "b", 0x07);
+    w.jnz(zero);
+    w.later(0, [&w, zero]() {
+        w.label(zero);
+        w.pushImm(0);
+        w.jnz(w.returnLabel());
+    });
+
+    if(!isUnrolled) {
+        std::string body = w.newLabel(), test = w.newLabel();
+        // Z is set
+        w.jnn(test);
+        w.label(body);
+        double8(w, "a");
+        w.label(test);
+        countDown(w, "b", body);
+        w.pushVar("a");
+        w.finish(RoutineWriter::end_zClear);
+        return;
+    }
+
+    // a chain of doublings, entered with b of them left
+    std::vector<std::string> entries;
+    for(int k = 0; k < 8; k++) {
+        entries.push_back(w.newLabel());
+    }
+    dispatch(w, "b", 0, 8, entries);
+    for(int k = 7; k >= 1; k--) {
+        w.label(entries[k]);
+        w.pushVar("a");
+        w.pushVar("a");
+        w.add();
+        if(k > 1) {
+            w.popVar("a");
+        }
+    }
+    w.finish(RoutineWriter::end_unknown);
+    w.later(0, [&w, entries]() {
+        w.label(entries[0]);
+        w.pushVar("a");
+        w.ret();
+    });
+}
+
+// r = r + r + the next bit of a, brought to the top by doubling a
+void shiftInStep(RoutineWriter& w, bool isStored) {
+    std::string skip = w.newLabel();
+    w.pushVar("r");
+    w.pushVar("r");
+    double8(w, "a");
+    w.jnn(skip);
+    w.pushImm(1);
+    w.add();
+    w.label(skip);
+    w.add();
+    if(isStored) {
+        w.popVar("r");
+    }
+}
+
+// a >> b, with b unsigned, copying the sign bit: r starts as the sign and the top 8 - b bits of a
+// are shifted into it; 8 or more shifts leave the sign
+void genShr8(RoutineWriter& w, bool isUnrolled) {
+    w.declare("a");
+    w.declare("b");
+    w.declare("r");
+    if(!isUnrolled) {
+        w.declare("i");
+    }
+    std::string positive = w.newLabel(), fill = w.newLabel();
+    w.test("a");
+    w.pushImm(0);
+    w.jnn(positive);
+    w.pushImm(0xFF);
+    w.add();
+    w.label(positive);
+    w.popVar("r");
+    testOutside(w, "b", 0x07);
+    w.jnz(fill);
+    w.later(0, [&w, fill]() {
+        w.label(fill);
+        w.pushVar("r");
+        w.jnz(w.returnLabel());
+    });
+
+    if(!isUnrolled) {
+        std::string body = w.newLabel(), test = w.newLabel();
+        // 7 - b bits come in after the sign
+        w.pushVar("b");
+        w.pushImm(7);
+        w.sub();
+        w.popVar("i");
+        w.jnn(test);
+        w.label(body);
+        shiftInStep(w, true);
+        w.label(test);
+        countDown(w, "i", body);
+        w.pushVar("r");
+        w.finish(RoutineWriter::end_zClear);
+        return;
+    }
+
+    std::vector<std::string> entries;
+    for(int k = 0; k < 8; k++) {
+        entries.push_back(w.newLabel());
+    }
+    dispatch(w, "b", 0, 8, entries);
+    for(int k = 1; k <= 6; k++) {
+        w.label(entries[k]);
+        shiftInStep(w, k < 6);
+    }
+    w.finish(RoutineWriter::end_unknown);
+    w.later(0, [&w, entries]() {
+        w.label(entries[0]);
+        w.pushVar("a");
+        w.ret();
+        w.label(entries[7]);
+        w.pushVar("r");
+        w.ret();
+    });
+}
+
+// jumps to less or greater for bytes x and y known to differ, signed or unsigned
+void compareBytes(RoutineWriter& w, const std::string& x, int xOffset, const std::string& y, int yOffset, bool isSigned,
+    const std::string& less, const std::string& greater) {
+    std::string xPositive = w.newLabel(), same = w.newLabel();
+    // the top bits differ: for signed, the negative one is less, for unsigned, greater
+    const std::string& xNegative = isSigned ? less : greater;
+    const std::string& yNegative = isSigned ? greater : less;
+    w.test(x, xOffset);
+    w.jnn(xPositive);
+    w.test(y, yOffset);
+    w.jnn(xNegative);
+    w.jnz(same);
+    w.label(xPositive);
+    w.test(y, yOffset);
+    w.jnn(same);
+    w.jnz(yNegative);
+    // the top bits are the same, so x - y doesn't overflow
+    w.label(same);
+    w.pushVar(y, yOffset);
+    w.pushVar(x, xOffset);
+    w.sub();
+    w.popInh();
+    w.jnn(greater);
+    w.jnz(less);
+}
+
+// pushes -1 with N set, or 1 with N clear, and returns
+void compareResults(RoutineWriter& w, const std::string& less, const std::string& greater) {
+    w.later(0, [&w, less, greater]() {
+        w.label(less);
+        w.pushImm(0xFF);
+        w.pushImm(0x40);
+        w.popPSW();
+        w.jnz(w.returnLabel());
+        w.label(greater);
+        w.pushImm(1);
+        w.pushImm(0);
+        w.popPSW();
+        w.jnz(w.returnLabel());
+    });
+}
+
+void genCompare8(RoutineWriter& w, bool isSigned) {
+    w.declare("a");
+    w.declare("b");
+    std::string differ = w.newLabel(), less = w.newLabel(), greater = w.newLabel();
+    w.pushVar("b");
+    w.pushVar("a");
+    w.sub();
+    w.jnz(differ);
+    w.later(1, [&w, differ, isSigned, less, greater]() {
+        w.label(differ);
+        w.popInh();
+        compareBytes(w, "a", 0, "b", 0, isSigned, less, greater);
+    });
+    compareResults(w, less, greater);
+    // 0 is on the stack
+    w.finish(RoutineWriter::end_zSet);
+}
+
+void genCmp8(RoutineWriter& w, bool isUnrolled) {
+    genCompare8(w, true);
+}
+
+void genUcmp8(RoutineWriter& w, bool isUnrolled) {
+    genCompare8(w, false);
+}
+
+/*
+    16-bit routines
+*/
+
+// v = v + v over 16 bits, the low byte's top bit carried into the high byte
+// leaves N the top bit of the new low byte, which is what the next doubling tests
+void double16(RoutineWriter& w, const std::string& v, bool isTested = false) {
+    std::string skip = w.newLabel();
+    if(!isTested) {
+        w.test(v, 1);
+    }
+    w.pushVar(v);
+    w.pushVar(v);
+    w.jnn(skip);
+    w.pushImm(1);
+    w.add();
+    w.label(skip);
+    w.add();
+    w.popVar(v);
+    double8(w, v, 1);
+}
+
+// x = x + y over 16 bits
+// the low bytes' sum s carries if s < y unsigned: when the top bits of s and y differ, that is
+// the top bit of y, otherwise s - y doesn't overflow and it is its sign
+void add16(RoutineWriter& w, const std::string& x, const std::string& y) {
+    std::string sPositive = w.newLabel(), same = w.newLabel(), carry = w.newLabel(), noCarry = w.newLabel(), done = w.newLabel();
+    w.pushVar(y, 1);
+    w.pushVar(x, 1);
+    w.add();
+    w.popVar(x, 1);
+    w.jnn(sPositive);
+    w.test(y, 1);
+    w.jnn(noCarry);
+    w.label(same);
+    w.pushVar(y, 1);
+    w.pushVar(x, 1);
+    w.sub();
+    w.popInh();
+    w.jnn(noCarry);
+    w.label(carry);
+    w.pushVar(y);
+    w.pushVar(x);
+    w.add();
+    w.pushImm(1);
+    w.add();
+    w.popVar(x);
+    w.jump(done);
+    w.label(sPositive);
+    w.test(y, 1);
+    w.jnn(same);
+    w.jnz(carry);
+    w.label(noCarry);
+    w.pushVar(y);
+    w.pushVar(x);
+    w.add();
+    w.popVar(x);
+    w.label(done);
+}
+
+// t = x - y over 16 bits, leaving the flags from the high byte
+// the low bytes borrow if x < y unsigned: when their top bits differ, that is the top bit of y,
+// otherwise it is the sign of their difference
+void sub16(RoutineWriter& w, const std::string& t, const std::string& x, const std::string& y) {
+    std::string xPositive = w.newLabel(), same = w.newLabel(), borrow = w.newLabel(), noBorrow = w.newLabel(), done = w.newLabel();
+    w.pushVar(y, 1);
+    w.pushVar(x, 1);
+    w.sub();
+    w.popVar(t, 1);
+    w.test(x, 1);
+    w.jnn(xPositive);
+    w.test(y, 1);
+    w.jnn(noBorrow);
+    w.label(same);
+    w.test(t, 1);
+    w.jnn(noBorrow);
+    w.label(borrow);
+    w.pushVar(y);
+    w.pushVar(x);
+    w.sub();
+    w.pushImm(0xFF);
+    w.add();
+    w.popVar(t);
+    w.jump(done);
+    w.label(xPositive);
+    w.test(y, 1);
+    w.jnn(same);
+    w.jnz(borrow);
+    w.label(noBorrow);
+    w.pushVar(y);
+    w.pushVar(x);
+    w.sub();
+    w.popVar(t);
+    w.label(done);
+}
+
+// a * b, as a * (the low byte of b) by Horner's rule over 16 bits,
+// plus (the low byte of a * the high byte of b) << 8
+void genMul16(RoutineWriter& w, bool isUnrolled) {
+    w.declare("a", 2);
+    w.declare("b", 2);
+    w.declare("r", 2);
+    w.declare("t");
+    if(!isUnrolled) {
+        w.declare("i");
+    }
+    std::string zero = w.newLabel(), start = w.newLabel();
+    w.test("b", 1);
+    w.jnn(zero);
+    w.pushVar("a");
+    w.popVar("r");
+    w.pushVar("a", 1);
+    w.popVar("r", 1);
+    // N is set, so Z is clear
+    w.jnz(start);
+    w.label(zero);
+    w.pushImm(0);
+    w.popVar("r");
+    w.pushImm(0);
+    w.popVar("r", 1);
+    w.label(start);
+
+    std::string loop = w.newLabel();
+    if(!isUnrolled) {
+        w.pushImm(6);
+        w.popVar("i");
+        w.label(loop);
+    }
+    for(int bit = isUnrolled ? 6 : 0; bit >= 0; bit--) {
+        std::string skip = w.newLabel();
+        double16(w, "r");
+        double8(w, "b", 1);
+        w.jnn(skip);
+        add16(w, "r", "a");
+        w.label(skip);
+    }
+    if(!isUnrolled) {
+        countDown(w, "i", loop);
+    }
+
+    mulBytes(w, isUnrolled, "a", 1, "b", 0, "t", "i");
+    w.pushVar("r");
+    w.add();
+    w.popVar("a");
+    w.pushVar("r", 1);
+    w.popVar("a", 1);
+    w.finish(RoutineWriter::end_unknown);
+}
+
+// a = a + a + bit over 16 bits, leaving N the top bit of the new high byte
+void shiftQuotient(RoutineWriter& w, int bit) {
+    std::string skip = w.newLabel();
+    w.test("a", 1);
+    w.pushVar("a");
+    w.pushVar("a");
+    w.jnn(skip);
+    w.pushImm(1);
+    w.add();
+    w.label(skip);
+    w.pushVar("a", 1);
+    w.pushVar("a", 1);
+    w.add();
+    if(bit) {
+        w.pushImm(1);
+        w.add();
+    }
+    w.popVar("a", 1);
+    w.add();
+    w.popVar("a");
+}
+
+// one step of restoring division over 16 bits, with N the top bit of a, as udivStep8
+// b < 0x8000, so m - b is within 16 bits signed
+void udivStep16(RoutineWriter& w) {
+    std::string carry = w.newLabel(), carryHigh = w.newLabel(), fits = w.newLabel(), next = w.newLabel();
+    // m = m + m + the top bit of a: the low byte is doubled on the stack while the carry out of
+    // it is tested
+    w.pushVar("m", 1);
+    w.pushVar("m", 1);
+    w.jnn(carry);
+    w.pushImm(1);
+    w.add();
+    w.label(carry);
+    w.add();
+    w.test("m", 1);
+    w.pushVar("m");
+    w.pushVar("m");
+    w.jnn(carryHigh);
+    w.pushImm(1);
+    w.add();
+    w.label(carryHigh);
+    w.add();
+    w.popVar("m");
+    w.popVar("m", 1);
+    sub16(w, "t", "m", "b");
+    w.jnn(fits);
+    shiftQuotient(w, 0);
+    w.label(next);
+    w.later(0, [&w, fits, next]() {
+        w.label(fits);
+        w.pushVar("t");
+        w.popVar("m");
+        w.pushVar("t", 1);
+        w.popVar("m", 1);
+        shiftQuotient(w, 1);
+        w.jump(next);
+    });
+}
+
+// a / b unsigned, leaving the remainder in m
+// dividing by 0 gives a quotient of 0xFFFF and a remainder of a
+void genUdiv16(RoutineWriter& w, bool isUnrolled) {
+    w.declare("a", 2);
+    w.declare("b", 2);
+    w.declare("m", 2);
+    w.declare("t", 2);
+    if(!isUnrolled) {
+        w.declare("i");
+    }
+    std::string nonzero = w.newLabel(), small = w.newLabel(), zero = w.newLabel(), one = w.newLabel(), done = w.newLabel();
+    w.pushVar("a");
+    w.popVar("m");
+    w.pushVar("a", 1);
+    w.popVar("m", 1);
+    // Z is set if b is 0, as ~~(b | b+1) + 0
+    w.pushVar("b");
+    w.pushVar("b", 1);
+    w.nor();
+    w.pushImm(0);
+    w.nor();
+    w.pushImm(0);
+    w.add();
+    w.popInh();
+    w.jnz(nonzero);
+    w.pushImm(0xFF);
+    w.popVar("a");
+    w.pushImm(0xFF);
+    w.popVar("a", 1);
+    w.jump(done);
+
+    // b >= 0x8000: the quotient is 1 if a >= b, unsigned
+    w.label(nonzero);
+    w.test("b");
+    w.jnn(small);
+    w.test("a");
+    w.jnn(zero);
+    sub16(w, "t", "a", "b");
+    w.jnn(one);
+    w.label(zero);
+    w.pushImm(0);
+    w.popVar("a");
+    w.pushImm(0);
+    w.popVar("a", 1);
+    w.jump(done);
+    w.later(0, [&w, one, done]() {
+        w.label(one);
+        w.pushVar("t");
+        w.popVar("m");
+        w.pushVar("t", 1);
+        w.popVar("m", 1);
+        w.pushImm(0);
+        w.popVar("a");
+        w.pushImm(1);
+        w.popVar("a", 1);
+        w.jump(done);
+    });
+
+    w.label(small);
+    w.pushImm(0);
+    w.popVar("m");
+    w.pushImm(0);
+    w.popVar("m", 1);
+    if(isUnrolled) {
+        w.test("a");
+        for(int step = 0; step < 16; step++) {
+            udivStep16(w);
+        }
+    } else {
+        std::string loop = w.newLabel();
+        w.pushImm(15);
+        w.popVar("i");
+        w.label(loop);
+        w.test("a");
+        udivStep16(w);
+        countDown(w, "i", loop);
+    }
+    w.label(done);
+    w.finish(RoutineWriter::end_unknown);
+}
+
+// tests b for a 16-bit shift: 16 or more goes to out, 8 or more moves the bytes with move,
+// then continues at shift with b < 8
+void shiftCount16(RoutineWriter& w, const std::string& out, const std::string& shift, std::function<void()> move) {
+    std::string bytes = w.newLabel();
+    testOutside(w, "b", 0x0F);
+    w.jnz(out);
+    w.pushImm(0xF8);
+    w.pushVar("b");
+    w.add();
+    w.jnn(bytes);
+    w.popInh();
+    w.label(shift);
+    w.later(1, [&w, bytes, shift, move]() {
+        w.label(bytes);
+        w.popVar("b");
+        move();
+        w.jump(shift);
+    });
+}
+
+// a << b, with b unsigned: 16 or more shifts everything out, 8 or more moves the low byte up first
+void genShl16(RoutineWriter& w, bool isUnrolled) {
+    w.declare("a", 2);
+    w.declare("b");
+    std::string zero = w.newLabel(), shift = w.newLabel();
+    shiftCount16(w, zero, shift, [&w]() {
+        w.pushVar("a", 1);
+        w.popVar("a");
+        w.pushImm(0);
+        w.popVar("a", 1);
+    });
+    w.later(0, [&w, zero]() {
+        w.label(zero);
+        w.pushImm(0);
+        w.popVar("a");
+        w.pushImm(0);
+        w.popVar("a", 1);
+        w.jnz(w.returnLabel());
+    });
+
+    if(!isUnrolled) {
+        std::string body = w.newLabel(), test = w.newLabel();
+        w.jump(test);
+        w.label(body);
+        double16(w, "a");
+        w.label(test);
+        countDown(w, "b", body);
+        w.finish(RoutineWriter::end_zClear);
+        return;
+    }
+
+    // a chain of doublings, each leaving N for the next; each entry tests the low byte first
+    std::vector<std::string> entries, chain;
+    for(int k = 0; k < 8; k++) {
+        entries.push_back(w.newLabel());
+        chain.push_back(w.newLabel());
+    }
+    dispatch(w, "b", 0, 8, entries);
+    for(int k = 7; k >= 1; k--) {
+        w.label(chain[k]);
+        double16(w, "a", true);
+    }
+    w.finish(RoutineWriter::end_unknown);
+    w.later(0, [&w, entries, chain]() {
+        w.label(entries[0]);
+        w.ret();
+        for(int k = 1; k < 8; k++) {
+            w.label(entries[k]);
+            w.test("a", 1);
+            w.jump(chain[k]);
+        }
+    });
+}
+
+// one step of shifting the 24 bits t:a:a+1 left, with N the top bit of a+1
+// a's doubling is kept on the stack while its top bit is tested for t
+void windowStep(RoutineWriter& w, bool isLast) {
+    std::string skip = w.newLabel(), skipHigh = w.newLabel();
+    w.pushVar("a");
+    w.pushVar("a");
+    w.jnn(skip);
+    w.pushImm(1);
+    w.add();
+    w.label(skip);
+    w.add();
+    w.test("a");
+    w.pushVar("t");
+    w.pushVar("t");
+    w.jnn(skipHigh);
+    w.pushImm(1);
+    w.add();
+    w.label(skipHigh);
+    w.add();
+    w.popVar("t");
+    w.popVar("a");
+    if(!isLast) {
+        double8(w, "a", 1);
+    }
+}
+
+// a >> b, with b unsigned, copying the sign bit: 16 or more shifts leave the sign, 8 or more
+// move the high byte down first; then the 24 bits sign:a are shifted left by 8 - b,
+// leaving the result in their top 16 bits
+void genShr16(RoutineWriter& w, bool isUnrolled) {
+    w.declare("a", 2);
+    w.declare("b");
+    w.declare("t");
+    if(!isUnrolled) {
+        w.declare("i");
+    }
+    std::string positive = w.newLabel(), fill = w.newLabel(), shift = w.newLabel();
+    w.test("a");
+    w.pushImm(0);
+    w.jnn(positive);
+    w.pushImm(0xFF);
+    w.add();
+    w.label(positive);
+    w.popVar("t");
+    shiftCount16(w, fill, shift, [&w]() {
+        w.pushVar("a");
+        w.popVar("a", 1);
+        w.pushVar("t");
+        w.popVar("a");
+    });
+    w.later(0, [&w, fill]() {
+        w.label(fill);
+        w.pushVar("t");
+        w.popVar("a");
+        w.pushVar("t");
+        w.popVar("a", 1);
+        w.jnz(w.returnLabel());
+    });
+
+    std::string result = w.newLabel();
+    if(!isUnrolled) {
+        std::string body = w.newLabel(), test = w.newLabel();
+        w.pushVar("b");
+        w.pushImm(8);
+        w.sub();
+        w.popVar("i");
+        w.jump(test);
+        w.label(body);
+        w.test("a", 1);
+        windowStep(w, false);
+        w.label(test);
+        countDown(w, "i", body);
+    } else {
+        std::vector<std::string> entries, chain;
+        for(int k = 0; k < 8; k++) {
+            entries.push_back(w.newLabel());
+            chain.push_back(w.newLabel());
+        }
+        dispatch(w, "b", 0, 8, entries);
+        for(int k = 1; k < 8; k++) {
+            w.label(chain[k]);
+            windowStep(w, k == 7);
+        }
+        w.later(0, [&w, entries, chain]() {
+            w.label(entries[0]);
+            w.ret();
+            for(int k = 1; k < 8; k++) {
+                w.label(entries[k]);
+                w.test("a", 1);
+                w.jump(chain[k]);
+            }
+        });
+    }
+    w.label(result);
+    w.pushVar("a");
+    w.popVar("a", 1);
+    w.pushVar("t");
+    w.popVar("a");
+    w.finish(isUnrolled ? RoutineWriter::end_unknown : RoutineWriter::end_zClear);
+}
+
+// compares the high bytes, signed or not, then the low bytes unsigned
+void genCompare16(RoutineWriter& w, bool isSigned) {
+    w.declare("a", 2);
+    w.declare("b", 2);
+    std::string differ = w.newLabel(), lowDiffer = w.newLabel(), less = w.newLabel(), greater = w.newLabel();
+    w.pushVar("b");
+    w.pushVar("a");
+    w.sub();
+    w.jnz(differ);
+    w.popInh();
+    w.pushVar("b", 1);
+    w.pushVar("a", 1);
+    w.sub();
+    w.jnz(lowDiffer);
+    w.later(1, [&w, differ, lowDiffer, isSigned, less, greater]() {
+        w.label(differ);
+        w.popInh();
+        compareBytes(w, "a", 0, "b", 0, isSigned, less, greater);
+        w.setDepth(1);
+        w.label(lowDiffer);
+        w.popInh();
+        compareBytes(w, "a", 1, "b", 1, false, less, greater);
+    });
+    compareResults(w, less, greater);
+    // 0 is on the stack
+    w.finish(RoutineWriter::end_zSet);
+}
+
+void genCmp16(RoutineWriter& w, bool isUnrolled) {
+    genCompare16(w, true);
+}
+
+void genUcmp16(RoutineWriter& w, bool isUnrolled) {
+    genCompare16(w, false);
+}
+
+/*
+    the routine table
+*/
+
+// a routine, its generator and the C++ it is verified against
+class Routine {
+    public:
+    std::string name;
+    // 8 or 16
+    int width;
+    // the operation, as C
+    std::string summary;
+    // true if the routine has no loop, so it has only one variant
+    bool isStraight;
+    // true if the result is pushed, rather than left in a
+    bool isPushed;
+    // the variable holding a second result, or ""
+    std::string extra;
+    std::function<void(RoutineWriter&, bool)> generate;
+    // the result and the second result for a and b, as unsigned values of the routine's width
+    std::function<int(int, int)> result;
+    std::function<int(int, int)> extraResult;
+};
+
+// a signed value of bits bits
+int signedOf(int value, int bits) {
+    int top = 1 << (bits - 1);
+    return (value & top) ? value - (top << 1) : value;
+}
+
+// a / b rounding toward zero, a % b with the sign of a, and the cases for b == 0
+int signedDivide(int a, int b, int bits, bool isMod) {
+    int mask = (1 << bits) - 1;
+    int x = signedOf(a, bits), y = signedOf(b, bits);
+    if(y == 0) {
+        return (isMod ? x : (x < 0 ? 1 : -1)) & mask;
+    }
+    return (isMod ? x % y : x / y) & mask;
+}
+
+int shiftLeft(int a, int b, int bits) {
+    return b >= bits ? 0 : (a << b) & ((1 << bits) - 1);
+}
+
+int shiftRight(int a, int b, int bits) {
+    return (signedOf(a, bits) >> std::min(b, bits - 1)) & ((1 << bits) - 1);
+}
+
+// -1, 0 or 1 as a byte
+int compareOf(int x, int y) {
+    return (x < y ? -1 : x > y ? 1 : 0) & 0xFF;
+}
+
+const std::vector<Routine>& routines() {
+    static const std::vector<Routine> table = {
+        { "mul8", 8, "a * b", false, true, "", genMul8,
+            [](int a, int b) { return (a * b) & 0xFF; }, nullptr },
+        { "udiv8", 8, "a / b, a % b unsigned", false, true, "m", genUdiv8,
+            [](int a, int b) { return b == 0 ? 0xFF : a / b; },
+            [](int a, int b) { return b == 0 ? a : a % b; } },
+        { "div8", 8, "a / b", false, true, "", genDiv8,
+            [](int a, int b) { return signedDivide(a, b, 8, false); }, nullptr },
+        { "mod8", 8, "a % b", false, true, "", genMod8,
+            [](int a, int b) { return signedDivide(a, b, 8, true); }, nullptr },
+        { "shl8", 8, "a << b", false, true, "", genShl8,
+            [](int a, int b) { return shiftLeft(a, b, 8); }, nullptr },
+        { "shr8", 8, "a >> b", false, true, "", genShr8,
+            [](int a, int b) { return shiftRight(a, b, 8); }, nullptr },
+        { "cmp8", 8, "a <=> b", true, true, "", genCmp8,
+            [](int a, int b) { return compareOf(signedOf(a, 8), signedOf(b, 8)); }, nullptr },
+        { "ucmp8", 8, "a <=> b unsigned", true, true, "", genUcmp8,
+            [](int a, int b) { return compareOf(a, b); }, nullptr },
+        { "mul16", 16, "a * b", false, false, "", genMul16,
+            [](int a, int b) { return (a * b) & 0xFFFF; }, nullptr },
+        { "udiv16", 16, "a / b, a % b unsigned", false, false, "m", genUdiv16,
+            [](int a, int b) { return b == 0 ? 0xFFFF : a / b; },
+            [](int a, int b) { return b == 0 ? a : a % b; } },
+        { "shl16", 16, "a << b", false, false, "", genShl16,
+            [](int a, int b) { return shiftLeft(a, b, 16); }, nullptr },
+        { "shr16", 16, "a >> b", false, false, "", genShr16,
+            [](int a, int b) { return shiftRight(a, b, 16); }, nullptr },
+        { "cmp16", 16, "a <=> b", true, true, "", genCmp16,
+            [](int a, int b) { return compareOf(signedOf(a, 16), signedOf(b, 16)); }, nullptr },
+        { "ucmp16", 16, "a <=> b unsigned", true, true, "", genUcmp16,
+            [](int a, int b) { return compareOf(a, b); }, nullptr }
+    };
+    return table;
+}
+
+// returns the routine named, or nullptr
+const Routine* findRoutine(const std::string& name) {
+    for(const auto& routine : routines()) {
+        if(routine.name == name) {
+            return &routine;
+        }
+    }
+    return nullptr;
+}
+
+// true if b is a shift count, of which only 0 to width - 1 are worth measuring
+bool isShift(const Routine& routine) {
+    return routine.name.compare(0, 3, "shl") == 0 || routine.name.compare(0, 3, "shr") == 0;
+}
+
+// the file a variant is written to, e.g. 'mul8_unrolled.s'
+std::string routineFileName(const Routine& routine, bool isUnrolled) {
+    return routine.name + (routine.isStraight ? "" : isUnrolled ? "_unrolled" : "_looped") + ".s";
+}
+
+// writes the assembly of a routine variant, labelled with name (the routine's own by default),
+// filling out_maxDepth with the deepest it takes the stack
+std::string generateRoutine(const Routine& routine, bool isUnrolled, const std::string& name, int& out_maxDepth) {
+    RoutineWriter w(name.empty() ? routine.name : name);
+    std::ostringstream os;
+    os << "; " << w.name << ": " << routine.summary << ", " << routine.width << "-bit"
+        << (routine.isStraight ? "" : isUnrolled ? ", unrolled" : ", looped") << std::endl;
+    w.label(w.entryLabel());
+    routine.generate(w, isUnrolled);
+    os << w.text();
+    out_maxDepth = w.maxDepth;
+    return os.str();
+}
+
+#endif // RUNTIME_H
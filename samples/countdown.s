@@ -0,0 +1,10 @@
+; counts port B down from 5 to 1, then halts
+#loop pushext @count
+popext 0xFFFD           // portB
+pushimm 1
+pushext @count
+sub                     // count - 1
+popext @count
+jnz @loop
+halt
+#count 5
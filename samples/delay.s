@@ -0,0 +1,27 @@
+; counts port B down from 8 to 1, busy-waiting 255 x 255 iterations of a pair of
+; delay loops between counts, then halts
+#next pushext @count
+popext 0xFFFD           // portB
+pushimm 0xFF
+popext @outer
+#wait_outer pushimm 0xFF
+popext @inner
+#wait_inner pushext @inner
+pushimm 0xFF
+add                     // inner - 1
+popext @inner
+jnz @wait_inner
+pushext @outer
+pushimm 0xFF
+add                     // outer - 1
+popext @outer
+jnz @wait_outer
+pushext @count
+pushimm 0xFF
+add                     // count - 1
+popext @count
+jnz @next
+halt
+#count 8
+#outer 0
+#inner 0
@@ -0,0 +1,10 @@
+; fills 200 bytes of a buffer with 0x5A and copies them 100 bytes on with the DMA device,
+; then writes the last byte copied to port B and halts; run with 'ssbc run samples/dma.s --dma'
+.include "../runtime/lib/dma.s"
+dma_fill @buf, 0x5A, 200
+dma_copy @buf, (@buf+100), 200
+pushext @buf+299
+popext 0xFFFD           // portB
+halt
+#buf
+.fill 300
@@ -0,0 +1,8 @@
+; adds 1 and 2 into 0x0100, for the heatmap check of ssbc-interpreter's make test: each of its 9
+; bytes is fetched once, 0xFFFA read twice (by add and popext) and written twice (by the first
+; push and add), 0xFFF9 read and written once, and the PSW and 0x0100 written once
+pushimm 0x01
+pushimm 0x02
+add
+popext 0x0100
+halt
@@ -0,0 +1,14 @@
+; writes 12 * 11 to port A with the runtime library's multiply, then halts
+pushimm 12
+popext @v_mul8_a
+pushimm 11
+popext @v_mul8_b
+pushimm @back.H
+popext @r_mul8+1
+pushimm @back.L
+popext @r_mul8+2
+jnz @f_mul8
+jnn @f_mul8
+#back popext 0xFFFC     // portA
+halt
+.include "../runtime/lib/mul8_unrolled.s"
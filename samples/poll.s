@@ -0,0 +1,26 @@
+; polls for 4 bytes arriving on port A, writing their sum to port B and halting; run with
+; 'ssbc run samples/poll.s --events samples/poll.events'
+.include "../runtime/lib/events.s"
+#poll
+pushext IRQ_STATUS
+pushimm 0
+add
+popinh
+jnz @arrived
+jnn @poll
+#arrived
+irq_clear IRQ_PORTA
+pushext @sum
+pushext 0xFFFC          // portA
+add
+popext @sum
+pushext @left
+pushimm 0xFF
+add
+popext @left
+jnz @poll
+pushext @sum
+popext 0xFFFD           // portB
+halt
+#sum 0
+#left 4
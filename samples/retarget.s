@@ -0,0 +1,12 @@
+; rewrites the target of the jump at r to B before jumping to it, so port B ends as 0x42
+; (an optimizer following r's jump as assembled would skip to A and leave port B at 0)
+pushimm @B.H
+popext @r+1
+pushimm @B.L
+popext @r+2
+jnz @r
+#A halt
+#B pushimm 0x42
+popext 0xFFFD           // portB
+halt
+#r jnz @A
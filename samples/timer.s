@@ -0,0 +1,24 @@
+; sleeps through 10 ticks of the timer, every 10000 cycles, counting them down to port B in the
+; interrupt handler, then halts; run with 'ssbc run samples/timer.s --events'
+.include "../runtime/lib/events.s"
+irq_handler @tick, IRQ_TIMER
+timer_start 10000, 0, TIMER_PERIODIC
+#sleep
+irq_wait
+pushext @left
+pushimm 0
+add
+popinh
+jnz @sleep
+halt
+// the interrupt handler
+#tick
+pushext @left
+pushimm 0xFF
+add
+popext @left
+pushext @left
+popext 0xFFFD           // portB
+irq_clear IRQ_TIMER
+irq_return
+#left 10
@@ -0,0 +1,179 @@
+/*
+    code coverage: which instructions of a program have run
+
+    a CoverageMap has a byte for each address, set to 1 when an instruction there runs; a byte
+    rather than a bit, so that marking one is a single store with no test or read-modify-write in
+    the loop stepping the machine. it is written as a bitmap, a bit per address after a header line
+    with the hash of the image it was collected on, so the maps of many runs (of batch jobs, say)
+    are merged by or-ing them, and a map from another build of the program is refused
+    an assembled program's LineTable maps each address back to its source line, for an annotated
+    copy of the source and an lcov tracefile (for genhtml and the like); the lines of macros and
+    .include files count as the line using them
+*/
+
+#ifndef COVERAGE_H
+#define COVERAGE_H
+
+#include <vector>
+#include <map>
+#include <string>
+#include <cstdint>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <ostream>
+#include <iostream>
+#include "machine.h"
+
+const std::string COVERAGE_HEADER = "ssbc coverage ";
+
+class CoverageMap {
+    public:
+    unsigned char hits[IMAGE_SIZE] = {};
+
+    void merge(const CoverageMap& other) {
+        for(int address = 0; address < IMAGE_SIZE; address++) {
+            hits[address] |= other.hits[address];
+        }
+    }
+
+    // the addresses marked
+    int count() const {
+        int result = 0;
+        for(int address = 0; address < IMAGE_SIZE; address++) {
+            result += hits[address];
+        }
+        return result;
+    }
+};
+
+// the FNV-1a hash of an image, telling the maps of one program from those of another
+uint64_t imageHash(const std::vector<unsigned char>& image) {
+    uint64_t hash = 0xCBF29CE484222325ull;
+    for(unsigned char byte : image) {
+        hash = (hash ^ byte) * 0x100000001B3ull;
+    }
+    return hash;
+}
+
+// writes the map to the named file as a bitmap, with the hash of the image it was collected on
+// returns false after writing an error if not possible
+bool tryWriteCoverage(const std::string& fileName, const CoverageMap& coverage, uint64_t hash) {
+    std::ofstream file(fileName, std::ios::binary);
+    if(!file.is_open()) {
+        std::cerr << "Error: could not write " << fileName << std::endl;
+        return false;
+    }
+    std::ostringstream header;
+    header << COVERAGE_HEADER << std::hex << std::setw(16) << std::setfill('0') << hash << "\n";
+    file << header.str();
+    std::vector<unsigned char> bits(IMAGE_SIZE / 8);
+    for(int address = 0; address < IMAGE_SIZE; address++) {
+        bits[address / 8] |= (coverage.hits[address] != 0) << (address % 8);
+    }
+    file.write(reinterpret_cast<const char*>(bits.data()), bits.size());
+    return file.good();
+}
+
+// reads a bitmap written by tryWriteCoverage, or-ing it into the map
+// returns false after writing an error if not possible, or if it was collected on an image with
+// another hash
+bool tryMergeCoverage(const std::string& fileName, CoverageMap& coverage, uint64_t hash, std::ostream& err) {
+    std::ifstream file(fileName, std::ios::binary);
+    std::string header;
+    if(!file.is_open() || !std::getline(file, header) || header.compare(0, COVERAGE_HEADER.size(), COVERAGE_HEADER) != 0) {
+        err << "Error: " << fileName << " is not a coverage map" << std::endl;
+        return false;
+    }
+    if(std::stoull(header.substr(COVERAGE_HEADER.size()), nullptr, 16) != hash) {
+        err << "Error: " << fileName << " was collected on another build of the program" << std::endl;
+        return false;
+    }
+    std::vector<unsigned char> bits(IMAGE_SIZE / 8);
+    if(!file.read(reinterpret_cast<char*>(bits.data()), bits.size())) {
+        err << "Error: " << fileName << " is cut short" << std::endl;
+        return false;
+    }
+    for(int address = 0; address < IMAGE_SIZE; address++) {
+        coverage.hits[address] |= (bits[address / 8] >> (address % 8)) & 1;
+    }
+    return true;
+}
+
+// where each byte of an assembled program came from
+class LineTable {
+    public:
+    // the source line (from 1) of each byte of the image, and whether it is an instruction's opcode
+    std::vector<int> lines;
+    std::vector<bool> isInstruction;
+    // the source as read, a string per line
+    std::vector<std::string> source;
+
+    bool empty() const {
+        return lines.empty();
+    }
+};
+
+// the instructions of a source line, and those of them which ran
+class LineCoverage {
+    public:
+    int instructions = 0;
+    int hit = 0;
+};
+
+// the coverage of each source line, from index 1
+std::vector<LineCoverage> coverLines(const CoverageMap& coverage, const LineTable& table) {
+    std::vector<LineCoverage> result(table.source.size() + 1);
+    for(size_t address = 0; address < table.lines.size(); address++) {
+        int line = table.lines[address];
+        if(table.isInstruction[address] && line > 0 && line < (int)result.size()) {
+            result[line].instructions++;
+            result[line].hit += coverage.hits[address];
+        }
+    }
+    return result;
+}
+
+// writes the source with the instructions run of each line before it, as 'run/all', '#####' for
+// none of them, or '-' for a line with no instructions
+void writeCoverageReport(std::ostream& os, const CoverageMap& coverage, const LineTable& table) {
+    std::vector<LineCoverage> lines = coverLines(coverage, table);
+    for(size_t line = 1; line <= table.source.size(); line++) {
+        const LineCoverage& c = lines[line];
+        std::string count = c.instructions == 0 ? "-" : c.hit == 0 ? "#####" : std::to_string(c.hit) + "/" + std::to_string(c.instructions);
+        os << std::setw(9) << count << ":" << std::setw(5) << line << ":" << table.source[line - 1] << "\n";
+    }
+}
+
+// writes an lcov tracefile of the source: a DA record for each line with instructions, run if any
+// of them ran, and an FN record for each label of an instruction, run if it ran
+void writeLcov(std::ostream& os, const CoverageMap& coverage, const LineTable& table, const std::string& sourceName, const std::map<std::string, int>& labels) {
+    std::vector<LineCoverage> lines = coverLines(coverage, table);
+    os << "TN:\n";
+    os << "SF:" << sourceName << "\n";
+    int functions = 0, functionsHit = 0;
+    for(const auto& label : labels) {
+        int address = label.second;
+        if(address < (int)table.lines.size() && table.isInstruction[address] && table.lines[address] > 0) {
+            os << "FN:" << table.lines[address] << "," << label.first << "\n";
+            os << "FNDA:" << (int)coverage.hits[address] << "," << label.first << "\n";
+            functions++;
+            functionsHit += coverage.hits[address];
+        }
+    }
+    os << "FNF:" << functions << "\n";
+    os << "FNH:" << functionsHit << "\n";
+    int found = 0, hit = 0;
+    for(size_t line = 1; line < lines.size(); line++) {
+        if(lines[line].instructions > 0) {
+            os << "DA:" << line << "," << (lines[line].hit > 0) << "\n";
+            found++;
+            hit += lines[line].hit > 0;
+        }
+    }
+    os << "LF:" << found << "\n";
+    os << "LH:" << hit << "\n";
+    os << "end_of_record\n";
+}
+
+#endif // COVERAGE_H
@@ -0,0 +1,136 @@
+/*
+    a memory-mapped DMA device, copying and filling blocks of memory for the program
+
+    its registers take the 8 bytes from DMA_BASE:
+        +0 +1   source address, high byte first
+        +2 +3   destination address, high byte first
+        +4 +5   length in bytes, high byte first (0 does nothing)
+        +6      the byte to fill with
+        +7      control: writing dma_copy or dma_fill runs the transfer at once, then it reads 0
+    a copy is done as if through a buffer (memmove), so the blocks may overlap, and both blocks wrap
+    around the end of memory as addresses do. the transfer costs the machine setupCycles plus
+    cyclesPerByte for each byte, on top of the instruction which wrote the control byte
+    a DmaMachine hides the machine's write to watch for the control byte, as a ProfiledMachine does
+    for its accesses, so a plain Machine has none of this; it may be built on any machine
+    the bytes a transfer writes are reported to onTransfer, so that anything decoded from memory
+    (the loop accelerator's loops) can be dropped if it was overwritten
+    runtime/lib/dma.s has macros to program it
+*/
+
+#ifndef DMA_H
+#define DMA_H
+
+#include <cstring>
+#include <functional>
+#include "machine.h"
+
+// where the registers are, as in runtime/lib/dma.s; below the stack and out of the way of programs
+const int DMA_BASE = 0xFF00;
+const int DMA_REGISTERS = 8;
+
+enum {
+    dma_source = 0,
+    dma_destination = 2,
+    dma_length = 4,
+    dma_value = 6,
+    dma_control = 7
+};
+
+// the commands written to the control byte
+enum {
+    dma_idle = 0,
+    dma_copy = 1,
+    dma_fill = 2
+};
+
+class DmaDevice {
+    public:
+    int base = DMA_BASE;
+    // what a transfer costs the machine
+    int setupCycles = 4;
+    int cyclesPerByte = 1;
+    // the transfers run, and the bytes they wrote
+    long long transfers = 0;
+    long long bytes = 0;
+    // called with each block of memory [start, end) a transfer wrote
+    std::function<void(int, int)> onTransfer;
+
+    // runs the command just written to the control byte of the machine's memory
+    // returns the cycles it took
+    long long run(unsigned char* mem) {
+        int command = mem[base + dma_control];
+        mem[base + dma_control] = dma_idle;
+        int source = word(mem, dma_source);
+        int destination = word(mem, dma_destination);
+        int length = word(mem, dma_length);
+        if((command != dma_copy && command != dma_fill) || length == 0) {
+            return 0;
+        }
+        if(command == dma_copy) {
+            if(source + length <= IMAGE_SIZE && destination + length <= IMAGE_SIZE) {
+                std::memmove(mem + destination, mem + source, length);
+            } else {
+                std::vector<unsigned char> buffer(length);
+                for(int i = 0; i < length; i++) {
+                    buffer[i] = mem[(source + i) & 0xFFFF];
+                }
+                for(int i = 0; i < length; i++) {
+                    mem[(destination + i) & 0xFFFF] = buffer[i];
+                }
+            }
+        } else {
+            int first = std::min(length, IMAGE_SIZE - destination);
+            std::memset(mem + destination, mem[base + dma_value], first);
+            std::memset(mem, mem[base + dma_value], length - first);
+        }
+        transfers++;
+        bytes += length;
+        if(onTransfer) {
+            int first = std::min(length, IMAGE_SIZE - destination);
+            onTransfer(destination, destination + first);
+            if(first < length) {
+                onTransfer(0, length - first);
+            }
+        }
+        return setupCycles + (long long)length * cyclesPerByte;
+    }
+
+    private:
+    int word(const unsigned char* mem, int offset) const {
+        return (mem[base + offset] << 8) | mem[base + offset + 1];
+    }
+};
+
+// a machine with the device in its memory
+template<typename M = Machine>
+class DmaMachine : public M {
+    public:
+    DmaDevice& dma;
+
+    template<typename... Args>
+    DmaMachine(DmaDevice& _dma, Args&... args) : M(args...), dma(_dma) {}
+
+    void write(int address, unsigned char value) {
+        M::write(address, value);
+        if(address == dma.base + dma_control) {
+            this->cycles += dma.run(this->MEM);
+        }
+    }
+
+    // as the machine's, with the device
+    bool step() {
+        return rtnStep(*this);
+    }
+    bool microStep() {
+        return rtnMicroStep(*this);
+    }
+    void run(long long maxInstructions = 0) {
+        while(step()) {
+            if(maxInstructions > 0 && this->instructions >= maxInstructions) {
+                break;
+            }
+        }
+    }
+};
+
+#endif // DMA_H
@@ -0,0 +1,506 @@
+/*
+    a timer, bytes arriving on the input ports, and interrupts, as events on the machine's clock
+
+    the devices' events are kept in a timing wheel, by the clock cycle they are due at, and are done
+    before the first instruction starting at or after it. their registers take the 12 bytes from
+    EVENT_BASE:
+        +0      status: a bit for each source with an event pending (irq_timer, irq_portA,
+                irq_portC); writing it clears the bits written as 1
+        +1      enable: the sources which interrupt or wake the program
+        +2 +3   the interrupt vector, high byte first (0 for none)
+        +4 +5   the address returned to from an interrupt, high byte first
+        +6      the PSW as the interrupt found it
+        +7      control: writing control_wait sleeps until an enabled source is pending,
+                control_return returns from an interrupt; either is done once the instruction
+                writing it is, and it reads 0
+        +8 +9   the timer's period in cycles, high byte first, shifted left by
+        +10     the timer's scale
+        +11     the timer's control: timer_periodic or timer_oneShot starts it a period on from the
+                instruction writing it, timer_stop stops it
+    an enabled source pending with a vector set interrupts the program between instructions, unless
+    it is already in its handler: the address of the next instruction and the PSW are saved, and it
+    goes on at the vector. the handler clears the source's status bit, and returns with
+    control_return, which restores both; the stack is the program's, so the handler leaves it as
+    it found it
+    the clock is the machine's, so simulated time (at clockHz) has nothing to do with the host's:
+    a program asleep in a wait jumps the clock to the next event, and a loop polling for one is
+    skipped up to it, when an iteration of it is found to have changed nothing, coming back to its
+    start with the stack pointer where it was and memory as it was; every iteration after it would
+    be the same, until an event changes something
+    an EventMachine hides the machine's write for the registers, as a DmaMachine does, so a plain
+    Machine has none of this; it may be built on any machine, and goes outside any other layers so
+    that its step is the one run
+    runtime/lib/events.s names the registers
+*/
+
+#ifndef EVENTS_H
+#define EVENTS_H
+
+#include <vector>
+#include <map>
+#include <climits>
+#include <istream>
+#include <ostream>
+#include <sstream>
+#include "machine.h"
+
+// where the registers are, as in runtime/lib/events.s; after the DMA device's
+const int EVENT_BASE = 0xFF10;
+const int EVENT_REGISTERS = 12;
+
+enum {
+    irq_status = 0,
+    irq_enable = 1,
+    irq_vector = 2,
+    irq_return = 4,
+    irq_psw = 6,
+    irq_control = 7,
+    timer_period = 8,
+    timer_scale = 10,
+    timer_control = 11
+};
+
+// the sources, as bits of the status and enable registers
+enum {
+    irq_timer = 1,
+    irq_portA = 2,
+    irq_portC = 4
+};
+
+// the commands written to the control byte
+enum {
+    control_wait = 1,
+    control_return = 2
+};
+
+// the commands written to the timer's control byte
+enum {
+    timer_stop = 0,
+    timer_periodic = 1,
+    timer_oneShot = 2
+};
+
+// the time of no event at all
+const long long NO_EVENT = LLONG_MAX;
+
+enum EventKind {
+    event_timer,
+    event_arrival
+};
+
+// something due at a clock cycle: the timer going off (started as the timer's generation was), or
+// a byte arriving on a port
+class Event {
+    public:
+    long long when = 0;
+    EventKind kind = event_timer;
+    long long generation = 0;
+    int port = 0;
+    unsigned char value = 0;
+};
+
+// events by when they are due, as two timing wheels: the first has a slot for each cycle up to the
+// next multiple of WHEEL_SLOTS, the second a slot for each WHEEL_SLOTS cycles up to the next
+// multiple of WHEEL_SLOTS squared, and anything later waits in order until the wheels come around
+// to it. each slot of the first is due at once, and the wheel moves over empty turns at a time
+const int WHEEL_SLOTS = 256;
+
+class TimingWheel {
+    public:
+    // adds an event, due now if it was due before
+    void schedule(Event event) {
+        event.when = std::max(event.when, current);
+        place(event);
+        nextDue = std::min(nextDue, event.when);
+    }
+
+    // when the first event is due, or NO_EVENT
+    long long next() const {
+        return nextDue;
+    }
+
+    // takes out the events due by now, in the order they are due, moving the wheel on past it
+    void advance(long long now, std::vector<Event>& out_due) {
+        while(current <= now) {
+            std::vector<Event>& slot = near[current % WHEEL_SLOTS];
+            if(!slot.empty()) {
+                out_due.insert(out_due.end(), slot.begin(), slot.end());
+                nearCount -= slot.size();
+                slot.clear();
+            }
+            // the next cycle, or past what is left empty of this turn
+            long long next = current + 1;
+            if(nearCount == 0) {
+                long long turn = farCount > 0 ? WHEEL_SLOTS : WHEEL_SLOTS * WHEEL_SLOTS;
+                next = (current / turn + 1) * turn;
+            }
+            current = std::min(next, now + 1);
+            if(current % (WHEEL_SLOTS * WHEEL_SLOTS) == 0) {
+                while(!later.empty() && later.begin()->first < current + WHEEL_SLOTS * WHEEL_SLOTS) {
+                    place(later.begin()->second);
+                    later.erase(later.begin());
+                }
+            }
+            if(current % WHEEL_SLOTS == 0) {
+                std::vector<Event> cascaded;
+                cascaded.swap(far[(current / WHEEL_SLOTS) % WHEEL_SLOTS]);
+                farCount -= cascaded.size();
+                for(const Event& event : cascaded) {
+                    place(event);
+                }
+            }
+        }
+        findNext();
+    }
+
+    private:
+    // the cycle the wheel is at; nothing is due before it
+    long long current = 0;
+    std::vector<Event> near[WHEEL_SLOTS];
+    std::vector<Event> far[WHEEL_SLOTS];
+    std::multimap<long long, Event> later;
+    size_t nearCount = 0;
+    size_t farCount = 0;
+    long long nextDue = NO_EVENT;
+
+    void place(const Event& event) {
+        if(event.when / WHEEL_SLOTS == current / WHEEL_SLOTS) {
+            near[event.when % WHEEL_SLOTS].push_back(event);
+            nearCount++;
+        } else if(event.when / (WHEEL_SLOTS * WHEEL_SLOTS) == current / (WHEEL_SLOTS * WHEEL_SLOTS)) {
+            far[(event.when / WHEEL_SLOTS) % WHEEL_SLOTS].push_back(event);
+            farCount++;
+        } else {
+            later.insert({ event.when, event });
+        }
+    }
+
+    void findNext() {
+        nextDue = NO_EVENT;
+        if(nearCount > 0) {
+            for(long long slot = current % WHEEL_SLOTS; slot < WHEEL_SLOTS; slot++) {
+                if(!near[slot].empty()) {
+                    nextDue = current - current % WHEEL_SLOTS + slot;
+                    return;
+                }
+            }
+        }
+        if(farCount > 0) {
+            for(long long slot = (current / WHEEL_SLOTS) % WHEEL_SLOTS; slot < WHEEL_SLOTS; slot++) {
+                for(const Event& event : far[slot]) {
+                    nextDue = std::min(nextDue, event.when);
+                }
+                if(nextDue != NO_EVENT) {
+                    return;
+                }
+            }
+        }
+        if(!later.empty()) {
+            nextDue = later.begin()->first;
+        }
+    }
+};
+
+class EventDevices {
+    public:
+    int base = EVENT_BASE;
+    // the clock's rate, for simulated time
+    long long clockHz = 1000000;
+    // what taking an interrupt costs the machine
+    int interruptCycles = 4;
+    TimingWheel queue;
+    // the timer's mode, and how many times it has been started, to tell its events from those of
+    // a timer since stopped or started again
+    int timerMode = timer_stop;
+    long long timerGeneration = 0;
+    // the events done, interrupts taken and waits slept; the cycles skipped waiting, and those
+    // skipped polling
+    long long events = 0;
+    long long interrupts = 0;
+    long long waits = 0;
+    long long idleCycles = 0;
+    long long spinCycles = 0;
+    // whether the machine stopped waiting or polling with no event to come
+    bool isStuck = false;
+
+    // schedules a byte arriving on port A or C when it is due
+    void scheduleArrival(long long when, int port, unsigned char value) {
+        Event event;
+        event.when = when;
+        event.kind = event_arrival;
+        event.port = port;
+        event.value = value;
+        queue.schedule(event);
+    }
+
+    // the number of cycles in a time, such as '1500', '20us', '3ms' or '2s'
+    // returns false if it isn't one
+    bool tryParseTime(const std::string& text, long long& out_cycles) const {
+        size_t end = 0;
+        double number;
+        try {
+            number = std::stod(text, &end);
+        } catch(...) {
+            return false;
+        }
+        std::string unit = text.substr(end);
+        double scale = unit == "" ? 1 : unit == "s" ? clockHz : unit == "ms" ? clockHz / 1e3 : unit == "us" ? clockHz / 1e6 : unit == "ns" ? clockHz / 1e9 : -1;
+        if(scale < 0 || number < 0) {
+            return false;
+        }
+        out_cycles = (long long)(number * scale + 0.5);
+        return true;
+    }
+
+    // simulated time in seconds at a cycle
+    double seconds(long long cycles) const {
+        return (double)cycles / clockHz;
+    }
+};
+
+// reads a script of bytes arriving on the input ports, a line 'time port value' for each, the time
+// as for tryParseTime, the port A or C, and '#' starting a comment; they are scheduled on devices
+// returns false after writing an error if not possible
+bool tryReadEvents(std::istream& in, EventDevices& devices, std::ostream& err) {
+    std::string line;
+    for(int lineNumber = 1; std::getline(in, line); lineNumber++) {
+        line = line.substr(0, line.find('#'));
+        std::istringstream fields(line);
+        std::string time, port, value, extra;
+        if(!(fields >> time)) {
+            continue;
+        }
+        long long when = 0;
+        int byte = 0;
+        bool isValue = false;
+        if(fields >> port >> value && !(fields >> extra)) {
+            try {
+                size_t end = 0;
+                byte = std::stoi(value, &end, 0);
+                isValue = end == value.size() && byte >= 0 && byte <= 0xFF;
+            } catch(...) {
+            }
+        }
+        if(!isValue || !devices.tryParseTime(time, when) || (port != "A" && port != "C")) {
+            err << "Error: line " << lineNumber << " of the events is not 'time A|C byte': " << line << std::endl;
+            return false;
+        }
+        devices.scheduleArrival(when, port == "A" ? map_portA : map_portC, byte);
+    }
+    return true;
+}
+
+// a machine with the devices in its memory
+template<typename M = Machine>
+class EventMachine : public M {
+    public:
+    EventDevices& devices;
+    // asleep until an enabled source is pending
+    bool isWaiting = false;
+    // in the interrupt handler
+    bool isInterrupted = false;
+    // if set, marks each instruction run, once an interrupt has moved PC to its handler
+    unsigned char* hits = nullptr;
+
+    template<typename... Args>
+    EventMachine(EventDevices& _devices, Args&... args) : M(args...), devices(_devices) {}
+
+    void write(int address, unsigned char value) {
+        int base = devices.base;
+        if(address == base + irq_status) {
+            value = this->MEM[address] & ~value;
+        }
+        if(this->MEM[address] != value) {
+            isChanged = true;
+        }
+        M::write(address, value);
+        if(address == base + irq_control) {
+            command = value;
+            this->MEM[address] = 0;
+        } else if(address == base + timer_control) {
+            startTimer(value);
+        }
+    }
+
+    // as the machine's, with the devices: the events due are done first, and the instruction
+    // waited for or interrupted, then a command written to the control byte is done
+    // returns false if halted or faulted, or stuck
+    bool step() {
+        if(!tryPrepare()) {
+            return false;
+        }
+        if(hits != nullptr) {
+            hits[this->PC] = 1;
+        }
+        bool isRunning = rtnStep(*this);
+        finish();
+        return isRunning;
+    }
+    bool microStep() {
+        if(this->phase == 0 && !tryPrepare()) {
+            return false;
+        }
+        if(hits != nullptr && this->phase == 0) {
+            hits[this->PC] = 1;
+        }
+        bool isRunning = rtnMicroStep(*this);
+        if(this->phase == 0) {
+            finish();
+        }
+        return isRunning;
+    }
+
+    // as the machine's, skipping the iterations of loops polling for an event
+    void run(long long maxInstructions = 0) {
+        // the iteration of a loop the program last jumped back to
+        int markPC = -1;
+        int markSP = 0;
+        bool markInterrupted = false;
+        long long markCycles = 0;
+        long long markInstructions = 0;
+        while(true) {
+            int pc = this->PC;
+            if(!step() || (maxInstructions > 0 && this->instructions >= maxInstructions)) {
+                break;
+            }
+            if(this->PC > pc) {
+                continue;
+            }
+            if(this->PC == markPC && this->SP == markSP && isInterrupted == markInterrupted && !isChanged) {
+                long long iterationCycles = this->cycles - markCycles;
+                long long iterationInstructions = this->instructions - markInstructions;
+                long long next = devices.queue.next();
+                if(next == NO_EVENT && maxInstructions <= 0) {
+                    devices.isStuck = true;
+                    break;
+                }
+                // the iterations before the one the next event is due in
+                long long skipped = next == NO_EVENT ? LLONG_MAX : std::max(0LL, (next - this->cycles) / iterationCycles);
+                if(maxInstructions > 0) {
+                    skipped = std::min(skipped, (maxInstructions - this->instructions) / iterationInstructions);
+                }
+                this->cycles += skipped * iterationCycles;
+                this->instructions += skipped * iterationInstructions;
+                devices.spinCycles += skipped * iterationCycles;
+                if(maxInstructions > 0 && this->instructions >= maxInstructions) {
+                    break;
+                }
+            }
+            markPC = this->PC;
+            markSP = this->SP;
+            markInterrupted = isInterrupted;
+            markCycles = this->cycles;
+            markInstructions = this->instructions;
+            isChanged = false;
+        }
+    }
+
+    private:
+    // whether memory or the devices have changed since the last loop iteration began
+    bool isChanged = false;
+    // the command written to the control byte by the instruction running, and the cycle it started
+    int command = 0;
+    long long instructionStart = 0;
+    std::vector<Event> due;
+
+    unsigned char& registerAt(int offset) {
+        return this->MEM[devices.base + offset];
+    }
+
+    int word(int offset) {
+        return (registerAt(offset) << 8) | registerAt(offset + 1);
+    }
+
+    int pendingSources() {
+        return registerAt(irq_status) & registerAt(irq_enable);
+    }
+
+    // does the events due, sleeps through a wait, and takes an interrupt, before an instruction
+    // returns false if stuck waiting
+    bool tryPrepare() {
+        if(this->HALT || this->FAULT) {
+            return true;
+        }
+        fire();
+        while(isWaiting && pendingSources() == 0) {
+            long long next = devices.queue.next();
+            if(next == NO_EVENT) {
+                devices.isStuck = true;
+                return false;
+            }
+            devices.idleCycles += next - this->cycles;
+            this->cycles = next;
+            fire();
+        }
+        isWaiting = false;
+        if(!isInterrupted && pendingSources() != 0 && word(irq_vector) != 0) {
+            registerAt(irq_return) = this->PC >> 8;
+            registerAt(irq_return + 1) = this->PC & 0xFF;
+            registerAt(irq_psw) = this->MEM[map_PSW];
+            this->PC = word(irq_vector);
+            this->cycles += devices.interruptCycles;
+            isInterrupted = true;
+            isChanged = true;
+            devices.interrupts++;
+        }
+        instructionStart = this->cycles;
+        return true;
+    }
+
+    // does the command the instruction wrote, once it is done
+    void finish() {
+        if(command == control_wait) {
+            isWaiting = true;
+            devices.waits++;
+        } else if(command == control_return && isInterrupted) {
+            this->PC = word(irq_return);
+            this->MEM[map_PSW] = registerAt(irq_psw);
+            isInterrupted = false;
+        }
+        command = 0;
+    }
+
+    void fire() {
+        if(this->cycles < devices.queue.next()) {
+            return;
+        }
+        due.clear();
+        devices.queue.advance(this->cycles, due);
+        for(Event& event : due) {
+            if(event.kind == event_timer) {
+                if(event.generation != devices.timerGeneration) {
+                    continue;
+                }
+                registerAt(irq_status) |= irq_timer;
+                if(devices.timerMode == timer_periodic) {
+                    event.when += timerInterval();
+                    devices.queue.schedule(event);
+                }
+            } else {
+                this->MEM[event.port] = event.value;
+                registerAt(irq_status) |= event.port == map_portA ? irq_portA : irq_portC;
+            }
+            isChanged = true;
+            devices.events++;
+        }
+    }
+
+    long long timerInterval() {
+        return (long long)word(timer_period) << (registerAt(timer_scale) & 0x1F);
+    }
+
+    void startTimer(int mode) {
+        isChanged = true;
+        devices.timerGeneration++;
+        devices.timerMode = mode;
+        if((mode == timer_periodic || mode == timer_oneShot) && timerInterval() > 0) {
+            Event event;
+            event.when = instructionStart + timerInterval();
+            event.kind = event_timer;
+            event.generation = devices.timerGeneration;
+            devices.queue.schedule(event);
+        }
+    }
+};
+
+#endif // EVENTS_H
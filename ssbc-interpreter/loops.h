@@ -0,0 +1,336 @@
+/*
+    counted loops, run in closed form
+
+    when a jnz jumps back, the code from its target to it is run once symbolically, from the state
+    at the start of an iteration: each value is a constant, a byte of memory as the iteration
+    started plus a constant, or something else depending on some of those bytes. the loop is a
+    counted one if
+    - it is straight-line code ending in the jnz, leaving SP where it found it, and writing none of
+      its own code
+    - the flags the jnz tests are those of a counter byte C plus a constant d, which is also what
+      is written back to C
+    - no other byte it writes, nor R2, depends on anything written in the loop except C
+    so every iteration does the same, given C: it ends with C + d, and has written the same bytes as
+    any iteration starting with the same C would. it runs until C + k*d wraps to 0, and the
+    iterations in between can be skipped: C is set to its value at the start of the last of them,
+    the clock and instruction count moved on by the others, and that one is stepped as usual,
+    leaving memory, the flags and R2 as if every one had been stepped
+    the loops are cached by the address of their jnz, along with their code and SP, so that a loop
+    which can't be run this way only costs a compare of its code each time it comes around; a
+    device writing memory behind the program's back drops the loops it wrote over with invalidate
+    a loop writing a device's registers is never counted, as skipping its iterations would skip
+    what the device does for each of them
+*/
+
+#ifndef LOOPS_H
+#define LOOPS_H
+
+#include <vector>
+#include <map>
+#include <unordered_map>
+#include <algorithm>
+#include <cstring>
+#include "machine.h"
+
+// the longest loop looked at, in bytes of code
+const int MAX_LOOP_BYTES = 256;
+
+// a value of the loop: base (a byte of memory as the iteration started, or -1 for none) plus
+// offset, if affine; either way, the bytes it was read from
+class LoopValue {
+    public:
+    bool isAffine = true;
+    int base = -1;
+    int offset = 0;
+    // the Z and N bits of the value, as written to the PSW
+    bool isFlags = false;
+    std::vector<int> reads;
+
+    static LoopValue constant(int value) {
+        LoopValue result;
+        result.offset = value & 0xFF;
+        return result;
+    }
+
+    static LoopValue initial(int address) {
+        LoopValue result;
+        result.base = address;
+        result.reads.push_back(address);
+        return result;
+    }
+
+    // a value depending on both, but on nothing else
+    static LoopValue opaque(const LoopValue& a, const LoopValue& b) {
+        LoopValue result;
+        result.isAffine = false;
+        result.reads = a.reads;
+        for(int address : b.reads) {
+            if(std::find(result.reads.begin(), result.reads.end(), address) == result.reads.end()) {
+                result.reads.push_back(address);
+            }
+        }
+        return result;
+    }
+
+    // the flags read back as a byte
+    LoopValue number() const {
+        if(!isFlags) {
+            return *this;
+        }
+        return opaque(*this, LoopValue());
+    }
+
+    bool isConstant() const {
+        return isAffine && base < 0;
+    }
+};
+
+// a loop from start up to its jnz at end - 3, as found with the stack pointer at sp
+class CountedLoop {
+    public:
+    int start = 0;
+    int end = 0;
+    int sp = 0;
+    std::vector<unsigned char> code;
+    // whether it can be run in closed form, and if so its counter, the counter's step, and what an
+    // iteration takes
+    bool isCounted = false;
+    int counter = 0;
+    int step = 0;
+    long long instructions = 0;
+    long long cycles = 0;
+};
+
+class LoopAccelerator {
+    public:
+    // loops run in closed form, and the iterations skipped
+    long long loopsAccelerated = 0;
+    long long iterationsSkipped = 0;
+
+    // the registers of devices, [start, end), whose writes do more than store a byte
+    std::vector<std::pair<int, int>> devices;
+
+    // runs until halted or faulted, or maxInstructions have run (if positive), as Machine::run
+    // would, running counted loops in closed form
+    template<typename M>
+    void run(M& m, long long maxInstructions = 0) {
+        while(true) {
+            int pc = m.PC;
+            bool isJnz = (m.MEM[pc] & 0xF) == op_jnz;
+            if(!m.step() || (maxInstructions > 0 && m.instructions >= maxInstructions)) {
+                break;
+            }
+            if(isJnz && m.PC <= pc && tryAccelerate(m, pc, maxInstructions) && maxInstructions > 0 && m.instructions >= maxInstructions) {
+                break;
+            }
+        }
+    }
+
+    // skips the iterations of the loop jumped back to by the jnz at jnzAddress, if it is counted,
+    // running no more than maxInstructions (if positive) in all
+    // returns true if it did
+    template<typename M>
+    bool tryAccelerate(M& m, int jnzAddress, long long maxInstructions = 0) {
+        const CountedLoop& loop = find(m, jnzAddress);
+        if(!loop.isCounted) {
+            return false;
+        }
+        // the iterations left, up to the one that leaves the counter at 0
+        long long left = -1;
+        int count = m.MEM[loop.counter];
+        for(int k = 1; k <= 256; k++) {
+            if(((count + k * loop.step) & 0xFF) == 0) {
+                left = k;
+                break;
+            }
+        }
+        if(maxInstructions > 0) {
+            long long fit = (maxInstructions - m.instructions) / loop.instructions;
+            left = left < 0 ? fit : std::min(left, fit);
+        }
+        // a loop which never ends goes on for as long as it is run
+        if(left < 2) {
+            return false;
+        }
+        long long skipped = left - 1;
+        m.MEM[loop.counter] = (count + skipped * loop.step) & 0xFF;
+        m.instructions += skipped * loop.instructions;
+        m.cycles += skipped * loop.cycles;
+        for(long long i = 0; i < loop.instructions; i++) {
+            m.step();
+        }
+        loopsAccelerated++;
+        iterationsSkipped += skipped;
+        return true;
+    }
+
+    // drops the loops with code in [start, end), which has been written
+    void invalidate(int start, int end) {
+        for(auto it = loops.begin(); it != loops.end();) {
+            if(it->second.start < end && start < it->second.end) {
+                it = loops.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+
+    private:
+    std::unordered_map<int, CountedLoop> loops;
+
+    // the loop of the jnz, from the cache if its code and stack pointer are as they were
+    const CountedLoop& find(const Machine& m, int jnzAddress) {
+        int start = m.PC;
+        int end = jnzAddress + 3;
+        auto it = loops.find(jnzAddress);
+        if(it != loops.end()) {
+            const CountedLoop& loop = it->second;
+            if(loop.start == start && loop.sp == m.SP && (loop.code.empty() || std::memcmp(loop.code.data(), m.MEM + start, end - start) == 0)) {
+                return loop;
+            }
+        }
+        CountedLoop& loop = loops[jnzAddress];
+        loop = CountedLoop();
+        loop.start = start;
+        loop.end = end;
+        loop.sp = m.SP;
+        if(end - start <= MAX_LOOP_BYTES && end <= IMAGE_SIZE) {
+            loop.code.assign(m.MEM + start, m.MEM + end);
+            analyze(m, loop);
+        }
+        return loop;
+    }
+
+    // runs an iteration of the loop symbolically, finding whether it is counted
+    void analyze(const Machine& m, CountedLoop& loop) {
+        std::map<int, LoopValue> written;
+        auto read = [&written](int address) {
+            auto it = written.find(address);
+            return it != written.end() ? it->second : LoopValue::initial(address);
+        };
+        auto ext = [&m](int address) {
+            return (m.MEM[address] << 8) | m.MEM[address + 1];
+        };
+        LoopValue r2;
+        bool isR2Set = false;
+        int pc = loop.start;
+        int sp = loop.sp;
+        while(true) {
+            int op = m.MEM[pc] & 0xF;
+            // an instruction running past the jnz isn't in the loop
+            if(pc + opSize(op) > loop.end) {
+                return;
+            }
+            loop.instructions++;
+            loop.cycles += opCycles(op);
+            int s1 = (sp + 1) & 0xFFFF;
+            int s2 = (sp + 2) & 0xFFFF;
+            switch(op) {
+                case op_noop: {
+                    pc += 1;
+                    break;
+                }
+                case op_pushimm: {
+                    written[sp] = LoopValue::constant(m.MEM[pc + 1]);
+                    sp = (sp - 1) & 0xFFFF;
+                    pc += 2;
+                    break;
+                }
+                case op_pushext: {
+                    written[sp] = read(ext(pc + 1));
+                    sp = (sp - 1) & 0xFFFF;
+                    pc += 3;
+                    break;
+                }
+                case op_popinh: {
+                    sp = s1;
+                    pc += 1;
+                    break;
+                }
+                case op_popext: {
+                    written[ext(pc + 1)] = read(s1);
+                    sp = s1;
+                    pc += 3;
+                    break;
+                }
+                case op_add:
+                case op_sub: {
+                    LoopValue a = read(s1).number();
+                    LoopValue b = read(s2).number();
+                    LoopValue result = LoopValue::opaque(a, b);
+                    if(op == op_add && a.isAffine && b.isAffine && (a.base < 0 || b.base < 0)) {
+                        result.isAffine = true;
+                        result.base = std::max(a.base, b.base);
+                        result.offset = (a.offset + b.offset) & 0xFF;
+                    } else if(op == op_sub && a.isAffine && b.isAffine && (b.base < 0 || b.base == a.base)) {
+                        result.isAffine = true;
+                        result.base = b.base < 0 ? a.base : -1;
+                        result.offset = (a.offset - b.offset) & 0xFF;
+                    }
+                    r2 = result;
+                    isR2Set = true;
+                    written[s2] = result;
+                    result.isFlags = true;
+                    written[map_PSW] = result;
+                    sp = s1;
+                    pc += 1;
+                    break;
+                }
+                case op_nor: {
+                    LoopValue a = read(s1).number();
+                    LoopValue b = read(s2).number();
+                    written[s2] = a.isConstant() && b.isConstant() ? LoopValue::constant(~(a.offset | b.offset)) : LoopValue::opaque(a, b);
+                    sp = s1;
+                    pc += 1;
+                    break;
+                }
+                case op_jnz: {
+                    // only the jnz jumping back ends the loop
+                    if(pc != loop.end - 3 || ext(pc + 1) != loop.start) {
+                        return;
+                    }
+                    LoopValue flags = read(map_PSW);
+                    if(sp != loop.sp || !isR2Set || !flags.isFlags || !flags.isAffine || flags.base < 0 || (flags.offset & 0xFF) == 0) {
+                        return;
+                    }
+                    int counter = flags.base;
+                    LoopValue count = read(counter);
+                    if(count.isFlags || !count.isAffine || count.base != counter || count.offset != flags.offset) {
+                        return;
+                    }
+                    // nothing written may depend on what was written, but the counter
+                    for(const auto& entry : written) {
+                        if(entry.first >= loop.start && entry.first < loop.end) {
+                            return;
+                        }
+                        for(const auto& device : devices) {
+                            if(entry.first >= device.first && entry.first < device.second) {
+                                return;
+                            }
+                        }
+                        for(int address : entry.second.reads) {
+                            if(address != counter && written.count(address) != 0) {
+                                return;
+                            }
+                        }
+                    }
+                    for(int address : r2.reads) {
+                        if(address != counter && written.count(address) != 0) {
+                            return;
+                        }
+                    }
+                    loop.isCounted = true;
+                    loop.counter = counter;
+                    loop.step = flags.offset;
+                    return;
+                }
+                default: {
+                    // halt, jnn and invalid opcodes
+                    return;
+                }
+            }
+        }
+    }
+};
+
+#endif // LOOPS_H
@@ -0,0 +1,102 @@
+/*
+    the ssbc machine, following docs/abstractRTN.md
+
+    its step functions are generated from the RTN by rtn2cpp into rtnStep.h, which the machine's
+    members are named for: a capitalized member per register, MEM, and the counters; the generated
+    code goes through fetch, read and write for memory, so that a machine deriving from this one can
+    watch its accesses (profile.h) by hiding them
+*/
+
+#ifndef MACHINE_H
+#define MACHINE_H
+
+#include <vector>
+#include "../common.h"
+#include "rtnStep.h"
+
+// the reset value of the stack pointer
+const int SP_RESET = 0xFFFA;
+
+class Machine {
+    public:
+    unsigned char MEM[IMAGE_SIZE];  // main memory
+    int PC = 0;                     // program counter
+    int SP = SP_RESET;              // stack pointer
+    int MR = 0;                     // memory register
+    unsigned char R0 = 0;           // register 0
+    unsigned char R1 = 0;           // register 1
+    unsigned char R2 = 0;           // register 2
+    unsigned char R3 = 0;           // register 3
+    unsigned char IR = 0;           // instruction register
+    /* 1-bit indicators */
+    bool FAULT = false;
+    bool HALT = false;
+
+    // clock cycles and instructions executed since reset
+    long long cycles = 0;
+    long long instructions = 0;
+    // the step of the RTN the next clock cycle runs, 0 at the start of an instruction
+    int phase = 0;
+
+    Machine() {
+        std::fill(MEM, MEM + IMAGE_SIZE, 0);
+    }
+
+    // clears memory and copies the image in from address 0, then resets
+    void load(const std::vector<unsigned char>& image) {
+        std::fill(MEM, MEM + IMAGE_SIZE, 0);
+        std::copy(image.begin(), image.begin() + std::min<size_t>(image.size(), IMAGE_SIZE), MEM);
+        reset();
+    }
+
+    // the reset signal
+    void reset() {
+        rtnReset(*this);
+        cycles = 0;
+        instructions = 0;
+        phase = 0;
+    }
+
+    // the memory accesses of the RTN: fetching the program at PC, and reading or writing data
+    unsigned char fetch(int address) { return MEM[address]; }
+    unsigned char read(int address) { return MEM[address]; }
+    void write(int address, unsigned char value) { MEM[address] = value; }
+
+    // ports A,B,C,D
+    unsigned char portA() { return MEM[map_portA]; }
+    unsigned char portB() { return MEM[map_portB]; }
+    unsigned char portC() { return MEM[map_portC]; }
+    unsigned char portD() { return MEM[map_portD]; }
+
+    unsigned char PSW() { return MEM[map_PSW]; }        // program status word
+    bool Z() { return (PSW() >> 7) & 1; }               // zero flag bit
+    bool N() { return (PSW() >> 6) & 1; }               // negative flag bit
+    unsigned char ii() { return MEM[PC]; }              // immediate operand
+    unsigned char s1() { return MEM[(SP+1) & 0xFFFF]; } // first on stack
+    unsigned char s2() { return MEM[(SP+2) & 0xFFFF]; } // second on stack
+    // external addressing
+    int ext() { return (MEM[PC] << 8) | MEM[(PC+1) & 0xFFFF]; }
+
+    // runs one instruction interpretation and execution
+    // returns false if the machine is halted or faulted
+    bool step() {
+        return rtnStep(*this);
+    }
+
+    // runs one clock cycle of the RTN, phase being its step within the instruction
+    // returns false if the machine is halted or faulted
+    bool microStep() {
+        return rtnMicroStep(*this);
+    }
+
+    // runs until halted or faulted, or maxInstructions have run (if positive)
+    void run(long long maxInstructions = 0) {
+        while(step()) {
+            if(maxInstructions > 0 && instructions >= maxInstructions) {
+                break;
+            }
+        }
+    }
+};
+
+#endif // MACHINE_H
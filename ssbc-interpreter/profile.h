@@ -0,0 +1,235 @@
+/*
+    memory access profiling for the interpreter
+
+    a ProfiledMachine hides the machine's fetch, read and write, so the step functions generated from
+    the RTN report each access to a MemoryProfile, which counts
+    - the reads, writes and fetches (reads of the program at PC) of every 256-byte page
+    - exactly, the accesses of each address within a window, if one is chosen
+    the page counts may be sampled to cut their cost: a countdown, jittered so it doesn't fall into
+    step with a loop, picks one access in n on average, and each one picked counts for n
+    the plain Machine has none of this, so running unprofiled costs nothing
+
+    the profile is written as csv, a row per page and per address of the window, or as a ppm heatmap
+    with red for writes, green for reads and blue for fetches, each on a log scale; both are
+    annotated with the program's labels
+*/
+
+#ifndef PROFILE_H
+#define PROFILE_H
+
+#include <vector>
+#include <map>
+#include <string>
+#include <cmath>
+#include <cstdint>
+#include <ostream>
+#include "machine.h"
+
+enum AccessKind {
+    access_read,
+    access_write,
+    access_fetch,
+    access_count
+};
+
+const int PAGE_SIZE = 256;
+const int PAGE_COUNT = IMAGE_SIZE / PAGE_SIZE;
+
+class MemoryProfile {
+    public:
+    // the accesses of each kind per page, estimated if sampled
+    long long pages[PAGE_COUNT][access_count] = {};
+    // the window of addresses counted exactly, [windowStart, windowEnd), and its counts
+    int windowStart = 0;
+    int windowEnd = 0;
+    std::vector<long long> window;
+    // on average one access in samplePeriod is counted, for samplePeriod accesses
+    int samplePeriod = 1;
+
+    MemoryProfile(int _samplePeriod = 1, int _windowStart = 0, int _windowEnd = 0) :
+        windowStart(_windowStart), windowEnd(_windowEnd), window((_windowEnd - _windowStart) * access_count, 0),
+        samplePeriod(std::max(1, _samplePeriod)) {
+        windowSize = windowEnd - windowStart;
+        countdown = nextCountdown();
+    }
+
+    void record(int address, AccessKind kind) {
+        // one compare for the window, as an address below its start wraps past its size
+        if((unsigned)(address - windowStart) < windowSize) {
+            window[(address - windowStart) * access_count + kind]++;
+        }
+        if(--countdown == 0) {
+            sample(address, kind);
+        }
+    }
+
+    // the accesses of a kind to an address of the window
+    long long windowCount(int address, AccessKind kind) const {
+        return window[(address - windowStart) * access_count + kind];
+    }
+
+    private:
+    unsigned windowSize = 0;
+    int countdown = 1;
+    uint32_t random = 2463534242u;
+
+    // kept out of record, so that the common path is small enough to be inlined into the step
+    void sample(int address, AccessKind kind) {
+        countdown = nextCountdown();
+        pages[address / PAGE_SIZE][kind] += samplePeriod;
+    }
+
+    // uniform over 1 .. 2 * samplePeriod - 1, so its mean is samplePeriod
+    int nextCountdown() {
+        if(samplePeriod == 1) {
+            return 1;
+        }
+        random ^= random << 13;
+        random ^= random >> 17;
+        random ^= random << 5;
+        return 1 + random % (2 * samplePeriod - 1);
+    }
+};
+
+// a machine whose memory accesses are counted
+class ProfiledMachine : public Machine {
+    public:
+    MemoryProfile& profile;
+
+    ProfiledMachine(MemoryProfile& _profile) : profile(_profile) {}
+
+    unsigned char fetch(int address) {
+        profile.record(address, access_fetch);
+        return MEM[address];
+    }
+    unsigned char read(int address) {
+        profile.record(address, access_read);
+        return MEM[address];
+    }
+    void write(int address, unsigned char value) {
+        profile.record(address, access_write);
+        MEM[address] = value;
+    }
+
+    // as the machine's, with the accesses above
+    bool step() {
+        return rtnStep(*this);
+    }
+    bool microStep() {
+        return rtnMicroStep(*this);
+    }
+    void run(long long maxInstructions = 0) {
+        while(step()) {
+            if(maxInstructions > 0 && instructions >= maxInstructions) {
+                break;
+            }
+        }
+    }
+};
+
+// the labels at each address, space separated, from labels by name
+std::map<int, std::string> labelsByAddress(const std::map<std::string, int>& labels) {
+    std::map<int, std::string> result;
+    for(const auto& label : labels) {
+        std::string& names = result[label.second];
+        names += (names.empty() ? "" : " ") + label.first;
+    }
+    return result;
+}
+
+// the labels from first up to last, space separated
+std::string labelsBetween(const std::map<int, std::string>& labels, int first, int last) {
+    std::string result;
+    for(auto it = labels.lower_bound(first); it != labels.end() && it->first <= last; ++it) {
+        result += (result.empty() ? "" : " ") + it->second;
+    }
+    return result;
+}
+
+// writes a row per page accessed, then a row per address of the window accessed:
+// scope,address,reads,writes,fetches,labels
+void writeProfileCsv(std::ostream& os, const MemoryProfile& profile, const std::map<std::string, int>& labels) {
+    std::map<int, std::string> byAddress = labelsByAddress(labels);
+    os << "scope,address,reads,writes,fetches,labels\n";
+    for(int page = 0; page < PAGE_COUNT; page++) {
+        const long long* counts = profile.pages[page];
+        if(counts[access_read] + counts[access_write] + counts[access_fetch] == 0) {
+            continue;
+        }
+        int first = page * PAGE_SIZE;
+        os << "page,0x" << twoBytes2hex(first) << "," << counts[access_read] << "," << counts[access_write] << "," << counts[access_fetch]
+            << "," << labelsBetween(byAddress, first, first + PAGE_SIZE - 1) << "\n";
+    }
+    for(int address = profile.windowStart; address < profile.windowEnd; address++) {
+        long long reads = profile.windowCount(address, access_read);
+        long long writes = profile.windowCount(address, access_write);
+        long long fetches = profile.windowCount(address, access_fetch);
+        if(reads + writes + fetches == 0) {
+            continue;
+        }
+        os << "address,0x" << twoBytes2hex(address) << "," << reads << "," << writes << "," << fetches
+            << "," << labelsBetween(byAddress, address, address) << "\n";
+    }
+}
+
+// writes a binary ppm (P6) of the window, 16 addresses to a row, or if there is no window, of the
+// pages in a 16x16 grid; the labels of each cell are written as comments in the header
+void writeProfilePpm(std::ostream& os, const MemoryProfile& profile, const std::map<std::string, int>& labels) {
+    bool isWindow = profile.windowEnd > profile.windowStart;
+    int cells = isWindow ? profile.windowEnd - profile.windowStart : PAGE_COUNT;
+    int cellAddresses = isWindow ? 1 : PAGE_SIZE;
+    int first = isWindow ? profile.windowStart : 0;
+    int columns = 16;
+    int rows = (cells + columns - 1) / columns;
+    // large windows get smaller cells, so the image stays a reasonable size
+    int cellSize = rows <= 64 ? 16 : rows <= 256 ? 4 : 1;
+
+    std::vector<long long> counts(cells * access_count);
+    long long maxCounts[access_count] = {};
+    for(int cell = 0; cell < cells; cell++) {
+        for(int kind = 0; kind < access_count; kind++) {
+            long long count = isWindow ? profile.windowCount(first + cell, (AccessKind)kind) : profile.pages[cell][kind];
+            counts[cell * access_count + kind] = count;
+            maxCounts[kind] = std::max(maxCounts[kind], count);
+        }
+    }
+
+    std::map<int, std::string> byAddress = labelsByAddress(labels);
+    os << "P6\n";
+    os << "# " << (isWindow ? "addresses 0x" + twoBytes2hex(first) + " to 0x" + twoBytes2hex(profile.windowEnd - 1) : std::string("pages of 256 bytes"))
+        << ", " << columns << " to a row; red: writes, green: reads, blue: fetches, on a log scale\n";
+    for(int cell = 0; cell < cells; cell++) {
+        int address = first + cell * cellAddresses;
+        std::string names = labelsBetween(byAddress, address, address + cellAddresses - 1);
+        if(!names.empty()) {
+            os << "# row " << cell / columns << " column " << cell % columns << " (0x" << twoBytes2hex(address) << "): " << names << "\n";
+        }
+    }
+    os << columns * cellSize << " " << rows * cellSize << "\n255\n";
+
+    // the channels in the order of a pixel
+    const AccessKind channels[3] = { access_write, access_read, access_fetch };
+    std::vector<unsigned char> line(columns * cellSize * 3);
+    for(int row = 0; row < rows; row++) {
+        std::fill(line.begin(), line.end(), 0);
+        for(int column = 0; column < columns; column++) {
+            int cell = row * columns + column;
+            if(cell >= cells) {
+                break;
+            }
+            for(int c = 0; c < 3; c++) {
+                long long count = counts[cell * access_count + channels[c]];
+                long long maxCount = maxCounts[channels[c]];
+                int value = count == 0 ? 0 : (int)std::lround(255 * std::log1p((double)count) / std::log1p((double)maxCount));
+                for(int x = 0; x < cellSize; x++) {
+                    line[((column * cellSize) + x) * 3 + c] = value;
+                }
+            }
+        }
+        for(int y = 0; y < cellSize; y++) {
+            os.write(reinterpret_cast<const char*>(line.data()), line.size());
+        }
+    }
+}
+
+#endif // PROFILE_H
@@ -0,0 +1,356 @@
+/*
+    generated by rtn2cpp from docs/abstractRTN.md, do not edit
+    - rtnReset(m): the Reset branch of Ins_interpretation
+    - rtnStep(m): one instruction, its steps collapsed into straight-line code per opcode;
+      returns false if the machine is halted or faulted
+    - rtnMicroStep(m): one clock cycle, m.phase being the step to run, 0 at the start of an
+      instruction; returns false without a cycle if the machine is halted or faulted
+    memory is accessed through m.fetch(a) for the program at PC, m.read(a) and m.write(a, v)
+*/
+
+#ifndef RTNSTEP_H
+#define RTNSTEP_H
+
+template<typename M>
+void rtnReset(M& m) {
+    m.PC = 0;
+    m.SP = 0xFFFA;
+    m.HALT = 0;
+    m.FAULT = 0;
+}
+
+template<typename M>
+bool rtnStep(M& m) {
+    if(!m.FAULT && !m.HALT) {
+        m.IR = m.fetch(m.PC);
+        m.FAULT = !((m.IR & 0xF) <= 0xA);
+        if(!m.FAULT) {
+            m.PC = ((m.PC + 1) & 0xFFFF);
+            ++m.instructions;
+            switch(m.IR & 0xF) {
+                // Noop
+                case 0: {
+                    m.cycles += 4;
+                    break;
+                }
+                // Halt
+                case 1: {
+                    m.HALT = 1;
+                    m.cycles += 4;
+                    break;
+                }
+                // Pushimm
+                case 2: {
+                    m.write(m.SP, m.fetch(m.PC));
+                    int v0 = ((m.SP - 1) & 0xFFFF);
+                    int v1 = ((m.PC + 1) & 0xFFFF);
+                    m.SP = v0;
+                    m.PC = v1;
+                    m.cycles += 5;
+                    break;
+                }
+                // Pushext
+                case 3: {
+                    m.write(m.SP, m.read(((m.fetch(m.PC) << 8) | m.fetch(((m.PC + 1) & 0xFFFF)))));
+                    int v2 = ((m.SP - 1) & 0xFFFF);
+                    int v3 = ((m.PC + 2) & 0xFFFF);
+                    m.SP = v2;
+                    m.PC = v3;
+                    m.cycles += 5;
+                    break;
+                }
+                // Popinh
+                case 4: {
+                    m.SP = ((m.SP + 1) & 0xFFFF);
+                    m.cycles += 4;
+                    break;
+                }
+                // Popext
+                case 5: {
+                    m.write(((m.fetch(m.PC) << 8) | m.fetch(((m.PC + 1) & 0xFFFF))), m.read(((m.SP + 1) & 0xFFFF)));
+                    int v4 = ((m.SP + 1) & 0xFFFF);
+                    int v5 = ((m.PC + 2) & 0xFFFF);
+                    m.SP = v4;
+                    m.PC = v5;
+                    m.cycles += 5;
+                    break;
+                }
+                // Jnz
+                case 6: {
+                    int r6 = m.read(0xFFFB);
+                    bool c7 = !((r6 >> 7) & 1);
+                    int v8 = ((m.fetch(m.PC) << 8) | m.fetch(((m.PC + 1) & 0xFFFF)));
+                    bool c9 = ((r6 >> 7) & 1);
+                    int v10 = ((m.PC + 2) & 0xFFFF);
+                    if(c7) {
+                        m.PC = v8;
+                    }
+                    if(c9) {
+                        m.PC = v10;
+                    }
+                    m.cycles += 4;
+                    break;
+                }
+                // Jnn
+                case 7: {
+                    int r11 = m.read(0xFFFB);
+                    bool c12 = !((r11 >> 6) & 1);
+                    int v13 = ((m.fetch(m.PC) << 8) | m.fetch(((m.PC + 1) & 0xFFFF)));
+                    bool c14 = ((r11 >> 6) & 1);
+                    int v15 = ((m.PC + 2) & 0xFFFF);
+                    if(c12) {
+                        m.PC = v13;
+                    }
+                    if(c14) {
+                        m.PC = v15;
+                    }
+                    m.cycles += 4;
+                    break;
+                }
+                // Add
+                case 8: {
+                    int r16 = m.read(((m.SP + 1) & 0xFFFF));
+                    int r17 = m.read(((m.SP + 2) & 0xFFFF));
+                    int v18 = ((r16 + r17) & 0xFF);
+                    int a19 = ((m.SP + 2) & 0xFFFF);
+                    m.R2 = v18;
+                    m.write(a19, v18);
+                    int v20 = !(m.R2 != 0);
+                    int v21 = ((m.R2 >> 7) & 1);
+                    int v22 = ((m.SP + 1) & 0xFFFF);
+                    m.write(0xFFFB, (v20 << 7) | (v21 << 6));
+                    m.SP = v22;
+                    m.cycles += 5;
+                    break;
+                }
+                // Sub
+                case 9: {
+                    int r23 = m.read(((m.SP + 1) & 0xFFFF));
+                    int r24 = m.read(((m.SP + 2) & 0xFFFF));
+                    int v25 = ((r23 - r24) & 0xFF);
+                    int a26 = ((m.SP + 2) & 0xFFFF);
+                    m.R2 = v25;
+                    m.write(a26, v25);
+                    int v27 = !(m.R2 != 0);
+                    int v28 = ((m.R2 >> 7) & 1);
+                    int v29 = ((m.SP + 1) & 0xFFFF);
+                    m.write(0xFFFB, (v27 << 7) | (v28 << 6));
+                    m.SP = v29;
+                    m.cycles += 5;
+                    break;
+                }
+                // Nor
+                case 10: {
+                    m.write(((m.SP + 2) & 0xFFFF), ((~(m.read(((m.SP + 1) & 0xFFFF)) | m.read(((m.SP + 2) & 0xFFFF)))) & 0xFF));
+                    m.SP = ((m.SP + 1) & 0xFFFF);
+                    m.cycles += 5;
+                    break;
+                }
+                default: {
+                    m.cycles += 4;
+                    break;
+                }
+            }
+        } else {
+            m.cycles += 3;
+        }
+    } else {
+        return false;
+    }
+    return !m.HALT && !m.FAULT;
+}
+
+template<typename M>
+bool rtnMicroStep(M& m) {
+    switch(m.phase) {
+        // the start of an instruction
+        case 0: {
+            if(!m.FAULT && !m.HALT) {
+                m.IR = m.fetch(m.PC);
+                m.phase = 1;
+            } else {
+                return false;
+            }
+            break;
+        }
+        // set_fault
+        case 1: {
+            m.FAULT = !((m.IR & 0xF) <= 0xA);
+            m.phase = 2;
+            break;
+        }
+        // (NOT Fault) -> (PC <- PC+1; ins_exe)
+        case 2: {
+            if(!m.FAULT) {
+                m.PC = ((m.PC + 1) & 0xFFFF);
+                m.phase = 3;
+            } else {
+                m.phase = 0;
+            }
+            break;
+        }
+        // ins_exe
+        case 3: {
+            ++m.instructions;
+            switch(m.IR & 0xF) {
+                // Noop
+                case 0: {
+                    m.phase = 0;
+                    break;
+                }
+                // Halt
+                case 1: {
+                    m.HALT = 1;
+                    m.phase = 0;
+                    break;
+                }
+                // Pushimm
+                case 2: {
+                    m.write(m.SP, m.fetch(m.PC));
+                    m.phase = 4;
+                    break;
+                }
+                // Pushext
+                case 3: {
+                    m.write(m.SP, m.read(((m.fetch(m.PC) << 8) | m.fetch(((m.PC + 1) & 0xFFFF)))));
+                    m.phase = 5;
+                    break;
+                }
+                // Popinh
+                case 4: {
+                    m.SP = ((m.SP + 1) & 0xFFFF);
+                    m.phase = 0;
+                    break;
+                }
+                // Popext
+                case 5: {
+                    m.write(((m.fetch(m.PC) << 8) | m.fetch(((m.PC + 1) & 0xFFFF))), m.read(((m.SP + 1) & 0xFFFF)));
+                    m.phase = 6;
+                    break;
+                }
+                // Jnz
+                case 6: {
+                    int r6 = m.read(0xFFFB);
+                    bool c7 = !((r6 >> 7) & 1);
+                    int v8 = ((m.fetch(m.PC) << 8) | m.fetch(((m.PC + 1) & 0xFFFF)));
+                    bool c9 = ((r6 >> 7) & 1);
+                    int v10 = ((m.PC + 2) & 0xFFFF);
+                    if(c7) {
+                        m.PC = v8;
+                    }
+                    if(c9) {
+                        m.PC = v10;
+                    }
+                    m.phase = 0;
+                    break;
+                }
+                // Jnn
+                case 7: {
+                    int r11 = m.read(0xFFFB);
+                    bool c12 = !((r11 >> 6) & 1);
+                    int v13 = ((m.fetch(m.PC) << 8) | m.fetch(((m.PC + 1) & 0xFFFF)));
+                    bool c14 = ((r11 >> 6) & 1);
+                    int v15 = ((m.PC + 2) & 0xFFFF);
+                    if(c12) {
+                        m.PC = v13;
+                    }
+                    if(c14) {
+                        m.PC = v15;
+                    }
+                    m.phase = 0;
+                    break;
+                }
+                // Add
+                case 8: {
+                    int r19 = m.read(((m.SP + 1) & 0xFFFF));
+                    int r20 = m.read(((m.SP + 2) & 0xFFFF));
+                    int v21 = ((r19 + r20) & 0xFF);
+                    int a22 = ((m.SP + 2) & 0xFFFF);
+                    m.R2 = v21;
+                    m.write(a22, v21);
+                    m.phase = 7;
+                    break;
+                }
+                // Sub
+                case 9: {
+                    int r26 = m.read(((m.SP + 1) & 0xFFFF));
+                    int r27 = m.read(((m.SP + 2) & 0xFFFF));
+                    int v28 = ((r26 - r27) & 0xFF);
+                    int a29 = ((m.SP + 2) & 0xFFFF);
+                    m.R2 = v28;
+                    m.write(a29, v28);
+                    m.phase = 8;
+                    break;
+                }
+                // Nor
+                case 10: {
+                    m.write(((m.SP + 2) & 0xFFFF), ((~(m.read(((m.SP + 1) & 0xFFFF)) | m.read(((m.SP + 2) & 0xFFFF)))) & 0xFF));
+                    m.phase = 9;
+                    break;
+                }
+                default: {
+                    m.phase = 0;
+                    break;
+                }
+            }
+            break;
+        }
+        // (SP <- SP-1: PC <- PC+1)
+        case 4: {
+            int v0 = ((m.SP - 1) & 0xFFFF);
+            int v1 = ((m.PC + 1) & 0xFFFF);
+            m.SP = v0;
+            m.PC = v1;
+            m.phase = 0;
+            break;
+        }
+        // (SP <- SP-1: PC <- PC+2)
+        case 5: {
+            int v2 = ((m.SP - 1) & 0xFFFF);
+            int v3 = ((m.PC + 2) & 0xFFFF);
+            m.SP = v2;
+            m.PC = v3;
+            m.phase = 0;
+            break;
+        }
+        // (SP <- SP+1: PC <- PC+2)
+        case 6: {
+            int v4 = ((m.SP + 1) & 0xFFFF);
+            int v5 = ((m.PC + 2) & 0xFFFF);
+            m.SP = v4;
+            m.PC = v5;
+            m.phase = 0;
+            break;
+        }
+        // (Z <- NOT (R2<7> OR .. OR R2<0>): N <- R2<7>: SP <- SP+1)
+        case 7: {
+            int v16 = !(m.R2 != 0);
+            int v17 = ((m.R2 >> 7) & 1);
+            int v18 = ((m.SP + 1) & 0xFFFF);
+            m.write(0xFFFB, (v16 << 7) | (v17 << 6));
+            m.SP = v18;
+            m.phase = 0;
+            break;
+        }
+        // (Z <- NOT (R2<7> OR .. OR R2<0>): N <- R2<7>: SP <- SP+1)
+        case 8: {
+            int v23 = !(m.R2 != 0);
+            int v24 = ((m.R2 >> 7) & 1);
+            int v25 = ((m.SP + 1) & 0xFFFF);
+            m.write(0xFFFB, (v23 << 7) | (v24 << 6));
+            m.SP = v25;
+            m.phase = 0;
+            break;
+        }
+        // SP <- SP+1
+        case 9: {
+            m.SP = ((m.SP + 1) & 0xFFFF);
+            m.phase = 0;
+            break;
+        }
+    }
+    ++m.cycles;
+    return true;
+}
+
+#endif // RTNSTEP_H
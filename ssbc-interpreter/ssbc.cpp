@@ -1,75 +1,961 @@
+/*
+    the ssbc toolchain driver, with a subcommand for each stage:
+        ssbc asm program.s [-o outfile] [-f mac|bin|ihex|img] [--optimize [--rules rulesfile]] [--clean] [--linemac]
+        ssbc clean [program] [-o outfile]
+        ssbc linemac program [-o outfile] [-j threads]
+        ssbc run program [--portA n] [--portC n] [--max-instructions n] [--trace] [--micro] [--no-accelerate] [--linemac [file]]
+                         [--heatmap file.csv|file.ppm] [--heatmap-window start:end] [--heatmap-sample n] [--dma] [--dma-cycles n]
+                         [--events [file]] [--clock-hz n] [--coverage file] [--check-stack]
+        ssbc batch program [--runs n] [-j threads] [--max-instructions n] [--stats file.json|file.prom] [--stats-every seconds] [--coverage file]
+        ssbc coverage program.s coverage... [-o merged] [--report file.s] [--lcov file.info]
+        ssbc wcet program.s [--bounds file] [--routine label]
+        ssbc stack program.s [-o listing]
+        ssbc disasm program [-o outfile]
+    the program may be assembly (.s), which is assembled in-process, machine code (.mac),
+    intel hex (.hex, .ihex) or a raw binary or memory image (anything else)
+    chained stages pass their buffers along in memory, so nothing is written out and read back
+*/
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
 #include <cstdio>
+#include <memory>
+#include <functional>
+#include <climits>
+#include "../common.h"
+#include "../assem2mac/assembler.h"
+#include "../cleanMac/cleanMac.h"
+#include "../mac2lineMac/mac2lineMac.h"
+#include "../disasm/disassembler.h"
+#include "machine.h"
+#include "profile.h"
+#include "stats.h"
+#include "loops.h"
+#include "dma.h"
+#include "events.h"
+#include "coverage.h"
+#include "stack.h"
 
-// opcodes
-enum {
-    op_noop = 0,      // no operation
-    op_halt = 1,      // halt
-    op_pushimm = 2,   // push immediate
-    op_pushext = 3,   // push external
-    op_popinh = 4,    // pop inherent
-    op_popext = 5,    // pop external
-    op_jnz = 6,       // jump not zero
-    op_jnn = 7,       // jump not negative
-    op_add = 8,       // add
-    op_sub = 9,       // subtract
-    op_nor = 10,      // nor
-};
+// the most threads -j may ask for
+const int MAX_THREADS = 1024;
 
-enum {
-    state_ins_int,      // instruction interpertation
-    state_ins_exe,      // instruction execution
-    // state_noop,         // no operation
-    // state_halt,         // halt
-    // state_pushimm,      // push immediate
-    // state_pushext,      // push external
-    // state_popinh,       // pop inherent
-    // state_popext,       // pop external
-    // state_jnz,          // jump not zero
-    // state_jnn,          // jump not negative
-    // state_add,          // add
-    // state_sub,          // subtract
-    // state_nor,          // nor
-};
+// returns true if the string ends with the suffix
+bool endsWith(const std::string& input, const std::string& suffix) {
+    return input.size() >= suffix.size() && input.compare(input.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
 
-const int mem_size = 0xFFFF;
-
-char MEM[mem_size];     // main memory
-int PC = 0;             // program counter
-int SP = mem_size-1;    // stack pointer
-int MR = 0;             // memory register
-char R0 = 0;            // register 0
-char R1 = 0;            // register 1
-char R2 = 0;            // register 2
-char R3 = 0;            // register 3
-char IR = 0;            // instruction register
-/* 1-bit indicators */
-bool FAULT = false;
-bool HALT = false;
-bool RESET = false;
-// memory map
-enum {
-    map_PSW = 0xFFFB,
-    map_portA = 0xFFFC,
-    map_portB = 0xFFFD,
-    map_portC = 0xFFFE,
-    map_portD = 0xFFFF
+// reads the machine code lines (starting with 8 binary digits) of .mac text
+void readMac(const std::string& text, std::vector<unsigned char>& out_image) {
+    size_t pos = 0;
+    int byte;
+    while(pos < text.size()) {
+        const char* line = text.data() + pos;
+        const char* newline = static_cast<const char*>(std::memchr(line, '\n', text.size() - pos));
+        size_t length = newline != nullptr ? newline - line : text.size() - pos;
+        if(tryParseBinaryByte(line, length, byte)) {
+            out_image.push_back(byte);
+        }
+        pos += length + 1;
+    }
+}
+
+// a program as it passes through the stages of the toolchain
+class Program {
+    public:
+    // the machine code bytes, loaded at address 0
+    std::vector<unsigned char> image;
+    // the program as .mac text, for the text stages (clean, linemac), if it was loaded for them
+    std::string macText;
+    // the address of each label, and the source line of each byte, if the program was assembled
+    std::map<std::string, int> labels;
+    LineTable lineTable;
 };
 
-// ports A,B,C,D
-inline char portA() { return MEM[map_portA]; }
-inline char portB() { return MEM[map_portB]; }
-inline char portC() { return MEM[map_portC]; }
-inline char portD() { return MEM[map_portD]; }
+// writes each byte of the image as a .mac line of 8 binary digits
+std::string imageToMac(const std::vector<unsigned char>& image) {
+    std::string result;
+    result.reserve(image.size() * 9);
+    for(const unsigned char& b : image) {
+        for(int i = 7; i >= 0; i--) {
+            result.push_back('0' + ((b >> i) & 1));
+        }
+        result.push_back('\n');
+    }
+    return result;
+}
+
+// loads a program file, assembling it if it is ssbc assembly, with what the optimizer saved on
+// stderr if asked; its .mac text is only made if isMacText, for the commands that write it
+// returns false after writing an error if not possible
+bool tryLoadProgram(const std::string& fileName, Program& out_program, bool isMacText = false, AssembleOptions options = AssembleOptions()) {
+    bool isText = endsWith(fileName, ".s") || endsWith(fileName, ".mac") || endsWith(fileName, ".hex") || endsWith(fileName, ".ihex");
+    std::ifstream file;
+    file.open(fileName, isText ? std::ios::in : std::ios::binary);
+    if(!file.is_open()) {
+        std::cerr << "Error: could not open " << fileName << std::endl;
+        return false;
+    }
+
+    std::vector<unsigned char>& image = out_program.image;
+    if(endsWith(fileName, ".s")) {
+        std::stringstream source;
+        source << file.rdbuf();
+        // .include looks beside the program first
+        options.includeDirs.insert(options.includeDirs.begin(), directoryOf(fileName));
+        AssembleResult result = assemble(source.str(), options);
+        for(const auto& diagnostic : result.diagnostics) {
+            std::cerr << fileName << ": " << diagnostic << std::endl;
+        }
+        if(!result.ok) {
+            return false;
+        }
+        if(options.optimize) {
+            const OptimizeStats& stats = result.optimizeStats;
+            std::cerr << "optimizer: " << stats.rewrites << " rewrites, saved " << stats.bytesSaved << " bytes and an estimated "
+                << stats.cyclesSaved << " cycles (one execution of each rewritten site)" << std::endl;
+        }
+        image = result.image;
+        out_program.labels = result.addressMap.labels();
+        for(const auto& macLine : result.macLines) {
+            if(macLine->byte >= 0) {
+                out_program.lineTable.lines.push_back(macLine->assemLineNum);
+                out_program.lineTable.isInstruction.push_back(macLine->op >= 0);
+            }
+        }
+        for(const auto& sourceLine : result.sourceLines) {
+            out_program.lineTable.source.push_back(sourceLine.text);
+        }
+        if(isMacText) {
+            std::ostringstream macText;
+            writeMacListing(macText, result.macLines, false);
+            out_program.macText = macText.str();
+        }
+    } else if(endsWith(fileName, ".mac")) {
+        std::stringstream macText;
+        macText << file.rdbuf();
+        out_program.macText = macText.str();
+        readMac(out_program.macText, image);
+    } else if(endsWith(fileName, ".hex") || endsWith(fileName, ".ihex")) {
+        if(!tryReadIntelHex(file, image)) {
+            std::cerr << "Error: malformed intel hex in " << fileName << std::endl;
+            return false;
+        }
+        if(isMacText) {
+            out_program.macText = imageToMac(image);
+        }
+    } else {
+        image.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+        if(isMacText) {
+            out_program.macText = imageToMac(image);
+        }
+    }
+    return true;
+}
+
+// returns false after writing an error if the program does not fit in memory
+bool fitsInMemory(const std::string& fileName, const Program& program) {
+    if(program.image.size() > IMAGE_SIZE) {
+        std::cerr << "Error: " << fileName << " is " << program.image.size() << " bytes, which does not fit in memory" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+// the program with its instructions, as its symbol map would give them, if it was assembled
+MappedProgram mapProgram(const Program& program) {
+    MappedProgram mapped;
+    mapped.image = program.image;
+    mapped.labels = program.labels;
+    for(size_t address = 0; address < program.lineTable.lines.size(); address++) {
+        if(program.lineTable.isInstruction[address]) {
+            mapped.sizes[address] = opSize(program.image[address] & 0xF);
+            mapped.lines[address] = program.lineTable.lines[address];
+        }
+    }
+    return mapped;
+}
+
+// returns the program named by the argument after the subcommand, or "" if there is none
+std::string getProgramName(int argc, char** argv) {
+    return argc > 2 && argv[2][0] != '-' ? argv[2] : "";
+}
+
+// returns true if the flag was set, filling out_val with the argument after it if that isn't another flag
+bool tryParseOptionalArg(const int& argc, char** argv, const std::string& flagString, std::string& out_val) {
+    for(int i = 0; i < argc; i++) {
+        if(flagString == argv[i]) {
+            out_val = argc > i+1 && argv[i+1][0] != '-' ? argv[i+1] : "";
+            return true;
+        }
+    }
+    return false;
+}
+
+// writes the data to the named file, or to stdout if there is no name
+// returns false after writing an error if not possible
+bool tryWriteOutput(const std::string& fileName, const char* data, size_t size) {
+    if(fileName == "") {
+        std::cout.write(data, size);
+        std::cout.flush();
+        return true;
+    }
+    std::ofstream file;
+    file.open(fileName, std::ios::binary);
+    if(!file.is_open()) {
+        std::cerr << "Error: could not open " << fileName << std::endl;
+        return false;
+    }
+    file.write(data, size);
+    return true;
+}
+
+// writes the linemac listing of the program
+bool tryWriteLineMac(const Program& program, const std::string& fileName, int threadCount = 1) {
+    std::vector<char> lines;
+    lineMac(program.macText.data(), program.macText.size(), lines, threadCount);
+    return tryWriteOutput(fileName, lines.data(), lines.size());
+}
+
+// prints the state of the machine
+void printState(Machine& machine) {
+    std::cout << "PC=" << intToFourHex(machine.PC) << " SP=" << intToFourHex(machine.SP)
+        << " Z=" << machine.Z() << " N=" << machine.N() << std::endl;
+    std::cout << "portA=0x" << byte2hex(machine.portA()) << " portB=0x" << byte2hex(machine.portB())
+        << " portC=0x" << byte2hex(machine.portC()) << " portD=0x" << byte2hex(machine.portD()) << std::endl;
+}
+
+// where a machine marks the instructions it runs itself, or null if they are marked before its
+// step: an EventMachine may be interrupted into its handler within the step
+template<typename M>
+unsigned char** markedInStep(M& machine) {
+    return nullptr;
+}
+template<typename M>
+unsigned char** markedInStep(EventMachine<M>& machine) {
+    return &machine.hits;
+}
+
+// runs the machine until it halts or faults, or maxInstructions have run (if positive), marking
+// each instruction run in coverage if given, and stopping before a push below stackLimit if given
+template<typename M>
+void runMachine(M& machine, long long maxInstructions, bool isTrace, bool isMicro, CoverageMap* coverage = nullptr, int stackLimit = 0) {
+    // the marks made here, if the machine doesn't make them itself
+    unsigned char* hits = nullptr;
+    unsigned char** inStep = markedInStep(machine);
+    if(coverage != nullptr && inStep != nullptr) {
+        *inStep = coverage->hits;
+    } else if(coverage != nullptr) {
+        hits = coverage->hits;
+    }
+    if(isTrace) {
+        while(!machine.HALT && !machine.FAULT && (maxInstructions <= 0 || machine.instructions < maxInstructions) && !isStackOverflowing(machine, stackLimit)) {
+            if(hits != nullptr) {
+                hits[machine.PC] = 1;
+            }
+            int op = machine.MEM[machine.PC] & 0xF;
+            std::cout << intToFourHex(machine.PC) << " " << opName(op);
+            for(int i = 1; i < opSize(op); i++) {
+                std::cout << " " << byte2hex(machine.MEM[(machine.PC + i) & 0xFFFF]);
+            }
+            std::cout << std::endl;
+            machine.step();
+        }
+    } else if(isMicro) {
+        // a clock cycle at a time, finishing the instruction the limit is reached in
+        while(true) {
+            if(machine.phase == 0 && isStackOverflowing(machine, stackLimit)) {
+                break;
+            }
+            if(hits != nullptr && machine.phase == 0) {
+                hits[machine.PC] = 1;
+            }
+            if(!machine.microStep()) {
+                break;
+            }
+            if(maxInstructions > 0 && machine.instructions >= maxInstructions && machine.phase == 0) {
+                break;
+            }
+        }
+    } else if(hits != nullptr) {
+        // the mark is the only thing added to the loop
+        while(!isStackOverflowing(machine, stackLimit)) {
+            hits[machine.PC] = 1;
+            if(!machine.step() || (maxInstructions > 0 && machine.instructions >= maxInstructions)) {
+                break;
+            }
+        }
+    } else if(stackLimit > 0) {
+        while(!isStackOverflowing(machine, stackLimit)) {
+            if(!machine.step() || (maxInstructions > 0 && machine.instructions >= maxInstructions)) {
+                break;
+            }
+        }
+    } else {
+        machine.run(maxInstructions);
+    }
+}
+
+// writes how much of the program the coverage map covers to stderr, by source line if assembled
+void printCoverage(const CoverageMap& coverage, const Program& program) {
+    int instructions = 0, hit = 0;
+    for(const LineCoverage& line : coverLines(coverage, program.lineTable)) {
+        instructions += line.instructions > 0;
+        hit += line.hit > 0;
+    }
+    std::cerr << coverage.count() << " instruction addresses run";
+    if(!program.lineTable.empty()) {
+        std::cerr << ", covering " << hit << " of " << instructions << " source lines with instructions";
+    }
+    std::cerr << std::endl;
+}
+
+// fills out_val with the number given for the flag, in decimal or 0x hex, if it is given
+// returns false after writing an error if it isn't a number from min to max
+template<typename T>
+bool tryParseNumberArg(int argc, char** argv, const std::string& flagString, long long min, long long max, T& out_val) {
+    std::string value;
+    if(!tryParseArg(argc, argv, flagString, value)) {
+        return true;
+    }
+    long long number = 0;
+    size_t length = 0;
+    try {
+        number = std::stoll(value, &length, 0);
+    } catch(const std::exception&) {
+        length = 0;
+    }
+    if(length == 0 || length != value.size() || number < min || number > max) {
+        std::cerr << "Error: expected " << flagString << " to be a number from " << min << " to " << max << ", not '" << value << "'" << std::endl;
+        return false;
+    }
+    out_val = number;
+    return true;
+}
+
+// fills out_val with the seconds given for the flag, if it is given
+// returns false after writing an error if it isn't a number of seconds, 0 or more
+bool tryParseSecondsArg(int argc, char** argv, const std::string& flagString, double& out_val) {
+    std::string value;
+    if(!tryParseArg(argc, argv, flagString, value)) {
+        return true;
+    }
+    double seconds = -1;
+    size_t length = 0;
+    try {
+        seconds = std::stod(value, &length);
+    } catch(const std::exception&) {
+        length = 0;
+    }
+    if(length == 0 || length != value.size() || !(seconds >= 0)) {
+        std::cerr << "Error: expected " << flagString << " to be a number of seconds, not '" << value << "'" << std::endl;
+        return false;
+    }
+    out_val = seconds;
+    return true;
+}
+
+// reads a heatmap window, 'start:end' with end exclusive, each a number or a label of the program
+// returns false after writing an error if not possible
+bool tryParseWindow(const std::string& text, const Program& program, int& out_start, int& out_end) {
+    size_t colon = text.find(':');
+    int bounds[2];
+    std::string parts[2] = { text.substr(0, colon), colon != std::string::npos ? text.substr(colon + 1) : "" };
+    for(int i = 0; i < 2; i++) {
+        auto label = program.labels.find(parts[i]);
+        size_t length = 0;
+        if(label != program.labels.end()) {
+            bounds[i] = label->second;
+        } else {
+            try {
+                bounds[i] = std::stoi(parts[i], &length, 0);
+            } catch(const std::exception&) {
+                length = 0;
+            }
+            if(length == 0 || length != parts[i].size()) {
+                std::cerr << "Error: expected a heatmap window like 0x0100:0x0200, not '" << text << "'" << std::endl;
+                return false;
+            }
+        }
+    }
+    if(bounds[0] < 0 || bounds[0] >= bounds[1] || bounds[1] > IMAGE_SIZE) {
+        std::cerr << "Error: the heatmap window " << text << " is not within memory" << std::endl;
+        return false;
+    }
+    out_start = bounds[0];
+    out_end = bounds[1];
+    return true;
+}
+
+// runs a program, returning 0 if it halted, 1 if it faulted (or was stopped before overflowing its
+// stack) and 2 if it ran out of instructions
+int runCommand(int argc, char** argv) {
+    if(argc < 3) {
+        std::cerr << "Usage: " << argv[0] << " run program [--portA n] [--portC n] [--max-instructions n] [--trace] [--micro] [--no-accelerate]"
+            << " [--heatmap file.csv|file.ppm] [--heatmap-window start:end] [--heatmap-sample n] [--dma] [--dma-cycles n]"
+            << " [--events [file]] [--clock-hz n] [--coverage file] [--check-stack]" << std::endl;
+        return 1;
+    }
+
+    std::string value;
+    bool isLineMac = tryParseOptionalArg(argc, argv, "--linemac", value);
+    Program program;
+    if(!tryLoadProgram(argv[2], program, isLineMac) || !fitsInMemory(argv[2], program)) {
+        return 1;
+    }
+    if(isLineMac && !tryWriteLineMac(program, value)) {
+        return 1;
+    }
+
+    // the memory profile, if a heatmap is wanted
+    std::string heatmapFileName;
+    bool isProfiled = tryParseArg(argc, argv, "--heatmap", heatmapFileName);
+    if(isProfiled && !endsWith(heatmapFileName, ".csv") && !endsWith(heatmapFileName, ".ppm")) {
+        std::cerr << "Error: the heatmap is written as .csv or .ppm, not " << heatmapFileName << std::endl;
+        return 1;
+    }
+    int windowStart = 0, windowEnd = 0;
+    if(tryParseArg(argc, argv, "--heatmap-window", value) && !tryParseWindow(value, program, windowStart, windowEnd)) {
+        return 1;
+    }
+    int samplePeriod = 1;
+    if(!tryParseNumberArg(argc, argv, "--heatmap-sample", 1, INT_MAX, samplePeriod)) {
+        return 1;
+    }
+    MemoryProfile profile(samplePeriod, windowStart, windowEnd);
+    // the DMA device, if the program opts in to it, costing cyclesPerByte a byte
+    DmaDevice dma;
+    bool isDma = tryParseArg(argc, argv, "--dma");
+    if(!tryParseNumberArg(argc, argv, "--dma-cycles", 0, INT_MAX, dma.cyclesPerByte)) {
+        return 1;
+    }
+    // the timer, interrupts and the bytes of the events script arriving on the ports, at clockHz
+    EventDevices events;
+    std::string eventsFileName;
+    bool isEvents = tryParseOptionalArg(argc, argv, "--events", eventsFileName);
+    if(!tryParseNumberArg(argc, argv, "--clock-hz", 1, LLONG_MAX, events.clockHz)) {
+        return 1;
+    }
+    if(eventsFileName != "") {
+        std::ifstream eventsFile(eventsFileName);
+        if(!eventsFile.is_open()) {
+            std::cerr << "Error: could not open the events " << eventsFileName << std::endl;
+            return 1;
+        }
+        if(!tryReadEvents(eventsFile, events, std::cerr)) {
+            return 1;
+        }
+    }
+    long long maxInstructions = 0;
+    if(!tryParseNumberArg(argc, argv, "--max-instructions", 0, LLONG_MAX, maxInstructions)) {
+        return 1;
+    }
+    int portA = 0, portC = 0;
+    if(!tryParseNumberArg(argc, argv, "--portA", 0, 0xFF, portA) || !tryParseNumberArg(argc, argv, "--portC", 0, 0xFF, portC)) {
+        return 1;
+    }
+
+    bool isTrace = tryParseArg(argc, argv, "--trace");
+    bool isMicro = tryParseArg(argc, argv, "--micro");
+    // the instructions run, if asked for; the map is on the heap, as the machines are
+    std::string coverageFileName;
+    std::unique_ptr<CoverageMap> coverage;
+    if(tryParseArg(argc, argv, "--coverage", coverageFileName)) {
+        coverage.reset(new CoverageMap());
+    }
+    // pushes are checked against the end of the program, unless its stack is proven to stay above it
+    int stackLimit = 0;
+    if(tryParseArg(argc, argv, "--check-stack")) {
+        if(program.lineTable.empty()) {
+            std::cerr << "Error: checking the stack needs the program's source, not " << argv[2] << std::endl;
+            return 1;
+        }
+        StackReport report = analyzeStack(mapProgram(program));
+        for(const std::string& warning : report.warnings) {
+            std::cerr << "warning: " << warning << std::endl;
+        }
+        if(report.isSafe && !isEvents && !isDma) {
+            std::cerr << "stack proven to stay within " << depthToString(report.depth.min) << ".." << depthToString(report.depth.max)
+                << " bytes, above the program's end at " << intToFourHex(report.limit) << ": running unchecked" << std::endl;
+        } else {
+            if(report.isSafe) {
+                std::cerr << "stack proven safe, but not for interrupt handlers and DMA transfers: running checked" << std::endl;
+            }
+            stackLimit = report.limit;
+        }
+    }
+    // counted loops are run in closed form, unless every instruction is to be seen, or events may
+    // be due in the iterations skipped, or pushes are checked
+    bool isAccelerated = !isProfiled && !isTrace && !isMicro && !isEvents && coverage == nullptr && stackLimit == 0 && !tryParseArg(argc, argv, "--no-accelerate");
+    LoopAccelerator accelerator;
+    // loops triggering the device run every iteration, and loops it copies over are decoded again
+    accelerator.devices.push_back({ dma.base + dma_control, dma.base + dma_control + 1 });
+    dma.onTransfer = [&accelerator](int start, int end) {
+        accelerator.invalidate(start, end);
+    };
+
+    // the machine, with a layer for each device and the profile, if asked for; the layers are
+    // only built then, so the plain machine's step stays as it is
+    std::shared_ptr<Machine> machine;
+    std::function<void()> runIt;
+    auto use = [&](auto* layered) {
+        machine.reset(layered);
+        runIt = [layered, &accelerator, &coverage, isAccelerated, maxInstructions, isTrace, isMicro, stackLimit]() {
+            if(isAccelerated) {
+                accelerator.run(*layered, maxInstructions);
+            } else {
+                runMachine(*layered, maxInstructions, isTrace, isMicro, coverage.get(), stackLimit);
+            }
+        };
+    };
+    if(isEvents && isDma && isProfiled) {
+        use(new EventMachine<DmaMachine<ProfiledMachine>>(events, dma, profile));
+    } else if(isEvents && isDma) {
+        use(new EventMachine<DmaMachine<>>(events, dma));
+    } else if(isEvents && isProfiled) {
+        use(new EventMachine<ProfiledMachine>(events, profile));
+    } else if(isEvents) {
+        use(new EventMachine<>(events));
+    } else if(isDma && isProfiled) {
+        use(new DmaMachine<ProfiledMachine>(dma, profile));
+    } else if(isDma) {
+        use(new DmaMachine<>(dma));
+    } else if(isProfiled) {
+        use(new ProfiledMachine(profile));
+    } else {
+        use(new Machine());
+    }
+    machine->load(program.image);
+
+    machine->MEM[map_portA] = portA;
+    machine->MEM[map_portC] = portC;
+    runIt();
+
+    bool isOverflowed = !machine->HALT && !machine->FAULT && isStackOverflowing(*machine, stackLimit);
+    if(machine->HALT) {
+        std::cout << "halted";
+    } else if(machine->FAULT) {
+        std::cout << "faulted at " << intToFourHex(machine->PC);
+    } else if(isOverflowed) {
+        std::cout << "stopped before overflowing the stack into the program at " << intToFourHex(machine->SP);
+    } else {
+        std::cout << "stopped";
+    }
+    std::cout << " after " << machine->instructions << " instructions, " << machine->cycles << " cycles" << std::endl;
+    printState(*machine);
+    if(accelerator.loopsAccelerated > 0) {
+        std::cerr << accelerator.loopsAccelerated << " counted loops run in closed form, skipping " << accelerator.iterationsSkipped << " iterations" << std::endl;
+    }
+    if(dma.transfers > 0) {
+        std::cerr << dma.transfers << " DMA transfers of " << dma.bytes << " bytes" << std::endl;
+    }
+    if(isEvents) {
+        if(events.isStuck) {
+            std::cerr << "stopped waiting for an event, with none to come" << std::endl;
+        }
+        std::cerr << events.seconds(machine->cycles) * 1e3 << " ms simulated at " << events.clockHz << " Hz: " << events.events << " events, "
+            << events.interrupts << " interrupts, " << events.waits << " waits; " << events.idleCycles << " cycles skipped waiting, "
+            << events.spinCycles << " polling" << std::endl;
+    }
+
+    if(coverage != nullptr) {
+        printCoverage(*coverage, program);
+        if(!tryWriteCoverage(coverageFileName, *coverage, imageHash(program.image))) {
+            return 1;
+        }
+    }
+
+    if(isProfiled) {
+        std::ostringstream os;
+        if(endsWith(heatmapFileName, ".csv")) {
+            writeProfileCsv(os, profile, program.labels);
+        } else {
+            writeProfilePpm(os, profile, program.labels);
+        }
+        if(!tryWriteOutput(heatmapFileName, os.str().data(), os.str().size())) {
+            return 1;
+        }
+    }
+    return machine->HALT ? 0 : machine->FAULT || isOverflowed ? 1 : 2;
+}
+
+// the marks of a batch machine merged into coverage: none, or those of its CoverageMap
+void mergeMarks(CoverageMap& coverage, const NoMarks& marks) {}
+void mergeMarks(CoverageMap& coverage, const CoverageMarks& marks) {
+    coverage.merge(marks.coverage);
+}
+
+// runs the program runs times over threads of StatsMachine<Marks>, each thread taking the next run
+// until there are none left; the machines' marks are merged into coverage once they are done
+template<typename Marks>
+void runBatch(const Program& program, StatsRegistry& registry, int threadCount, long long runs, long long maxInstructions, CoverageMap& coverage) {
+    std::atomic<long long> nextRun{0};
+    std::vector<std::thread> threads;
+    std::vector<std::unique_ptr<StatsMachine<Marks>>> machines;
+    for(int t = 0; t < threadCount; t++) {
+        ThreadStats& stats = registry.addThread();
+        machines.emplace_back(new StatsMachine<Marks>(stats));
+        StatsMachine<Marks>* machine = machines.back().get();
+        threads.push_back(std::thread([&program, &nextRun, machine, runs, maxInstructions] {
+            for(long long run = nextRun++; run < runs; run = nextRun++) {
+                machine->load(program.image);
+                machine->MEM[map_portA] = run & 0xFF;
+                machine->MEM[map_portC] = (run >> 8) & 0xFF;
+                machine->run(maxInstructions);
+            }
+        }));
+    }
+    for(auto& thread : threads) {
+        thread.join();
+    }
+    for(const auto& machine : machines) {
+        mergeMarks(coverage, *machine);
+    }
+}
+
+// runs a program many times over threads, run i with port A at i's low byte and port C at its next
+// byte, collecting the stats of every run; the stats are written every so often if asked, and when
+// the process gets SIGUSR1
+int batchCommand(int argc, char** argv) {
+    std::string programName = getProgramName(argc, argv);
+    if(programName == "") {
+        std::cerr << "Usage: " << argv[0] << " batch program [--runs n] [-j threads] [--max-instructions n] [--stats file.json|file.prom] [--stats-every seconds] [--coverage file]" << std::endl;
+        return 1;
+    }
+    Program program;
+    if(!tryLoadProgram(programName, program) || !fitsInMemory(programName, program)) {
+        return 1;
+    }
+
+    long long runs = 256;
+    int threadCount = std::max(1u, std::thread::hardware_concurrency());
+    long long maxInstructions = 0;
+    double statsEvery = 0;
+    if(!tryParseNumberArg(argc, argv, "--runs", 0, LLONG_MAX, runs) || !tryParseNumberArg(argc, argv, "-j", 1, MAX_THREADS, threadCount)
+        || !tryParseNumberArg(argc, argv, "--max-instructions", 0, LLONG_MAX, maxInstructions) || !tryParseSecondsArg(argc, argv, "--stats-every", statsEvery)) {
+        return 1;
+    }
+    std::string statsFileName;
+    tryParseArg(argc, argv, "--stats", statsFileName);
+
+    StatsRegistry registry;
+    std::unique_ptr<StatsDumper> dumper;
+    if(statsFileName != "") {
+        dumper.reset(new StatsDumper(registry, statsFileName, statsEvery));
+    }
+    std::string coverageFileName;
+    bool isCovering = tryParseArg(argc, argv, "--coverage", coverageFileName);
+    std::unique_ptr<CoverageMap> coverage(new CoverageMap());
+    if(!isCovering) {
+        runBatch<NoMarks>(program, registry, threadCount, runs, maxInstructions, *coverage);
+    } else {
+        runBatch<CoverageMarks>(program, registry, threadCount, runs, maxInstructions, *coverage);
+        printCoverage(*coverage, program);
+        if(!tryWriteCoverage(coverageFileName, *coverage, imageHash(program.image))) {
+            return 1;
+        }
+    }
+    if(dumper != nullptr && !dumper->stop()) {
+        return 1;
+    }
+
+    StatsSnapshot stats = registry.read();
+    std::cout << stats.runs << " runs on " << threadCount << " threads: " << stats.halted << " halted, " << stats.faulted << " faulted, "
+        << stats.stopped << " stopped; " << stats.instructions << " instructions, " << stats.cycles << " cycles in " << stats.seconds
+        << " s (" << stats.mips << " MIPS)" << std::endl;
+    return 0;
+}
+
+// merges the coverage maps of a program, writing the merged map, the source annotated with the
+// instructions run of each line, and an lcov tracefile, as asked
+int coverageCommand(int argc, char** argv) {
+    std::string programName = getProgramName(argc, argv);
+    std::string outFileName, reportFileName, lcovFileName;
+    tryParseArg(argc, argv, "-o", outFileName);
+    tryParseArg(argc, argv, "--report", reportFileName);
+    tryParseArg(argc, argv, "--lcov", lcovFileName);
+    std::vector<std::string> mapFileNames;
+    for(int i = 3; i < argc; i++) {
+        std::string arg = argv[i];
+        if(arg == "-o" || arg == "--report" || arg == "--lcov") {
+            i++;
+        } else {
+            mapFileNames.push_back(arg);
+        }
+    }
+    if(programName == "" || mapFileNames.empty()) {
+        std::cerr << "Usage: " << argv[0] << " coverage program.s coverage... [-o merged] [--report file.s] [--lcov file.info]" << std::endl;
+        return 1;
+    }
+    Program program;
+    if(!tryLoadProgram(programName, program) || !fitsInMemory(programName, program)) {
+        return 1;
+    }
+    if((reportFileName != "" || lcovFileName != "") && program.lineTable.empty()) {
+        std::cerr << "Error: the report and lcov tracefile need the program's source, not " << programName << std::endl;
+        return 1;
+    }
+
+    uint64_t hash = imageHash(program.image);
+    std::unique_ptr<CoverageMap> coverage(new CoverageMap());
+    for(const std::string& mapFileName : mapFileNames) {
+        if(!tryMergeCoverage(mapFileName, *coverage, hash, std::cerr)) {
+            return 1;
+        }
+    }
+    printCoverage(*coverage, program);
+    if(outFileName != "" && !tryWriteCoverage(outFileName, *coverage, hash)) {
+        return 1;
+    }
+    if(reportFileName != "") {
+        std::ostringstream os;
+        writeCoverageReport(os, *coverage, program.lineTable);
+        if(!tryWriteOutput(reportFileName, os.str().data(), os.str().size())) {
+            return 1;
+        }
+    }
+    if(lcovFileName != "") {
+        std::ostringstream os;
+        writeLcov(os, *coverage, program.lineTable, programName, program.labels);
+        if(!tryWriteOutput(lcovFileName, os.str().data(), os.str().size())) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+// times the routines of an assembled program statically, see wcet/wcet.h
+int wcetCommand(int argc, char** argv) {
+    std::string programName = getProgramName(argc, argv);
+    if(programName == "" || !endsWith(programName, ".s")) {
+        std::cerr << "Usage: " << argv[0] << " wcet program.s [--bounds file] [--routine label]" << std::endl;
+        return 1;
+    }
+    Program program;
+    if(!tryLoadProgram(programName, program) || !fitsInMemory(programName, program)) {
+        return 1;
+    }
+    MappedProgram mapped = mapProgram(program);
+
+    std::map<int, LoopBound> bounds;
+    std::ostringstream source;
+    for(const std::string& line : program.lineTable.source) {
+        source << line << "\n";
+    }
+    std::istringstream sourceIn(source.str());
+    if(!tryReadSourceBounds(sourceIn, mapped, bounds, std::cerr)) {
+        return 1;
+    }
+    std::string boundsFileName;
+    if(tryParseArg(argc, argv, "--bounds", boundsFileName)) {
+        std::ifstream boundsFile(boundsFileName);
+        if(!boundsFile.is_open()) {
+            std::cerr << "Error: could not open " << boundsFileName << std::endl;
+            return 1;
+        }
+        if(!tryReadBounds(boundsFile, mapped, bounds, std::cerr)) {
+            return 1;
+        }
+    }
+
+    std::vector<RoutineTime> times;
+    std::string routine;
+    tryParseArg(argc, argv, "--routine", routine);
+    if(!tryAnalyzeRoutines(mapped, bounds, routine, times, std::cerr)) {
+        return 1;
+    }
+    writeRoutineTimes(std::cout, mapped, times);
+    for(const RoutineTime& time : times) {
+        if(!time.isBounded) {
+            return 2;
+        }
+    }
+    return 0;
+}
+
+// finds the depths of the stack at each instruction of an assembled program, warning where it may
+// overflow into the program
+int stackCommand(int argc, char** argv) {
+    std::string programName = getProgramName(argc, argv);
+    if(programName == "" || !endsWith(programName, ".s")) {
+        std::cerr << "Usage: " << argv[0] << " stack program.s [-o listing]" << std::endl;
+        return 1;
+    }
+    Program program;
+    if(!tryLoadProgram(programName, program) || !fitsInMemory(programName, program)) {
+        return 1;
+    }
+    MappedProgram mapped = mapProgram(program);
+    StackReport report = analyzeStack(mapped);
+    std::string outFileName;
+    tryParseArg(argc, argv, "-o", outFileName);
+    std::ostringstream os;
+    writeStackListing(os, mapped, report, program.lineTable.source);
+    if(!tryWriteOutput(outFileName, os.str().data(), os.str().size())) {
+        return 1;
+    }
+    for(const std::string& warning : report.warnings) {
+        std::cerr << "warning: " << warning << std::endl;
+    }
+    if(report.isSafe) {
+        std::cerr << "stack proven to stay within " << depthToString(report.depth.min) << ".." << depthToString(report.depth.max)
+            << " bytes, above the program's end at " << intToFourHex(report.limit) << std::endl;
+    }
+    return report.isSafe ? 0 : 2;
+}
+
+// assembles a program, writing it in the given format
+// the .mac text may be passed through the clean and linemac stages in memory
+int asmCommand(int argc, char** argv) {
+    std::string programName = getProgramName(argc, argv);
+    if(programName == "") {
+        std::cerr << "Usage: " << argv[0] << " asm program.s [-o outfile] [-f mac|bin|ihex|img] [--optimize [--rules rulesfile]] [--clean] [--linemac]" << std::endl;
+        return 1;
+    }
+    std::string format = "mac";
+    tryParseArg(argc, argv, "-f", format);
+    if(format != "mac" && format != "bin" && format != "ihex" && format != "img") {
+        std::cerr << "Error: unrecognized output format: '" << format << "'" << std::endl;
+        return 1;
+    }
+    std::string outFileName;
+    tryParseArg(argc, argv, "-o", outFileName);
+
+    AssembleOptions options;
+    options.optimize = tryParseArg(argc, argv, "--optimize");
+    std::string rulesFileName;
+    if(tryParseArg(argc, argv, "--rules", rulesFileName)) {
+        std::ifstream rulesFile(rulesFileName);
+        if(!rulesFile.is_open()) {
+            std::cerr << "Error: could not open " << rulesFileName << std::endl;
+            return 1;
+        }
+        if(!tryReadRules(rulesFile, options.rules, std::cerr)) {
+            return 1;
+        }
+    }
+    Program program;
+    if(!tryLoadProgram(programName, program, format == "mac", options)) {
+        return 1;
+    }
+
+    if(format == "mac") {
+        if(tryParseArg(argc, argv, "--clean")) {
+            std::vector<char> cleaned;
+            cleanMac(program.macText.data(), program.macText.size(), cleaned);
+            program.macText.assign(cleaned.begin(), cleaned.end());
+        }
+        if(tryParseArg(argc, argv, "--linemac")) {
+            return tryWriteLineMac(program, outFileName) ? 0 : 1;
+        }
+        return tryWriteOutput(outFileName, program.macText.data(), program.macText.size()) ? 0 : 1;
+    }
+
+    std::ostringstream os;
+    if(format == "bin") {
+        writeBinary(os, program.image);
+    } else if(format == "ihex") {
+        writeIntelHex(os, program.image);
+    } else if(!tryWriteImage(os, program.image)) {
+        std::cerr << "Error: " << programName << " is " << program.image.size() << " bytes, which does not fit in memory" << std::endl;
+        return 1;
+    }
+    return tryWriteOutput(outFileName, os.str().data(), os.str().size()) ? 0 : 1;
+}
+
+// removes anything except for binary text on a line, from a program or stdin
+int cleanCommand(int argc, char** argv) {
+    std::string programName = getProgramName(argc, argv);
+    std::string outFileName;
+    tryParseArg(argc, argv, "-o", outFileName);
+    if(programName == "") {
+        FILE* outFile = outFileName == "" ? stdout : std::fopen(outFileName.c_str(), "wb");
+        if(outFile == nullptr) {
+            std::cerr << "Error: could not open " << outFileName << std::endl;
+            return 1;
+        }
+        cleanMac(stdin, outFile);
+        if(outFile != stdout) {
+            std::fclose(outFile);
+        }
+        return 0;
+    }
+
+    Program program;
+    if(!tryLoadProgram(programName, program, true)) {
+        return 1;
+    }
+    std::vector<char> cleaned;
+    cleanMac(program.macText.data(), program.macText.size(), cleaned);
+    return tryWriteOutput(outFileName, cleaned.data(), cleaned.size()) ? 0 : 1;
+}
+
+// adds hex line numbers and hex bytes to the machine code lines of a program
+int linemacCommand(int argc, char** argv) {
+    std::string programName = getProgramName(argc, argv);
+    if(programName == "") {
+        std::cerr << "Usage: " << argv[0] << " linemac program [-o outfile] [-j threads]" << std::endl;
+        return 1;
+    }
+    std::string outFileName;
+    tryParseArg(argc, argv, "-o", outFileName);
+    // 0 threads for one per core
+    int threadCount = 1;
+    if(!tryParseNumberArg(argc, argv, "-j", 0, MAX_THREADS, threadCount)) {
+        return 1;
+    }
+    if(threadCount == 0) {
+        threadCount = std::max(1u, std::thread::hardware_concurrency());
+    }
 
-inline char PSW() { return MEM[map_PSW]; }              // program status word
-inline char Z_set() { return (PSW() >> 7) & 1; }        // zero flag bit
-inline char N_set() { return (PSW() >> 6) & 1; }        // not flag bit
-inline char ii() { return MEM[PC]; }                    // current instruction
-inline char s1() { return MEM[SP+1]; }                  // first on stack
-inline char s2() { return MEM[SP+2]; }                  // second on stack
-// external addressing
-inline int ext() { return (0xFF00 & (MEM[PC] << 8)) | (0x00FF & MEM[PC+1]); }
+    Program program;
+    if(!tryLoadProgram(programName, program, true)) {
+        return 1;
+    }
+    return tryWriteLineMac(program, outFileName, threadCount) ? 0 : 1;
+}
 
-int main() {
+// writes the disassembly of a program
+int disasmCommand(int argc, char** argv) {
+    std::string programName = getProgramName(argc, argv);
+    if(programName == "") {
+        std::cerr << "Usage: " << argv[0] << " disasm program [-o outfile]" << std::endl;
+        return 1;
+    }
+    std::string outFileName;
+    tryParseArg(argc, argv, "-o", outFileName);
+    Program program;
+    if(!tryLoadProgram(programName, program) || !fitsInMemory(programName, program)) {
+        return 1;
+    }
+    std::string text;
+    Disassembler disassembler;
+    disassembler.disassemble(program.image.data(), program.image.size(), text);
+    return tryWriteOutput(outFileName, text.data(), text.size()) ? 0 : 1;
+}
 
-}
\ No newline at end of file
+int main(int argc, char** argv) {
+    std::string command = argc > 1 ? argv[1] : "";
+    if(command == "asm") {
+        return asmCommand(argc, argv);
+    } else if(command == "clean") {
+        return cleanCommand(argc, argv);
+    } else if(command == "linemac") {
+        return linemacCommand(argc, argv);
+    } else if(command == "run") {
+        return runCommand(argc, argv);
+    } else if(command == "batch") {
+        return batchCommand(argc, argv);
+    } else if(command == "coverage") {
+        return coverageCommand(argc, argv);
+    } else if(command == "wcet") {
+        return wcetCommand(argc, argv);
+    } else if(command == "stack") {
+        return stackCommand(argc, argv);
+    } else if(command == "disasm") {
+        return disasmCommand(argc, argv);
+    }
+    std::cerr << "Usage: " << argv[0] << " asm|clean|linemac|run|batch|coverage|wcet|stack|disasm program [options]" << std::endl;
+    return 1;
+}
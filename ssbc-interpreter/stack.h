@@ -0,0 +1,192 @@
+/*
+    static stack depths: how deep the stack may be at each instruction of an assembled program
+
+    the stack grows down from SP_RESET toward the program, a push writing MEM[SP] and nothing
+    checking where that is. the program's graph from reset (ProgramGraph, wcet/wcet.h, which follows
+    calls back through the return jumps they write) is walked with the depth at each node as a
+    range, pushes adding 1 and pops taking 1, joined where ways meet; a range still growing after its
+    node has been reached WIDEN_AFTER times is widened to no bound on that side, so a loop which
+    pushes more than it pops is found in a few passes rather than one per byte
+    the program is safe if no push may write below the end of its image (or wrap around the top of
+    memory into it), and it returns nowhere unknown and writes no opcode nor jump but its return
+    jumps, which the graph relies on; the address of a pushext or popext may be written, as compiled
+    array accesses do, and a popext is taken to write what its address was assembled as
+    run --check-stack runs a safe program as is, and any other with a check before each push,
+    stopping the machine rather than letting it write over its own code
+    interrupt handlers and DMA transfers aren't in the graph, so with those devices there is no proof
+*/
+
+#ifndef STACK_H
+#define STACK_H
+
+#include <vector>
+#include <string>
+#include <ostream>
+#include <climits>
+#include <algorithm>
+#include "machine.h"
+#include "../wcet/wcet.h"
+
+// the times a node's range may grow before it is widened
+const int WIDEN_AFTER = 8;
+
+// a depth with no bound
+const int DEPTH_UNBOUNDED = INT_MAX / 2;
+
+// the depths of the stack, bytes pushed below SP_RESET, from min to max; empty (min > max) where
+// nothing was found
+class StackRange {
+    public:
+    int min = DEPTH_UNBOUNDED;
+    int max = -DEPTH_UNBOUNDED;
+
+    bool empty() const {
+        return min > max;
+    }
+
+    // joins other into the range; returns true if it grew
+    bool join(const StackRange& other) {
+        if(other.empty() || (other.min >= min && other.max <= max)) {
+            return false;
+        }
+        min = std::min(min, other.min);
+        max = std::max(max, other.max);
+        return true;
+    }
+};
+
+// writes a depth, '?' for no bound
+std::string depthToString(int depth) {
+    return depth >= DEPTH_UNBOUNDED || depth <= -DEPTH_UNBOUNDED ? "?" : std::to_string(depth);
+}
+
+class StackReport {
+    public:
+    // whether no push may write into the program, and if not what may
+    bool isSafe = false;
+    std::vector<std::string> warnings;
+    // the depths at each address where an instruction was reached, and over the program
+    std::vector<StackRange> ranges = std::vector<StackRange>(IMAGE_SIZE);
+    StackRange depth;
+    // the lowest address the stack may write: the end of the program
+    int limit = 0;
+};
+
+// finds the depths of the stack at each instruction of the program run from reset
+StackReport analyzeStack(const MappedProgram& program) {
+    StackReport report;
+    report.limit = program.image.size();
+    ProgramGraph graph(program);
+    if(!graph.tryBuild(0)) {
+        report.warnings.push_back("the program " + graph.problem);
+        return report;
+    }
+    const std::vector<ProgramGraph::Node>& nodes = graph.nodes;
+
+    // the opcodes and jump operands, which the graph is made of: only return jumps may be written,
+    // while the operands of the other instructions are data (compiled array accesses write them)
+    std::vector<bool> isCode(IMAGE_SIZE);
+    for(int address = 0; address < (int)program.image.size(); address++) {
+        int op = program.image[address] & 0xF;
+        for(int k = 0; k < program.sizes[address] && address + k < IMAGE_SIZE; k++) {
+            isCode[address + k] = k == 0 || op == op_jnz || op == op_jnn;
+        }
+    }
+    for(const ProgramGraph::Node& node : nodes) {
+        int pc = node.state.pc;
+        int op = program.image[pc] & 0xF;
+        if(node.ends & end_return) {
+            report.warnings.push_back("returns at " + program.describe(pc) + " to an address it can't tell");
+        }
+        if(op == op_popext) {
+            int address = (program.image[pc + 1] << 8) | program.image[pc + 2];
+            if(isCode[address] && !graph.isReturnOperandAt(address)) {
+                report.warnings.push_back("writes its own code at " + program.describe(address) + ", from " + program.describe(pc));
+            }
+        }
+    }
+
+    // the depth at each node as it starts, widened where it keeps growing
+    std::vector<StackRange> before(nodes.size());
+    std::vector<int> grown(nodes.size());
+    before[0].min = before[0].max = 0;
+    std::vector<int> work = { 0 };
+    while(!work.empty()) {
+        int id = work.back();
+        work.pop_back();
+        int op = program.image[nodes[id].state.pc] & 0xF;
+        int delta = op == op_pushimm || op == op_pushext ? 1 : op == op_popinh || op == op_popext || op == op_add || op == op_sub || op == op_nor ? -1 : 0;
+        StackRange after = before[id];
+        after.min = after.min <= -DEPTH_UNBOUNDED ? after.min : after.min + delta;
+        after.max = after.max >= DEPTH_UNBOUNDED ? after.max : after.max + delta;
+        for(int to : nodes[id].successors) {
+            StackRange was = before[to];
+            if(!before[to].join(after)) {
+                continue;
+            }
+            if(!was.empty() && ++grown[to] > WIDEN_AFTER) {
+                before[to].min = before[to].min < was.min ? -DEPTH_UNBOUNDED : before[to].min;
+                before[to].max = before[to].max > was.max ? DEPTH_UNBOUNDED : before[to].max;
+            }
+            work.push_back(to);
+        }
+    }
+
+    // a push at depth d writes SP_RESET - d, which must be in [limit, 0xFFFF]
+    std::vector<bool> isWarned(IMAGE_SIZE);
+    bool isUnboundedWarned = false;
+    for(size_t id = 0; id < nodes.size(); id++) {
+        int pc = nodes[id].state.pc;
+        const StackRange& range = before[id];
+        report.ranges[pc].join(range);
+        report.depth.join(range);
+        int op = program.image[pc] & 0xF;
+        if((op != op_pushimm && op != op_pushext) || isWarned[pc]) {
+            continue;
+        }
+        if(range.max >= DEPTH_UNBOUNDED) {
+            // once, for the first push found, rather than for every push after it
+            if(!isUnboundedWarned) {
+                report.warnings.push_back("the stack may grow without bound, the push at " + program.describe(pc) + " writing anywhere below it");
+            }
+            isUnboundedWarned = true;
+        } else if(SP_RESET - range.max < report.limit) {
+            report.warnings.push_back("the push at " + program.describe(pc) + " may write " + intToFourHex(SP_RESET - range.max) + ", in the program");
+        } else if(SP_RESET - range.min > 0xFFFF) {
+            report.warnings.push_back("the push at " + program.describe(pc) + " may wrap around the top of memory into the program, as the stack may be popped " + depthToString(-range.min) + " bytes above its reset");
+        } else {
+            continue;
+        }
+        isWarned[pc] = true;
+    }
+    report.isSafe = report.warnings.empty();
+    return report;
+}
+
+// writes each instruction of the program with the depths of the stack before it, '-' if never
+// reached, and its source line if given
+void writeStackListing(std::ostream& os, const MappedProgram& program, const StackReport& report, const std::vector<std::string>& source) {
+    for(int address = 0; address < (int)program.image.size(); address++) {
+        if(program.sizes[address] == 0) {
+            continue;
+        }
+        const StackRange& range = report.ranges[address];
+        std::string depth = range.empty() ? "-" : depthToString(range.min) + ".." + depthToString(range.max);
+        os << intToFourHex(address) << " " << padLeft(depth, 9) << " |";
+        int line = program.lines[address];
+        if(line > 0 && line <= (int)source.size()) {
+            os << " " << source[line - 1];
+        }
+        os << "\n";
+    }
+}
+
+// returns true if the machine's next instruction is a push which would write below limit, as
+// checked before each instruction of a program not proven safe
+template<typename M>
+bool isStackOverflowing(M& machine, int limit) {
+    int op = machine.MEM[machine.PC] & 0xF;
+    return machine.SP < limit && (op == op_pushimm || op == op_pushext);
+}
+
+#endif // STACK_H
@@ -0,0 +1,402 @@
+/*
+    machine statistics for batch runs, exported as json or in prometheus' text format
+
+    each worker thread runs its machines as StatsMachines, which count into plain members as they
+    step: instructions per opcode, branches taken and not, the deepest the stack went below its reset
+    value, and the bytes read from and written to the ports; if asked, each also marks the
+    instructions it runs in its own CoverageMap (coverage.h), for the batch to merge at the end,
+    being then a StatsMachine<CoverageMarks> rather than a StatsMachine<NoMarks>.
+    every so often, and at the end of each run, a machine publishes its counts to its thread's
+    ThreadStats, the only writer of it, so the stores are relaxed atomics without a locked
+    read-modify-write and no cache line is shared between threads. StatsRegistry::read merges the
+    threads' counters whenever a dump is wanted, and StatsDumper writes one every interval, when the
+    process gets SIGUSR1, and when it is stopped
+*/
+
+#ifndef STATS_H
+#define STATS_H
+
+#include <atomic>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <condition_variable>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <string>
+#include <sstream>
+#include <fstream>
+#include <iostream>
+#include "machine.h"
+#include "coverage.h"
+
+// the instructions a run took, in buckets up to 1, 4, 16, .. 4^(RUN_BUCKETS-1), then the rest
+const int RUN_BUCKETS = 14;
+
+// the bucket of a run of n instructions
+int runBucket(long long n) {
+    int bucket = 0;
+    long long bound = 1;
+    while(bucket < RUN_BUCKETS && n > bound) {
+        bucket++;
+        bound *= 4;
+    }
+    return bucket;
+}
+
+// adds to a counter only its own thread writes, so the addition needn't be atomic
+inline void addRelaxed(std::atomic<long long>& counter, long long n) {
+    counter.store(counter.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+}
+
+// a thread's counters, on cache lines of their own
+class alignas(64) ThreadStats {
+    public:
+    // by the low 4 bits of the opcode, the ones past op_nor being invalid
+    std::atomic<long long> opcodes[16] = {};
+    std::atomic<long long> cycles{0};
+    std::atomic<long long> branchesTaken{0};
+    std::atomic<long long> branchesNotTaken{0};
+    std::atomic<long long> portBytesIn{0};
+    std::atomic<long long> portBytesOut{0};
+    std::atomic<long long> maxStackDepth{0};
+    // the outcome of each run, and the histogram of their instructions
+    std::atomic<long long> halted{0};
+    std::atomic<long long> faulted{0};
+    std::atomic<long long> stopped{0};
+    std::atomic<long long> runBuckets[RUN_BUCKETS + 1] = {};
+    std::atomic<long long> runInstructions{0};
+};
+
+// the counters of every thread, added up, and the rate of instructions
+class StatsSnapshot {
+    public:
+    long long opcodes[16] = {};
+    long long instructions = 0;
+    long long cycles = 0;
+    long long branchesTaken = 0;
+    long long branchesNotTaken = 0;
+    long long portBytesIn = 0;
+    long long portBytesOut = 0;
+    long long maxStackDepth = 0;
+    long long halted = 0;
+    long long faulted = 0;
+    long long stopped = 0;
+    long long runBuckets[RUN_BUCKETS + 1] = {};
+    long long runInstructions = 0;
+    long long runs = 0;
+    int threads = 0;
+    double seconds = 0;
+    double mips = 0;
+};
+
+class StatsRegistry {
+    public:
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+    // the counters of a new thread, which stay with the registry after the thread has finished
+    ThreadStats& addThread() {
+        std::lock_guard<std::mutex> lock(mutex);
+        threads.push_back(std::unique_ptr<ThreadStats>(new ThreadStats()));
+        return *threads.back();
+    }
+
+    // merges every thread's counters
+    StatsSnapshot read() {
+        StatsSnapshot s;
+        std::lock_guard<std::mutex> lock(mutex);
+        for(const auto& thread : threads) {
+            const ThreadStats& t = *thread;
+            for(int op = 0; op < 16; op++) {
+                s.opcodes[op] += t.opcodes[op].load(std::memory_order_relaxed);
+            }
+            s.cycles += t.cycles.load(std::memory_order_relaxed);
+            s.branchesTaken += t.branchesTaken.load(std::memory_order_relaxed);
+            s.branchesNotTaken += t.branchesNotTaken.load(std::memory_order_relaxed);
+            s.portBytesIn += t.portBytesIn.load(std::memory_order_relaxed);
+            s.portBytesOut += t.portBytesOut.load(std::memory_order_relaxed);
+            s.maxStackDepth = std::max(s.maxStackDepth, t.maxStackDepth.load(std::memory_order_relaxed));
+            s.halted += t.halted.load(std::memory_order_relaxed);
+            s.faulted += t.faulted.load(std::memory_order_relaxed);
+            s.stopped += t.stopped.load(std::memory_order_relaxed);
+            for(int b = 0; b <= RUN_BUCKETS; b++) {
+                s.runBuckets[b] += t.runBuckets[b].load(std::memory_order_relaxed);
+            }
+            s.runInstructions += t.runInstructions.load(std::memory_order_relaxed);
+        }
+        for(int op = 0; op < 16; op++) {
+            s.instructions += s.opcodes[op];
+        }
+        s.runs = s.halted + s.faulted + s.stopped;
+        s.threads = threads.size();
+        s.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        s.mips = s.seconds > 0 ? s.instructions / s.seconds / 1e6 : 0;
+        return s;
+    }
+
+    private:
+    std::mutex mutex;
+    std::vector<std::unique_ptr<ThreadStats>> threads;
+};
+
+// what a StatsMachine marks of the instructions it runs: nothing, or each in its CoverageMap
+class NoMarks {
+    public:
+    void mark(int address) {}
+};
+class CoverageMarks {
+    public:
+    // the instructions run, over every run of the machine
+    CoverageMap coverage;
+
+    void mark(int address) {
+        coverage.hits[address] = 1;
+    }
+};
+
+// a machine counting what it runs, publishing to its thread's stats, and marking with Marks (the
+// choice made once for the batch, so stepping tests no flag)
+template<typename Marks>
+class StatsMachine : public Machine, public Marks {
+    public:
+    ThreadStats& stats;
+    // the counts since the last publish
+    long long opcodes[16] = {};
+    long long branchesTaken = 0;
+    long long branchesNotTaken = 0;
+    long long portBytesIn = 0;
+    long long portBytesOut = 0;
+    long long maxStackDepth = 0;
+    long long publishedCycles = 0;
+
+    StatsMachine(ThreadStats& _stats) : stats(_stats) {}
+
+    // the ports are the top of memory
+    unsigned char read(int address) {
+        portBytesIn += address >= map_portA;
+        return MEM[address];
+    }
+    void write(int address, unsigned char value) {
+        portBytesOut += address >= map_portA;
+        MEM[address] = value;
+    }
+
+    bool step() {
+        if(HALT || FAULT) {
+            return false;
+        }
+        this->mark(PC);
+        int op = MEM[PC] & 0xF;
+        // a branch is taken on its flag being clear, as the flags were before it ran
+        bool isTaken = !(MEM[map_PSW] & (op == op_jnz ? 0x80 : 0x40));
+        bool isRunning = rtnStep(*this);
+        opcodes[op]++;
+        if(op == op_jnz || op == op_jnn) {
+            branchesTaken += isTaken;
+            branchesNotTaken += !isTaken;
+        }
+        maxStackDepth = std::max<long long>(maxStackDepth, SP_RESET - SP);
+        return isRunning;
+    }
+
+    // adds the counts since the last publish to the thread's stats
+    void publish() {
+        for(int op = 0; op < 16; op++) {
+            addRelaxed(stats.opcodes[op], opcodes[op]);
+            opcodes[op] = 0;
+        }
+        addRelaxed(stats.cycles, cycles - publishedCycles);
+        publishedCycles = cycles;
+        addRelaxed(stats.branchesTaken, branchesTaken);
+        addRelaxed(stats.branchesNotTaken, branchesNotTaken);
+        addRelaxed(stats.portBytesIn, portBytesIn);
+        addRelaxed(stats.portBytesOut, portBytesOut);
+        branchesTaken = branchesNotTaken = portBytesIn = portBytesOut = 0;
+        if(maxStackDepth > stats.maxStackDepth.load(std::memory_order_relaxed)) {
+            stats.maxStackDepth.store(maxStackDepth, std::memory_order_relaxed);
+        }
+    }
+
+    // runs a loaded program, publishing every publishEvery instructions and at the end
+    void run(long long maxInstructions = 0, long long publishEvery = 1 << 20) {
+        publishedCycles = 0;
+        maxStackDepth = 0;
+        long long nextPublish = publishEvery;
+        while(step()) {
+            if(instructions >= nextPublish) {
+                publish();
+                nextPublish += publishEvery;
+            }
+            if(maxInstructions > 0 && instructions >= maxInstructions) {
+                break;
+            }
+        }
+        publish();
+        addRelaxed(HALT ? stats.halted : FAULT ? stats.faulted : stats.stopped, 1);
+        addRelaxed(stats.runBuckets[runBucket(instructions)], 1);
+        addRelaxed(stats.runInstructions, instructions);
+    }
+};
+
+// the upper bound of a bucket of the run histogram
+std::string runBucketBound(int bucket) {
+    return bucket == RUN_BUCKETS ? "+Inf" : std::to_string(1ll << (2 * bucket));
+}
+
+void writeStatsJson(std::ostream& os, const StatsSnapshot& s) {
+    os << "{\n";
+    os << "  \"seconds\": " << s.seconds << ",\n";
+    os << "  \"threads\": " << s.threads << ",\n";
+    os << "  \"mips\": " << s.mips << ",\n";
+    os << "  \"runs\": { \"halted\": " << s.halted << ", \"faulted\": " << s.faulted << ", \"stopped\": " << s.stopped << " },\n";
+    os << "  \"instructions\": " << s.instructions << ",\n";
+    os << "  \"opcodes\": {";
+    long long invalid = 0;
+    for(int op = 0; op < 16; op++) {
+        if(op < op_count) {
+            os << (op == 0 ? " " : ", ") << "\"" << opName(op) << "\": " << s.opcodes[op];
+        } else {
+            invalid += s.opcodes[op];
+        }
+    }
+    os << ", \"invalid\": " << invalid << " },\n";
+    os << "  \"cycles\": " << s.cycles << ",\n";
+    os << "  \"branches\": { \"taken\": " << s.branchesTaken << ", \"notTaken\": " << s.branchesNotTaken << " },\n";
+    os << "  \"maxStackDepth\": " << s.maxStackDepth << ",\n";
+    os << "  \"portBytes\": { \"in\": " << s.portBytesIn << ", \"out\": " << s.portBytesOut << " },\n";
+    os << "  \"runInstructions\": { \"sum\": " << s.runInstructions << ", \"buckets\": [";
+    for(int b = 0; b <= RUN_BUCKETS; b++) {
+        std::string bound = b == RUN_BUCKETS ? "null" : runBucketBound(b);
+        os << (b == 0 ? " " : ", ") << "{ \"le\": " << bound << ", \"runs\": " << s.runBuckets[b] << " }";
+    }
+    os << " ] }\n";
+    os << "}\n";
+}
+
+// writes the metric's help and type lines
+void writePrometheusHeader(std::ostream& os, const std::string& name, const std::string& type, const std::string& help) {
+    os << "# HELP " << name << " " << help << "\n# TYPE " << name << " " << type << "\n";
+}
+
+void writeStatsPrometheus(std::ostream& os, const StatsSnapshot& s) {
+    writePrometheusHeader(os, "ssbc_instructions_total", "counter", "Instructions run, by opcode.");
+    long long invalid = 0;
+    for(int op = 0; op < 16; op++) {
+        if(op < op_count) {
+            os << "ssbc_instructions_total{opcode=\"" << opName(op) << "\"} " << s.opcodes[op] << "\n";
+        } else {
+            invalid += s.opcodes[op];
+        }
+    }
+    os << "ssbc_instructions_total{opcode=\"invalid\"} " << invalid << "\n";
+    writePrometheusHeader(os, "ssbc_cycles_total", "counter", "Clock cycles run.");
+    os << "ssbc_cycles_total " << s.cycles << "\n";
+    writePrometheusHeader(os, "ssbc_branches_total", "counter", "Conditional jumps, by whether they were taken.");
+    os << "ssbc_branches_total{taken=\"true\"} " << s.branchesTaken << "\n";
+    os << "ssbc_branches_total{taken=\"false\"} " << s.branchesNotTaken << "\n";
+    writePrometheusHeader(os, "ssbc_runs_total", "counter", "Finished runs, by how they ended.");
+    os << "ssbc_runs_total{outcome=\"halted\"} " << s.halted << "\n";
+    os << "ssbc_runs_total{outcome=\"faulted\"} " << s.faulted << "\n";
+    os << "ssbc_runs_total{outcome=\"stopped\"} " << s.stopped << "\n";
+    writePrometheusHeader(os, "ssbc_port_bytes_total", "counter", "Bytes read from and written to the ports.");
+    os << "ssbc_port_bytes_total{direction=\"in\"} " << s.portBytesIn << "\n";
+    os << "ssbc_port_bytes_total{direction=\"out\"} " << s.portBytesOut << "\n";
+    writePrometheusHeader(os, "ssbc_max_stack_depth_bytes", "gauge", "The deepest any run's stack went below its reset value.");
+    os << "ssbc_max_stack_depth_bytes " << s.maxStackDepth << "\n";
+    writePrometheusHeader(os, "ssbc_mips", "gauge", "Millions of instructions a second, over every thread since the start.");
+    os << "ssbc_mips " << s.mips << "\n";
+    writePrometheusHeader(os, "ssbc_run_instructions", "histogram", "Instructions per finished run.");
+    long long cumulative = 0;
+    for(int b = 0; b <= RUN_BUCKETS; b++) {
+        cumulative += s.runBuckets[b];
+        os << "ssbc_run_instructions_bucket{le=\"" << runBucketBound(b) << "\"} " << cumulative << "\n";
+    }
+    os << "ssbc_run_instructions_sum " << s.runInstructions << "\n";
+    os << "ssbc_run_instructions_count " << s.runs << "\n";
+}
+
+// writes the stats as json, or prometheus text for a .prom file, through a temporary file renamed
+// into place so a reader never sees half a dump
+// returns false after writing an error if not possible
+bool tryWriteStats(const std::string& fileName, const StatsSnapshot& snapshot) {
+    std::ostringstream os;
+    bool isPrometheus = fileName.size() >= 5 && fileName.compare(fileName.size() - 5, 5, ".prom") == 0;
+    if(isPrometheus) {
+        writeStatsPrometheus(os, snapshot);
+    } else {
+        writeStatsJson(os, snapshot);
+    }
+    std::string tempFileName = fileName + ".tmp";
+    std::ofstream file(tempFileName);
+    if(!file.is_open()) {
+        std::cerr << "Error: could not open " << tempFileName << std::endl;
+        return false;
+    }
+    file << os.str();
+    file.close();
+    if(!file || std::rename(tempFileName.c_str(), fileName.c_str()) != 0) {
+        std::cerr << "Error: could not write " << fileName << std::endl;
+        return false;
+    }
+    return true;
+}
+
+// set by SIGUSR1, for the dumper to notice
+volatile std::sig_atomic_t statsDumpRequested = 0;
+
+extern "C" void requestStatsDump(int) {
+    statsDumpRequested = 1;
+}
+
+// writes the registry's stats to a file every interval (if positive), on SIGUSR1, and once stopped
+class StatsDumper {
+    public:
+    StatsDumper(StatsRegistry& _registry, const std::string& _fileName, double _intervalSeconds) :
+        registry(_registry), fileName(_fileName), intervalSeconds(_intervalSeconds) {
+#ifdef SIGUSR1
+        std::signal(SIGUSR1, requestStatsDump);
+#endif
+        thread = std::thread(&StatsDumper::loop, this);
+    }
+
+    // writes the last dump, returning false if it couldn't be written
+    bool stop() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            isStopped = true;
+        }
+        wake.notify_one();
+        thread.join();
+        return tryWriteStats(fileName, registry.read());
+    }
+
+    private:
+    StatsRegistry& registry;
+    std::string fileName;
+    double intervalSeconds;
+    std::thread thread;
+    std::mutex mutex;
+    std::condition_variable wake;
+    bool isStopped = false;
+
+    // wakes often enough to notice a signal soon after it arrives
+    void loop() {
+        auto poll = std::chrono::milliseconds(100);
+        auto nextDump = std::chrono::steady_clock::now() + std::chrono::duration<double>(intervalSeconds);
+        std::unique_lock<std::mutex> lock(mutex);
+        while(!wake.wait_for(lock, poll, [this] { return isStopped; })) {
+            bool isDue = intervalSeconds > 0 && std::chrono::steady_clock::now() >= nextDump;
+            if(statsDumpRequested || isDue) {
+                statsDumpRequested = 0;
+                tryWriteStats(fileName, registry.read());
+                if(isDue) {
+                    nextDump += std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(intervalSeconds));
+                }
+            }
+        }
+    }
+};
+
+#endif // STATS_H
@@ -0,0 +1,61 @@
+/*
+    mines peephole rules for the assembler's optimizer (assem2mac --optimize --rules file), see
+    superopt.h
+*/
+
+#include <string>
+#include <iostream>
+#include <fstream>
+#include <iomanip>
+#include <chrono>
+#include "superopt.h"
+
+int main(int argc, char** argv) {
+    SuperoptOptions options;
+    options.threads = std::max(1u, std::thread::hardware_concurrency());
+    std::string value;
+    if(tryParseArg(argc, argv, "-n", value)) {
+        options.maxLength = std::atoi(value.c_str());
+    }
+    if(tryParseArg(argc, argv, "-j", value)) {
+        options.threads = std::atoi(value.c_str());
+    }
+    if(tryParseArg(argc, argv, "--max-inputs", value)) {
+        options.maxInputs = std::atoi(value.c_str());
+    }
+    if(tryParseArg(argc, argv, "--seed", value)) {
+        options.seed = std::atoll(value.c_str());
+    }
+    std::string outFileName;
+    if(!tryParseArg(argc, argv, "-o", outFileName) || options.maxLength < 1 || options.maxLength > MAX_SEQUENCE
+        || options.threads < 1 || options.maxInputs < 1 || options.maxInputs > 4) {
+        std::cerr << "Usage: " << argv[0] << " -o rulesfile [-n length (1-" << MAX_SEQUENCE << ")] [-j threads] [--max-inputs n (1-4)] [--seed n]" << std::endl;
+        return 1;
+    }
+    std::ofstream outFile(outFileName);
+    if(!outFile.is_open()) {
+        std::cerr << "Error: could not open " << outFileName << std::endl;
+        return 1;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    Superoptimizer superopt(options);
+    superopt.run();
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    outFile << "# peephole rules mined by superopt -n " << options.maxLength << " --max-inputs " << options.maxInputs << "\n";
+    outFile << "# each replacement leaves the same stack, memory and flags (unless 'when flags dead') as its pattern,\n";
+    outFile << "# checked for every value of the bytes either one uses\n";
+    for(const auto& mined : superopt.rules) {
+        std::string rule = ruleToString(mined.rule());
+        outFile << rule << std::string(std::max(1, 64 - (int)rule.size()), ' ') << "# cycles " << mined.lhs.cycles() << " -> " << mined.rhs.cycles()
+            << ", bytes " << mined.lhs.bytes() << " -> " << mined.rhs.bytes() << "\n";
+    }
+
+    const SuperoptStats& stats = superopt.stats;
+    std::cerr << stats.sequences << " sequences of up to " << options.maxLength << " instructions, " << stats.fingerprints << " fingerprints; "
+        << stats.candidates << " candidates checked (" << stats.rejected << " rejected, " << stats.tooManyInputs << " using more than "
+        << options.maxInputs << " input bytes); " << superopt.rules.size() << " rules, on " << options.threads << " threads ("
+        << stats.steals << " tasks stolen) in " << std::fixed << std::setprecision(1) << seconds << " s" << std::endl;
+    return 0;
+}
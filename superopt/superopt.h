@@ -0,0 +1,843 @@
+/*
+    a superoptimizer mining peephole rules for ssbc's straight-line code
+
+    every sequence of up to n instructions is enumerated over an alphabet of
+    - popinh, add, sub and nor
+    - pushimm of 0x00, 0x01, 0xFF, 0x80, or a parameter K1, K2 standing for any byte
+    - pushext and popext of a variable A, B standing for any address below the PSW
+    with parameters and variables named in the order they are first used, so that no two sequences
+    differ only in their names. noop, jnz, jnn and halt are left out: a noop is removed by the
+    optimizer anyway, and the others end the straight-line code a rule may rewrite
+    a sequence is run on a state of its own: the 4 bytes above SP, the bytes at A and B, the PSW and
+    the parameters. one which pops past those 4 bytes is dropped along with every sequence starting
+    with it (this is its stack effect: how deep it reads, and how far it moves SP). it leaves the
+    bytes from SP up to the 4th above SP as it found it, the bytes at A and B, and the PSW; R2 is
+    never read, so what it leaves there doesn't matter
+    sequences leaving the same on a set of random states (some with A and B the same address) share
+    a fingerprint, and a sequence is rewritten to a cheaper one of its fingerprint if they then
+    leave the same for every value of the bytes either one uses, A and B apart and A and B the same
+    a rule leaving other flags is kept as well, to be applied only where the flags are dead
+    only rules whose pattern holds no shorter pattern are kept, as the optimizer applies them
+    until nothing changes
+    the enumeration and the checks are spread over threads with work-stealing deques
+*/
+
+#ifndef SUPEROPT_H
+#define SUPEROPT_H
+
+#include <vector>
+#include <deque>
+#include <unordered_map>
+#include <unordered_set>
+#include <mutex>
+#include <thread>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <random>
+#include <cstdint>
+#include <cstring>
+#include "../assem2mac/assembler.h"
+
+// the longest sequence enumerated
+const int MAX_SEQUENCE = 8;
+// the bytes above SP a sequence may read
+const int STACK_INPUTS = 4;
+
+// the letters of the alphabet, 0 ending a sequence
+enum {
+    letter_end,
+    letter_popinh,
+    letter_add,
+    letter_sub,
+    letter_nor,
+    letter_push00,
+    letter_push01,
+    letter_pushFF,
+    letter_push80,
+    letter_pushK1,
+    letter_pushK2,
+    letter_pushextA,
+    letter_pushextB,
+    letter_popextA,
+    letter_popextB,
+    letter_count
+};
+
+// returns the instruction of a letter
+RuleInstruction letterInstruction(int letter) {
+    static const int ops[letter_count] = { op_noop, op_popinh, op_add, op_sub, op_nor, op_pushimm, op_pushimm, op_pushimm, op_pushimm,
+        op_pushimm, op_pushimm, op_pushext, op_pushext, op_popext, op_popext };
+    static const int bytes[4] = { 0x00, 0x01, 0xFF, 0x80 };
+    RuleInstruction ins;
+    ins.op = ops[letter];
+    if(letter >= letter_push00 && letter <= letter_push80) {
+        ins.operand = rule_byte;
+        ins.value = bytes[letter - letter_push00];
+    } else if(letter == letter_pushK1 || letter == letter_pushK2) {
+        ins.operand = rule_param;
+        ins.value = letter - letter_pushK1;
+    } else if(letter >= letter_pushextA) {
+        ins.operand = rule_variable;
+        ins.value = (letter - letter_pushextA) % 2;
+    }
+    return ins;
+}
+
+// the parameter (0 for K1, 1 for K2) or variable (0 for A, 1 for B) of a letter, or -1
+int letterParam(int letter) {
+    return letter == letter_pushK1 ? 0 : letter == letter_pushK2 ? 1 : -1;
+}
+int letterVariable(int letter) {
+    return letter >= letter_pushextA ? (letter - letter_pushextA) % 2 : -1;
+}
+
+class Sequence {
+    public:
+    int length = 0;
+    unsigned char letters[MAX_SEQUENCE] = {};
+
+    // packed 4 bits to a letter, so that a sequence can be hashed and compared at once
+    uint64_t key() const {
+        uint64_t result = 0;
+        for(int i = 0; i < length; i++) {
+            result |= (uint64_t)letters[i] << (4 * i);
+        }
+        return result;
+    }
+
+    int bytes() const {
+        int total = 0;
+        for(int i = 0; i < length; i++) {
+            total += opSize(letterInstruction(letters[i]).op);
+        }
+        return total;
+    }
+    int cycles() const {
+        int total = 0;
+        for(int i = 0; i < length; i++) {
+            total += opCycles(letterInstruction(letters[i]).op);
+        }
+        return total;
+    }
+
+    // the letters from first up to last (exclusive), with their parameters and variables renamed
+    // in the order they are first used
+    Sequence canonicalPart(int first, int last) const {
+        Sequence result;
+        int params[2] = { -1, -1 }, variables[2] = { -1, -1 };
+        int paramCount = 0, variableCount = 0;
+        for(int i = first; i < last; i++) {
+            int letter = letters[i];
+            int p = letterParam(letter), v = letterVariable(letter);
+            if(p >= 0) {
+                if(params[p] < 0) {
+                    params[p] = paramCount++;
+                }
+                letter = letter_pushK1 + params[p];
+            } else if(v >= 0) {
+                if(variables[v] < 0) {
+                    variables[v] = variableCount++;
+                }
+                letter = (letter < letter_popextA ? letter_pushextA : letter_popextA) + variables[v];
+            }
+            result.letters[result.length++] = letter;
+        }
+        return result;
+    }
+
+    std::vector<RuleInstruction> instructions() const {
+        std::vector<RuleInstruction> result;
+        for(int i = 0; i < length; i++) {
+            result.push_back(letterInstruction(letters[i]));
+        }
+        return result;
+    }
+};
+
+// what a sequence starts from
+class SeqInputs {
+    public:
+    // stack[0] is the byte at SP+4, stack[3] the byte at SP+1
+    unsigned char stack[STACK_INPUTS];
+    unsigned char memory[2];
+    unsigned char psw;
+    unsigned char params[2];
+};
+
+// what a sequence leaves: the stack up to the 4th byte above SP as it started, A, B and the PSW
+class SeqState {
+    public:
+    unsigned char stack[STACK_INPUTS + MAX_SEQUENCE];
+    int top = STACK_INPUTS;
+    unsigned char memory[2];
+    unsigned char psw;
+
+    bool equals(const SeqState& other, bool isFlagsKept) const {
+        if(top != other.top || memory[0] != other.memory[0] || memory[1] != other.memory[1] || (isFlagsKept && psw != other.psw)) {
+            return false;
+        }
+        for(int i = 0; i < top; i++) {
+            if(stack[i] != other.stack[i]) {
+                return false;
+            }
+        }
+        return true;
+    }
+};
+
+// runs one letter, with A and B the same address if isAliased
+// returns false if it pops past the inputs
+bool runLetter(int letter, const SeqInputs& in, bool isAliased, SeqState& s) {
+    int v = letterVariable(letter);
+    int cell = isAliased ? 0 : v;
+    switch(letter) {
+        case letter_popinh: {
+            if(s.top < 1) {
+                return false;
+            }
+            s.top--;
+            return true;
+        }
+        case letter_add:
+        case letter_sub:
+        case letter_nor: {
+            if(s.top < 2) {
+                return false;
+            }
+            int s1 = s.stack[s.top - 1], s2 = s.stack[s.top - 2];
+            int result = letter == letter_add ? s1 + s2 : letter == letter_sub ? s1 - s2 : ~(s1 | s2);
+            result &= 0xFF;
+            s.stack[s.top - 2] = result;
+            s.top--;
+            if(letter != letter_nor) {
+                s.psw = (result == 0) << 7 | (result >> 7) << 6;
+            }
+            return true;
+        }
+        case letter_pushK1:
+        case letter_pushK2: {
+            s.stack[s.top++] = in.params[letterParam(letter)];
+            return true;
+        }
+        case letter_pushextA:
+        case letter_pushextB: {
+            s.stack[s.top++] = s.memory[cell];
+            return true;
+        }
+        case letter_popextA:
+        case letter_popextB: {
+            if(s.top < 1) {
+                return false;
+            }
+            s.memory[cell] = s.stack[--s.top];
+            return true;
+        }
+    }
+    s.stack[s.top++] = letterInstruction(letter).value;
+    return true;
+}
+
+// runs the sequence, returning false if it pops past the inputs
+bool runSequence(const Sequence& seq, const SeqInputs& in, bool isAliased, SeqState& out_state) {
+    std::copy(in.stack, in.stack + STACK_INPUTS, out_state.stack);
+    out_state.top = STACK_INPUTS;
+    out_state.memory[0] = in.memory[0];
+    out_state.memory[1] = isAliased ? in.memory[0] : in.memory[1];
+    out_state.psw = in.psw;
+    for(int i = 0; i < seq.length; i++) {
+        if(!runLetter(seq.letters[i], in, isAliased, out_state)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// the inputs a pair of sequences might depend on: the stack bytes either one pops to, the bytes
+// at the variables and the parameters either one names, and the PSW if either might change it
+class UsedInputs {
+    public:
+    std::vector<int> stack;
+    bool memory[2] = {};
+    bool psw = false;
+    bool params[2] = {};
+
+    void add(const Sequence& seq) {
+        int top = STACK_INPUTS, lowest = STACK_INPUTS;
+        for(int i = 0; i < seq.length; i++) {
+            int letter = seq.letters[i];
+            RuleInstruction ins = letterInstruction(letter);
+            top -= ins.op == op_popinh || ins.op == op_popext || ins.op == op_add || ins.op == op_sub || ins.op == op_nor ? 1 : 0;
+            lowest = std::min(lowest, ins.op == op_popinh || ins.op == op_popext ? top : top - 1);
+            top += ins.op == op_pushimm || ins.op == op_pushext ? 1 : 0;
+            if(letterVariable(letter) >= 0) {
+                memory[letterVariable(letter)] = true;
+            }
+            if(letterParam(letter) >= 0) {
+                params[letterParam(letter)] = true;
+            }
+            psw = psw || ins.op == op_add || ins.op == op_sub;
+        }
+        for(int i = std::max(lowest, 0); i < STACK_INPUTS; i++) {
+            if(std::find(stack.begin(), stack.end(), i) == stack.end()) {
+                stack.push_back(i);
+            }
+        }
+    }
+
+    int count(bool isAliased, bool isFlagsKept) const {
+        return stack.size() + memory[0] + (memory[1] && !isAliased) + (psw && isFlagsKept) + params[0] + params[1];
+    }
+};
+
+// the values of one input byte tried at once, each in a lane of its own
+const int LANES = 256;
+
+// the inputs and state of a sequence run in lanes, a row of bytes for each byte of SeqInputs and SeqState
+class LaneInputs {
+    public:
+    unsigned char stack[STACK_INPUTS][LANES];
+    unsigned char memory[2][LANES];
+    unsigned char psw[LANES];
+    unsigned char params[2][LANES];
+};
+
+class LaneState {
+    public:
+    unsigned char stack[STACK_INPUTS + MAX_SEQUENCE][LANES];
+    int top = STACK_INPUTS;
+    unsigned char memory[2][LANES];
+    unsigned char psw[LANES];
+
+    bool equals(const LaneState& other, bool isFlagsKept) const {
+        return top == other.top && std::memcmp(stack, other.stack, top * LANES) == 0 && std::memcmp(memory, other.memory, sizeof(memory)) == 0
+            && (!isFlagsKept || std::memcmp(psw, other.psw, LANES) == 0);
+    }
+};
+
+// runs a sequence, which must not pop past the inputs, in every lane at once
+void runLanes(const Sequence& seq, const LaneInputs& in, bool isAliased, LaneState& s) {
+    std::memcpy(s.stack, in.stack, sizeof(in.stack));
+    s.top = STACK_INPUTS;
+    std::memcpy(s.memory[0], in.memory[0], LANES);
+    std::memcpy(s.memory[1], in.memory[isAliased ? 0 : 1], LANES);
+    std::memcpy(s.psw, in.psw, LANES);
+    for(int i = 0; i < seq.length; i++) {
+        int letter = seq.letters[i];
+        int cell = isAliased ? 0 : letterVariable(letter);
+        unsigned char* top = s.stack[s.top];
+        unsigned char* s1 = s.stack[s.top - 1];
+        unsigned char* s2 = s.stack[s.top - 2];
+        switch(letter) {
+            case letter_popinh: {
+                s.top--;
+                break;
+            }
+            case letter_add:
+            case letter_sub: {
+                for(int lane = 0; lane < LANES; lane++) {
+                    unsigned char result = letter == letter_add ? s1[lane] + s2[lane] : s1[lane] - s2[lane];
+                    s2[lane] = result;
+                    s.psw[lane] = (result == 0) << 7 | (result >> 7) << 6;
+                }
+                s.top--;
+                break;
+            }
+            case letter_nor: {
+                for(int lane = 0; lane < LANES; lane++) {
+                    s2[lane] = ~(s1[lane] | s2[lane]);
+                }
+                s.top--;
+                break;
+            }
+            case letter_pushK1:
+            case letter_pushK2: {
+                std::memcpy(top, in.params[letterParam(letter)], LANES);
+                s.top++;
+                break;
+            }
+            case letter_pushextA:
+            case letter_pushextB: {
+                std::memcpy(top, s.memory[cell], LANES);
+                s.top++;
+                break;
+            }
+            case letter_popextA:
+            case letter_popextB: {
+                std::memcpy(s.memory[cell], s1, LANES);
+                s.top--;
+                break;
+            }
+            default: {
+                std::memset(top, letterInstruction(letter).value, LANES);
+                s.top++;
+            }
+        }
+    }
+}
+
+// returns true if the sequences leave the same for every value of the bytes they use, with A and
+// B apart and, if both are used, the same
+// the first of those bytes takes all its values at once, across the lanes
+bool isEquivalent(const Sequence& a, const Sequence& b, bool isFlagsKept, const UsedInputs& used) {
+    LaneInputs in = {};
+    LaneState sa, sb;
+    for(int aliased = 0; aliased <= (used.memory[0] && used.memory[1] ? 1 : 0); aliased++) {
+        // the rows of the bytes to try every value of
+        std::vector<unsigned char*> rows;
+        for(int i : used.stack) {
+            rows.push_back(in.stack[i]);
+        }
+        if(used.memory[0]) {
+            rows.push_back(in.memory[0]);
+        }
+        if(used.memory[1] && !aliased) {
+            rows.push_back(in.memory[1]);
+        }
+        if(used.psw && isFlagsKept) {
+            rows.push_back(in.psw);
+        }
+        for(int p = 0; p < 2; p++) {
+            if(used.params[p]) {
+                rows.push_back(in.params[p]);
+            }
+        }
+        uint64_t combinations = 1;
+        if(!rows.empty()) {
+            for(int lane = 0; lane < LANES; lane++) {
+                rows[0][lane] = lane;
+            }
+            combinations = 1ull << (8 * (rows.size() - 1));
+        }
+        for(uint64_t c = 0; c < combinations; c++) {
+            for(int i = 1; i < rows.size(); i++) {
+                std::memset(rows[i], (c >> (8 * (i - 1))) & 0xFF, LANES);
+            }
+            runLanes(a, in, aliased, sa);
+            runLanes(b, in, aliased, sb);
+            if(!sa.equals(sb, isFlagsKept)) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+// runs tasks on a number of threads, each taking from the back of its own deque and, when that is
+// empty, stealing from the front of another's, so the big tasks queued first are the ones stolen
+// a task may queue more tasks on its own thread
+template<typename Task>
+class WorkStealingPool {
+    public:
+    // the tasks taken from another thread
+    std::atomic<long long> steals{0};
+
+    WorkStealingPool(int _threadCount) {
+        for(int i = 0; i < std::max(1, _threadCount); i++) {
+            queues.push_back(std::make_unique<Queue>());
+        }
+    }
+
+    // runs the tasks, dealt round the threads, until they and every task they queue are done
+    void run(const std::vector<Task>& tasks, const std::function<void(const Task&, int)>& work) {
+        for(int i = 0; i < tasks.size(); i++) {
+            push(i % queues.size(), tasks[i]);
+        }
+        std::vector<std::thread> threads;
+        for(int t = 0; t < queues.size(); t++) {
+            threads.push_back(std::thread([this, t, &work]() {
+                Task task;
+                while(pending > 0) {
+                    if(!tryPop(t, task)) {
+                        std::this_thread::yield();
+                        continue;
+                    }
+                    work(task, t);
+                    pending--;
+                }
+            }));
+        }
+        for(auto& thread : threads) {
+            thread.join();
+        }
+    }
+
+    // queues a task on a thread
+    void push(int thread, const Task& task) {
+        pending++;
+        std::lock_guard<std::mutex> lock(queues[thread]->mutex);
+        queues[thread]->tasks.push_back(task);
+    }
+
+    int threadCount() const {
+        return queues.size();
+    }
+
+    private:
+    class Queue {
+        public:
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+    std::vector<std::unique_ptr<Queue>> queues;
+    // the tasks queued and not yet done
+    std::atomic<long long> pending{0};
+
+    bool tryPop(int thread, Task& out_task) {
+        for(int i = 0; i < queues.size(); i++) {
+            Queue& queue = *queues[(thread + i) % queues.size()];
+            std::lock_guard<std::mutex> lock(queue.mutex);
+            if(queue.tasks.empty()) {
+                continue;
+            }
+            if(i == 0) {
+                out_task = queue.tasks.back();
+                queue.tasks.pop_back();
+            } else {
+                out_task = queue.tasks.front();
+                queue.tasks.pop_front();
+                steals++;
+            }
+            return true;
+        }
+        return false;
+    }
+};
+
+// a mined rule, with what it saves
+class MinedRule {
+    public:
+    Sequence lhs;
+    Sequence rhs;
+    bool isFlagsDead = false;
+
+    RewriteRule rule() const {
+        RewriteRule result;
+        result.lhs = lhs.instructions();
+        result.rhs = rhs.instructions();
+        result.isFlagsDead = isFlagsDead;
+        return result;
+    }
+};
+
+class SuperoptOptions {
+    public:
+    int maxLength = 4;
+    int threads = 1;
+    // the random states a fingerprint is taken on
+    int tests = 16;
+    // the most bytes a rule may depend on, as each one multiplies its check by 256
+    int maxInputs = 3;
+    uint64_t seed = 1;
+};
+
+class SuperoptStats {
+    public:
+    long long sequences = 0;
+    long long fingerprints = 0;
+    long long candidates = 0;
+    long long rejected = 0;
+    long long tooManyInputs = 0;
+    long long steals = 0;
+};
+
+class Superoptimizer {
+    public:
+    SuperoptOptions options;
+    SuperoptStats stats;
+    std::vector<MinedRule> rules;
+
+    Superoptimizer(const SuperoptOptions& _options) : options(_options) {
+        std::mt19937_64 random(options.seed);
+        for(int t = 0; t < options.tests; t++) {
+            SeqInputs in;
+            for(int i = 0; i < STACK_INPUTS; i++) {
+                in.stack[i] = random();
+            }
+            in.memory[0] = random();
+            in.memory[1] = random();
+            in.psw = random();
+            in.params[0] = random();
+            in.params[1] = random();
+            tests.push_back(in);
+        }
+    }
+
+    // mines the rules for every sequence up to the longest, shortest first
+    void run() {
+        // the cheapest sequences of each fingerprint, from every sequence up to the longest
+        forEachSequence(options.maxLength, false, [this](const Sequence& seq, int thread) {
+            uint64_t withFlags, withoutFlags;
+            fingerprint(seq, withFlags, withoutFlags);
+            local[thread].sequences++;
+            local[thread].kept[withFlags].offer(seq);
+            local[thread].cleared[withoutFlags].offer(seq);
+        });
+        for(auto& part : local) {
+            stats.sequences += part.sequences;
+            merge(part.kept, kept);
+            merge(part.cleared, cleared);
+        }
+        stats.fingerprints = kept.size();
+        local.clear();
+
+        // then the rules, a length at a time, so each one's shorter patterns are known
+        for(int length = 1; length <= options.maxLength; length++) {
+            forEachSequence(length, true, [this](const Sequence& seq, int thread) {
+                mine(seq, local[thread]);
+            });
+            for(auto& part : local) {
+                rules.insert(rules.end(), part.rules.begin(), part.rules.end());
+                reducibleKept.insert(part.reducibleKept.begin(), part.reducibleKept.end());
+                reducibleCleared.insert(part.reducibleCleared.begin(), part.reducibleCleared.end());
+                stats.candidates += part.candidates;
+                stats.rejected += part.rejected;
+                stats.tooManyInputs += part.tooManyInputs;
+            }
+            local.clear();
+        }
+        // the same order each time, however the threads ran
+        std::sort(rules.begin(), rules.end(), [](const MinedRule& a, const MinedRule& b) {
+            if(a.lhs.length != b.lhs.length) {
+                return a.lhs.length < b.lhs.length;
+            }
+            if(a.lhs.key() != b.lhs.key()) {
+                return a.lhs.key() < b.lhs.key();
+            }
+            return a.isFlagsDead < b.isFlagsDead;
+        });
+    }
+
+    private:
+    // the cheapest few sequences sharing a fingerprint, in case one turns out not to be the same
+    class Bucket {
+        public:
+        static const int SIZE = 4;
+        std::vector<Sequence> cheapest;
+
+        void offer(const Sequence& seq) {
+            cheapest.push_back(seq);
+            std::sort(cheapest.begin(), cheapest.end(), [](const Sequence& a, const Sequence& b) {
+                if(a.cycles() != b.cycles()) {
+                    return a.cycles() < b.cycles();
+                }
+                if(a.bytes() != b.bytes()) {
+                    return a.bytes() < b.bytes();
+                }
+                return a.key() < b.key();
+            });
+            if(cheapest.size() > SIZE) {
+                cheapest.pop_back();
+            }
+        }
+    };
+    typedef std::unordered_map<uint64_t, Bucket> BucketMap;
+
+    // what one thread finds, merged once they are all done
+    class ThreadPart {
+        public:
+        long long sequences = 0;
+        BucketMap kept;
+        BucketMap cleared;
+        std::vector<MinedRule> rules;
+        std::unordered_set<uint64_t> reducibleKept;
+        std::unordered_set<uint64_t> reducibleCleared;
+        long long candidates = 0;
+        long long rejected = 0;
+        long long tooManyInputs = 0;
+    };
+
+    // a prefix to enumerate the sequences from, with the parameters and variables it has named
+    class Prefix {
+        public:
+        Sequence seq;
+        int params = 0;
+        int variables = 0;
+        int top = STACK_INPUTS;
+    };
+
+    std::vector<SeqInputs> tests;
+    BucketMap kept;
+    BucketMap cleared;
+    std::unordered_set<uint64_t> reducibleKept;
+    std::unordered_set<uint64_t> reducibleCleared;
+    std::vector<ThreadPart> local;
+
+    static void merge(BucketMap& from, BucketMap& to) {
+        for(auto& entry : from) {
+            Bucket& bucket = to[entry.first];
+            for(const auto& seq : entry.second.cheapest) {
+                bucket.offer(seq);
+            }
+        }
+        from.clear();
+    }
+
+    // calls visit for each sequence up to maxLength letters (or of exactly that many), on the pool's
+    // threads: the prefixes of 2 letters are queued, and one with far to go queues its extensions
+    // by another letter rather than enumerating them itself, for idle threads to steal
+    void forEachSequence(int maxLength, bool isExact, const std::function<void(const Sequence&, int)>& visit) {
+        WorkStealingPool<Prefix> pool(options.threads);
+        local.assign(pool.threadCount(), ThreadPart());
+        std::vector<Prefix> roots(1);
+        std::function<void(const Prefix&, int)> work = [&](const Prefix& prefix, int thread) {
+            if(maxLength - prefix.seq.length > 3) {
+                if(!isExact || prefix.seq.length == maxLength) {
+                    visit(prefix.seq, thread);
+                }
+                forEachExtension(prefix, [&](const Prefix& next) {
+                    pool.push(thread, next);
+                });
+                return;
+            }
+            enumerate(prefix, maxLength, isExact, thread, visit);
+        };
+        pool.run(roots, work);
+        stats.steals += pool.steals;
+    }
+
+    // calls extend for each prefix one letter longer which is canonical and doesn't pop past the inputs
+    static void forEachExtension(const Prefix& prefix, const std::function<void(const Prefix&)>& extend) {
+        for(int letter = letter_popinh; letter < letter_count; letter++) {
+            Prefix next = prefix;
+            int p = letterParam(letter), v = letterVariable(letter);
+            if((p >= 0 && p > prefix.params) || (v >= 0 && v > prefix.variables)) {
+                continue;
+            }
+            next.params = std::max(prefix.params, p + 1);
+            next.variables = std::max(prefix.variables, v + 1);
+            int op = letterInstruction(letter).op;
+            next.top -= op == op_popinh || op == op_popext ? 1 : op == op_add || op == op_sub || op == op_nor ? 2 : 0;
+            if(next.top < 0) {
+                continue;
+            }
+            next.top += op == op_add || op == op_sub || op == op_nor || op == op_pushimm || op == op_pushext ? 1 : 0;
+            next.seq.letters[next.seq.length++] = letter;
+            extend(next);
+        }
+    }
+
+    static void enumerate(const Prefix& prefix, int maxLength, bool isExact, int thread, const std::function<void(const Sequence&, int)>& visit) {
+        if(!isExact || prefix.seq.length == maxLength) {
+            visit(prefix.seq, thread);
+        }
+        if(prefix.seq.length == maxLength) {
+            return;
+        }
+        forEachExtension(prefix, [&](const Prefix& next) {
+            enumerate(next, maxLength, isExact, thread, visit);
+        });
+    }
+
+    // hashes what the sequence leaves on each test, with and without the PSW
+    void fingerprint(const Sequence& seq, uint64_t& out_withFlags, uint64_t& out_withoutFlags) const {
+        uint64_t with = 14695981039346656037ull, without = with;
+        auto mix = [](uint64_t& hash, uint64_t value) {
+            hash = (hash ^ value) * 1099511628211ull;
+        };
+        SeqState state;
+        for(int t = 0; t < tests.size(); t++) {
+            // every fourth test has A and B the same
+            runSequence(seq, tests[t], t % 4 == 3, state);
+            mix(without, state.top);
+            for(int i = 0; i < state.top; i++) {
+                mix(without, state.stack[i]);
+            }
+            mix(without, state.memory[0]);
+            mix(without, state.memory[1]);
+            mix(with, without);
+            mix(with, state.psw);
+        }
+        out_withFlags = with;
+        out_withoutFlags = without;
+    }
+
+    // returns true if a is cheaper than b: fewer cycles and no more bytes, or fewer bytes and no
+    // more cycles, in no more instructions
+    static bool isCheaper(const Sequence& a, const Sequence& b) {
+        int ac = a.cycles(), bc = b.cycles(), ab = a.bytes(), bb = b.bytes();
+        return a.length <= b.length && ((ac < bc && ab <= bb) || (ab < bb && ac <= bc));
+    }
+
+    // returns true if the pattern only names what the sequence names
+    static bool bindsAll(const Sequence& pattern, const Sequence& replacement) {
+        UsedInputs a, b;
+        a.add(pattern);
+        b.add(replacement);
+        for(int i = 0; i < 2; i++) {
+            if((b.memory[i] && !a.memory[i]) || (b.params[i] && !a.params[i])) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // finds the cheapest replacement of the sequence, keeping the flags and then not, if no
+    // shorter part of it has one
+    void mine(const Sequence& seq, ThreadPart& part) {
+        bool hasKept = false, hasCleared = false;
+        for(int first = 0; first < seq.length; first++) {
+            for(int last = first + 1; last <= seq.length; last++) {
+                if(last - first == seq.length) {
+                    continue;
+                }
+                uint64_t key = seq.canonicalPart(first, last).key();
+                hasKept = hasKept || reducibleKept.count(key) != 0;
+                hasCleared = hasCleared || reducibleCleared.count(key) != 0;
+            }
+        }
+        if(hasKept) {
+            return;
+        }
+        uint64_t withFlags, withoutFlags;
+        fingerprint(seq, withFlags, withoutFlags);
+        const Sequence* best = tryFind(seq, seq, kept.at(withFlags), true, part);
+        if(best != nullptr) {
+            part.rules.push_back({ seq, *best, false });
+            part.reducibleKept.insert(seq.key());
+            part.reducibleCleared.insert(seq.key());
+        }
+        if(hasCleared) {
+            return;
+        }
+        // clearing the flags is only worth it for something cheaper still
+        const Sequence* clearing = tryFind(seq, best != nullptr ? *best : seq, cleared.at(withoutFlags), false, part);
+        if(clearing != nullptr) {
+            part.rules.push_back({ seq, *clearing, true });
+            part.reducibleCleared.insert(seq.key());
+        }
+    }
+
+    // returns the cheapest sequence of the bucket which is cheaper than cost and does the same as
+    // seq, or nullptr
+    const Sequence* tryFind(const Sequence& seq, const Sequence& cost, const Bucket& bucket, bool isFlagsKept, ThreadPart& part) {
+        for(const auto& candidate : bucket.cheapest) {
+            if(isCheaper(candidate, cost) && tryVerify(seq, candidate, isFlagsKept, part)) {
+                return &candidate;
+            }
+        }
+        return nullptr;
+    }
+
+    bool tryVerify(const Sequence& seq, const Sequence& candidate, bool isFlagsKept, ThreadPart& part) {
+        part.candidates++;
+        if(!bindsAll(seq, candidate)) {
+            part.rejected++;
+            return false;
+        }
+        UsedInputs used;
+        used.add(seq);
+        used.add(candidate);
+        if(used.count(false, isFlagsKept) > options.maxInputs) {
+            part.tooManyInputs++;
+            return false;
+        }
+        if(!isEquivalent(seq, candidate, isFlagsKept, used)) {
+            part.rejected++;
+            return false;
+        }
+        return true;
+    }
+};
+
+#endif // SUPEROPT_H
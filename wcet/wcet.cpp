@@ -0,0 +1,89 @@
+/*
+    static best and worst case execution times of the routines of an assembled program, see wcet.h
+    usage: wcet.exe -i program.bin --map program.map [--bounds file] [--source program.s] [--routine label]
+    the image is a raw binary or intel hex (.hex, .ihex), and the map is written by assem2mac --map
+    exits with 2 if a routine timed is unbounded
+*/
+
+#include <string>
+#include <iostream>
+#include <fstream>
+#include <iterator>
+#include "wcet.h"
+
+// returns true if the string ends with the suffix
+bool endsWith(const std::string& input, const std::string& suffix) {
+    return input.size() >= suffix.size() && input.compare(input.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+int main(int argc, char** argv) {
+    std::string inFileName, mapFileName;
+    if(!tryParseArg(argc, argv, "-i", inFileName) || !tryParseArg(argc, argv, "--map", mapFileName)) {
+        std::cerr << "Usage: " << argv[0] << " -i program.bin --map program.map [--bounds file] [--source program.s] [--routine label]" << std::endl;
+        return 1;
+    }
+
+    MappedProgram program;
+    std::ifstream inFile(inFileName, std::ios::binary);
+    if(!inFile.is_open()) {
+        std::cerr << "Error: could not open " << inFileName << std::endl;
+        return 1;
+    }
+    if(endsWith(inFileName, ".hex") || endsWith(inFileName, ".ihex")) {
+        if(!tryReadIntelHex(inFile, program.image)) {
+            std::cerr << "Error: malformed intel hex in " << inFileName << std::endl;
+            return 1;
+        }
+    } else {
+        program.image.assign(std::istreambuf_iterator<char>(inFile), std::istreambuf_iterator<char>());
+    }
+    if(program.image.size() > IMAGE_SIZE) {
+        std::cerr << "Error: " << inFileName << " is " << program.image.size() << " bytes, which does not fit in memory" << std::endl;
+        return 1;
+    }
+    std::ifstream mapFile(mapFileName);
+    if(!mapFile.is_open()) {
+        std::cerr << "Error: could not open " << mapFileName << std::endl;
+        return 1;
+    }
+    if(!tryReadSymbolMap(mapFile, program, std::cerr)) {
+        return 1;
+    }
+
+    std::map<int, LoopBound> bounds;
+    std::string fileName;
+    if(tryParseArg(argc, argv, "--source", fileName)) {
+        std::ifstream source(fileName);
+        if(!source.is_open()) {
+            std::cerr << "Error: could not open " << fileName << std::endl;
+            return 1;
+        }
+        if(!tryReadSourceBounds(source, program, bounds, std::cerr)) {
+            return 1;
+        }
+    }
+    if(tryParseArg(argc, argv, "--bounds", fileName)) {
+        std::ifstream boundsFile(fileName);
+        if(!boundsFile.is_open()) {
+            std::cerr << "Error: could not open " << fileName << std::endl;
+            return 1;
+        }
+        if(!tryReadBounds(boundsFile, program, bounds, std::cerr)) {
+            return 1;
+        }
+    }
+
+    std::vector<RoutineTime> times;
+    std::string routine;
+    tryParseArg(argc, argv, "--routine", routine);
+    if(!tryAnalyzeRoutines(program, bounds, routine, times, std::cerr)) {
+        return 1;
+    }
+    writeRoutineTimes(std::cout, program, times);
+    for(const RoutineTime& time : times) {
+        if(!time.isBounded) {
+            return 2;
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,1140 @@
+/*
+    static best and worst case execution times of the routines of an assembled program
+
+    the program is read as its image and its symbol map (assem2mac --map), which tells its labels
+    and which bytes are instructions. the routines are the reset address, what is called and the
+    functions cpp2assem compiles (labelled f_), each timed from there to a halt or a return, in the
+    cycles of the RTN (opCycles)
+    the control flow graph is found by following the program from the routine, over states of
+    - the address of the instruction
+    - the two bytes on top of the stack, where known (pushed with pushimm, or worked out of them),
+      or their low bits: 'pushext a; pushext a; add; pushimm 1; add' is never zero
+    - the bytes of return jumps, the jnz/jnn instructions which a popext writes the operand of,
+      where written with a known byte: a call writes its return address into the callee's, and its
+      return goes there, or out of the routine if it isn't known
+    - the flags which may be set, as the set of the Z,N pairs possible: an add or sub leaves any but
+      both set, popext of a known byte to the PSW exactly those of the byte, and a jnz or jnn only
+      follows the edges some pair allows, and only with those pairs. so 'jnz X; jnn X' has no fall
+      through, and a return which is only reached with Z clear doesn't run into the data after it
+    a call (a jump right after a popext writing a return jump) is taken whole: the called routine is
+    timed once for the flags it is called with, from its own entry with no return jumps known, into
+    the ways it ends, each by a return jump with the return jump bytes it leaves known, and each way
+    then returns to the caller by what the caller's known bytes (less those the callee may write)
+    hold, so no routine is explored more than once however deep the calls go
+    loops are the natural loops of the graph's back edges, and need a bound: how many times the
+    loop's first instruction runs each time the loop is entered, as 'max' or 'min..max' (min being
+    1 if not given), from a bounds file of 'label bound' lines or an '@bound' in a comment of the
+    source on the line of the loop's label or first instruction (of the source file itself: the
+    lines of .include files and macros are known only as the line using them). loops are collapsed innermost
+    first, into the cost of leaving them by each way out: (bound - 1) iterations of the longest (or
+    shortest) way around, plus the longest (or shortest) way from the first instruction out. the
+    routine is then the longest (or shortest) path through what is left, which has no cycles
+    a loop without a bound, a loop entered other than at its first instruction, or running into
+    data leaves the routine unbounded, saying why
+*/
+
+#ifndef WCET_H
+#define WCET_H
+
+#include <vector>
+#include <map>
+#include <unordered_map>
+#include <set>
+#include <string>
+#include <sstream>
+#include <istream>
+#include <ostream>
+#include <climits>
+#include <algorithm>
+#include "../common.h"
+#include "../assem2mac/assembler.h"
+
+// an assembled program, as its image and symbol map
+class MappedProgram {
+    public:
+    std::vector<unsigned char> image;
+    std::map<std::string, int> labels;
+    // the size of the instruction at each address and its source line, or 0 where none starts
+    std::vector<int> sizes = std::vector<int>(IMAGE_SIZE);
+    std::vector<int> lines = std::vector<int>(IMAGE_SIZE);
+
+    // the labels of an address, separated by spaces
+    std::string labelsAt(int address) const {
+        std::string result;
+        for(const auto& label : labels) {
+            if(label.second == address) {
+                result += (result.empty() ? "" : " ") + label.first;
+            }
+        }
+        return result;
+    }
+
+    // an address, with its labels
+    std::string describe(int address) const {
+        std::string names = labelsAt(address);
+        return intToFourHex(address) + (names.empty() ? "" : " (#" + names + ")");
+    }
+};
+
+// reads the records of a symbol map written by writeSymbolMap into program
+// returns false after writing an error if not possible
+bool tryReadSymbolMap(std::istream& in, MappedProgram& program, std::ostream& err) {
+    std::string line;
+    for(int lineNumber = 1; std::getline(in, line); lineNumber++) {
+        std::istringstream fields(line);
+        std::string kind, name, address;
+        int size = 0, sourceLine = 0;
+        if(!(fields >> kind) || kind[0] == '#' || kind == "data") {
+            continue;
+        }
+        try {
+            if(kind == "sym" && fields >> name >> address) {
+                program.labels[name] = std::stoi(address, nullptr, 0);
+                continue;
+            } else if(kind == "ins" && fields >> address >> size >> sourceLine) {
+                int at = std::stoi(address, nullptr, 0);
+                if(at >= 0 && at < IMAGE_SIZE) {
+                    program.sizes[at] = size;
+                    program.lines[at] = sourceLine;
+                    continue;
+                }
+            }
+        } catch(...) {
+        }
+        err << "Error: line " << lineNumber << " of the symbol map is not a record: " << line << std::endl;
+        return false;
+    }
+    return true;
+}
+
+// how many times a loop's first instruction runs each time the loop is entered
+class LoopBound {
+    public:
+    long long min = 1;
+    long long max = 0;
+};
+
+// reads a bound, 'max' or 'min..max'
+// returns false if it isn't one
+bool tryParseBound(const std::string& text, LoopBound& out_bound) {
+    size_t dots = text.find("..");
+    try {
+        size_t end = 0;
+        std::string first = text.substr(0, dots);
+        long long min = dots == std::string::npos ? 1 : std::stoll(first, &end, 0);
+        if(dots != std::string::npos && end != first.size()) {
+            return false;
+        }
+        std::string last = dots == std::string::npos ? text : text.substr(dots + 2);
+        long long max = std::stoll(last, &end, 0);
+        if(end != last.size() || min < 1 || max < min) {
+            return false;
+        }
+        out_bound.min = min;
+        out_bound.max = max;
+        return true;
+    } catch(...) {
+        return false;
+    }
+}
+
+// reads the 'label bound' lines of a bounds file, '#' starting a comment, into bounds by address; a
+// loop without a label (in a macro, say) is named by its address, as 0x1234
+// returns false after writing an error if not possible
+bool tryReadBounds(std::istream& in, const MappedProgram& program, std::map<int, LoopBound>& bounds, std::ostream& err) {
+    std::string line;
+    for(int lineNumber = 1; std::getline(in, line); lineNumber++) {
+        std::istringstream fields(line.substr(0, line.find('#')));
+        std::string label, bound, extra;
+        if(!(fields >> label)) {
+            continue;
+        }
+        LoopBound loopBound;
+        if(!(fields >> bound) || fields >> extra || !tryParseBound(bound, loopBound)) {
+            err << "Error: line " << lineNumber << " of the bounds is not 'label max' or 'label min..max': " << line << std::endl;
+            return false;
+        }
+        auto it = program.labels.find(label);
+        int address = -1;
+        if(it != program.labels.end()) {
+            address = it->second;
+        } else if(label.compare(0, 2, "0x") == 0) {
+            try {
+                address = std::stoi(label, nullptr, 16);
+            } catch(...) {
+            }
+        }
+        if(address < 0 || address >= IMAGE_SIZE || program.sizes[address] == 0) {
+            err << "Error: line " << lineNumber << " of the bounds names no instruction of the program: " << label << std::endl;
+            return false;
+        }
+        bounds[address] = loopBound;
+    }
+    return true;
+}
+
+// reads the '@bound max' or '@bound min..max' of the source's comments into bounds, each for the
+// first instruction from its line on
+// returns false after writing an error if one can't be read
+bool tryReadSourceBounds(std::istream& source, const MappedProgram& program, std::map<int, LoopBound>& bounds, std::ostream& err) {
+    // the first instruction of each source line
+    std::map<int, int> firstOfLine;
+    for(int address = IMAGE_SIZE - 1; address >= 0; address--) {
+        if(program.sizes[address] > 0) {
+            firstOfLine[program.lines[address]] = address;
+        }
+    }
+    std::string line;
+    for(int lineNumber = 1; std::getline(source, line); lineNumber++) {
+        size_t at = line.find("@bound");
+        if(at == std::string::npos) {
+            continue;
+        }
+        std::istringstream fields(line.substr(at + 6));
+        std::string bound;
+        LoopBound loopBound;
+        if(!(fields >> bound) || !tryParseBound(bound, loopBound)) {
+            err << "Error on line [" << lineNumber << "]: expected '@bound max' or '@bound min..max': " << trim(line) << std::endl;
+            return false;
+        }
+        auto it = firstOfLine.lower_bound(lineNumber);
+        if(it != firstOfLine.end()) {
+            bounds[it->second] = loopBound;
+        }
+    }
+    return true;
+}
+
+// the ways a routine ends
+enum {
+    end_halt = 1,
+    end_return = 2,
+    end_fault = 4
+};
+
+// the time of a routine, from its entry to its end
+class RoutineTime {
+    public:
+    int address = 0;
+    bool isBounded = false;
+    long long best = 0;
+    long long worst = 0;
+    // the ways it may end, and why it is unbounded if it is
+    int ends = 0;
+    std::string problem;
+    // the states of its graph
+    int states = 0;
+};
+
+// a way a called routine ends, from its entry: by a halt or fault, or by the return jump at slot
+// (-1 for none), with the return jump bytes known there and the flags it returns with
+class CallWay {
+    public:
+    int slot = -1;
+    int ends = 0;
+    std::map<int, int> context;
+    int flags = 0;
+    long long best = 0;
+    long long worst = 0;
+};
+
+// what calling a routine does, found once for its entry and the flags it is called with: the ways
+// it ends, and the return jump bytes it (or what it calls) may write
+class CallSummary {
+    public:
+    bool isBounded = false;
+    // what a caller says of it if it is unbounded
+    std::string problem;
+    std::vector<CallWay> ways;
+    std::set<int> written;
+};
+
+// the most states a routine's graph may have
+const int MAX_STATES = 1 << 20;
+
+// the bytes on top of the stack as the graph knows them: 0-255 exactly, or else whether the byte is
+// even or odd, or that it was read from address VALUE_READ + a of the program and a hasn't been
+// written since (so that a + a is even, and a + a + 1 not zero)
+const int VALUE_UNKNOWN = -1;
+const int VALUE_EVEN = -2;
+const int VALUE_ODD = -3;
+const int VALUE_READ = 0x100;
+
+bool isKnownValue(int value) {
+    return value >= 0 && value < VALUE_READ;
+}
+
+// the low bit of a value, or -1 if not known
+int parityOf(int value) {
+    return isKnownValue(value) ? value & 1 : value == VALUE_EVEN ? 0 : value == VALUE_ODD ? 1 : -1;
+}
+
+// the pairs of Z,N flags, as bits 1 << (Z*2 + N)
+const int FLAGS_ANY = 0xF;
+const int FLAGS_ARITH = 0x7;
+const int FLAGS_Z_CLEAR = 0x3;
+const int FLAGS_N_CLEAR = 0x5;
+
+// the control flow graph of a routine, from its entry to its ends, over the states of the program
+class ProgramGraph {
+    public:
+    ProgramGraph(const MappedProgram& _program) : program(_program) {
+        // the operands of jumps written by a popext
+        std::set<int> written;
+        for(int address = 0; address < (int)program.image.size(); address++) {
+            if(program.sizes[address] == 3 && (program.image[address] & 0xF) == op_popext) {
+                written.insert(ext(address));
+            }
+        }
+        for(int address = 0; address < (int)program.image.size(); address++) {
+            int op = program.image[address] & 0xF;
+            if(program.sizes[address] == 3 && (op == op_jnz || op == op_jnn) && (written.count(address + 1) || written.count(address + 2))) {
+                isReturnOperand[address + 1] = isReturnOperand[address + 2] = true;
+            }
+        }
+        // the calls: jumps right after a popext writing a return jump, or after such a jump to the
+        // same place, as in 'jnz f; jnn f'
+        int last = -1;
+        for(int address = 0; address < (int)program.image.size(); address++) {
+            if(program.sizes[address] == 0) {
+                continue;
+            }
+            int op = program.image[address] & 0xF;
+            if(program.sizes[address] == 3 && (op == op_jnz || op == op_jnn) && !isReturnOperand[address + 1]
+                && last >= 0 && last + program.sizes[last] == address) {
+                isCallJump[address] = ((program.image[last] & 0xF) == op_popext && isReturnOperand[ext(last)])
+                    || (isCallJump[last] && ext(last) == ext(address));
+            }
+            last = address;
+        }
+    }
+
+    // the addresses called
+    std::set<int> calledRoutines() const {
+        std::set<int> result;
+        for(int address = 0; address < (int)program.image.size(); address++) {
+            if(isCallJump[address]) {
+                result.insert(ext(address));
+            }
+        }
+        return result;
+    }
+
+    // whether the instruction at address is a return jump, with a written operand
+    bool isReturn(int address) const {
+        return isReturnOperand[address + 1];
+    }
+
+    // whether the byte at address is the operand of a return jump
+    bool isReturnOperandAt(int address) const {
+        return isReturnOperand[address];
+    }
+
+    // finds the graph of the routine starting at entry with the flags
+    // returns false after setting problem if not possible
+    bool tryBuild(int entry, int flags = FLAGS_ARITH) {
+        nodes.clear();
+        ids.clear();
+        contexts.clear();
+        contextIds.clear();
+        calls.clear();
+        callIds.clear();
+        problem.clear();
+        isCallProblem = false;
+        nodeFor(State{ entry, -1, -1, contextFor(std::map<int, int>()) }, flags);
+        return explore();
+    }
+
+    // a state of the program: the address of the instruction, the bytes on top of the stack (-1
+    // if not known) and the known bytes of return jumps, or for a call taken whole the routine called
+    // and the way it ends (call)
+    // a node is a state by its address and return jumps, with the bytes on top of the stack known
+    // only where they are the same by every way in, so that a loop is one loop however its values
+    // start out
+    class State {
+        public:
+        int pc;
+        int s1;
+        int s2;
+        int context;
+        int call = -1;
+
+        long long key() const {
+            return ((long long)(call + 1) << 40) | ((long long)context << 16) | pc;
+        }
+    };
+
+    // a state in the graph, with the flags it may be reached with, the cycles of its instruction (or
+    // the best and worst of a call), and where it goes
+    class Node {
+        public:
+        State state;
+        int flags = 0;
+        long long cycles = 0;
+        long long bestCycles = 0;
+        std::vector<int> successors;
+        int ends = 0;
+    };
+
+    const MappedProgram& program;
+    std::vector<Node> nodes;
+    // why the graph, or the analysis of it, couldn't be finished, and whether that was a call's
+    std::string problem;
+    bool isCallProblem = false;
+
+    // the return jump by which a node leaves the routine (the address of the jump), with the return
+    // jump bytes known there and the flags it returns with
+    void returnOf(const Node& node, int& out_slot, std::map<int, int>& out_context, int& out_flags) const {
+        const State& s = node.state;
+        if(s.call >= 0) {
+            const CallWay& way = calls[s.call].first->ways[calls[s.call].second];
+            out_slot = way.slot;
+            out_context = contextAfter(s);
+            out_flags = way.flags;
+            return;
+        }
+        out_slot = s.pc;
+        out_context = contexts[s.context];
+        out_flags = node.flags & ((program.image[s.pc] & 0xF) == op_jnz ? FLAGS_Z_CLEAR : FLAGS_N_CLEAR);
+    }
+
+    // the return jump bytes the graph may write: by a popext, by a call, or by a return which is
+    // taken back (and forgotten), unlike one leaving the routine
+    std::set<int> returnBytesWritten() const {
+        std::set<int> result;
+        for(const Node& node : nodes) {
+            const State& s = node.state;
+            int slot = -1;
+            std::map<int, int> context;
+            if(s.call >= 0) {
+                const CallSummary& summary = *calls[s.call].first;
+                result.insert(summary.written.begin(), summary.written.end());
+                slot = summary.ways[calls[s.call].second].slot;
+                context = slot >= 0 ? contextAfter(s) : context;
+            } else {
+                int op = program.image[s.pc] & 0xF;
+                if(op == op_popext && isReturnOperand[ext(s.pc)]) {
+                    result.insert(ext(s.pc));
+                } else if((op == op_jnz || op == op_jnn) && isReturnOperand[s.pc + 1]) {
+                    slot = s.pc;
+                    context = contexts[s.context];
+                }
+            }
+            if(slot >= 0 && context.count(slot + 1) && context.count(slot + 2)) {
+                result.insert(slot + 1);
+                result.insert(slot + 2);
+            }
+        }
+        return result;
+    }
+
+    protected:
+    // a graph of the same program as another, taking the jumps it found rather than finding them again
+    ProgramGraph(const ProgramGraph* other) : program(other->program), isReturnOperand(other->isReturnOperand), isCallJump(other->isCallJump) {}
+
+    // what a call to entry with the flags does, or nullptr to follow it through the callee and
+    // back, as the graph does unless told otherwise
+    virtual const CallSummary* summaryOf(int entry, int flags) {
+        return nullptr;
+    }
+
+    private:
+    std::vector<bool> isReturnOperand = std::vector<bool>(IMAGE_SIZE + 2);
+    std::vector<bool> isCallJump = std::vector<bool>(IMAGE_SIZE);
+    // the nodes by address and context
+    std::unordered_map<long long, int> ids;
+    std::vector<std::map<int, int>> contexts;
+    std::map<std::map<int, int>, int> contextIds;
+    // the calls taken whole, as a summary and one of its ways, by their State::call
+    std::vector<std::pair<const CallSummary*, int>> calls;
+    std::map<std::pair<const CallSummary*, int>, int> callIds;
+
+    int ext(int address) const {
+        return (program.image[(address + 1) & 0xFFFF] << 8) | program.image[(address + 2) & 0xFFFF];
+    }
+
+    int contextFor(const std::map<int, int>& context) {
+        auto it = contextIds.find(context);
+        if(it != contextIds.end()) {
+            return it->second;
+        }
+        contexts.push_back(context);
+        return contextIds[context] = contexts.size() - 1;
+    }
+
+    int callFor(const CallSummary* summary, int way) {
+        auto it = callIds.find({ summary, way });
+        if(it != callIds.end()) {
+            return it->second;
+        }
+        calls.push_back({ summary, way });
+        return callIds[{ summary, way }] = calls.size() - 1;
+    }
+
+    // the return jump bytes known after a call's way: the caller's, but for those the callee may
+    // write, under those it leaves known
+    std::map<int, int> contextAfter(const State& s) const {
+        const CallSummary& summary = *calls[s.call].first;
+        const CallWay& way = summary.ways[calls[s.call].second];
+        std::map<int, int> context;
+        for(const auto& byte : contexts[s.context]) {
+            if(!summary.written.count(byte.first)) {
+                context.insert(byte);
+            }
+        }
+        for(const auto& byte : way.context) {
+            context[byte.first] = byte.second;
+        }
+        return context;
+    }
+
+    // the node of a state, adding it if new; returns true if it was new, or the state or flags added
+    // to what the node was reached with
+    bool nodeFor(const State& state, int flags, int* out_id = nullptr) {
+        auto it = ids.find(state.key());
+        if(it == ids.end()) {
+            if(out_id != nullptr) {
+                *out_id = nodes.size();
+            }
+            ids[state.key()] = nodes.size();
+            nodes.push_back(Node());
+            nodes.back().state = state;
+            nodes.back().flags = flags;
+            return true;
+        }
+        Node& node = nodes[it->second];
+        if(out_id != nullptr) {
+            *out_id = it->second;
+        }
+        int s1 = joinValues(node.state.s1, state.s1);
+        int s2 = joinValues(node.state.s2, state.s2);
+        bool isNew = (node.flags | flags) != node.flags || s1 != node.state.s1 || s2 != node.state.s2;
+        node.state.s1 = s1;
+        node.state.s2 = s2;
+        node.flags |= flags;
+        return isNew;
+    }
+
+    // what is known of a byte which is either value
+    static int joinValues(int a, int b) {
+        if(a == b) {
+            return a;
+        }
+        int parity = parityOf(a);
+        return parity >= 0 && parity == parityOf(b) ? (parity ? VALUE_ODD : VALUE_EVEN) : VALUE_UNKNOWN;
+    }
+
+    // the states an instruction goes to, with their flags, and the ways it ends the routine
+    // returns false after setting problem if it isn't an instruction
+    bool tryTransitions(const Node& node, std::vector<std::pair<State, int>>& out_next, int& out_ends, long long& out_cycles, long long& out_best) {
+        const State& s = node.state;
+        if(s.call >= 0) {
+            // a call taken whole ends by its way, or returns where the caller's context says
+            const CallWay& way = calls[s.call].first->ways[calls[s.call].second];
+            out_cycles = way.worst;
+            out_best = way.best;
+            out_ends |= way.ends;
+            if(way.slot < 0) {
+                return true;
+            }
+            std::map<int, int> context = contextAfter(s);
+            auto high = context.find(way.slot + 1);
+            auto low = context.find(way.slot + 2);
+            if(high == context.end() || low == context.end()) {
+                out_ends |= end_return;
+                return true;
+            }
+            State back{ (high->second << 8) | low->second, -1, -1, 0 };
+            context.erase(high);
+            context.erase(low);
+            back.context = contextFor(context);
+            out_next.push_back({ back, way.flags });
+            return true;
+        }
+        int pc = s.pc;
+        if(pc >= (int)program.image.size() || program.sizes[pc] == 0) {
+            problem = "runs into data at " + program.describe(pc);
+            return false;
+        }
+        int op = program.image[pc] & 0xF;
+        out_cycles = op < op_count ? opCycles(op) : 0;
+        out_best = out_cycles;
+        if(op >= op_count) {
+            out_ends |= end_fault;
+            return true;
+        }
+        int next = (pc + opSize(op)) & 0xFFFF;
+        State after = s;
+        after.pc = next;
+        int flags = node.flags;
+        switch(op) {
+            case op_halt: {
+                out_ends |= end_halt;
+                return true;
+            }
+            case op_pushimm: {
+                after.s2 = s.s1;
+                after.s1 = program.image[pc + 1];
+                break;
+            }
+            case op_pushext: {
+                int address = ext(pc);
+                after.s2 = s.s1;
+                after.s1 = address < (int)program.image.size() ? VALUE_READ + address : VALUE_UNKNOWN;
+                break;
+            }
+            case op_popinh: {
+                after.s1 = s.s2;
+                after.s2 = -1;
+                break;
+            }
+            case op_popext: {
+                int address = ext(pc);
+                if(isReturnOperand[address]) {
+                    std::map<int, int> context = contexts[s.context];
+                    if(isKnownValue(s.s1)) {
+                        context[address] = s.s1;
+                    } else {
+                        context.erase(address);
+                    }
+                    after.context = contextFor(context);
+                } else if(address == map_PSW) {
+                    flags = isKnownValue(s.s1) ? 1 << (((s.s1 >> 7) & 1) * 2 + ((s.s1 >> 6) & 1)) : FLAGS_ANY;
+                }
+                after.s1 = s.s2 == VALUE_READ + address ? VALUE_UNKNOWN : s.s2;
+                after.s2 = -1;
+                break;
+            }
+            case op_add:
+            case op_sub:
+            case op_nor: {
+                int value = VALUE_UNKNOWN;
+                int p1 = parityOf(s.s1), p2 = parityOf(s.s2);
+                if(isKnownValue(s.s1) && isKnownValue(s.s2)) {
+                    value = (op == op_add ? s.s1 + s.s2 : op == op_sub ? s.s1 - s.s2 : ~(s.s1 | s.s2)) & 0xFF;
+                } else if(s.s1 == s.s2 && s.s1 >= VALUE_READ && op != op_nor) {
+                    value = op == op_add ? VALUE_EVEN : 0;
+                } else if(p1 >= 0 && p2 >= 0) {
+                    value = (op == op_nor ? !(p1 | p2) : p1 ^ p2) ? VALUE_ODD : VALUE_EVEN;
+                }
+                if(op != op_nor) {
+                    flags = isKnownValue(value) ? 1 << ((value == 0) * 2 + ((value >> 7) & 1)) : value == VALUE_ODD ? FLAGS_Z_CLEAR : FLAGS_ARITH;
+                }
+                after.s1 = value;
+                after.s2 = -1;
+                break;
+            }
+            case op_jnz:
+            case op_jnn: {
+                int clear = op == op_jnz ? FLAGS_Z_CLEAR : FLAGS_N_CLEAR;
+                if((flags & ~clear) != 0) {
+                    out_next.push_back({ after, flags & ~clear });
+                }
+                if((flags & clear) != 0) {
+                    State taken = s;
+                    if(!isReturnOperand[pc + 1]) {
+                        taken.pc = ext(pc);
+                        const CallSummary* summary = isCallJump[pc] ? summaryOf(taken.pc, flags & clear) : nullptr;
+                        if(summary != nullptr) {
+                            if(!summary->isBounded) {
+                                problem = summary->problem;
+                                isCallProblem = true;
+                                return false;
+                            }
+                            taken.s1 = taken.s2 = -1;
+                            for(size_t k = 0; k < summary->ways.size(); k++) {
+                                taken.call = callFor(summary, k);
+                                out_next.push_back({ taken, flags & clear });
+                            }
+                            return true;
+                        }
+                    } else {
+                        std::map<int, int> context = contexts[s.context];
+                        auto high = context.find(pc + 1);
+                        auto low = context.find(pc + 2);
+                        if(high == context.end() || low == context.end()) {
+                            out_ends |= end_return;
+                            return true;
+                        }
+                        taken.pc = (high->second << 8) | low->second;
+                        // the return is done with until the next call writes it
+                        context.erase(high);
+                        context.erase(low);
+                        taken.context = contextFor(context);
+                    }
+                    out_next.push_back({ taken, flags & clear });
+                }
+                return true;
+            }
+        }
+        out_next.push_back({ after, flags });
+        return true;
+    }
+
+    // finds the graph's nodes, then their edges with the flags they were all reached with
+    // returns false after setting problem if not possible
+    bool explore() {
+        std::vector<int> work = { 0 };
+        std::vector<std::pair<State, int>> next;
+        while(!work.empty()) {
+            int id = work.back();
+            work.pop_back();
+            next.clear();
+            int ends = 0;
+            long long cycles = 0, best = 0;
+            if(!tryTransitions(nodes[id], next, ends, cycles, best)) {
+                return false;
+            }
+            for(const auto& transition : next) {
+                int to;
+                if(nodeFor(transition.first, transition.second, &to)) {
+                    work.push_back(to);
+                }
+            }
+            if(nodes.size() > MAX_STATES) {
+                problem = "has more than " + std::to_string(MAX_STATES) + " states";
+                return false;
+            }
+        }
+        for(Node& node : nodes) {
+            next.clear();
+            tryTransitions(node, next, node.ends, node.cycles, node.bestCycles);
+            for(const auto& transition : next) {
+                int to = ids[transition.first.key()];
+                if(std::find(node.successors.begin(), node.successors.end(), to) == node.successors.end()) {
+                    node.successors.push_back(to);
+                }
+            }
+        }
+        return true;
+    }
+};
+
+// the ends of a routine beyond a halt, a return or a fault: its returns by each return jump and what
+// is known there, from -END_RETURNS down
+const int END_RETURNS = 8;
+
+class WcetAnalyzer : public ProgramGraph {
+    public:
+    WcetAnalyzer(const MappedProgram& _program, const std::map<int, LoopBound>& _bounds) : ProgramGraph(_program), bounds(_bounds), summaries(&ownSummaries) {}
+
+    // times the routine starting at entry with the flags
+    RoutineTime analyze(int entry, int flags = FLAGS_ARITH) {
+        RoutineTime result;
+        result.address = entry;
+        if(!tryBuild(entry, flags)) {
+            result.problem = problem;
+            result.states = nodes.size();
+            return result;
+        }
+        result.states = nodes.size();
+        if(!tryTime(result)) {
+            result.problem = problem;
+            return result;
+        }
+        result.isBounded = true;
+        return result;
+    }
+
+    protected:
+    // times the routine called once for its entry and flags, for every call to it
+    const CallSummary* summaryOf(int entry, int flags) override {
+        auto key = std::make_pair(entry, flags);
+        auto it = summaries->find(key);
+        if(it != summaries->end()) {
+            // one left unbounded with no problem is still being timed, and this call is back to it
+            if(!it->second.isBounded && it->second.problem.empty()) {
+                it->second.problem = "calls " + program.describe(entry) + ", which calls itself";
+            }
+            return &it->second;
+        }
+        CallSummary& summary = (*summaries)[key];
+        WcetAnalyzer callee(this);
+        RoutineTime time = callee.analyze(entry, flags);
+        if(!time.isBounded) {
+            summary.problem = callee.isCallProblem ? callee.problem : "calls " + program.describe(entry) + ", which " + callee.problem;
+            return &summary;
+        }
+        summary.ways = callee.ways;
+        summary.written = callee.returnBytesWritten();
+        summary.isBounded = true;
+        return &summary;
+    }
+
+    private:
+    const std::map<int, LoopBound>& bounds;
+    // the routines timed as called, by their entry and flags, shared with those timing the callees
+    std::map<std::pair<int, int>, CallSummary> ownSummaries;
+    std::map<std::pair<int, int>, CallSummary>* summaries;
+    // the returns found for the ends of the routine, then the ways it ends
+    std::vector<CallWay> returns;
+    std::vector<CallWay> ways;
+
+    // the analyzer of a routine the caller calls, sharing its summaries and bounds
+    WcetAnalyzer(const WcetAnalyzer* caller) : ProgramGraph(caller), bounds(caller->bounds), summaries(caller->summaries) {}
+
+    // the end target of a node's return out of the routine, one for each return jump and what is
+    // known there
+    int returnTarget(int id) {
+        CallWay way;
+        returnOf(nodes[id], way.slot, way.context, way.flags);
+        for(size_t k = 0; k < returns.size(); k++) {
+            if(returns[k].slot == way.slot && returns[k].context == way.context) {
+                returns[k].flags |= way.flags;
+                return -(END_RETURNS + (int)k);
+            }
+        }
+        returns.push_back(way);
+        return -(END_RETURNS + (int)returns.size() - 1);
+    }
+
+    // the cost of leaving a node or collapsed loop for a target (a node, or -end for an end)
+    class Exit {
+        public:
+        int target;
+        long long worst;
+        long long best;
+    };
+
+
+    // collapses the loops, then times the paths from the entry to the ends
+    // returns false after setting problem if not possible
+    bool tryTime(RoutineTime& result) {
+        int n = nodes.size();
+        // reverse postorder from the entry
+        std::vector<int> order, position(n, -1);
+        std::vector<int> stack = { 0 }, nextChild(n, 0);
+        std::vector<bool> isSeen(n, false);
+        isSeen[0] = true;
+        while(!stack.empty()) {
+            int id = stack.back();
+            if(nextChild[id] < (int)nodes[id].successors.size()) {
+                int to = nodes[id].successors[nextChild[id]++];
+                if(!isSeen[to]) {
+                    isSeen[to] = true;
+                    stack.push_back(to);
+                }
+            } else {
+                order.push_back(id);
+                stack.pop_back();
+            }
+        }
+        // (a node left unreached, a call first taken with fewer flags, has no position)
+        std::reverse(order.begin(), order.end());
+        for(size_t k = 0; k < order.size(); k++) {
+            position[order[k]] = k;
+        }
+        std::vector<std::vector<int>> predecessors(n);
+        for(int id : order) {
+            for(int to : nodes[id].successors) {
+                predecessors[to].push_back(id);
+            }
+        }
+        // dominators, as in Cooper, Harvey and Kennedy's "A Simple, Fast Dominance Algorithm"
+        std::vector<int> dominator(n, -1);
+        dominator[0] = 0;
+        for(bool isChanged = true; isChanged;) {
+            isChanged = false;
+            for(size_t k = 1; k < order.size(); k++) {
+                int id = order[k];
+                int idom = -1;
+                for(int from : predecessors[id]) {
+                    if(dominator[from] < 0) {
+                        continue;
+                    }
+                    if(idom < 0) {
+                        idom = from;
+                        continue;
+                    }
+                    int a = from, b = idom;
+                    while(a != b) {
+                        while(position[a] > position[b]) {
+                            a = dominator[a];
+                        }
+                        while(position[b] > position[a]) {
+                            b = dominator[b];
+                        }
+                    }
+                    idom = a;
+                }
+                if(dominator[id] != idom) {
+                    dominator[id] = idom;
+                    isChanged = true;
+                }
+            }
+        }
+        auto dominates = [&](int a, int b) {
+            while(b != a && b != 0) {
+                b = dominator[b];
+            }
+            return b == a;
+        };
+        // the loops, by their first instruction, with their bodies
+        std::map<int, std::vector<int>> latches;
+        for(int id : order) {
+            for(int to : nodes[id].successors) {
+                if(position[to] > position[id]) {
+                    continue;
+                }
+                if(!dominates(to, id)) {
+                    problem = "has a loop entered other than at its first instruction, at " + program.describe(nodes[to].state.pc);
+                    return false;
+                }
+                latches[to].push_back(id);
+            }
+        }
+        std::vector<std::pair<int, std::vector<int>>> loops;
+        for(const auto& loop : latches) {
+            std::vector<int> body = { loop.first };
+            std::vector<bool> isIn(n, false);
+            isIn[loop.first] = true;
+            std::vector<int> work;
+            for(int latch : loop.second) {
+                if(!isIn[latch]) {
+                    isIn[latch] = true;
+                    body.push_back(latch);
+                    work.push_back(latch);
+                }
+            }
+            while(!work.empty()) {
+                int id = work.back();
+                work.pop_back();
+                for(int from : predecessors[id]) {
+                    if(!isIn[from]) {
+                        isIn[from] = true;
+                        body.push_back(from);
+                        work.push_back(from);
+                    }
+                }
+            }
+            loops.push_back({ loop.first, body });
+        }
+        std::sort(loops.begin(), loops.end(), [](const auto& a, const auto& b) {
+            return a.second.size() < b.second.size();
+        });
+
+        // each node, then each collapsed loop, with what leaving it costs
+        exits.assign(n, std::vector<Exit>());
+        collapsedInto.assign(n, -1);
+        returns.clear();
+        for(int id = 0; id < n; id++) {
+            for(int to : nodes[id].successors) {
+                exits[id].push_back({ to, nodes[id].cycles, nodes[id].bestCycles });
+            }
+            for(int end : { end_halt, end_return, end_fault }) {
+                if(nodes[id].ends & end) {
+                    exits[id].push_back({ end == end_return ? returnTarget(id) : -end, nodes[id].cycles, nodes[id].bestCycles });
+                }
+            }
+        }
+        for(const auto& loop : loops) {
+            int header = loop.first;
+            std::vector<int> members;
+            for(int id : loop.second) {
+                members.push_back(find(id));
+            }
+            std::map<int, Exit> leaving;
+            Exit around{ header, -1, LLONG_MAX };
+            if(!tryWalk(header, members, header, leaving, around)) {
+                return false;
+            }
+            auto bound = bounds.find(nodes[header].state.pc);
+            if(bound == bounds.end()) {
+                problem = "has a loop with no bound, at " + program.describe(nodes[header].state.pc);
+                return false;
+            }
+            int collapsed = exits.size();
+            exits.push_back(std::vector<Exit>());
+            collapsedInto.push_back(-1);
+            for(const auto& way : leaving) {
+                exits[collapsed].push_back({ way.first, (bound->second.max - 1) * around.worst + way.second.worst, (bound->second.min - 1) * around.best + way.second.best });
+            }
+            for(int member : members) {
+                collapsedInto[member] = collapsed;
+            }
+        }
+
+        std::vector<int> members;
+        for(int id = 0; id < n; id++) {
+            members.push_back(find(id));
+        }
+        std::map<int, Exit> leaving;
+        Exit around{ -1, -1, LLONG_MAX };
+        if(!tryWalk(find(0), members, -1, leaving, around)) {
+            return false;
+        }
+        if(leaving.empty()) {
+            problem = "never ends";
+            return false;
+        }
+        result.best = LLONG_MAX;
+        ways.clear();
+        for(const auto& way : leaving) {
+            CallWay end;
+            if(way.first <= -END_RETURNS) {
+                end = returns[-way.first - END_RETURNS];
+                result.ends |= end_return;
+            } else {
+                end.ends = -way.first;
+                result.ends |= end.ends;
+            }
+            end.worst = way.second.worst;
+            end.best = way.second.best;
+            ways.push_back(end);
+            result.worst = std::max(result.worst, way.second.worst);
+            result.best = std::min(result.best, way.second.best);
+        }
+        return true;
+    }
+
+    std::vector<std::vector<Exit>> exits;
+    std::vector<int> collapsedInto;
+    // for tryWalk, by node or loop: the walk it was last a member of, its state in the walk, and the
+    // longest and shortest paths to it
+    std::vector<int> walkOf;
+    std::vector<char> visit;
+    std::vector<long long> worstTo, bestTo;
+    int walk = 0;
+
+    // the outermost collapsed loop a node or loop is in, or itself
+    int find(int id) {
+        while(collapsedInto[id] >= 0) {
+            id = collapsedInto[id];
+        }
+        return id;
+    }
+
+    // finds the longest and shortest paths from start through members, which have no cycles but
+    // through header (-1 for none): out_leaving gets the cost of leaving members by each target,
+    // and out_around that of coming back to header
+    // returns false after setting problem if the members have a cycle
+    bool tryWalk(int start, const std::vector<int>& members, int header, std::map<int, Exit>& out_leaving, Exit& out_around) {
+        if(walkOf.size() < exits.size()) {
+            walkOf.resize(exits.size(), 0);
+            visit.resize(exits.size());
+            worstTo.resize(exits.size());
+            bestTo.resize(exits.size());
+        }
+        walk++;
+        for(int id : members) {
+            walkOf[id] = walk;
+            visit[id] = 0;
+            worstTo[id] = -1;
+            bestTo[id] = LLONG_MAX;
+        }
+        // postorder over the members, not following edges back to header
+        std::vector<int> order;
+        std::vector<std::pair<int, size_t>> stack = { { start, 0 } };
+        visit[start] = 1;
+        while(!stack.empty()) {
+            int id = stack.back().first;
+            size_t k = stack.back().second++;
+            if(k < exits[id].size()) {
+                int target = exits[id][k].target;
+                if(target < 0 || target == header) {
+                    continue;
+                }
+                int to = find(target);
+                if(walkOf[to] != walk) {
+                    continue;
+                }
+                if(visit[to] == 1) {
+                    problem = "has a loop which isn't collapsed, at " + program.describe(to < (int)nodes.size() ? nodes[to].state.pc : 0);
+                    return false;
+                } else if(visit[to] == 0) {
+                    visit[to] = 1;
+                    stack.push_back({ to, 0 });
+                }
+            } else {
+                visit[id] = 2;
+                order.push_back(id);
+                stack.pop_back();
+            }
+        }
+        worstTo[start] = 0;
+        bestTo[start] = 0;
+        for(auto it = order.rbegin(); it != order.rend(); ++it) {
+            int id = *it;
+            for(const Exit& exit : exits[id]) {
+                long long w = worstTo[id] + exit.worst;
+                long long b = bestTo[id] + exit.best;
+                int to = exit.target >= 0 ? find(exit.target) : exit.target;
+                if(exit.target >= 0 && exit.target == header) {
+                    out_around.worst = std::max(out_around.worst, w);
+                    out_around.best = std::min(out_around.best, b);
+                } else if(exit.target >= 0 && walkOf[to] == walk) {
+                    worstTo[to] = std::max(worstTo[to], w);
+                    bestTo[to] = std::min(bestTo[to], b);
+                } else {
+                    auto way = out_leaving.find(exit.target);
+                    if(way == out_leaving.end()) {
+                        out_leaving[exit.target] = { exit.target, w, b };
+                    } else {
+                        way->second.worst = std::max(way->second.worst, w);
+                        way->second.best = std::min(way->second.best, b);
+                    }
+                }
+            }
+        }
+        return true;
+    }
+};
+
+// times the routine of the label, or if none is given each routine of the program: the reset
+// address, each address called, and each function compiled by cpp2assem (a label starting f_)
+// returns false after writing an error if the label isn't one of an instruction
+bool tryAnalyzeRoutines(const MappedProgram& program, const std::map<int, LoopBound>& bounds, const std::string& routine, std::vector<RoutineTime>& out_times, std::ostream& err) {
+    WcetAnalyzer analyzer(program, bounds);
+    std::set<int> entries;
+    if(routine != "") {
+        auto it = program.labels.find(routine);
+        if(it == program.labels.end() || it->second >= IMAGE_SIZE || program.sizes[it->second] == 0) {
+            err << "Error: " << routine << " is not the label of an instruction" << std::endl;
+            return false;
+        }
+        entries.insert(it->second);
+    } else {
+        for(int address : analyzer.calledRoutines()) {
+            if(address < IMAGE_SIZE && program.sizes[address] > 0) {
+                entries.insert(address);
+            }
+        }
+        for(const auto& label : program.labels) {
+            if(label.first.compare(0, 2, "f_") == 0 && label.second < IMAGE_SIZE && program.sizes[label.second] > 0 && !analyzer.isReturn(label.second)) {
+                entries.insert(label.second);
+            }
+        }
+        if(program.sizes[0] > 0) {
+            entries.insert(0);
+        }
+    }
+    out_times.clear();
+    for(int entry : entries) {
+        out_times.push_back(analyzer.analyze(entry));
+    }
+    return true;
+}
+
+// writes a line for each routine: its labels, address, best and worst case cycles, and how it ends,
+// or why it is unbounded
+void writeRoutineTimes(std::ostream& os, const MappedProgram& program, const std::vector<RoutineTime>& times) {
+    os << "addr   " << padLeft("best", 10) << " " << padLeft("worst", 10) << "  ends          | routine" << std::endl;
+    for(const RoutineTime& time : times) {
+        std::string names = program.labelsAt(time.address);
+        names = names.empty() ? "(reset)" : "#" + names;
+        os << padRight(intToFourHex(time.address), 6) << " ";
+        if(!time.isBounded) {
+            os << padLeft("-", 10) << " " << padLeft("-", 10) << "  " << padRight("unbounded", 13) << " | " << names << ": " << time.problem << std::endl;
+            continue;
+        }
+        std::string ends;
+        for(const auto& end : { std::make_pair(end_halt, "halt"), std::make_pair(end_return, "return"), std::make_pair(end_fault, "fault") }) {
+            if(time.ends & end.first) {
+                ends += (ends.empty() ? "" : ",") + std::string(end.second);
+            }
+        }
+        os << padLeft(std::to_string(time.best), 10) << " " << padLeft(std::to_string(time.worst), 10) << "  " << padRight(ends, 13) << " | " << names << std::endl;
+    }
+}
+
+#endif // WCET_H